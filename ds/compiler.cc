@@ -1,6 +1,7 @@
 #include "compiler.hh"
 #include <datascript/base_renderer.hh>
 #include <datascript/ir_builder.hh>
+#include <datascript/ir_synth.hh>
 #include <datascript/parser.hh>
 #include <datascript/parser_error.hh>
 #include <datascript/renderer_registry.hh>
@@ -49,6 +50,12 @@ int Compiler::compile() {
                 return print_outputs(bundle, modules);
             }
 
+            // Synthetic test data replaces code generation
+            if (!options_.synth_type.empty()) {
+                write_synthetic_data(bundle);
+                continue;
+            }
+
             // Stage 5: Generate code
             generate_code(bundle, modules);
         }
@@ -91,6 +98,8 @@ bool Compiler::run_semantic_analysis(module_set& modules, semantic::analysis_res
     semantic::analysis_options analysis_opts;
     analysis_opts.warnings_as_errors = options_.warnings_as_errors;
     analysis_opts.disabled_warnings = options_.disabled_warnings;
+    analysis_opts.jobs = options_.jobs;
+    analysis_opts.check_decode_cost = options_.perf_lints || options_.cost_report;
 
     if (options_.suppress_all_warnings) {
         analysis_opts.min_level = semantic::diagnostic_level::error;
@@ -102,6 +111,18 @@ bool Compiler::run_semantic_analysis(module_set& modules, semantic::analysis_res
     // Print diagnostics
     print_diagnostics(out_result);
 
+    if (options_.cost_report && out_result.analyzed) {
+        std::cout << semantic::format_cost_report(*out_result.analyzed);
+    }
+
+    if (!options_.size_report_path.empty() && out_result.analyzed) {
+        std::ofstream ofs(options_.size_report_path);
+        if (!ofs) {
+            throw std::runtime_error("Failed to open file for writing: " + options_.size_report_path.string());
+        }
+        ofs << semantic::format_size_report(*out_result.analyzed);
+    }
+
     // Return true if successful, false if errors
     return !out_result.has_errors();
 }
@@ -171,6 +192,39 @@ void Compiler::generate_code(const ir::bundle& bundle, const module_set& modules
     write_output_files(output_files);
 }
 
+void Compiler::write_synthetic_data(const ir::bundle& bundle) {
+    std::filesystem::path path = options_.synth_output;
+    if (path.empty()) {
+        std::filesystem::path output_dir = options_.output_dir;
+        if (output_dir.empty()) {
+            output_dir = std::filesystem::current_path();
+        }
+        path = output_dir / (options_.synth_type + ".bin");
+    }
+
+    logger_.verbose("Synthesizing " + std::to_string(options_.synth_count) + " instance(s) of " +
+                    options_.synth_type + " (seed " + std::to_string(options_.synth_seed) + ")");
+
+    ir::synth_options synth_opts;
+    synth_opts.seed = options_.synth_seed;
+    ir::instance_generator generator(bundle, synth_opts);
+
+    std::vector<uint8_t> data;
+    generator.generate_records(options_.synth_type, options_.synth_count, data);
+
+    auto parent = path.parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) {
+        throw std::runtime_error("Failed to open file for writing: " + path.string());
+    }
+    ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    logger_.success("Wrote " + std::to_string(data.size()) + " bytes to " + path.string());
+}
+
 // ============================================================================
 // Output File Writing
 // ============================================================================
@@ -37,6 +37,9 @@ private:
     /// Stage 5: Generate code in target language
     void generate_code(const ir::bundle& bundle, const module_set& modules);
 
+    /// Stage 5 (--synth): write random instances of a type instead of code
+    void write_synthetic_data(const ir::bundle& bundle);
+
     // ========================================================================
     // Output File Writing
     // ========================================================================
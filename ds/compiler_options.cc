@@ -240,12 +240,77 @@ CompilerOptions parse_command_line(int argc, char** argv) {
             continue;
         }
 
+        // Semantic analysis worker threads
+        if (starts_with(arg, "-j")) {
+            std::string value = get_option_value(arg, "-j");
+            if (value.empty() && i + 1 < argc) {
+                value = argv[++i];
+            }
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::runtime_error("Option -j requires a numeric argument");
+            }
+            opts.jobs = std::stoul(value);
+            continue;
+        }
+
         // Warning options
         if (std::strcmp(arg, "-Werror") == 0) {
             opts.warnings_as_errors = true;
             continue;
         }
 
+        if (std::strcmp(arg, "-Wperf") == 0) {
+            opts.perf_lints = true;
+            continue;
+        }
+
+        if (std::strcmp(arg, "--cost-report") == 0) {
+            opts.cost_report = true;
+            continue;
+        }
+
+        if (starts_with(arg, "--size-report=")) {
+            std::string value = get_option_value(arg, "--size-report=");
+            if (value.empty()) {
+                throw std::runtime_error("Option --size-report requires a file name");
+            }
+            opts.size_report_path = value;
+            continue;
+        }
+
+        // Synthetic test data
+        if (starts_with(arg, "--synth=")) {
+            opts.synth_type = get_option_value(arg, "--synth=");
+            if (opts.synth_type.empty()) {
+                throw std::runtime_error("Option --synth requires a type name");
+            }
+            continue;
+        }
+
+        if (starts_with(arg, "--synth-count=") || starts_with(arg, "--synth-seed=")) {
+            const bool is_count = starts_with(arg, "--synth-count=");
+            std::string value = get_option_value(arg, is_count ? "--synth-count=" : "--synth-seed=");
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::runtime_error(std::string("Option ") + (is_count ? "--synth-count" : "--synth-seed") +
+                                         " requires a numeric argument");
+            }
+            if (is_count) {
+                opts.synth_count = std::stoull(value);
+            } else {
+                opts.synth_seed = std::stoull(value);
+            }
+            continue;
+        }
+
+        if (starts_with(arg, "--synth-output=")) {
+            std::string value = get_option_value(arg, "--synth-output=");
+            if (value.empty()) {
+                throw std::runtime_error("Option --synth-output requires a file name");
+            }
+            opts.synth_output = value;
+            continue;
+        }
+
         if (std::strcmp(arg, "-w") == 0) {
             opts.suppress_all_warnings = true;
             continue;
@@ -341,6 +406,19 @@ void print_help(const char* program_name) {
     std::cout << "  -I <dir>                Add include search path\n";
     std::cout << "\n";
 
+    std::cout << "Analysis:\n";
+    std::cout << "  -j <n>                  Worker threads for semantic analysis (default: 1, 0 = all cores)\n";
+    std::cout << "  --cost-report           Print estimated decode cost per type (implies -Wperf)\n";
+    std::cout << "  --size-report=<file>    Write per-type wire size and heap bounds as JSON\n";
+    std::cout << "\n";
+
+    std::cout << "Synthetic Test Data:\n";
+    std::cout << "  --synth=<Type>          Write random valid instances of Type instead of code\n";
+    std::cout << "  --synth-count=<n>       Number of back-to-back instances (default: 1)\n";
+    std::cout << "  --synth-seed=<n>        Random seed (default: 0)\n";
+    std::cout << "  --synth-output=<file>   Output file (default: <output-dir>/<Type>.bin)\n";
+    std::cout << "\n";
+
     std::cout << "Diagnostics:\n";
     std::cout << "  -v, --verbose           Verbose output\n";
     std::cout << "  -q, --quiet             Quiet mode (errors only)\n";
@@ -348,6 +426,7 @@ void print_help(const char* program_name) {
     std::cout << "  -Werror                 Treat all warnings as errors\n";
     std::cout << "  -Werror=<code>          Treat specific warning as error\n";
     std::cout << "  -Wno-<code>             Disable specific warning\n";
+    std::cout << "  -Wperf                  Warn about slow or unbounded decoding (W050-W054)\n";
     std::cout << "\n";
 
     std::cout << "Generator Options:\n";
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <map>
 #include <set>
@@ -54,6 +55,19 @@ struct CompilerOptions {
     bool suppress_all_warnings = false;              // -w
     std::set<std::string> disabled_warnings;         // -Wno-W001
     std::map<std::string, bool> warning_overrides;   // -Werror=W001
+    size_t jobs = 1;                                 // -j <n> (0 = all hardware threads)
+    bool perf_lints = false;                         // -Wperf (decode performance warnings)
+    bool cost_report = false;                        // --cost-report (per-type decode cost table)
+    std::filesystem::path size_report_path;          // --size-report=<file> (JSON wire size bounds)
+
+    // ========================================================================
+    // Synthetic Test Data
+    // ========================================================================
+
+    std::string synth_type;                          // --synth=<Type> (write instances instead of code)
+    size_t synth_count = 1;                          // --synth-count=<n> (back-to-back records)
+    uint64_t synth_seed = 0;                         // --synth-seed=<n>
+    std::filesystem::path synth_output;              // --synth-output=<file> (default: <output>/<Type>.bin)
 
     // ========================================================================
     // Diagnostic Options
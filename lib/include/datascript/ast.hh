@@ -171,6 +171,12 @@ namespace datascript::ast {
         source_pos pos;
     };
 
+    struct float_type {
+        source_pos pos;
+        std::uint32_t bits; // 32/64 (IEEE-754 binary32/binary64)
+        endian byte_order{endian::unspec}; // unspec/little/big
+    };
+
     struct qualified_name {
         source_pos pos;
         std::vector<std::string> parts;
@@ -214,6 +220,7 @@ namespace datascript::ast {
         u16_string_type,
         u32_string_type,
         bool_type,
+        float_type,
         qualified_name,
         array_type_fixed,
         array_type_range,
@@ -312,6 +319,15 @@ namespace datascript::ast {
         expr alignment_expr;  // The alignment value (e.g., 8 for 8-byte alignment)
     };
 
+    // Transform directive (standalone): @delta or @zlib(size)
+    // Applies to the next field: array transforms to an integer array,
+    // substream transforms to the type parsed from a byte region
+    struct transform_directive {
+        source_pos pos;
+        std::string name;        // delta, delta_of_delta, zigzag_delta, xor, rol, ror or zlib
+        std::vector<expr> args;  // Substreams: region size, then key / bit count
+    };
+
     // Statement types for function bodies
     struct return_statement {
         source_pos pos;
@@ -365,11 +381,12 @@ namespace datascript::ast {
         std::optional<std::string> docstring;
     };
 
-    // Struct body item - can be a field, label, alignment directive, function, or inline type
+    // Struct body item - can be a field, label, alignment/transform directive, function, or inline type
     using struct_body_item = std::variant<
         field_def,
         label_directive,
         alignment_directive,
+        transform_directive,
         function_def,
         inline_union_field,
         inline_struct_field
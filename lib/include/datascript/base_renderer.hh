@@ -59,6 +59,10 @@ struct ExprContext {
     /// This field should NOT use parent context (it's the local variable)
     std::string current_field_name;
 
+    /// Members of an anonymous union block read as current_field_name
+    /// A case condition naming them reads current_field_name.member
+    std::set<std::string> block_members;
+
     /// Use safe reads (return errors) vs exceptions?
     /// Universal concept: Result<T> vs throw (C++/Python/TS), always Result (Rust/Go)
     bool use_safe_reads = true;
@@ -67,6 +71,10 @@ struct ExprContext {
     /// Universal: all languages need to track temporaries and parameters
     std::map<std::string, std::string> variable_names;
 
+    /// Member function calls already evaluated into a local (function name -> local)
+    /// Universal: readers evaluate pure parameterless functions once per method
+    std::map<std::string, std::string> memoized_calls;
+
     /// Module constants (for distinguishing constant refs from field refs)
     /// Universal: distinguish HEADER_SIZE (constant) from length (field)
     const std::map<std::string, uint64_t>* module_constants = nullptr;
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 #include <datascript/ir.hh>
 #include <datascript/base_renderer.hh>  // For ExprContext
@@ -48,6 +49,15 @@ public:
      */
     std::string render(const ir::expr& expr);
 
+    /**
+     * Members a union case condition may name directly.
+     *
+     * @param union_case Union case
+     * @param module IR bundle holding the case's block struct
+     * @return Field names of the block struct, or none if the case is a single field
+     */
+    static std::set<std::string> block_members(const ir::union_case& union_case, const ir::bundle& module);
+
 private:
     const ExprContext& ctx_;
     const ir::bundle* module_;  // Reserved for future use
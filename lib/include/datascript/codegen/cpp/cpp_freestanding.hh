@@ -0,0 +1,117 @@
+#pragma once
+
+#include <datascript/ir.hh>
+#include <datascript/base_renderer.hh>
+#include <datascript/codegen/presence.hh>
+#include <datascript/codegen/cpp/cpp_writer_context.hh>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace datascript::codegen {
+
+// Forward declarations
+class CppRenderer;
+
+/**
+ * Helper class for generating C++ code in the freestanding profile
+ * (--cpp-profile=freestanding).
+ *
+ * The generated header uses no heap, no exceptions and no standard library
+ * beyond <cstddef>, <cstdint>, <bit> and <type_traits>, so a reader can run
+ * in interrupt context with a deterministic stack and no allocator:
+ * - Readers are `static Status read(T& obj, data, end)` and report errors
+ *   as Status codes
+ * - Arrays whose element count has a bound at most the capacity limit
+ *   (constant lengths, ranged maxima, counts narrowed by semantic analysis)
+ *   are stored inline as FixedArray<T, N> / BoundedArray<T, N>
+ * - Longer arrays, T[] arrays and strings are views into the input
+ *   (WireArray, WireSequence, WireString)
+ * - Unions and choices are tagged unions
+ *
+ * Like CppLibraryModeGenerator, this class encapsulates the profile so the
+ * command-based CppRenderer does not have to know about it.
+ */
+class CppFreestandingGenerator {
+public:
+    /**
+     * Constructor.
+     * @param renderer Parent renderer for accessing configuration
+     */
+    explicit CppFreestandingGenerator(CppRenderer& renderer);
+
+    /**
+     * Render the freestanding header for a bundle.
+     * @throws codegen_error for constructs the profile cannot represent
+     *         (128-bit integers, views of nested arrays, transforms on
+     *         views, substreams, sequences of choices with external selectors)
+     */
+    std::string render(const ir::bundle& bundle);
+
+private:
+    // How an array field is stored
+    enum class array_storage {
+        fixed,     // FixedArray<T, N>: constant length within the capacity limit
+        bounded,   // BoundedArray<T, N>: runtime length bounded by N
+        view,      // WireArray<T>: fixed-width scalars left in the input
+        sequence   // WireSequence<T>: composite elements left in the input
+    };
+
+    struct array_plan {
+        array_storage storage = array_storage::fixed;
+        uint64_t capacity = 0;  // Element count (fixed) or capacity (bounded)
+    };
+
+    CppRenderer& renderer_;
+    const ir::bundle* bundle_ = nullptr;
+    std::ostringstream output_;
+    CppWriterContext ctx_;
+    ExprContext expr_context_;
+    int temp_counter_ = 0;  // Unique local names within one reader
+    PresencePlan presence_;  // Presence bits of conditional fields (always stored inline)
+
+    // Runtime
+    void emit_runtime();
+    void emit_array_transforms();
+
+    // Module-level declarations
+    void emit_constants();
+    void emit_enum(const ir::enum_def& enum_def);
+    void emit_subtype(const ir::subtype_def& subtype);
+    void emit_struct(const ir::struct_def& struct_def);
+    void emit_union(const ir::union_def& union_def);
+    void emit_choice(const ir::choice_def& choice_def);
+    void emit_documentation(const std::string& documentation);
+
+    // Readers
+    void emit_fields_read(const std::vector<ir::field>& fields, const struct_presence* presence = nullptr);
+    void emit_presence_members(const struct_presence& presence);
+    std::string presence_word(size_t bit, size_t bit_count) const;
+    size_t emit_bitfield_group(const std::vector<ir::field>& fields, size_t start_index);
+    void emit_field_read(const ir::field& field);
+    void emit_constraints(const ir::field& field);
+    void emit_value_read(const ir::type_ref& type, const std::string& target);
+    void emit_array_read(const ir::field& field);
+    void emit_element_reads(const ir::type_ref& element_type, const std::string& items,
+                            const std::string& count, ir::array_transform transform, size_t depth);
+    void emit_check(const std::string& call);
+
+    // Types
+    array_plan plan_array(const ir::type_ref& type, std::optional<uint64_t> max_count) const;
+    std::string field_type(const ir::field& field) const;
+    std::string value_type(const ir::type_ref& type) const;
+    std::string element_type(const ir::type_ref& type) const;
+    std::string string_type(const ir::type_ref& type) const;
+    bool is_view_element(const ir::type_ref& type) const;
+    bool is_big_endian(const ir::type_ref& type) const;
+    std::string endian_arg(const ir::type_ref& type) const;
+    std::optional<uint64_t> constant_count(const ir::type_ref& type) const;
+    const ir::type_ref& scalar_of(const ir::type_ref& type) const;
+
+    // Expressions
+    std::string render_expr(const ir::expr& expr) const;
+    std::string selector_args(const ir::type_ref& type) const;
+};
+
+}  // namespace datascript::codegen
@@ -6,6 +6,14 @@
 // - Binary reading helpers (read_uint8, read_uint16_le/be, etc.)
 // - String reading helpers (exception and safe modes)
 // - ReadResult template (for safe mode)
+// - Content-addressed decode cache (optional)
+// - Bulk file ingestion driver (optional)
+// - Relocatable decoded-object snapshots (optional)
+// - Incremental re-decoding after in-place edits (optional)
+// - UTF-16/UTF-32 to UTF-8 string transcoding (optional)
+// - Branch-light readers over padded input (optional)
+// - Hook dispatch for visitor decoding (optional)
+// - Runtime CPU feature dispatch of the vector kernels (optional)
 //
 
 #pragma once
@@ -41,22 +49,286 @@ public:
      *
      * Output order:
      * 1. Exception classes (if exceptions enabled)
-     * 2. Binary reading helpers (always)
-     * 3. Peek helpers (non-consuming reads, always)
-     * 4. String reading helpers (mode-dependent)
-     * 5. ReadResult template (if safe mode enabled)
+     * 2. CPU dispatch runtime (if set_cpu_dispatch())
+     * 3. Binary reading helpers (always)
+     * 4. Peek helpers (non-consuming reads, always)
+     * 5. String reading helpers (mode-dependent)
+     * 6. ReadResult template (if safe mode enabled)
      */
     void generate_all();
 
+    /**
+     * Switch generate_all() to the padded-input readers (--cpp-padded-input).
+     *
+     * The fixed-width readers then do one unaligned load from
+     * min(p, end) and advance without a bounds check; callers guarantee
+     * input_padding readable bytes past end (PaddedBuffer), and generated
+     * readers call check_input_end() at their checkpoints. Also emits
+     * input_padding, PaddedBuffer and check_input_end().
+     */
+    void set_padded_input(bool enabled) { padded_input_ = enabled; }
+
+    /**
+     * Set the largest inflated size of a @zlib substream
+     * (--cpp-substream-max-inflate); inflate_substream() throws past it.
+     */
+    void set_substream_max_inflate(uint64_t bytes) { substream_max_inflate_ = bytes; }
+
+    /**
+     * Generate the #include lines needed by the padded-input readers.
+     */
+    void generate_padded_input_includes();
+
+    /**
+     * Route the runtime's vector kernels through a dispatch table
+     * (--cpp-cpu-dispatch).
+     *
+     * generate_all() then emits namespace cpu: scalar, SSE2, SSE4.2, AVX2
+     * and AVX-512 builds of the byte-swap, terminator search, xor/rotate and
+     * ASCII transcoding kernels, one-time CPU detection (overridable with
+     * DATASCRIPT_FORCE_ISA), kernels() and benchmark_kernels(). Array
+     * byte-swaps, read_string(), the UTF-8 transcoders and the substream
+     * transforms call the table instead of their fixed SSE2/scalar loops.
+     */
+    void set_cpu_dispatch(bool enabled) { cpu_dispatch_ = enabled; }
+
+    /**
+     * Generate the #include lines needed by the CPU dispatch runtime.
+     */
+    void generate_cpu_dispatch_includes();
+
+    /**
+     * Generate the content-addressed decode cache support code.
+     *
+     * Emits decode_cache_hash() (XXH64 over raw input bytes) and the
+     * DecodeCache<T> template: a mutex-guarded, size-bounded LRU map from
+     * input hash to std::shared_ptr<const T> with hit/miss counters.
+     * Not part of generate_all(); emitted only when --cpp-decode-cache is set.
+     */
+    void generate_decode_cache();
+
+    /**
+     * Generate the #include lines needed by generate_bulk_ingest().
+     *
+     * Must be emitted at file scope. Besides the standard headers this emits
+     * the POSIX file headers and, on Linux with <linux/io_uring.h> available,
+     * the io_uring headers plus the DATASCRIPT_BULK_IO_URING feature macro.
+     */
+    void generate_bulk_ingest_includes();
+
+    /**
+     * Generate the bulk file ingestion driver.
+     *
+     * Emits BulkIngestOptions, BulkIngestStats, BulkReader and the
+     * bulk_ingest<T>() template. BulkReader reads files through io_uring
+     * with registered buffers and a bounded in-flight window, and hands
+     * completed buffers to a worker pool; without io_uring it falls back to
+     * a pread() thread pool. Not part of generate_all(); emitted only when
+     * --cpp-bulk-ingest is set.
+     */
+    void generate_bulk_ingest();
+
+    /**
+     * Generate the #include lines needed by generate_snapshot().
+     *
+     * Must be emitted at file scope (adds the POSIX mmap headers where
+     * available).
+     */
+    void generate_snapshot_includes();
+
+    /**
+     * Generate the decoded-object snapshot support code.
+     *
+     * Emits SnapshotError, SnapshotWriter (builds a position-independent,
+     * naturally aligned image with strings and arrays stored as
+     * offset + count references), the read-only SnapshotArray /
+     * SnapshotRecords / SnapshotStrings views, header validation and
+     * SnapshotFile (read-only file mapping). Not part of generate_all();
+     * emitted only when --cpp-snapshot is set.
+     */
+    void generate_snapshot();
+
+    /**
+     * Generate the #include lines needed by generate_incremental().
+     */
+    void generate_incremental_includes();
+
+    /**
+     * Generate the incremental re-decoding support code.
+     *
+     * Emits IncrementalSession (per-thread node table recording the input
+     * range every struct read() depended on), IncrementalFrame (the hook
+     * used by generated struct readers), incremental_touch() and the
+     * IncrementalDecoder<T> front end. Not part of generate_all(); emitted
+     * only when --cpp-incremental is set.
+     */
+    void generate_incremental();
+
+    /**
+     * Generate the #include lines needed by generate_utf8_strings()
+     * (SSE2 or NEON intrinsics where the target has them).
+     */
+    void generate_utf8_strings_includes();
+
+    /**
+     * Generate readers that decode UTF-16/UTF-32 strings straight to UTF-8.
+     *
+     * Emits read_u16string_le/be_utf8() and read_u32string_le/be_utf8(),
+     * which locate the terminator and transcode ASCII runs with SSE2 or
+     * NEON, falling back to a scalar loop that validates surrogate pairs
+     * and code point ranges. Not part of generate_all(); emitted only when
+     * --cpp-utf8-strings is set.
+     */
+    void generate_utf8_strings();
+
+    /**
+     * Generate the #include lines needed by generate_array_transforms()
+     * (SSE2 intrinsics where the target has them).
+     */
+    void generate_array_transforms_includes();
+
+    /**
+     * Generate readers for @delta, @delta_of_delta and @zigzag_delta arrays.
+     *
+     * Emits read_array_delta_le/be(), read_array_delta_of_delta_le/be() and
+     * read_array_zigzag_delta_le/be(), which bounds-check once and rebuild
+     * the values while copying them out, using an SSE2 prefix sum for 32-
+     * and 64-bit elements (the cpu::kernels() delta32/delta64 entries with
+     * --cpp-cpu-dispatch) and a scalar loop otherwise. Not part of
+     * generate_all(); emitted only when the module uses an array transform.
+     */
+    void generate_array_transforms();
+
+    /**
+     * Generate the #include lines needed by generate_substreams()
+     * (<zlib.h> when a substream is zlib-compressed, SSE2 intrinsics where
+     * the target has them).
+     */
+    void generate_substreams_includes(bool zlib);
+
+    /**
+     * Generate support for @xor / @rol / @ror / @zlib substream fields.
+     *
+     * Emits ByteTransform, undo_byte_transform() (SSE2 xor and rotate with
+     * a scalar tail), inflate_substream() (zlib inflate in 16 KiB steps up
+     * to substream_max_inflate bytes, only when zlib is set), the
+     * Substream<T> holder that decodes its raw bytes on first get(), and
+     * read_substream(). Not part of generate_all();
+     * emitted only when the module has a substream field.
+     */
+    void generate_substreams(bool zlib);
+
+    /**
+     * Generate the skip helpers used by read_projected().
+     *
+     * Emits skip_bytes(), skip_array(), skip_string() (memchr for the
+     * terminator) and skip_wide_string<Width>(). Not part of generate_all();
+     * emitted only when --cpp-project selects at least one struct.
+     */
+    void generate_projection_skippers();
+
+    /**
+     * Generate the #include lines needed by generate_batch_decode().
+     */
+    void generate_batch_decode_includes();
+
+    /**
+     * Generate the batch decoding support used by read_batch().
+     *
+     * Emits BatchStatus, batch_prefetch(), read_string_into() and
+     * decode_batch<T>(), which decodes messages in groups of
+     * batch_group_size while prefetching the inputs and output slots of the
+     * next group. Not part of generate_all(); emitted only when
+     * --cpp-batch-decode is set.
+     */
+    void generate_batch_decode();
+
+    /**
+     * Generate the #include lines needed by generate_record_index().
+     */
+    void generate_record_index_includes();
+
+    /**
+     * Generate the record-offset index used by build_index() / read_at().
+     *
+     * Emits RecordIndexError, RecordRange and RecordIndex: a sparse table of
+     * every stride-th record offset with offset_of(), split() into equal
+     * byte ranges, and save()/load() of a checksummed sidecar file stamped
+     * with the source file's size and mtime. Not part of generate_all();
+     * emitted only when --cpp-record-index lists at least one struct.
+     */
+    void generate_record_index();
+
+    /**
+     * Generate the #include lines needed by generate_parallel_decode().
+     */
+    void generate_parallel_decode_includes();
+
+    /**
+     * Generate parallel_decode<T>(), used by read_all_parallel().
+     *
+     * A serial boundary pass with the struct's skipper cuts the buffer into
+     * chunks at record boundaries; the chunks are then decoded on a thread
+     * pool into per-chunk vectors that are concatenated in order. Not part
+     * of generate_all(); emitted only when --cpp-parallel-decode lists at
+     * least one struct.
+     */
+    void generate_parallel_decode();
+
+    /**
+     * Generate the #include lines needed by generate_visitor().
+     */
+    void generate_visitor_includes();
+
+    /**
+     * Generate the hook dispatch used by the parse_<Type>(data, end, visitor)
+     * functions.
+     *
+     * Emits, in namespace visit, the handles<Tag, V> concept, wrappers that
+     * call a hook only when the visitor declares it, null_visitor and
+     * try_branch() for union trial passes, read_string_view() and
+     * extract_bits(). Not part of generate_all(); emitted only when
+     * --cpp-visitor is set.
+     */
+    void generate_visitor();
+
+    /**
+     * Generate the #include lines needed by presence tracking and
+     * out-of-line conditional fields: <optional> and <memory> for the
+     * wrappers, <bitset> for presence masks wider than 64 bits.
+     */
+    void generate_conditional_storage_includes(bool out_of_line, bool wide_masks);
+
+    /**
+     * Generate Boxed<T>, the member type of fields stored out of line with
+     * --cpp-conditional-storage=boxed.
+     *
+     * A deep-copying owning pointer with the part of the std::optional
+     * interface that readers and users need: emplace(), reset(),
+     * has_value(), operator bool, operator* and operator->. Not part of
+     * generate_all(); emitted only when some struct stores a field boxed.
+     */
+    void generate_boxed();
+
 private:
     CppWriterContext& ctx_;
     cpp_options::error_style error_handling_;
+    bool padded_input_ = false;
+    bool cpu_dispatch_ = false;
+    uint64_t substream_max_inflate_ = 64u << 20;
 
     // Generation methods for each section
     void generate_exception_classes();
     void generate_binary_readers();
+    void generate_checked_readers();
+    void generate_byteswap_helpers();
+    void generate_padded_input();
     void generate_peek_helpers();
     void generate_string_readers();
+    void generate_cpu_dispatch();
+    void generate_cpu_scalar_kernels();
+    void generate_cpu_x86_kernels();
+    void generate_array_transforms_sse2();
 };
 
 }  // namespace datascript::codegen
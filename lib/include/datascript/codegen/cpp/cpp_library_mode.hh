@@ -2,6 +2,7 @@
 
 #include <datascript/ir.hh>
 #include <datascript/base_renderer.hh>
+#include <datascript/codegen/presence.hh>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -71,6 +72,7 @@ private:
      * Generate runtime header using CppHelperGenerator.
      */
     std::string generate_runtime_header(
+        const ir::bundle& bundle,
         const std::string& namespace_name,
         const LibraryFiles& files) const;
 
@@ -92,11 +94,13 @@ private:
 
     /**
      * Generate introspection metadata for a struct.
+     * presence lists its conditional fields (null if it has none).
      */
     void generate_struct_metadata(
         std::ostream& out,
         const ir::struct_def& struct_def,
-        const std::string& namespace_name) const;
+        const std::string& namespace_name,
+        const struct_presence* presence) const;
 };
 
 }  // namespace datascript::codegen
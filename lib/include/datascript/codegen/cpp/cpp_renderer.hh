@@ -8,6 +8,7 @@
 #include <optional>
 #include <datascript/base_renderer.hh>
 #include <datascript/codegen_commands.hh>
+#include <datascript/codegen/presence.hh>
 #include <datascript/codegen/cpp/cpp_writer_context.hh>
 
 namespace datascript::codegen {
@@ -64,6 +65,104 @@ public:
      */
     std::optional<std::string> get_output_name_override() const { return output_name_override_; }
 
+    /**
+     * Check whether content-addressed decode caches are generated (--cpp-decode-cache).
+     */
+    bool is_decode_cache_enabled() const { return generate_decode_cache_; }
+
+    /**
+     * Check whether the bulk file ingestion driver is generated (--cpp-bulk-ingest).
+     */
+    bool is_bulk_ingest_enabled() const { return generate_bulk_ingest_; }
+
+    /**
+     * Check whether decoded-object snapshots are generated (--cpp-snapshot).
+     */
+    bool is_snapshot_enabled() const { return generate_snapshot_; }
+
+    /**
+     * Check whether readers take padded input (--cpp-padded-input).
+     */
+    bool is_padded_input_enabled() const { return padded_input_; }
+
+    /**
+     * Get the largest inflated size of a @zlib substream (--cpp-substream-max-inflate).
+     */
+    uint64_t get_substream_max_inflate() const { return substream_max_inflate_; }
+
+    /**
+     * Get where large conditional fields are stored (--cpp-conditional-storage).
+     */
+    conditional_storage get_conditional_storage() const { return conditional_storage_; }
+
+    /**
+     * Check whether the runtime's vector kernels are dispatched by CPU feature (--cpp-cpu-dispatch).
+     */
+    bool is_cpu_dispatch_enabled() const { return cpu_dispatch_; }
+
+    /**
+     * Check whether parse_<Type>(data, end, visitor) functions are generated (--cpp-visitor).
+     */
+    bool is_visitor_enabled() const { return generate_visitor_; }
+
+    /**
+     * Check whether incremental re-decoding support is generated (--cpp-incremental).
+     */
+    bool is_incremental_enabled() const { return generate_incremental_; }
+
+    /**
+     * Check whether UTF-16/UTF-32 strings decode to UTF-8 (--cpp-utf8-strings).
+     */
+    bool is_utf8_strings_enabled() const { return utf8_strings_; }
+
+    /**
+     * Check whether read_into() / read_batch() are generated (--cpp-batch-decode).
+     */
+    bool is_batch_decode_enabled() const { return generate_batch_decode_; }
+
+    /**
+     * Check whether the freestanding profile is selected (--cpp-profile=freestanding).
+     */
+    bool is_freestanding_profile() const { return profile_ == "freestanding"; }
+
+    /**
+     * Get the largest array stored inline in the freestanding profile
+     * (--cpp-freestanding-capacity).
+     */
+    int64_t get_freestanding_capacity() const { return freestanding_capacity_; }
+
+    /**
+     * Get the structs that get build_index() / read_at() (--cpp-record-index).
+     */
+    const std::vector<std::string>& get_record_index_structs() const { return record_index_structs_; }
+
+    /**
+     * Get the structs that get read_all_parallel() (--cpp-parallel-decode).
+     */
+    const std::vector<std::string>& get_parallel_decode_structs() const { return parallel_decode_structs_; }
+
+    /**
+     * Structs that need a boundary-scanning read_boundary() (record index,
+     * parallel decode, and variable-size structs under the decode cache).
+     */
+    std::vector<std::string> get_boundary_structs(const ir::bundle& bundle) const;
+
+    /**
+     * Get the projection spec for read_projected() methods (--cpp-project).
+     */
+    const std::string& get_projection_spec() const { return projection_spec_; }
+
+    /**
+     * Check whether any struct field carries an @delta-style array transform.
+     */
+    static bool has_array_transforms(const ir::bundle& bundle);
+
+    /**
+     * Check whether any struct field is a substream (@xor, @rol, @ror,
+     * @zlib); with zlib_only, whether any is zlib-compressed.
+     */
+    static bool has_substreams(const ir::bundle& bundle, bool zlib_only = false);
+
     /**
      * Enable/disable safe read mode (returns bool vs exceptions).
      */
@@ -193,8 +292,15 @@ public:
     void render_read_array_element(const ReadArrayElementCommand& cmd);
     void render_seek_to_label(const SeekToLabelCommand& cmd);
     void render_align_pointer(const AlignPointerCommand& cmd);
+    void render_skip_field(const SkipFieldCommand& cmd);
+    void render_reset_field(const ResetFieldCommand& cmd);
+    void render_emplace_field(const EmplaceFieldCommand& cmd);
+    void render_mark_present(const MarkPresentCommand& cmd);
     void render_resize_array(const ResizeArrayCommand& cmd);
+    void render_reserve_array(const ReserveArrayCommand& cmd);
     void render_append_to_array(const AppendToArrayCommand& cmd);
+    void render_read_primitive_array(const ReadPrimitiveArrayCommand& cmd);
+    void render_read_substream(const ReadSubstreamCommand& cmd);
 
     void render_start_loop(const StartLoopCommand& cmd);
     void render_start_while_loop(const StartWhileLoopCommand& cmd);
@@ -228,6 +334,7 @@ public:
     void render_comment(const CommentCommand& cmd);
     void render_read_primitive_to_variable(const ReadPrimitiveToVariableCommand& cmd);
     void render_extract_bitfield(const ExtractBitfieldCommand& cmd);
+    void render_memoize_call(const MemoizeCallCommand& cmd);
 
 protected:
     // ========================================================================
@@ -305,6 +412,111 @@ private:
      */
     void emit_helper_functions();
 
+    /**
+     * Emit decode_cache() and read_cached() static members for the current struct.
+     */
+    void emit_decode_cache_methods(const ir::struct_def& struct_def);
+
+    /**
+     * Emit the read_batch() static member for the current struct.
+     */
+    void emit_batch_decode_methods(const ir::struct_def& struct_def);
+
+    /**
+     * Emit build_index() and read_at() static members for the current struct.
+     */
+    void emit_record_index_methods(const ir::struct_def& struct_def);
+
+    /**
+     * Emit the read_all_parallel() static member for the current struct.
+     */
+    void emit_parallel_decode_methods(const ir::struct_def& struct_def);
+
+    /**
+     * Emit the read(const PaddedBuffer&) static member for the current struct.
+     */
+    void emit_padded_read_method();
+
+    /**
+     * Emit the presence_ mask and has_<field>() accessors of the current
+     * struct, if it has conditional fields.
+     */
+    void emit_presence_members(const struct_presence& presence);
+
+    /**
+     * Member a read writes to: "obj.name", or "(*obj.name)" while the
+     * out-of-line field name is being read.
+     */
+    std::string field_target(const std::string& field_name) const;
+
+    /**
+     * Emit check_input_end(data, end) when readers take padded input; called
+     * before anything that moves the read position back or depends on it
+     * being within the input.
+     */
+    void emit_input_checkpoint();
+
+    /**
+     * Compute the exact number of input bytes a type always consumes.
+     * Returns std::nullopt for variable-size types and for layouts that
+     * cannot be proven fixed (bitfields, labels, alignment, conditions).
+     */
+    std::optional<size_t> fixed_wire_size(const ir::type_ref& type, size_t depth = 0) const;
+    std::optional<size_t> fixed_wire_size(const ir::struct_def& struct_def, size_t depth = 0) const;
+
+    /**
+     * Fewest input bytes a type consumes: its fixed size, a string's
+     * terminator, or a struct, union or choice's min_wire_size from
+     * semantic analysis. 0 when unknown.
+     */
+    size_t min_wire_size(const ir::type_ref& type) const;
+
+    /// Most elements reserved up front for an unbounded array of variable-size elements
+    static constexpr size_t unbounded_reserve_cap = 4096;
+
+    /**
+     * Emit the min_wire_size, max_wire_size and max_heap_bytes constants
+     * of the current struct, union or choice (SIZE_MAX when unbounded).
+     */
+    void emit_size_bounds(const std::optional<ir::size_bounds>& bounds);
+
+    /**
+     * Size and alignment of a value inside a snapshot record.
+     */
+    struct snapshot_slot {
+        size_t size;
+        size_t align;
+    };
+
+    /**
+     * Emit the snapshot layout constants, write_snapshot(), to_snapshot(),
+     * the nested SnapshotView accessor class and open_snapshot() for the
+     * current struct (or a comment if a field has no snapshot layout).
+     */
+    void emit_snapshot_methods(const ir::struct_def& struct_def);
+
+    /**
+     * Compute the snapshot slot of a field type. Scalars are stored inline at
+     * their natural alignment, strings and variable arrays as 16-byte
+     * offset/count references, nested structs and fixed arrays inline.
+     * Returns std::nullopt for types without a snapshot layout (unions,
+     * choices, 128-bit integers, UTF-16/32 strings, nested arrays).
+     */
+    std::optional<snapshot_slot> snapshot_layout(const ir::type_ref& type, size_t depth = 0) const;
+
+    /**
+     * Compute the snapshot record layout of a struct; field offsets are
+     * appended to `offsets` when it is non-null.
+     */
+    std::optional<snapshot_slot> snapshot_layout(const ir::struct_def& struct_def, size_t depth = 0,
+                                                 std::vector<size_t>* offsets = nullptr) const;
+
+    /**
+     * Describe a struct's snapshot layout (field names, types, offsets and
+     * nested layouts); its hash identifies compatible snapshots.
+     */
+    std::string snapshot_signature(const ir::struct_def& struct_def, size_t depth = 0) const;
+
     // Note: Expression rendering implementation delegated to CppExpressionRenderer
 
     // ========================================================================
@@ -350,6 +562,27 @@ private:
     std::optional<std::string> output_name_override_;  // Override output filename
     bool generate_enum_to_string_ = false;  // Generate enum-to-string conversion functions
     std::string output_mode_ = "single-header";  // "single-header" or "library"
+    bool generate_decode_cache_ = false;  // Generate read_cached() with a content-addressed cache
+    int64_t decode_cache_capacity_ = 1024;  // Maximum cached objects per struct type
+    uint64_t substream_max_inflate_ = 64u << 20;  // Largest inflated @zlib substream, in bytes
+    bool generate_bulk_ingest_ = false;  // Generate BulkReader / bulk_ingest<T>()
+    bool generate_snapshot_ = false;  // Generate to_snapshot() / open_snapshot()
+    bool generate_size_bounds_ = false;  // Emit wire size / heap bound constants
+    bool padded_input_ = false;  // Readers rely on PaddedBuffer padding instead of per-read checks
+    conditional_storage conditional_storage_ = conditional_storage::inline_value;  // Large conditional fields
+    PresencePlan presence_plan_;  // Presence bits and storage of the module's conditional fields
+    std::string out_of_line_field_;  // Out-of-line field being read (between EmplaceField and MarkPresent)
+    bool cpu_dispatch_ = false;  // Vector kernels picked at run time by CPU feature
+    bool generate_visitor_ = false;  // Generate event-driven parse_<Type>(data, end, visitor)
+    bool generate_incremental_ = false;  // Generate IncrementalDecoder<T> and struct reader hooks
+    bool utf8_strings_ = false;  // Decode u16string/u32string fields to UTF-8 std::string
+    bool generate_batch_decode_ = false;  // Generate read_into() / read_batch()
+    std::vector<std::string> record_index_structs_;  // Structs that get build_index() / read_at()
+    std::vector<std::string> parallel_decode_structs_;  // Structs that get read_all_parallel()
+    std::string projection_spec_;  // "Type=field,a.b;..." structs that get read_projected()
+    bool has_projections_ = false;  // Module being rendered has projected readers
+    std::string profile_ = "default";  // "default" or "freestanding"
+    int64_t freestanding_capacity_ = 4096;  // Largest array stored inline (freestanding profile)
 
     // Type name cache for performance (30-50% faster rendering for complex types)
     mutable std::map<const ir::type_ref*, std::string> type_name_cache_;
@@ -358,6 +591,8 @@ private:
     bool in_struct_;
     bool in_method_;
     std::string current_struct_name_;
+    bool current_struct_has_reader_ = false;  // Struct emitted an exception-mode read()
+    bool current_struct_has_into_reader_ = false;  // Struct emitted read_into()
 
     // Track current enum context for bitmask operator generation
     std::string current_enum_name_;
@@ -375,6 +610,8 @@ private:
     StartMethodCommand::MethodKind current_method_kind_;
     const ir::struct_def* current_method_target_struct_;
     bool current_method_use_exceptions_;
+    bool current_method_projected_ = false;
+    bool current_method_into_ = false;  // Decoding into a caller-owned obj (read_into)
 };
 
 } // namespace datascript::codegen
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <datascript/ir.hh>
+#include <datascript/base_renderer.hh>
+#include <datascript/codegen/cpp/cpp_writer_context.hh>
+#include <cstddef>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace datascript::codegen {
+
+// Forward declarations
+class CppRenderer;
+
+/**
+ * Helper class for generating event-driven visitor decoding (--cpp-visitor).
+ *
+ * For every struct, union and choice this emits tag types
+ * (fields::<Type>::<field>) and
+ * `template<typename Visitor> void parse_<Type>(data, end, visitor)`, which
+ * decodes the input in wire order and reports it to the visitor's hooks
+ * instead of building the generated struct:
+ * - A field the visitor handles (on_field<Tag>) is decoded and reported
+ * - Any other field is skipped, unless a later length, selector, label or
+ *   constraint expression needs its value; only those fields are kept, in a
+ *   local frame of the parse function
+ * - Nested structs, unions and choices are visited field by field unless the
+ *   visitor handles them whole; arrays, union branches and choice cases are
+ *   bracketed by begin_/end_ hooks
+ *
+ * Types whose decoding is not reproduced here (substreams, array transforms,
+ * member function calls, nested arrays, bitfield arrays, 128-bit integers)
+ * get no parse function; fields of those types are decoded with T::read()
+ * and reported whole.
+ *
+ * Like CppFreestandingGenerator, this class walks the IR directly; the
+ * runtime it relies on comes from CppHelperGenerator::generate_visitor().
+ */
+class CppVisitorGenerator {
+public:
+    /**
+     * Constructor.
+     * @param renderer Parent renderer for type names and configuration
+     * @param ctx Writer context to emit into (inside the module namespace)
+     */
+    CppVisitorGenerator(CppRenderer& renderer, CppWriterContext& ctx);
+
+    /**
+     * Emit the field tags and visitor parse functions of a bundle. Must
+     * follow the definitions of all its types.
+     * @param namespace_name Namespace of the generated types
+     */
+    void generate(const ir::bundle& bundle, const std::string& namespace_name);
+
+private:
+    CppRenderer& renderer_;
+    CppWriterContext& ctx_;
+    const ir::bundle* bundle_ = nullptr;
+    std::string qualifier_;          // "::ns::" prefix of generated types in tags
+    ExprContext expr_context_;
+    std::string owner_;              // Type whose parse function is being emitted
+    std::set<std::string> needed_;   // Fields kept in the frame of that function
+    int temp_counter_ = 0;           // Unique local names within one function
+
+    // Types that get a parse function (indexed like the bundle)
+    std::vector<bool> struct_visitable_;
+    std::vector<bool> union_visitable_;
+    std::vector<bool> choice_visitable_;
+
+    // Analysis
+    void classify_types();
+    bool fields_visitable(const std::vector<const ir::field*>& fields) const;
+    bool type_visitable(const ir::type_ref& type) const;
+    bool has_parse_function(const ir::type_ref& type) const;
+    void collect_refs(const ir::expr& expr, std::set<std::string>& names, bool& calls) const;
+    void collect_type_refs(const ir::type_ref& type, std::set<std::string>& names, bool& calls) const;
+    void collect_field_refs(const ir::field& field, std::set<std::string>& names, bool& calls) const;
+    std::set<std::string> parent_refs(const ir::union_def& union_def) const;
+    void select_needed(const std::vector<const ir::field*>& fields);
+
+    // Declarations
+    void emit_tags(const std::string& owner, const std::vector<const ir::field*>& fields);
+    void emit_declarations();
+    void emit_signature(const std::string& name, const std::string& extra_templates,
+                        const std::string& extra_params, const std::string& terminator);
+
+    // Parse functions
+    void emit_struct(const ir::struct_def& struct_def);
+    void emit_union(const ir::union_def& union_def);
+    void emit_choice(const ir::choice_def& choice_def);
+    void emit_frame(const std::vector<const ir::field*>& fields);
+    void emit_fields(const std::vector<const ir::field*>& fields);
+    size_t emit_bitfield_group(const std::vector<const ir::field*>& fields, size_t start_index);
+    void emit_field(const ir::field& field);
+    void emit_value(const ir::field& field);
+    void emit_composite(const ir::type_ref& type, const std::string& tag, const std::string& target);
+    void emit_array(const ir::field& field);
+    void emit_element(const ir::type_ref& element, const std::string& tag, const std::string& target);
+    void emit_constraints(const ir::field& field);
+    void emit_checkpoint();
+
+    // Types
+    std::string tag_name(const std::string& field_name) const;
+    std::string value_type(const ir::type_ref& type) const;
+    std::string frame_type(const ir::type_ref& type) const;
+    std::string read_expr(const ir::type_ref& type) const;
+    std::string read_call(const ir::type_ref& type) const;
+    std::string parse_call(const ir::type_ref& type, const std::string& data_var) const;
+    std::optional<size_t> scalar_size(const ir::type_ref& type) const;
+
+    // Expressions
+    std::string render_expr(const ir::expr& expr) const;
+    std::string selector_args(const ir::type_ref& type) const;
+};
+
+}  // namespace datascript::codegen
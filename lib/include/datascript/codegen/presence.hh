@@ -0,0 +1,93 @@
+#pragma once
+
+#include <datascript/ir.hh>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace datascript::codegen {
+
+// ============================================================================
+// Conditional Field Presence
+// ============================================================================
+
+/// Where a generated struct keeps the value of a conditional field
+enum class conditional_storage {
+    inline_value,  ///< Plain member, like unconditional fields (default)
+    optional,      ///< std::optional<T>: no allocation, but absent values still reserve sizeof(T)
+    boxed          ///< Boxed<T>: one pointer inline, the value on the heap only when present
+};
+
+/// Parse "inline", "optional" or "boxed"; throws std::invalid_argument otherwise
+conditional_storage parse_conditional_storage(const std::string& name);
+
+/// One runtime-conditional field of a struct
+struct conditional_member {
+    std::string name;
+    std::string accessor;      ///< has_<name>, or has_<name>_ if the struct already uses that name
+    size_t bit = 0;            ///< Bit in the struct's presence_ mask
+    bool out_of_line = false;  ///< Declared as std::optional<T> / Boxed<T>
+};
+
+/// Conditional fields of one struct, in field order
+struct struct_presence {
+    std::vector<conditional_member> members;
+
+    const conditional_member* find(const std::string& field_name) const;
+    bool has_out_of_line() const;
+};
+
+/**
+ * Presence tracking for a module.
+ *
+ * Every struct with runtime-conditional fields gets one presence_ bitmask
+ * (bit i for its i-th conditional field) and has_<field>() accessors, so
+ * consumers can tell an absent field from one that decoded as zero. When a
+ * field or function of the struct is already called has_<field>, the
+ * accessor gets trailing underscores until its name is free.
+ *
+ * With optional or boxed storage, large conditional fields (strings,
+ * runtime-sized arrays, nested structs, unions and choices, fixed-size
+ * values of at least out_of_line_min_bytes) are stored out of line. Fields
+ * that expressions refer to, and fields with constraints, defaults or
+ * substreams, stay plain members: readers and checks access them directly.
+ */
+class PresencePlan {
+public:
+    /// Smallest wire size that makes a fixed-size field worth storing out of line
+    static constexpr size_t out_of_line_min_bytes = 16;
+
+    PresencePlan() = default;
+
+    static PresencePlan build(const ir::bundle& bundle, conditional_storage storage);
+
+    conditional_storage storage() const { return storage_; }
+
+    /// Conditional fields of struct_name, or nullptr if it has none
+    const struct_presence* find(const std::string& struct_name) const;
+
+    /// Whether any struct stores a field out of line
+    bool has_out_of_line() const;
+
+    /// Most conditional fields in one struct (std::bitset masks beyond 64)
+    size_t widest_mask() const;
+
+    /**
+     * Whether objects of the named struct, union or choice may own Boxed
+     * allocations, directly or through nested types. Their heap use is not
+     * covered by the IR's max_heap_bytes bound.
+     */
+    bool owns_boxes(const std::string& type_name) const { return box_owners_.count(type_name) > 0; }
+
+private:
+    conditional_storage storage_ = conditional_storage::inline_value;
+    std::map<std::string, struct_presence> structs_;  // By struct name
+    std::set<std::string> box_owners_;
+};
+
+/// C++ type holding bit_count presence bits: uint8_t .. uint64_t, std::bitset<N> beyond 64
+std::string presence_mask_type(size_t bit_count);
+
+}  // namespace datascript::codegen
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <datascript/ir.hh>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace datascript::codegen {
+
+// ============================================================================
+// Projected Readers
+// ============================================================================
+
+/// How a projected reader handles one struct field
+enum class projection_action {
+    decode,         ///< Read the field exactly as read() does
+    decode_nested,  ///< Read a struct field with its own read_projected()
+    skip_fixed,     ///< Advance by a byte count known at generation time
+    skip_elements,  ///< Advance by (runtime element count) * (fixed element size)
+    skip_string     ///< Scan past a null-terminated string without copying it
+};
+
+struct field_projection {
+    projection_action action = projection_action::decode;
+    size_t byte_size = 0;  ///< skip_fixed: total bytes; skip_elements: bytes per element
+};
+
+/**
+ * Projected readers to generate for a module.
+ *
+ * Built from a projection spec such as "Order=id,customer.name;Item=sku".
+ * Each listed struct gets a read_projected() method that decodes the listed
+ * fields plus every field needed to evaluate sizes, conditions, labels,
+ * selectors and the constraints of decoded fields. All other fields are
+ * skipped by fixed offsets or a terminator scan; the input pointer still
+ * ends up after the whole struct, exactly as with read().
+ *
+ * A path through a struct field ("customer.name") projects the nested
+ * struct as well. Variable-size nested structs that are not requested at
+ * all get an empty projection, which makes their read_projected() a pure
+ * skipper.
+ */
+class ProjectionPlan {
+public:
+    ProjectionPlan() = default;
+
+    /**
+     * Parse spec and resolve it against bundle.
+     * boundary_structs also get a projected reader; unless spec selects
+     * fields of them, it only decodes what is needed to find the end of
+     * the record. Record indexes and parallel decoders build such a plan
+     * with an empty spec, separate from the user's projection.
+     * Throws codegen_error for malformed specs, unknown structs or fields,
+     * and paths that descend into non-struct fields.
+     */
+    static ProjectionPlan build(const ir::bundle& bundle, const std::string& spec,
+                                const std::vector<std::string>& boundary_structs = {});
+
+    bool empty() const { return readers_.empty(); }
+
+    /**
+     * Per-field actions for struct_def's projected reader (parallel to
+     * struct_def.fields), or nullptr if the struct has none.
+     */
+    const std::vector<field_projection>* find(const ir::struct_def& struct_def) const;
+
+private:
+    std::map<std::string, std::vector<field_projection>> readers_;  // By struct name
+};
+
+/**
+ * Encoded size of a type when it never depends on the input, or nullopt.
+ * Shared by projected readers and the C++ renderer's fixed-size fast paths.
+ */
+std::optional<size_t> fixed_wire_size(const ir::bundle* module, const ir::type_ref& type,
+                                      size_t depth = 0);
+std::optional<size_t> fixed_wire_size(const ir::bundle* module, const ir::struct_def& struct_def,
+                                      size_t depth = 0);
+
+}  // namespace datascript::codegen
@@ -73,10 +73,17 @@ struct Command {
         ReadArrayElement,
         SeekToLabel,
         AlignPointer,
+        SkipField,  // Advance past a field a projected reader does not decode
+        ResetField,  // Return a field of a reused object to its default state
+        EmplaceField,  // Construct an out-of-line conditional field before reading it
+        MarkPresent,  // Set a conditional field's bit in the presence mask
+        ReadSubstream,  // Capture a transformed byte region for lazy decoding
 
         // Array operations
         ResizeArray,
+        ReserveArray,  // Reserve capacity for an array read until the end of the input
         AppendToArray,
+        ReadPrimitiveArray,  // Bulk-read a run of fixed-width elements
 
         // Control flow
         StartLoop,
@@ -104,6 +111,7 @@ struct Command {
         AssignChoiceWrapper,  // For choice variant assignment with wrapper struct
         ReadPrimitiveToVariable,  // Read primitive type into a variable
         ExtractBitfield,  // Extract bitfield from byte variable(s)
+        MemoizeCall,  // Evaluate a pure member function once into a local
 
         // Error handling
         SetErrorMessage,
@@ -145,6 +153,7 @@ struct DeclareFieldCommand : Command {
     std::string field_name;
     const ir::type_ref* field_type;  // IR type, not language-specific string
     std::string doc_comment;
+    const ir::substream_def* substream = nullptr;  // Field is a lazily decoded substream
 
     DeclareFieldCommand(const std::string& name, const ir::type_ref* ftype, const std::string& doc)
         : Command(DeclareField), field_name(name), field_type(ftype), doc_comment(doc) {}
@@ -240,6 +249,8 @@ struct StartMethodCommand : Command {
     const std::vector<ir::function_param>* parameters;  // For user functions (pointer to IR data, not copied)
     bool use_exceptions;  // Error handling strategy
     bool is_static;
+    bool projected = false;  // read_projected() / read_boundary(): decodes only part of the struct
+    bool into_existing = false;  // read_into(): decodes into a caller-owned object
 
     StartMethodCommand(const std::string& n, MethodKind k,
                       const ir::struct_def* target, bool exceptions, bool stat)
@@ -291,6 +302,7 @@ struct ReadFieldCommand : Command {
     std::string field_name;
     const ir::type_ref* field_type;  // IR type, not language-specific string
     bool use_exceptions;
+    std::string projected_reader;  // Struct field read with this projected reader (read_projected, read_boundary)
 
     ReadFieldCommand(const std::string& name, const ir::type_ref* ftype, bool exc)
         : Command(ReadField), field_name(name), field_type(ftype), use_exceptions(exc) {}
@@ -321,6 +333,55 @@ struct AlignPointerCommand : Command {
         : Command(AlignPointer), alignment(align), use_exceptions(exc) {}
 };
 
+struct SkipFieldCommand : Command {
+    const ir::type_ref* field_type;  // Type being skipped (strings scan for their terminator)
+    const ir::expr* count_expr;      // Element count for runtime-sized arrays, else null
+    size_t byte_size;                // Total bytes, or bytes per element with count_expr
+    bool use_exceptions;
+
+    SkipFieldCommand(const ir::type_ref* ftype, const ir::expr* count, size_t bytes, bool exc)
+        : Command(SkipField), field_type(ftype), count_expr(count), byte_size(bytes), use_exceptions(exc) {}
+};
+
+struct ReadSubstreamCommand : Command {
+    std::string field_name;
+    const ir::type_ref* field_type;       // Type parsed from the decoded bytes
+    const ir::substream_def* substream;   // Region size and byte transform
+    bool use_exceptions;
+
+    ReadSubstreamCommand(const std::string& name, const ir::type_ref* ftype,
+                         const ir::substream_def* sub, bool exc)
+        : Command(ReadSubstream), field_name(name), field_type(ftype), substream(sub), use_exceptions(exc) {}
+};
+
+struct ResetFieldCommand : Command {
+    std::string field_name;
+    const ir::type_ref* field_type;  // Strings and vectors are cleared, keeping their capacity
+    bool out_of_line = false;        // std::optional / Boxed member: emptied instead
+
+    ResetFieldCommand(const std::string& name, const ir::type_ref* ftype)
+        : Command(ResetField), field_name(name), field_type(ftype) {}
+};
+
+/// Construct the value of an out-of-line conditional field; the reads that
+/// follow (up to the matching MarkPresent) target the constructed value
+struct EmplaceFieldCommand : Command {
+    std::string field_name;
+
+    explicit EmplaceFieldCommand(const std::string& name)
+        : Command(EmplaceField), field_name(name) {}
+};
+
+/// Record that a conditional field was read: obj.presence_ bit `bit` of `bit_count`
+struct MarkPresentCommand : Command {
+    std::string field_name;
+    size_t bit;
+    size_t bit_count;  // Conditional fields in the struct (selects the mask type)
+
+    MarkPresentCommand(const std::string& name, size_t b, size_t count)
+        : Command(MarkPresent), field_name(name), bit(b), bit_count(count) {}
+};
+
 // ============================================================================
 // Array Commands
 // ============================================================================
@@ -333,6 +394,14 @@ struct ResizeArrayCommand : Command {
         : Command(ResizeArray), array_name(arr), size_expr(size) {}
 };
 
+struct ReserveArrayCommand : Command {
+    std::string array_name;            // Qualified array
+    const ir::type_ref* element_type;  // Sizes the reservation from its wire size
+
+    ReserveArrayCommand(const std::string& arr, const ir::type_ref* etype)
+        : Command(ReserveArray), array_name(arr), element_type(etype) {}
+};
+
 struct AppendToArrayCommand : Command {
     std::string array_name;
     const ir::type_ref* element_type;
@@ -342,6 +411,19 @@ struct AppendToArrayCommand : Command {
         : Command(AppendToArray), array_name(arr), element_type(etype), use_exceptions(exc) {}
 };
 
+struct ReadPrimitiveArrayCommand : Command {
+    std::string array_name;            // Qualified array (already sized)
+    const ir::type_ref* element_type;  // Fixed-width element type
+    const ir::expr* count_expr;        // Number of elements to read (nullptr: all remaining input)
+    ir::array_transform transform;     // Delta reconstruction fused into the read
+    bool use_exceptions;
+
+    ReadPrimitiveArrayCommand(const std::string& arr, const ir::type_ref* etype,
+                              const ir::expr* count, ir::array_transform xform, bool exc)
+        : Command(ReadPrimitiveArray), array_name(arr), element_type(etype),
+          count_expr(count), transform(xform), use_exceptions(exc) {}
+};
+
 // ============================================================================
 // Control Flow Commands
 // ============================================================================
@@ -503,6 +585,17 @@ struct AssignChoiceWrapperCommand : Command {
         : Command(AssignChoiceWrapper), target(tgt), wrapper_type(wrapper), source_var(src) {}
 };
 
+/// Evaluate a pure parameterless member function into a local variable.
+/// Later calls to the function in the same method render as the variable.
+struct MemoizeCallCommand : Command {
+    std::string var_name;               // Local variable: "_memo_payload_size"
+    const ir::function_def* function;   // Pure function (provides name and return type)
+    const ir::expr* call_expr;          // The call itself: payload_size()
+
+    MemoizeCallCommand(const std::string& var, const ir::function_def* func, const ir::expr* call)
+        : Command(MemoizeCall), var_name(var), function(func), call_expr(call) {}
+};
+
 // ============================================================================
 // Bitfield Operations (Language-Agnostic)
 // ============================================================================
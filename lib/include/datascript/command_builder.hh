@@ -7,6 +7,8 @@
 #include <datascript/codegen_commands.hh>
 #include <datascript/base_renderer.hh>  // For ExprContext
 #include <datascript/codegen.hh>  // For cpp_options
+#include <datascript/codegen/presence.hh>
+#include <datascript/codegen/projection.hh>
 
 namespace datascript::codegen {
 
@@ -185,6 +187,43 @@ public:
         constraints_ = constraints;
     }
 
+    /**
+     * Set projected readers to generate.
+     * Structs listed in the plan get a read_projected() method next to read().
+     */
+    void set_projections(const ProjectionPlan* projections) {
+        projections_ = projections;
+    }
+
+    /**
+     * Set boundary scanners to generate.
+     * Structs listed in the plan get a read_boundary() method that decodes
+     * only what is needed to find the end of a record (record indexes and
+     * parallel decoding). Kept apart from set_projections() so a user
+     * projection of the same struct cannot change what the scanner does.
+     */
+    void set_boundary_scanners(const ProjectionPlan* scanners) {
+        boundary_scanners_ = scanners;
+    }
+
+    /**
+     * Enable read_into() readers (used by read_batch()).
+     * read_into() decodes into an existing object and keeps the capacity of
+     * its strings and arrays. Generated next to the exception-mode read().
+     */
+    void set_batch_readers(bool enabled) {
+        batch_readers_ = enabled;
+    }
+
+    /**
+     * Set presence tracking for conditional fields.
+     * Readers set a struct's presence_ bit for every conditional field they
+     * decode and construct out-of-line fields before reading into them.
+     */
+    void set_presence(const PresencePlan* presence) {
+        presence_ = presence;
+    }
+
     // ========================================================================
     // Component Builders (used internally and by tests)
     // ========================================================================
@@ -290,11 +329,13 @@ public:
 
     /**
      * Emit field declaration command.
+     * @param substream Set for fields decoded lazily from a transformed region
      */
     void emit_field_declaration(
         const std::string& name,
         const ir::type_ref* type,
-        const std::string& doc
+        const std::string& doc,
+        const ir::substream_def* substream = nullptr
     );
 
     /**
@@ -304,6 +345,77 @@ public:
      */
     void emit_field_read(const ir::field& field, bool use_exceptions);
 
+    /**
+     * Emit the label seek and alignment that precede a field, if any.
+     */
+    void emit_field_positioning(const ir::field& field, bool use_exceptions);
+
+    /**
+     * Emit the field reads of a struct reader body, in declaration order,
+     * into a declared or caller-owned "obj".
+     */
+    void emit_field_reads(const ir::struct_def& struct_def, bool use_exceptions);
+
+    /**
+     * Open the if statement around a conditional field. An out-of-line
+     * field that will be decoded is constructed here and targeted by the
+     * reads up to emit_conditional_end().
+     */
+    void emit_conditional_start(const ir::struct_def& struct_def, const ir::field& field,
+                                bool decoded = true);
+
+    /**
+     * Close the if statement around a conditional field. With decoded set,
+     * the field's presence bit is set first.
+     */
+    void emit_conditional_end(const ir::struct_def& struct_def, const ir::field& field, bool decoded = true);
+
+    /**
+     * Object member a read writes to: "obj.name", or "(*obj.name)" while an
+     * out-of-line field is being read.
+     */
+    std::string qualify_field(const std::string& field_name) const;
+
+    /**
+     * A pure parameterless member function a reader evaluates only once.
+     */
+    struct memoized_call {
+        const ir::function_def* function;
+        size_t ready_at;  // Index of the first field that calls it unconditionally after its inputs
+    };
+
+    /**
+     * Pick the pure parameterless member functions that the reader would
+     * otherwise call more than once after their inputs are decoded, ordered
+     * by the point where they can be evaluated. A function is evaluated
+     * before the first field that calls it on every input, never earlier,
+     * so guards that keep it from faulting still apply.
+     */
+    std::vector<memoized_call> plan_memoized_calls(const ir::struct_def& struct_def) const;
+
+    /**
+     * Emit the evaluations of the memoized functions whose inputs are all
+     * decoded before field_index, advancing next past them.
+     */
+    void emit_memoized_calls(const std::vector<memoized_call>& memoized, size_t& next,
+                             size_t field_index);
+
+    /**
+     * Emit a read_into() method that decodes into a caller-owned object,
+     * resetting only the fields a read might otherwise leave stale.
+     */
+    void emit_into_reader(const ir::struct_def& struct_def);
+
+    /**
+     * Emit a projected reader named method_name (read_projected,
+     * read_projected_safe or read_boundary) that decodes only the fields
+     * the plan marks for decoding and skips the rest. Nested projected
+     * structs are read with their method of the same name.
+     */
+    void emit_projected_reader(const ir::struct_def& struct_def,
+                               const std::vector<field_projection>& projection,
+                               const std::string& method_name, bool use_exceptions);
+
     /**
      * Emit optimized reading for a sequence of consecutive bitfields.
      * Returns the index of the first non-bitfield after the sequence.
@@ -481,11 +593,13 @@ private:
     );
 
     /**
-     * Emit commands to read an array field.
+     * Emit commands to read an array field, applying the field's
+     * array transform (if any) while reading.
      */
     void emit_array_field_read(
         const std::string& field_name,
         const ir::type_ref& field_type,
+        ir::array_transform transform,
         bool use_exceptions
     );
 
@@ -496,6 +610,7 @@ private:
         const std::string& field_name,
         const ir::type_ref& element_type,
         uint64_t array_size,
+        ir::array_transform transform,
         bool use_exceptions
     );
 
@@ -506,6 +621,7 @@ private:
         const std::string& field_name,
         const ir::type_ref& element_type,
         const ir::expr* size_expr,
+        ir::array_transform transform,
         bool use_exceptions
     );
 
@@ -516,6 +632,7 @@ private:
         const std::string& field_name,
         const ir::type_ref& element_type,
         const ir::expr* size_expr,
+        ir::array_transform transform,
         bool use_exceptions
     );
 
@@ -528,11 +645,14 @@ private:
         const ir::expr* size_expr,
         const ir::expr* min_expr,
         const ir::expr* max_expr,
+        ir::array_transform transform,
         bool use_exceptions
     );
 
     /**
      * Emit commands to read an unbounded array (reads until end of data).
+     * Bulk elements are read in one run sized by the remaining bytes; other
+     * arrays reserve capacity from them before the append loop.
      */
     void emit_unbounded_array_read(
         const std::string& field_name,
@@ -540,6 +660,21 @@ private:
         bool use_exceptions
     );
 
+    /**
+     * Emit a single bulk read for arrays of fixed-width elements that decode
+     * without per-element work (float32/float64), or whose values are
+     * reconstructed by an array transform (@delta etc.). A null count_expr
+     * reads every remaining element (unbounded T[]).
+     * Returns false if the array needs the per-element loop.
+     */
+    bool emit_bulk_array_read(
+        const std::string& qualified_field,
+        const ir::type_ref& element_type,
+        const ir::expr* count_expr,
+        ir::array_transform transform,
+        bool use_exceptions
+    );
+
     /**
      * Emit commands to read a single array element.
      */
@@ -603,6 +738,21 @@ private:
     // Module choices (for choice field reading)
     const std::vector<ir::choice_def>* choices_ = nullptr;
 
+    // Projected readers to generate (null when none were requested)
+    const ProjectionPlan* projections_ = nullptr;
+
+    // Boundary scanners to generate (null when no struct needs one)
+    const ProjectionPlan* boundary_scanners_ = nullptr;
+
+    // Generate read_into() next to read() (--cpp-batch-decode)
+    bool batch_readers_ = false;
+
+    // Presence bits and out-of-line storage of conditional fields (null: none)
+    const PresencePlan* presence_ = nullptr;
+
+    // Out-of-line field being read between emit_conditional_start/end
+    std::string out_of_line_field_;
+
     // ========================================================================
     // Expression Ownership
     // ========================================================================
@@ -47,6 +47,9 @@ enum class type_kind {
     uint8, uint16, uint32, uint64, uint128,
     int8, int16, int32, int64, int128,
 
+    // IEEE-754 floating-point types (binary32 / binary64)
+    float32, float64,
+
     // Other primitives
     boolean,
     string,
@@ -69,6 +72,22 @@ enum class type_kind {
     array_ranged
 };
 
+// Reconstruction applied to the wire values of an integer array (@delta etc.)
+enum class array_transform {
+    none,
+    delta,           // value[i] = value[i-1] + wire[i]
+    delta_of_delta,  // d[i] = d[i-1] + wire[i]; value[i] = value[i-1] + d[i]
+    zigzag_delta     // value[i] = value[i-1] + zigzag_decode(wire[i])
+};
+
+// Byte transform undone on a length-delimited region before it is parsed (@xor etc.)
+enum class byte_transform {
+    xor_key,       // byte ^ key
+    rotate_left,   // rotl(byte, bits)
+    rotate_right,  // rotr(byte, bits)
+    zlib           // zlib (RFC 1950) inflate
+};
+
 enum class endianness {
     little,
     big,
@@ -273,6 +292,14 @@ struct constraint_def {
 // Fields and Types
 // ============================================================================
 
+// Substream: the field is parsed from `size` bytes after undoing a byte
+// transform, lazily on first access
+struct substream_def {
+    byte_transform transform = byte_transform::xor_key;
+    expr size;                       // Region length in bytes
+    std::optional<expr> parameter;   // xor key or rotate bit count
+};
+
 struct field {
     std::string name;
     type_ref type;
@@ -309,6 +336,16 @@ struct field {
     // Alignment: pad to N-byte boundary before reading the field
     std::optional<uint64_t> alignment;
 
+    // Array transform: values are reconstructed from deltas while reading
+    array_transform transform = array_transform::none;
+
+    // Substream transform: parsed from a transformed byte region (@zlib etc.)
+    std::optional<substream_def> substream;
+
+    // Runtime-length arrays: most elements one decode can produce, from
+    // semantic analysis (std::nullopt = unbounded)
+    std::optional<uint64_t> max_count;
+
     std::string documentation;
 };
 
@@ -344,9 +381,23 @@ struct function_def {
     std::vector<function_param> parameters;
     std::vector<statement> body;
 
+    // Computed by semantic analysis: the result depends only on these
+    // fields (and on parameters and constants), so readers may evaluate a
+    // call once after the last of them is decoded
+    bool is_pure = false;
+    std::vector<std::string> input_fields;
+
     std::string documentation;
 };
 
+// Wire size and heap bounds of one decode (std::nullopt = unbounded),
+// from semantic analysis
+struct size_bounds {
+    size_t min_wire_size = 0;
+    std::optional<size_t> max_wire_size;
+    std::optional<size_t> max_heap_bytes;
+};
+
 struct struct_def {
     std::string name;
     source_location source;
@@ -357,6 +408,8 @@ struct struct_def {
     size_t total_size;
     size_t alignment;
 
+    std::optional<size_bounds> bounds;
+
     std::string documentation;
 };
 
@@ -407,6 +460,8 @@ struct union_def {
     size_t size;
     size_t alignment;
 
+    std::optional<size_bounds> bounds;
+
     std::string documentation;
 };
 
@@ -450,6 +505,8 @@ struct choice_def {
     size_t size;
     size_t alignment;
 
+    std::optional<size_bounds> bounds;
+
     std::string documentation;
 };
 
@@ -109,6 +109,9 @@ private:
     // Convert Kaitai expression string to IR expression
     ir::expr map_expression(const std::string& expr_str);
 
+    // Convert 'process: xor(k) / rol(n) / ror(n) / zlib' plus 'size' to a substream
+    ir::substream_def map_process(const std::string& process, const fkyaml::node& item);
+
     // Throw error for unsupported feature
     [[noreturn]] void unsupported(const std::string& feature,
                                    const std::string& message);
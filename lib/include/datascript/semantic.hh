@@ -84,6 +84,7 @@ enum class diagnostic_level {
 /// - W020-W029: Size and alignment warnings
 /// - W030-W039: Type usage warnings (truncation, sign mismatch)
 /// - W040-W049: Best practice warnings
+/// - W050-W059: Decode performance warnings
 namespace diag_codes {
     // === Errors (E_xxx) ===
 
@@ -125,6 +126,9 @@ namespace diag_codes {
     // Configuration errors (E050-E059)
     constexpr const char* E_UNKNOWN_TARGET_LANGUAGE = "E050";  ///< Unknown/unregistered target language in analysis options
 
+    // Directive errors (E060-E069)
+    constexpr const char* E_INVALID_DIRECTIVE = "E060";     ///< Directive is unknown or misplaced (e.g., @delta on a non-array field)
+
     // === Warnings (W_xxx) ===
 
     // Unused symbols (W001-W009)
@@ -155,6 +159,13 @@ namespace diag_codes {
     constexpr const char* W_MISSING_DOCSTRING = "W040";     ///< Public symbol lacks documentation
     constexpr const char* W_DEPRECATED = "W041";            ///< Using deprecated feature
     constexpr const char* W_TODO_COMMENT = "W042";          ///< TODO comment found in code
+
+    // Decode performance (W050-W059)
+    constexpr const char* W_UNBOUNDED_STRUCT_ARRAY = "W050"; ///< T[] of structs, decoded until the input ends
+    constexpr const char* W_TRIAL_DECODING = "W051";         ///< Union case can only be rejected by decoding it
+    constexpr const char* W_UNBOUNDED_COUNT = "W052";        ///< Array length read from a field with no upper bound
+    constexpr const char* W_BACKWARD_SEEK = "W053";          ///< Label seeks back over bytes already read
+    constexpr const char* W_LARGE_CHOICE = "W054";           ///< Choice has too many cases for linear dispatch
 }
 
 /// A single diagnostic message (error, warning, or note).
@@ -353,6 +364,58 @@ struct type_info {
     std::optional<size_t> max_size;  ///< Maximum size for ranged arrays
 };
 
+/// Largest element count of one runtime-length array field (Phase 5).
+struct array_count_bound {
+    std::string field;                  ///< Array field name
+    std::optional<uint64_t> max_count;  ///< Most elements a decode can produce (nullopt: unbounded)
+    std::vector<std::string> inputs;    ///< Fields and parameters the count is computed from
+};
+
+/// Wire size and heap bounds of one struct, union or choice (Phase 5).
+///
+/// Maxima follow from constant array lengths, ranged array maxima, the
+/// value ranges of the fields and parameters an array count is read from
+/// (their integer width, narrowed by constraints such as 'n <= 64' and by
+/// subtypes) and the largest union or choice case. std::nullopt means the
+/// input alone decides: strings, T[] arrays, counts computed by function
+/// calls, and bounds that overflow size_t.
+///
+/// Heap bytes count the element storage of std::vector and std::string
+/// members a decode allocates, using the in-memory size of decoded values
+/// under an LP64 model (24-byte std::vector, 32-byte std::string,
+/// std::optional and std::variant with a trailing one-byte flag).
+struct wire_bounds {
+    size_t min_size = 0;                   ///< Fewest bytes a successful decode consumes
+    std::optional<size_t> max_size;        ///< Furthest byte past the start a decode can touch
+    std::optional<size_t> max_heap_bytes;  ///< Most bytes a decode can allocate
+    std::vector<array_count_bound> arrays; ///< Runtime-length array fields, in declaration order
+};
+
+/// Static estimate of the work one decode of a type does (Phase 8).
+///
+/// Counts follow the shape of the generated readers: every scalar read is
+/// bounds checked and can throw, strings and vectors allocate, and
+/// conditions, loop tests, checks and case comparisons branch. A union
+/// counts every case, since in the worst case each one is tried; a choice
+/// counts its comparisons plus its most expensive case. A loop whose trip
+/// count comes from the input contributes a single element and is counted
+/// in runtime_loops, so the real cost scales with the data.
+struct decode_cost {
+    size_t checked_reads = 0;  ///< Bounds-checked reads
+    size_t branches = 0;       ///< Conditions, loop tests, checks and case comparisons
+    size_t allocations = 0;    ///< Heap allocations (strings, vectors)
+    size_t throw_sites = 0;    ///< Operations that throw on malformed input
+    size_t runtime_loops = 0;  ///< Loops whose trip count comes from the input
+};
+
+/// Decode cost of one struct, union or choice (Phase 8).
+struct type_decode_cost {
+    std::string name;          ///< Type name as declared
+    std::string kind;          ///< "struct", "union" or "choice"
+    ast::source_pos position;  ///< Declaration position
+    decode_cost cost;
+};
+
 // ============================================================================
 // Analyzed Module Set
 // ============================================================================
@@ -364,9 +427,10 @@ struct type_info {
 /// - Resolved type references (Phase 2)
 /// - Expression types (Phase 3)
 /// - Constant values (Phase 4)
-/// - Type sizes and field offsets (Phase 5)
+/// - Type sizes, field offsets and wire size bounds (Phase 5)
 /// - Constraint validation results (Phase 6)
 /// - Reachability information (Phase 7)
+/// - Decode cost estimates (Phase 8, optional)
 ///
 /// Access patterns:
 ///   // Get size of a struct
@@ -435,6 +499,24 @@ struct analyzed_module_set {
     /// Only populated for choices where selector is std::nullopt.
     std::map<const ast::choice_def*, ast::primitive_type> choice_discriminator_types;
 
+    /// Pure struct member functions (Phase 3).
+    /// Maps each function whose result depends only on the struct's fields,
+    /// parameters and constants to the fields it reads, directly or through
+    /// calls to other member functions. Recursive functions and functions
+    /// that call unknown functions are absent. Readers use this to evaluate
+    /// a call once, after its last input field is decoded.
+    std::map<const ast::function_def*, std::set<std::string>> pure_functions;
+
+    /// Wire size and heap bounds of every struct, union and choice (Phase 5).
+    /// Keyed by definition; see wire_bounds.
+    std::map<resolved_type, wire_bounds> type_bounds;
+
+    /// Decode cost estimates (Phase 8).
+    /// One entry per struct, union and choice (in that order within each
+    /// module), main module first. Only filled when
+    /// analysis_options::check_decode_cost is set.
+    std::vector<type_decode_cost> decode_costs;
+
     /// Get symbols for a specific package.
     /// @param package_name Fully-qualified package name
     /// @return Pointer to module_symbols or nullptr
@@ -566,12 +648,24 @@ struct analysis_options {
     /// Generates W_INEFFICIENT_LAYOUT and W_ALIGNMENT_PADDING warnings.
     bool check_layout_efficiency = false;
 
+    /// Estimate the decode cost of every type and warn about schema
+    /// patterns that make generated readers slow or unbounded.
+    /// Fills analyzed.decode_costs and generates W050-W054 warnings.
+    bool check_decode_cost = false;
+
     /// Target programming languages for code generation.
     /// When specified, identifiers are validated against keywords in these languages.
     /// Empty set (default) checks against all registered languages.
     /// Example: {"cpp", "rust", "python"}
     /// Generates W_KEYWORD_COLLISION warnings.
     std::set<std::string> target_languages;
+
+    /// Number of worker threads for the parallel phases (2-7).
+    /// - 1: Run everything on the calling thread (default)
+    /// - 0: Use one thread per hardware thread
+    /// Diagnostics and results are identical for every setting; per-worker
+    /// diagnostic buffers are merged in module/declaration order.
+    size_t jobs = 1;
 };
 
 // ============================================================================
@@ -588,6 +682,7 @@ struct analysis_options {
 ///   5. Size Calculation     - Calculate struct layouts and type sizes
 ///   6. Constraint Validation- Check constraints and conditions
 ///   7. Reachability Analysis- Detect unused symbols
+///   8. Decode Cost Analysis - Estimate reader cost (check_decode_cost only)
 ///
 /// The analysis stops after any phase that produces errors (if stop_on_first_error
 /// is set), but warnings don't prevent later phases from running.
@@ -614,6 +709,20 @@ struct analysis_options {
 analysis_result analyze(module_set& modules,
                         const analysis_options& opts = {});
 
+/// Format analyzed.type_bounds as a JSON document.
+///
+/// One object per struct, union and choice (main module first, structs
+/// before unions before choices) with min_wire_size, max_wire_size,
+/// max_heap_bytes and the bounds of runtime-length array fields. Unbounded
+/// values are null.
+std::string format_size_report(const analyzed_module_set& analyzed);
+
+/// Format analyzed.decode_costs as a fixed-width table, one row per type.
+///
+/// Columns are reads, branches, allocations, throw sites and runtime loops
+/// (see decode_cost). Returns an empty string when no costs were computed.
+std::string format_cost_report(const analyzed_module_set& analyzed);
+
 // ============================================================================
 // Individual Phases (for testing and incremental analysis)
 // ============================================================================
@@ -681,10 +790,12 @@ symbol_table collect_symbols(
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires symbols from Phase 1)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void resolve_names(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
 
 /// Phase 3: Type Checking
 ///
@@ -698,15 +809,17 @@ void resolve_names(
 /// - Array indexing on array types
 /// - Assignment type compatibility
 ///
-/// Populates: analyzed.expression_types
+/// Populates: analyzed.expression_types, analyzed.pure_functions
 ///
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires Phase 2)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void check_types(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
 
 /// Phase 4: Constant Evaluation
 ///
@@ -722,13 +835,18 @@ void check_types(
 ///
 /// Populates: analyzed.constant_values
 ///
+/// Constants are grouped into topological levels of their dependency graph;
+/// each level is evaluated concurrently when jobs != 1.
+///
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires Phase 3)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void evaluate_constants(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
 
 /// Utility: Evaluate Constant Expression to uint64
 ///
@@ -782,10 +900,29 @@ std::optional<uint64_t> evaluate_constant_uint(
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires Phase 4)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void calculate_sizes(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
+
+/// Phase 5 (continued): Wire Size and Heap Bounds
+///
+/// Computes, for every struct, union and choice, the fewest and most
+/// bytes a decode reads and the most heap bytes it allocates (see
+/// wire_bounds). Array counts are bounded by interval arithmetic over the
+/// value ranges of the fields and parameters they are computed from.
+///
+/// Populates: analyzed.type_bounds
+///
+/// @param modules Module set being analyzed
+/// @param analyzed Analysis result to populate (requires Phase 4)
+/// @param jobs Worker threads (see analysis_options::jobs)
+void calculate_wire_bounds(
+    const module_set& modules,
+    analyzed_module_set& analyzed,
+    size_t jobs = 1);
 
 /// Phase 6: Constraint Validation
 ///
@@ -802,10 +939,12 @@ void calculate_sizes(
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires Phase 5)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void validate_constraints(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
 
 /// Phase 7: Reachability and Dependency Analysis
 ///
@@ -825,10 +964,36 @@ void validate_constraints(
 /// @param modules Module set being analyzed
 /// @param analyzed Analysis result to populate (requires Phase 6)
 /// @param diagnostics Output vector for error/warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
 void analyze_reachability(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics);
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
+
+/// Phase 8: Decode Cost Analysis (optional)
+///
+/// Estimates what a generated reader does per decode of every struct,
+/// union and choice (see decode_cost) and warns about patterns that make
+/// decoding slow or let malformed input dictate the amount of work:
+/// - Unbounded T[] arrays of structs (W_UNBOUNDED_STRUCT_ARRAY)
+/// - Unions whose cases are rejected by trial decoding (W_TRIAL_DECODING)
+/// - Array lengths read from unconstrained wide fields (W_UNBOUNDED_COUNT)
+/// - Labels that seek back over bytes already read (W_BACKWARD_SEEK)
+/// - Choices with too many cases for if-chain dispatch (W_LARGE_CHOICE)
+///
+/// Costs cover every module (main first); warnings are only issued for
+/// the main module, like Phase 7.
+///
+/// @param modules Module set being analyzed
+/// @param analyzed Analysis result to populate (requires Phases 2-4)
+/// @param diagnostics Output vector for warning messages
+/// @param jobs Worker threads (see analysis_options::jobs)
+void analyze_decode_cost(
+    const module_set& modules,
+    analyzed_module_set& analyzed,
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs = 1);
 
 } // namespace phases
 
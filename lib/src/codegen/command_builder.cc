@@ -5,6 +5,7 @@
 //
 
 #include <datascript/command_builder.hh>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 
@@ -71,12 +72,122 @@ namespace {
             case ir::type_kind::int32:
             case ir::type_kind::int64:
             case ir::type_kind::int128:
+            case ir::type_kind::float32:
+            case ir::type_kind::float64:
                 return true;
             default:
                 return false;
         }
     }
 
+    // Element types whose arrays are decoded with one bounds check and a
+    // block copy (plus byte swap when the wire order differs from the host)
+    bool is_bulk_array_element(const ir::type_ref& type) {
+        return type.kind == ir::type_kind::float32 ||
+               type.kind == ir::type_kind::float64;
+    }
+
+    // Integers the bulk readers can copy: 128-bit values have no machine word
+    bool is_fixed_width_integer(const ir::type_ref& type) {
+        switch (type.kind) {
+            case ir::type_kind::uint8:
+            case ir::type_kind::uint16:
+            case ir::type_kind::uint32:
+            case ir::type_kind::uint64:
+            case ir::type_kind::int8:
+            case ir::type_kind::int16:
+            case ir::type_kind::int32:
+            case ir::type_kind::int64:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Calls to the parameterless member function `name` in e
+    size_t count_calls(const ir::expr& e, const std::string& name) {
+        size_t count = (e.type == ir::expr::function_call && e.arguments.empty() && e.ref_name == name) ? 1 : 0;
+        for (const ir::expr* child : {e.left.get(), e.right.get(), e.condition.get(),
+                                      e.true_expr.get(), e.false_expr.get()}) {
+            if (child) {
+                count += count_calls(*child, name);
+            }
+        }
+        for (const auto& argument : e.arguments) {
+            count += count_calls(*argument, name);
+        }
+        return count;
+    }
+
+    // Whether evaluating e always calls name(): calls behind the right side
+    // of && and || or a branch of ?: may be skipped and do not count
+    bool calls_unconditionally(const ir::expr& e, const std::string& name) {
+        if (e.type == ir::expr::function_call && e.arguments.empty() && e.ref_name == name) {
+            return true;
+        }
+        if (e.type == ir::expr::ternary_op) {
+            return e.condition && calls_unconditionally(*e.condition, name);
+        }
+        if (e.left && calls_unconditionally(*e.left, name)) {
+            return true;
+        }
+        if (e.right && e.op != ir::expr::logical_and && e.op != ir::expr::logical_or &&
+            calls_unconditionally(*e.right, name)) {
+            return true;
+        }
+        for (const auto& argument : e.arguments) {
+            if (calls_unconditionally(*argument, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether reading field always calls name(). A conditional field only
+    // evaluates its condition for sure; everything else is behind the guard.
+    bool field_calls_unconditionally(const ir::field& field, const std::string& name) {
+        if (field.default_value && calls_unconditionally(*field.default_value, name)) {
+            return true;
+        }
+        if (field.condition == ir::field::runtime && field.runtime_condition) {
+            return calls_unconditionally(*field.runtime_condition, name);
+        }
+        const ir::expr* size = field.type.array_size_expr ? field.type.array_size_expr.get()
+                                                          : field.type.min_size_expr.get();
+        for (const ir::expr* e : {field.label ? &*field.label : nullptr,
+                                  field.inline_constraint ? &*field.inline_constraint : nullptr, size}) {
+            if (e && calls_unconditionally(*e, name)) {
+                return true;
+            }
+        }
+        for (const auto& argument : field.type.choice_selector_args) {
+            if (calls_unconditionally(*argument, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Evaluations of name() by the expressions in a field type. An array
+    // dimension counts twice: it sizes the array and bounds every iteration
+    // of the element loop. Expressions of the element type repeat per element.
+    size_t count_type_calls(const ir::type_ref& type, const std::string& name, size_t weight) {
+        size_t count = 0;
+        for (const ir::expr* dimension : {type.array_size_expr.get(), type.min_size_expr.get(),
+                                          type.max_size_expr.get()}) {
+            if (dimension) {
+                count += 2 * weight * count_calls(*dimension, name);
+            }
+        }
+        for (const auto& argument : type.choice_selector_args) {
+            count += weight * count_calls(*argument, name);
+        }
+        if (type.element_type) {
+            count += count_type_calls(*type.element_type, name, 2 * weight);
+        }
+        return count;
+    }
+
 }
 
 // ============================================================================
@@ -100,7 +211,7 @@ std::vector<CommandPtr> CommandBuilder::build_struct_reader(
 
     // Emit field declarations
     for (const auto& field : struct_def.fields) {
-        emit_field_declaration(field.name, &field.type, "");
+        emit_field_declaration(field.name, &field.type, "", field.substream ? &*field.substream : nullptr);
     }
 
     // Start read() method - renderer will format signature based on method kind and error handling
@@ -118,44 +229,7 @@ std::vector<CommandPtr> CommandBuilder::build_struct_reader(
     // Declare object variable: StructName obj;
     emit_variable_declaration("obj", &struct_def);
 
-    // Emit field reads (with special handling for consecutive bitfields)
-    size_t i = 0;
-    while (i < struct_def.fields.size()) {
-        const auto& field = struct_def.fields[i];
-
-        // Initialize field with default value if specified
-        if (field.default_value) {
-            emit_comment("Initialize field '" + field.name + "' with default value");
-            emit_variable_assignment("obj." + field.name, &field.default_value.value());
-        }
-
-        // Check if field is conditional (runtime condition)
-        bool is_conditional = (field.condition == ir::field::runtime && field.runtime_condition.has_value());
-
-        if (is_conditional) {
-            // Wrap conditional field read in if statement
-            emit_comment("Conditional field: " + field.name);
-            emit_if(&field.runtime_condition.value());
-        }
-
-        // Check if this starts a sequence of bitfields
-        if (field.type.kind == ir::type_kind::bitfield && field.type.bit_width.has_value()) {
-            // Batch consecutive bitfields together
-            i = emit_bitfield_sequence(struct_def.fields, i, use_exceptions);
-        } else if (field.condition == ir::field::always || is_conditional) {
-            // Normal field read (only if not skipped)
-            emit_field_read(field, use_exceptions);
-            emit_field_constraints(field, use_exceptions);
-            i++;
-        } else {
-            // Skip fields with condition == never
-            i++;
-        }
-
-        if (is_conditional) {
-            emit_end_if();
-        }
-    }
+    emit_field_reads(struct_def, use_exceptions);
 
     // Return the object
     if (use_exceptions) {
@@ -177,6 +251,24 @@ std::vector<CommandPtr> CommandBuilder::build_struct_reader(
     }
 
     emit_method_end();
+
+    // Projected reader (--cpp-project)
+    if (const auto* projection = projections_ ? projections_->find(struct_def) : nullptr) {
+        emit_projected_reader(struct_def, *projection,
+                              use_exceptions ? "read_projected" : "read_projected_safe", use_exceptions);
+    }
+
+    // Boundary scanner (--cpp-record-index, --cpp-parallel-decode)
+    if (const auto* scanner = boundary_scanners_ ? boundary_scanners_->find(struct_def) : nullptr;
+        scanner && use_exceptions) {
+        emit_projected_reader(struct_def, *scanner, "read_boundary", true);
+    }
+
+    // Capacity-reusing reader for read_batch() (--cpp-batch-decode)
+    if (batch_readers_ && use_exceptions) {
+        emit_into_reader(struct_def);
+    }
+
     emit_struct_end();
 
     return scope.take_commands();  // Success: transfer command ownership
@@ -206,11 +298,10 @@ std::vector<CommandPtr> CommandBuilder::build_standalone_reader(
     for (const auto& field : struct_def.fields) {
         // Handle conditional fields
         if (field.condition == ir::field::runtime && field.runtime_condition.has_value()) {
-            emit_comment("Conditional field: " + field.name);
-            emit_if(&field.runtime_condition.value());
+            emit_conditional_start(struct_def, field);
             emit_field_read(field, use_exceptions);
             emit_field_constraints(field, use_exceptions);
-            emit_end_if();
+            emit_conditional_end(struct_def, field);
         } else if (field.condition == ir::field::always) {
             emit_field_read(field, use_exceptions);
             emit_field_constraints(field, use_exceptions);
@@ -234,7 +325,8 @@ std::vector<CommandPtr> CommandBuilder::build_struct_declaration(
     emit_struct_start(struct_def.name, struct_def.documentation);
 
     for (const auto& field : struct_def.fields) {
-        emit_field_declaration(field.name, &field.type, "");  // Pass IR type, not C++ string
+        emit_field_declaration(field.name, &field.type, "",  // Pass IR type, not C++ string
+                               field.substream ? &*field.substream : nullptr);
     }
 
     emit_struct_end();
@@ -741,9 +833,12 @@ void CommandBuilder::emit_method_end() {
 void CommandBuilder::emit_field_declaration(
     const std::string& name,
     const ir::type_ref* type,
-    const std::string& doc
+    const std::string& doc,
+    const ir::substream_def* substream
 ) {
-    commands_.push_back(std::make_unique<DeclareFieldCommand>(name, type, doc));
+    auto cmd = std::make_unique<DeclareFieldCommand>(name, type, doc);
+    cmd->substream = substream;
+    commands_.push_back(std::move(cmd));
 }
 
 size_t CommandBuilder::emit_bitfield_sequence(
@@ -831,7 +926,7 @@ size_t CommandBuilder::emit_bitfield_sequence(
     return end_index;
 }
 
-void CommandBuilder::emit_field_read(const ir::field& field, bool use_exceptions) {
+void CommandBuilder::emit_field_positioning(const ir::field& field, bool use_exceptions) {
     // Handle label directive - seek to position before reading field
     if (field.label.has_value()) {
         emit_comment("Seek to labeled position for field '" + field.name + "'");
@@ -847,11 +942,23 @@ void CommandBuilder::emit_field_read(const ir::field& field, bool use_exceptions
             field.alignment.value(), use_exceptions
         ));
     }
+}
+
+void CommandBuilder::emit_field_read(const ir::field& field, bool use_exceptions) {
+    emit_field_positioning(field, use_exceptions);
+
+    // Substreams capture their region now and decode it on first access
+    if (field.substream) {
+        commands_.push_back(std::make_unique<ReadSubstreamCommand>(
+            field.name, &field.type, &*field.substream, use_exceptions
+        ));
+        return;
+    }
 
     // Dispatch based on field type
     // Check arrays first since they may have primitive element types
     if (is_array_type(field.type)) {
-        emit_array_field_read(field.name, field.type, use_exceptions);
+        emit_array_field_read(field.name, field.type, field.transform, use_exceptions);
     } else if (is_primitive_type(field.type)) {
         emit_primitive_field_read(field.name, field.type, use_exceptions);
     } else if (field.type.kind == ir::type_kind::string) {
@@ -872,6 +979,299 @@ void CommandBuilder::emit_field_read(const ir::field& field, bool use_exceptions
     // which is called after emit_field_read() in build_struct_reader()
 }
 
+void CommandBuilder::emit_field_reads(const ir::struct_def& struct_def, bool use_exceptions) {
+    // Pure functions used repeatedly are evaluated once, as soon as the
+    // fields they read are decoded
+    auto memoized = plan_memoized_calls(struct_def);
+    size_t next_memoized = 0;
+
+    // Emit field reads (with special handling for consecutive bitfields)
+    size_t i = 0;
+    while (i < struct_def.fields.size()) {
+        emit_memoized_calls(memoized, next_memoized, i);
+
+        const auto& field = struct_def.fields[i];
+
+        // Initialize field with default value if specified
+        if (field.default_value) {
+            emit_comment("Initialize field '" + field.name + "' with default value");
+            emit_variable_assignment("obj." + field.name, &field.default_value.value());
+        }
+
+        // Check if field is conditional (runtime condition)
+        bool is_conditional = (field.condition == ir::field::runtime && field.runtime_condition.has_value());
+
+        if (is_conditional) {
+            // Wrap conditional field read in if statement
+            emit_conditional_start(struct_def, field);
+        }
+
+        // Check if this starts a sequence of bitfields
+        if (field.type.kind == ir::type_kind::bitfield && field.type.bit_width.has_value()) {
+            // Batch consecutive bitfields together
+            i = emit_bitfield_sequence(struct_def.fields, i, use_exceptions);
+        } else if (field.condition == ir::field::always || is_conditional) {
+            // Normal field read (only if not skipped)
+            emit_field_read(field, use_exceptions);
+            emit_field_constraints(field, use_exceptions);
+            i++;
+        } else {
+            // Skip fields with condition == never
+            i++;
+        }
+
+        if (is_conditional) {
+            emit_conditional_end(struct_def, field);
+        }
+    }
+}
+
+void CommandBuilder::emit_conditional_start(const ir::struct_def& struct_def, const ir::field& field,
+                                            bool decoded) {
+    emit_comment("Conditional field: " + field.name);
+    emit_if(&field.runtime_condition.value());
+
+    const auto* presence = presence_ ? presence_->find(struct_def.name) : nullptr;
+    const auto* member = presence ? presence->find(field.name) : nullptr;
+    if (member && member->out_of_line && decoded) {
+        commands_.push_back(std::make_unique<EmplaceFieldCommand>(field.name));
+        out_of_line_field_ = field.name;
+    }
+}
+
+void CommandBuilder::emit_conditional_end(const ir::struct_def& struct_def, const ir::field& field,
+                                          bool decoded) {
+    const auto* presence = presence_ ? presence_->find(struct_def.name) : nullptr;
+    const auto* member = presence ? presence->find(field.name) : nullptr;
+    if (member && decoded) {
+        commands_.push_back(std::make_unique<MarkPresentCommand>(
+            field.name, member->bit, presence->members.size()));
+    }
+    out_of_line_field_.clear();
+    emit_end_if();
+}
+
+std::string CommandBuilder::qualify_field(const std::string& field_name) const {
+    if (expr_context_.object_name.empty()) {
+        return field_name;
+    }
+    std::string qualified = expr_context_.object_name + "." + field_name;
+    return field_name == out_of_line_field_ ? "(*" + qualified + ")" : qualified;
+}
+
+std::vector<CommandBuilder::memoized_call> CommandBuilder::plan_memoized_calls(
+    const ir::struct_def& struct_def
+) const {
+    std::vector<memoized_call> result;
+
+    for (const auto& function : struct_def.functions) {
+        if (!function.is_pure || !function.parameters.empty()) {
+            continue;
+        }
+
+        // The function can be evaluated once its last input field is read
+        size_t ready_at = 0;
+        bool resolved = true;
+        for (const auto& input : function.input_fields) {
+            auto it = std::find_if(struct_def.fields.begin(), struct_def.fields.end(),
+                                   [&](const ir::field& f) { return f.name == input; });
+            if (it == struct_def.fields.end()) {
+                resolved = false;
+                break;
+            }
+            ready_at = std::max(ready_at, static_cast<size_t>(it - struct_def.fields.begin()) + 1);
+        }
+        if (!resolved) {
+            continue;
+        }
+
+        // Evaluating early must not run the function where the reader would
+        // not: a guard like "if n != 0" may be what keeps it from faulting.
+        // Wait for the first field that calls it whatever the input.
+        while (ready_at < struct_def.fields.size() &&
+               (struct_def.fields[ready_at].condition == ir::field::never ||
+                !field_calls_unconditionally(struct_def.fields[ready_at], function.name))) {
+            ++ready_at;
+        }
+
+        // Count the evaluations in the fields read from that point on
+        size_t uses = 0;
+        for (size_t i = ready_at; i < struct_def.fields.size(); ++i) {
+            const auto& field = struct_def.fields[i];
+            if (field.condition == ir::field::never) {
+                continue;
+            }
+            for (const auto* e : {field.runtime_condition ? &*field.runtime_condition : nullptr,
+                                  field.label ? &*field.label : nullptr,
+                                  field.default_value ? &*field.default_value : nullptr,
+                                  field.inline_constraint ? &*field.inline_constraint : nullptr}) {
+                if (e) {
+                    uses += count_calls(*e, function.name);
+                }
+            }
+            if (constraints_) {
+                for (const auto& app : field.constraints) {
+                    if (app.constraint_index < constraints_->size()) {
+                        uses += count_calls((*constraints_)[app.constraint_index].condition, function.name);
+                    }
+                }
+            }
+            uses += count_type_calls(field.type, function.name, 1);
+        }
+
+        if (uses >= 2) {
+            result.push_back({&function, ready_at});
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const memoized_call& a, const memoized_call& b) { return a.ready_at < b.ready_at; });
+    return result;
+}
+
+void CommandBuilder::emit_memoized_calls(
+    const std::vector<memoized_call>& memoized,
+    size_t& next,
+    size_t field_index
+) {
+    for (; next < memoized.size() && memoized[next].ready_at <= field_index; ++next) {
+        const auto& function = *memoized[next].function;
+        emit_comment("Evaluate pure function '" + function.name + "()' once; its inputs are decoded");
+
+        ir::expr call;
+        call.type = ir::expr::function_call;
+        call.ref_name = function.name;
+        commands_.push_back(std::make_unique<MemoizeCallCommand>(
+            "_memo_" + function.name, &function, create_expression(std::move(call))
+        ));
+    }
+}
+
+void CommandBuilder::emit_into_reader(const ir::struct_def& struct_def) {
+    auto method = std::make_unique<StartMethodCommand>(
+        "read_into", StartMethodCommand::MethodKind::StructReader, &struct_def, true, true);
+    method->into_existing = true;
+    commands_.push_back(std::move(method));
+
+    expr_context_.in_struct_method = true;
+    expr_context_.object_name = "obj";
+
+    // Every other field is overwritten below: scalars by assignment, strings
+    // and sized arrays in place. Fields that may be absent and arrays that
+    // append must not keep values from the previous message.
+    const auto* presence = presence_ ? presence_->find(struct_def.name) : nullptr;
+    bool reset_comment = false;
+    for (const auto& field : struct_def.fields) {
+        bool appends = field.type.kind == ir::type_kind::array_variable && !field.type.array_size_expr;
+        if (field.condition == ir::field::always && !appends) {
+            continue;
+        }
+        if (!reset_comment) {
+            emit_comment("Reset fields the previous message may have set");
+            reset_comment = true;
+        }
+        auto reset = std::make_unique<ResetFieldCommand>(field.name, &field.type);
+        const auto* member = presence ? presence->find(field.name) : nullptr;
+        reset->out_of_line = member && member->out_of_line;
+        commands_.push_back(std::move(reset));
+    }
+    if (presence) {
+        ir::type_ref mask_type;
+        mask_type.kind = ir::type_kind::uint64;
+        commands_.push_back(std::make_unique<ResetFieldCommand>("presence_", create_type(std::move(mask_type))));
+    }
+
+    emit_field_reads(struct_def, true);
+    emit_method_end();
+}
+
+void CommandBuilder::emit_projected_reader(
+    const ir::struct_def& struct_def,
+    const std::vector<field_projection>& projection,
+    const std::string& method_name,
+    bool use_exceptions
+) {
+    auto method = std::make_unique<StartMethodCommand>(
+        method_name, StartMethodCommand::MethodKind::StructReader, &struct_def, use_exceptions, true);
+    method->projected = true;
+    commands_.push_back(std::move(method));
+    emit_variable_declaration("obj", &struct_def);
+
+    expr_context_.in_struct_method = true;
+    expr_context_.object_name = "obj";
+
+    size_t i = 0;
+    while (i < struct_def.fields.size()) {
+        const auto& field = struct_def.fields[i];
+        if (field.condition == ir::field::never) {
+            i++;
+            continue;
+        }
+
+        // Bitfields are always decoded, as a group
+        if (field.type.kind == ir::type_kind::bitfield && field.type.bit_width.has_value()) {
+            i = emit_bitfield_sequence(struct_def.fields, i, use_exceptions);
+            continue;
+        }
+
+        const auto& action = projection[i];
+        bool decoded = action.action == projection_action::decode ||
+                       action.action == projection_action::decode_nested;
+
+        bool is_conditional = (field.condition == ir::field::runtime && field.runtime_condition.has_value());
+        if (is_conditional) {
+            emit_conditional_start(struct_def, field, decoded);
+        }
+        switch (action.action) {
+            case projection_action::decode:
+                if (field.default_value) {
+                    emit_comment("Initialize field '" + field.name + "' with default value");
+                    emit_variable_assignment("obj." + field.name, &field.default_value.value());
+                }
+                emit_field_read(field, use_exceptions);
+                emit_field_constraints(field, use_exceptions);
+                break;
+
+            case projection_action::decode_nested: {
+                emit_field_positioning(field, use_exceptions);
+                auto read = std::make_unique<ReadFieldCommand>(field.name, &field.type, use_exceptions);
+                read->projected_reader = method_name;
+                commands_.push_back(std::move(read));
+                break;
+            }
+
+            case projection_action::skip_fixed:
+                emit_field_positioning(field, use_exceptions);
+                emit_comment("Skip field '" + field.name + "'");
+                commands_.push_back(std::make_unique<SkipFieldCommand>(
+                    &field.type, nullptr, action.byte_size, use_exceptions));
+                break;
+
+            case projection_action::skip_elements:
+                emit_field_positioning(field, use_exceptions);
+                emit_comment("Skip field '" + field.name + "'");
+                commands_.push_back(std::make_unique<SkipFieldCommand>(
+                    &field.type, field.type.array_size_expr.get(), action.byte_size, use_exceptions));
+                break;
+
+            case projection_action::skip_string:
+                emit_field_positioning(field, use_exceptions);
+                emit_comment("Skip field '" + field.name + "'");
+                commands_.push_back(std::make_unique<SkipFieldCommand>(
+                    &field.type, nullptr, 0, use_exceptions));
+                break;
+        }
+
+        if (is_conditional) {
+            emit_conditional_end(struct_def, field, decoded);
+        }
+        i++;
+    }
+
+    emit_return_value(use_exceptions ? "obj" : "result");
+    emit_method_end();
+}
+
 void CommandBuilder::emit_variable_declaration(
     const std::string& name,
     const ir::struct_def* struct_type
@@ -1093,6 +1493,7 @@ void CommandBuilder::clear() {
     owned_expressions_.clear();
     owned_types_.clear();
     scope_depth_ = 0;
+    out_of_line_field_.clear();
 }
 
 // ============================================================================
@@ -1141,6 +1542,7 @@ void CommandBuilder::emit_bool_field_read(
 void CommandBuilder::emit_array_field_read(
     const std::string& field_name,
     const ir::type_ref& field_type,
+    ir::array_transform transform,
     bool use_exceptions
 ) {
     // Determine array type based on available information
@@ -1154,6 +1556,7 @@ void CommandBuilder::emit_array_field_read(
             field_type.array_size_expr.get(),
             field_type.min_size_expr.get(),
             field_type.max_size_expr.get(),
+            transform,
             use_exceptions
         );
     } else if (field_type.kind == ir::type_kind::array_fixed || field_type.array_size.has_value()) {
@@ -1164,6 +1567,7 @@ void CommandBuilder::emit_array_field_read(
                 field_name,
                 *field_type.element_type,
                 field_type.array_size_expr.get(),
+                transform,
                 use_exceptions
             );
         } else {
@@ -1171,6 +1575,7 @@ void CommandBuilder::emit_array_field_read(
                 field_name,
                 *field_type.element_type,
                 field_type.array_size.value(),
+                transform,
                 use_exceptions
             );
         }
@@ -1182,6 +1587,7 @@ void CommandBuilder::emit_array_field_read(
             field_name,
             *field_type.element_type,
             field_type.array_size_expr.get(),
+            transform,
             use_exceptions
         );
     } else {
@@ -1199,6 +1605,7 @@ void CommandBuilder::emit_fixed_array_read(
     const std::string& field_name,
     const ir::type_ref& element_type,
     uint64_t array_size,
+    ir::array_transform transform,
     bool use_exceptions
 ) {
     // Create owned expression for array size
@@ -1207,26 +1614,30 @@ void CommandBuilder::emit_fixed_array_read(
     size_literal.int_value = array_size;
     const ir::expr* size_expr = create_expression(std::move(size_literal));
 
-    emit_fixed_array_read_expr(field_name, element_type, size_expr, use_exceptions);
+    emit_fixed_array_read_expr(field_name, element_type, size_expr, transform, use_exceptions);
 }
 
 void CommandBuilder::emit_fixed_array_read_expr(
     const std::string& field_name,
     const ir::type_ref& element_type,
     const ir::expr* size_expr,
+    ir::array_transform transform,
     bool use_exceptions
 ) {
     // Fixed-size arrays (std::array) don't need resize - they're already the right size
     // No resize command needed
 
+    // Qualify with object name if in struct context
+    std::string qualified_field = qualify_field(field_name);
+    if (emit_bulk_array_read(qualified_field, element_type, size_expr, transform, use_exceptions)) {
+        return;
+    }
+
     // Loop to read elements
     std::string index_var = "i";
     emit_loop_start(index_var, size_expr);
 
-    // Read array element - qualify with object name if in struct context
-    std::string qualified_field = expr_context_.object_name.empty()
-        ? field_name
-        : expr_context_.object_name + "." + field_name;
+    // Read array element
     std::string element_expr = qualified_field + "[" + index_var + "]";
     emit_array_element_read(element_expr, element_type, use_exceptions);
 
@@ -1237,6 +1648,7 @@ void CommandBuilder::emit_variable_array_read(
     const std::string& field_name,
     const ir::type_ref& element_type,
     const ir::expr* size_expr,
+    ir::array_transform transform,
     bool use_exceptions
 ) {
     // Resize array to size_expr
@@ -1244,14 +1656,17 @@ void CommandBuilder::emit_variable_array_read(
         field_name, size_expr
     ));
 
+    // Qualify with object name if in struct context
+    std::string qualified_field = qualify_field(field_name);
+    if (emit_bulk_array_read(qualified_field, element_type, size_expr, transform, use_exceptions)) {
+        return;
+    }
+
     // Loop to read elements using the same size expression
     std::string index_var = "i";
     emit_loop_start(index_var, size_expr, false);  // false = don't use .size(), use expression directly
 
-    // Read array element - qualify with object name if in struct context
-    std::string qualified_field = expr_context_.object_name.empty()
-        ? field_name
-        : expr_context_.object_name + "." + field_name;
+    // Read array element
     std::string element_expr = qualified_field + "[" + index_var + "]";
     emit_array_element_read(element_expr, element_type, use_exceptions);
 
@@ -1264,6 +1679,7 @@ void CommandBuilder::emit_ranged_array_read(
     const ir::expr* size_expr,
     const ir::expr* min_expr,
     const ir::expr* max_expr,
+    ir::array_transform transform,
     bool use_exceptions
 ) {
     // Ranged array: T[min..max] where size = max - min
@@ -1303,14 +1719,17 @@ void CommandBuilder::emit_ranged_array_read(
         field_name, resize_expr_ptr
     ));
 
+    // Qualify with object name if in struct context
+    std::string qualified_field = qualify_field(field_name);
+    if (emit_bulk_array_read(qualified_field, element_type, resize_expr_ptr, transform, use_exceptions)) {
+        return;
+    }
+
     // Loop to read elements
     std::string index_var = "i";
     emit_loop_start(index_var, resize_expr_ptr, false);  // false = don't use .size()
 
-    // Read array element - qualify with object name if in struct context
-    std::string qualified_field = expr_context_.object_name.empty()
-        ? field_name
-        : expr_context_.object_name + "." + field_name;
+    // Read array element
     std::string element_expr = qualified_field + "[" + index_var + "]";
     emit_array_element_read(element_expr, element_type, use_exceptions);
 
@@ -1325,14 +1744,28 @@ void CommandBuilder::emit_unbounded_array_read(
     // Unbounded array: T[] - read elements until end of data
     emit_comment("Read until end of data");
 
+    // Qualify field name with object if in struct context
+    std::string qualified_field = qualify_field(field_name);
+
+    // Fixed-width elements: the remaining bytes give the count, so the
+    // whole run is one bulk read. Integers qualify here too; counted integer
+    // arrays keep per-element reads, which the existing output pins.
+    if (is_fixed_width_integer(element_type)) {
+        commands_.push_back(std::make_unique<ReadPrimitiveArrayCommand>(
+            qualified_field, &element_type, nullptr, ir::array_transform::none, use_exceptions
+        ));
+        return;
+    }
+    if (emit_bulk_array_read(qualified_field, element_type, nullptr, ir::array_transform::none, use_exceptions)) {
+        return;
+    }
+
+    // Size the array from the remaining bytes instead of growing it per element
+    commands_.push_back(std::make_unique<ReserveArrayCommand>(qualified_field, &element_type));
+
     // Emit while loop: while (data < end)
     commands_.push_back(std::make_unique<StartWhileLoopCommand>("data < end"));
 
-    // Qualify field name with object if in struct context
-    std::string qualified_field = expr_context_.object_name.empty()
-        ? field_name
-        : expr_context_.object_name + "." + field_name;
-
     // Append element using push_back
     commands_.push_back(std::make_unique<AppendToArrayCommand>(
         qualified_field, &element_type, use_exceptions
@@ -1341,6 +1774,23 @@ void CommandBuilder::emit_unbounded_array_read(
     emit_loop_end();
 }
 
+bool CommandBuilder::emit_bulk_array_read(
+    const std::string& qualified_field,
+    const ir::type_ref& element_type,
+    const ir::expr* count_expr,
+    ir::array_transform transform,
+    bool use_exceptions
+) {
+    if (transform == ir::array_transform::none && !is_bulk_array_element(element_type)) {
+        return false;
+    }
+
+    commands_.push_back(std::make_unique<ReadPrimitiveArrayCommand>(
+        qualified_field, &element_type, count_expr, transform, use_exceptions
+    ));
+    return true;
+}
+
 void CommandBuilder::emit_array_element_read(
     const std::string& element_var,
     const ir::type_ref& element_type,
@@ -1453,7 +1903,7 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
         emit_struct_start(struct_def.name, struct_def.documentation);
 
         for (const auto& field : struct_def.fields) {
-            emit_field_declaration(field.name, &field.type, "");
+            emit_field_declaration(field.name, &field.type, "", field.substream ? &*field.substream : nullptr);
         }
 
         // Generate read methods based on error handling mode
@@ -1468,9 +1918,15 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
             expr_context_.in_struct_method = true;
             expr_context_.object_name = "obj";
 
+            // Pure functions used repeatedly are evaluated once
+            auto memoized = plan_memoized_calls(struct_def);
+            size_t next_memoized = 0;
+
             // Emit field reads (with special handling for consecutive bitfields)
             size_t i = 0;
             while (i < struct_def.fields.size()) {
+                emit_memoized_calls(memoized, next_memoized, i);
+
                 const auto& field = struct_def.fields[i];
 
                 // Initialize field with default value if specified
@@ -1486,11 +1942,10 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
                 } else {
                     // Handle conditional fields
                     if (field.condition == ir::field::runtime && field.runtime_condition.has_value()) {
-                        emit_comment("Conditional field: " + field.name);
-                        emit_if(&field.runtime_condition.value());
+                        emit_conditional_start(struct_def, field);
                         emit_field_read(field, false);
                         emit_field_constraints(field, false);
-                        emit_end_if();
+                        emit_conditional_end(struct_def, field);
                     } else if (field.condition == ir::field::always) {
                         emit_field_read(field, false);
                         emit_field_constraints(field, false);
@@ -1513,9 +1968,15 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
             expr_context_.in_struct_method = true;
             expr_context_.object_name = "obj";
 
+            // Pure functions used repeatedly are evaluated once
+            auto memoized = plan_memoized_calls(struct_def);
+            size_t next_memoized = 0;
+
             // Emit field reads (with special handling for consecutive bitfields)
             size_t i = 0;
             while (i < struct_def.fields.size()) {
+                emit_memoized_calls(memoized, next_memoized, i);
+
                 const auto& field = struct_def.fields[i];
 
                 // Initialize field with default value if specified
@@ -1531,11 +1992,10 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
                 } else {
                     // Handle conditional fields
                     if (field.condition == ir::field::runtime && field.runtime_condition.has_value()) {
-                        emit_comment("Conditional field: " + field.name);
-                        emit_if(&field.runtime_condition.value());
+                        emit_conditional_start(struct_def, field);
                         emit_field_read(field, true);
                         emit_field_constraints(field, true);
-                        emit_end_if();
+                        emit_conditional_end(struct_def, field);
                     } else if (field.condition == ir::field::always) {
                         emit_field_read(field, true);
                         emit_field_constraints(field, true);
@@ -1549,6 +2009,27 @@ void CommandBuilder::emit_module_structs_and_choices(const ir::bundle& module, c
             emit_method_end();
         }
 
+        // Generate projected readers (--cpp-project)
+        if (const auto* projection = projections_ ? projections_->find(struct_def) : nullptr) {
+            if (modes.generate_safe) {
+                emit_projected_reader(struct_def, *projection, "read_projected_safe", false);
+            }
+            if (modes.generate_throw) {
+                emit_projected_reader(struct_def, *projection, "read_projected", true);
+            }
+        }
+
+        // Generate boundary scanners (--cpp-record-index, --cpp-parallel-decode)
+        if (const auto* scanner = boundary_scanners_ ? boundary_scanners_->find(struct_def) : nullptr;
+            scanner && modes.generate_throw) {
+            emit_projected_reader(struct_def, *scanner, "read_boundary", true);
+        }
+
+        // Generate capacity-reusing reader for read_batch() (--cpp-batch-decode)
+        if (batch_readers_ && modes.generate_throw) {
+            emit_into_reader(struct_def);
+        }
+
         // Generate user-defined functions
         for (const auto& func : struct_def.functions) {
             emit_comment("User-defined function: " + func.name);
@@ -91,6 +91,21 @@ std::string CppExpressionRenderer::render_literal_string(const std::string& valu
     return result;
 }
 
+std::set<std::string> CppExpressionRenderer::block_members(const ir::union_case& union_case,
+                                                          const ir::bundle& module) {
+    std::set<std::string> members;
+    if (!union_case.is_anonymous_block || union_case.fields.size() != 1) {
+        return members;
+    }
+    const auto& type = union_case.fields.front().type;
+    if (type.kind == ir::type_kind::struct_type && type.type_index && *type.type_index < module.structs.size()) {
+        for (const auto& member : module.structs[*type.type_index].fields) {
+            members.insert(member.name);
+        }
+    }
+    return members;
+}
+
 // ============================================================================
 // Private: Reference Rendering
 // ============================================================================
@@ -102,6 +117,11 @@ std::string CppExpressionRenderer::render_parameter_ref(const std::string& name)
         return ctx_.get_variable(name);
     }
 
+    // Members of an anonymous union block live inside the case's local
+    if (ctx_.block_members.count(name)) {
+        return render_field_ref(ctx_.current_field_name + "." + name);
+    }
+
     // Check if it's a module constant (namespace-level, no object prefix needed)
     if (ctx_.module_constants && ctx_.module_constants->count(name)) {
         return name;
@@ -116,6 +136,11 @@ std::string CppExpressionRenderer::render_parameter_ref(const std::string& name)
 }
 
 std::string CppExpressionRenderer::render_field_ref(const std::string& name) {
+    std::string root = name.substr(0, name.find_first_of(".["));
+    if (root != ctx_.current_field_name && ctx_.block_members.count(root)) {
+        return render_field_ref(ctx_.current_field_name + "." + name);
+    }
+
     // Union field readers: use parent-> prefix for parent struct field references
     // EXCEPT for the field currently being read (it's a local variable)
     // Also handle member access like "opt_header_32.Magic" where opt_header_32 is current field
@@ -247,6 +272,13 @@ std::string CppExpressionRenderer::render_ternary_op(const ir::expr& expr) {
 std::string CppExpressionRenderer::render_function_call(const ir::expr& expr) {
     std::string func_name = expr.ref_name;
 
+    // Pure member function the reader has already evaluated
+    if (expr.arguments.empty()) {
+        if (auto it = ctx_.memoized_calls.find(func_name); it != ctx_.memoized_calls.end()) {
+            return it->second;
+        }
+    }
+
     // If in struct method and this is a simple function name (not qualified),
     // it's likely a method call on the current object
     if (ctx_.in_struct_method && func_name.find('.') == std::string::npos && func_name.find("::") == std::string::npos) {
@@ -0,0 +1,1408 @@
+//
+// C++ Freestanding Profile Generator Implementation
+//
+// Generates a single header whose readers use no heap and no exceptions:
+// status codes, fixed-capacity inline arrays, views into the input for
+// strings and long arrays, and tagged unions for unions and choices.
+//
+
+#include <datascript/codegen/cpp/cpp_freestanding.hh>
+#include <datascript/codegen/cpp/cpp_renderer.hh>
+#include <datascript/codegen/cpp/cpp_expression_renderer.hh>
+#include <datascript/codegen.hh>
+#include <algorithm>
+
+namespace datascript::codegen {
+
+using codegen::endl;
+using codegen::blank;
+
+namespace {
+    bool is_128bit(ir::type_kind kind) {
+        return kind == ir::type_kind::uint128 || kind == ir::type_kind::int128;
+    }
+
+    bool is_array(const ir::type_ref& type) {
+        return type.kind == ir::type_kind::array_fixed ||
+               type.kind == ir::type_kind::array_variable ||
+               type.kind == ir::type_kind::array_ranged;
+    }
+
+    bool is_string(const ir::type_ref& type) {
+        return type.kind == ir::type_kind::string ||
+               type.kind == ir::type_kind::u16_string ||
+               type.kind == ir::type_kind::u32_string;
+    }
+
+    std::string transform_name(ir::array_transform transform) {
+        switch (transform) {
+            case ir::array_transform::delta: return "ArrayTransform::Delta";
+            case ir::array_transform::delta_of_delta: return "ArrayTransform::DeltaOfDelta";
+            case ir::array_transform::zigzag_delta: return "ArrayTransform::ZigzagDelta";
+            case ir::array_transform::none: break;
+        }
+        return "";
+    }
+
+    std::string unsupported(const std::string& what) {
+        return "Freestanding profile: " + what + " not supported";
+    }
+}  // namespace
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+CppFreestandingGenerator::CppFreestandingGenerator(CppRenderer& renderer)
+    : renderer_(renderer),
+      ctx_(output_)
+{
+    expr_context_.in_struct_method = true;
+    expr_context_.object_name = "obj";
+    expr_context_.use_safe_reads = true;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+std::string CppFreestandingGenerator::render(const ir::bundle& bundle) {
+    bundle_ = &bundle;
+    renderer_.set_module(&bundle);  // Set module for type name resolution
+    presence_ = PresencePlan::build(bundle, conditional_storage::inline_value);
+    expr_context_.module_constants = &bundle.constants;
+
+    // Namespace from the package name, as in single-header mode
+    std::string namespace_name = "generated";
+    if (!bundle.name.empty()) {
+        namespace_name.clear();
+        for (char c : bundle.name) {
+            namespace_name += (c == '.') ? std::string("::") : std::string(1, c);
+        }
+    }
+
+    ctx_ << "#pragma once" << endl;
+    ctx_ << blank;
+    ctx_ << "// Freestanding profile: no heap, no exceptions, no standard library beyond" << endl;
+    ctx_ << "// <cstddef>, <cstdint>, <bit> and <type_traits>" << endl;
+    ctx_ << "#if defined(__GNUC__) || defined(__clang__)" << endl;
+    ctx_ << "#pragma GCC diagnostic push" << endl;
+    ctx_ << "#pragma GCC diagnostic ignored \"-Wunused-parameter\"" << endl;
+    ctx_ << "#pragma GCC diagnostic ignored \"-Wconversion\"" << endl;
+    ctx_ << "#pragma GCC diagnostic ignored \"-Wsign-conversion\"" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << blank;
+    ctx_ << "#include <bit>" << endl;
+    ctx_ << "#include <cstddef>" << endl;
+    ctx_ << "#include <cstdint>" << endl;
+    ctx_ << "#include <type_traits>" << endl;
+    ctx_ << blank;
+
+    ctx_.start_namespace(namespace_name);
+    ctx_ << blank;
+
+    emit_runtime();
+    if (CppRenderer::has_array_transforms(bundle)) {
+        emit_array_transforms();
+    }
+
+    emit_constants();
+    for (const auto& enum_def : bundle.enums) {
+        emit_enum(enum_def);
+    }
+    for (const auto& subtype : bundle.subtypes) {
+        emit_subtype(subtype);
+    }
+
+    // Structs, unions and choices in dependency order (0=struct, 1=union, 2=choice)
+    for (const auto& [kind, index] : bundle.type_emission_order) {
+        if (kind == 0) {
+            emit_struct(bundle.structs[index]);
+        } else if (kind == 1) {
+            emit_union(bundle.unions[index]);
+        } else if (kind == 2) {
+            emit_choice(bundle.choices[index]);
+        }
+    }
+
+    ctx_.end_namespace();
+    ctx_ << blank;
+    ctx_ << "#if defined(__GNUC__) || defined(__clang__)" << endl;
+    ctx_ << "#pragma GCC diagnostic pop" << endl;
+    ctx_ << "#endif" << endl;
+
+    return output_.str();
+}
+
+// ============================================================================
+// Runtime
+// ============================================================================
+
+void CppFreestandingGenerator::emit_runtime() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Freestanding Runtime" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Result of every read(); anything but ok leaves the object partially decoded" << endl;
+    ctx_ << "enum class Status : uint8_t {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "ok," << endl;
+    ctx_ << "buffer_underflow,      // Input ends inside a value" << endl;
+    ctx_ << "constraint_violation,  // A constraint, subtype or array range check failed" << endl;
+    ctx_ << "invalid_selector,      // No choice case matches the selector" << endl;
+    ctx_ << "capacity_exceeded,     // An array count exceeds its inline capacity" << endl;
+    ctx_ << "unterminated_string,   // No string terminator before the end of input" << endl;
+    ctx_ << "bad_offset             // A label points outside the input" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    ctx_ << "constexpr const char* status_name(Status status) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "switch (status) {" << endl;
+    ctx_.writer().indent();
+    for (const char* name : {"ok", "buffer_underflow", "constraint_violation", "invalid_selector",
+                             "capacity_exceeded", "unterminated_string", "bad_offset"}) {
+        ctx_ << "case Status::" + std::string(name) + ": return \"" + name + "\";" << endl;
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return \"unknown\";" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "constexpr bool native_big_endian = std::endian::native == std::endian::big;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Unsigned integer of N bytes" << endl;
+    ctx_ << "template<size_t N> struct wire_word;" << endl;
+    ctx_ << "template<> struct wire_word<1> { using type = uint8_t; };" << endl;
+    ctx_ << "template<> struct wire_word<2> { using type = uint16_t; };" << endl;
+    ctx_ << "template<> struct wire_word<4> { using type = uint32_t; };" << endl;
+    ctx_ << "template<> struct wire_word<8> { using type = uint64_t; };" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Decode one fixed-width scalar (integer, enum, bool, character or float)" << endl;
+    ctx_ << "template<typename T, bool BigEndian>" << endl;
+    ctx_ << "constexpr T load(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using W = typename wire_word<sizeof(T)>::type;" << endl;
+    ctx_ << "W word = 0;" << endl;
+    ctx_ << "for (size_t i = 0; i < sizeof(T); ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t shift = BigEndian ? (sizeof(T) - 1 - i) * 8 : i * 8;" << endl;
+    ctx_ << "word = static_cast<W>(word | static_cast<W>(static_cast<W>(p[i]) << shift));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (std::is_floating_point_v<T>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::bit_cast<T>(word);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else if constexpr (std::is_same_v<T, bool>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return word != 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return static_cast<T>(word);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "template<bool BigEndian = false, typename T>" << endl;
+    ctx_ << "inline Status read_scalar(const uint8_t*& p, const uint8_t* end, T& out) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (static_cast<size_t>(end - p) < sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::buffer_underflow;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out = load<T, BigEndian>(p);" << endl;
+    ctx_ << "p += sizeof(T);" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// count scalars with one bounds check" << endl;
+    ctx_ << "template<bool BigEndian = false, typename T>" << endl;
+    ctx_ << "inline Status read_scalars(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::buffer_underflow;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "out[i] = load<T, BigEndian>(p + i * sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "inline Status read_bytes(const uint8_t*& p, const uint8_t* end, uint8_t* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return read_scalars(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Bits [offset, offset + width) of a bitfield group, least significant bit first" << endl;
+    ctx_ << "constexpr uint64_t extract_bits(const uint8_t* bytes, size_t offset, size_t width) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t value = 0;" << endl;
+    ctx_ << "for (size_t i = 0; i < width; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t bit = offset + i;" << endl;
+    ctx_ << "value |= static_cast<uint64_t>((bytes[bit / 8] >> (bit % 8)) & 1u) << i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return value;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    // Inline storage
+    ctx_ << "// Constant-length array stored inline" << endl;
+    ctx_ << "template<typename T, size_t N>" << endl;
+    ctx_ << "struct FixedArray {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "T items[N > 0 ? N : 1];" << endl;
+    ctx_ << blank;
+    ctx_ << "static constexpr size_t size() { return N; }" << endl;
+    ctx_ << "constexpr T& operator[](size_t i) { return items[i]; }" << endl;
+    ctx_ << "constexpr const T& operator[](size_t i) const { return items[i]; }" << endl;
+    ctx_ << "constexpr T* begin() { return items; }" << endl;
+    ctx_ << "constexpr T* end() { return items + N; }" << endl;
+    ctx_ << "constexpr const T* begin() const { return items; }" << endl;
+    ctx_ << "constexpr const T* end() const { return items + N; }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Runtime-length array stored inline; read() fails with capacity_exceeded" << endl;
+    ctx_ << "// rather than overflow when the input asks for more than Capacity elements" << endl;
+    ctx_ << "template<typename T, size_t Capacity>" << endl;
+    ctx_ << "struct BoundedArray {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "T items[Capacity > 0 ? Capacity : 1];" << endl;
+    ctx_ << "size_t count;" << endl;
+    ctx_ << blank;
+    ctx_ << "static constexpr size_t capacity() { return Capacity; }" << endl;
+    ctx_ << "constexpr size_t size() const { return count; }" << endl;
+    ctx_ << "constexpr bool empty() const { return count == 0; }" << endl;
+    ctx_ << "constexpr T& operator[](size_t i) { return items[i]; }" << endl;
+    ctx_ << "constexpr const T& operator[](size_t i) const { return items[i]; }" << endl;
+    ctx_ << "constexpr T* begin() { return items; }" << endl;
+    ctx_ << "constexpr T* end() { return items + count; }" << endl;
+    ctx_ << "constexpr const T* begin() const { return items; }" << endl;
+    ctx_ << "constexpr const T* end() const { return items + count; }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    // Views into the input
+    ctx_ << "// Array of fixed-width scalars left in the input and decoded on access;" << endl;
+    ctx_ << "// valid while the input buffer is" << endl;
+    ctx_ << "template<typename T, bool BigEndian = false>" << endl;
+    ctx_ << "struct WireArray {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* data;" << endl;
+    ctx_ << "size_t count;" << endl;
+    ctx_ << blank;
+    ctx_ << "constexpr size_t size() const { return count; }" << endl;
+    ctx_ << "constexpr bool empty() const { return count == 0; }" << endl;
+    ctx_ << "constexpr T operator[](size_t i) const { return load<T, BigEndian>(data + i * sizeof(T)); }" << endl;
+    ctx_ << blank;
+    ctx_ << "static Status read(WireArray& out, const uint8_t*& p, const uint8_t* end, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::buffer_underflow;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out.data = p;" << endl;
+    ctx_ << "out.count = count;" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// T[]: every element up to the end of the input" << endl;
+    ctx_ << "static Status read_rest(WireArray& out, const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t remaining = static_cast<size_t>(end - p);" << endl;
+    ctx_ << "if (remaining % sizeof(T) != 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::buffer_underflow;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return read(out, p, end, remaining / sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Terminated string left in the input; length excludes the terminator" << endl;
+    ctx_ << "template<typename CharT, bool BigEndian = false>" << endl;
+    ctx_ << "struct WireString {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* data;" << endl;
+    ctx_ << "size_t length;" << endl;
+    ctx_ << blank;
+    ctx_ << "constexpr size_t size() const { return length; }" << endl;
+    ctx_ << "constexpr bool empty() const { return length == 0; }" << endl;
+    ctx_ << "constexpr CharT operator[](size_t i) const { return load<CharT, BigEndian>(data + i * sizeof(CharT)); }" << endl;
+    ctx_ << blank;
+    ctx_ << "// The input keeps the terminator, so narrow strings are C strings in place" << endl;
+    ctx_ << "const char* c_str() const requires std::is_same_v<CharT, char> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return reinterpret_cast<const char*>(data);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<size_t N>" << endl;
+    ctx_ << "constexpr bool operator==(const CharT (&text)[N]) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (length != N - 1) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return false;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "for (size_t i = 0; i < length; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if ((*this)[i] != text[i]) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return false;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "static Status read(WireString& out, const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* cursor = p;" << endl;
+    ctx_ << "size_t length = 0;" << endl;
+    ctx_ << "for (;;) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (static_cast<size_t>(end - cursor) < sizeof(CharT)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::unterminated_string;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (load<CharT, BigEndian>(cursor) == CharT{}) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "break;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "cursor += sizeof(CharT);" << endl;
+    ctx_ << "++length;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out.data = p;" << endl;
+    ctx_ << "out.length = length;" << endl;
+    ctx_ << "p = cursor + sizeof(CharT);" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Sequence of variable-size elements (structs, strings, unions) left in the" << endl;
+    ctx_ << "// input. read() validates every element by decoding it into one stack" << endl;
+    ctx_ << "// temporary; a Cursor decodes them again, one at a time" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "struct WireSequence {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* data;" << endl;
+    ctx_ << "const uint8_t* end;" << endl;
+    ctx_ << "size_t count;" << endl;
+    ctx_ << blank;
+    ctx_ << "struct Cursor {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* data;" << endl;
+    ctx_ << "const uint8_t* end;" << endl;
+    ctx_ << "size_t remaining;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Decode the next element; false once the sequence is exhausted" << endl;
+    ctx_ << "bool next(T& out) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (remaining == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return false;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "--remaining;" << endl;
+    ctx_ << "return T::read(out, data, end) == Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "constexpr size_t size() const { return count; }" << endl;
+    ctx_ << "constexpr bool empty() const { return count == 0; }" << endl;
+    ctx_ << "constexpr Cursor cursor() const { return Cursor{data, end, count}; }" << endl;
+    ctx_ << blank;
+    ctx_ << "static Status read(WireSequence& out, const uint8_t*& p, const uint8_t* end, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* first = p;" << endl;
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "T element;" << endl;
+    ctx_ << "if (Status s = T::read(element, p, end); s != Status::ok) return s;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out.data = first;" << endl;
+    ctx_ << "out.end = p;" << endl;
+    ctx_ << "out.count = count;" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// T[]: every element up to the end of the input" << endl;
+    ctx_ << "static Status read_rest(WireSequence& out, const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* first = p;" << endl;
+    ctx_ << "size_t count = 0;" << endl;
+    ctx_ << "while (p < end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "T element;" << endl;
+    ctx_ << "if (Status s = T::read(element, p, end); s != Status::ok) return s;" << endl;
+    ctx_ << "++count;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out.data = first;" << endl;
+    ctx_ << "out.end = p;" << endl;
+    ctx_ << "out.count = count;" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+}
+
+void CppFreestandingGenerator::emit_array_transforms() {
+    ctx_ << "// Reconstruction applied while reading @delta / @delta_of_delta / @zigzag_delta arrays" << endl;
+    ctx_ << "enum class ArrayTransform { Delta, DeltaOfDelta, ZigzagDelta };" << endl;
+    ctx_ << blank;
+    ctx_ << "template<ArrayTransform X, bool BigEndian = false, typename T>" << endl;
+    ctx_ << "inline Status read_transformed(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using W = typename wire_word<sizeof(T)>::type;" << endl;
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return Status::buffer_underflow;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "W value = 0;" << endl;
+    ctx_ << "W delta = 0;" << endl;
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "W w = load<W, BigEndian>(p + i * sizeof(T));" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::ZigzagDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "w = static_cast<W>((w >> 1) ^ (W(0) - (w & 1)));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::DeltaOfDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "delta = static_cast<W>(delta + w);" << endl;
+    ctx_ << "w = delta;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "value = static_cast<W>(value + w);" << endl;
+    ctx_ << "out[i] = static_cast<T>(value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+// ============================================================================
+// Module-Level Declarations
+// ============================================================================
+
+void CppFreestandingGenerator::emit_constants() {
+    if (bundle_->constants.empty()) {
+        return;
+    }
+    // Type from magnitude, as in single-header mode
+    for (const auto& [name, value] : bundle_->constants) {
+        const char* type = value <= UINT8_MAX ? "uint8_t"
+                         : value <= UINT16_MAX ? "uint16_t"
+                         : value <= UINT32_MAX ? "uint32_t" : "uint64_t";
+        ctx_ << "constexpr " + std::string(type) + " " + name + " = " + std::to_string(value) + ";" << endl;
+    }
+    ctx_ << blank;
+}
+
+void CppFreestandingGenerator::emit_enum(const ir::enum_def& enum_def) {
+    ctx_.start_enum(enum_def.name, value_type(enum_def.base_type), enum_def.documentation);
+    for (size_t i = 0; i < enum_def.items.size(); ++i) {
+        const auto& item = enum_def.items[i];
+        ctx_ << item.name + " = " + std::to_string(item.value) +
+                (i + 1 < enum_def.items.size() ? "," : "") << endl;
+    }
+    ctx_.end_enum();
+
+    // Same operators single-header mode provides, so expressions render alike
+    const std::string& type = enum_def.name;
+    const std::string underlying = "std::underlying_type_t<" + type + ">";
+    for (const char* op : {"|", "&", "^"}) {
+        ctx_ << "constexpr " + type + " operator" + op + "(" + type + " a, " + type + " b) { return static_cast<" +
+                type + ">(static_cast<" + underlying + ">(a) " + op + " static_cast<" + underlying + ">(b)); }" << endl;
+    }
+    ctx_ << "constexpr " + type + " operator~(" + type + " a) { return static_cast<" + type + ">(~static_cast<" +
+            underlying + ">(a)); }" << endl;
+    ctx_ << "constexpr bool operator==(" + type + " a, int b) { return static_cast<" + underlying +
+            ">(a) == static_cast<" + underlying + ">(b); }" << endl;
+    ctx_ << "constexpr bool operator!=(" + type + " a, int b) { return !(a == b); }" << endl;
+    ctx_ << blank;
+}
+
+void CppFreestandingGenerator::emit_subtype(const ir::subtype_def& subtype) {
+    emit_documentation(subtype.documentation);
+    std::string base = value_type(subtype.base_type);
+    ctx_ << "using " + subtype.name + " = " + base + ";" << endl;
+    ctx_ << blank;
+
+    ExprContext context = expr_context_;
+    context.in_struct_method = false;
+    context.add_variable("this", "value");
+    CppExpressionRenderer expr_renderer(context, bundle_);
+    ctx_ << "constexpr bool validate_" + subtype.name + "(" + base + " value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return " + expr_renderer.render(subtype.constraint) + ";" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppFreestandingGenerator::emit_documentation(const std::string& documentation) {
+    if (!documentation.empty()) {
+        ctx_ << "/**" << endl;
+        ctx_ << " * " + documentation << endl;
+        ctx_ << " */" << endl;
+    }
+}
+
+void CppFreestandingGenerator::emit_struct(const ir::struct_def& struct_def) {
+    ctx_.start_struct(struct_def.name, struct_def.documentation);
+
+    // Members stay trivial (no default member initializers), so objects can
+    // live in static storage or on an interrupt stack without constructors
+    for (const auto& field : struct_def.fields) {
+        if (field.condition == ir::field::never) {
+            continue;
+        }
+        ctx_ << field_type(field) + " " + field.name + ";" << endl;
+    }
+    const auto* presence = presence_.find(struct_def.name);
+    if (presence) {
+        emit_presence_members(*presence);
+    }
+    ctx_ << blank;
+
+    ctx_ << "static Status read(" + struct_def.name + "& obj, const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    temp_counter_ = 0;
+    if (presence && presence->members.size() > 64) {
+        ctx_ << "for (uint64_t& word : obj.presence_) word = 0;" << endl;
+    } else if (presence) {
+        ctx_ << "obj.presence_ = 0;" << endl;
+    }
+    bool positions = std::any_of(struct_def.fields.begin(), struct_def.fields.end(), [](const ir::field& f) {
+        return f.label.has_value() || f.alignment.has_value();
+    });
+    if (positions) {
+        ctx_ << "const uint8_t* start = data;  // Labels and alignment are relative to the struct start" << endl;
+    }
+    emit_fields_read(struct_def.fields, presence);
+    ctx_ << "return Status::ok;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+
+    // User-defined functions: const members evaluated against decoded fields
+    ExprContext function_context = expr_context_;
+    function_context.in_struct_method = false;
+    CppExpressionRenderer function_renderer(function_context, bundle_);
+    for (const auto& function : struct_def.functions) {
+        std::string params;
+        for (const auto& param : function.parameters) {
+            if (!params.empty()) {
+                params += ", ";
+            }
+            params += value_type(param.param_type) + " " + param.name;
+        }
+        ctx_ << blank;
+        ctx_ << value_type(function.return_type) + " " + function.name + "(" + params + ") const {" << endl;
+        ctx_.writer().indent();
+        for (const auto& statement : function.body) {
+            if (auto* ret = std::get_if<ir::return_statement>(&statement)) {
+                ctx_ << "return " + function_renderer.render(ret->value) + ";" << endl;
+            }
+        }
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+
+    ctx_.end_struct();
+}
+
+void CppFreestandingGenerator::emit_union(const ir::union_def& union_def) {
+    std::vector<const ir::field*> branches;
+    std::vector<const ir::union_case*> branch_cases;
+    for (const auto& union_case : union_def.cases) {
+        for (const auto& field : union_case.fields) {
+            branches.push_back(&field);
+            branch_cases.push_back(&union_case);
+        }
+    }
+
+    // All cases conditional: no branch matching leaves the union unset
+    bool is_optional = std::all_of(union_def.cases.begin(), union_def.cases.end(),
+                                   [](const ir::union_case& c) { return c.condition.has_value(); });
+
+    ctx_.start_struct(union_def.name, union_def.documentation);
+    std::string tags = "unset";
+    for (const auto* field : branches) {
+        tags += ", " + field->name;
+    }
+    ctx_ << "enum class Tag : uint8_t { " + tags + " };" << endl;
+    ctx_ << blank;
+    ctx_ << "Tag tag;" << endl;
+    if (!branches.empty()) {
+        ctx_ << "union {" << endl;
+        ctx_.writer().indent();
+        for (const auto* field : branches) {
+            ctx_ << field_type(*field) + " " + field->name + ";" << endl;
+        }
+        ctx_.writer().unindent();
+        ctx_ << "};" << endl;
+    }
+
+    // One reader per branch; constraints see the enclosing struct as parent->
+    ExprContext saved = expr_context_;
+    expr_context_.use_parent_context = true;
+    for (size_t i = 0; i < branches.size(); ++i) {
+        const auto& field = *branches[i];
+        expr_context_.current_field_name = field.name;
+        expr_context_.block_members = CppExpressionRenderer::block_members(*branch_cases[i], *bundle_);
+        temp_counter_ = 0;
+
+        ctx_ << blank;
+        ctx_ << "template<typename ParentT = void>" << endl;
+        ctx_ << "static Status read_as_" + field.name + "(" + union_def.name +
+                "& obj, const uint8_t*& data, const uint8_t* end, const ParentT* parent = nullptr) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "(void)parent;" << endl;
+        if (field.label || field.alignment) {
+            ctx_ << "const uint8_t* start = data;" << endl;
+        }
+        emit_field_read(field);
+        emit_constraints(field);
+        if (branch_cases[i]->condition) {
+            ctx_ << "if (!(" + render_expr(*branch_cases[i]->condition) + ")) return Status::constraint_violation;" << endl;
+        }
+        ctx_ << "obj.tag = Tag::" + field.name + ";" << endl;
+        ctx_ << "return Status::ok;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+    expr_context_ = saved;
+
+    // Trial decoding: a branch failing a constraint falls through to the next
+    ctx_ << blank;
+    ctx_ << "template<typename ParentT = void>" << endl;
+    ctx_ << "static Status read(" + union_def.name +
+            "& obj, const uint8_t*& data, const uint8_t* end, const ParentT* parent = nullptr) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "obj.tag = Tag::unset;" << endl;
+    if (branches.empty()) {
+        ctx_ << "return Status::ok;" << endl;
+    } else {
+        ctx_ << "const uint8_t* union_pos = data;  // Restored before each further branch" << endl;
+        for (size_t i = 0; i < branches.size(); ++i) {
+            const std::string call = "read_as_" + branches[i]->name + "(obj, data, end, parent)";
+            bool is_last = (i + 1 == branches.size());
+            if (is_last && !is_optional) {
+                ctx_ << "return " + call + ";" << endl;
+                break;
+            }
+            ctx_ << "if (Status s = " + call + "; s != Status::constraint_violation) return s;" << endl;
+            if (!is_last) {
+                ctx_ << "data = union_pos;" << endl;
+            }
+        }
+        if (is_optional) {
+            ctx_ << "// No branch matched - the union stays unset" << endl;
+            ctx_ << "obj.tag = Tag::unset;" << endl;
+            ctx_ << "return Status::ok;" << endl;
+        }
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+
+    ctx_.end_struct();
+}
+
+void CppFreestandingGenerator::emit_choice(const ir::choice_def& choice_def) {
+    bool is_inline = !choice_def.selector.has_value() && choice_def.inferred_discriminator_type.has_value();
+
+    ctx_.start_struct(choice_def.name, choice_def.documentation);
+    std::string tags = "unset";
+    for (const auto& choice_case : choice_def.cases) {
+        tags += ", " + choice_case.case_field.name;
+    }
+    ctx_ << "enum class Tag : uint8_t { " + tags + " };" << endl;
+    ctx_ << blank;
+    ctx_ << "Tag tag;" << endl;
+    if (!choice_def.cases.empty()) {
+        ctx_ << "union {" << endl;
+        ctx_.writer().indent();
+        for (const auto& choice_case : choice_def.cases) {
+            ctx_ << field_type(choice_case.case_field) + " " + choice_case.case_field.name + ";" << endl;
+        }
+        ctx_.writer().unindent();
+        ctx_ << "};" << endl;
+    }
+    ctx_ << blank;
+
+    if (is_inline) {
+        ctx_ << "static Status read(" + choice_def.name + "& obj, const uint8_t*& data, const uint8_t* end) {" << endl;
+    } else {
+        ctx_ << "template<typename SelectorType>" << endl;
+        ctx_ << "static Status read(" + choice_def.name +
+                "& obj, const uint8_t*& data, const uint8_t* end, SelectorType selector_value) {" << endl;
+    }
+    ctx_.writer().indent();
+    temp_counter_ = 0;
+    ctx_ << "obj.tag = Tag::unset;" << endl;
+
+    bool positions = std::any_of(choice_def.cases.begin(), choice_def.cases.end(), [](const auto& c) {
+        return c.case_field.label.has_value() || c.case_field.alignment.has_value();
+    });
+    if (positions) {
+        ctx_ << "const uint8_t* start = data;" << endl;
+    }
+
+    // Anonymous blocks re-read the discriminator as their first field, and
+    // default cases treat it as part of their data
+    auto is_default = [](const ir::choice_def::case_def& c) {
+        return c.case_values.empty() && c.selector_mode == ir::case_selector_mode::exact;
+    };
+    if (is_inline) {
+        bool needs_save = std::any_of(choice_def.cases.begin(), choice_def.cases.end(), [&](const auto& c) {
+            return c.is_anonymous_block || is_default(c);
+        });
+        if (needs_save) {
+            ctx_ << "const uint8_t* saved_data_pos = data;" << endl;
+        }
+        const auto& discriminator = *choice_def.inferred_discriminator_type;
+        ctx_ << value_type(discriminator) + " selector_value;" << endl;
+        emit_check("read_scalar" + endian_arg(discriminator) + "(data, end, selector_value)");
+    }
+
+    // Exact and range cases first, the default case (if any) as the final else
+    std::vector<const ir::choice_def::case_def*> ordered;
+    const ir::choice_def::case_def* default_case = nullptr;
+    for (const auto& choice_case : choice_def.cases) {
+        if (is_default(choice_case)) {
+            default_case = &choice_case;
+        } else {
+            ordered.push_back(&choice_case);
+        }
+    }
+
+    auto emit_case_body = [&](const ir::choice_def::case_def& choice_case) {
+        if (is_inline && (choice_case.is_anonymous_block || is_default(choice_case))) {
+            ctx_ << "data = saved_data_pos;" << endl;
+        }
+        emit_field_read(choice_case.case_field);
+        emit_constraints(choice_case.case_field);
+        ctx_ << "obj.tag = Tag::" + choice_case.case_field.name + ";" << endl;
+    };
+
+    bool first = true;
+    for (const auto* choice_case : ordered) {
+        std::string condition;
+        if (choice_case->selector_mode != ir::case_selector_mode::exact) {
+            std::string op;
+            switch (choice_case->selector_mode) {
+                case ir::case_selector_mode::ge: op = " >= "; break;
+                case ir::case_selector_mode::gt: op = " > "; break;
+                case ir::case_selector_mode::le: op = " <= "; break;
+                case ir::case_selector_mode::lt: op = " < "; break;
+                case ir::case_selector_mode::ne: op = " != "; break;
+                case ir::case_selector_mode::exact: break;
+            }
+            condition = "selector_value" + op + "(" +
+                        (choice_case->range_bound ? render_expr(*choice_case->range_bound) : "0") + ")";
+        } else {
+            for (const auto& value : choice_case->case_values) {
+                if (!condition.empty()) {
+                    condition += " || ";
+                }
+                condition += "selector_value == (" + render_expr(value) + ")";
+            }
+        }
+        if (first) {
+            ctx_.start_if(condition);
+            first = false;
+        } else {
+            ctx_.start_else_if(condition);
+        }
+        emit_case_body(*choice_case);
+    }
+
+    if (default_case) {
+        if (first) {
+            emit_case_body(*default_case);
+        } else {
+            ctx_.start_else();
+            emit_case_body(*default_case);
+            ctx_.end_if();
+        }
+    } else if (first) {
+        ctx_ << "return Status::invalid_selector;" << endl;
+    } else {
+        ctx_.start_else();
+        ctx_ << "return Status::invalid_selector;" << endl;
+        ctx_.end_if();
+    }
+    if (default_case || !first) {
+        ctx_ << "return Status::ok;" << endl;
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+
+    ctx_.end_struct();
+}
+
+// ============================================================================
+// Readers
+// ============================================================================
+
+void CppFreestandingGenerator::emit_check(const std::string& call) {
+    ctx_ << "if (Status s = " + call + "; s != Status::ok) return s;" << endl;
+}
+
+void CppFreestandingGenerator::emit_presence_members(const struct_presence& presence) {
+    const size_t count = presence.members.size();
+    ctx_ << blank;
+    ctx_ << "// Presence bits of the conditional fields, in declaration order (set by read())" << endl;
+    if (count > 64) {
+        ctx_ << "uint64_t presence_[" + std::to_string((count + 63) / 64) + "];" << endl;
+    } else {
+        ctx_ << presence_mask_type(count) + " presence_;" << endl;
+    }
+    ctx_ << blank;
+    for (const auto& member : presence.members) {
+        ctx_ << "bool " + member.accessor + "() const { return (" + presence_word(member.bit, count) +
+                " >> " + std::to_string(member.bit % 64) + ") & 1u; }" << endl;
+    }
+}
+
+std::string CppFreestandingGenerator::presence_word(size_t bit, size_t bit_count) const {
+    return bit_count > 64 ? "presence_[" + std::to_string(bit / 64) + "]" : "presence_";
+}
+
+void CppFreestandingGenerator::emit_fields_read(const std::vector<ir::field>& fields,
+                                                const struct_presence* presence) {
+    size_t i = 0;
+    while (i < fields.size()) {
+        const auto& field = fields[i];
+
+        if (field.default_value) {
+            ctx_ << "obj." + field.name + " = " + render_expr(*field.default_value) + ";" << endl;
+        }
+
+        bool is_conditional = (field.condition == ir::field::runtime && field.runtime_condition.has_value());
+        if (is_conditional) {
+            ctx_.start_if(render_expr(*field.runtime_condition));
+        }
+
+        if (field.type.kind == ir::type_kind::bitfield && field.type.bit_width.has_value()) {
+            // Consecutive bitfields are read as one group, as in single-header mode
+            i = emit_bitfield_group(fields, i);
+        } else if (field.condition == ir::field::always || is_conditional) {
+            emit_field_read(field);
+            emit_constraints(field);
+            i++;
+        } else {
+            i++;
+        }
+
+        if (is_conditional) {
+            const auto* member = presence ? presence->find(field.name) : nullptr;
+            if (member) {
+                const size_t count = presence->members.size();
+                const std::string word = count > 64 ? "uint64_t" : presence_mask_type(count);
+                ctx_ << "obj." + presence_word(member->bit, count) + " |= " + word + "(1) << " +
+                        std::to_string(member->bit % 64) + ";" << endl;
+            }
+            ctx_.end_if();
+        }
+    }
+}
+
+size_t CppFreestandingGenerator::emit_bitfield_group(const std::vector<ir::field>& fields, size_t start_index) {
+    size_t end_index = start_index;
+    size_t total_bits = 0;
+    while (end_index < fields.size() &&
+           fields[end_index].type.kind == ir::type_kind::bitfield &&
+           fields[end_index].type.bit_width.has_value()) {
+        total_bits += *fields[end_index].type.bit_width;
+        end_index++;
+    }
+
+    std::string bytes = "bitfield_bytes" + std::to_string(temp_counter_++);
+    size_t num_bytes = (total_bits + 7) / 8;
+    ctx_ << "uint8_t " + bytes + "[" + std::to_string(num_bytes) + "];" << endl;
+    emit_check("read_bytes(data, end, " + bytes + ", " + std::to_string(num_bytes) + ")");
+
+    size_t bit_offset = 0;
+    for (size_t i = start_index; i < end_index; i++) {
+        const auto& field = fields[i];
+        size_t width = *field.type.bit_width;
+        ctx_ << "obj." + field.name + " = static_cast<" + value_type(field.type) + ">(extract_bits(" + bytes + ", " +
+                std::to_string(bit_offset) + ", " + std::to_string(width) + "));" << endl;
+        emit_constraints(field);
+        bit_offset += width;
+    }
+    return end_index;
+}
+
+void CppFreestandingGenerator::emit_field_read(const ir::field& field) {
+    if (field.substream) {
+        // Undoing the transform needs a buffer for the decoded bytes
+        throw codegen_error(unsupported("substream '" + field.name + "'"));
+    }
+    if (field.label) {
+        std::string offset = "label_offset" + std::to_string(temp_counter_++);
+        ctx_ << "const uint64_t " + offset + " = static_cast<uint64_t>(" + render_expr(*field.label) + ");" << endl;
+        ctx_ << "if (" + offset + " > static_cast<uint64_t>(end - start)) return Status::bad_offset;" << endl;
+        ctx_ << "data = start + " + offset + ";" << endl;
+    }
+    if (field.alignment) {
+        std::string mask = std::to_string(*field.alignment - 1);
+        std::string aligned = "aligned_offset" + std::to_string(temp_counter_++);
+        ctx_ << "const size_t " + aligned + " = (static_cast<size_t>(data - start) + " + mask + ") & ~size_t(" +
+                mask + ");" << endl;
+        ctx_ << "if (" + aligned + " > static_cast<size_t>(end - start)) return Status::buffer_underflow;" << endl;
+        ctx_ << "data = start + " + aligned + ";" << endl;
+    }
+
+    if (is_array(field.type)) {
+        emit_array_read(field);
+    } else {
+        emit_value_read(field.type, "obj." + field.name);
+    }
+}
+
+void CppFreestandingGenerator::emit_constraints(const ir::field& field) {
+    std::vector<std::string> conditions;
+    if (field.inline_constraint) {
+        conditions.push_back(render_expr(*field.inline_constraint));
+    }
+    for (const auto& application : field.constraints) {
+        if (application.constraint_index < bundle_->constraints.size()) {
+            conditions.push_back(render_expr(bundle_->constraints[application.constraint_index].condition));
+        }
+    }
+
+    for (const auto& condition : conditions) {
+        if (condition.find("parent->") != std::string::npos) {
+            // Union branch constraints on the enclosing struct apply only when one is passed
+            ctx_ << "if constexpr (!std::is_void_v<ParentT>) {" << endl;
+            ctx_.writer().indent();
+            ctx_ << "if (parent != nullptr && !(" + condition + ")) return Status::constraint_violation;" << endl;
+            ctx_.writer().unindent();
+            ctx_ << "}" << endl;
+        } else {
+            ctx_ << "if (!(" + condition + ")) return Status::constraint_violation;" << endl;
+        }
+    }
+}
+
+void CppFreestandingGenerator::emit_value_read(const ir::type_ref& type, const std::string& target) {
+    if (is_128bit(type.kind)) {
+        throw codegen_error(unsupported("128-bit integers"));
+    }
+
+    switch (type.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::uint16:
+        case ir::type_kind::uint32:
+        case ir::type_kind::uint64:
+        case ir::type_kind::int8:
+        case ir::type_kind::int16:
+        case ir::type_kind::int32:
+        case ir::type_kind::int64:
+        case ir::type_kind::float32:
+        case ir::type_kind::float64:
+        case ir::type_kind::boolean:
+        case ir::type_kind::enum_type:
+            emit_check("read_scalar" + endian_arg(scalar_of(type)) + "(data, end, " + target + ")");
+            return;
+
+        case ir::type_kind::bitfield: {
+            // Array elements: one word per element, masked to the width
+            emit_check("read_scalar(data, end, " + target + ")");
+            if (type.bit_width && *type.bit_width < 64) {
+                uint64_t mask = (1ULL << *type.bit_width) - 1;
+                ctx_ << target + " = static_cast<" + value_type(type) + ">(" + target + " & " +
+                        std::to_string(mask) + "u);" << endl;
+            }
+            return;
+        }
+
+        case ir::type_kind::subtype_ref: {
+            const auto& subtype = bundle_->subtypes.at(*type.type_index);
+            emit_value_read(subtype.base_type, target);
+            ctx_ << "if (!validate_" + subtype.name + "(" + target + ")) return Status::constraint_violation;" << endl;
+            return;
+        }
+
+        case ir::type_kind::string:
+        case ir::type_kind::u16_string:
+        case ir::type_kind::u32_string:
+            emit_check(string_type(type) + "::read(" + target + ", data, end)");
+            return;
+
+        case ir::type_kind::struct_type:
+            emit_check(value_type(type) + "::read(" + target + ", data, end)");
+            return;
+
+        case ir::type_kind::union_type:
+            emit_check(value_type(type) + "::read(" + target + ", data, end, &obj)");
+            return;
+
+        case ir::type_kind::choice_type: {
+            const auto& choice_def = bundle_->choices.at(*type.type_index);
+            if (!choice_def.selector.has_value() && choice_def.inferred_discriminator_type.has_value()) {
+                emit_check(choice_def.name + "::read(" + target + ", data, end)");
+            } else {
+                emit_check(choice_def.name + "::read(" + target + ", data, end, " + selector_args(type) + ")");
+            }
+            return;
+        }
+
+        default:
+            throw codegen_error(unsupported("type of '" + target + "'"));
+    }
+}
+
+void CppFreestandingGenerator::emit_array_read(const ir::field& field) {
+    const ir::type_ref& type = field.type;
+    const ir::type_ref& element = *type.element_type;
+    array_plan plan = plan_array(type, field.max_count);
+    const std::string target = "obj." + field.name;
+
+    // Element count: constant, counted or (T[]) up to the end of the input
+    std::optional<std::string> count;
+    if (auto constant = constant_count(type)) {
+        count = std::to_string(*constant);
+    } else if (type.array_size_expr) {
+        count = "static_cast<size_t>(" + render_expr(*type.array_size_expr) + ")";
+    }
+
+    switch (plan.storage) {
+        case array_storage::fixed:
+            emit_element_reads(element, target + ".items", *count, field.transform, 0);
+            return;
+
+        case array_storage::bounded: {
+            ctx_.start_scope();
+            ctx_ << "const size_t count = " + *count + ";" << endl;
+            if (type.kind == ir::type_kind::array_ranged && type.min_size_expr && type.max_size_expr) {
+                ctx_ << "if (count < static_cast<size_t>(" + render_expr(*type.min_size_expr) +
+                        ") || count > static_cast<size_t>(" + render_expr(*type.max_size_expr) +
+                        ")) return Status::constraint_violation;" << endl;
+            }
+            ctx_ << "if (count > " + std::to_string(plan.capacity) + ") return Status::capacity_exceeded;" << endl;
+            ctx_ << target + ".count = count;" << endl;
+            emit_element_reads(element, target + ".items", "count", field.transform, 0);
+            ctx_.end_scope();
+            return;
+        }
+
+        case array_storage::view:
+        case array_storage::sequence: {
+            if (field.transform != ir::array_transform::none) {
+                throw codegen_error(unsupported("array transform on '" + field.name +
+                                                "' (its length has no bound within the inline capacity)"));
+            }
+            std::string storage = field_type(field);
+            if (count) {
+                if (type.kind == ir::type_kind::array_ranged && type.min_size_expr && type.max_size_expr) {
+                    ctx_.start_scope();
+                    ctx_ << "const size_t count = " + *count + ";" << endl;
+                    ctx_ << "if (count < static_cast<size_t>(" + render_expr(*type.min_size_expr) +
+                            ") || count > static_cast<size_t>(" + render_expr(*type.max_size_expr) +
+                            ")) return Status::constraint_violation;" << endl;
+                    emit_check(storage + "::read(" + target + ", data, end, count)");
+                    ctx_.end_scope();
+                } else {
+                    emit_check(storage + "::read(" + target + ", data, end, " + *count + ")");
+                }
+            } else {
+                emit_check(storage + "::read_rest(" + target + ", data, end)");
+            }
+
+            // Subtype elements are validated once, up front
+            if (element.kind == ir::type_kind::subtype_ref) {
+                const auto& subtype = bundle_->subtypes.at(*element.type_index);
+                ctx_.start_for("size_t i = 0", "i < " + target + ".size()", "++i");
+                ctx_ << "if (!validate_" + subtype.name + "(" + target + "[i])) return Status::constraint_violation;" << endl;
+                ctx_.end_for();
+            }
+            return;
+        }
+    }
+}
+
+void CppFreestandingGenerator::emit_element_reads(const ir::type_ref& element_type, const std::string& items,
+                                                  const std::string& count, ir::array_transform transform,
+                                                  size_t depth) {
+    if (transform != ir::array_transform::none) {
+        std::string big = endian_arg(element_type);
+        std::string args = transform_name(transform);
+        if (!big.empty()) {
+            args += ", " + big.substr(1, big.size() - 2);
+        }
+        emit_check("read_transformed<" + args + ">(data, end, " + items + ", " + count + ")");
+        return;
+    }
+
+    switch (element_type.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::uint16:
+        case ir::type_kind::uint32:
+        case ir::type_kind::uint64:
+        case ir::type_kind::int8:
+        case ir::type_kind::int16:
+        case ir::type_kind::int32:
+        case ir::type_kind::int64:
+        case ir::type_kind::float32:
+        case ir::type_kind::float64:
+        case ir::type_kind::boolean:
+        case ir::type_kind::enum_type:
+            // One bounds check for the whole run
+            emit_check("read_scalars" + endian_arg(scalar_of(element_type)) + "(data, end, " + items + ", " + count + ")");
+            return;
+        default:
+            break;
+    }
+
+    std::string index = depth == 0 ? "i" : "i" + std::to_string(depth);
+    ctx_.start_for("size_t " + index + " = 0", index + " < " + count, "++" + index);
+    std::string element = items + "[" + index + "]";
+    if (is_array(element_type)) {
+        auto inner = constant_count(element_type);
+        emit_element_reads(*element_type.element_type, element + ".items", std::to_string(*inner),
+                           ir::array_transform::none, depth + 1);
+    } else {
+        emit_value_read(element_type, element);
+    }
+    ctx_.end_for();
+}
+
+// ============================================================================
+// Types
+// ============================================================================
+
+std::optional<uint64_t> CppFreestandingGenerator::constant_count(const ir::type_ref& type) const {
+    if (type.kind != ir::type_kind::array_fixed) {
+        return std::nullopt;
+    }
+    if (type.array_size) {
+        return type.array_size;
+    }
+    if (type.array_size_expr && type.array_size_expr->type == ir::expr::literal_int) {
+        return type.array_size_expr->int_value;
+    }
+    return std::nullopt;
+}
+
+CppFreestandingGenerator::array_plan CppFreestandingGenerator::plan_array(
+    const ir::type_ref& type, std::optional<uint64_t> max_count) const
+{
+    const ir::type_ref& element = *type.element_type;
+    auto count = constant_count(type);
+    auto bound = count ? count : max_count;
+    uint64_t limit = static_cast<uint64_t>(renderer_.get_freestanding_capacity());
+
+    if (bound && *bound <= limit) {
+        return array_plan{count ? array_storage::fixed : array_storage::bounded, *bound};
+    }
+
+    // Too long (or unbounded) to store inline: leave the elements in the input
+    if (is_view_element(element)) {
+        return array_plan{array_storage::view, 0};
+    }
+    if (is_array(element) || element.kind == ir::type_kind::bitfield || is_128bit(element.kind)) {
+        throw codegen_error(unsupported("unbounded array of this element type"));
+    }
+    if (element.kind == ir::type_kind::choice_type) {
+        const auto& choice_def = bundle_->choices.at(*element.type_index);
+        if (choice_def.selector.has_value() || !choice_def.inferred_discriminator_type.has_value()) {
+            throw codegen_error(unsupported("unbounded array of choice '" + choice_def.name +
+                                            "' with an external selector"));
+        }
+    }
+    return array_plan{array_storage::sequence, 0};
+}
+
+bool CppFreestandingGenerator::is_view_element(const ir::type_ref& type) const {
+    switch (type.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::uint16:
+        case ir::type_kind::uint32:
+        case ir::type_kind::uint64:
+        case ir::type_kind::int8:
+        case ir::type_kind::int16:
+        case ir::type_kind::int32:
+        case ir::type_kind::int64:
+        case ir::type_kind::float32:
+        case ir::type_kind::float64:
+        case ir::type_kind::boolean:
+        case ir::type_kind::enum_type:
+            return true;
+        case ir::type_kind::subtype_ref:
+            return is_view_element(bundle_->subtypes.at(*type.type_index).base_type);
+        default:
+            return false;
+    }
+}
+
+const ir::type_ref& CppFreestandingGenerator::scalar_of(const ir::type_ref& type) const {
+    if (type.kind == ir::type_kind::enum_type && type.type_index) {
+        return bundle_->enums.at(*type.type_index).base_type;
+    }
+    if (type.kind == ir::type_kind::subtype_ref && type.type_index) {
+        return scalar_of(bundle_->subtypes.at(*type.type_index).base_type);
+    }
+    return type;
+}
+
+bool CppFreestandingGenerator::is_big_endian(const ir::type_ref& type) const {
+    return type.byte_order.has_value() && *type.byte_order == ir::endianness::big;
+}
+
+std::string CppFreestandingGenerator::endian_arg(const ir::type_ref& type) const {
+    if (!type.byte_order) {
+        return "";  // Little endian by default
+    }
+    switch (*type.byte_order) {
+        case ir::endianness::big: return "<true>";
+        case ir::endianness::native: return "<native_big_endian>";
+        default: return "";
+    }
+}
+
+std::string CppFreestandingGenerator::string_type(const ir::type_ref& type) const {
+    std::string big;
+    if (is_big_endian(type)) {
+        big = ", true";
+    } else if (type.byte_order && *type.byte_order == ir::endianness::native) {
+        big = ", native_big_endian";
+    }
+    switch (type.kind) {
+        case ir::type_kind::u16_string: return "WireString<char16_t" + big + ">";
+        case ir::type_kind::u32_string: return "WireString<char32_t" + big + ">";
+        default: return "WireString<char>";
+    }
+}
+
+std::string CppFreestandingGenerator::value_type(const ir::type_ref& type) const {
+    if (is_128bit(type.kind)) {
+        throw codegen_error(unsupported("128-bit integers"));
+    }
+    if (is_string(type)) {
+        return string_type(type);
+    }
+    if (is_array(type)) {
+        return element_type(type);
+    }
+    return renderer_.get_type_name(type);
+}
+
+std::string CppFreestandingGenerator::element_type(const ir::type_ref& type) const {
+    // Arrays nested in arrays are stored inline only
+    auto plan = plan_array(type, std::nullopt);
+    if (plan.storage != array_storage::fixed) {
+        throw codegen_error(unsupported("nested array without a constant length within the inline capacity"));
+    }
+    return "FixedArray<" + value_type(*type.element_type) + ", " + std::to_string(plan.capacity) + ">";
+}
+
+std::string CppFreestandingGenerator::field_type(const ir::field& field) const {
+    if (!is_array(field.type)) {
+        return value_type(field.type);
+    }
+
+    const ir::type_ref& element = *field.type.element_type;
+    auto plan = plan_array(field.type, field.max_count);
+    switch (plan.storage) {
+        case array_storage::fixed:
+            return "FixedArray<" + value_type(element) + ", " + std::to_string(plan.capacity) + ">";
+        case array_storage::bounded:
+            return "BoundedArray<" + value_type(element) + ", " + std::to_string(plan.capacity) + ">";
+        case array_storage::view: {
+            std::string arg = endian_arg(scalar_of(element));
+            std::string big = arg.empty() ? "" : ", " + arg.substr(1, arg.size() - 2);
+            return "WireArray<" + value_type(element) + big + ">";
+        }
+        case array_storage::sequence:
+            return "WireSequence<" + value_type(element) + ">";
+    }
+    return value_type(element);
+}
+
+// ============================================================================
+// Expressions
+// ============================================================================
+
+std::string CppFreestandingGenerator::render_expr(const ir::expr& expr) const {
+    CppExpressionRenderer expr_renderer(expr_context_, bundle_);
+    return expr_renderer.render(expr);
+}
+
+std::string CppFreestandingGenerator::selector_args(const ir::type_ref& type) const {
+    if (!type.choice_selector_args.empty()) {
+        std::string args;
+        for (const auto& arg : type.choice_selector_args) {
+            if (!args.empty()) {
+                args += ", ";
+            }
+            args += render_expr(*arg);
+        }
+        return args;
+    }
+
+    // The selector names a field of the enclosing struct
+    const auto& choice_def = bundle_->choices.at(*type.type_index);
+    ir::expr selector;
+    selector.type = ir::expr::field_ref;
+    selector.ref_name = choice_def.selector->ref_name;
+    return render_expr(selector);
+}
+
+}  // namespace datascript::codegen
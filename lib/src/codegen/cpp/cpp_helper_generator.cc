@@ -25,6 +25,9 @@ CppHelperGenerator::CppHelperGenerator(CppWriterContext& ctx, cpp_options::error
 
 void CppHelperGenerator::generate_all() {
     generate_exception_classes();
+    if (cpu_dispatch_) {
+        generate_cpu_dispatch();
+    }
     generate_binary_readers();
     generate_peek_helpers();
     generate_string_readers();
@@ -55,6 +58,172 @@ void CppHelperGenerator::generate_binary_readers() {
     ctx_ << "// ============================================================================" << endl;
     ctx_ << blank;
 
+    if (padded_input_) {
+        generate_byteswap_helpers();
+        generate_padded_input();
+    } else {
+        generate_checked_readers();
+    }
+
+    // int readers (just cast from unsigned, bounds checking delegated to unsigned readers)
+    ctx_ << "inline int8_t read_int8(const uint8_t*& p, const uint8_t* end) { return static_cast<int8_t>(read_uint8(p, end)); }" << endl;
+    ctx_ << "inline int16_t read_int16_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int16_t>(read_uint16_le(p, end)); }" << endl;
+    ctx_ << "inline int16_t read_int16_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int16_t>(read_uint16_be(p, end)); }" << endl;
+    ctx_ << "inline int32_t read_int32_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int32_t>(read_uint32_le(p, end)); }" << endl;
+    ctx_ << "inline int32_t read_int32_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int32_t>(read_uint32_be(p, end)); }" << endl;
+    ctx_ << "inline int64_t read_int64_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int64_t>(read_uint64_le(p, end)); }" << endl;
+    ctx_ << "inline int64_t read_int64_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int64_t>(read_uint64_be(p, end)); }" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// IEEE-754 readers: fetch the bit pattern, then reinterpret it" << endl;
+    ctx_ << "inline float read_float32_le(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t bits = read_uint32_le(p, end);" << endl;
+    ctx_ << "float v;" << endl;
+    ctx_ << "std::memcpy(&v, &bits, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline float read_float32_be(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t bits = read_uint32_be(p, end);" << endl;
+    ctx_ << "float v;" << endl;
+    ctx_ << "std::memcpy(&v, &bits, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline double read_float64_le(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t bits = read_uint64_le(p, end);" << endl;
+    ctx_ << "double v;" << endl;
+    ctx_ << "std::memcpy(&v, &bits, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline double read_float64_be(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t bits = read_uint64_be(p, end);" << endl;
+    ctx_ << "double v;" << endl;
+    ctx_ << "std::memcpy(&v, &bits, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline float read_float32(const uint8_t*& p, const uint8_t* end) { return read_float32_le(p, end); }" << endl;
+    ctx_ << "inline double read_float64(const uint8_t*& p, const uint8_t* end) { return read_float64_le(p, end); }" << endl;
+    ctx_ << blank;
+    if (!padded_input_) {
+        generate_byteswap_helpers();
+    }
+    ctx_ << "// Bulk array readers: one bounds check for the whole run, then a straight" << endl;
+    if (cpu_dispatch_) {
+        ctx_ << "// copy when the wire order matches the host, or the dispatched byte-swap" << endl;
+        ctx_ << "// kernel when it does not" << endl;
+    } else {
+        ctx_ << "// copy when the wire order matches the host, or a byte-swap loop the" << endl;
+        ctx_ << "// compiler can vectorize when it does not" << endl;
+    }
+    ctx_ << "template<size_t N> struct array_word;" << endl;
+    ctx_ << "template<> struct array_word<1> { using type = uint8_t; };" << endl;
+    ctx_ << "template<> struct array_word<2> { using type = uint16_t; };" << endl;
+    ctx_ << "template<> struct array_word<4> { using type = uint32_t; };" << endl;
+    ctx_ << "template<> struct array_word<8> { using type = uint64_t; };" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void copy_array_swapped(const uint8_t* p, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    if (cpu_dispatch_) {
+        ctx_ << "uint8_t* dst = reinterpret_cast<uint8_t*>(out);" << endl;
+        ctx_ << "if constexpr (sizeof(T) == 2) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().byteswap16(dst, p, count);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else if constexpr (sizeof(T) == 4) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().byteswap32(dst, p, count);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else if constexpr (sizeof(T) == 8) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().byteswap64(dst, p, count);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else if (count > 0) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "std::memcpy(dst, p, count);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    } else {
+        ctx_ << "using W = typename array_word<sizeof(T)>::type;" << endl;
+        ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "W w;" << endl;
+        ctx_ << "std::memcpy(&w, p + i * sizeof(T), sizeof(W));" << endl;
+        ctx_ << "w = byteswap_word(w);" << endl;
+        ctx_ << "std::memcpy(&out[i], &w, sizeof(T));" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_le(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Buffer underflow reading array\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__" << endl;
+    ctx_ << "copy_array_swapped(p, out, count);" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "if (count > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::memcpy(out, p, count * sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Buffer underflow reading array\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__" << endl;
+    ctx_ << "if (count > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::memcpy(out, p, count * sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "copy_array_swapped(p, out, count);" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Capacity for an array read until the end of the input: the remaining" << endl;
+    ctx_ << "// bytes over the element's (minimum) wire size, at most max_elements" << endl;
+    ctx_ << "template<typename Vec>" << endl;
+    ctx_ << "inline void reserve_remaining(Vec& out, const uint8_t* p, const uint8_t* end, size_t wire_size," << endl;
+    ctx_ << "                              size_t max_elements = SIZE_MAX) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t count = p < end ? static_cast<size_t>(end - p) / wire_size : 0;" << endl;
+    ctx_ << "out.reserve(out.size() + (count < max_elements ? count : max_elements));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppHelperGenerator::generate_checked_readers() {
     // uint8 reader with bounds checking
     ctx_.start_inline_function("uint8_t", "read_uint8", "const uint8_t*& p, const uint8_t* end");
     ctx_.start_if("p + 1 > end");
@@ -157,15 +326,132 @@ void CppHelperGenerator::generate_binary_readers() {
     ctx_ << "return v;" << endl;
     ctx_.end_inline_function();
     ctx_ << blank;
+}
 
-    // int readers (just cast from unsigned, bounds checking delegated to unsigned readers)
-    ctx_ << "inline int8_t read_int8(const uint8_t*& p, const uint8_t* end) { return static_cast<int8_t>(read_uint8(p, end)); }" << endl;
-    ctx_ << "inline int16_t read_int16_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int16_t>(read_uint16_le(p, end)); }" << endl;
-    ctx_ << "inline int16_t read_int16_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int16_t>(read_uint16_be(p, end)); }" << endl;
-    ctx_ << "inline int32_t read_int32_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int32_t>(read_uint32_le(p, end)); }" << endl;
-    ctx_ << "inline int32_t read_int32_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int32_t>(read_uint32_be(p, end)); }" << endl;
-    ctx_ << "inline int64_t read_int64_le(const uint8_t*& p, const uint8_t* end) { return static_cast<int64_t>(read_uint64_le(p, end)); }" << endl;
-    ctx_ << "inline int64_t read_int64_be(const uint8_t*& p, const uint8_t* end) { return static_cast<int64_t>(read_uint64_be(p, end)); }" << endl;
+void CppHelperGenerator::generate_byteswap_helpers() {
+    ctx_ << "// Byte swapping for wire words whose order differs from the host" << endl;
+    ctx_ << "inline uint8_t byteswap_word(uint8_t v) { return v; }" << endl;
+    ctx_ << "inline uint16_t byteswap_word(uint16_t v) { return static_cast<uint16_t>((v >> 8) | (v << 8)); }" << endl;
+    ctx_ << "inline uint32_t byteswap_word(uint32_t v) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline uint64_t byteswap_word(uint64_t v) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return (static_cast<uint64_t>(byteswap_word(static_cast<uint32_t>(v))) << 32) |" << endl;
+    ctx_ << "       byteswap_word(static_cast<uint32_t>(v >> 32));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppHelperGenerator::generate_padded_input_includes() {
+    ctx_ << "#include <memory>" << endl;
+    ctx_ << "#include <span>" << endl;
+}
+
+void CppHelperGenerator::generate_padded_input() {
+    ctx_ << "// Padded input: every buffer handed to a reader is followed by" << endl;
+    ctx_ << "// input_padding readable bytes, so fixed-width fields load without a" << endl;
+    ctx_ << "// bounds check. A truncated input only moves the read pointer past end;" << endl;
+    ctx_ << "// readers call check_input_end() at their checkpoints (strings, arrays," << endl;
+    ctx_ << "// labels, backtracking, return) before the position or a decoded count" << endl;
+    ctx_ << "// is used" << endl;
+    ctx_ << "inline constexpr size_t input_padding = 8;" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Owns a copy of the input followed by input_padding zero bytes" << endl;
+    ctx_.start_class("PaddedBuffer");
+    ctx_ << "public:" << endl;
+    ctx_ << "PaddedBuffer() : PaddedBuffer(0) {}" << endl;
+    ctx_ << blank;
+    ctx_ << "// size zero bytes, filled through data()" << endl;
+    ctx_ << "explicit PaddedBuffer(size_t size)" << endl;
+    ctx_ << "    : bytes_(new uint8_t[size + input_padding]()), size_(size) {}" << endl;
+    ctx_ << blank;
+    ctx_ << "static PaddedBuffer copy_of(const uint8_t* data, size_t size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "PaddedBuffer buffer(size);" << endl;
+    ctx_.start_if("size > 0");
+    ctx_ << "std::memcpy(buffer.bytes_.get(), data, size);" << endl;
+    ctx_.end_if();
+    ctx_ << "return buffer;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "static PaddedBuffer copy_of(std::span<const uint8_t> data) { return copy_of(data.data(), data.size()); }" << endl;
+    ctx_ << blank;
+    ctx_ << "uint8_t* data() { return bytes_.get(); }" << endl;
+    ctx_ << "const uint8_t* data() const { return bytes_.get(); }" << endl;
+    ctx_ << "size_t size() const { return size_; }" << endl;
+    ctx_ << "std::span<const uint8_t> span() const { return {bytes_.get(), size_}; }" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "std::unique_ptr<uint8_t[]> bytes_;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_.end_class();
+    ctx_ << blank;
+
+    ctx_.start_inline_function("void", "check_input_end", "const uint8_t* p, const uint8_t* end");
+    ctx_.start_if("p > end");
+    ctx_ << "throw std::runtime_error(\"Buffer underflow\");" << endl;
+    ctx_.end_if();
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    ctx_ << "// One unaligned load of a wire word; past end it loads the padding" << endl;
+    ctx_ << "// instead, so the value is garbage but the access stays in bounds" << endl;
+    ctx_ << "template<typename W>" << endl;
+    ctx_ << "inline W load_padded_word(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static_assert(sizeof(W) <= input_padding);" << endl;
+    ctx_ << "W w;" << endl;
+    ctx_ << "std::memcpy(&w, p < end ? p : end, sizeof(W));" << endl;
+    ctx_ << "return w;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "template<typename W>" << endl;
+    ctx_ << "inline W read_padded_le(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "W v = load_padded_word<W>(p, end);" << endl;
+    ctx_ << "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__" << endl;
+    ctx_ << "v = byteswap_word(v);" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "p += sizeof(W);" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "template<typename W>" << endl;
+    ctx_ << "inline W read_padded_be(const uint8_t*& p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "W v = load_padded_word<W>(p, end);" << endl;
+    ctx_ << "#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__" << endl;
+    ctx_ << "v = byteswap_word(v);" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "p += sizeof(W);" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "inline uint8_t read_uint8(const uint8_t*& p, const uint8_t* end) { return read_padded_le<uint8_t>(p, end); }" << endl;
+    ctx_ << "inline uint16_t read_uint16(const uint8_t*& p, const uint8_t* end) { return read_padded_le<uint16_t>(p, end); }" << endl;
+    ctx_ << "inline uint32_t read_uint32(const uint8_t*& p, const uint8_t* end) { return read_padded_le<uint32_t>(p, end); }" << endl;
+    ctx_ << "inline uint64_t read_uint64(const uint8_t*& p, const uint8_t* end) { return read_padded_le<uint64_t>(p, end); }" << endl;
+    ctx_ << blank;
+    ctx_ << "inline uint16_t read_uint16_le(const uint8_t*& p, const uint8_t* end) { return read_uint16(p, end); }" << endl;
+    ctx_ << "inline uint32_t read_uint32_le(const uint8_t*& p, const uint8_t* end) { return read_uint32(p, end); }" << endl;
+    ctx_ << "inline uint64_t read_uint64_le(const uint8_t*& p, const uint8_t* end) { return read_uint64(p, end); }" << endl;
+    ctx_ << blank;
+    ctx_ << "inline uint16_t read_uint16_be(const uint8_t*& p, const uint8_t* end) { return read_padded_be<uint16_t>(p, end); }" << endl;
+    ctx_ << "inline uint32_t read_uint32_be(const uint8_t*& p, const uint8_t* end) { return read_padded_be<uint32_t>(p, end); }" << endl;
+    ctx_ << "inline uint64_t read_uint64_be(const uint8_t*& p, const uint8_t* end) { return read_padded_be<uint64_t>(p, end); }" << endl;
     ctx_ << blank;
 }
 
@@ -260,15 +546,25 @@ void CppHelperGenerator::generate_peek_helpers() {
 }
 
 void CppHelperGenerator::generate_string_readers() {
+    // Advance data to the null terminator, or to end when there is none
+    auto scan_to_terminator = [this] {
+        if (cpu_dispatch_) {
+            ctx_ << "const uint8_t* terminator = data < end ? cpu::kernels().find_zero8(data, end) : nullptr;" << endl;
+            ctx_ << "data = terminator != nullptr ? terminator : end;" << endl;
+        } else {
+            ctx_.start_while("data < end && *data != 0");
+            ctx_ << "data++;" << endl;
+            ctx_.end_while();
+        }
+    };
+
     // String reader (exception mode) - only emit if exceptions are enabled
     bool emit_exception_mode = (error_handling_ == cpp_options::exceptions_only ||
                                 error_handling_ == cpp_options::both);
     if (emit_exception_mode) {
         ctx_.start_inline_function("std::string", "read_string", "const uint8_t*& data, const uint8_t* end");
         ctx_ << "const uint8_t* start = data;" << endl;
-        ctx_.start_while("data < end && *data != 0");
-        ctx_ << "data++;" << endl;
-        ctx_.end_while();
+        scan_to_terminator();
         ctx_.start_if("data >= end");
         ctx_ << "throw std::runtime_error(\"String not null-terminated before end of buffer\");" << endl;
         ctx_.end_if();
@@ -293,9 +589,7 @@ void CppHelperGenerator::generate_string_readers() {
         // String reader (safe mode)
         ctx_.start_inline_function("ReadResult<std::string>", "read_string_safe", "const uint8_t*& data, const uint8_t* end");
         ctx_ << "const uint8_t* start = data;" << endl;
-        ctx_.start_while("data < end && *data != 0");
-        ctx_ << "data++;" << endl;
-        ctx_.end_while();
+        scan_to_terminator();
         ctx_.start_if("data >= end");
         ctx_ << "ReadResult<std::string> result;" << endl;
         ctx_ << "result.error_message = \"String not null-terminated before end of buffer\";" << endl;
@@ -391,4 +685,4690 @@ void CppHelperGenerator::generate_string_readers() {
     }
 }
 
+void CppHelperGenerator::generate_decode_cache() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Decode Cache" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+
+    // XXH64 building blocks
+    ctx_ << "constexpr uint64_t DECODE_CACHE_PRIME1 = 0x9E3779B185EBCA87ULL;" << endl;
+    ctx_ << "constexpr uint64_t DECODE_CACHE_PRIME2 = 0xC2B2AE3D27D4EB4FULL;" << endl;
+    ctx_ << "constexpr uint64_t DECODE_CACHE_PRIME3 = 0x165667B19E3779F9ULL;" << endl;
+    ctx_ << "constexpr uint64_t DECODE_CACHE_PRIME4 = 0x85EBCA77C2B2AE63ULL;" << endl;
+    ctx_ << "constexpr uint64_t DECODE_CACHE_PRIME5 = 0x27D4EB2F165667C5ULL;" << endl;
+    ctx_ << blank;
+
+    ctx_.start_inline_function("uint64_t", "decode_cache_rotl", "uint64_t x, int r");
+    ctx_ << "return (x << r) | (x >> (64 - r));" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    ctx_.start_inline_function("uint64_t", "decode_cache_load64", "const uint8_t* p");
+    ctx_ << "uint64_t v;" << endl;
+    ctx_ << "std::memcpy(&v, p, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    ctx_.start_inline_function("uint32_t", "decode_cache_load32", "const uint8_t* p");
+    ctx_ << "uint32_t v;" << endl;
+    ctx_ << "std::memcpy(&v, p, sizeof(v));" << endl;
+    ctx_ << "return v;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    ctx_.start_inline_function("uint64_t", "decode_cache_round", "uint64_t acc, uint64_t input");
+    ctx_ << "acc += input * DECODE_CACHE_PRIME2;" << endl;
+    ctx_ << "acc = decode_cache_rotl(acc, 31);" << endl;
+    ctx_ << "return acc * DECODE_CACHE_PRIME1;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    ctx_.start_inline_function("uint64_t", "decode_cache_merge", "uint64_t acc, uint64_t val");
+    ctx_ << "acc ^= decode_cache_round(0, val);" << endl;
+    ctx_ << "return acc * DECODE_CACHE_PRIME1 + DECODE_CACHE_PRIME4;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    // XXH64 over the raw input bytes (the cache key)
+    ctx_ << "// 64-bit XXH64 hash of raw input bytes (decode cache key)" << endl;
+    ctx_.start_inline_function("uint64_t", "decode_cache_hash", "const uint8_t* p, size_t len, uint64_t seed = 0");
+    ctx_ << "const uint8_t* const limit = p + len;" << endl;
+    ctx_ << "uint64_t h;" << endl;
+    ctx_.start_if("len >= 32");
+    ctx_ << "uint64_t v1 = seed + DECODE_CACHE_PRIME1 + DECODE_CACHE_PRIME2;" << endl;
+    ctx_ << "uint64_t v2 = seed + DECODE_CACHE_PRIME2;" << endl;
+    ctx_ << "uint64_t v3 = seed;" << endl;
+    ctx_ << "uint64_t v4 = seed - DECODE_CACHE_PRIME1;" << endl;
+    ctx_.start_while("p + 32 <= limit");
+    ctx_ << "v1 = decode_cache_round(v1, decode_cache_load64(p));" << endl;
+    ctx_ << "v2 = decode_cache_round(v2, decode_cache_load64(p + 8));" << endl;
+    ctx_ << "v3 = decode_cache_round(v3, decode_cache_load64(p + 16));" << endl;
+    ctx_ << "v4 = decode_cache_round(v4, decode_cache_load64(p + 24));" << endl;
+    ctx_ << "p += 32;" << endl;
+    ctx_.end_while();
+    ctx_ << "h = decode_cache_rotl(v1, 1) + decode_cache_rotl(v2, 7) +" << endl;
+    ctx_ << "    decode_cache_rotl(v3, 12) + decode_cache_rotl(v4, 18);" << endl;
+    ctx_ << "h = decode_cache_merge(h, v1);" << endl;
+    ctx_ << "h = decode_cache_merge(h, v2);" << endl;
+    ctx_ << "h = decode_cache_merge(h, v3);" << endl;
+    ctx_ << "h = decode_cache_merge(h, v4);" << endl;
+    ctx_.start_else();
+    ctx_ << "h = seed + DECODE_CACHE_PRIME5;" << endl;
+    ctx_.end_if();
+    ctx_ << "h += static_cast<uint64_t>(len);" << endl;
+    ctx_.start_while("p + 8 <= limit");
+    ctx_ << "h ^= decode_cache_round(0, decode_cache_load64(p));" << endl;
+    ctx_ << "h = decode_cache_rotl(h, 27) * DECODE_CACHE_PRIME1 + DECODE_CACHE_PRIME4;" << endl;
+    ctx_ << "p += 8;" << endl;
+    ctx_.end_while();
+    ctx_.start_if("p + 4 <= limit");
+    ctx_ << "h ^= static_cast<uint64_t>(decode_cache_load32(p)) * DECODE_CACHE_PRIME1;" << endl;
+    ctx_ << "h = decode_cache_rotl(h, 23) * DECODE_CACHE_PRIME2 + DECODE_CACHE_PRIME3;" << endl;
+    ctx_ << "p += 4;" << endl;
+    ctx_.end_if();
+    ctx_.start_while("p < limit");
+    ctx_ << "h ^= static_cast<uint64_t>(*p) * DECODE_CACHE_PRIME5;" << endl;
+    ctx_ << "h = decode_cache_rotl(h, 11) * DECODE_CACHE_PRIME1;" << endl;
+    ctx_ << "++p;" << endl;
+    ctx_.end_while();
+    ctx_ << "h ^= h >> 33;" << endl;
+    ctx_ << "h *= DECODE_CACHE_PRIME2;" << endl;
+    ctx_ << "h ^= h >> 29;" << endl;
+    ctx_ << "h *= DECODE_CACHE_PRIME3;" << endl;
+    ctx_ << "h ^= h >> 32;" << endl;
+    ctx_ << "return h;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+
+    // Thread-safe, size-bounded LRU cache of immutable decoded objects
+    ctx_ << "/**" << endl;
+    ctx_ << " * Content-addressed cache of decoded objects." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * Keyed by the XXH64 hash of the raw input bytes; the key bytes are kept" << endl;
+    ctx_ << " * and compared on lookup, so hash collisions never return a wrong object." << endl;
+    ctx_ << " * Holds at most capacity() entries (least recently used evicted first)." << endl;
+    ctx_ << " * Safe to share between threads; decoded values are immutable." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_.start_class("DecodeCache");
+    ctx_ << "public:" << endl;
+    ctx_ << "explicit DecodeCache(size_t capacity) : capacity_(capacity) {}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "std::shared_ptr<const T> find(uint64_t hash, const uint8_t* key, size_t key_len, size_t& consumed) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex_);" << endl;
+    ctx_ << "auto it = index_.find(hash);" << endl;
+    ctx_ << "bool match = it != index_.end() && it->second->key.size() == key_len &&" << endl;
+    ctx_ << "             (key_len == 0 || std::memcmp(it->second->key.data(), key, key_len) == 0);" << endl;
+    ctx_.start_if("!match");
+    ctx_ << "misses_.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "return nullptr;" << endl;
+    ctx_.end_if();
+    ctx_ << "entries_.splice(entries_.begin(), entries_, it->second);" << endl;
+    ctx_ << "hits_.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "consumed = it->second->consumed;" << endl;
+    ctx_ << "return it->second->value;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "void insert(uint64_t hash, const uint8_t* key, size_t key_len, size_t consumed," << endl;
+    ctx_ << "            std::shared_ptr<const T> value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex_);" << endl;
+    ctx_ << "if (capacity_ == 0) return;" << endl;
+    ctx_ << "auto it = index_.find(hash);" << endl;
+    ctx_.start_if("it != index_.end()");
+    ctx_ << "entries_.erase(it->second);" << endl;
+    ctx_ << "index_.erase(it);" << endl;
+    ctx_.end_if();
+    ctx_ << "entries_.push_front(Entry{hash, std::vector<uint8_t>(key, key + key_len), consumed, std::move(value)});" << endl;
+    ctx_ << "index_[hash] = entries_.begin();" << endl;
+    ctx_ << "evict_locked();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "void clear() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex_);" << endl;
+    ctx_ << "entries_.clear();" << endl;
+    ctx_ << "index_.clear();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "void set_capacity(size_t capacity) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex_);" << endl;
+    ctx_ << "capacity_ = capacity;" << endl;
+    ctx_ << "evict_locked();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "size_t capacity() const { std::lock_guard<std::mutex> lock(mutex_); return capacity_; }" << endl;
+    ctx_ << "size_t size() const { std::lock_guard<std::mutex> lock(mutex_); return entries_.size(); }" << endl;
+    ctx_ << "uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }" << endl;
+    ctx_ << "uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }" << endl;
+    ctx_ << "void reset_stats() { hits_.store(0); misses_.store(0); }" << endl;
+    ctx_ << blank;
+
+    ctx_ << "private:" << endl;
+    ctx_ << "struct Entry {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t hash;" << endl;
+    ctx_ << "std::vector<uint8_t> key;" << endl;
+    ctx_ << "size_t consumed;" << endl;
+    ctx_ << "std::shared_ptr<const T> value;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+
+    ctx_ << "void evict_locked() {" << endl;
+    ctx_.writer().indent();
+    ctx_.start_while("entries_.size() > capacity_");
+    ctx_ << "index_.erase(entries_.back().hash);" << endl;
+    ctx_ << "entries_.pop_back();" << endl;
+    ctx_.end_while();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "mutable std::mutex mutex_;" << endl;
+    ctx_ << "size_t capacity_;" << endl;
+    ctx_ << "std::list<Entry> entries_;" << endl;
+    ctx_ << "std::unordered_map<uint64_t, typename std::list<Entry>::iterator> index_;" << endl;
+    ctx_ << "std::atomic<uint64_t> hits_{0};" << endl;
+    ctx_ << "std::atomic<uint64_t> misses_{0};" << endl;
+    ctx_.end_class();
+}
+
+void CppHelperGenerator::generate_bulk_ingest_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <atomic>" << endl;
+    ctx_ << "#include <cerrno>" << endl;
+    ctx_ << "#include <condition_variable>" << endl;
+    ctx_ << "#include <cstring>" << endl;
+    ctx_ << "#include <deque>" << endl;
+    ctx_ << "#include <fstream>" << endl;
+    ctx_ << "#include <functional>" << endl;
+    ctx_ << "#include <iterator>" << endl;
+    ctx_ << "#include <memory>" << endl;
+    ctx_ << "#include <mutex>" << endl;
+    ctx_ << "#include <system_error>" << endl;
+    ctx_ << "#include <thread>" << endl;
+    ctx_ << "#if defined(__unix__) || defined(__APPLE__)" << endl;
+    ctx_ << "#include <fcntl.h>" << endl;
+    ctx_ << "#include <sys/stat.h>" << endl;
+    ctx_ << "#include <unistd.h>" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "#if defined(__linux__) && defined(__has_include)" << endl;
+    ctx_ << "#if __has_include(<linux/io_uring.h>)" << endl;
+    ctx_ << "#include <linux/io_uring.h>" << endl;
+    ctx_ << "#include <sys/mman.h>" << endl;
+    ctx_ << "#include <sys/syscall.h>" << endl;
+    ctx_ << "#include <sys/uio.h>" << endl;
+    ctx_ << "#define DATASCRIPT_BULK_IO_URING 1" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_bulk_ingest() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Bulk Ingestion" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+
+    ctx_ << "/**" << endl;
+    ctx_ << " * Options for bulk_ingest() / BulkReader." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "struct BulkIngestOptions {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t queue_depth = 64;           // Reads in flight (= number of recycled buffers)" << endl;
+    ctx_ << "size_t buffer_size = 64 * 1024;    // Bytes per buffer; larger files are read separately" << endl;
+    ctx_ << "size_t workers = 0;                // Parse threads (0 = hardware concurrency)" << endl;
+    ctx_ << "bool use_io_uring = true;          // Try io_uring first (Linux), else pread thread pool" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Counters reported by a bulk ingestion run." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "struct BulkIngestStats {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t files = 0;                // Files handed to the callback" << endl;
+    ctx_ << "uint64_t bytes = 0;                // Total bytes read" << endl;
+    ctx_ << "uint64_t io_errors = 0;            // Files that could not be opened or read" << endl;
+    ctx_ << "uint64_t parse_errors = 0;         // Callbacks that threw" << endl;
+    ctx_ << "bool used_io_uring = false;        // True if the io_uring backend ran" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Reads many files and hands each one, fully read, to a callback on a" << endl;
+    ctx_ << " * worker pool." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * On Linux reads go through io_uring with registered (fixed) buffers and a" << endl;
+    ctx_ << " * bounded in-flight window of queue_depth reads. A buffer returns to the" << endl;
+    ctx_ << " * pool as soon as the callback for its file returns, so memory use is" << endl;
+    ctx_ << " * queue_depth * buffer_size regardless of the number of files. Files larger" << endl;
+    ctx_ << " * than buffer_size, and every file when io_uring is unavailable, are read" << endl;
+    ctx_ << " * with pread() on the worker threads instead." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * The callback is invoked as fn(index, data, size) concurrently from" << endl;
+    ctx_ << " * several threads; `data` is only valid during the call." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class BulkReader {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit BulkReader(BulkIngestOptions options = {}) : options_(options) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (options_.queue_depth == 0) options_.queue_depth = 1;" << endl;
+    ctx_ << "if (options_.workers == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "options_.workers = std::max<size_t>(1, std::thread::hardware_concurrency());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename Fn>" << endl;
+    ctx_ << "BulkIngestStats run(const std::vector<std::string>& paths, Fn&& fn) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "State state(paths, options_.workers);" << endl;
+    ctx_ << "auto deliver = [&](size_t index, const uint8_t* data, size_t len) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "fn(index, data, len);" << endl;
+    ctx_ << "state.files.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "state.bytes.fetch_add(len, std::memory_order_relaxed);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (...) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "state.parse_errors.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "bool done = false;" << endl;
+    ctx_ << "#if defined(DATASCRIPT_BULK_IO_URING)" << endl;
+    ctx_ << "if (options_.use_io_uring) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "done = run_io_uring(state, deliver);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "if (!done) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_pread(state, deliver);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return state.stats(done);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "struct State {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "State(const std::vector<std::string>& p, size_t workers) : paths(p), worker_count(workers) {}" << endl;
+    ctx_ << "const std::vector<std::string>& paths;" << endl;
+    ctx_ << "size_t worker_count;" << endl;
+    ctx_ << "std::atomic<uint64_t> files{0};" << endl;
+    ctx_ << "std::atomic<uint64_t> bytes{0};" << endl;
+    ctx_ << "std::atomic<uint64_t> io_errors{0};" << endl;
+    ctx_ << "std::atomic<uint64_t> parse_errors{0};" << endl;
+    ctx_ << blank;
+    ctx_ << "BulkIngestStats stats(bool io_uring) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "BulkIngestStats s;" << endl;
+    ctx_ << "s.files = files.load();" << endl;
+    ctx_ << "s.bytes = bytes.load();" << endl;
+    ctx_ << "s.io_errors = io_errors.load();" << endl;
+    ctx_ << "s.parse_errors = parse_errors.load();" << endl;
+    ctx_ << "s.used_io_uring = io_uring;" << endl;
+    ctx_ << "return s;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Worker threads joined on every exit path, so an exception between spawn" << endl;
+    ctx_ << "// and join never reaches ~thread() with a joinable thread. `wake` runs" << endl;
+    ctx_ << "// before joining so workers blocked on a queue see the shutdown." << endl;
+    ctx_ << "class Workers {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit Workers(std::function<void()> wake = {}) : wake_(std::move(wake)) {}" << endl;
+    ctx_ << "Workers(const Workers&) = delete;" << endl;
+    ctx_ << "Workers& operator=(const Workers&) = delete;" << endl;
+    ctx_ << "~Workers() { join(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "// Start up to `count` threads running fn; returns how many started" << endl;
+    ctx_ << "template<typename Fn>" << endl;
+    ctx_ << "size_t spawn(size_t count, Fn& fn) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "threads_.reserve(count);" << endl;
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "threads_.emplace_back(std::ref(fn));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (const std::system_error&) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "break;  // Run with the threads already started" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return threads_.size();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void join() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (wake_) wake_();" << endl;
+    ctx_ << "for (auto& thread : threads_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (thread.joinable()) thread.join();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "threads_.clear();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "std::function<void()> wake_;" << endl;
+    ctx_ << "std::vector<std::thread> threads_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Read a whole file into `buf`; false on any I/O error" << endl;
+    ctx_ << "static bool read_whole_file(const std::string& path, std::vector<uint8_t>& buf) {" << endl;
+    ctx_ << "#if defined(__unix__) || defined(__APPLE__)" << endl;
+    ctx_.writer().indent();
+    ctx_ << "int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);" << endl;
+    ctx_ << "if (fd < 0) return false;" << endl;
+    ctx_ << "struct stat st{};" << endl;
+    ctx_ << "if (::fstat(fd, &st) != 0) { ::close(fd); return false; }" << endl;
+    ctx_ << "buf.resize(static_cast<size_t>(st.st_size));" << endl;
+    ctx_ << "size_t done = 0;" << endl;
+    ctx_ << "while (done < buf.size()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "ssize_t n = ::pread(fd, buf.data() + done, buf.size() - done, static_cast<off_t>(done));" << endl;
+    ctx_ << "if (n < 0 && errno == EINTR) continue;" << endl;
+    ctx_ << "if (n <= 0) { ::close(fd); return false; }" << endl;
+    ctx_ << "done += static_cast<size_t>(n);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "::close(fd);" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "std::ifstream file(path, std::ios::binary);" << endl;
+    ctx_ << "if (!file) return false;" << endl;
+    ctx_ << "buf.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());" << endl;
+    ctx_ << "return !file.bad();" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Thread-pool fallback: each worker claims files and preads them into a reused buffer" << endl;
+    ctx_ << "template<typename Deliver>" << endl;
+    ctx_ << "void run_pread(State& state, Deliver& deliver) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::atomic<size_t> next{0};" << endl;
+    ctx_ << "auto worker = [&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<uint8_t> buf;" << endl;
+    ctx_ << "for (size_t i = next.fetch_add(1); i < state.paths.size(); i = next.fetch_add(1)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!read_whole_file(state.paths[i], buf)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "state.io_errors.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "deliver(i, buf.data(), buf.size());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "Workers threads;" << endl;
+    ctx_ << "threads.spawn(state.worker_count - 1, worker);" << endl;
+    ctx_ << "worker();  // The calling thread is one of the workers" << endl;
+    ctx_ << "threads.join();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "#if defined(DATASCRIPT_BULK_IO_URING)" << endl;
+    ctx_ << "// Minimal io_uring ring (raw syscalls, no liburing dependency)" << endl;
+    ctx_ << "class Ring {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "bool init(unsigned entries) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "io_uring_params p{};" << endl;
+    ctx_ << "fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));" << endl;
+    ctx_ << "if (fd_ < 0) return false;" << endl;
+    ctx_ << "sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);" << endl;
+    ctx_ << "cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);" << endl;
+    ctx_ << "if (p.features & IORING_FEAT_SINGLE_MMAP) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);" << endl;
+    ctx_ << "if (sq_ptr_ == MAP_FAILED) { sq_ptr_ = nullptr; return false; }" << endl;
+    ctx_ << "if (p.features & IORING_FEAT_SINGLE_MMAP) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "cq_ptr_ = sq_ptr_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "cq_ptr_ = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);" << endl;
+    ctx_ << "if (cq_ptr_ == MAP_FAILED) { cq_ptr_ = nullptr; return false; }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);" << endl;
+    ctx_ << "void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);" << endl;
+    ctx_ << "if (sqes == MAP_FAILED) return false;" << endl;
+    ctx_ << "sqes_ = static_cast<io_uring_sqe*>(sqes);" << endl;
+    ctx_ << "auto* sq = static_cast<char*>(sq_ptr_);" << endl;
+    ctx_ << "auto* cq = static_cast<char*>(cq_ptr_);" << endl;
+    ctx_ << "sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);" << endl;
+    ctx_ << "sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);" << endl;
+    ctx_ << "sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);" << endl;
+    ctx_ << "cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);" << endl;
+    ctx_ << "cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);" << endl;
+    ctx_ << "cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);" << endl;
+    ctx_ << "cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "~Ring() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (sqes_) ::munmap(sqes_, sqes_size_);" << endl;
+    ctx_ << "if (cq_ptr_ && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_size_);" << endl;
+    ctx_ << "if (sq_ptr_) ::munmap(sq_ptr_, sq_size_);" << endl;
+    ctx_ << "if (fd_ >= 0) ::close(fd_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "bool register_buffers(const iovec* iov, unsigned count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iov, count) == 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Completions of queue_cancel() carry this tag instead of a slot index" << endl;
+    ctx_ << "static constexpr uint64_t cancel_tag = ~uint64_t{0};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Queue one read; fixed_index < 0 uses a plain (unregistered) READV" << endl;
+    ctx_ << "void queue_read(int fd, iovec* iov, uint64_t offset, int fixed_index, uint64_t user_data) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "io_uring_sqe* sqe = next_sqe();" << endl;
+    ctx_ << "sqe->fd = fd;" << endl;
+    ctx_ << "sqe->off = offset;" << endl;
+    ctx_ << "sqe->user_data = user_data;" << endl;
+    ctx_ << "if (fixed_index >= 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "sqe->opcode = IORING_OP_READ_FIXED;" << endl;
+    ctx_ << "sqe->addr = reinterpret_cast<uint64_t>(iov->iov_base);" << endl;
+    ctx_ << "sqe->len = static_cast<uint32_t>(iov->iov_len);" << endl;
+    ctx_ << "sqe->buf_index = static_cast<uint16_t>(fixed_index);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "sqe->opcode = IORING_OP_READV;" << endl;
+    ctx_ << "sqe->addr = reinterpret_cast<uint64_t>(iov);" << endl;
+    ctx_ << "sqe->len = 1;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "push_sqe();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Queue a cancel of the read queued with user_data" << endl;
+    ctx_ << "void queue_cancel(uint64_t user_data) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "io_uring_sqe* sqe = next_sqe();" << endl;
+    ctx_ << "sqe->opcode = IORING_OP_ASYNC_CANCEL;" << endl;
+    ctx_ << "sqe->fd = -1;" << endl;
+    ctx_ << "sqe->addr = user_data;" << endl;
+    ctx_ << "sqe->user_data = cancel_tag;" << endl;
+    ctx_ << "push_sqe();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Submit queued reads and optionally wait for at least one completion" << endl;
+    ctx_ << "bool enter(bool wait) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "unsigned busy_retries = 0;" << endl;
+    ctx_ << "for (;;) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0u;" << endl;
+    ctx_ << "long r = ::syscall(__NR_io_uring_enter, fd_, pending_submit_, wait ? 1u : 0u, flags, nullptr, 0);" << endl;
+    ctx_ << "if (r >= 0) { pending_submit_ -= static_cast<unsigned>(r); return true; }" << endl;
+    ctx_ << "if (errno == EINTR) continue;" << endl;
+    ctx_ << "if (errno != EAGAIN && errno != EBUSY) return false;" << endl;
+    ctx_ << "// Out of kernel resources or completion queue full: transient, so" << endl;
+    ctx_ << "// let the caller reap what has completed, or back off and retry" << endl;
+    ctx_ << "if (has_completions()) return true;" << endl;
+    ctx_ << "if (++busy_retries > 1000) return false;" << endl;
+    ctx_ << "std::this_thread::yield();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "bool pop(uint64_t& user_data, int& res) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "unsigned head = *cq_head_;" << endl;
+    ctx_ << "if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;" << endl;
+    ctx_ << "const io_uring_cqe& cqe = cqes_[head & cq_mask_];" << endl;
+    ctx_ << "user_data = cqe.user_data;" << endl;
+    ctx_ << "res = cqe.res;" << endl;
+    ctx_ << "__atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "bool has_completions() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Zeroed entry at the submission queue tail; push_sqe() publishes it" << endl;
+    ctx_ << "io_uring_sqe* next_sqe() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "io_uring_sqe* sqe = &sqes_[*sq_tail_ & sq_mask_];" << endl;
+    ctx_ << "std::memset(sqe, 0, sizeof(*sqe));" << endl;
+    ctx_ << "return sqe;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void push_sqe() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "unsigned tail = *sq_tail_;" << endl;
+    ctx_ << "sq_array_[tail & sq_mask_] = tail & sq_mask_;" << endl;
+    ctx_ << "__atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);" << endl;
+    ctx_ << "++pending_submit_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "int fd_ = -1;" << endl;
+    ctx_ << "void* sq_ptr_ = nullptr;" << endl;
+    ctx_ << "void* cq_ptr_ = nullptr;" << endl;
+    ctx_ << "size_t sq_size_ = 0;" << endl;
+    ctx_ << "size_t cq_size_ = 0;" << endl;
+    ctx_ << "size_t sqes_size_ = 0;" << endl;
+    ctx_ << "io_uring_sqe* sqes_ = nullptr;" << endl;
+    ctx_ << "unsigned* sq_tail_ = nullptr;" << endl;
+    ctx_ << "unsigned sq_mask_ = 0;" << endl;
+    ctx_ << "unsigned* sq_array_ = nullptr;" << endl;
+    ctx_ << "unsigned* cq_head_ = nullptr;" << endl;
+    ctx_ << "unsigned* cq_tail_ = nullptr;" << endl;
+    ctx_ << "unsigned cq_mask_ = 0;" << endl;
+    ctx_ << "io_uring_cqe* cqes_ = nullptr;" << endl;
+    ctx_ << "unsigned pending_submit_ = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "struct Slot {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "iovec iov{};          // Whole slot buffer (registered)" << endl;
+    ctx_ << "iovec pending{};      // Remaining part of the current read" << endl;
+    ctx_ << "int fd = -1;" << endl;
+    ctx_ << "size_t file_index = 0;" << endl;
+    ctx_ << "size_t size = 0;" << endl;
+    ctx_ << "size_t done = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename Deliver>" << endl;
+    ctx_ << "bool run_io_uring(State& state, Deliver& deliver) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t depth = options_.queue_depth;" << endl;
+    ctx_ << "// Read buffers and slots (whose iovecs READV points at) outlive the" << endl;
+    ctx_ << "// ring; if its reads cannot be reaped they are leaked, never freed" << endl;
+    ctx_ << "std::unique_ptr<uint8_t[]> arena_storage(new uint8_t[depth * options_.buffer_size]);" << endl;
+    ctx_ << "std::unique_ptr<Slot[]> slot_storage(new Slot[depth]);" << endl;
+    ctx_ << "uint8_t* const arena = arena_storage.get();" << endl;
+    ctx_ << "Slot* const slots = slot_storage.get();" << endl;
+    ctx_ << "Ring ring;" << endl;
+    ctx_ << "// Room for every read plus a cancel of each" << endl;
+    ctx_ << "if (!ring.init(static_cast<unsigned>(2 * depth))) return false;" << endl;
+    ctx_ << blank;
+    ctx_ << "std::vector<iovec> iovs(depth);" << endl;
+    ctx_ << "for (size_t i = 0; i < depth; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "slots[i].iov.iov_base = arena + i * options_.buffer_size;" << endl;
+    ctx_ << "slots[i].iov.iov_len = options_.buffer_size;" << endl;
+    ctx_ << "iovs[i] = slots[i].iov;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const bool fixed = ring.register_buffers(iovs.data(), static_cast<unsigned>(depth));" << endl;
+    ctx_ << blank;
+    ctx_ << "// Free buffer pool (recycled by workers) and the parse job queue" << endl;
+    ctx_ << "std::mutex mutex;" << endl;
+    ctx_ << "std::condition_variable slot_freed;" << endl;
+    ctx_ << "std::condition_variable job_ready;" << endl;
+    ctx_ << "std::vector<size_t> free_slots;" << endl;
+    ctx_ << "for (size_t i = depth; i-- > 0;) free_slots.push_back(i);" << endl;
+    ctx_ << "struct Job { size_t slot; size_t file_index; bool whole_file; };" << endl;
+    ctx_ << "std::deque<Job> jobs;" << endl;
+    ctx_ << "bool io_done = false;" << endl;
+    ctx_ << blank;
+    ctx_ << "auto worker = [&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<uint8_t> large;" << endl;
+    ctx_ << "for (;;) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Job job;" << endl;
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::unique_lock<std::mutex> lock(mutex);" << endl;
+    ctx_ << "job_ready.wait(lock, [&] { return !jobs.empty() || io_done; });" << endl;
+    ctx_ << "if (jobs.empty()) return;" << endl;
+    ctx_ << "job = jobs.front();" << endl;
+    ctx_ << "jobs.pop_front();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (job.whole_file) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (read_whole_file(state.paths[job.file_index], large)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "deliver(job.file_index, large.data(), large.size());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "state.io_errors.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const Slot& s = slots[job.slot];" << endl;
+    ctx_ << "deliver(job.file_index, static_cast<const uint8_t*>(s.iov.iov_base), s.size);" << endl;
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "free_slots.push_back(job.slot);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "slot_freed.notify_one();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "Workers threads([&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "io_done = true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "job_ready.notify_all();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "});" << endl;
+    ctx_ << "// Nothing would drain the job queue; let run() fall back to pread" << endl;
+    ctx_ << "if (threads.spawn(state.worker_count, worker) == 0) return false;" << endl;
+    ctx_ << blank;
+    ctx_ << "auto push_job = [&](Job job) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "jobs.push_back(job);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "job_ready.notify_one();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "auto submit = [&](size_t slot_index) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Slot& s = slots[slot_index];" << endl;
+    ctx_ << "s.pending.iov_base = static_cast<uint8_t*>(s.iov.iov_base) + s.done;" << endl;
+    ctx_ << "s.pending.iov_len = s.size - s.done;" << endl;
+    ctx_ << "ring.queue_read(s.fd, &s.pending, s.done, fixed ? static_cast<int>(slot_index) : -1, slot_index);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "size_t next_file = 0;" << endl;
+    ctx_ << "size_t in_flight = 0;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Cancel every read in flight and reap until none is left; false if" << endl;
+    ctx_ << "// the ring fails on the way" << endl;
+    ctx_ << "auto cancel_in_flight = [&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < depth; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (slots[i].fd >= 0) ring.queue_cancel(i);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "uint64_t user_data = 0;" << endl;
+    ctx_ << "int res = 0;" << endl;
+    ctx_ << "while (in_flight > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!ring.enter(true)) return false;" << endl;
+    ctx_ << "while (ring.pop(user_data, res)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (user_data != Ring::cancel_tag) --in_flight;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "while (next_file < state.paths.size() || in_flight > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Fill the in-flight window from the free buffer pool" << endl;
+    ctx_ << "while (next_file < state.paths.size()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t slot_index;" << endl;
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::unique_lock<std::mutex> lock(mutex);" << endl;
+    ctx_ << "if (free_slots.empty()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (in_flight > 0) break;  // Reap completions first" << endl;
+    ctx_ << "slot_freed.wait(lock, [&] { return !free_slots.empty(); });" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "slot_index = free_slots.back();" << endl;
+    ctx_ << "free_slots.pop_back();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const size_t file_index = next_file++;" << endl;
+    ctx_ << "Slot& s = slots[slot_index];" << endl;
+    ctx_ << "s.fd = ::open(state.paths[file_index].c_str(), O_RDONLY | O_CLOEXEC);" << endl;
+    ctx_ << "struct stat st{};" << endl;
+    ctx_ << "if (s.fd < 0 || ::fstat(s.fd, &st) != 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (s.fd >= 0) ::close(s.fd);" << endl;
+    ctx_ << "s.fd = -1;" << endl;
+    ctx_ << "state.io_errors.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "free_slots.push_back(slot_index);" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "s.file_index = file_index;" << endl;
+    ctx_ << "s.size = static_cast<size_t>(st.st_size);" << endl;
+    ctx_ << "s.done = 0;" << endl;
+    ctx_ << "if (s.size > options_.buffer_size || s.size == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "::close(s.fd);" << endl;
+    ctx_ << "s.fd = -1;" << endl;
+    ctx_ << "{" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "free_slots.push_back(slot_index);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (s.size == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "deliver(file_index, nullptr, 0);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "push_job(Job{0, file_index, true});  // Too large for a fixed buffer" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "submit(slot_index);" << endl;
+    ctx_ << "++in_flight;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "if (in_flight == 0) continue;" << endl;
+    ctx_ << "if (!ring.enter(true)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Ring failed mid-run. Its reads may still write into the arena:" << endl;
+    ctx_ << "// reap them, or leak arena and slots if the ring cannot even cancel" << endl;
+    ctx_ << "if (!cancel_in_flight()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "arena_storage.release();" << endl;
+    ctx_ << "slot_storage.release();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Read everything not yet delivered with pread" << endl;
+    ctx_ << "for (size_t i = 0; i < depth; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Slot& s = slots[i];" << endl;
+    ctx_ << "if (s.fd < 0) continue;" << endl;
+    ctx_ << "::close(s.fd);" << endl;
+    ctx_ << "s.fd = -1;" << endl;
+    ctx_ << "push_job(Job{0, s.file_index, true});" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "while (next_file < state.paths.size()) push_job(Job{0, next_file++, true});" << endl;
+    ctx_ << "break;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "uint64_t user_data = 0;" << endl;
+    ctx_ << "int res = 0;" << endl;
+    ctx_ << "while (ring.pop(user_data, res)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Slot& s = slots[static_cast<size_t>(user_data)];" << endl;
+    ctx_ << "if (res > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "s.done += static_cast<size_t>(res);" << endl;
+    ctx_ << "if (s.done < s.size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "submit(static_cast<size_t>(user_data));  // Short read: continue" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "--in_flight;" << endl;
+    ctx_ << "::close(s.fd);" << endl;
+    ctx_ << "s.fd = -1;" << endl;
+    ctx_ << "if (res <= 0 && s.done < s.size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "state.io_errors.fetch_add(1, std::memory_order_relaxed);" << endl;
+    ctx_ << "std::lock_guard<std::mutex> lock(mutex);" << endl;
+    ctx_ << "free_slots.push_back(static_cast<size_t>(user_data));" << endl;
+    ctx_ << "continue;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "push_job(Job{static_cast<size_t>(user_data), s.file_index, false});" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "ring.enter(false);  // Flush resubmitted short reads" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "threads.join();  // Workers drain the remaining jobs, then exit" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << blank;
+    ctx_ << "BulkIngestOptions options_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Read every file in `paths` and decode it as T, invoking" << endl;
+    ctx_ << " * on_record(index, T&&) from the worker pool for each file." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T, typename Fn>" << endl;
+    ctx_ << "BulkIngestStats bulk_ingest(const std::vector<std::string>& paths, Fn&& on_record," << endl;
+    ctx_ << "                            BulkIngestOptions options = {}) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "BulkReader reader(options);" << endl;
+    ctx_ << "return reader.run(paths, [&](size_t index, const uint8_t* data, size_t len) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* p = data;" << endl;
+    ctx_ << "on_record(index, T::read(p, data + len));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "});" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+void CppHelperGenerator::generate_snapshot_includes() {
+    ctx_ << "#include <cstring>" << endl;
+    ctx_ << "#include <fstream>" << endl;
+    ctx_ << "#include <iterator>" << endl;
+    ctx_ << "#include <string_view>" << endl;
+    ctx_ << "#include <utility>" << endl;
+    ctx_ << "#if defined(__unix__) || defined(__APPLE__)" << endl;
+    ctx_ << "#include <fcntl.h>" << endl;
+    ctx_ << "#include <sys/mman.h>" << endl;
+    ctx_ << "#include <sys/stat.h>" << endl;
+    ctx_ << "#include <unistd.h>" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_snapshot() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Snapshots" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+
+    ctx_ << "/**" << endl;
+    ctx_ << " * Thrown when a snapshot is malformed, truncated or built for another schema." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class SnapshotError : public std::runtime_error {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit SnapshotError(const std::string& msg) : std::runtime_error(\"Snapshot error: \" + msg) {}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Snapshot file header (all fields in host byte order)" << endl;
+    ctx_ << "//   char     magic[8]      \"DSSNAP01\"" << endl;
+    ctx_ << "//   uint32_t byte_order    0x01020304 as written by the producing host" << endl;
+    ctx_ << "//   uint32_t version       SNAPSHOT_VERSION" << endl;
+    ctx_ << "//   uint64_t layout_hash   Schema fingerprint of the root type" << endl;
+    ctx_ << "//   uint64_t root_offset   Offset of the root record" << endl;
+    ctx_ << "//   uint64_t total_size    Size of the whole snapshot in bytes" << endl;
+    ctx_ << "constexpr uint32_t SNAPSHOT_VERSION = 1;" << endl;
+    ctx_ << "constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304u;" << endl;
+    ctx_ << "constexpr size_t SNAPSHOT_HEADER_SIZE = 40;" << endl;
+    ctx_ << "constexpr size_t SNAPSHOT_REF_SIZE = 16;   // uint64_t offset + uint64_t count" << endl;
+    ctx_ << "constexpr size_t SNAPSHOT_REF_ALIGN = 8;" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline T snapshot_load(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "T value;" << endl;
+    ctx_ << "std::memcpy(&value, p, sizeof(T));" << endl;
+    ctx_ << "return value;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Builds a snapshot image. Records are laid out at naturally aligned" << endl;
+    ctx_ << " * offsets; strings and arrays live out of line and are referenced by" << endl;
+    ctx_ << " * (offset, count) pairs, so the image contains no pointers." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class SnapshotWriter {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Write the header and reserve the root record; returns its offset" << endl;
+    ctx_ << "size_t begin(uint64_t layout_hash, size_t root_size, size_t root_align) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "buf_.assign(SNAPSHOT_HEADER_SIZE, 0);" << endl;
+    ctx_ << "std::memcpy(buf_.data(), \"DSSNAP01\", 8);" << endl;
+    ctx_ << "put(8, SNAPSHOT_BYTE_ORDER);" << endl;
+    ctx_ << "put(12, SNAPSHOT_VERSION);" << endl;
+    ctx_ << "put(16, layout_hash);" << endl;
+    ctx_ << "size_t root = allocate(root_size, root_align);" << endl;
+    ctx_ << "put(24, static_cast<uint64_t>(root));" << endl;
+    ctx_ << "return root;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Reserve zeroed, aligned space; returns its offset" << endl;
+    ctx_ << "size_t allocate(size_t size, size_t align) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t at = (buf_.size() + align - 1) / align * align;" << endl;
+    ctx_ << "buf_.resize(at + size, 0);" << endl;
+    ctx_ << "return at;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "void put(size_t at, const T& value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::memcpy(buf_.data() + at, &value, sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Store (offset, count) at `at`" << endl;
+    ctx_ << "void put_ref(size_t at, size_t offset, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "put(at, static_cast<uint64_t>(offset));" << endl;
+    ctx_ << "put(at + 8, static_cast<uint64_t>(count));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Copy trivially copyable elements into a record (fixed-size arrays)" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "void put_elements(size_t at, const T* data, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (count != 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::memcpy(buf_.data() + at, data, sizeof(T) * count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Copy trivially copyable elements out of line and reference them" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "void put_array(size_t at, const T* data, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t offset = allocate(sizeof(T) * count, alignof(T));" << endl;
+    ctx_ << "if (count != 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::memcpy(buf_.data() + offset, data, sizeof(T) * count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "put_ref(at, offset, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void put_string(size_t at, const std::string& s) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "put_array(at, s.data(), s.size());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Reserve `count` records out of line and reference them; returns their offset" << endl;
+    ctx_ << "size_t put_records(size_t at, size_t count, size_t record_size, size_t record_align) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t offset = allocate(record_size * count, record_align);" << endl;
+    ctx_ << "put_ref(at, offset, count);" << endl;
+    ctx_ << "return offset;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Finish the image (fills in total_size)" << endl;
+    ctx_ << "std::vector<uint8_t> finish() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "put(32, static_cast<uint64_t>(buf_.size()));" << endl;
+    ctx_ << "return std::move(buf_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "std::vector<uint8_t> buf_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Validate a snapshot header; returns the root record offset" << endl;
+    ctx_ << "inline size_t snapshot_root(const uint8_t* data, size_t size, uint64_t layout_hash, size_t root_size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (size < SNAPSHOT_HEADER_SIZE || std::memcmp(data, \"DSSNAP01\", 8) != 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"not a snapshot\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (snapshot_load<uint32_t>(data + 8) != SNAPSHOT_BYTE_ORDER) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"written on a host with a different byte order\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (snapshot_load<uint32_t>(data + 12) != SNAPSHOT_VERSION) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"unsupported snapshot version\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (snapshot_load<uint64_t>(data + 16) != layout_hash) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"snapshot was written for a different schema\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (snapshot_load<uint64_t>(data + 32) != size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"snapshot is truncated\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "uint64_t root = snapshot_load<uint64_t>(data + 24);" << endl;
+    ctx_ << "if (root > size || size - root < root_size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"root record out of bounds\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return static_cast<size_t>(root);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Resolve the (offset, count) reference stored at `at`; returns the offset" << endl;
+    ctx_ << "inline size_t snapshot_deref(const uint8_t* base, size_t size, size_t at, size_t element_size, size_t& count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t offset = snapshot_load<uint64_t>(base + at);" << endl;
+    ctx_ << "uint64_t n = snapshot_load<uint64_t>(base + at + 8);" << endl;
+    ctx_ << "if (offset > size || (element_size != 0 && n > (size - offset) / element_size)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw SnapshotError(\"reference out of bounds\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "count = static_cast<size_t>(n);" << endl;
+    ctx_ << "return static_cast<size_t>(offset);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline std::string_view snapshot_string(const uint8_t* base, size_t size, size_t at) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t count = 0;" << endl;
+    ctx_ << "size_t offset = snapshot_deref(base, size, at, 1, count);" << endl;
+    ctx_ << "return std::string_view(reinterpret_cast<const char*>(base + offset), count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Read-only view of an array of scalars inside a snapshot." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "class SnapshotArray {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "SnapshotArray() = default;" << endl;
+    ctx_ << "SnapshotArray(const uint8_t* data, size_t count) : data_(data), count_(count) {}" << endl;
+    ctx_ << blank;
+    ctx_ << "size_t size() const { return count_; }" << endl;
+    ctx_ << "bool empty() const { return count_ == 0; }" << endl;
+    ctx_ << "T operator[](size_t i) const { return snapshot_load<T>(data_ + i * sizeof(T)); }" << endl;
+    ctx_ << "std::vector<T> to_vector() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<T> out(count_);" << endl;
+    ctx_ << "if (count_ != 0) std::memcpy(out.data(), data_, count_ * sizeof(T));" << endl;
+    ctx_ << "return out;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const uint8_t* data_ = nullptr;" << endl;
+    ctx_ << "size_t count_ = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline SnapshotArray<T> snapshot_array(const uint8_t* base, size_t size, size_t at) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t count = 0;" << endl;
+    ctx_ << "size_t offset = snapshot_deref(base, size, at, sizeof(T), count);" << endl;
+    ctx_ << "return SnapshotArray<T>(base + offset, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Read-only view of an array of records (struct elements) inside a snapshot." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "class SnapshotRecords {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "SnapshotRecords() = default;" << endl;
+    ctx_ << "SnapshotRecords(const uint8_t* base, size_t size, size_t at, size_t count)" << endl;
+    ctx_.writer().indent();
+    ctx_ << ": base_(base), size_(size), at_(at), count_(count) {}" << endl;
+    ctx_ << blank;
+    ctx_.writer().unindent();
+    ctx_ << "size_t size() const { return count_; }" << endl;
+    ctx_ << "bool empty() const { return count_ == 0; }" << endl;
+    ctx_ << "typename T::SnapshotView operator[](size_t i) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return typename T::SnapshotView(base_, size_, at_ + i * T::snapshot_record_size);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const uint8_t* base_ = nullptr;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_ << "size_t at_ = 0;" << endl;
+    ctx_ << "size_t count_ = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline SnapshotRecords<T> snapshot_records(const uint8_t* base, size_t size, size_t at) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t count = 0;" << endl;
+    ctx_ << "size_t offset = snapshot_deref(base, size, at, T::snapshot_record_size, count);" << endl;
+    ctx_ << "return SnapshotRecords<T>(base, size, offset, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Read-only view of an array of strings inside a snapshot." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class SnapshotStrings {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "SnapshotStrings() = default;" << endl;
+    ctx_ << "SnapshotStrings(const uint8_t* base, size_t size, size_t at, size_t count)" << endl;
+    ctx_.writer().indent();
+    ctx_ << ": base_(base), size_(size), at_(at), count_(count) {}" << endl;
+    ctx_ << blank;
+    ctx_.writer().unindent();
+    ctx_ << "size_t size() const { return count_; }" << endl;
+    ctx_ << "bool empty() const { return count_ == 0; }" << endl;
+    ctx_ << "std::string_view operator[](size_t i) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return snapshot_string(base_, size_, at_ + i * SNAPSHOT_REF_SIZE);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const uint8_t* base_ = nullptr;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_ << "size_t at_ = 0;" << endl;
+    ctx_ << "size_t count_ = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "inline SnapshotStrings snapshot_strings(const uint8_t* base, size_t size, size_t at) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t count = 0;" << endl;
+    ctx_ << "size_t offset = snapshot_deref(base, size, at, SNAPSHOT_REF_SIZE, count);" << endl;
+    ctx_ << "return SnapshotStrings(base, size, offset, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Read-only snapshot file. Memory-mapped where available (shared between" << endl;
+    ctx_ << " * processes through the page cache), otherwise read into memory." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class SnapshotFile {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit SnapshotFile(const std::string& path) {" << endl;
+    ctx_ << "#if defined(__unix__) || defined(__APPLE__)" << endl;
+    ctx_.writer().indent();
+    ctx_ << "int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);" << endl;
+    ctx_ << "if (fd < 0) throw SnapshotError(\"cannot open \" + path);" << endl;
+    ctx_ << "struct stat st{};" << endl;
+    ctx_ << "if (::fstat(fd, &st) == 0 && st.st_size > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);" << endl;
+    ctx_ << "if (p != MAP_FAILED) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "data_ = static_cast<const uint8_t*>(p);" << endl;
+    ctx_ << "size_ = static_cast<size_t>(st.st_size);" << endl;
+    ctx_ << "mapped_ = true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "::close(fd);" << endl;
+    ctx_ << "if (mapped_) return;" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "std::ifstream file(path, std::ios::binary);" << endl;
+    ctx_ << "if (!file) throw SnapshotError(\"cannot open \" + path);" << endl;
+    ctx_ << "copy_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());" << endl;
+    ctx_ << "data_ = copy_.data();" << endl;
+    ctx_ << "size_ = copy_.size();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "SnapshotFile(const SnapshotFile&) = delete;" << endl;
+    ctx_ << "SnapshotFile& operator=(const SnapshotFile&) = delete;" << endl;
+    ctx_ << blank;
+    ctx_ << "~SnapshotFile() {" << endl;
+    ctx_ << "#if defined(__unix__) || defined(__APPLE__)" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (mapped_) ::munmap(const_cast<uint8_t*>(data_), size_);" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "const uint8_t* data() const { return data_; }" << endl;
+    ctx_ << "size_t size() const { return size_; }" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const uint8_t* data_ = nullptr;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_ << "bool mapped_ = false;" << endl;
+    ctx_ << "std::vector<uint8_t> copy_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Write a snapshot image to disk" << endl;
+    ctx_ << "inline void save_snapshot(const std::string& path, const std::vector<uint8_t>& image) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::ofstream file(path, std::ios::binary | std::ios::trunc);" << endl;
+    ctx_ << "if (!file) throw SnapshotError(\"cannot create \" + path);" << endl;
+    ctx_ << "file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));" << endl;
+    ctx_ << "if (!file) throw SnapshotError(\"cannot write \" + path);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+
+void CppHelperGenerator::generate_incremental_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <functional>" << endl;
+    ctx_ << "#include <memory>" << endl;
+    ctx_ << "#include <unordered_map>" << endl;
+}
+
+void CppHelperGenerator::generate_incremental() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Incremental re-decoding" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Counters for the last IncrementalDecoder::decode() / update() call." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "struct IncrementalStats {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t nodes_decoded = 0;    // Struct nodes decoded from bytes" << endl;
+    ctx_ << "size_t nodes_reused = 0;     // Struct nodes taken from the previous tree (their subtrees not counted)" << endl;
+    ctx_ << "size_t bytes_reused = 0;     // Input bytes covered by reused nodes" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Node table shared by all struct readers while an IncrementalDecoder runs." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * Every struct read() records a node: its type, input offset, the end of" << endl;
+    ctx_ << " * its input window, the bytes it consumed and its extent (the furthest" << endl;
+    ctx_ << " * byte it examined, including backtracking and label seeks). Nodes are" << endl;
+    ctx_ << " * stored in pre-order, so each node's descendants follow it contiguously." << endl;
+    ctx_ << " * During an update a node is reused when its [offset, extent) range misses" << endl;
+    ctx_ << " * every dirty byte; its recorded subtree is carried over unchanged." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * A node keeps a copy of its value only when its own fields make up at" << endl;
+    ctx_ << " * least half of its input. A parent made up mostly of child structs is" << endl;
+    ctx_ << " * decoded again from its reused children instead, so the stored copies" << endl;
+    ctx_ << " * cover each input byte at most twice rather than once per nesting level." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class IncrementalSession {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "struct Node {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const void* type = nullptr;          // Per-type tag; nullptr for failed reads" << endl;
+    ctx_ << "size_t offset = 0;" << endl;
+    ctx_ << "size_t window_end = 0;" << endl;
+    ctx_ << "size_t consumed = 0;" << endl;
+    ctx_ << "size_t extent = 0;" << endl;
+    ctx_ << "size_t subtree_end = 0;              // One past the last descendant" << endl;
+    ctx_ << "size_t children_consumed = 0;        // Bytes consumed by direct children" << endl;
+    ctx_ << "std::shared_ptr<const void> value;   // Decoded object, if kept (never for the root)" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Type tag: the address of a per-type variable" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "static const void* type_tag() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static const char tag = 0;" << endl;
+    ctx_ << "return &tag;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Session driving the struct readers on this thread (nullptr if none)" << endl;
+    ctx_ << "static IncrementalSession*& current() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "thread_local IncrementalSession* session = nullptr;" << endl;
+    ctx_ << "return session;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void begin(const uint8_t* base, size_t dirty_begin, size_t dirty_end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "base_ = base;" << endl;
+    ctx_ << "dirty_begin_ = dirty_begin;" << endl;
+    ctx_ << "dirty_end_ = dirty_end;" << endl;
+    ctx_ << "next_.clear();" << endl;
+    ctx_ << "frames_.clear();" << endl;
+    ctx_ << "stats_ = IncrementalStats{};" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Adopt the node table of a successful run" << endl;
+    ctx_ << "void commit() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "nodes_.swap(next_);" << endl;
+    ctx_ << "next_.clear();" << endl;
+    ctx_ << "index_.clear();" << endl;
+    ctx_ << "index_.reserve(nodes_.size());" << endl;
+    ctx_ << "for (size_t i = 0; i < nodes_.size(); ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (nodes_[i].type && nodes_[i].value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "index_[Key{nodes_[i].type, nodes_[i].offset, nodes_[i].window_end}] = i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void clear() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "nodes_.clear();" << endl;
+    ctx_ << "next_.clear();" << endl;
+    ctx_ << "index_.clear();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "const IncrementalStats& stats() const { return stats_; }" << endl;
+    ctx_ << "size_t node_count() const { return nodes_.size(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "// Reuse a clean node of type T at `start`; returns nullptr on a miss" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "const T* reuse(const uint8_t* start, const uint8_t* end, size_t& consumed) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const Key key{type_tag<T>(), offset_of(start), offset_of(end)};" << endl;
+    ctx_ << "auto it = index_.find(key);" << endl;
+    ctx_ << "if (it == index_.end()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return nullptr;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const Node& node = nodes_[it->second];" << endl;
+    ctx_ << "if (node.offset < dirty_end_ && dirty_begin_ < node.extent) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return nullptr;  // Depends on an edited byte" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Carry the node and its recorded subtree over to the new table" << endl;
+    ctx_ << "const size_t shift = next_.size() - it->second;" << endl;
+    ctx_ << "for (size_t i = it->second; i < node.subtree_end; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "next_.push_back(nodes_[i]);" << endl;
+    ctx_ << "next_.back().subtree_end += shift;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "touch(base_ + node.extent);" << endl;
+    ctx_ << "if (!frames_.empty()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "next_[frames_.back()].children_consumed += node.consumed;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "stats_.nodes_reused++;" << endl;
+    ctx_ << "stats_.bytes_reused += node.consumed;" << endl;
+    ctx_ << "consumed = node.consumed;" << endl;
+    ctx_ << "return static_cast<const T*>(node.value.get());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Open a node for a struct about to be decoded; returns its index" << endl;
+    ctx_ << "size_t enter(const uint8_t* start, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Node node;" << endl;
+    ctx_ << "node.offset = offset_of(start);" << endl;
+    ctx_ << "node.window_end = offset_of(end);" << endl;
+    ctx_ << "node.extent = node.offset;" << endl;
+    ctx_ << "next_.push_back(std::move(node));" << endl;
+    ctx_ << "frames_.push_back(next_.size() - 1);" << endl;
+    ctx_ << "return next_.size() - 1;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Close a successfully decoded node" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "void leave(size_t index, const T& value, const uint8_t* data) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Node& node = next_[index];" << endl;
+    ctx_ << "node.type = type_tag<T>();" << endl;
+    ctx_ << "node.consumed = offset_of(data) - node.offset;" << endl;
+    ctx_ << "node.extent = std::max(node.extent, offset_of(data));" << endl;
+    ctx_ << "node.subtree_end = next_.size();" << endl;
+    ctx_ << "// The root is always re-decoded; a node mostly made of children is rebuilt from them" << endl;
+    ctx_ << "if (frames_.size() > 1 && 2 * node.children_consumed <= node.consumed) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "node.value = std::make_shared<const T>(value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "stats_.nodes_decoded++;" << endl;
+    ctx_ << "pop(index);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Close a node whose read threw (e.g. a failed union branch)" << endl;
+    ctx_ << "void abandon(size_t index) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "next_[index].subtree_end = next_.size();" << endl;
+    ctx_ << "pop(index);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Record that the reader examined input up to `p` (before seeking back)" << endl;
+    ctx_ << "void touch(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!frames_.empty()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Node& node = next_[frames_.back()];" << endl;
+    ctx_ << "node.extent = std::max(node.extent, offset_of(p));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "struct Key {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const void* type;" << endl;
+    ctx_ << "size_t offset;" << endl;
+    ctx_ << "size_t window_end;" << endl;
+    ctx_ << "bool operator==(const Key& other) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return type == other.type && offset == other.offset && window_end == other.window_end;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "struct KeyHash {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t operator()(const Key& key) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t h = std::hash<const void*>()(key.type);" << endl;
+    ctx_ << "h ^= key.offset + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);" << endl;
+    ctx_ << "h ^= key.window_end + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);" << endl;
+    ctx_ << "return h;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "size_t offset_of(const uint8_t* p) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return static_cast<size_t>(p - base_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Pop a frame and extend the parent by the child's extent and input" << endl;
+    ctx_ << "void pop(size_t index) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "frames_.pop_back();" << endl;
+    ctx_ << "if (!frames_.empty()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Node& parent = next_[frames_.back()];" << endl;
+    ctx_ << "parent.extent = std::max(parent.extent, next_[index].extent);" << endl;
+    ctx_ << "parent.children_consumed += next_[index].consumed;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "const uint8_t* base_ = nullptr;" << endl;
+    ctx_ << "size_t dirty_begin_ = 0;" << endl;
+    ctx_ << "size_t dirty_end_ = 0;" << endl;
+    ctx_ << "std::vector<Node> nodes_;       // Table of the last successful run" << endl;
+    ctx_ << "std::vector<Node> next_;        // Table being built" << endl;
+    ctx_ << "std::vector<size_t> frames_;    // Open nodes (indices into next_)" << endl;
+    ctx_ << "std::unordered_map<Key, size_t, KeyHash> index_;" << endl;
+    ctx_ << "IncrementalStats stats_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Record input examined before a backward seek (no-op outside an incremental run)" << endl;
+    ctx_ << "inline void incremental_touch(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (IncrementalSession* session = IncrementalSession::current()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "session->touch(p);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Per-call bookkeeping used by generated struct readers." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class IncrementalFrame {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "IncrementalFrame() : session_(IncrementalSession::current()) {}" << endl;
+    ctx_ << blank;
+    ctx_ << "IncrementalFrame(const IncrementalFrame&) = delete;" << endl;
+    ctx_ << "IncrementalFrame& operator=(const IncrementalFrame&) = delete;" << endl;
+    ctx_ << blank;
+    ctx_ << "~IncrementalFrame() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (open_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "session_->abandon(index_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Return a reusable previous T at `data` (advancing data), or open a new node" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "const T* reuse(const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!session_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return nullptr;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "size_t consumed = 0;" << endl;
+    ctx_ << "if (const T* previous = session_->reuse<T>(data, end, consumed)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "data += consumed;" << endl;
+    ctx_ << "return previous;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "index_ = session_->enter(data, end);" << endl;
+    ctx_ << "open_ = true;" << endl;
+    ctx_ << "return nullptr;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "void record(const T& value, const uint8_t* data) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (open_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "open_ = false;" << endl;
+    ctx_ << "session_->leave(index_, value, data);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "IncrementalSession* session_;" << endl;
+    ctx_ << "size_t index_ = 0;" << endl;
+    ctx_ << "bool open_ = false;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Keeps a decoded T together with the input ranges of all its struct" << endl;
+    ctx_ << " * nodes, so that after an in-place edit only the nodes whose input" << endl;
+    ctx_ << " * overlaps the edited bytes (and their ancestors) are decoded again." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * The buffer must keep its size between calls; a different size (an" << endl;
+    ctx_ << " * insertion or deletion) triggers a full decode." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "class IncrementalDecoder {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Decode the whole buffer" << endl;
+    ctx_ << "const T& decode(const uint8_t* data, size_t size) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "session_.clear();" << endl;
+    ctx_ << "pending_ = false;" << endl;
+    ctx_ << "return run(data, size, 0, 0);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Re-decode after bytes [dirty_begin, dirty_end) were changed in place" << endl;
+    ctx_ << "const T& update(const uint8_t* data, size_t size, size_t dirty_begin, size_t dirty_end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!value_ || size != size_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return decode(data, size);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (pending_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Include edits of earlier updates that failed to decode" << endl;
+    ctx_ << "dirty_begin = std::min(dirty_begin, pending_begin_);" << endl;
+    ctx_ << "dirty_end = std::max(dirty_end, pending_end_);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return run(data, size, dirty_begin, dirty_end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "const T& value() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!value_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::logic_error(\"IncrementalDecoder: nothing decoded yet\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return *value_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "const IncrementalStats& stats() const { return session_.stats(); }" << endl;
+    ctx_ << "size_t node_count() const { return session_.node_count(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const T& run(const uint8_t* data, size_t size, size_t dirty_begin, size_t dirty_end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "struct Activate {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit Activate(IncrementalSession* s) { IncrementalSession::current() = s; }" << endl;
+    ctx_ << "~Activate() { IncrementalSession::current() = nullptr; }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "session_.begin(data, dirty_begin, dirty_end);" << endl;
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Activate active(&session_);" << endl;
+    ctx_ << "const uint8_t* p = data;" << endl;
+    ctx_ << "T decoded = T::read(p, data + size);" << endl;
+    ctx_ << "value_ = std::make_unique<T>(std::move(decoded));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (...) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Keep the previous tree; remember the edit for the next update" << endl;
+    ctx_ << "pending_begin_ = pending_ ? std::min(pending_begin_, dirty_begin) : dirty_begin;" << endl;
+    ctx_ << "pending_end_ = pending_ ? std::max(pending_end_, dirty_end) : dirty_end;" << endl;
+    ctx_ << "pending_ = value_ != nullptr;" << endl;
+    ctx_ << "throw;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "session_.commit();" << endl;
+    ctx_ << "size_ = size;" << endl;
+    ctx_ << "pending_ = false;" << endl;
+    ctx_ << "return *value_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "IncrementalSession session_;" << endl;
+    ctx_ << "std::unique_ptr<T> value_;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_ << "bool pending_ = false;" << endl;
+    ctx_ << "size_t pending_begin_ = 0;" << endl;
+    ctx_ << "size_t pending_end_ = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+}
+
+
+void CppHelperGenerator::generate_utf8_strings_includes() {
+    ctx_ << "#include <cstring>" << endl;
+    ctx_ << "#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)" << endl;
+    ctx_ << "#include <emmintrin.h>" << endl;
+    ctx_ << "#define DATASCRIPT_UTF8_SSE2 1" << endl;
+    ctx_ << "#elif defined(__aarch64__) && defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__" << endl;
+    ctx_ << "#include <arm_neon.h>" << endl;
+    ctx_ << "#define DATASCRIPT_UTF8_NEON 1" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_utf8_strings() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// UTF-16 / UTF-32 to UTF-8 Transcoding" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Append one code point (already validated) as UTF-8" << endl;
+    ctx_ << "inline char* utf8_put(char* out, uint32_t cp) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (cp < 0x80) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << " *out++ = static_cast<char>(cp);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else if (cp < 0x800) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << " *out++ = static_cast<char>(0xC0 | (cp >> 6));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | (cp & 0x3F));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else if (cp < 0x10000) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << " *out++ = static_cast<char>(0xE0 | (cp >> 12));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | (cp & 0x3F));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << " *out++ = static_cast<char>(0xF0 | (cp >> 18));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));" << endl;
+    ctx_ << " *out++ = static_cast<char>(0x80 | (cp & 0x3F));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return out;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<bool BigEndian>" << endl;
+    ctx_ << "inline uint32_t utf16_unit(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return BigEndian ? (static_cast<uint32_t>(p[0]) << 8) | p[1]" << endl;
+    ctx_ << "                 : static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<bool BigEndian>" << endl;
+    ctx_ << "inline uint32_t utf32_unit(const uint8_t* p) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return BigEndian ? (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |" << endl;
+    ctx_ << "                   (static_cast<uint32_t>(p[2]) << 8) | p[3]" << endl;
+    ctx_ << "                 : static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |" << endl;
+    ctx_ << "                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Find the null code unit of a UTF-16 / UTF-32 string (Width = 2 or 4 bytes)" << endl;
+    ctx_ << "template<size_t Width>" << endl;
+    ctx_ << "inline const uint8_t* find_wide_terminator(const uint8_t* data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* p = data;" << endl;
+    if (cpu_dispatch_) {
+        ctx_ << "#if defined(DATASCRIPT_CPU_X86)" << endl;
+        ctx_ << "const uint8_t* found = Width == 2 ? cpu::kernels().find_zero16(p, end) : cpu::kernels().find_zero32(p, end);" << endl;
+        ctx_ << "if (found != nullptr) return found;" << endl;
+        ctx_ << "p = end;" << endl;
+    }
+    ctx_ << (cpu_dispatch_ ? "#elif" : "#if") << " defined(DATASCRIPT_UTF8_SSE2)" << endl;
+    ctx_ << "const __m128i zero = _mm_setzero_si128();" << endl;
+    ctx_ << "while (end - p >= 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));" << endl;
+    ctx_ << "__m128i eq = Width == 2 ? _mm_cmpeq_epi16(v, zero) : _mm_cmpeq_epi32(v, zero);" << endl;
+    ctx_ << "if (_mm_movemask_epi8(eq) != 0) break;  // Terminator in this block" << endl;
+    ctx_ << "p += 16;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#elif defined(DATASCRIPT_UTF8_NEON)" << endl;
+    ctx_ << "while (end - p >= 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint8x16_t v = vld1q_u8(p);" << endl;
+    ctx_ << "bool has_zero = Width == 2 ? vminvq_u16(vreinterpretq_u16_u8(v)) == 0" << endl;
+    ctx_ << "                               : vminvq_u32(vreinterpretq_u32_u8(v)) == 0;" << endl;
+    ctx_ << "if (has_zero) break;  // Terminator in this block" << endl;
+    ctx_ << "p += 16;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "for (; end - p >= static_cast<ptrdiff_t>(Width); p += Width) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "bool zero_unit = Width == 2 ? (p[0] | p[1]) == 0 : (p[0] | p[1] | p[2] | p[3]) == 0;" << endl;
+    ctx_ << "if (zero_unit) return p;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "throw std::runtime_error(Width == 2 ? \"UTF-16 string not null-terminated before end of buffer\"" << endl;
+    ctx_ << "                                    : \"UTF-32 string not null-terminated before end of buffer\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Transcode `units` UTF-16 code units to UTF-8, validating surrogate pairs" << endl;
+    ctx_ << "template<bool BigEndian>" << endl;
+    ctx_ << "inline std::string utf16_to_utf8(const uint8_t* src, size_t units) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::string result(units * 3, '\\0');  // Worst case: 3 bytes per unit" << endl;
+    ctx_ << "char* out = &result[0];" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "while (i < units) {" << endl;
+    ctx_.writer().indent();
+    if (cpu_dispatch_) {
+        ctx_ << "// ASCII fast path: the dispatched kernel on x86, 8 units per step elsewhere" << endl;
+        ctx_ << "#if defined(DATASCRIPT_CPU_X86)" << endl;
+        ctx_ << "const size_t ascii = cpu::kernels().ascii16(src + 2 * i, units - i, out, BigEndian);" << endl;
+        ctx_ << "out += ascii;" << endl;
+        ctx_ << "i += ascii;" << endl;
+    } else {
+        ctx_ << "// ASCII fast path: 8 units per step" << endl;
+    }
+    ctx_ << (cpu_dispatch_ ? "#elif" : "#if") << " defined(DATASCRIPT_UTF8_SSE2)" << endl;
+    ctx_ << "while (units - i >= 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));" << endl;
+    ctx_ << "if constexpr (BigEndian) v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));" << endl;
+    ctx_ << "__m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));" << endl;
+    ctx_ << "if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) break;" << endl;
+    ctx_ << "_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(v, v));" << endl;
+    ctx_ << "out += 8;" << endl;
+    ctx_ << "i += 8;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#elif defined(DATASCRIPT_UTF8_NEON)" << endl;
+    ctx_ << "while (units - i >= 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint8x16_t bytes = vld1q_u8(src + 2 * i);" << endl;
+    ctx_ << "if constexpr (BigEndian) bytes = vrev16q_u8(bytes);" << endl;
+    ctx_ << "uint16x8_t v = vreinterpretq_u16_u8(bytes);" << endl;
+    ctx_ << "if (vmaxvq_u16(v) >= 0x80) break;" << endl;
+    ctx_ << "vst1_u8(reinterpret_cast<uint8_t*>(out), vmovn_u16(v));" << endl;
+    ctx_ << "out += 8;" << endl;
+    ctx_ << "i += 8;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "// Scalar path for the next block (non-ASCII text and the tail)" << endl;
+    ctx_ << "const size_t stop = i + 8 < units ? i + 8 : units;" << endl;
+    ctx_ << "while (i < stop) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t cp = utf16_unit<BigEndian>(src + 2 * i);" << endl;
+    ctx_ << "if (cp >= 0xD800 && cp <= 0xDBFF) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t low = i + 1 < units ? utf16_unit<BigEndian>(src + 2 * (i + 1)) : 0;" << endl;
+    ctx_ << "if (low < 0xDC00 || low > 0xDFFF) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Invalid UTF-16: unpaired high surrogate\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);" << endl;
+    ctx_ << "i += 2;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else if (cp >= 0xDC00 && cp <= 0xDFFF) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Invalid UTF-16: unpaired low surrogate\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "i += 1;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out = utf8_put(out, cp);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "result.resize(static_cast<size_t>(out - result.data()));" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Transcode `units` UTF-32 code units to UTF-8, rejecting surrogates and values above U+10FFFF" << endl;
+    ctx_ << "template<bool BigEndian>" << endl;
+    ctx_ << "inline std::string utf32_to_utf8(const uint8_t* src, size_t units) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::string result(units * 4, '\\0');  // Worst case: 4 bytes per unit" << endl;
+    ctx_ << "char* out = &result[0];" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "while (i < units) {" << endl;
+    ctx_.writer().indent();
+    if (cpu_dispatch_) {
+        ctx_ << "// ASCII fast path: the dispatched kernel on x86, 4 units per step elsewhere" << endl;
+        ctx_ << "#if defined(DATASCRIPT_CPU_X86)" << endl;
+        ctx_ << "const size_t ascii = cpu::kernels().ascii32(src + 4 * i, units - i, out, BigEndian);" << endl;
+        ctx_ << "out += ascii;" << endl;
+        ctx_ << "i += ascii;" << endl;
+    } else {
+        ctx_ << "// ASCII fast path: 4 units per step" << endl;
+    }
+    ctx_ << (cpu_dispatch_ ? "#elif" : "#if") << " defined(DATASCRIPT_UTF8_SSE2)" << endl;
+    ctx_ << "while (units - i >= 4) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));" << endl;
+    ctx_ << "if constexpr (BigEndian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Only the low byte of each unit survives the ASCII check" << endl;
+    ctx_ << "v = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(v, 24), _mm_slli_epi32(v, 24))," << endl;
+    ctx_ << "                 _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xFF00))," << endl;
+    ctx_ << "                              _mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0xFF0000))));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "__m128i high = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFF80u)));" << endl;
+    ctx_ << "if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF) break;" << endl;
+    ctx_ << "__m128i packed = _mm_packus_epi16(_mm_packs_epi32(v, v), _mm_setzero_si128());" << endl;
+    ctx_ << "int32_t four = _mm_cvtsi128_si32(packed);" << endl;
+    ctx_ << "std::memcpy(out, &four, 4);" << endl;
+    ctx_ << "out += 4;" << endl;
+    ctx_ << "i += 4;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#elif defined(DATASCRIPT_UTF8_NEON)" << endl;
+    ctx_ << "while (units - i >= 4) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint8x16_t bytes = vld1q_u8(src + 4 * i);" << endl;
+    ctx_ << "if constexpr (BigEndian) bytes = vrev32q_u8(bytes);" << endl;
+    ctx_ << "uint32x4_t v = vreinterpretq_u32_u8(bytes);" << endl;
+    ctx_ << "if (vmaxvq_u32(v) >= 0x80) break;" << endl;
+    ctx_ << "uint8x8_t narrow = vmovn_u16(vcombine_u16(vmovn_u32(v), vdup_n_u16(0)));" << endl;
+    ctx_ << "vst1_lane_u32(reinterpret_cast<uint32_t*>(out), vreinterpret_u32_u8(narrow), 0);" << endl;
+    ctx_ << "out += 4;" << endl;
+    ctx_ << "i += 4;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "// Scalar path for the next block (non-ASCII text and the tail)" << endl;
+    ctx_ << "const size_t stop = i + 4 < units ? i + 4 : units;" << endl;
+    ctx_ << "for (; i < stop; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t cp = utf32_unit<BigEndian>(src + 4 * i);" << endl;
+    ctx_ << "if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Invalid UTF-32 code point\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out = utf8_put(out, cp);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "result.resize(static_cast<size_t>(out - result.data()));" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline std::string read_u16string_le_utf8(const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* terminator = find_wide_terminator<2>(data, end);" << endl;
+    ctx_ << "std::string result = utf16_to_utf8<false>(data, static_cast<size_t>(terminator - data) / 2);" << endl;
+    ctx_ << "data = terminator + 2;  // Skip null terminator" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline std::string read_u16string_be_utf8(const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* terminator = find_wide_terminator<2>(data, end);" << endl;
+    ctx_ << "std::string result = utf16_to_utf8<true>(data, static_cast<size_t>(terminator - data) / 2);" << endl;
+    ctx_ << "data = terminator + 2;  // Skip null terminator" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline std::string read_u32string_le_utf8(const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* terminator = find_wide_terminator<4>(data, end);" << endl;
+    ctx_ << "std::string result = utf32_to_utf8<false>(data, static_cast<size_t>(terminator - data) / 4);" << endl;
+    ctx_ << "data = terminator + 4;  // Skip null terminator" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline std::string read_u32string_be_utf8(const uint8_t*& data, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* terminator = find_wide_terminator<4>(data, end);" << endl;
+    ctx_ << "std::string result = utf32_to_utf8<true>(data, static_cast<size_t>(terminator - data) / 4);" << endl;
+    ctx_ << "data = terminator + 4;  // Skip null terminator" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+
+void CppHelperGenerator::generate_array_transforms_includes() {
+    ctx_ << "#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)" << endl;
+    ctx_ << "#include <emmintrin.h>" << endl;
+    ctx_ << "#define DATASCRIPT_TRANSFORM_SSE2 1" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_array_transforms_sse2() {
+    ctx_ << "#if defined(DATASCRIPT_TRANSFORM_SSE2)" << endl;
+    ctx_ << "// SSE2 lane operations for the in-register prefix sum, per element width" << endl;
+    ctx_ << "template<size_t N> struct TransformLanes;" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct TransformLanes<4> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static __m128i splat(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }" << endl;
+    ctx_ << "static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }" << endl;
+    ctx_ << "static __m128i zigzag(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi32(1)));" << endl;
+    ctx_ << "return _mm_xor_si128(_mm_srli_epi32(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "static __m128i bswap(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));" << endl;
+    ctx_ << "return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the four lanes" << endl;
+    ctx_ << "static __m128i scan(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm_add_epi32(x, _mm_slli_si128(x, 4));" << endl;
+    ctx_ << "return _mm_add_epi32(x, _mm_slli_si128(x, 8));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "static __m128i broadcast_last(__m128i x) { return _mm_shuffle_epi32(x, 0xFF); }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct TransformLanes<8> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static __m128i splat(uint64_t v) { return _mm_set1_epi64x(static_cast<long long>(v)); }" << endl;
+    ctx_ << "static __m128i add(__m128i a, __m128i b) { return _mm_add_epi64(a, b); }" << endl;
+    ctx_ << "static __m128i zigzag(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi64x(1)));" << endl;
+    ctx_ << "return _mm_xor_si128(_mm_srli_epi64(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "static __m128i bswap(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));" << endl;
+    ctx_ << "return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1B), 0x1B);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the two lanes" << endl;
+    ctx_ << "static __m128i scan(__m128i x) { return _mm_add_epi64(x, _mm_slli_si128(x, 8)); }" << endl;
+    ctx_ << "static __m128i broadcast_last(__m128i x) { return _mm_shuffle_epi32(x, 0xEE); }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Vector body: decodes whole 16-byte blocks, carrying the running sums in" << endl;
+    ctx_ << "// registers; returns the number of elements written" << endl;
+    ctx_ << "template<typename W, bool Swap, ArrayTransform X>" << endl;
+    ctx_ << "inline size_t transform_array_sse2(const uint8_t* src, uint8_t* dst, size_t count, W& value, W& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using L = TransformLanes<sizeof(W)>;" << endl;
+    ctx_ << "constexpr size_t lanes = 16 / sizeof(W);" << endl;
+    ctx_ << "__m128i acc = L::splat(value);" << endl;
+    ctx_ << "__m128i acc_delta = L::splat(delta);" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + lanes <= count; i += lanes) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(W)));" << endl;
+    ctx_ << "if constexpr (Swap) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::bswap(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::ZigzagDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::zigzag(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::DeltaOfDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::add(L::scan(x), acc_delta);" << endl;
+    ctx_ << "acc_delta = L::broadcast_last(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "x = L::add(L::scan(x), acc);" << endl;
+    ctx_ << "acc = L::broadcast_last(x);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * sizeof(W)), x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "W carry[lanes];" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(carry), acc);" << endl;
+    ctx_ << "value = carry[0];" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(carry), acc_delta);" << endl;
+    ctx_ << "delta = carry[0];" << endl;
+    ctx_ << "return i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << blank;
+}
+
+void CppHelperGenerator::generate_array_transforms() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Delta-Encoded Array Reconstruction" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Reconstruction applied while reading @delta / @delta_of_delta / @zigzag_delta arrays" << endl;
+    ctx_ << "enum class ArrayTransform { Delta, DeltaOfDelta, ZigzagDelta };" << endl;
+    ctx_ << blank;
+    if (!cpu_dispatch_) {
+        generate_array_transforms_sse2();
+    }
+    ctx_ << "// Read count elements and rebuild the values from their deltas in the same" << endl;
+    ctx_ << "// pass over memory; one bounds check covers the whole array" << endl;
+    ctx_ << "template<ArrayTransform X, bool BigEndian, typename T>" << endl;
+    ctx_ << "inline void read_transformed_array(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using W = typename array_word<sizeof(T)>::type;" << endl;
+    ctx_ << "if (count > static_cast<size_t>(end - p) / sizeof(T)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Buffer underflow reading array\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__" << endl;
+    ctx_ << "constexpr bool swap = !BigEndian;" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "constexpr bool swap = BigEndian;" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "W value = 0;" << endl;
+    ctx_ << "W delta = 0;" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    if (cpu_dispatch_) {
+        ctx_ << "if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "constexpr unsigned mode = (swap ? cpu::delta_swap : 0u) |" << endl;
+        ctx_ << "                          (X == ArrayTransform::ZigzagDelta ? cpu::delta_zigzag : 0u) |" << endl;
+        ctx_ << "                          (X == ArrayTransform::DeltaOfDelta ? cpu::delta_twice : 0u);" << endl;
+        ctx_ << "if constexpr (sizeof(T) == 4) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().delta32(p, reinterpret_cast<uint8_t*>(out), count, mode, value, delta);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().delta64(p, reinterpret_cast<uint8_t*>(out), count, mode, value, delta);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "i = count;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    } else {
+        ctx_ << "#if defined(DATASCRIPT_TRANSFORM_SSE2)" << endl;
+        ctx_ << "if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "i = transform_array_sse2<W, swap, X>(p, reinterpret_cast<uint8_t*>(out), count, value, delta);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "#endif" << endl;
+    }
+    ctx_ << "for (; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "W w;" << endl;
+    ctx_ << "std::memcpy(&w, p + i * sizeof(T), sizeof(W));" << endl;
+    ctx_ << "if constexpr (swap) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "w = byteswap_word(w);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::ZigzagDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "w = static_cast<W>((w >> 1) ^ (W(0) - (w & 1)));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (X == ArrayTransform::DeltaOfDelta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "delta = static_cast<W>(delta + w);" << endl;
+    ctx_ << "w = delta;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "value = static_cast<W>(value + w);" << endl;
+    ctx_ << "std::memcpy(&out[i], &value, sizeof(T));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "p += count * sizeof(T);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_delta_le(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::Delta, false>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_delta_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::Delta, true>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_delta_of_delta_le(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::DeltaOfDelta, false>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_delta_of_delta_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::DeltaOfDelta, true>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_zigzag_delta_le(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::ZigzagDelta, false>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_array_zigzag_delta_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "read_transformed_array<ArrayTransform::ZigzagDelta, true>(p, end, out, count);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+
+void CppHelperGenerator::generate_substreams_includes(bool zlib) {
+    ctx_ << "#include <optional>" << endl;
+    ctx_ << "#include <type_traits>" << endl;
+    if (zlib) {
+        ctx_ << "#include <zlib.h>  // link with -lz" << endl;
+    }
+    ctx_ << "#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)" << endl;
+    ctx_ << "#include <emmintrin.h>" << endl;
+    ctx_ << "#define DATASCRIPT_SUBSTREAM_SSE2 1" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_substreams(bool zlib) {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Byte-Transform Substreams" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Transform undone on a substream's bytes before they are parsed" << endl;
+    ctx_ << "enum class ByteTransform : uint8_t { Xor, RotateLeft, RotateRight, Zlib };" << endl;
+    ctx_ << blank;
+    if (cpu_dispatch_) {
+        ctx_ << "// Undo xor / rotate in place with the dispatched kernels" << endl;
+        ctx_ << "inline void undo_byte_transform(uint8_t* bytes, size_t size, ByteTransform transform, uint8_t param) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "if (transform == ByteTransform::Xor) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().xor_bytes(bytes, size, param);" << endl;
+        ctx_ << "return;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "// Rotating right by k is rotating left by 8 - k" << endl;
+        ctx_ << "const unsigned left = (transform == ByteTransform::RotateLeft ? param : 8u - (param & 7u)) & 7u;" << endl;
+        ctx_ << "if (left != 0) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "cpu::kernels().rotl_bytes(bytes, size, left);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    } else {
+        ctx_ << "// Undo xor / rotate in place: 16 bytes per step with SSE2, scalar for the tail" << endl;
+        ctx_ << "inline void undo_byte_transform(uint8_t* bytes, size_t size, ByteTransform transform, uint8_t param) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "size_t i = 0;" << endl;
+        ctx_ << "if (transform == ByteTransform::Xor) {" << endl;
+        ctx_ << "#if defined(DATASCRIPT_SUBSTREAM_SSE2)" << endl;
+        ctx_.writer().indent();
+        ctx_ << "const __m128i key = _mm_set1_epi8(static_cast<char>(param));" << endl;
+        ctx_ << "for (; i + 16 <= size; i += 16) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));" << endl;
+        ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), _mm_xor_si128(x, key));" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "#endif" << endl;
+        ctx_ << "for (; i < size; i++) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "bytes[i] = static_cast<uint8_t>(bytes[i] ^ param);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "return;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "// Rotating right by k is rotating left by 8 - k" << endl;
+        ctx_ << "const unsigned left = (transform == ByteTransform::RotateLeft ? param : 8u - (param & 7u)) & 7u;" << endl;
+        ctx_ << "if (left == 0) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "return;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "#if defined(DATASCRIPT_SUBSTREAM_SSE2)" << endl;
+        ctx_ << "// No 8-bit shifts in SSE2: shift 16-bit lanes, then mask off the bits that crossed into the neighbouring byte" << endl;
+        ctx_ << "const __m128i high_mask = _mm_set1_epi8(static_cast<char>((0xFFu << left) & 0xFFu));" << endl;
+        ctx_ << "const __m128i low_mask = _mm_set1_epi8(static_cast<char>(0xFFu >> (8u - left)));" << endl;
+        ctx_ << "const __m128i left_count = _mm_cvtsi32_si128(static_cast<int>(left));" << endl;
+        ctx_ << "const __m128i right_count = _mm_cvtsi32_si128(static_cast<int>(8u - left));" << endl;
+        ctx_ << "for (; i + 16 <= size; i += 16) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));" << endl;
+        ctx_ << "__m128i high = _mm_and_si128(_mm_sll_epi16(x, left_count), high_mask);" << endl;
+        ctx_ << "__m128i low = _mm_and_si128(_mm_srl_epi16(x, right_count), low_mask);" << endl;
+        ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), _mm_or_si128(high, low));" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "#endif" << endl;
+        ctx_ << "for (; i < size; i++) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "bytes[i] = static_cast<uint8_t>((bytes[i] << left) | (bytes[i] >> (8u - left)));" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+    ctx_ << blank;
+    if (zlib) {
+        ctx_ << "// Largest inflated size of a @zlib substream (--cpp-substream-max-inflate);" << endl;
+        ctx_ << "// a few hostile bytes could otherwise inflate until memory runs out" << endl;
+        ctx_ << "constexpr size_t substream_max_inflate = " << std::to_string(substream_max_inflate_) << ";" << endl;
+        ctx_ << blank;
+        ctx_ << "// Inflate a zlib (RFC 1950) stream, growing the output 16 KiB at a time" << endl;
+        ctx_ << "inline std::vector<uint8_t> inflate_substream(const uint8_t* data, size_t size) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "if (size > 0xFFFFFFFFu) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "throw std::runtime_error(\"zlib substream too large\");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "z_stream stream{};" << endl;
+        ctx_ << "if (inflateInit(&stream) != Z_OK) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "throw std::runtime_error(\"zlib substream: inflateInit failed\");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "struct InflateGuard {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "z_stream& stream;" << endl;
+        ctx_ << "~InflateGuard() { inflateEnd(&stream); }" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} guard{stream};" << endl;
+        ctx_ << "stream.next_in = const_cast<Bytef*>(data);" << endl;
+        ctx_ << "stream.avail_in = static_cast<uInt>(size);" << endl;
+        ctx_ << blank;
+        ctx_ << "constexpr size_t chunk = 16384;" << endl;
+        ctx_ << "std::vector<uint8_t> out;" << endl;
+        ctx_ << "int status = Z_OK;" << endl;
+        ctx_ << "while (status != Z_STREAM_END) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "const size_t used = out.size();" << endl;
+        ctx_ << "// One byte past the limit is enough to tell that the stream exceeds it" << endl;
+        ctx_ << "const size_t room = substream_max_inflate - used + 1;" << endl;
+        ctx_ << "const size_t step = room < chunk ? room : chunk;" << endl;
+        ctx_ << "out.resize(used + step);" << endl;
+        ctx_ << "stream.next_out = out.data() + used;" << endl;
+        ctx_ << "stream.avail_out = static_cast<uInt>(step);" << endl;
+        ctx_ << "status = inflate(&stream, Z_NO_FLUSH);" << endl;
+        ctx_ << "out.resize(used + (step - stream.avail_out));" << endl;
+        ctx_ << "if (out.size() > substream_max_inflate) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "throw std::runtime_error(\"zlib substream too large\");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "if (status != Z_OK && status != Z_STREAM_END) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "throw std::runtime_error(status == Z_BUF_ERROR ? \"zlib substream truncated\" : \"zlib substream corrupt\");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "if (status == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "throw std::runtime_error(\"zlib substream truncated\");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << "return out;" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << blank;
+    }
+    ctx_ << "// A length-delimited region stored under a byte transform. read() only" << endl;
+    ctx_ << "// copies the raw bytes; get() undoes the transform and parses T on first" << endl;
+    ctx_ << "// access, so regions that are never looked at are never decoded. The cache" << endl;
+    ctx_ << "// is not synchronized: call get() before sharing an object across threads." << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "class Substream {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Capture the region (called by the generated readers)" << endl;
+    ctx_ << "void assign(const uint8_t* data, size_t size, ByteTransform transform, uint8_t param) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "raw_.assign(data, data + size);" << endl;
+    ctx_ << "transform_ = transform;" << endl;
+    ctx_ << "param_ = param;" << endl;
+    ctx_ << "value_.reset();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "void clear() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "raw_.clear();" << endl;
+    ctx_ << "value_.reset();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Bytes as stored on the wire, transform not yet undone" << endl;
+    ctx_ << "const std::vector<uint8_t>& raw() const { return raw_; }" << endl;
+    ctx_ << "ByteTransform transform() const { return transform_; }" << endl;
+    ctx_ << blank;
+    ctx_ << "// True once get() has decoded the region" << endl;
+    ctx_ << "bool decoded() const { return value_.has_value(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "// Decode on first call; later calls return the cached value" << endl;
+    ctx_ << "const T& get() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (!value_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "value_.emplace(decode());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return *value_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const T& operator*() const { return get(); }" << endl;
+    ctx_ << "const T* operator->() const { return &get(); }" << endl;
+    ctx_ << blank;
+    ctx_.writer().unindent();
+    ctx_ << "private:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<uint8_t> raw_;" << endl;
+    ctx_ << "ByteTransform transform_ = ByteTransform::Xor;" << endl;
+    ctx_ << "uint8_t param_ = 0;" << endl;
+    ctx_ << "mutable std::optional<T> value_;" << endl;
+    ctx_ << blank;
+    ctx_ << "T decode() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<uint8_t> plain;" << endl;
+    if (zlib) {
+        ctx_ << "if (transform_ == ByteTransform::Zlib) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "plain = inflate_substream(raw_.data(), raw_.size());" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "plain = raw_;" << endl;
+        ctx_ << "undo_byte_transform(plain.data(), plain.size(), transform_, param_);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    } else {
+        ctx_ << "plain = raw_;" << endl;
+        ctx_ << "undo_byte_transform(plain.data(), plain.size(), transform_, param_);" << endl;
+    }
+    // Padded-input readers may load up to input_padding bytes past the end
+    const std::string size = padded_input_ ? "size" : "plain.size()";
+    if (padded_input_) {
+        ctx_ << "const size_t size = plain.size();" << endl;
+        ctx_ << "if constexpr (!std::is_same_v<T, std::vector<uint8_t>>) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "plain.resize(size + input_padding);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+    ctx_ << "const uint8_t* p = plain.data();" << endl;
+    ctx_ << "if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return plain;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else if constexpr (requires { T::read(p, p); }) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return T::read(p, p + " + size + ");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// Structs generated without exceptions only have read_safe()" << endl;
+    ctx_ << "auto result = T::read_safe(p, p + " + size + ");" << endl;
+    ctx_ << "if (!result) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(result.error_message);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return std::move(result.value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Capture size bytes for a substream field; decoding waits for get()" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_ << "inline void read_substream(Substream<T>& out, const uint8_t*& p, const uint8_t* end, size_t size, ByteTransform transform, uint8_t param) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (size > static_cast<size_t>(end - p)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Buffer underflow reading substream\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "out.assign(p, size, transform, param);" << endl;
+    ctx_ << "p += size;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+
+}
+
+
+void CppHelperGenerator::generate_projection_skippers() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Field Skipping (projected readers)" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Advance past a fixed number of bytes without decoding them" << endl;
+    ctx_.start_inline_function("void", "skip_bytes", "const uint8_t*& data, const uint8_t* end, size_t count");
+    ctx_.start_if("count > static_cast<size_t>(end - data)");
+    ctx_ << "throw std::runtime_error(\"Buffer underflow skipping field\");" << endl;
+    ctx_.end_if();
+    ctx_ << "data += count;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "// Advance past count fixed-size elements; checked without overflowing count * size" << endl;
+    ctx_.start_inline_function("void", "skip_array", "const uint8_t*& data, const uint8_t* end, size_t count, size_t element_size");
+    ctx_.start_if("element_size != 0 && count > static_cast<size_t>(end - data) / element_size");
+    ctx_ << "throw std::runtime_error(\"Buffer underflow skipping array\");" << endl;
+    ctx_.end_if();
+    ctx_ << "data += count * element_size;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "// Advance past a null-terminated string without copying it" << endl;
+    ctx_.start_inline_function("void", "skip_string", "const uint8_t*& data, const uint8_t* end");
+    ctx_ << "const void* terminator = std::memchr(data, 0, static_cast<size_t>(end - data));" << endl;
+    ctx_.start_if("!terminator");
+    ctx_ << "throw std::runtime_error(\"String not null-terminated before end of buffer\");" << endl;
+    ctx_.end_if();
+    ctx_ << "data = static_cast<const uint8_t*>(terminator) + 1;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "// Advance past a null-terminated UTF-16 (Width 2) or UTF-32 (Width 4) string" << endl;
+    ctx_ << "template<size_t Width>" << endl;
+    ctx_.start_inline_function("void", "skip_wide_string", "const uint8_t*& data, const uint8_t* end");
+    ctx_.start_while("static_cast<size_t>(end - data) >= Width");
+    ctx_ << "bool terminator = true;" << endl;
+    ctx_.start_for("size_t i = 0", "i < Width", "++i");
+    ctx_ << "terminator = terminator && data[i] == 0;" << endl;
+    ctx_.end_for();
+    ctx_ << "data += Width;" << endl;
+    ctx_.start_if("terminator");
+    ctx_ << "return;" << endl;
+    ctx_.end_if();
+    ctx_.end_while();
+    ctx_ << "throw std::runtime_error(\"Wide string not null-terminated before end of buffer\");" << endl;
+    ctx_.end_inline_function();
+}
+
+void CppHelperGenerator::generate_batch_decode_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <span>" << endl;
+    ctx_ << "#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))" << endl;
+    ctx_ << "#include <xmmintrin.h>" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_batch_decode() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Batch Decoding" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Outcome of one message in read_batch()" << endl;
+    ctx_ << "enum class BatchStatus : uint8_t {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "ok,                    // outputs[i] holds the decoded message" << endl;
+    ctx_ << "constraint_violation,  // A constraint failed; outputs[i] is partially updated" << endl;
+    ctx_ << "decode_error,          // Truncated or malformed input; outputs[i] is partially updated" << endl;
+    ctx_ << "not_decoded            // outputs has no slot for this input" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Messages decoded per group; the next group is prefetched while this one decodes" << endl;
+    ctx_ << "inline constexpr size_t batch_group_size = 8;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Hint that address will be read soon (no-op where unsupported)" << endl;
+    ctx_.start_inline_function("void", "batch_prefetch", "const void* address");
+    ctx_ << "#if defined(__GNUC__) || defined(__clang__)" << endl;
+    ctx_ << "__builtin_prefetch(address, 0, 3);" << endl;
+    ctx_ << "#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))" << endl;
+    ctx_ << "_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "(void)address;" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "// Read a null-terminated string into out, reusing its capacity" << endl;
+    ctx_.start_inline_function("void", "read_string_into", "std::string& out, const uint8_t*& data, const uint8_t* end");
+    ctx_ << "const void* terminator = std::memchr(data, 0, static_cast<size_t>(end - data));" << endl;
+    ctx_.start_if("!terminator");
+    ctx_ << "throw std::runtime_error(\"String not null-terminated before end of buffer\");" << endl;
+    ctx_.end_if();
+    ctx_ << "const uint8_t* last = static_cast<const uint8_t*>(terminator);" << endl;
+    ctx_ << "out.assign(reinterpret_cast<const char*>(data), static_cast<size_t>(last - data));" << endl;
+    ctx_ << "data = last + 1;  // Skip null terminator" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Decode inputs[i] into outputs[i] with read_into(out, data, end)." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * Messages are decoded in groups of batch_group_size. Before a group is" << endl;
+    ctx_ << " * decoded, the first two cache lines of every input in the next group and" << endl;
+    ctx_ << " * their output objects are prefetched, so those misses overlap with" << endl;
+    ctx_ << " * decoding instead of stalling each message in turn. Errors are caught per" << endl;
+    ctx_ << " * message and reported in status; a failed message leaves its output" << endl;
+    ctx_ << " * partially updated but reusable. Returns the number of messages decoded." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T, typename ReadInto>" << endl;
+    ctx_.start_inline_function("size_t", "decode_batch",
+                               "std::span<const std::span<const uint8_t>> inputs, std::span<T> outputs, "
+                               "std::span<BatchStatus> status, ReadInto read_into");
+    ctx_ << "const size_t count = std::min(inputs.size(), outputs.size());" << endl;
+    ctx_ << "auto prefetch_group = [&](size_t first) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t last = std::min(first + batch_group_size, count);" << endl;
+    ctx_.start_for("size_t i = first", "i < last", "++i");
+    ctx_.start_if("!inputs[i].empty()");
+    ctx_ << "batch_prefetch(inputs[i].data());" << endl;
+    ctx_.end_if();
+    ctx_.start_if("inputs[i].size() > 64");
+    ctx_ << "batch_prefetch(inputs[i].data() + 64);" << endl;
+    ctx_.end_if();
+    ctx_ << "batch_prefetch(&outputs[i]);" << endl;
+    ctx_.end_for();
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "size_t decoded = 0;" << endl;
+    ctx_ << "prefetch_group(0);" << endl;
+    ctx_.start_for("size_t group = 0", "group < count", "group += batch_group_size");
+    ctx_ << "prefetch_group(group + batch_group_size);" << endl;
+    ctx_ << "const size_t last = std::min(group + batch_group_size, count);" << endl;
+    ctx_.start_for("size_t i = group", "i < last", "++i");
+    ctx_ << "BatchStatus result = BatchStatus::ok;" << endl;
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* data = inputs[i].data();" << endl;
+    ctx_ << "read_into(outputs[i], data, data + inputs[i].size());" << endl;
+    ctx_ << "++decoded;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (const ConstraintViolation&) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "result = BatchStatus::constraint_violation;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (...) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "result = BatchStatus::decode_error;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.start_if("i < status.size()");
+    ctx_ << "status[i] = result;" << endl;
+    ctx_.end_if();
+    ctx_.end_for();
+    ctx_.end_for();
+    ctx_.start_for("size_t i = count", "i < std::min(inputs.size(), status.size())", "++i");
+    ctx_ << "status[i] = BatchStatus::not_decoded;" << endl;
+    ctx_.end_for();
+    ctx_ << "return decoded;" << endl;
+    ctx_.end_inline_function();
+}
+
+void CppHelperGenerator::generate_record_index_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <filesystem>" << endl;
+    ctx_ << "#include <fstream>" << endl;
+    ctx_ << "#include <optional>" << endl;
+    ctx_ << "#include <system_error>" << endl;
+    ctx_ << "#include <vector>" << endl;
+}
+
+void CppHelperGenerator::generate_record_index() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Record-Offset Index" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Thrown when a record index cannot be built, used or written." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class RecordIndexError : public std::runtime_error {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "explicit RecordIndexError(const std::string& message) : std::runtime_error(message) {}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Consecutive records [first, first + count) at byte offsets [begin, end)." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "struct RecordRange {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t first = 0;" << endl;
+    ctx_ << "uint64_t count = 0;" << endl;
+    ctx_ << "size_t begin = 0;" << endl;
+    ctx_ << "size_t end = 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Sparse record-offset index over a buffer of back-to-back variable-size" << endl;
+    ctx_ << " * records." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * The byte offset of every stride-th record is kept, so record n is found" << endl;
+    ctx_ << " * by jumping to the entry for n / stride and skipping at most stride - 1" << endl;
+    ctx_ << " * records. save() writes the index to a sidecar file together with the" << endl;
+    ctx_ << " * source file's size and modification time; load() returns nothing when" << endl;
+    ctx_ << " * the sidecar is missing, corrupt or older than its source." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "class RecordIndex {" << endl;
+    ctx_ << "public:" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static constexpr uint32_t default_stride = 64;" << endl;
+    ctx_ << blank;
+    ctx_ << "RecordIndex() = default;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Scan data once; skip(p, end) must advance p past exactly one record" << endl;
+    ctx_ << "template<typename Skip>" << endl;
+    ctx_ << "static RecordIndex build(const uint8_t* data, size_t size, uint32_t stride, Skip skip) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (stride == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw RecordIndexError(\"Record index stride must be positive\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "RecordIndex index;" << endl;
+    ctx_ << "index.stride_ = stride;" << endl;
+    ctx_ << "index.data_size_ = size;" << endl;
+    ctx_ << "const uint8_t* p = data;" << endl;
+    ctx_ << "const uint8_t* end = data + size;" << endl;
+    ctx_ << "while (p < end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (index.count_ % stride == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "index.offsets_.push_back(static_cast<uint64_t>(p - data));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const uint8_t* before = p;" << endl;
+    ctx_ << "skip(p, end);" << endl;
+    ctx_ << "if (p <= before) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw RecordIndexError(\"Record \" + std::to_string(index.count_) + \" consumed no input\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "++index.count_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return index;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "uint64_t count() const { return count_; }" << endl;
+    ctx_ << "uint32_t stride() const { return stride_; }" << endl;
+    ctx_ << "size_t data_size() const { return data_size_; }" << endl;
+    ctx_ << blank;
+    ctx_ << "// Byte offset of record n, skipping forward from the nearest indexed record" << endl;
+    ctx_ << "template<typename Skip>" << endl;
+    ctx_ << "size_t offset_of(const uint8_t* data, size_t size, uint64_t n, Skip skip) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (size != data_size_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw RecordIndexError(\"Record index was built for a buffer of a different size\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (n >= count_) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::out_of_range(\"Record \" + std::to_string(n) + \" is past the end of the index\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const uint8_t* p = data + offsets_[n / stride_];" << endl;
+    ctx_ << "const uint8_t* end = data + size;" << endl;
+    ctx_ << "for (uint64_t i = n % stride_; i > 0; --i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "skip(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return static_cast<size_t>(p - data);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Split into at most parts ranges of about equal byte size, cut at indexed records" << endl;
+    ctx_ << "std::vector<RecordRange> split(size_t parts) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::vector<RecordRange> ranges;" << endl;
+    ctx_ << "if (count_ == 0 || parts == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return ranges;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "size_t block = 0;" << endl;
+    ctx_ << "while (block < offsets_.size()) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t k = ranges.size() + 1;" << endl;
+    ctx_ << "const size_t boundary = data_size_ / parts * k + data_size_ % parts * k / parts;" << endl;
+    ctx_ << "size_t next = block + 1;" << endl;
+    ctx_ << "while (next < offsets_.size() && offsets_[next] < boundary) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "++next;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "RecordRange range;" << endl;
+    ctx_ << "range.first = block * uint64_t(stride_);" << endl;
+    ctx_ << "range.count = std::min<uint64_t>(next * uint64_t(stride_), count_) - range.first;" << endl;
+    ctx_ << "range.begin = static_cast<size_t>(offsets_[block]);" << endl;
+    ctx_ << "range.end = next < offsets_.size() ? static_cast<size_t>(offsets_[next]) : data_size_;" << endl;
+    ctx_ << "ranges.push_back(range);" << endl;
+    ctx_ << "block = next;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return ranges;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Write the sidecar index; source_path's current size and mtime are recorded" << endl;
+    ctx_ << "void save(const std::string& index_path, const std::string& source_path) const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "auto source = fingerprint(source_path);" << endl;
+    ctx_ << "if (!source) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw RecordIndexError(\"Cannot stat source file \" + source_path);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "std::vector<uint64_t> words = {magic, stride_, count_, data_size_, source->first, source->second," << endl;
+    ctx_ << "                               offsets_.size()};" << endl;
+    ctx_ << "words.insert(words.end(), offsets_.begin(), offsets_.end());" << endl;
+    ctx_ << "words.push_back(checksum(words));" << endl;
+    ctx_ << "std::ofstream out(index_path, std::ios::binary | std::ios::trunc);" << endl;
+    ctx_ << "out.write(reinterpret_cast<const char*>(words.data())," << endl;
+    ctx_ << "          static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));" << endl;
+    ctx_ << "if (!out) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw RecordIndexError(\"Cannot write record index \" + index_path);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Read a sidecar index; nothing if it is missing, corrupt or its source changed" << endl;
+    ctx_ << "static std::optional<RecordIndex> load(const std::string& index_path, const std::string& source_path) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::ifstream in(index_path, std::ios::binary | std::ios::ate);" << endl;
+    ctx_ << "if (!in) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const auto bytes = static_cast<size_t>(in.tellg());" << endl;
+    ctx_ << "if (bytes % sizeof(uint64_t) != 0 || bytes < header_words * sizeof(uint64_t) + sizeof(uint64_t)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "std::vector<uint64_t> words(bytes / sizeof(uint64_t));" << endl;
+    ctx_ << "in.seekg(0);" << endl;
+    ctx_ << "if (!in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(bytes))) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const uint64_t stored = words.back();" << endl;
+    ctx_ << "words.pop_back();" << endl;
+    ctx_ << "auto source = fingerprint(source_path);" << endl;
+    ctx_ << "if (words[0] != magic || checksum(words) != stored || !source ||" << endl;
+    ctx_.writer().indent();
+    ctx_ << "words[4] != source->first || words[5] != source->second ||" << endl;
+    ctx_ << "words[6] != words.size() - header_words) {" << endl;
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "RecordIndex index;" << endl;
+    ctx_ << "index.stride_ = static_cast<uint32_t>(words[1]);" << endl;
+    ctx_ << "index.count_ = words[2];" << endl;
+    ctx_ << "index.data_size_ = static_cast<size_t>(words[3]);" << endl;
+    ctx_ << "index.offsets_.assign(words.begin() + header_words, words.end());" << endl;
+    ctx_ << "if (index.stride_ == 0 || words[1] != index.stride_ ||" << endl;
+    ctx_.writer().indent();
+    ctx_ << "index.offsets_.size() != (index.count_ + index.stride_ - 1) / index.stride_) {" << endl;
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return index;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "static constexpr uint64_t magic = 0x3130584449524453ULL;  // \"DSRIDX01\"" << endl;
+    ctx_ << "static constexpr size_t header_words = 7;" << endl;
+    ctx_ << blank;
+    ctx_ << "uint32_t stride_ = default_stride;" << endl;
+    ctx_ << "uint64_t count_ = 0;" << endl;
+    ctx_ << "size_t data_size_ = 0;" << endl;
+    ctx_ << "std::vector<uint64_t> offsets_;  // Byte offset of records 0, stride, 2 * stride, ..." << endl;
+    ctx_ << blank;
+    ctx_ << "// (size, mtime) of a file, or nothing if it cannot be read" << endl;
+    ctx_ << "static std::optional<std::pair<uint64_t, uint64_t>> fingerprint(const std::string& path) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::error_code ec;" << endl;
+    ctx_ << "const auto size = std::filesystem::file_size(path, ec);" << endl;
+    ctx_ << "if (ec) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const auto mtime = std::filesystem::last_write_time(path, ec);" << endl;
+    ctx_ << "if (ec) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return std::nullopt;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return std::make_pair(static_cast<uint64_t>(size)," << endl;
+    ctx_ << "                      static_cast<uint64_t>(mtime.time_since_epoch().count()));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// FNV-1a over the index words" << endl;
+    ctx_ << "static uint64_t checksum(const std::vector<uint64_t>& words) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t hash = 14695981039346656037ULL;" << endl;
+    ctx_ << "for (uint64_t word : words) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (int shift = 0; shift < 64; shift += 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "hash = (hash ^ ((word >> shift) & 0xFF)) * 1099511628211ULL;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return hash;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+}
+
+void CppHelperGenerator::generate_parallel_decode_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <atomic>" << endl;
+    ctx_ << "#include <exception>" << endl;
+    ctx_ << "#include <iterator>" << endl;
+    ctx_ << "#include <system_error>" << endl;
+    ctx_ << "#include <thread>" << endl;
+}
+
+void CppHelperGenerator::generate_parallel_decode() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Parallel Decoding of Record Streams" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "/**" << endl;
+    ctx_ << " * Decode a buffer of back-to-back variable-size records on a thread pool." << endl;
+    ctx_ << " *" << endl;
+    ctx_ << " * With one worker the records are simply decoded in order. Otherwise" << endl;
+    ctx_ << " * phase 1 walks the buffer serially with skip(p, end), which decodes only" << endl;
+    ctx_ << " * the fields that determine a record's size, and cuts it into chunks of" << endl;
+    ctx_ << " * about size / (4 * workers) bytes at record boundaries. Phase 2 decodes" << endl;
+    ctx_ << " * the chunks in parallel with read(p, end) into one vector per chunk, and" << endl;
+    ctx_ << " * the vectors are concatenated in input order. A malformed record throws" << endl;
+    ctx_ << " * from phase 1; an exception from phase 2 is rethrown for the first" << endl;
+    ctx_ << " * failing chunk after all workers finish. On every path, a record that" << endl;
+    ctx_ << " * consumes no input throws instead of repeating forever." << endl;
+    ctx_ << " */" << endl;
+    ctx_ << "template<typename T, typename Skip, typename Read>" << endl;
+    ctx_ << "inline std::vector<T> parallel_decode(const uint8_t* data, size_t size, size_t workers, Skip skip, Read read) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (workers == 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "workers = std::max<size_t>(1, std::thread::hardware_concurrency());" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "const uint8_t* end = data + size;" << endl;
+    ctx_ << "const uint8_t* p = data;" << endl;
+    ctx_ << "if (workers == 1) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// No parallelism: a boundary pass would only add work" << endl;
+    ctx_ << "std::vector<T> result;" << endl;
+    ctx_ << "while (p < end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* before = p;" << endl;
+    ctx_ << "result.push_back(read(p, end));" << endl;
+    ctx_ << "if (p <= before) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Record consumed no input\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Phase 1: record boundaries only" << endl;
+    ctx_ << "struct Chunk {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* begin;" << endl;
+    ctx_ << "const uint8_t* end;" << endl;
+    ctx_ << "size_t count;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "std::vector<Chunk> chunks;" << endl;
+    ctx_ << "const size_t target = std::max<size_t>(1, size / (workers * 4));" << endl;
+    ctx_ << "Chunk current{p, p, 0};" << endl;
+    ctx_ << "while (p < end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* before = p;" << endl;
+    ctx_ << "skip(p, end);" << endl;
+    ctx_ << "if (p <= before) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Record consumed no input\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "++current.count;" << endl;
+    ctx_ << "if (static_cast<size_t>(p - current.begin) >= target) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "current.end = p;" << endl;
+    ctx_ << "chunks.push_back(current);" << endl;
+    ctx_ << "current = Chunk{p, p, 0};" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (current.count > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "current.end = p;" << endl;
+    ctx_ << "chunks.push_back(current);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Phase 2: decode chunks in parallel, each into its own vector" << endl;
+    ctx_ << "std::vector<std::vector<T>> decoded(chunks.size());" << endl;
+    ctx_ << "std::vector<std::exception_ptr> errors(chunks.size());" << endl;
+    ctx_ << "std::atomic<size_t> next{0};" << endl;
+    ctx_ << "auto work = [&]() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = next++; i < chunks.size(); i = next++) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "decoded[i].reserve(chunks[i].count);" << endl;
+    ctx_ << "const uint8_t* q = chunks[i].begin;" << endl;
+    ctx_ << "while (q < chunks[i].end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* before = q;" << endl;
+    ctx_ << "decoded[i].push_back(read(q, chunks[i].end));" << endl;
+    ctx_ << "// skip() advanced here; a read() that does not would loop forever" << endl;
+    ctx_ << "if (q <= before) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "throw std::runtime_error(\"Record consumed no input\");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (...) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "errors[i] = std::current_exception();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "const size_t threads = std::min(workers, chunks.size());" << endl;
+    ctx_ << "std::vector<std::thread> pool;" << endl;
+    ctx_ << "for (size_t t = 1; t < threads; ++t) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "pool.emplace_back(work);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (const std::system_error&) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "break;  // Run with the threads already started" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "work();  // The calling thread is one of the workers" << endl;
+    ctx_ << "for (auto& thread : pool) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "thread.join();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "for (const auto& error : errors) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (error) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::rethrow_exception(error);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "size_t total = 0;" << endl;
+    ctx_ << "for (const auto& chunk : chunks) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "total += chunk.count;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "std::vector<T> result;" << endl;
+    ctx_ << "result.reserve(total);" << endl;
+    ctx_ << "for (auto& part : decoded) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::move(part.begin(), part.end(), std::back_inserter(result));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return result;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+void CppHelperGenerator::generate_visitor_includes() {
+    ctx_ << "#include <string_view>" << endl;
+    ctx_ << "#include <type_traits>" << endl;
+}
+
+void CppHelperGenerator::generate_visitor() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Visitor Decoding" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Hooks of the parse_<Type>(data, end, visitor) functions. Every hook is" << endl;
+    ctx_ << "// optional and takes the field's tag (fields::<Type>::<field>) as its" << endl;
+    ctx_ << "// template argument:" << endl;
+    ctx_ << "//   on_field<Tag>(const Tag::value_type& value)       A decoded value or array element" << endl;
+    ctx_ << "//   begin_struct<Tag>() / end_struct<Tag>()           A nested struct, union or choice" << endl;
+    ctx_ << "//   begin_array<Tag>(size_t count) / end_array<Tag>() An array, before its elements" << endl;
+    ctx_ << "//   begin_choice<Tag>() / end_choice<Tag>()           The decoded union branch or choice case" << endl;
+    ctx_ << "namespace visit {" << endl;
+    ctx_ << blank;
+    ctx_ << "// Element count passed to begin_array() for T[] arrays, which run to the end of the input" << endl;
+    ctx_ << "inline constexpr size_t unknown_count = static_cast<size_t>(-1);" << endl;
+    ctx_ << blank;
+    ctx_ << "// A field the visitor does not handle is skipped, or decoded only as far as" << endl;
+    ctx_ << "// later length, selector and constraint expressions need it" << endl;
+    ctx_ << "template<typename Tag, typename V>" << endl;
+    ctx_ << "concept handles = requires (V& v, const typename Tag::value_type& value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "v.template on_field<Tag>(value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<typename Tag, typename V, typename T>" << endl;
+    ctx_ << "inline void field(V& v, const T& value) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if constexpr (handles<Tag, V>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "v.template on_field<Tag>(value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+
+    // One wrapper per structural hook: called only when the visitor declares it
+    const struct { const char* name; const char* params; const char* args; } hooks[] = {
+        {"begin_struct", "", ""},
+        {"end_struct", "", ""},
+        {"begin_array", ", size_t count", "count"},
+        {"end_array", "", ""},
+        {"begin_choice", "", ""},
+        {"end_choice", "", ""},
+    };
+    for (const auto& hook : hooks) {
+        const std::string name = hook.name;
+        const std::string call = "v.template " + name + "<Tag>(" + hook.args + ")";
+        ctx_ << blank;
+        ctx_ << "template<typename Tag, typename V>" << endl;
+        ctx_ << "inline void " + name + "(V& v" + hook.params + ") {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "if constexpr (requires { " + call + "; }) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << call + ";" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    }
+    ctx_ << blank;
+
+    ctx_ << "// Visitor of union trial passes: handles nothing, so a branch is only validated" << endl;
+    ctx_ << "struct null_visitor {};" << endl;
+    ctx_ << blank;
+    ctx_ << "// True when decode() completes without a constraint violation" << endl;
+    ctx_ << "template<typename Fn>" << endl;
+    ctx_ << "inline bool try_branch(Fn&& decode) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "try {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "decode();" << endl;
+    ctx_ << "return true;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} catch (const ConstraintViolation&) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return false;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Null-terminated string as a view into the input" << endl;
+    ctx_.start_inline_function("std::string_view", "read_string_view", "const uint8_t*& data, const uint8_t* end");
+    ctx_ << "const void* terminator = std::memchr(data, 0, static_cast<size_t>(end - data));" << endl;
+    ctx_.start_if("!terminator");
+    ctx_ << "throw std::runtime_error(\"String not null-terminated before end of buffer\");" << endl;
+    ctx_.end_if();
+    ctx_ << "std::string_view value(reinterpret_cast<const char*>(data)," << endl;
+    ctx_ << "                       static_cast<size_t>(static_cast<const uint8_t*>(terminator) - data));" << endl;
+    ctx_ << "data = static_cast<const uint8_t*>(terminator) + 1;" << endl;
+    ctx_ << "return value;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "// Bits [offset, offset + width) of a bitfield group, least significant bit first" << endl;
+    ctx_.start_inline_function("uint64_t", "extract_bits", "const uint8_t* bytes, size_t offset, size_t width");
+    ctx_ << "uint64_t value = 0;" << endl;
+    ctx_.start_for("size_t i = 0", "i < width", "++i");
+    ctx_ << "const size_t bit = offset + i;" << endl;
+    ctx_ << "value |= static_cast<uint64_t>((bytes[bit / 8] >> (bit % 8)) & 1u) << i;" << endl;
+    ctx_.end_for();
+    ctx_ << "return value;" << endl;
+    ctx_.end_inline_function();
+    ctx_ << blank;
+    ctx_ << "}  // namespace visit" << endl;
+    ctx_ << blank;
+}
+
+void CppHelperGenerator::generate_cpu_dispatch_includes() {
+    ctx_ << "#include <algorithm>" << endl;
+    ctx_ << "#include <bit>" << endl;
+    ctx_ << "#include <chrono>" << endl;
+    ctx_ << "#include <cstdio>" << endl;
+    ctx_ << "#include <cstdlib>" << endl;
+    ctx_ << "#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)" << endl;
+    ctx_ << "#define DATASCRIPT_CPU_X86 1" << endl;
+    ctx_ << "#include <immintrin.h>" << endl;
+    ctx_ << "#if defined(_MSC_VER)" << endl;
+    ctx_ << "#include <intrin.h>" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "#if defined(DATASCRIPT_CPU_X86) && (defined(__GNUC__) || defined(__clang__))" << endl;
+    ctx_ << "#define DATASCRIPT_TARGET(isa) __attribute__((target(isa)))" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "#define DATASCRIPT_TARGET(isa)" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_cpu_dispatch() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// CPU Feature Dispatch" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Vector kernels are compiled for every x86 level in one binary; the best" << endl;
+    ctx_ << "// level the CPU supports is picked once, on first use. Set the environment" << endl;
+    ctx_ << "// variable DATASCRIPT_FORCE_ISA=scalar|sse2|sse4.2|avx2|avx512 to run a" << endl;
+    ctx_ << "// lower level; a higher one than the CPU supports runs the best it has" << endl;
+    ctx_ << "namespace cpu {" << endl;
+    ctx_ << blank;
+    ctx_ << "enum class Isa : uint8_t { Scalar, Sse2, Sse42, Avx2, Avx512 };" << endl;
+    ctx_ << blank;
+    ctx_ << "inline const char* isa_name(Isa isa) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "switch (isa) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "case Isa::Sse2: return \"sse2\";" << endl;
+    ctx_ << "case Isa::Sse42: return \"sse4.2\";" << endl;
+    ctx_ << "case Isa::Avx2: return \"avx2\";" << endl;
+    ctx_ << "case Isa::Avx512: return \"avx512\";" << endl;
+    ctx_ << "default: return \"scalar\";" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Level named by isa_name(), or fallback for anything else" << endl;
+    ctx_ << "inline Isa parse_isa(const char* name, Isa fallback) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const std::string text = name;" << endl;
+    ctx_ << "for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Sse42, Isa::Avx2, Isa::Avx512}) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (text == isa_name(isa)) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return isa;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return fallback;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Best level this CPU and OS support (AVX levels need the OS to save the" << endl;
+    ctx_ << "// wider registers)" << endl;
+    ctx_ << "inline Isa detect_isa() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "#if defined(DATASCRIPT_CPU_X86) && (defined(__GNUC__) || defined(__clang__))" << endl;
+    ctx_ << "__builtin_cpu_init();" << endl;
+    ctx_ << "if (__builtin_cpu_supports(\"avx512f\") && __builtin_cpu_supports(\"avx512bw\")) return Isa::Avx512;" << endl;
+    ctx_ << "if (__builtin_cpu_supports(\"avx2\")) return Isa::Avx2;" << endl;
+    ctx_ << "if (__builtin_cpu_supports(\"sse4.2\")) return Isa::Sse42;" << endl;
+    ctx_ << "if (__builtin_cpu_supports(\"sse2\")) return Isa::Sse2;" << endl;
+    ctx_ << "return Isa::Scalar;" << endl;
+    ctx_ << "#elif defined(DATASCRIPT_CPU_X86) && defined(_MSC_VER)" << endl;
+    ctx_ << "int info[4];" << endl;
+    ctx_ << "__cpuid(info, 0);" << endl;
+    ctx_ << "const int max_leaf = info[0];" << endl;
+    ctx_ << "__cpuid(info, 1);" << endl;
+    ctx_ << "const bool sse2 = (info[3] & (1 << 26)) != 0;" << endl;
+    ctx_ << "const bool sse42 = (info[2] & (1 << 20)) != 0 && (info[2] & (1 << 9)) != 0;" << endl;
+    ctx_ << "const unsigned long long xcr0 = (info[2] & (1 << 27)) != 0 ? _xgetbv(0) : 0;" << endl;
+    ctx_ << "bool avx2 = false;" << endl;
+    ctx_ << "bool avx512 = false;" << endl;
+    ctx_ << "if (max_leaf >= 7 && (xcr0 & 0x6) == 0x6) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__cpuidex(info, 7, 0);" << endl;
+    ctx_ << "avx2 = (info[1] & (1 << 5)) != 0;" << endl;
+    ctx_ << "avx512 = (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (avx512) return Isa::Avx512;" << endl;
+    ctx_ << "if (avx2) return Isa::Avx2;" << endl;
+    ctx_ << "if (sse42) return Isa::Sse42;" << endl;
+    ctx_ << "return sse2 ? Isa::Sse2 : Isa::Scalar;" << endl;
+    ctx_ << "#else" << endl;
+    ctx_ << "return Isa::Scalar;" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Mode bits of the delta32 / delta64 kernels" << endl;
+    ctx_ << "constexpr unsigned delta_swap = 1;    // Words are stored in the other byte order" << endl;
+    ctx_ << "constexpr unsigned delta_zigzag = 2;  // Zigzag-decode each word first (@zigzag_delta)" << endl;
+    ctx_ << "constexpr unsigned delta_twice = 4;   // Two running sums (@delta_of_delta)" << endl;
+    ctx_ << blank;
+    ctx_ << "// Calls Run::run<W, Swap, Zigzag, Twice>() for the mode bits, so every" << endl;
+    ctx_ << "// delta kernel compiles its loop once per mode" << endl;
+    ctx_ << "template<typename Run, typename W>" << endl;
+    ctx_ << "inline void run_delta(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, W& value, W& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "switch (mode & 7u) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "case 0: Run::template run<W, false, false, false>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 1: Run::template run<W, true, false, false>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 2: Run::template run<W, false, true, false>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 3: Run::template run<W, true, true, false>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 4: Run::template run<W, false, false, true>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 5: Run::template run<W, true, false, true>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "case 6: Run::template run<W, false, true, true>(src, dst, count, value, delta); break;" << endl;
+    ctx_ << "default: Run::template run<W, true, true, true>(src, dst, count, value, delta); break;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// One implementation of every kernel, all of the same level" << endl;
+    ctx_ << "struct Kernels {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "Isa isa;" << endl;
+    ctx_ << "// Copy count 2-, 4- or 8-byte words from src to dst, reversing the bytes of each" << endl;
+    ctx_ << "void (*byteswap16)(uint8_t* dst, const uint8_t* src, size_t count);" << endl;
+    ctx_ << "void (*byteswap32)(uint8_t* dst, const uint8_t* src, size_t count);" << endl;
+    ctx_ << "void (*byteswap64)(uint8_t* dst, const uint8_t* src, size_t count);" << endl;
+    ctx_ << "// First zero byte, or zero 2- / 4-byte unit counted from p, in [p, end); nullptr if none" << endl;
+    ctx_ << "const uint8_t* (*find_zero8)(const uint8_t* p, const uint8_t* end);" << endl;
+    ctx_ << "const uint8_t* (*find_zero16)(const uint8_t* p, const uint8_t* end);" << endl;
+    ctx_ << "const uint8_t* (*find_zero32)(const uint8_t* p, const uint8_t* end);" << endl;
+    ctx_ << "// Undo @xor and @rol in place (left is 1..7)" << endl;
+    ctx_ << "void (*xor_bytes)(uint8_t* bytes, size_t size, uint8_t key);" << endl;
+    ctx_ << "void (*rotl_bytes)(uint8_t* bytes, size_t size, unsigned left);" << endl;
+    ctx_ << "// Narrow leading ASCII UTF-16 / UTF-32 units to out; returns the units" << endl;
+    ctx_ << "// written, which may stop short of the first non-ASCII unit" << endl;
+    ctx_ << "size_t (*ascii16)(const uint8_t* src, size_t units, char* out, bool big_endian);" << endl;
+    ctx_ << "size_t (*ascii32)(const uint8_t* src, size_t units, char* out, bool big_endian);" << endl;
+    ctx_ << "// Rebuild count 4- / 8-byte words of a delta-encoded array from src into dst" << endl;
+    ctx_ << "// as running sums; value and delta carry the sums in and out of each call" << endl;
+    ctx_ << "void (*delta32)(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint32_t& value, uint32_t& delta);" << endl;
+    ctx_ << "void (*delta64)(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint64_t& value, uint64_t& delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    generate_cpu_scalar_kernels();
+    ctx_ << blank;
+    generate_cpu_x86_kernels();
+    ctx_ << blank;
+    ctx_ << "// Kernels of the given level, lowered to what this CPU supports" << endl;
+    ctx_ << "inline Kernels kernels_for(Isa isa) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "isa = std::min(isa, detect_isa());" << endl;
+    ctx_ << "Kernels k{Isa::Scalar, scalar::byteswap16, scalar::byteswap32, scalar::byteswap64," << endl;
+    ctx_.writer().indent();
+    ctx_ << "      scalar::find_zero8, scalar::find_zero16, scalar::find_zero32," << endl;
+    ctx_ << "      scalar::xor_bytes, scalar::rotl_bytes, scalar::ascii16, scalar::ascii32," << endl;
+    ctx_ << "      scalar::delta32, scalar::delta64};" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "#if defined(DATASCRIPT_CPU_X86)" << endl;
+    ctx_ << "if (isa >= Isa::Sse2) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "k = Kernels{Isa::Sse2, sse2::byteswap16, sse2::byteswap32, sse2::byteswap64," << endl;
+    ctx_.writer().indent();
+    ctx_ << "        sse2::find_zero8, sse2::find_zero16, sse2::find_zero32," << endl;
+    ctx_ << "        sse2::xor_bytes, sse2::rotl_bytes, sse2::ascii16, sse2::ascii32," << endl;
+    ctx_ << "        sse2::delta32, sse2::delta64};" << endl;
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (isa >= Isa::Sse42) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "k.isa = Isa::Sse42;" << endl;
+    ctx_ << "k.byteswap16 = sse42::byteswap16;" << endl;
+    ctx_ << "k.byteswap32 = sse42::byteswap32;" << endl;
+    ctx_ << "k.byteswap64 = sse42::byteswap64;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (isa >= Isa::Avx2) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "k = Kernels{Isa::Avx2, avx2::byteswap16, avx2::byteswap32, avx2::byteswap64," << endl;
+    ctx_.writer().indent();
+    ctx_ << "        avx2::find_zero8, avx2::find_zero16, avx2::find_zero32," << endl;
+    ctx_ << "        avx2::xor_bytes, avx2::rotl_bytes, avx2::ascii16, avx2::ascii32," << endl;
+    ctx_ << "        avx2::delta32, avx2::delta64};" << endl;
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if (isa >= Isa::Avx512) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "// The transcoding kernels stay at AVX2: their runs are rarely long enough for 64-byte blocks." << endl;
+    ctx_ << "// So do the delta kernels, whose sums are carried serially from block to block" << endl;
+    ctx_ << "k.isa = Isa::Avx512;" << endl;
+    ctx_ << "k.byteswap16 = avx512::byteswap16;" << endl;
+    ctx_ << "k.byteswap32 = avx512::byteswap32;" << endl;
+    ctx_ << "k.byteswap64 = avx512::byteswap64;" << endl;
+    ctx_ << "k.find_zero8 = avx512::find_zero8;" << endl;
+    ctx_ << "k.find_zero16 = avx512::find_zero16;" << endl;
+    ctx_ << "k.find_zero32 = avx512::find_zero32;" << endl;
+    ctx_ << "k.xor_bytes = avx512::xor_bytes;" << endl;
+    ctx_ << "k.rotl_bytes = avx512::rotl_bytes;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "#endif" << endl;
+    ctx_ << "return k;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Level in use: detected once, possibly lowered by DATASCRIPT_FORCE_ISA" << endl;
+    ctx_ << "inline Isa active_isa() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static const Isa isa = [] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const Isa detected = detect_isa();" << endl;
+    ctx_ << "const char* forced = std::getenv(\"DATASCRIPT_FORCE_ISA\");" << endl;
+    ctx_ << "return forced != nullptr ? std::min(parse_isa(forced, detected), detected) : detected;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}();" << endl;
+    ctx_ << "return isa;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Kernel table of active_isa(), built on first use" << endl;
+    ctx_ << "inline const Kernels& kernels() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "static const Kernels table = kernels_for(active_isa());" << endl;
+    ctx_ << "return table;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "struct KernelThroughput {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const char* kernel;" << endl;
+    ctx_ << "Isa isa;" << endl;
+    ctx_ << "double mb_per_s;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Time every kernel at every level up to detect_isa() on `bytes` bytes of" << endl;
+    ctx_ << "// input (best of `rounds` runs). For tuning and for checking a host; the" << endl;
+    ctx_ << "// readers never call it." << endl;
+    ctx_ << "inline std::vector<KernelThroughput> benchmark_kernels(size_t bytes = size_t(1) << 20, int rounds = 5) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "bytes = std::max<size_t>(bytes / 8 * 8, 8);" << endl;
+    ctx_ << "// Nonzero ASCII everywhere: searches and ASCII runs cover the whole buffer" << endl;
+    ctx_ << "std::vector<uint8_t> narrow(bytes), wide16(bytes, 0), wide32(bytes, 0), out(bytes);" << endl;
+    ctx_ << "std::vector<char> text(bytes);" << endl;
+    ctx_ << "for (size_t i = 0; i < bytes; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "narrow[i] = static_cast<uint8_t>(0x20 + i % 0x5F);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "for (size_t i = 0; i < bytes / 2; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "wide16[2 * i] = narrow[i];" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "for (size_t i = 0; i < bytes / 4; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "wide32[4 * i] = narrow[i];" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "std::vector<KernelThroughput> results;" << endl;
+    ctx_ << "volatile size_t sink = 0;" << endl;
+    ctx_ << "for (int level = 0; level <= static_cast<int>(detect_isa()); ++level) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const Kernels k = kernels_for(static_cast<Isa>(level));" << endl;
+    ctx_ << "auto measure = [&](const char* kernel, auto&& run) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "double best = 0;" << endl;
+    ctx_ << "for (int r = 0; r < rounds; ++r) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const auto start = std::chrono::steady_clock::now();" << endl;
+    ctx_ << "run();" << endl;
+    ctx_ << "const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();" << endl;
+    ctx_ << "if (seconds > 0) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "best = std::max(best, static_cast<double>(bytes) / seconds / 1e6);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "results.push_back({kernel, k.isa, best});" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << "const uint8_t* src = narrow.data();" << endl;
+    ctx_ << "measure(\"byteswap16\", [&] { k.byteswap16(out.data(), src, bytes / 2); });" << endl;
+    ctx_ << "measure(\"byteswap32\", [&] { k.byteswap32(out.data(), src, bytes / 4); });" << endl;
+    ctx_ << "measure(\"byteswap64\", [&] { k.byteswap64(out.data(), src, bytes / 8); });" << endl;
+    ctx_ << "measure(\"find_zero8\", [&] { sink = sink + (k.find_zero8(src, src + bytes) != nullptr); });" << endl;
+    ctx_ << "measure(\"find_zero16\", [&] { sink = sink + (k.find_zero16(wide16.data(), wide16.data() + bytes) != nullptr); });" << endl;
+    ctx_ << "measure(\"find_zero32\", [&] { sink = sink + (k.find_zero32(wide32.data(), wide32.data() + bytes) != nullptr); });" << endl;
+    ctx_ << "measure(\"xor_bytes\", [&] { k.xor_bytes(out.data(), bytes, 0x5A); });" << endl;
+    ctx_ << "measure(\"rotl_bytes\", [&] { k.rotl_bytes(out.data(), bytes, 3); });" << endl;
+    ctx_ << "measure(\"ascii16\", [&] { sink = sink + k.ascii16(wide16.data(), bytes / 2, text.data(), false); });" << endl;
+    ctx_ << "measure(\"ascii32\", [&] { sink = sink + k.ascii32(wide32.data(), bytes / 4, text.data(), false); });" << endl;
+    ctx_ << "measure(\"delta32\", [&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t value = 0, delta = 0;" << endl;
+    ctx_ << "k.delta32(src, out.data(), bytes / 4, 0, value, delta);" << endl;
+    ctx_ << "sink = sink + value;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "});" << endl;
+    ctx_ << "measure(\"delta64\", [&] {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint64_t value = 0, delta = 0;" << endl;
+    ctx_ << "k.delta64(src, out.data(), bytes / 8, 0, value, delta);" << endl;
+    ctx_ << "sink = sink + static_cast<size_t>(value);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "});" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return results;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// One line per kernel and level, e.g. \"byteswap32   avx2      11843.2 MB/s\"" << endl;
+    ctx_ << "inline std::string format_benchmark(const std::vector<KernelThroughput>& results) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::string report;" << endl;
+    ctx_ << "char line[96];" << endl;
+    ctx_ << "for (const auto& result : results) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "std::snprintf(line, sizeof(line), \"%-12s %-8s %10.1f MB/s\\n\", result.kernel, isa_name(result.isa)," << endl;
+    ctx_ << "              result.mb_per_s);" << endl;
+    ctx_ << "report += line;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return report;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace cpu" << endl;
+    ctx_ << blank;
+}
+
+void CppHelperGenerator::generate_cpu_scalar_kernels() {
+    ctx_ << "namespace scalar {" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void byteswap16(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "dst[2 * i] = src[2 * i + 1];" << endl;
+    ctx_ << "dst[2 * i + 1] = src[2 * i];" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void byteswap32(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "uint32_t w;" << endl;
+    ctx_ << "std::memcpy(&w, src + 4 * i, 4);" << endl;
+    ctx_ << "w = (w >> 24) | ((w >> 8) & 0x0000FF00u) | ((w << 8) & 0x00FF0000u) | (w << 24);" << endl;
+    ctx_ << "std::memcpy(dst + 4 * i, &w, 4);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void byteswap64(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t b = 0; b < 8; ++b) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "dst[8 * i + b] = src[8 * i + 7 - b];" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline const uint8_t* find_zero8(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if (p == end) return nullptr;" << endl;
+    ctx_ << "return static_cast<const uint8_t*>(std::memchr(p, 0, static_cast<size_t>(end - p)));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline const uint8_t* find_zero16(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (; end - p >= 2; p += 2) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if ((p[0] | p[1]) == 0) return p;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return nullptr;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline const uint8_t* find_zero32(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (; end - p >= 4; p += 4) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "if ((p[0] | p[1] | p[2] | p[3]) == 0) return p;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return nullptr;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void xor_bytes(uint8_t* bytes, size_t size, uint8_t key) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < size; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "bytes[i] = static_cast<uint8_t>(bytes[i] ^ key);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void rotl_bytes(uint8_t* bytes, size_t size, unsigned left) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < size; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "bytes[i] = static_cast<uint8_t>((bytes[i] << left) | (bytes[i] >> (8u - left)));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline size_t ascii16(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i < units; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t high = src[2 * i + (big_endian ? 0 : 1)];" << endl;
+    ctx_ << "const uint8_t low = src[2 * i + (big_endian ? 1 : 0)];" << endl;
+    ctx_ << "if (high != 0 || low >= 0x80) break;" << endl;
+    ctx_ << "out[i] = static_cast<char>(low);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline size_t ascii32(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i < units; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const uint8_t* u = src + 4 * i;" << endl;
+    ctx_ << "const uint8_t low = big_endian ? u[3] : u[0];" << endl;
+    ctx_ << "const uint32_t rest = big_endian ? (u[0] | u[1] | u[2]) : (u[1] | u[2] | u[3]);" << endl;
+    ctx_ << "if (rest != 0 || low >= 0x80) break;" << endl;
+    ctx_ << "out[i] = static_cast<char>(low);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline uint32_t swap_word(uint32_t w) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return (w >> 24) | ((w >> 8) & 0x0000FF00u) | ((w << 8) & 0x00FF0000u) | (w << 24);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline uint64_t swap_word(uint64_t w) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return (uint64_t(swap_word(static_cast<uint32_t>(w))) << 32) | swap_word(static_cast<uint32_t>(w >> 32));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "struct DeltaRun {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "template<typename W, bool Swap, bool Zigzag, bool Twice>" << endl;
+    ctx_ << "static void run(const uint8_t* src, uint8_t* dst, size_t count, W& value, W& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (size_t i = 0; i < count; ++i) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "W w;" << endl;
+    ctx_ << "std::memcpy(&w, src + i * sizeof(W), sizeof(W));" << endl;
+    ctx_ << "if constexpr (Swap) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "w = swap_word(w);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Zigzag) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "w = static_cast<W>((w >> 1) ^ (W(0) - (w & 1)));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Twice) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "delta = static_cast<W>(delta + w);" << endl;
+    ctx_ << "w = delta;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "value = static_cast<W>(value + w);" << endl;
+    ctx_ << "std::memcpy(dst + i * sizeof(W), &value, sizeof(W));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void delta32(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint32_t& value, uint32_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "inline void delta64(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint64_t& value, uint64_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace scalar" << endl;
+}
+
+void CppHelperGenerator::generate_cpu_x86_kernels() {
+    ctx_ << "#if defined(DATASCRIPT_CPU_X86)" << endl;
+    ctx_ << "namespace sse2 {" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline __m128i swap16(__m128i x) { return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)); }" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void byteswap16(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 8 <= count; i += 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), swap16(x));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "scalar::byteswap16(dst + 2 * i, src + 2 * i, count - i);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void byteswap32(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 4 <= count; i += 4) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = swap16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i)));" << endl;
+    ctx_ << "x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "scalar::byteswap32(dst + 4 * i, src + 4 * i, count - i);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void byteswap64(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 2 <= count; i += 2) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = swap16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * i)));" << endl;
+    ctx_ << "x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1B), 0x1B);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8 * i), x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "scalar::byteswap64(dst + 8 * i, src + 8 * i, count - i);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero8(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m128i zero = _mm_setzero_si128();" << endl;
+    ctx_ << "for (; end - p >= 16; p += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return scalar::find_zero8(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero16(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m128i zero = _mm_setzero_si128();" << endl;
+    ctx_ << "for (; end - p >= 16; p += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return scalar::find_zero16(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero32(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m128i zero = _mm_setzero_si128();" << endl;
+    ctx_ << "for (; end - p >= 16; p += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return scalar::find_zero32(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void xor_bytes(uint8_t* bytes, size_t size, uint8_t key) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m128i k = _mm_set1_epi8(static_cast<char>(key));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 16 <= size; i += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), _mm_xor_si128(x, k));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "scalar::xor_bytes(bytes + i, size - i, key);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// No 8-bit shifts: shift 16-bit lanes, then mask off the bits that crossed into the neighbouring byte" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void rotl_bytes(uint8_t* bytes, size_t size, unsigned left) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m128i high_mask = _mm_set1_epi8(static_cast<char>((0xFFu << left) & 0xFFu));" << endl;
+    ctx_ << "const __m128i low_mask = _mm_set1_epi8(static_cast<char>(0xFFu >> (8u - left)));" << endl;
+    ctx_ << "const __m128i left_count = _mm_cvtsi32_si128(static_cast<int>(left));" << endl;
+    ctx_ << "const __m128i right_count = _mm_cvtsi32_si128(static_cast<int>(8u - left));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 16 <= size; i += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));" << endl;
+    ctx_ << "__m128i high = _mm_and_si128(_mm_sll_epi16(x, left_count), high_mask);" << endl;
+    ctx_ << "__m128i low = _mm_and_si128(_mm_srl_epi16(x, right_count), low_mask);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), _mm_or_si128(high, low));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "scalar::rotl_bytes(bytes + i, size - i, left);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline size_t ascii16(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 8 <= units; i += 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));" << endl;
+    ctx_ << "if (big_endian) v = swap16(v);" << endl;
+    ctx_ << "__m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));" << endl;
+    ctx_ << "if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) break;" << endl;
+    ctx_ << "_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(v, v));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline size_t ascii32(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 4 <= units; i += 4) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));" << endl;
+    ctx_ << "if (big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "v = swap16(v);" << endl;
+    ctx_ << "v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "__m128i high = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFF80u)));" << endl;
+    ctx_ << "if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF) break;" << endl;
+    ctx_ << "int32_t four = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(v, v), _mm_setzero_si128()));" << endl;
+    ctx_ << "std::memcpy(out + i, &four, 4);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Lane operations of the in-register prefix sums, per word width" << endl;
+    ctx_ << "template<size_t N> struct DeltaLanes;" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct DeltaLanes<4> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i splat(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i zigzag(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi32(1)));" << endl;
+    ctx_ << "return _mm_xor_si128(_mm_srli_epi32(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i bswap(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return _mm_shufflehi_epi16(_mm_shufflelo_epi16(swap16(x), 0xB1), 0xB1);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the four lanes" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i scan(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm_add_epi32(x, _mm_slli_si128(x, 4));" << endl;
+    ctx_ << "return _mm_add_epi32(x, _mm_slli_si128(x, 8));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i broadcast_last(__m128i x) { return _mm_shuffle_epi32(x, 0xFF); }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct DeltaLanes<8> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i splat(uint64_t v) { return _mm_set1_epi64x(static_cast<long long>(v)); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi64(a, b); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i zigzag(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi64x(1)));" << endl;
+    ctx_ << "return _mm_xor_si128(_mm_srli_epi64(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i bswap(__m128i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return _mm_shufflehi_epi16(_mm_shufflelo_epi16(swap16(x), 0x1B), 0x1B);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the two lanes" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i scan(__m128i x) { return _mm_add_epi64(x, _mm_slli_si128(x, 8)); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\") static __m128i broadcast_last(__m128i x) { return _mm_shuffle_epi32(x, 0xEE); }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Whole 16-byte blocks with the running sums kept in registers, then the scalar tail" << endl;
+    ctx_ << "struct DeltaRun {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "template<typename W, bool Swap, bool Zigzag, bool Twice>" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "static void run(const uint8_t* src, uint8_t* dst, size_t count, W& value, W& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using L = DeltaLanes<sizeof(W)>;" << endl;
+    ctx_ << "constexpr size_t lanes = 16 / sizeof(W);" << endl;
+    ctx_ << "__m128i acc = L::splat(value);" << endl;
+    ctx_ << "__m128i acc_delta = L::splat(delta);" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + lanes <= count; i += lanes) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(W)));" << endl;
+    ctx_ << "if constexpr (Swap) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::bswap(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Zigzag) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::zigzag(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Twice) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::add(L::scan(x), acc_delta);" << endl;
+    ctx_ << "acc_delta = L::broadcast_last(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "x = L::add(L::scan(x), acc);" << endl;
+    ctx_ << "acc = L::broadcast_last(x);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * sizeof(W)), x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "W carry[lanes];" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(carry), acc);" << endl;
+    ctx_ << "value = carry[0];" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(carry), acc_delta);" << endl;
+    ctx_ << "delta = carry[0];" << endl;
+    ctx_ << "scalar::DeltaRun::run<W, Swap, Zigzag, Twice>(src + i * sizeof(W), dst + i * sizeof(W), count - i, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void delta32(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint32_t& value, uint32_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse2\")" << endl;
+    ctx_ << "inline void delta64(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint64_t& value, uint64_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace sse2" << endl;
+    ctx_ << blank;
+    ctx_ << "namespace sse42 {" << endl;
+    ctx_ << blank;
+    ctx_ << "// pshufb (SSSE3, implied by SSE4.2) reverses the bytes of each word in one step" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"sse4.2\")" << endl;
+    ctx_ << "inline void byteswap(uint8_t* dst, const uint8_t* src, size_t bytes, __m128i order) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 16 <= bytes; i += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(x, order));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse4.2\")" << endl;
+    ctx_ << "inline void byteswap16(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 8 * 8;" << endl;
+    ctx_ << "byteswap(dst, src, 2 * vector, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));" << endl;
+    ctx_ << "scalar::byteswap16(dst + 2 * vector, src + 2 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse4.2\")" << endl;
+    ctx_ << "inline void byteswap32(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 4 * 4;" << endl;
+    ctx_ << "byteswap(dst, src, 4 * vector, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));" << endl;
+    ctx_ << "scalar::byteswap32(dst + 4 * vector, src + 4 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"sse4.2\")" << endl;
+    ctx_ << "inline void byteswap64(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 2 * 2;" << endl;
+    ctx_ << "byteswap(dst, src, 8 * vector, _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));" << endl;
+    ctx_ << "scalar::byteswap64(dst + 8 * vector, src + 8 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace sse42" << endl;
+    ctx_ << blank;
+    ctx_ << "namespace avx2 {" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void byteswap(uint8_t* dst, const uint8_t* src, size_t bytes, __m256i order) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 32 <= bytes; i += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(x, order));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void byteswap16(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 16 * 16;" << endl;
+    ctx_ << "byteswap(dst, src, 2 * vector, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14," << endl;
+    ctx_ << "                                                1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));" << endl;
+    ctx_ << "sse42::byteswap16(dst + 2 * vector, src + 2 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void byteswap32(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 8 * 8;" << endl;
+    ctx_ << "byteswap(dst, src, 4 * vector, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12," << endl;
+    ctx_ << "                                                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));" << endl;
+    ctx_ << "sse42::byteswap32(dst + 4 * vector, src + 4 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void byteswap64(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 4 * 4;" << endl;
+    ctx_ << "byteswap(dst, src, 8 * vector, _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8," << endl;
+    ctx_ << "                                                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));" << endl;
+    ctx_ << "sse42::byteswap64(dst + 8 * vector, src + 8 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero8(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i zero = _mm256_setzero_si256();" << endl;
+    ctx_ << "for (; end - p >= 32; p += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return sse2::find_zero8(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero16(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i zero = _mm256_setzero_si256();" << endl;
+    ctx_ << "for (; end - p >= 32; p += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return sse2::find_zero16(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero32(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i zero = _mm256_setzero_si256();" << endl;
+    ctx_ << "for (; end - p >= 32; p += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));" << endl;
+    ctx_ << "unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, zero)));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(mask);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return sse2::find_zero32(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void xor_bytes(uint8_t* bytes, size_t size, uint8_t key) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i k = _mm256_set1_epi8(static_cast<char>(key));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 32 <= size; i += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + i), _mm256_xor_si256(x, k));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "sse2::xor_bytes(bytes + i, size - i, key);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void rotl_bytes(uint8_t* bytes, size_t size, unsigned left) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i high_mask = _mm256_set1_epi8(static_cast<char>((0xFFu << left) & 0xFFu));" << endl;
+    ctx_ << "const __m256i low_mask = _mm256_set1_epi8(static_cast<char>(0xFFu >> (8u - left)));" << endl;
+    ctx_ << "const __m128i left_count = _mm_cvtsi32_si128(static_cast<int>(left));" << endl;
+    ctx_ << "const __m128i right_count = _mm_cvtsi32_si128(static_cast<int>(8u - left));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 32 <= size; i += 32) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));" << endl;
+    ctx_ << "__m256i high = _mm256_and_si256(_mm256_sll_epi16(x, left_count), high_mask);" << endl;
+    ctx_ << "__m256i low = _mm256_and_si256(_mm256_srl_epi16(x, right_count), low_mask);" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + i), _mm256_or_si256(high, low));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "sse2::rotl_bytes(bytes + i, size - i, left);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline size_t ascii16(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i order = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14," << endl;
+    ctx_ << "                                       1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);" << endl;
+    ctx_ << "const __m256i non_ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 16 <= units; i += 16) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));" << endl;
+    ctx_ << "if (big_endian) v = _mm256_shuffle_epi8(v, order);" << endl;
+    ctx_ << "if (!_mm256_testz_si256(v, non_ascii)) break;" << endl;
+    ctx_ << "// packus works per 128-bit lane; gather the two low halves" << endl;
+    ctx_ << "__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);" << endl;
+    ctx_ << "_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i + sse2::ascii16(src + 2 * i, units - i, out + i, big_endian);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline size_t ascii32(const uint8_t* src, size_t units, char* out, bool big_endian) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m256i order = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12," << endl;
+    ctx_ << "                                       3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);" << endl;
+    ctx_ << "const __m256i non_ascii = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80u));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 8 <= units; i += 8) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));" << endl;
+    ctx_ << "if (big_endian) v = _mm256_shuffle_epi8(v, order);" << endl;
+    ctx_ << "if (!_mm256_testz_si256(v, non_ascii)) break;" << endl;
+    ctx_ << "__m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(v, v), v);" << endl;
+    ctx_ << "int32_t low = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));" << endl;
+    ctx_ << "int32_t high = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));" << endl;
+    ctx_ << "std::memcpy(out + i, &low, 4);" << endl;
+    ctx_ << "std::memcpy(out + i + 4, &high, 4);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return i + sse2::ascii32(src + 4 * i, units - i, out + i, big_endian);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Prefix sums run within each 128-bit half first; the low half's total is" << endl;
+    ctx_ << "// then carried into the high half" << endl;
+    ctx_ << "template<size_t N> struct DeltaLanes;" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct DeltaLanes<4> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i splat(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i zigzag(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i sign = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(x, _mm256_set1_epi32(1)));" << endl;
+    ctx_ << "return _mm256_xor_si256(_mm256_srli_epi32(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i bswap(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12," << endl;
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_ << "3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));" << endl;
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the eight lanes" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i scan(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));" << endl;
+    ctx_ << "x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));" << endl;
+    ctx_ << "__m256i half_total = _mm256_shuffle_epi32(x, 0xFF);" << endl;
+    ctx_ << "return _mm256_add_epi32(x, _mm256_permute2x128_si256(half_total, half_total, 0x08));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i broadcast_last(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return _mm256_permute4x64_epi64(_mm256_shuffle_epi32(x, 0xFF), 0xFF);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "template<> struct DeltaLanes<8> {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i splat(uint64_t v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i zigzag(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i sign = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(x, _mm256_set1_epi64x(1)));" << endl;
+    ctx_ << "return _mm256_xor_si256(_mm256_srli_epi64(x, 1), sign);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i bswap(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return _mm256_shuffle_epi8(x, _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8," << endl;
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_.writer().indent();
+    ctx_ << "7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));" << endl;
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "// Inclusive prefix sum across the four lanes" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i scan(__m256i x) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));" << endl;
+    ctx_ << "__m256i half_total = _mm256_shuffle_epi32(x, 0xEE);" << endl;
+    ctx_ << "return _mm256_add_epi64(x, _mm256_permute2x128_si256(half_total, half_total, 0x08));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\") static __m256i broadcast_last(__m256i x) { return _mm256_permute4x64_epi64(x, 0xFF); }" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "// Whole 32-byte blocks, then the SSE2 kernel for the tail" << endl;
+    ctx_ << "struct DeltaRun {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "template<typename W, bool Swap, bool Zigzag, bool Twice>" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "static void run(const uint8_t* src, uint8_t* dst, size_t count, W& value, W& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "using L = DeltaLanes<sizeof(W)>;" << endl;
+    ctx_ << "constexpr size_t lanes = 32 / sizeof(W);" << endl;
+    ctx_ << "__m256i acc = L::splat(value);" << endl;
+    ctx_ << "__m256i acc_delta = L::splat(delta);" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + lanes <= count; i += lanes) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * sizeof(W)));" << endl;
+    ctx_ << "if constexpr (Swap) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::bswap(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Zigzag) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::zigzag(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "if constexpr (Twice) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "x = L::add(L::scan(x), acc_delta);" << endl;
+    ctx_ << "acc_delta = L::broadcast_last(x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "x = L::add(L::scan(x), acc);" << endl;
+    ctx_ << "acc = L::broadcast_last(x);" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * sizeof(W)), x);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "W carry[lanes];" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(carry), acc);" << endl;
+    ctx_ << "value = carry[0];" << endl;
+    ctx_ << "_mm256_storeu_si256(reinterpret_cast<__m256i*>(carry), acc_delta);" << endl;
+    ctx_ << "delta = carry[0];" << endl;
+    ctx_ << "sse2::DeltaRun::run<W, Swap, Zigzag, Twice>(src + i * sizeof(W), dst + i * sizeof(W), count - i, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "};" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void delta32(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint32_t& value, uint32_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx2\")" << endl;
+    ctx_ << "inline void delta64(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint64_t& value, uint64_t& delta) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "run_delta<DeltaRun>(src, dst, count, mode, value, delta);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace avx2" << endl;
+    ctx_ << blank;
+    ctx_ << "namespace avx512 {" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void byteswap(uint8_t* dst, const uint8_t* src, size_t bytes, __m512i order) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 64 <= bytes; i += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m512i x = _mm512_loadu_si512(src + i);" << endl;
+    ctx_ << "_mm512_storeu_si512(dst + i, _mm512_shuffle_epi8(x, order));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "// Byte order within each 16-byte lane, repeated for the four lanes" << endl;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline __m512i lane_order(uint64_t low, uint64_t high) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const long long l = static_cast<long long>(low);" << endl;
+    ctx_ << "const long long h = static_cast<long long>(high);" << endl;
+    ctx_ << "return _mm512_set_epi64(h, l, h, l, h, l, h, l);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void byteswap16(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 32 * 32;" << endl;
+    ctx_ << "byteswap(dst, src, 2 * vector, lane_order(0x0607040502030001ull, 0x0E0F0C0D0A0B0809ull));" << endl;
+    ctx_ << "avx2::byteswap16(dst + 2 * vector, src + 2 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void byteswap32(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 16 * 16;" << endl;
+    ctx_ << "byteswap(dst, src, 4 * vector, lane_order(0x0405060700010203ull, 0x0C0D0E0F08090A0Bull));" << endl;
+    ctx_ << "avx2::byteswap32(dst + 4 * vector, src + 4 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void byteswap64(uint8_t* dst, const uint8_t* src, size_t count) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const size_t vector = count / 8 * 8;" << endl;
+    ctx_ << "byteswap(dst, src, 8 * vector, lane_order(0x0001020304050607ull, 0x08090A0B0C0D0E0Full));" << endl;
+    ctx_ << "avx2::byteswap64(dst + 8 * vector, src + 8 * vector, count - vector);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero8(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (; end - p >= 64; p += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__mmask64 mask = _mm512_testn_epi8_mask(_mm512_loadu_si512(p), _mm512_set1_epi8(-1));" << endl;
+    ctx_ << "if (mask != 0) return p + std::countr_zero(static_cast<uint64_t>(mask));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return avx2::find_zero8(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero16(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (; end - p >= 64; p += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__mmask32 mask = _mm512_testn_epi16_mask(_mm512_loadu_si512(p), _mm512_set1_epi16(-1));" << endl;
+    ctx_ << "if (mask != 0) return p + 2 * std::countr_zero(static_cast<uint32_t>(mask));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return avx2::find_zero16(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline const uint8_t* find_zero32(const uint8_t* p, const uint8_t* end) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "for (; end - p >= 64; p += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__mmask16 mask = _mm512_testn_epi32_mask(_mm512_loadu_si512(p), _mm512_set1_epi32(-1));" << endl;
+    ctx_ << "if (mask != 0) return p + 4 * std::countr_zero(static_cast<uint32_t>(mask));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "return avx2::find_zero32(p, end);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void xor_bytes(uint8_t* bytes, size_t size, uint8_t key) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m512i k = _mm512_set1_epi8(static_cast<char>(key));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 64 <= size; i += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "_mm512_storeu_si512(bytes + i, _mm512_xor_si512(_mm512_loadu_si512(bytes + i), k));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "avx2::xor_bytes(bytes + i, size - i, key);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "DATASCRIPT_TARGET(\"avx512f,avx512bw\")" << endl;
+    ctx_ << "inline void rotl_bytes(uint8_t* bytes, size_t size, unsigned left) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "const __m512i high_mask = _mm512_set1_epi8(static_cast<char>((0xFFu << left) & 0xFFu));" << endl;
+    ctx_ << "const __m512i low_mask = _mm512_set1_epi8(static_cast<char>(0xFFu >> (8u - left)));" << endl;
+    ctx_ << "const __m128i left_count = _mm_cvtsi32_si128(static_cast<int>(left));" << endl;
+    ctx_ << "const __m128i right_count = _mm_cvtsi32_si128(static_cast<int>(8u - left));" << endl;
+    ctx_ << "size_t i = 0;" << endl;
+    ctx_ << "for (; i + 64 <= size; i += 64) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "__m512i x = _mm512_loadu_si512(bytes + i);" << endl;
+    ctx_ << "__m512i high = _mm512_and_si512(_mm512_sll_epi16(x, left_count), high_mask);" << endl;
+    ctx_ << "__m512i low = _mm512_and_si512(_mm512_srl_epi16(x, right_count), low_mask);" << endl;
+    ctx_ << "_mm512_storeu_si512(bytes + i, _mm512_or_si512(high, low));" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "avx2::rotl_bytes(bytes + i, size - i, left);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+    ctx_ << "}  // namespace avx512" << endl;
+    ctx_ << "#endif" << endl;
+}
+
+void CppHelperGenerator::generate_conditional_storage_includes(bool out_of_line, bool wide_masks) {
+    if (out_of_line) {
+        ctx_ << "#include <memory>" << endl;
+        ctx_ << "#include <optional>" << endl;
+    }
+    if (wide_masks) {
+        ctx_ << "#include <bitset>" << endl;
+    }
+}
+
+void CppHelperGenerator::generate_boxed() {
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Out-of-line Conditional Fields" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    ctx_ << "// Heap-allocated value with value semantics: copies are deep, an empty box" << endl;
+    ctx_ << "// is one null pointer. Holds large conditional fields, so records where" << endl;
+    ctx_ << "// they are absent stay small" << endl;
+    ctx_ << "template<typename T>" << endl;
+    ctx_.start_class("Boxed");
+    ctx_ << "public:" << endl;
+    ctx_ << "Boxed() = default;" << endl;
+    ctx_ << "Boxed(const Boxed& other) : value_(other.value_ ? std::make_unique<T>(*other.value_) : nullptr) {}" << endl;
+    ctx_ << "Boxed(Boxed&& other) noexcept = default;" << endl;
+    ctx_ << blank;
+    ctx_ << "Boxed& operator=(const Boxed& other) {" << endl;
+    ctx_.writer().indent();
+    ctx_.start_if("this != &other");
+    ctx_ << "value_ = other.value_ ? std::make_unique<T>(*other.value_) : nullptr;" << endl;
+    ctx_.end_if();
+    ctx_ << "return *this;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "Boxed& operator=(Boxed&& other) noexcept = default;" << endl;
+    ctx_ << blank;
+    ctx_ << "// Replace the value with a default-constructed one" << endl;
+    ctx_ << "T& emplace() {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "value_ = std::make_unique<T>();" << endl;
+    ctx_ << "return *value_;" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << "void reset() noexcept { value_.reset(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "bool has_value() const noexcept { return value_ != nullptr; }" << endl;
+    ctx_ << "explicit operator bool() const noexcept { return value_ != nullptr; }" << endl;
+    ctx_ << blank;
+    ctx_ << "T& operator*() { return *value_; }" << endl;
+    ctx_ << "const T& operator*() const { return *value_; }" << endl;
+    ctx_ << "T* operator->() { return value_.get(); }" << endl;
+    ctx_ << "const T* operator->() const { return value_.get(); }" << endl;
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "std::unique_ptr<T> value_;" << endl;
+    ctx_.end_class();
+    ctx_ << blank;
+}
+
 }  // namespace datascript::codegen
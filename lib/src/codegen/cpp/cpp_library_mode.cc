@@ -10,9 +10,11 @@
 #include <datascript/codegen/cpp/cpp_library_mode.hh>
 #include <datascript/codegen/cpp/cpp_renderer.hh>
 #include <datascript/codegen/cpp/cpp_helper_generator.hh>
+#include <datascript/codegen/cpp/cpp_visitor.hh>
 #include <datascript/codegen/cpp/cpp_writer_context.hh>
 #include <datascript/codegen/cpp/cpp_string_utils.hh>
 #include <datascript/command_builder.hh>
+#include <datascript/codegen/projection.hh>
 #include <datascript/codegen.hh>
 #include <sstream>
 #include <algorithm>
@@ -49,7 +51,7 @@ std::vector<OutputFile> CppLibraryModeGenerator::generate(
     LibraryFiles files = get_filenames(bundle, output_dir);
 
     // Generate all three headers
-    std::string runtime_content = generate_runtime_header(namespace_name, files);
+    std::string runtime_content = generate_runtime_header(bundle, namespace_name, files);
     std::string public_content = generate_public_header(bundle, namespace_name, files);
     std::string impl_content = generate_impl_header(bundle, namespace_name, files);
 
@@ -123,6 +125,7 @@ CppLibraryModeGenerator::LibraryFiles CppLibraryModeGenerator::get_filenames(
 }
 
 std::string CppLibraryModeGenerator::generate_runtime_header(
+    const ir::bundle& bundle,
     const std::string& namespace_name,
     [[maybe_unused]] const LibraryFiles& files) const
 {
@@ -136,8 +139,64 @@ std::string CppLibraryModeGenerator::generate_runtime_header(
     // Write includes
     ctx.write_include("cstdint", true);
     ctx.write_include("cstddef", true);
+    ctx.write_include("cstring", true);
     ctx.write_include("stdexcept", true);
     ctx.write_include("string", true);
+    if (renderer_.is_decode_cache_enabled()) {
+        ctx.write_include("atomic", true);
+        ctx.write_include("list", true);
+        ctx.write_include("memory", true);
+        ctx.write_include("mutex", true);
+        ctx.write_include("unordered_map", true);
+        ctx.write_include("vector", true);
+    }
+    CppHelperGenerator helper_gen(ctx, cpp_options::exceptions_only);
+    if (renderer_.is_bulk_ingest_enabled()) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_bulk_ingest_includes();
+    }
+    if (renderer_.is_snapshot_enabled()) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_snapshot_includes();
+    }
+    if (renderer_.is_incremental_enabled()) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_incremental_includes();
+    }
+    if (renderer_.is_padded_input_enabled()) {
+        helper_gen.generate_padded_input_includes();
+    }
+    if (renderer_.is_cpu_dispatch_enabled()) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_cpu_dispatch_includes();
+    }
+    PresencePlan presence = PresencePlan::build(bundle, renderer_.get_conditional_storage());
+    if (presence.has_out_of_line() || presence.widest_mask() > 64) {
+        helper_gen.generate_conditional_storage_includes(presence.has_out_of_line(), presence.widest_mask() > 64);
+    }
+    if (renderer_.is_visitor_enabled()) {
+        helper_gen.generate_visitor_includes();
+    }
+    if (renderer_.is_utf8_strings_enabled()) {
+        helper_gen.generate_utf8_strings_includes();
+    }
+    if (CppRenderer::has_array_transforms(bundle)) {
+        helper_gen.generate_array_transforms_includes();
+    }
+    if (CppRenderer::has_substreams(bundle)) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_substreams_includes(CppRenderer::has_substreams(bundle, true));
+    }
+    if (renderer_.is_batch_decode_enabled()) {
+        helper_gen.generate_batch_decode_includes();
+    }
+    if (!renderer_.get_record_index_structs().empty()) {
+        helper_gen.generate_record_index_includes();
+    }
+    if (!renderer_.get_parallel_decode_structs().empty()) {
+        ctx.write_include("vector", true);
+        helper_gen.generate_parallel_decode_includes();
+    }
     ctx.write_blank_line();
 
     // Start namespace
@@ -145,8 +204,51 @@ std::string CppLibraryModeGenerator::generate_runtime_header(
     ctx.write_blank_line();
 
     // Generate exception classes and binary helpers using CppHelperGenerator
-    CppHelperGenerator helper_gen(ctx, cpp_options::exceptions_only);
+    helper_gen.set_padded_input(renderer_.is_padded_input_enabled());
+    helper_gen.set_cpu_dispatch(renderer_.is_cpu_dispatch_enabled());
+    helper_gen.set_substream_max_inflate(renderer_.get_substream_max_inflate());
     helper_gen.generate_all();
+    if (presence.storage() == conditional_storage::boxed && presence.has_out_of_line()) {
+        helper_gen.generate_boxed();
+    }
+    if (renderer_.is_decode_cache_enabled()) {
+        helper_gen.generate_decode_cache();
+    }
+    if (renderer_.is_bulk_ingest_enabled()) {
+        helper_gen.generate_bulk_ingest();
+    }
+    if (renderer_.is_snapshot_enabled()) {
+        helper_gen.generate_snapshot();
+    }
+    if (renderer_.is_incremental_enabled()) {
+        helper_gen.generate_incremental();
+    }
+    if (renderer_.is_utf8_strings_enabled()) {
+        helper_gen.generate_utf8_strings();
+    }
+    if (CppRenderer::has_array_transforms(bundle)) {
+        helper_gen.generate_array_transforms();
+    }
+    if (CppRenderer::has_substreams(bundle)) {
+        helper_gen.generate_substreams(CppRenderer::has_substreams(bundle, true));
+    }
+    if (renderer_.is_visitor_enabled() ||
+        !ProjectionPlan::build(bundle, renderer_.get_projection_spec()).empty() ||
+        !renderer_.get_boundary_structs(bundle).empty()) {
+        helper_gen.generate_projection_skippers();
+    }
+    if (renderer_.is_batch_decode_enabled()) {
+        helper_gen.generate_batch_decode();
+    }
+    if (!renderer_.get_record_index_structs().empty()) {
+        helper_gen.generate_record_index();
+    }
+    if (!renderer_.get_parallel_decode_structs().empty()) {
+        helper_gen.generate_parallel_decode();
+    }
+    if (renderer_.is_visitor_enabled()) {
+        helper_gen.generate_visitor();
+    }
 
     ctx.write_blank_line();
 
@@ -175,6 +277,15 @@ std::string CppLibraryModeGenerator::generate_public_header(
     ctx.write_include("vector", true);
     ctx.write_include("variant", true);
     ctx.write_include("string", true);
+    if (renderer_.is_decode_cache_enabled()) {
+        ctx.write_include("atomic", true);
+        ctx.write_include("cstring", true);
+        ctx.write_include("list", true);
+        ctx.write_include("memory", true);
+        ctx.write_include("mutex", true);
+        ctx.write_include("unordered_map", true);
+        ctx.write_include("vector", true);
+    }
     ctx.write_blank_line();
 
     // Start namespace
@@ -378,6 +489,13 @@ std::string CppLibraryModeGenerator::generate_impl_header(
     // This is needed for choice field reading (external discriminators)
     builder.set_choices(&bundle.choices);
     builder.set_constraints(&bundle.constraints);
+    ProjectionPlan projections = ProjectionPlan::build(bundle, renderer_.get_projection_spec());
+    ProjectionPlan scanners = ProjectionPlan::build(bundle, "", renderer_.get_boundary_structs(bundle));
+    builder.set_projections(&projections);
+    builder.set_boundary_scanners(&scanners);
+    builder.set_batch_readers(renderer_.is_batch_decode_enabled());
+    PresencePlan presence = PresencePlan::build(bundle, renderer_.get_conditional_storage());
+    builder.set_presence(&presence);
 
     cpp_options opts;
     opts.error_handling = cpp_options::exceptions_only;
@@ -415,11 +533,16 @@ std::string CppLibraryModeGenerator::generate_impl_header(
     output << "// Parse Functions\n";
     output << "// ============================================================================\n\n";
 
+    const bool padded = renderer_.is_padded_input_enabled();
     for (const auto& struct_def : bundle.structs) {
         // Pointer + length overload
         output << "/**\n";
         output << " * Parse " << struct_def.name << " from binary data.\n";
-        output << " * @param data Pointer to binary data\n";
+        if (padded) {
+            output << " * @param data Pointer to binary data, followed by input_padding readable bytes\n";
+        } else {
+            output << " * @param data Pointer to binary data\n";
+        }
         output << " * @param len Length of data in bytes\n";
         output << " * @return Parsed " << struct_def.name << " object\n";
         output << " * @throws UnexpectedEOF if data is too short\n";
@@ -440,7 +563,12 @@ std::string CppLibraryModeGenerator::generate_impl_header(
         output << " */\n";
         output << "inline " << struct_def.name << " parse_" << struct_def.name
                << "(const std::vector<uint8_t>& data) {\n";
-        output << "    return parse_" << struct_def.name << "(data.data(), data.size());\n";
+        if (padded) {
+            // Unpadded storage: decode from a padded copy
+            output << "    return " << struct_def.name << "::read(PaddedBuffer::copy_of(data));\n";
+        } else {
+            output << "    return parse_" << struct_def.name << "(data.data(), data.size());\n";
+        }
         output << "}\n\n";
 
         // std::span overload (C++20)
@@ -452,8 +580,56 @@ std::string CppLibraryModeGenerator::generate_impl_header(
         output << " */\n";
         output << "inline " << struct_def.name << " parse_" << struct_def.name
                << "(std::span<const uint8_t> data) {\n";
-        output << "    return parse_" << struct_def.name << "(data.data(), data.size());\n";
+        if (padded) {
+            output << "    return " << struct_def.name << "::read(PaddedBuffer::copy_of(data));\n";
+        } else {
+            output << "    return parse_" << struct_def.name << "(data.data(), data.size());\n";
+        }
         output << "}\n\n";
+
+        // PaddedBuffer overload (no copy, no per-field bounds checks)
+        if (padded) {
+            output << "/**\n";
+            output << " * Parse " << struct_def.name << " from a padded buffer.\n";
+            output << " * @param data Padded input\n";
+            output << " * @return Parsed " << struct_def.name << " object\n";
+            output << " * @throws UnexpectedEOF if data is too short\n";
+            output << " */\n";
+            output << "inline " << struct_def.name << " parse_" << struct_def.name
+                   << "(const PaddedBuffer& data) {\n";
+            output << "    return " << struct_def.name << "::read(data);\n";
+            output << "}\n\n";
+        }
+
+        // Bulk ingestion over many files
+        if (renderer_.is_bulk_ingest_enabled()) {
+            output << "/**\n";
+            output << " * Parse every file in paths as " << struct_def.name << " on a worker pool.\n";
+            output << " * @param paths Files to read (each file holds one " << struct_def.name << ")\n";
+            output << " * @param on_record Called as on_record(index, " << struct_def.name
+                   << "&&) from worker threads\n";
+            output << " * @param options Queue depth, buffer size, worker count, backend\n";
+            output << " * @return Counters; files that fail to read or parse are counted, not thrown\n";
+            output << " */\n";
+            output << "template<typename Fn>\n";
+            output << "inline BulkIngestStats ingest_" << struct_def.name
+                   << "(const std::vector<std::string>& paths, Fn&& on_record, "
+                   << "BulkIngestOptions options = {}) {\n";
+            output << "    return bulk_ingest<" << struct_def.name
+                   << ">(paths, std::forward<Fn>(on_record), options);\n";
+            output << "}\n\n";
+        }
+    }
+
+    // ========================================================================
+    // Visitor Parse Functions (event-driven, no structs built)
+    // ========================================================================
+    if (renderer_.is_visitor_enabled()) {
+        std::ostringstream visitor_output;
+        CppWriterContext visitor_ctx(visitor_output);
+        CppVisitorGenerator visitor_gen(renderer_, visitor_ctx);
+        visitor_gen.generate(bundle, namespace_name);
+        output << "\n" << visitor_output.str();
     }
 
     // ========================================================================
@@ -496,7 +672,7 @@ std::string CppLibraryModeGenerator::generate_impl_header(
 
     // Generate metadata for each struct
     for (const auto& struct_def : bundle.structs) {
-        generate_struct_metadata(output, struct_def, namespace_name);
+        generate_struct_metadata(output, struct_def, namespace_name, presence.find(struct_def.name));
     }
 
     output << "} // namespace introspection\n\n";
@@ -690,7 +866,8 @@ std::string CppLibraryModeGenerator::generate_impl_header(
 void CppLibraryModeGenerator::generate_struct_metadata(
     std::ostream& out,
     const ir::struct_def& struct_def,
-    const std::string& namespace_name) const
+    const std::string& namespace_name,
+    const struct_presence* presence) const
 {
     std::string struct_name = struct_def.name;
 
@@ -707,7 +884,19 @@ void CppLibraryModeGenerator::generate_struct_metadata(
         bool is_primitive = (field.type.kind >= ir::type_kind::uint8 && field.type.kind <= ir::type_kind::int128);
         std::string field_access = "s->" + field.name;
 
-        if (is_primitive) {
+        // Out-of-line conditional fields are formatted through the wrapper
+        const auto* member = presence ? presence->find(field.name) : nullptr;
+        if (member && member->out_of_line) {
+            out << "    if (!" << field_access << ") {\n";
+            out << "        return \"<absent>\";\n";
+            out << "    }\n";
+            field_access = "(*" + field_access + ")";
+        }
+
+        if (field.substream) {
+            // Show the raw region without forcing a decode
+            out << "    oss << \"<substream: \" << " << field_access << ".raw().size() << \" bytes>\";\n";
+        } else if (is_primitive) {
             // Format hex for types that look like offsets/addresses
             if (field.name.find("offset") != std::string::npos ||
                 field.name.find("address") != std::string::npos ||
@@ -716,6 +905,10 @@ void CppLibraryModeGenerator::generate_struct_metadata(
             } else {
                 out << "    oss << static_cast<uint64_t>(" << field_access << ");\n";
             }
+        } else if (field.type.kind == ir::type_kind::float32 ||
+                   field.type.kind == ir::type_kind::float64) {
+            // Floating-point values print as-is
+            out << "    oss << " << field_access << ";\n";
         } else if (field.type.kind == ir::type_kind::enum_type) {
             // For enums, show numeric value (to_string can be added later)
             out << "    oss << static_cast<int>(" << field_access << ");\n";
@@ -6,15 +6,43 @@
 
 #include <datascript/codegen/cpp/cpp_renderer.hh>
 #include <datascript/codegen/cpp/cpp_library_mode.hh>
+#include <datascript/codegen/cpp/cpp_freestanding.hh>
+#include <datascript/codegen/cpp/cpp_visitor.hh>
 #include <datascript/codegen/cpp/cpp_helper_generator.hh>
 #include <datascript/codegen/cpp/cpp_expression_renderer.hh>
 #include <datascript/codegen.hh>
 #include <datascript/command_builder.hh>
+#include <datascript/codegen/projection.hh>
 #include <sstream>
 #include <algorithm>
+#include <functional>
 
 namespace datascript::codegen {
 
+namespace {
+    // Parse "A, B,C" into struct names
+    std::vector<std::string> parse_struct_list(const std::string& text) {
+        std::vector<std::string> names;
+        std::istringstream input(text);
+        std::string name;
+        while (std::getline(input, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+
+    // string, u16string or u32string (their readers scan for a terminator)
+    bool is_string_type(const ir::type_ref* type) {
+        return type->kind == ir::type_kind::string ||
+               type->kind == ir::type_kind::u16_string ||
+               type->kind == ir::type_kind::u32_string;
+    }
+}  // namespace
+
 // ============================================================================
 // C++ Keywords - Static Member Definition
 // ============================================================================
@@ -78,6 +106,7 @@ void CppRenderer::set_module(const ir::bundle* mod) {
     module_ = mod;
     if (mod) {
         expr_context_.module_constants = &mod->constants;
+        presence_plan_ = PresencePlan::build(*mod, conditional_storage_);
     }
     // Clear type name cache when module changes (old pointers may be invalid)
     type_name_cache_.clear();
@@ -104,9 +133,42 @@ void CppRenderer::set_error_handling_mode(cpp_options::error_style mode) {
 
 std::string CppRenderer::render_module(const ir::bundle& bundle,
                                        const RenderOptions& options) {
+    // The freestanding profile has its own generator (no heap, no exceptions)
+    if (is_freestanding_profile()) {
+        CppFreestandingGenerator generator(*this);
+        return generator.render(bundle);
+    }
+
     // Convert generic RenderOptions to C++-specific options
     cpp_options cpp_opts;
 
+    // Visitor parse functions report errors the way read() does
+    if (generate_visitor_ && !options.use_exceptions) {
+        throw codegen_error("cpp-visitor requires exception error handling");
+    }
+
+    // Only exception-mode readers take part in the node table IncrementalDecoder drives
+    if (generate_incremental_ && !options.use_exceptions) {
+        throw codegen_error("cpp-incremental requires exception error handling");
+    }
+
+    // read_cached() wraps read(), which reports underflow by throwing
+    if (generate_decode_cache_ && !options.use_exceptions) {
+        throw codegen_error("cpp-decode-cache requires exception error handling");
+    }
+
+    // read_batch() drives read_into(), and the index scanner and parallel
+    // decoder hang off read(); results-only rendering emits none of them
+    if (generate_batch_decode_ && !options.use_exceptions) {
+        throw codegen_error("cpp-batch-decode requires exception error handling");
+    }
+    if (!record_index_structs_.empty() && !options.use_exceptions) {
+        throw codegen_error("cpp-record-index requires exception error handling");
+    }
+    if (!parallel_decode_structs_.empty() && !options.use_exceptions) {
+        throw codegen_error("cpp-parallel-decode requires exception error handling");
+    }
+
     // Map error handling mode
     if (options.use_exceptions) {
         cpp_opts.error_handling = cpp_options::exceptions_only;
@@ -137,10 +199,21 @@ std::string CppRenderer::render_module(const ir::bundle& bundle,
         namespace_name = result;
     }
 
-    auto commands = builder.build_module(bundle, namespace_name, cpp_opts, use_exceptions);
+    // Record indexes and parallel decoders find record boundaries with their own
+    // projected readers, which only decode what determines the record size
+    ProjectionPlan projections = ProjectionPlan::build(bundle, projection_spec_);
+    ProjectionPlan scanners = ProjectionPlan::build(bundle, "", get_boundary_structs(bundle));
+    builder.set_projections(&projections);
+    builder.set_boundary_scanners(&scanners);
+    has_projections_ = !projections.empty() || !scanners.empty();
+    builder.set_batch_readers(generate_batch_decode_);
 
     // Use THIS renderer (which has options set) instead of creating a new one
-    set_module(&bundle);  // Set module for type name resolution
+    set_module(&bundle);  // Set module for type name resolution (and plan presence tracking)
+    builder.set_presence(&presence_plan_);
+
+    auto commands = builder.build_module(bundle, namespace_name, cpp_opts, use_exceptions);
+
     set_error_handling_mode(cpp_opts.error_handling);  // Set error handling mode
     render_commands(commands);
 
@@ -209,6 +282,132 @@ std::vector<OptionDescription> CppRenderer::get_options() const {
             "Output mode: single-header (all-in-one) or library (separate public/impl headers)",
             "single-header",
             {"single-header", "library"}
+        },
+        {
+            "decode-cache",
+            OptionType::Bool,
+            "Generate read_cached() backed by a content-addressed decode cache per struct",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "decode-cache-capacity",
+            OptionType::Int,
+            "Maximum number of cached objects per struct type (with decode-cache)",
+            "1024",
+            {}  // choices (not applicable for Int)
+        },
+        {
+            "substream-max-inflate",
+            OptionType::Int,
+            "Largest inflated size in bytes of a @zlib substream; larger streams throw when decoded",
+            "67108864",
+            {}  // choices (not applicable for Int)
+        },
+        {
+            "bulk-ingest",
+            OptionType::Bool,
+            "Generate the bulk file ingestion driver (io_uring on Linux, pread thread pool elsewhere)",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "snapshot",
+            OptionType::Bool,
+            "Generate to_snapshot() / open_snapshot() for relocatable, zero-parse decoded snapshots",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "size-bounds",
+            OptionType::Bool,
+            "Emit min_wire_size / max_wire_size / max_heap_bytes constants in every struct, union and choice",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "padded-input",
+            OptionType::Bool,
+            "Readers require input_padding readable bytes past the end (PaddedBuffer) and load fixed-width fields without bounds checks",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "conditional-storage",
+            OptionType::Choice,
+            "Storage of large conditional fields: inline (plain member), optional (std::optional<T>) or boxed (Boxed<T>, heap-allocated only when present)",
+            "inline",
+            {"inline", "optional", "boxed"}
+        },
+        {
+            "cpu-dispatch",
+            OptionType::Bool,
+            "Compile the runtime's vector kernels for SSE2/SSE4.2/AVX2/AVX-512 and pick the best level at run time",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "visitor",
+            OptionType::Bool,
+            "Generate parse_<Type>(data, end, visitor) that reports fields to visitor hooks instead of building structs",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "incremental",
+            OptionType::Bool,
+            "Generate IncrementalDecoder<T> for re-decoding only the nodes touched by in-place edits",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "utf8-strings",
+            OptionType::Bool,
+            "Decode u16string/u32string fields to UTF-8 std::string (SIMD transcoding with validation)",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "batch-decode",
+            OptionType::Bool,
+            "Generate read_batch() that decodes many independent messages in prefetched groups into reused objects",
+            "false",
+            {}  // choices (not applicable for Bool)
+        },
+        {
+            "record-index",
+            OptionType::String,
+            "Generate build_index() / read_at() for buffers of back-to-back records of the listed structs, e.g. Event,LogEntry",
+            "",
+            {}  // choices (not applicable for String)
+        },
+        {
+            "parallel-decode",
+            OptionType::String,
+            "Generate read_all_parallel() for buffers of back-to-back records of the listed structs (boundary pass, then parallel decode)",
+            "",
+            {}  // choices (not applicable for String)
+        },
+        {
+            "project",
+            OptionType::String,
+            "Generate read_projected() that decodes only the listed fields, e.g. Order=id,customer.name;Item=sku",
+            "",
+            {}  // choices (not applicable for String)
+        },
+        {
+            "profile",
+            OptionType::Choice,
+            "Output profile: default (standard library, exceptions) or freestanding (no heap, no exceptions, status codes)",
+            "default",
+            {"default", "freestanding"}
+        },
+        {
+            "freestanding-capacity",
+            OptionType::Int,
+            "Largest array stored inline in the freestanding profile; longer arrays are views into the input",
+            "4096",
+            {}  // choices (not applicable for Int)
         }
     };
 }
@@ -225,6 +424,54 @@ void CppRenderer::set_option(const std::string& name, const OptionValue& value)
         generate_enum_to_string_ = std::get<bool>(value);
     } else if (name == "mode") {
         output_mode_ = std::get<std::string>(value);
+    } else if (name == "decode-cache") {
+        generate_decode_cache_ = std::get<bool>(value);
+    } else if (name == "decode-cache-capacity") {
+        int64_t capacity = std::get<int64_t>(value);
+        if (capacity < 0) {
+            throw std::invalid_argument("decode-cache-capacity must not be negative");
+        }
+        decode_cache_capacity_ = capacity;
+    } else if (name == "substream-max-inflate") {
+        int64_t bytes = std::get<int64_t>(value);
+        if (bytes < 0) {
+            throw std::invalid_argument("substream-max-inflate must not be negative");
+        }
+        substream_max_inflate_ = static_cast<uint64_t>(bytes);
+    } else if (name == "bulk-ingest") {
+        generate_bulk_ingest_ = std::get<bool>(value);
+    } else if (name == "snapshot") {
+        generate_snapshot_ = std::get<bool>(value);
+    } else if (name == "size-bounds") {
+        generate_size_bounds_ = std::get<bool>(value);
+    } else if (name == "padded-input") {
+        padded_input_ = std::get<bool>(value);
+    } else if (name == "conditional-storage") {
+        conditional_storage_ = parse_conditional_storage(std::get<std::string>(value));
+    } else if (name == "cpu-dispatch") {
+        cpu_dispatch_ = std::get<bool>(value);
+    } else if (name == "visitor") {
+        generate_visitor_ = std::get<bool>(value);
+    } else if (name == "incremental") {
+        generate_incremental_ = std::get<bool>(value);
+    } else if (name == "utf8-strings") {
+        utf8_strings_ = std::get<bool>(value);
+    } else if (name == "batch-decode") {
+        generate_batch_decode_ = std::get<bool>(value);
+    } else if (name == "record-index") {
+        record_index_structs_ = parse_struct_list(std::get<std::string>(value));
+    } else if (name == "parallel-decode") {
+        parallel_decode_structs_ = parse_struct_list(std::get<std::string>(value));
+    } else if (name == "project") {
+        projection_spec_ = std::get<std::string>(value);
+    } else if (name == "profile") {
+        profile_ = std::get<std::string>(value);
+    } else if (name == "freestanding-capacity") {
+        int64_t capacity = std::get<int64_t>(value);
+        if (capacity < 0) {
+            throw std::invalid_argument("freestanding-capacity must not be negative");
+        }
+        freestanding_capacity_ = capacity;
     } else {
         throw std::invalid_argument("Unknown cpp option: " + name);
     }
@@ -234,8 +481,8 @@ std::vector<OutputFile> CppRenderer::generate_files(
     const ir::bundle& bundle,
     const std::filesystem::path& output_dir)
 {
-    // Check if library mode is enabled
-    if (output_mode_ == "library") {
+    // Check if library mode is enabled (the freestanding profile is always one header)
+    if (output_mode_ == "library" && !is_freestanding_profile()) {
         return generate_library_mode(bundle, output_dir);
     } else {
         return generate_single_header_mode(bundle, output_dir);
@@ -438,12 +685,33 @@ void CppRenderer::render_command(const Command& cmd) {
         case Command::AlignPointer:
             render_align_pointer(static_cast<const AlignPointerCommand&>(cmd));
             break;
+        case Command::SkipField:
+            render_skip_field(static_cast<const SkipFieldCommand&>(cmd));
+            break;
+        case Command::ResetField:
+            render_reset_field(static_cast<const ResetFieldCommand&>(cmd));
+            break;
+        case Command::EmplaceField:
+            render_emplace_field(static_cast<const EmplaceFieldCommand&>(cmd));
+            break;
+        case Command::MarkPresent:
+            render_mark_present(static_cast<const MarkPresentCommand&>(cmd));
+            break;
+        case Command::ReadSubstream:
+            render_read_substream(static_cast<const ReadSubstreamCommand&>(cmd));
+            break;
         case Command::ResizeArray:
             render_resize_array(static_cast<const ResizeArrayCommand&>(cmd));
             break;
+        case Command::ReserveArray:
+            render_reserve_array(static_cast<const ReserveArrayCommand&>(cmd));
+            break;
         case Command::AppendToArray:
             render_append_to_array(static_cast<const AppendToArrayCommand&>(cmd));
             break;
+        case Command::ReadPrimitiveArray:
+            render_read_primitive_array(static_cast<const ReadPrimitiveArrayCommand&>(cmd));
+            break;
 
         case Command::StartLoop:
             render_start_loop(static_cast<const StartLoopCommand&>(cmd));
@@ -527,6 +795,10 @@ void CppRenderer::render_command(const Command& cmd) {
         case Command::ExtractBitfield:
             render_extract_bitfield(static_cast<const ExtractBitfieldCommand&>(cmd));
             break;
+
+        case Command::MemoizeCall:
+            render_memoize_call(static_cast<const MemoizeCallCommand&>(cmd));
+            break;
     }
 }
 
@@ -569,10 +841,71 @@ void CppRenderer::render_module_start(const ModuleStartCommand& cmd) {
     // Emit C++-specific includes
     ctx_ << "#include <array>" << endl;
     ctx_ << "#include <cstdint>" << endl;
+    ctx_ << "#include <cstring>" << endl;
     ctx_ << "#include <string>" << endl;
     ctx_ << "#include <vector>" << endl;
     ctx_ << "#include <variant>" << endl;  // For choice types
     ctx_ << "#include <stdexcept>" << endl;
+    if (generate_decode_cache_) {
+        ctx_ << "#include <atomic>" << endl;
+        ctx_ << "#include <list>" << endl;
+        ctx_ << "#include <memory>" << endl;
+        ctx_ << "#include <mutex>" << endl;
+        ctx_ << "#include <unordered_map>" << endl;
+    }
+    if (generate_bulk_ingest_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_bulk_ingest_includes();
+    }
+    if (generate_snapshot_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_snapshot_includes();
+    }
+    if (generate_incremental_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_incremental_includes();
+    }
+    if (padded_input_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_padded_input_includes();
+    }
+    if (cpu_dispatch_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_cpu_dispatch_includes();
+    }
+    if (presence_plan_.has_out_of_line() || presence_plan_.widest_mask() > 64) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_conditional_storage_includes(presence_plan_.has_out_of_line(),
+                                                         presence_plan_.widest_mask() > 64);
+    }
+    if (generate_visitor_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_visitor_includes();
+    }
+    if (utf8_strings_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_utf8_strings_includes();
+    }
+    if (module_ && has_array_transforms(*module_)) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_array_transforms_includes();
+    }
+    if (module_ && has_substreams(*module_)) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_substreams_includes(has_substreams(*module_, true));
+    }
+    if (generate_batch_decode_) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_batch_decode_includes();
+    }
+    if (!record_index_structs_.empty()) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_record_index_includes();
+    }
+    if (!parallel_decode_structs_.empty()) {
+        CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+        helper_gen.generate_parallel_decode_includes();
+    }
 }
 
 void CppRenderer::render_module_end(const ModuleEndCommand& cmd) {
@@ -589,7 +922,11 @@ void CppRenderer::render_namespace_start(const NamespaceStartCommand& cmd) {
 }
 
 void CppRenderer::render_namespace_end(const NamespaceEndCommand& cmd) {
-    (void)cmd;
+    // Visitor parse functions follow every type they can materialize
+    if (generate_visitor_ && module_) {
+        CppVisitorGenerator visitor_gen(*this, ctx_);
+        visitor_gen.generate(*module_, cmd.namespace_name);
+    }
     ctx_.end_namespace();
 }
 
@@ -806,9 +1143,63 @@ void CppRenderer::render_start_struct(const StartStructCommand& cmd) {
 
 void CppRenderer::render_end_struct(const EndStructCommand& cmd) {
     (void)cmd;
+    if (const auto* presence = presence_plan_.find(current_struct_name_)) {
+        emit_presence_members(*presence);
+    }
+    if (generate_decode_cache_ && current_struct_has_reader_ && module_) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_decode_cache_methods(*it);
+        }
+    }
+    if (generate_snapshot_ && module_) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_snapshot_methods(*it);
+        }
+    }
+    if (generate_batch_decode_ && current_struct_has_into_reader_ && module_) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_batch_decode_methods(*it);
+        }
+    }
+    if (current_struct_has_reader_ && module_ &&
+        std::find(record_index_structs_.begin(), record_index_structs_.end(), current_struct_name_) !=
+            record_index_structs_.end()) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_record_index_methods(*it);
+        }
+    }
+    if (current_struct_has_reader_ && module_ &&
+        std::find(parallel_decode_structs_.begin(), parallel_decode_structs_.end(), current_struct_name_) !=
+            parallel_decode_structs_.end()) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_parallel_decode_methods(*it);
+        }
+    }
+    if (padded_input_ && current_struct_has_reader_) {
+        emit_padded_read_method();
+    }
+    if (generate_size_bounds_ && module_) {
+        auto it = std::find_if(module_->structs.begin(), module_->structs.end(),
+            [&](const ir::struct_def& s) { return s.name == current_struct_name_; });
+        if (it != module_->structs.end()) {
+            emit_size_bounds(it->bounds);
+        }
+    }
     ctx_.end_struct();
     in_struct_ = false;
     current_struct_name_.clear();
+    current_struct_has_reader_ = false;
+    current_struct_has_into_reader_ = false;
 }
 
 void CppRenderer::render_declare_field(const DeclareFieldCommand& cmd) {
@@ -816,9 +1207,62 @@ void CppRenderer::render_declare_field(const DeclareFieldCommand& cmd) {
         ctx_ << "// " + cmd.doc_comment << endl;
     }
     std::string cpp_type = ir_type_to_cpp(cmd.field_type);
+    if (cmd.substream) {
+        cpp_type = "Substream<" + cpp_type + ">";  // Decoded on first get()
+    }
+    const auto* presence = presence_plan_.find(current_struct_name_);
+    const auto* member = presence ? presence->find(cmd.field_name) : nullptr;
+    if (member && member->out_of_line) {
+        // Holds a value only when the field was decoded
+        cpp_type = (presence_plan_.storage() == conditional_storage::boxed ? "Boxed<" : "std::optional<") +
+                   cpp_type + ">";
+    }
     ctx_ << cpp_type + " " + cmd.field_name + ";" << endl;
 }
 
+void CppRenderer::emit_presence_members(const struct_presence& presence) {
+    const std::string mask_type = presence_mask_type(presence.members.size());
+    const bool wide = presence.members.size() > 64;
+
+    ctx_ << blank;
+    ctx_ << "// Whether each conditional field was present in the input" << endl;
+    for (const auto& member : presence.members) {
+        const std::string bit = std::to_string(member.bit);
+        const std::string test = wide ? "presence_.test(" + bit + ")"
+                                      : "(presence_ >> " + bit + ") & 1u";
+        ctx_ << "bool " + member.accessor + "() const { return " + test + "; }" << endl;
+    }
+    ctx_ << blank;
+    ctx_ << "// Presence bits of the conditional fields, in declaration order" << endl;
+    ctx_ << mask_type + " presence_{};" << endl;
+}
+
+std::string CppRenderer::field_target(const std::string& field_name) const {
+    std::string target = expr_context_.object_name + "." + field_name;
+    return field_name == out_of_line_field_ ? "(*" + target + ")" : target;
+}
+
+void CppRenderer::emit_size_bounds(const std::optional<ir::size_bounds>& bounds) {
+    if (!bounds) {
+        return;  // Generated wrapper types have no schema definition
+    }
+    auto constant = [&](const std::string& name, const std::optional<size_t>& value) {
+        if (value) {
+            ctx_ << "static constexpr size_t " + name + " = " + std::to_string(*value) + ";" << endl;
+        } else {
+            ctx_ << "static constexpr size_t " + name + " = SIZE_MAX;  // unbounded" << endl;
+        }
+    };
+
+    ctx_ << blank;
+    ctx_ << "// Bytes one read() consumes at least / at most, and heap bytes it may allocate" << endl;
+    constant("min_wire_size", bounds->min_wire_size);
+    constant("max_wire_size", bounds->max_wire_size);
+    // Boxed members allocate on top of what the schema bound counts
+    constant("max_heap_bytes", presence_plan_.owns_boxes(current_struct_name_)
+                                   ? std::nullopt : bounds->max_heap_bytes);
+}
+
 // ============================================================================
 // Union Commands
 // ============================================================================
@@ -870,6 +1314,13 @@ void CppRenderer::render_start_union(const StartUnionCommand& cmd) {
 
 void CppRenderer::render_end_union(const EndUnionCommand& cmd) {
     (void)cmd;
+    if (generate_size_bounds_ && module_) {
+        auto it = std::find_if(module_->unions.begin(), module_->unions.end(),
+            [&](const ir::union_def& u) { return u.name == current_struct_name_; });
+        if (it != module_->unions.end()) {
+            emit_size_bounds(it->bounds);
+        }
+    }
     ctx_.end_struct();
     in_struct_ = false;
     current_struct_name_.clear();
@@ -920,6 +1371,13 @@ void CppRenderer::render_start_choice(const StartChoiceCommand& cmd) {
 
 void CppRenderer::render_end_choice(const EndChoiceCommand& cmd) {
     (void)cmd;
+    if (generate_size_bounds_ && module_) {
+        auto it = std::find_if(module_->choices.begin(), module_->choices.end(),
+            [&](const ir::choice_def& c) { return c.name == current_struct_name_; });
+        if (it != module_->choices.end()) {
+            emit_size_bounds(it->bounds);
+        }
+    }
     ctx_.end_struct();
     in_struct_ = false;
     current_struct_name_.clear();
@@ -985,10 +1443,20 @@ void CppRenderer::render_start_method(const StartMethodCommand& cmd) {
     // For union field readers, field references should use parent-> prefix
     expr_context_.use_parent_context = (cmd.kind == StartMethodCommand::MethodKind::UnionFieldReader);
 
+    if (cmd.kind == StartMethodCommand::MethodKind::StructReader && cmd.use_exceptions &&
+        !cmd.projected && !cmd.into_existing) {
+        current_struct_has_reader_ = true;
+    }
+    if (cmd.into_existing) {
+        current_struct_has_into_reader_ = true;
+    }
+
     // Save method context for proper return value formatting
     current_method_kind_ = cmd.kind;
     current_method_target_struct_ = cmd.target_struct;
     current_method_use_exceptions_ = cmd.use_exceptions;
+    current_method_projected_ = cmd.projected;
+    current_method_into_ = cmd.into_existing;
 
     ctx_ << blank;
 
@@ -1019,7 +1487,9 @@ void CppRenderer::render_start_method(const StartMethodCommand& cmd) {
     std::string return_type;
     switch (cmd.kind) {
         case StartMethodCommand::MethodKind::StructReader:
-            if (cmd.target_struct) {
+            if (cmd.into_existing) {
+                return_type = "void";  // Result is written to the caller's object
+            } else if (cmd.target_struct) {
                 return_type = cmd.use_exceptions
                     ? cmd.target_struct->name
                     : "ReadResult<" + cmd.target_struct->name + ">";
@@ -1078,6 +1548,9 @@ void CppRenderer::render_start_method(const StartMethodCommand& cmd) {
     switch (cmd.kind) {
         case StartMethodCommand::MethodKind::StructReader:
         case StartMethodCommand::MethodKind::StandaloneReader:
+            if (cmd.into_existing && cmd.target_struct) {
+                signature << cmd.target_struct->name << "& obj, ";
+            }
             signature << "const uint8_t*& data, const uint8_t* end";
             break;
         case StartMethodCommand::MethodKind::UnionReader:
@@ -1141,6 +1614,18 @@ void CppRenderer::render_start_method(const StartMethodCommand& cmd) {
     if (cmd.kind == StartMethodCommand::MethodKind::StructReader) {
         ctx_ << "const uint8_t* start = data;  // Save start for absolute label offsets" << endl;
     }
+
+    // Incremental decoding: reuse the previous node when its input is unchanged
+    // (projected objects are partial and read_into() objects are caller-owned,
+    // so neither enters the node table)
+    if (generate_incremental_ && cmd.kind == StartMethodCommand::MethodKind::StructReader &&
+        cmd.use_exceptions && !cmd.projected && !cmd.into_existing && cmd.target_struct) {
+        const std::string& name = cmd.target_struct->name;
+        ctx_ << "IncrementalFrame incremental_frame;" << endl;
+        ctx_.start_if("const " + name + "* reused = incremental_frame.reuse<" + name + ">(data, end)");
+        ctx_ << "return *reused;" << endl;
+        ctx_.end_if();
+    }
 }
 
 void CppRenderer::render_end_method(const EndMethodCommand& cmd) {
@@ -1149,11 +1634,14 @@ void CppRenderer::render_end_method(const EndMethodCommand& cmd) {
     ctx_ << "}" << endl;
     in_method_ = false;
     expr_context_.in_struct_method = false;
+    expr_context_.memoized_calls.clear();
 
     // Clear method context
     current_method_kind_ = StartMethodCommand::MethodKind::Custom;
     current_method_target_struct_ = nullptr;
     current_method_use_exceptions_ = false;
+    current_method_projected_ = false;
+    current_method_into_ = false;
 
     // Clear choice context
     in_choice_ = false;
@@ -1163,12 +1651,21 @@ void CppRenderer::render_end_method(const EndMethodCommand& cmd) {
 void CppRenderer::render_return_value(const ReturnValueCommand& cmd) {
     std::string return_expr = cmd.value;
 
+    // Padded input: fixed-width reads past the end surface here at the latest
+    emit_input_checkpoint();
+
     // For safe-mode struct readers, assign obj to result.value before returning
     if (current_method_kind_ == StartMethodCommand::MethodKind::StructReader &&
         !current_method_use_exceptions_ && return_expr == "result") {
         ctx_ << "result.value = obj;" << endl;
     }
 
+    // Incremental decoding: record the node's input range before returning
+    if (generate_incremental_ && current_method_kind_ == StartMethodCommand::MethodKind::StructReader &&
+        current_method_use_exceptions_ && !current_method_projected_ && return_expr == "obj") {
+        ctx_ << "incremental_frame.record(obj, data);" << endl;
+    }
+
     // For safe-mode choice readers, assign obj to result.value before returning
     if (current_method_kind_ == StartMethodCommand::MethodKind::ChoiceReader &&
         !current_method_use_exceptions_ && return_expr == "result") {
@@ -1196,10 +1693,30 @@ void CppRenderer::render_return_expression(const ReturnExpressionCommand& cmd) {
 
 void CppRenderer::render_read_field(const ReadFieldCommand& cmd) {
     std::string target = expr_context_.in_struct_method
-        ? expr_context_.object_name + "." + cmd.field_name
+        ? field_target(cmd.field_name)
         : cmd.field_name;
 
+    if (is_string_type(cmd.field_type)) {
+        emit_input_checkpoint();
+    }
+
     std::string read_call = generate_read_call(cmd.field_type, cmd.use_exceptions);
+    if (!cmd.projected_reader.empty()) {
+        // Nested struct with its own projection
+        read_call = ir_type_to_cpp(cmd.field_type) + "::" + cmd.projected_reader + "(data, end)";
+    }
+
+    // read_into(): decode nested structs and strings in place, keeping their capacity
+    if (current_method_into_ && expr_context_.in_struct_method && cmd.projected_reader.empty()) {
+        if (cmd.field_type->kind == ir::type_kind::struct_type) {
+            ctx_ << ir_type_to_cpp(cmd.field_type) + "::read_into(" + target + ", data, end);" << endl;
+            return;
+        }
+        if (cmd.field_type->kind == ir::type_kind::string) {
+            ctx_ << "read_string_into(" + target + ", data, end);" << endl;
+            return;
+        }
+    }
 
     // For union field readers with exceptions: use auto with initialization
     // This produces: auto field_name = FieldType::read(data, end);
@@ -1212,6 +1729,10 @@ void CppRenderer::render_read_field(const ReadFieldCommand& cmd) {
 }
 
 void CppRenderer::render_read_array_element(const ReadArrayElementCommand& cmd) {
+    if (is_string_type(cmd.element_type)) {
+        emit_input_checkpoint();
+    }
+
     std::string read_call = generate_read_call(cmd.element_type, cmd.use_exceptions);
 
     // For primitive types and enums, always just assign
@@ -1220,7 +1741,12 @@ void CppRenderer::render_read_array_element(const ReadArrayElementCommand& cmd)
                                cmd.element_type->kind == ir::type_kind::union_type ||
                                cmd.element_type->kind == ir::type_kind::choice_type);
 
-    if (cmd.use_exceptions || !is_struct_or_union) {
+    if (current_method_into_ && cmd.element_type->kind == ir::type_kind::struct_type) {
+        // read_into(): reuse the element left by the previous message
+        ctx_ << ir_type_to_cpp(cmd.element_type) + "::read_into(" + cmd.element_name + ", data, end);" << endl;
+    } else if (current_method_into_ && cmd.element_type->kind == ir::type_kind::string) {
+        ctx_ << "read_string_into(" + cmd.element_name + ", data, end);" << endl;
+    } else if (cmd.use_exceptions || !is_struct_or_union) {
         ctx_ << cmd.element_name + " = " + read_call + ";" << endl;
     } else {
         // Struct types in safe mode return ReadResult, need to check it
@@ -1237,6 +1763,7 @@ void CppRenderer::render_seek_to_label(const SeekToLabelCommand& cmd) {
 
     // Generate unique variable name for this label
     std::string label_var = "label_pos" + std::to_string(label_counter_++);
+    emit_input_checkpoint();
 
     // Calculate label position (absolute offset from struct start, per specification)
     ctx_ << "const uint8_t* " + label_var + " = start + " + label_expr + ";" << endl;
@@ -1252,6 +1779,9 @@ void CppRenderer::render_seek_to_label(const SeekToLabelCommand& cmd) {
     ctx_.end_if();
 
     // Seek to the labeled position
+    if (generate_incremental_) {
+        ctx_ << "incremental_touch(data);  // Bytes read so far stay in this node's input range" << endl;
+    }
     ctx_ << "data = " + label_var + ";" << endl;
 }
 
@@ -1269,19 +1799,114 @@ void CppRenderer::render_align_pointer(const AlignPointerCommand& cmd) {
     ctx_.end_scope();
 }
 
+void CppRenderer::render_reset_field(const ResetFieldCommand& cmd) {
+    const std::string target = expr_context_.object_name + "." + cmd.field_name;
+    if (cmd.out_of_line) {
+        ctx_ << target + ".reset();" << endl;
+        return;
+    }
+    switch (cmd.field_type->kind) {
+        case ir::type_kind::string:
+        case ir::type_kind::u16_string:
+        case ir::type_kind::u32_string:
+        case ir::type_kind::array_variable:
+        case ir::type_kind::array_ranged:
+            ctx_ << target + ".clear();" << endl;
+            break;
+        default:
+            ctx_ << target + " = {};" << endl;
+            break;
+    }
+}
+
+void CppRenderer::render_emplace_field(const EmplaceFieldCommand& cmd) {
+    ctx_ << expr_context_.object_name + "." + cmd.field_name + ".emplace();" << endl;
+    out_of_line_field_ = cmd.field_name;
+}
+
+void CppRenderer::render_mark_present(const MarkPresentCommand& cmd) {
+    const std::string mask = expr_context_.object_name + ".presence_";
+    const std::string bit = std::to_string(cmd.bit);
+    if (cmd.bit_count > 64) {
+        ctx_ << mask + ".set(" + bit + ");" << endl;
+    } else {
+        ctx_ << mask + " |= " + presence_mask_type(cmd.bit_count) + "(1) << " + bit + ";" << endl;
+    }
+    out_of_line_field_.clear();
+}
+
+void CppRenderer::render_skip_field(const SkipFieldCommand& cmd) {
+    const ir::type_kind kind = cmd.field_type->kind;
+    emit_input_checkpoint();
+    if (kind == ir::type_kind::string) {
+        ctx_ << "skip_string(data, end);" << endl;
+    } else if (kind == ir::type_kind::u16_string) {
+        ctx_ << "skip_wide_string<2>(data, end);" << endl;
+    } else if (kind == ir::type_kind::u32_string) {
+        ctx_ << "skip_wide_string<4>(data, end);" << endl;
+    } else if (cmd.count_expr) {
+        ctx_ << "skip_array(data, end, static_cast<size_t>(" + render_expression(cmd.count_expr) +
+                "), " + std::to_string(cmd.byte_size) + ");" << endl;
+    } else {
+        ctx_ << "skip_bytes(data, end, " + std::to_string(cmd.byte_size) + ");" << endl;
+    }
+}
+
+void CppRenderer::render_read_substream(const ReadSubstreamCommand& cmd) {
+    std::string target = expr_context_.in_struct_method
+        ? field_target(cmd.field_name)
+        : cmd.field_name;
+
+    // Only the raw region is copied here; Substream::get() undoes the
+    // transform and parses the field type on first access
+    const ir::substream_def& sub = *cmd.substream;
+    std::string transform;
+    switch (sub.transform) {
+        case ir::byte_transform::xor_key: transform = "ByteTransform::Xor"; break;
+        case ir::byte_transform::rotate_left: transform = "ByteTransform::RotateLeft"; break;
+        case ir::byte_transform::rotate_right: transform = "ByteTransform::RotateRight"; break;
+        case ir::byte_transform::zlib: transform = "ByteTransform::Zlib"; break;
+    }
+    std::string param = sub.parameter
+        ? "static_cast<uint8_t>(" + render_expression(&*sub.parameter) + ")"
+        : "0";
+    emit_input_checkpoint();
+    ctx_ << "read_substream(" + target + ", data, end, static_cast<size_t>(" +
+            render_expression(&sub.size) + "), " + transform + ", " + param + ");" << endl;
+}
+
 void CppRenderer::render_resize_array(const ResizeArrayCommand& cmd) {
     std::string size_expr = render_expression(cmd.size_expr);
     std::string target = expr_context_.in_struct_method
-        ? expr_context_.object_name + "." + cmd.array_name
+        ? field_target(cmd.array_name)
         : cmd.array_name;
 
+    emit_input_checkpoint();
     ctx_ << target + ".resize(" + size_expr + ");" << endl;
 }
 
+void CppRenderer::render_reserve_array(const ReserveArrayCommand& cmd) {
+    // Fixed-size elements: the remaining bytes give the exact count.
+    // Otherwise they bound it, and the reservation is capped so a small
+    // minimum size cannot turn a large input into a huge allocation.
+    std::string bound;
+    if (auto size = fixed_wire_size(*cmd.element_type); size && *size > 0) {
+        bound = std::to_string(*size);
+    } else if (size_t min_size = min_wire_size(*cmd.element_type); min_size > 0) {
+        bound = std::to_string(min_size) + ", " + std::to_string(unbounded_reserve_cap);
+    } else {
+        return;
+    }
+    emit_input_checkpoint();
+    ctx_ << "reserve_remaining(" + cmd.array_name + ", data, end, " + bound + ");" << endl;
+}
+
 void CppRenderer::render_append_to_array(const AppendToArrayCommand& cmd) {
-    std::string target = expr_context_.in_struct_method
-        ? expr_context_.object_name + "." + cmd.array_name
-        : cmd.array_name;
+    const std::string& target = cmd.array_name;  // Already qualified by the builder
+
+    if (is_string_type(cmd.element_type)) {
+        emit_input_checkpoint();
+    }
 
     std::string read_call = generate_read_call(cmd.element_type, cmd.use_exceptions);
 
@@ -1303,6 +1928,40 @@ void CppRenderer::render_append_to_array(const AppendToArrayCommand& cmd) {
     }
 }
 
+void CppRenderer::render_read_primitive_array(const ReadPrimitiveArrayCommand& cmd) {
+    emit_input_checkpoint();
+    std::string count_expr;
+    if (cmd.count_expr) {
+        count_expr = "static_cast<size_t>(" + render_expression(cmd.count_expr) + ")";
+    } else {
+        // Unbounded T[]: size the array by the remaining bytes, rounding up
+        // so a trailing partial element underflows as the per-element loop did
+        const size_t width = fixed_wire_size(*cmd.element_type).value_or(1);
+        if (width == 1) {
+            ctx_ << cmd.array_name + ".resize(static_cast<size_t>(end - data));" << endl;
+        } else {
+            const std::string w = std::to_string(width);
+            ctx_ << cmd.array_name + ".resize((static_cast<size_t>(end - data) + " + w + " - 1) / " +
+                    w + ");" << endl;
+        }
+        count_expr = cmd.array_name + ".size()";
+    }
+
+    // One bounds check for the whole run; the helper copies (or byte-swaps)
+    // straight into the array storage, undoing any delta encoding on the way
+    bool big = cmd.element_type->byte_order.has_value() &&
+               *cmd.element_type->byte_order == ir::endianness::big;
+    std::string func = "read_array";
+    switch (cmd.transform) {
+        case ir::array_transform::none: break;
+        case ir::array_transform::delta: func += "_delta"; break;
+        case ir::array_transform::delta_of_delta: func += "_delta_of_delta"; break;
+        case ir::array_transform::zigzag_delta: func += "_zigzag_delta"; break;
+    }
+    func += big ? "_be" : "_le";
+    ctx_ << func + "(data, end, " + cmd.array_name + ".data(), " + count_expr + ");" << endl;
+}
+
 // ============================================================================
 // Control Flow Commands
 // ============================================================================
@@ -1363,6 +2022,12 @@ void CppRenderer::render_save_position(const SavePositionCommand& cmd) {
 }
 
 void CppRenderer::render_restore_position(const RestorePositionCommand& cmd) {
+    // A failed attempt that ran past the end is an underflow, not a reason
+    // to try the next branch
+    emit_input_checkpoint();
+    if (generate_incremental_) {
+        ctx_ << "incremental_touch(data);  // The failed attempt's bytes stay in this node's input range" << endl;
+    }
     ctx_ << "data = " + cmd.var_name + ";  // Restore position for next branch attempt" << endl;
 }
 
@@ -1551,6 +2216,15 @@ void CppRenderer::render_extract_bitfield(const ExtractBitfieldCommand& cmd) {
     ctx_ << cmd.target_field + " = " + extraction.str() + ";" << endl;
 }
 
+void CppRenderer::render_memoize_call(const MemoizeCallCommand& cmd) {
+    // Generate: const uint32_t _memo_f = obj.f();
+    std::string call = render_expression(cmd.call_expr);
+    ctx_ << "const " + ir_type_to_cpp(&cmd.function->return_type) + " " + cmd.var_name + " = " + call + ";" << endl;
+
+    // Later calls in this method read the local (cleared at end of method)
+    expr_context_.memoized_calls[cmd.function->name] = cmd.var_name;
+}
+
 // ============================================================================
 // Helper: Map primitive type to read function name
 // ============================================================================
@@ -1567,6 +2241,8 @@ std::string CppRenderer::get_read_function_name(ir::type_kind type) {
         case ir::type_kind::int16:  return "read_int16_le";
         case ir::type_kind::int32:  return "read_int32_le";
         case ir::type_kind::int64:  return "read_int64_le";
+        case ir::type_kind::float32: return "read_float32_le";
+        case ir::type_kind::float64: return "read_float64_le";
         default:
             return "/* unknown type */";
     }
@@ -1579,7 +2255,604 @@ std::string CppRenderer::get_read_function_name(ir::type_kind type) {
 void CppRenderer::emit_helper_functions() {
     // Delegate to CppHelperGenerator for cleaner separation of concerns
     CppHelperGenerator helper_gen(ctx_, error_handling_mode_);
+    helper_gen.set_padded_input(padded_input_);
+    helper_gen.set_cpu_dispatch(cpu_dispatch_);
+    helper_gen.set_substream_max_inflate(substream_max_inflate_);
     helper_gen.generate_all();
+    if (presence_plan_.storage() == conditional_storage::boxed && presence_plan_.has_out_of_line()) {
+        helper_gen.generate_boxed();
+    }
+    if (generate_decode_cache_) {
+        helper_gen.generate_decode_cache();
+    }
+    if (generate_bulk_ingest_) {
+        helper_gen.generate_bulk_ingest();
+    }
+    if (generate_snapshot_) {
+        helper_gen.generate_snapshot();
+    }
+    if (generate_incremental_) {
+        helper_gen.generate_incremental();
+    }
+    if (utf8_strings_) {
+        helper_gen.generate_utf8_strings();
+    }
+    if (module_ && has_array_transforms(*module_)) {
+        helper_gen.generate_array_transforms();
+    }
+    if (module_ && has_substreams(*module_)) {
+        helper_gen.generate_substreams(has_substreams(*module_, true));
+    }
+    if (has_projections_ || generate_visitor_) {
+        helper_gen.generate_projection_skippers();
+    }
+    if (generate_batch_decode_) {
+        helper_gen.generate_batch_decode();
+    }
+    if (!record_index_structs_.empty()) {
+        helper_gen.generate_record_index();
+    }
+    if (!parallel_decode_structs_.empty()) {
+        helper_gen.generate_parallel_decode();
+    }
+    if (generate_visitor_) {
+        helper_gen.generate_visitor();
+    }
+}
+
+bool CppRenderer::has_array_transforms(const ir::bundle& bundle) {
+    for (const auto& struct_def : bundle.structs) {
+        for (const auto& field : struct_def.fields) {
+            if (field.transform != ir::array_transform::none) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool CppRenderer::has_substreams(const ir::bundle& bundle, bool zlib_only) {
+    for (const auto& struct_def : bundle.structs) {
+        for (const auto& field : struct_def.fields) {
+            if (field.substream && (!zlib_only || field.substream->transform == ir::byte_transform::zlib)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CppRenderer::emit_decode_cache_methods(const ir::struct_def& struct_def) {
+    const std::string& name = struct_def.name;
+    auto wire_size = fixed_wire_size(struct_def);
+
+    ctx_ << blank;
+    ctx_ << "// Content-addressed decode cache shared by all read_cached() calls" << endl;
+    ctx_.start_function("static DecodeCache<" + name + ">&", "decode_cache", "");
+    ctx_ << "static DecodeCache<" + name + "> cache(" + std::to_string(decode_cache_capacity_) + ");" << endl;
+    ctx_ << "return cache;" << endl;
+    ctx_.end_function();
+    ctx_ << blank;
+
+    // Keyed by exactly the bytes the struct consumes: its fixed wire size, or
+    // the extent a boundary scan finds without decoding the payload
+    ctx_ << "// Decode via the cache; identical input bytes share one immutable object" << endl;
+    ctx_.start_function("static std::shared_ptr<const " + name + ">", "read_cached",
+                        "const uint8_t*& data, const uint8_t* end");
+    if (wire_size) {
+        ctx_ << "const size_t key_len = " + std::to_string(*wire_size) + ";  // Fixed wire size" << endl;
+        ctx_.start_if("static_cast<size_t>(end - data) < key_len");
+        ctx_ << "return std::make_shared<const " + name + ">(read(data, end));  // read() reports the underflow" << endl;
+        ctx_.end_if();
+    } else {
+        ctx_ << "const uint8_t* extent_end = data;" << endl;
+        ctx_ << "(void)read_boundary(extent_end, end);  // Decodes only the fields that determine the size" << endl;
+        ctx_ << "const size_t key_len = static_cast<size_t>(extent_end - data);" << endl;
+    }
+    ctx_ << "const uint64_t key = decode_cache_hash(data, key_len);" << endl;
+    ctx_ << "size_t consumed = 0;" << endl;
+    ctx_.start_if("auto cached = decode_cache().find(key, data, key_len, consumed)");
+    ctx_ << "data += consumed;" << endl;
+    ctx_ << "return cached;" << endl;
+    ctx_.end_if();
+    ctx_ << "const uint8_t* key_start = data;" << endl;
+    ctx_ << "auto value = std::make_shared<const " + name + ">(read(data, end));" << endl;
+    ctx_ << "decode_cache().insert(key, key_start, key_len, static_cast<size_t>(data - key_start), value);" << endl;
+    ctx_ << "return value;" << endl;
+    ctx_.end_function();
+}
+
+void CppRenderer::emit_batch_decode_methods(const ir::struct_def& struct_def) {
+    const std::string& name = struct_def.name;
+
+    ctx_ << blank;
+    ctx_ << "// Decode independent messages into reused objects, prefetching the next group of inputs." << endl;
+    ctx_ << "// Never throws: status[i] (when present) reports message i; returns the number decoded." << endl;
+    ctx_ << "static size_t read_batch(std::span<const std::span<const uint8_t>> inputs, std::span<" + name +
+            "> outputs," << endl;
+    ctx_ << "                         std::span<BatchStatus> status = {}) noexcept {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "return decode_batch<" + name + ">(inputs, outputs, status," << endl;
+    ctx_ << "    [](" + name + "& out, const uint8_t*& data, const uint8_t* end) { read_into(out, data, end); });" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+void CppRenderer::emit_record_index_methods(const ir::struct_def& struct_def) {
+    const std::string& name = struct_def.name;
+    const std::string skip = "[](const uint8_t*& cursor, const uint8_t* limit) { (void)read_boundary(cursor, limit); }";
+
+    ctx_ << blank;
+    ctx_ << "// Index a buffer of back-to-back " + name + " records; only size-determining fields are decoded" << endl;
+    ctx_.start_function("static RecordIndex", "build_index",
+                        "const uint8_t* data, size_t size, uint32_t stride = RecordIndex::default_stride");
+    ctx_ << "return RecordIndex::build(data, size, stride, " + skip + ");" << endl;
+    ctx_.end_function();
+    ctx_ << blank;
+    ctx_ << "// Decode record n of an indexed buffer" << endl;
+    ctx_.start_function("static " + name, "read_at",
+                        "const RecordIndex& index, const uint8_t* data, size_t size, uint64_t n");
+    ctx_ << "const uint8_t* p = data + index.offset_of(data, size, n, " + skip + ");" << endl;
+    ctx_ << "return read(p, data + size);" << endl;
+    ctx_.end_function();
+}
+
+void CppRenderer::emit_parallel_decode_methods(const ir::struct_def& struct_def) {
+    const std::string& name = struct_def.name;
+
+    ctx_ << blank;
+    ctx_ << "// Decode a buffer of back-to-back " + name + " records: a serial boundary pass, then chunks" << endl;
+    ctx_ << "// decoded on workers threads (0 = hardware concurrency), returned in input order" << endl;
+    ctx_.start_function("static std::vector<" + name + ">", "read_all_parallel",
+                        "const uint8_t* data, size_t size, size_t workers = 0");
+    ctx_ << "return parallel_decode<" + name + ">(data, size, workers," << endl;
+    ctx_ << "    [](const uint8_t*& cursor, const uint8_t* limit) { (void)read_boundary(cursor, limit); }," << endl;
+    ctx_ << "    [](const uint8_t*& cursor, const uint8_t* limit) { return read(cursor, limit); });" << endl;
+    ctx_.end_function();
+}
+
+void CppRenderer::emit_padded_read_method() {
+    ctx_ << blank;
+    ctx_ << "// Decode from a padded buffer (the whole buffer is the input)" << endl;
+    ctx_.start_function("static " + current_struct_name_, "read", "const PaddedBuffer& buffer");
+    ctx_ << "const uint8_t* p = buffer.data();" << endl;
+    ctx_ << "return read(p, p + buffer.size());" << endl;
+    ctx_.end_function();
+}
+
+void CppRenderer::emit_input_checkpoint() {
+    if (!padded_input_) {
+        return;
+    }
+    switch (current_method_kind_) {
+        case StartMethodCommand::MethodKind::StructReader:
+        case StartMethodCommand::MethodKind::UnionReader:
+        case StartMethodCommand::MethodKind::UnionFieldReader:
+        case StartMethodCommand::MethodKind::ChoiceReader:
+        case StartMethodCommand::MethodKind::StandaloneReader:
+            ctx_ << "check_input_end(data, end);" << endl;
+            break;
+        default:
+            break;
+    }
+}
+
+std::vector<std::string> CppRenderer::get_boundary_structs(const ir::bundle& bundle) const {
+    std::vector<std::string> names = record_index_structs_;
+    for (const auto& name : parallel_decode_structs_) {
+        if (std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+    // read_cached() keys variable-size structs on the bytes read_boundary() spans
+    if (generate_decode_cache_) {
+        for (const auto& struct_def : bundle.structs) {
+            if (!codegen::fixed_wire_size(&bundle, struct_def, 0) &&
+                std::find(names.begin(), names.end(), struct_def.name) == names.end()) {
+                names.push_back(struct_def.name);
+            }
+        }
+    }
+    return names;
+}
+
+std::optional<size_t> CppRenderer::fixed_wire_size(const ir::type_ref& type, size_t depth) const {
+    return codegen::fixed_wire_size(module_, type, depth);
+}
+
+std::optional<size_t> CppRenderer::fixed_wire_size(const ir::struct_def& struct_def, size_t depth) const {
+    return codegen::fixed_wire_size(module_, struct_def, depth);
+}
+
+size_t CppRenderer::min_wire_size(const ir::type_ref& type) const {
+    if (auto size = fixed_wire_size(type)) {
+        return *size;
+    }
+    switch (type.kind) {
+        case ir::type_kind::string:
+            return 1;  // Terminator
+        case ir::type_kind::u16_string:
+            return 2;
+        case ir::type_kind::u32_string:
+            return 4;
+        default:
+            break;
+    }
+    if (!module_ || !type.type_index) {
+        return 0;
+    }
+    size_t index = *type.type_index;
+    const std::optional<ir::size_bounds>* bounds = nullptr;
+    if (type.kind == ir::type_kind::struct_type && index < module_->structs.size()) {
+        bounds = &module_->structs[index].bounds;
+    } else if (type.kind == ir::type_kind::union_type && index < module_->unions.size()) {
+        bounds = &module_->unions[index].bounds;
+    } else if (type.kind == ir::type_kind::choice_type && index < module_->choices.size()) {
+        bounds = &module_->choices[index].bounds;
+    }
+    return bounds && *bounds ? (*bounds)->min_wire_size : 0;
+}
+
+namespace {
+    // Follow subtype aliases to the underlying type
+    const ir::type_ref& resolve_subtype(const ir::bundle* module, const ir::type_ref& type) {
+        const ir::type_ref* current = &type;
+        for (size_t depth = 0; depth < 64; ++depth) {
+            if (current->kind != ir::type_kind::subtype_ref || !module || !current->type_index ||
+                *current->type_index >= module->subtypes.size()) {
+                break;
+            }
+            current = &module->subtypes[*current->type_index].base_type;
+        }
+        return *current;
+    }
+
+    // Value category of a type inside a snapshot record
+    enum class snapshot_kind { scalar, string, record, unsupported };
+
+    snapshot_kind classify_snapshot(const ir::type_ref& type) {
+        switch (type.kind) {
+            case ir::type_kind::uint8:
+            case ir::type_kind::uint16:
+            case ir::type_kind::uint32:
+            case ir::type_kind::uint64:
+            case ir::type_kind::int8:
+            case ir::type_kind::int16:
+            case ir::type_kind::int32:
+            case ir::type_kind::int64:
+            case ir::type_kind::float32:
+            case ir::type_kind::float64:
+            case ir::type_kind::boolean:
+            case ir::type_kind::bitfield:
+            case ir::type_kind::enum_type:
+                return snapshot_kind::scalar;
+            case ir::type_kind::string:
+                return snapshot_kind::string;
+            case ir::type_kind::struct_type:
+                return snapshot_kind::record;
+            default:
+                return snapshot_kind::unsupported;
+        }
+    }
+
+    constexpr size_t SNAPSHOT_REF_SIZE = 16;  // uint64_t offset + uint64_t count
+    constexpr size_t SNAPSHOT_REF_ALIGN = 8;
+
+    size_t round_up(size_t value, size_t align) {
+        return (value + align - 1) / align * align;
+    }
+
+    uint64_t fnv1a_64(const std::string& text) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+}
+
+void CppRenderer::emit_snapshot_methods(const ir::struct_def& struct_def) {
+    const std::string& name = struct_def.name;
+    std::vector<size_t> offsets;
+    auto layout = snapshot_layout(struct_def, 0, &offsets);
+
+    ctx_ << blank;
+    if (!layout) {
+        ctx_ << "// No snapshot support: a field (or nested type) has no snapshot layout" << endl;
+        return;
+    }
+
+    std::ostringstream hash;
+    hash << "0x" << std::hex << fnv1a_64(snapshot_signature(struct_def)) << "ULL";
+
+    ctx_ << "// Snapshot record layout (natural alignment, strings/arrays by offset + count)" << endl;
+    ctx_ << "static constexpr size_t snapshot_record_size = " + std::to_string(layout->size) + ";" << endl;
+    ctx_ << "static constexpr size_t snapshot_record_align = " + std::to_string(layout->align) + ";" << endl;
+    ctx_ << "static constexpr uint64_t snapshot_layout_hash = " + hash.str() + ";" << endl;
+    ctx_ << blank;
+
+    // write_snapshot(): store this object's record at `at`
+    ctx_ << "// Store this object as a snapshot record at offset `at`" << endl;
+    ctx_ << "void write_snapshot(SnapshotWriter& w, size_t at) const {" << endl;
+    ctx_.writer().indent();
+    for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+        const auto& field = struct_def.fields[i];
+        const auto& type = resolve_subtype(module_, field.type);
+        const std::string slot = "at + " + std::to_string(offsets[i]);
+        const std::string member = "this->" + field.name;  // Fields may shadow w / at / i
+
+        if (type.element_type) {
+            const auto& element = resolve_subtype(module_, *type.element_type);
+            const std::string element_name = ir_type_to_cpp(type.element_type.get());
+            auto kind = classify_snapshot(element);
+            if (type.kind == ir::type_kind::array_fixed) {
+                const std::string count = std::to_string(*type.array_size);
+                if (kind == snapshot_kind::scalar) {
+                    ctx_ << "w.put_elements(" + slot + ", " + member + ".data(), " + count + ");" << endl;
+                } else if (kind == snapshot_kind::string) {
+                    ctx_.start_for("size_t i = 0", "i < " + count, "i++");
+                    ctx_ << "w.put_string(" + slot + " + i * SNAPSHOT_REF_SIZE, " + member + "[i]);" << endl;
+                    ctx_.end_for();
+                } else {
+                    ctx_.start_for("size_t i = 0", "i < " + count, "i++");
+                    ctx_ << member + "[i].write_snapshot(w, " + slot + " + i * " + element_name + "::snapshot_record_size);" << endl;
+                    ctx_.end_for();
+                }
+            } else if (kind == snapshot_kind::scalar && element.kind != ir::type_kind::boolean) {
+                ctx_ << "w.put_array(" + slot + ", " + member + ".data(), " + member + ".size());" << endl;
+            } else {
+                // Out-of-line records (std::vector<bool> has no data())
+                std::string record_size, record_align, store;
+                if (kind == snapshot_kind::scalar) {
+                    record_size = record_align = "1";
+                    store = "w.put(elements_at + i, static_cast<bool>(" + member + "[i]));";
+                } else if (kind == snapshot_kind::string) {
+                    record_size = "SNAPSHOT_REF_SIZE";
+                    record_align = "SNAPSHOT_REF_ALIGN";
+                    store = "w.put_string(elements_at + i * SNAPSHOT_REF_SIZE, " + member + "[i]);";
+                } else {
+                    record_size = element_name + "::snapshot_record_size";
+                    record_align = element_name + "::snapshot_record_align";
+                    store = member + "[i].write_snapshot(w, elements_at + i * " + record_size + ");";
+                }
+                ctx_.start_scope();
+                ctx_ << "size_t elements_at = w.put_records(" + slot + ", " + member + ".size(), " +
+                        record_size + ", " + record_align + ");" << endl;
+                ctx_.start_for("size_t i = 0", "i < " + member + ".size()", "i++");
+                ctx_ << store << endl;
+                ctx_.end_for();
+                ctx_.end_scope();
+            }
+            continue;
+        }
+
+        switch (classify_snapshot(type)) {
+            case snapshot_kind::scalar:
+                ctx_ << "w.put(" + slot + ", " + member + ");" << endl;
+                break;
+            case snapshot_kind::string:
+                ctx_ << "w.put_string(" + slot + ", " + member + ");" << endl;
+                break;
+            default:
+                ctx_ << member + ".write_snapshot(w, " + slot + ");" << endl;
+                break;
+        }
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    ctx_ << "// Encode this object (and everything it owns) as a relocatable snapshot image" << endl;
+    ctx_ << "std::vector<uint8_t> to_snapshot() const {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "SnapshotWriter w;" << endl;
+    ctx_ << "write_snapshot(w, w.begin(snapshot_layout_hash, snapshot_record_size, snapshot_record_align));" << endl;
+    ctx_ << "return w.finish();" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+
+    // Read-only accessors over a snapshot record
+    ctx_ << "// Read-only view of a " + name + " record inside a snapshot (no parsing, no allocation)" << endl;
+    ctx_.start_class("SnapshotView");
+    ctx_ << "public:" << endl;
+    ctx_ << "SnapshotView() = default;" << endl;
+    ctx_ << "SnapshotView(const uint8_t* base, size_t size, size_t at) : base_(base), size_(size), at_(at) {}" << endl;
+    ctx_ << blank;
+    for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+        const auto& field = struct_def.fields[i];
+        const auto& type = resolve_subtype(module_, field.type);
+        const std::string slot = "at_ + " + std::to_string(offsets[i]);
+
+        if (type.element_type) {
+            const auto& element = resolve_subtype(module_, *type.element_type);
+            const std::string element_name = ir_type_to_cpp(type.element_type.get());
+            auto kind = classify_snapshot(element);
+            std::string view_type;
+            if (kind == snapshot_kind::scalar) {
+                view_type = "SnapshotArray<" + element_name + ">";
+            } else if (kind == snapshot_kind::string) {
+                view_type = "SnapshotStrings";
+            } else {
+                view_type = "SnapshotRecords<" + element_name + ">";
+            }
+
+            std::string body;
+            if (type.kind == ir::type_kind::array_fixed) {
+                const std::string count = std::to_string(*type.array_size);
+                if (kind == snapshot_kind::scalar) {
+                    body = view_type + "(base_ + " + slot + ", " + count + ")";
+                } else {
+                    body = view_type + "(base_, size_, " + slot + ", " + count + ")";
+                }
+            } else if (kind == snapshot_kind::scalar) {
+                body = "snapshot_array<" + element_name + ">(base_, size_, " + slot + ")";
+            } else if (kind == snapshot_kind::string) {
+                body = "snapshot_strings(base_, size_, " + slot + ")";
+            } else {
+                body = "snapshot_records<" + element_name + ">(base_, size_, " + slot + ")";
+            }
+            ctx_ << view_type + " " + field.name + "() const { return " + body + "; }" << endl;
+            continue;
+        }
+
+        const std::string type_name = ir_type_to_cpp(&field.type);
+        switch (classify_snapshot(type)) {
+            case snapshot_kind::scalar:
+                ctx_ << type_name + " " + field.name + "() const { return snapshot_load<" + type_name +
+                        ">(base_ + " + slot + "); }" << endl;
+                break;
+            case snapshot_kind::string:
+                ctx_ << "std::string_view " + field.name + "() const { return snapshot_string(base_, size_, " +
+                        slot + "); }" << endl;
+                break;
+            default:
+                ctx_ << type_name + "::SnapshotView " + field.name + "() const { return " + type_name +
+                        "::SnapshotView(base_, size_, " + slot + "); }" << endl;
+                break;
+        }
+    }
+    ctx_ << blank;
+    ctx_ << "private:" << endl;
+    ctx_ << "const uint8_t* base_ = nullptr;" << endl;
+    ctx_ << "size_t size_ = 0;" << endl;
+    ctx_ << "size_t at_ = 0;" << endl;
+    ctx_.end_class();
+    ctx_ << blank;
+
+    ctx_ << "// Open a snapshot image produced by to_snapshot(); validates the header only" << endl;
+    ctx_.start_function("static SnapshotView", "open_snapshot", "const uint8_t* data, size_t size");
+    ctx_ << "return SnapshotView(data, size, snapshot_root(data, size, snapshot_layout_hash, snapshot_record_size));" << endl;
+    ctx_.end_function();
+    ctx_ << blank;
+
+    ctx_.start_function("static SnapshotView", "open_snapshot", "const SnapshotFile& file");
+    ctx_ << "return open_snapshot(file.data(), file.size());" << endl;
+    ctx_.end_function();
+}
+
+std::optional<CppRenderer::snapshot_slot> CppRenderer::snapshot_layout(const ir::type_ref& type, size_t depth) const {
+    // Guard against pathological nesting (and self-referencing structs)
+    if (depth > 64) {
+        return std::nullopt;
+    }
+
+    const auto& resolved = resolve_subtype(module_, type);
+    switch (resolved.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::int8:
+        case ir::type_kind::boolean:
+            return snapshot_slot{1, 1};
+        case ir::type_kind::uint16:
+        case ir::type_kind::int16:
+            return snapshot_slot{2, 2};
+        case ir::type_kind::uint32:
+        case ir::type_kind::int32:
+        case ir::type_kind::float32:
+            return snapshot_slot{4, 4};
+        case ir::type_kind::uint64:
+        case ir::type_kind::int64:
+        case ir::type_kind::float64:
+            return snapshot_slot{8, 8};
+        case ir::type_kind::bitfield: {
+            size_t bits = resolved.bit_width.value_or(bitfield_limits::UINT8_MAX_BITS);
+            size_t size = bits <= bitfield_limits::UINT8_MAX_BITS ? 1
+                        : bits <= bitfield_limits::UINT16_MAX_BITS ? 2
+                        : bits <= bitfield_limits::UINT32_MAX_BITS ? 4 : 8;
+            return snapshot_slot{size, size};
+        }
+        case ir::type_kind::enum_type:
+            if (module_ && resolved.type_index && *resolved.type_index < module_->enums.size()) {
+                return snapshot_layout(module_->enums[*resolved.type_index].base_type, depth + 1);
+            }
+            return std::nullopt;
+        case ir::type_kind::string:
+            return snapshot_slot{SNAPSHOT_REF_SIZE, SNAPSHOT_REF_ALIGN};
+        case ir::type_kind::struct_type:
+            if (module_ && resolved.type_index && *resolved.type_index < module_->structs.size()) {
+                return snapshot_layout(module_->structs[*resolved.type_index], depth + 1);
+            }
+            return std::nullopt;
+        case ir::type_kind::array_fixed:
+        case ir::type_kind::array_variable:
+        case ir::type_kind::array_ranged: {
+            if (!resolved.element_type ||
+                classify_snapshot(resolve_subtype(module_, *resolved.element_type)) == snapshot_kind::unsupported) {
+                return std::nullopt;  // Nested arrays, unions, choices, wide strings
+            }
+            auto element = snapshot_layout(*resolved.element_type, depth + 1);
+            if (!element) {
+                return std::nullopt;
+            }
+            if (resolved.kind != ir::type_kind::array_fixed) {
+                return snapshot_slot{SNAPSHOT_REF_SIZE, SNAPSHOT_REF_ALIGN};
+            }
+            if (!resolved.array_size) {
+                return std::nullopt;
+            }
+            return snapshot_slot{element->size * static_cast<size_t>(*resolved.array_size), element->align};
+        }
+        default:
+            // 128-bit integers, UTF-16/32 strings, unions and choices
+            return std::nullopt;
+    }
+}
+
+std::optional<CppRenderer::snapshot_slot> CppRenderer::snapshot_layout(const ir::struct_def& struct_def, size_t depth,
+                                                                       std::vector<size_t>* offsets) const {
+    const auto* presence = presence_plan_.find(struct_def.name);
+    if (presence && presence->has_out_of_line()) {
+        return std::nullopt;  // std::optional / Boxed members have no snapshot form
+    }
+
+    size_t offset = 0;
+    size_t align = 1;
+    for (const auto& field : struct_def.fields) {
+        if (field.substream) {
+            return std::nullopt;  // Undecoded regions have no snapshot form
+        }
+        auto slot = snapshot_layout(field.type, depth);
+        if (!slot) {
+            return std::nullopt;
+        }
+        offset = round_up(offset, slot->align);
+        if (offsets) {
+            offsets->push_back(offset);
+        }
+        offset += slot->size;
+        align = std::max(align, slot->align);
+    }
+    return snapshot_slot{round_up(offset, align), align};
+}
+
+std::string CppRenderer::snapshot_signature(const ir::struct_def& struct_def, size_t depth) const {
+    std::vector<size_t> offsets;
+    auto layout = snapshot_layout(struct_def, depth, &offsets);
+    if (!layout || depth > 64) {
+        return struct_def.name + "{?}";
+    }
+
+    std::function<std::string(const ir::type_ref&)> describe = [&](const ir::type_ref& type) -> std::string {
+        const auto& resolved = resolve_subtype(module_, type);
+        if (resolved.element_type) {
+            std::string count = resolved.kind == ir::type_kind::array_fixed
+                ? std::to_string(resolved.array_size.value_or(0)) : "*";
+            return "[" + describe(*resolved.element_type) + ";" + count + "]";
+        }
+        if (resolved.kind == ir::type_kind::struct_type && module_ && resolved.type_index) {
+            return snapshot_signature(module_->structs[*resolved.type_index], depth + 1);
+        }
+        auto slot = snapshot_layout(resolved, depth + 1);
+        return ir_type_to_cpp(&resolved) + "/" + std::to_string(slot ? slot->size : 0);
+    };
+
+    std::string signature = struct_def.name + "{";
+    for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+        const auto& field = struct_def.fields[i];
+        signature += field.name + ":" + describe(field.type) + "@" + std::to_string(offsets[i]) + ";";
+    }
+    return signature + "}" + std::to_string(layout->size) + "/" + std::to_string(layout->align);
 }
 
 std::string CppRenderer::generate_read_call(const ir::type_ref* type, bool use_exceptions) {
@@ -1634,6 +2907,8 @@ std::string CppRenderer::generate_read_call(const ir::type_ref* type, bool use_e
         case ir::type_kind::int16:  return "read_int16" + get_endian_suffix() + "(data, end)";
         case ir::type_kind::int32:  return "read_int32" + get_endian_suffix() + "(data, end)";
         case ir::type_kind::int64:  return "read_int64" + get_endian_suffix() + "(data, end)";
+        case ir::type_kind::float32: return "read_float32" + get_endian_suffix() + "(data, end)";
+        case ir::type_kind::float64: return "read_float64" + get_endian_suffix() + "(data, end)";
         case ir::type_kind::boolean: return "read_uint8(data, end) != 0";
         default:
             break;
@@ -1700,6 +2975,9 @@ std::string CppRenderer::generate_read_call(const ir::type_ref* type, bool use_e
         } else {
             func_name = "read_u16string_le";  // Default to little-endian
         }
+        if (utf8_strings_) {
+            func_name += "_utf8";
+        }
         return func_name + "(data, end)";
     }
 
@@ -1711,6 +2989,9 @@ std::string CppRenderer::generate_read_call(const ir::type_ref* type, bool use_e
         } else {
             func_name = "read_u32string_le";  // Default to little-endian
         }
+        if (utf8_strings_) {
+            func_name += "_utf8";
+        }
         return func_name + "(data, end)";
     }
 
@@ -1738,6 +3019,7 @@ void CppRenderer::generate_error_check(const std::string& error_condition,
 
 void CppRenderer::generate_includes() {
     ctx_ << "#include <cstdint>" << endl;
+    ctx_ << "#include <cstring>" << endl;
     ctx_ << "#include <string>" << endl;
     ctx_ << "#include <vector>" << endl;
     ctx_ << "#include <stdexcept>" << endl;
@@ -1807,6 +3089,8 @@ std::string CppRenderer::ir_type_to_cpp(const ir::type_ref* type) const {
         case ir::type_kind::int32:
         case ir::type_kind::int64:
         case ir::type_kind::int128:
+        case ir::type_kind::float32:
+        case ir::type_kind::float64:
             result = get_primitive_cpp_type(type);
             break;
 
@@ -1815,11 +3099,11 @@ std::string CppRenderer::ir_type_to_cpp(const ir::type_ref* type) const {
             break;
 
         case ir::type_kind::u16_string:
-            result = "std::u16string";
+            result = utf8_strings_ ? "std::string" : "std::u16string";
             break;
 
         case ir::type_kind::u32_string:
-            result = "std::u32string";
+            result = utf8_strings_ ? "std::string" : "std::u32string";
             break;
 
         case ir::type_kind::boolean:
@@ -1902,6 +3186,8 @@ std::string CppRenderer::get_primitive_cpp_type(const ir::type_ref* type) const
         case ir::type_kind::int32:   return "int32_t";
         case ir::type_kind::int64:   return "int64_t";
         case ir::type_kind::int128:  return "int128_t";   // May not exist in C++
+        case ir::type_kind::float32: return "float";
+        case ir::type_kind::float64: return "double";
         default:
             return "/* not a primitive */";
     }
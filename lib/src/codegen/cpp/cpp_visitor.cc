@@ -0,0 +1,1144 @@
+//
+// C++ Visitor Decoding Generator Implementation
+//
+// Generates parse_<Type>(data, end, visitor): event-driven decoding that
+// reports fields to visitor hooks and skips what the visitor ignores,
+// without building the generated structs.
+//
+
+#include <datascript/codegen/cpp/cpp_visitor.hh>
+#include <datascript/codegen/cpp/cpp_renderer.hh>
+#include <datascript/codegen/cpp/cpp_expression_renderer.hh>
+#include <datascript/codegen.hh>
+#include <algorithm>
+
+namespace datascript::codegen {
+
+using codegen::endl;
+using codegen::blank;
+
+namespace {
+    bool is_array(const ir::type_ref& type) {
+        return type.kind == ir::type_kind::array_fixed ||
+               type.kind == ir::type_kind::array_variable ||
+               type.kind == ir::type_kind::array_ranged;
+    }
+
+    bool is_composite(const ir::type_ref& type) {
+        return type.kind == ir::type_kind::struct_type ||
+               type.kind == ir::type_kind::union_type ||
+               type.kind == ir::type_kind::choice_type;
+    }
+
+    bool is_128bit(ir::type_kind kind) {
+        return kind == ir::type_kind::uint128 || kind == ir::type_kind::int128;
+    }
+
+    // "header.len" and "items[i]" are fields header and items
+    std::string root_name(const std::string& ref_name) {
+        return ref_name.substr(0, ref_name.find_first_of(".["));
+    }
+
+    std::vector<const ir::field*> field_list(const std::vector<ir::field>& fields) {
+        std::vector<const ir::field*> list;
+        for (const auto& field : fields) {
+            list.push_back(&field);
+        }
+        return list;
+    }
+
+    std::vector<const ir::field*> union_branches(const ir::union_def& union_def) {
+        std::vector<const ir::field*> branches;
+        for (const auto& union_case : union_def.cases) {
+            for (const auto& field : union_case.fields) {
+                branches.push_back(&field);
+            }
+        }
+        return branches;
+    }
+
+    std::vector<const ir::field*> choice_cases(const ir::choice_def& choice_def) {
+        std::vector<const ir::field*> cases;
+        for (const auto& choice_case : choice_def.cases) {
+            cases.push_back(&choice_case.case_field);
+        }
+        return cases;
+    }
+}  // namespace
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+CppVisitorGenerator::CppVisitorGenerator(CppRenderer& renderer, CppWriterContext& ctx)
+    : renderer_(renderer),
+      ctx_(ctx)
+{
+    expr_context_.in_struct_method = true;
+    expr_context_.object_name = "obj";
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void CppVisitorGenerator::generate(const ir::bundle& bundle, const std::string& namespace_name) {
+    bundle_ = &bundle;
+    renderer_.set_module(&bundle);  // Set module for type name resolution
+    expr_context_.module_constants = &bundle.constants;
+    qualifier_ = "::" + namespace_name + "::";
+
+    classify_types();
+
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Visitor Field Tags" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    for (size_t i = 0; i < bundle.structs.size(); ++i) {
+        if (struct_visitable_[i]) {
+            emit_tags(bundle.structs[i].name, field_list(bundle.structs[i].fields));
+        }
+    }
+    for (size_t i = 0; i < bundle.unions.size(); ++i) {
+        if (union_visitable_[i]) {
+            emit_tags(bundle.unions[i].name, union_branches(bundle.unions[i]));
+        }
+    }
+    for (size_t i = 0; i < bundle.choices.size(); ++i) {
+        if (choice_visitable_[i]) {
+            emit_tags(bundle.choices[i].name, choice_cases(bundle.choices[i]));
+        }
+    }
+
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << "// Visitor Parse Functions" << endl;
+    ctx_ << "// ============================================================================" << endl;
+    ctx_ << blank;
+    emit_declarations();
+
+    for (const auto& [kind, index] : bundle.type_emission_order) {
+        if (kind == 0 && struct_visitable_[index]) {
+            emit_struct(bundle.structs[index]);
+        } else if (kind == 1 && union_visitable_[index]) {
+            emit_union(bundle.unions[index]);
+        } else if (kind == 2 && choice_visitable_[index]) {
+            emit_choice(bundle.choices[index]);
+        }
+    }
+}
+
+// ============================================================================
+// Analysis
+// ============================================================================
+
+void CppVisitorGenerator::classify_types() {
+    struct_visitable_.clear();
+    union_visitable_.clear();
+    choice_visitable_.clear();
+    for (const auto& struct_def : bundle_->structs) {
+        struct_visitable_.push_back(fields_visitable(field_list(struct_def.fields)));
+    }
+    for (const auto& union_def : bundle_->unions) {
+        bool visitable = fields_visitable(union_branches(union_def));
+        std::set<std::string> names;
+        bool calls = false;
+        for (const auto& union_case : union_def.cases) {
+            if (union_case.condition) {
+                collect_refs(*union_case.condition, names, calls);
+            }
+        }
+        union_visitable_.push_back(visitable && !calls);
+    }
+    for (const auto& choice_def : bundle_->choices) {
+        choice_visitable_.push_back(fields_visitable(choice_cases(choice_def)));
+    }
+}
+
+bool CppVisitorGenerator::fields_visitable(const std::vector<const ir::field*>& fields) const {
+    for (const auto* field : fields) {
+        if (field->substream || field->transform != ir::array_transform::none) {
+            return false;
+        }
+        if (!type_visitable(field->type)) {
+            return false;
+        }
+        std::set<std::string> names;
+        bool calls = false;
+        collect_field_refs(*field, names, calls);
+        if (calls) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CppVisitorGenerator::type_visitable(const ir::type_ref& type) const {
+    if (is_128bit(type.kind)) {
+        return false;
+    }
+    if (is_array(type)) {
+        const ir::type_ref& element = *type.element_type;
+        return !is_array(element) && element.kind != ir::type_kind::bitfield && type_visitable(element);
+    }
+    return true;
+}
+
+bool CppVisitorGenerator::has_parse_function(const ir::type_ref& type) const {
+    if (!type.type_index) {
+        return false;
+    }
+    switch (type.kind) {
+        case ir::type_kind::struct_type: return struct_visitable_.at(*type.type_index);
+        case ir::type_kind::union_type: return union_visitable_.at(*type.type_index);
+        case ir::type_kind::choice_type: return choice_visitable_.at(*type.type_index);
+        default: return false;
+    }
+}
+
+void CppVisitorGenerator::collect_refs(const ir::expr& expr, std::set<std::string>& names, bool& calls) const {
+    switch (expr.type) {
+        case ir::expr::field_ref:
+        case ir::expr::parameter_ref:
+            names.insert(root_name(expr.ref_name));
+            break;
+        case ir::expr::function_call:
+            calls = true;
+            break;
+        default:
+            break;
+    }
+    for (const auto* child : {expr.left.get(), expr.right.get(), expr.condition.get(),
+                              expr.true_expr.get(), expr.false_expr.get()}) {
+        if (child) {
+            collect_refs(*child, names, calls);
+        }
+    }
+    for (const auto& argument : expr.arguments) {
+        collect_refs(*argument, names, calls);
+    }
+}
+
+void CppVisitorGenerator::collect_type_refs(const ir::type_ref& type, std::set<std::string>& names,
+                                            bool& calls) const {
+    for (const auto* size : {type.array_size_expr.get(), type.min_size_expr.get(), type.max_size_expr.get()}) {
+        if (size) {
+            collect_refs(*size, names, calls);
+        }
+    }
+    for (const auto& argument : type.choice_selector_args) {
+        collect_refs(*argument, names, calls);
+    }
+    if (type.kind == ir::type_kind::choice_type && type.choice_selector_args.empty() && type.type_index) {
+        // The selector names a field of the enclosing struct
+        const auto& choice_def = bundle_->choices.at(*type.type_index);
+        if (choice_def.selector && !choice_def.inferred_discriminator_type) {
+            names.insert(root_name(choice_def.selector->ref_name));
+        }
+    }
+    if (type.kind == ir::type_kind::union_type && type.type_index) {
+        auto refs = parent_refs(bundle_->unions.at(*type.type_index));
+        names.insert(refs.begin(), refs.end());
+    }
+    if (type.element_type) {
+        collect_type_refs(*type.element_type, names, calls);
+    }
+}
+
+void CppVisitorGenerator::collect_field_refs(const ir::field& field, std::set<std::string>& names,
+                                             bool& calls) const {
+    collect_type_refs(field.type, names, calls);
+    for (const auto* expr : {field.inline_constraint ? &*field.inline_constraint : nullptr,
+                             field.default_value ? &*field.default_value : nullptr,
+                             field.runtime_condition ? &*field.runtime_condition : nullptr,
+                             field.label ? &*field.label : nullptr}) {
+        if (expr) {
+            collect_refs(*expr, names, calls);
+        }
+    }
+    for (const auto& application : field.constraints) {
+        if (application.constraint_index < bundle_->constraints.size()) {
+            collect_refs(bundle_->constraints[application.constraint_index].condition, names, calls);
+        }
+    }
+}
+
+std::set<std::string> CppVisitorGenerator::parent_refs(const ir::union_def& union_def) const {
+    // Branch expressions naming anything but the branch itself read the enclosing struct
+    std::set<std::string> refs;
+    for (const auto& union_case : union_def.cases) {
+        for (const auto& field : union_case.fields) {
+            std::set<std::string> names;
+            bool calls = false;
+            collect_field_refs(field, names, calls);
+            if (union_case.condition) {
+                collect_refs(*union_case.condition, names, calls);
+            }
+            names.erase(field.name);
+            for (const auto& member : CppExpressionRenderer::block_members(union_case, *bundle_)) {
+                names.erase(member);
+            }
+            refs.insert(names.begin(), names.end());
+        }
+    }
+    return refs;
+}
+
+void CppVisitorGenerator::select_needed(const std::vector<const ir::field*>& fields) {
+    std::set<std::string> names;
+    bool calls = false;
+    for (const auto* field : fields) {
+        collect_field_refs(*field, names, calls);
+    }
+    needed_.clear();
+    for (const auto* field : fields) {
+        if (names.count(field->name) && field->condition != ir::field::never) {
+            needed_.insert(field->name);
+        }
+    }
+}
+
+// ============================================================================
+// Declarations
+// ============================================================================
+
+void CppVisitorGenerator::emit_tags(const std::string& owner, const std::vector<const ir::field*>& fields) {
+    ctx_ << "namespace fields::" + owner + " {" << endl;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const auto& field = *fields[i];
+        if (field.condition == ir::field::never) {
+            continue;
+        }
+        ctx_ << "struct " + field.name + " {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "using value_type = " + value_type(field.type) + ";" << endl;
+        ctx_ << "static constexpr std::string_view field_name = \"" + field.name + "\";" << endl;
+        ctx_ << "static constexpr size_t field_index = " + std::to_string(i) + ";" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "};" << endl;
+    }
+    ctx_ << "}  // namespace fields::" + owner << endl;
+    ctx_ << blank;
+}
+
+void CppVisitorGenerator::emit_signature(const std::string& name, const std::string& extra_templates,
+                                         const std::string& extra_params, const std::string& terminator) {
+    ctx_ << "template<typename Visitor" + extra_templates + ">" << endl;
+    ctx_ << "void " + name + "(const uint8_t*& data, const uint8_t* end, Visitor& visitor" + extra_params + ")" +
+            terminator << endl;
+}
+
+void CppVisitorGenerator::emit_declarations() {
+    // Declared up front: types may nest each other in any order
+    for (size_t i = 0; i < bundle_->structs.size(); ++i) {
+        if (!struct_visitable_[i]) {
+            continue;
+        }
+        const auto& name = bundle_->structs[i].name;
+        ctx_ << "/**" << endl;
+        ctx_ << " * Decode " + name + " and report its fields to visitor; no " + name + " is built." << endl;
+        ctx_ << " * @throws ConstraintViolation or std::runtime_error, as " + name + "::read() does" << endl;
+        ctx_ << " */" << endl;
+        emit_signature("parse_" + name, "", "", ";");
+        ctx_ << blank;
+    }
+    for (size_t i = 0; i < bundle_->unions.size(); ++i) {
+        if (!union_visitable_[i]) {
+            continue;
+        }
+        const auto& name = bundle_->unions[i].name;
+        ctx_ << "/**" << endl;
+        ctx_ << " * Decode union " + name + " and report the matching branch to visitor." << endl;
+        ctx_ << " * @param parent Enclosing fields that branch constraints refer to" << endl;
+        ctx_ << " */" << endl;
+        emit_signature("parse_" + name, ", typename ParentT = void", ", const ParentT* parent = nullptr", ";");
+        ctx_ << blank;
+    }
+    for (size_t i = 0; i < bundle_->choices.size(); ++i) {
+        if (!choice_visitable_[i]) {
+            continue;
+        }
+        const auto& choice_def = bundle_->choices[i];
+        bool is_inline = !choice_def.selector.has_value() && choice_def.inferred_discriminator_type.has_value();
+        ctx_ << "/**" << endl;
+        ctx_ << " * Decode choice " + choice_def.name + " and report the selected case to visitor." << endl;
+        ctx_ << " */" << endl;
+        if (is_inline) {
+            emit_signature("parse_" + choice_def.name, "", "", ";");
+        } else {
+            emit_signature("parse_" + choice_def.name, ", typename SelectorType", ", SelectorType selector_value", ";");
+        }
+        ctx_ << blank;
+    }
+}
+
+// ============================================================================
+// Parse Functions
+// ============================================================================
+
+void CppVisitorGenerator::emit_struct(const ir::struct_def& struct_def) {
+    owner_ = struct_def.name;
+    temp_counter_ = 0;
+    auto fields = field_list(struct_def.fields);
+    select_needed(fields);
+
+    emit_signature("parse_" + struct_def.name, "", "", " {");
+    ctx_.writer().indent();
+    if (fields.empty()) {
+        ctx_ << "(void)visitor;" << endl;
+    }
+    emit_frame(fields);
+    bool positions = std::any_of(fields.begin(), fields.end(), [](const ir::field* f) {
+        return f->label.has_value() || f->alignment.has_value();
+    });
+    if (positions) {
+        ctx_ << "const uint8_t* start = data;  // Labels and alignment are relative to the struct start" << endl;
+    }
+    emit_fields(fields);
+    emit_checkpoint();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppVisitorGenerator::emit_union(const ir::union_def& union_def) {
+    owner_ = union_def.name;
+    std::vector<const ir::field*> branches;
+    std::vector<const ir::union_case*> branch_cases;
+    for (const auto& union_case : union_def.cases) {
+        for (const auto& field : union_case.fields) {
+            branches.push_back(&field);
+            branch_cases.push_back(&union_case);
+        }
+    }
+
+    // All cases conditional: no branch matching leaves the union unset
+    bool is_optional = std::all_of(union_def.cases.begin(), union_def.cases.end(),
+                                   [](const ir::union_case& c) { return c.condition.has_value(); });
+
+    // One function per branch; constraints see the enclosing struct as parent->
+    ExprContext saved = expr_context_;
+    expr_context_.use_parent_context = true;
+    for (size_t i = 0; i < branches.size(); ++i) {
+        const auto& field = *branches[i];
+        expr_context_.current_field_name = field.name;
+        expr_context_.block_members = CppExpressionRenderer::block_members(*branch_cases[i], *bundle_);
+        temp_counter_ = 0;
+        select_needed({&field});
+        if (branch_cases[i]->condition) {
+            // The case condition is checked after the branch, against its local
+            std::set<std::string> names;
+            bool calls = false;
+            collect_refs(*branch_cases[i]->condition, names, calls);
+            for (const auto& name : names) {
+                if (name == field.name || expr_context_.block_members.count(name)) {
+                    needed_.insert(field.name);
+                }
+            }
+        }
+        needed_.erase(std::string());
+
+        emit_signature("parse_" + union_def.name + "_as_" + field.name, ", typename ParentT",
+                       ", const ParentT* parent", " {");
+        ctx_.writer().indent();
+        ctx_ << "(void)parent;" << endl;
+        emit_frame({&field});
+        if (field.label || field.alignment) {
+            ctx_ << "const uint8_t* start = data;" << endl;
+        }
+        emit_fields({&field});
+        if (branch_cases[i]->condition) {
+            ctx_.start_if("!(" + render_expr(*branch_cases[i]->condition) + ")");
+            ctx_ << "throw ConstraintViolation(\"Union case condition failed for '" + field.name + "'\");" << endl;
+            ctx_.end_if();
+        }
+        emit_checkpoint();
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        ctx_ << blank;
+    }
+    expr_context_ = saved;
+
+    // Trial decoding: each branch but the last is first checked against a
+    // visitor that handles nothing, so the real visitor sees one branch only
+    emit_signature("parse_" + union_def.name, ", typename ParentT", ", const ParentT* parent", " {");
+    ctx_.writer().indent();
+    if (branches.empty()) {
+        ctx_ << "(void)data;" << endl;
+        ctx_ << "(void)end;" << endl;
+        ctx_ << "(void)visitor;" << endl;
+        ctx_ << "(void)parent;" << endl;
+    } else {
+        bool trials = branches.size() > 1 || is_optional;
+        if (trials) {
+            ctx_ << "visit::null_visitor trial;" << endl;
+        }
+        for (size_t i = 0; i < branches.size(); ++i) {
+            const std::string function = "parse_" + union_def.name + "_as_" + branches[i]->name;
+            const std::string tag = "fields::" + union_def.name + "::" + branches[i]->name;
+            bool is_last = (i + 1 == branches.size());
+            if (is_last && !is_optional) {
+                ctx_ << "visit::begin_choice<" + tag + ">(visitor);" << endl;
+                ctx_ << function + "(data, end, visitor, parent);" << endl;
+                ctx_ << "visit::end_choice<" + tag + ">(visitor);" << endl;
+                break;
+            }
+            ctx_.start_scope();
+            ctx_ << "const uint8_t* trial_data = data;" << endl;
+            ctx_.start_if("visit::try_branch([&] { " + function + "(trial_data, end, trial, parent); })");
+            ctx_ << "visit::begin_choice<" + tag + ">(visitor);" << endl;
+            ctx_ << function + "(data, end, visitor, parent);" << endl;
+            ctx_ << "visit::end_choice<" + tag + ">(visitor);" << endl;
+            ctx_ << "return;" << endl;
+            ctx_.end_if();
+            ctx_.end_scope();
+        }
+        if (is_optional) {
+            ctx_ << "// No branch matched - the union stays unset" << endl;
+        }
+    }
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppVisitorGenerator::emit_choice(const ir::choice_def& choice_def) {
+    owner_ = choice_def.name;
+    temp_counter_ = 0;
+    bool is_inline = !choice_def.selector.has_value() && choice_def.inferred_discriminator_type.has_value();
+    auto cases = choice_cases(choice_def);
+    select_needed(cases);
+
+    if (is_inline) {
+        emit_signature("parse_" + choice_def.name, "", "", " {");
+    } else {
+        emit_signature("parse_" + choice_def.name, ", typename SelectorType", ", SelectorType selector_value", " {");
+    }
+    ctx_.writer().indent();
+    emit_frame(cases);
+
+    bool positions = std::any_of(cases.begin(), cases.end(), [](const ir::field* f) {
+        return f->label.has_value() || f->alignment.has_value();
+    });
+    if (positions) {
+        ctx_ << "const uint8_t* start = data;" << endl;
+    }
+
+    // Anonymous blocks re-read the discriminator as their first field, and
+    // default cases treat it as part of their data
+    auto is_default = [](const ir::choice_def::case_def& c) {
+        return c.case_values.empty() && c.selector_mode == ir::case_selector_mode::exact;
+    };
+    if (is_inline) {
+        bool needs_save = std::any_of(choice_def.cases.begin(), choice_def.cases.end(), [&](const auto& c) {
+            return c.is_anonymous_block || is_default(c);
+        });
+        if (needs_save) {
+            ctx_ << "const uint8_t* saved_data_pos = data;" << endl;
+        }
+        // Read as the struct readers do (little endian)
+        const auto& discriminator = *choice_def.inferred_discriminator_type;
+        std::string read;
+        switch (discriminator.kind) {
+            case ir::type_kind::uint16: read = "read_uint16_le(data, end)"; break;
+            case ir::type_kind::uint32: read = "read_uint32_le(data, end)"; break;
+            case ir::type_kind::uint64: read = "read_uint64_le(data, end)"; break;
+            default: read = "read_uint8(data, end)"; break;
+        }
+        ctx_ << "const " + renderer_.get_type_name(discriminator) + " selector_value = " + read + ";" << endl;
+    }
+
+    // Exact and range cases first, the default case (if any) as the final else
+    std::vector<const ir::choice_def::case_def*> ordered;
+    const ir::choice_def::case_def* default_case = nullptr;
+    for (const auto& choice_case : choice_def.cases) {
+        if (is_default(choice_case)) {
+            default_case = &choice_case;
+        } else {
+            ordered.push_back(&choice_case);
+        }
+    }
+
+    auto emit_case_body = [&](const ir::choice_def::case_def& choice_case) {
+        const std::string tag = tag_name(choice_case.case_field.name);
+        if (is_inline && (choice_case.is_anonymous_block || is_default(choice_case))) {
+            ctx_ << "data = saved_data_pos;" << endl;
+        }
+        ctx_ << "visit::begin_choice<" + tag + ">(visitor);" << endl;
+        emit_fields({&choice_case.case_field});
+        ctx_ << "visit::end_choice<" + tag + ">(visitor);" << endl;
+    };
+
+    bool first = true;
+    for (const auto* choice_case : ordered) {
+        std::string condition;
+        if (choice_case->selector_mode != ir::case_selector_mode::exact) {
+            std::string op;
+            switch (choice_case->selector_mode) {
+                case ir::case_selector_mode::ge: op = " >= "; break;
+                case ir::case_selector_mode::gt: op = " > "; break;
+                case ir::case_selector_mode::le: op = " <= "; break;
+                case ir::case_selector_mode::lt: op = " < "; break;
+                case ir::case_selector_mode::ne: op = " != "; break;
+                case ir::case_selector_mode::exact: break;
+            }
+            condition = "selector_value" + op + "(" +
+                        (choice_case->range_bound ? render_expr(*choice_case->range_bound) : "0") + ")";
+        } else {
+            for (const auto& value : choice_case->case_values) {
+                if (!condition.empty()) {
+                    condition += " || ";
+                }
+                condition += "selector_value == (" + render_expr(value) + ")";
+            }
+        }
+        if (first) {
+            ctx_.start_if(condition);
+            first = false;
+        } else {
+            ctx_.start_else_if(condition);
+        }
+        emit_case_body(*choice_case);
+    }
+
+    const std::string invalid = "throw std::runtime_error(\"Invalid selector value for choice " +
+                                choice_def.name + "\");";
+    if (default_case) {
+        if (first) {
+            emit_case_body(*default_case);
+        } else {
+            ctx_.start_else();
+            emit_case_body(*default_case);
+            ctx_.end_if();
+        }
+    } else if (first) {
+        ctx_ << "(void)visitor;" << endl;
+        ctx_ << invalid << endl;
+    } else {
+        ctx_.start_else();
+        ctx_ << invalid << endl;
+        ctx_.end_if();
+    }
+    emit_checkpoint();
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+    ctx_ << blank;
+}
+
+void CppVisitorGenerator::emit_frame(const std::vector<const ir::field*>& fields) {
+    if (needed_.empty()) {
+        return;
+    }
+    ctx_ << "// Fields later expressions depend on; all others go straight to the visitor" << endl;
+    ctx_ << "struct {" << endl;
+    ctx_.writer().indent();
+    for (const auto* field : fields) {
+        if (needed_.count(field->name)) {
+            ctx_ << frame_type(field->type) + " " + field->name + "{};" << endl;
+        }
+    }
+    ctx_.writer().unindent();
+    ctx_ << "} obj;" << endl;
+}
+
+void CppVisitorGenerator::emit_fields(const std::vector<const ir::field*>& fields) {
+    size_t i = 0;
+    while (i < fields.size()) {
+        const auto& field = *fields[i];
+
+        if (field.default_value && needed_.count(field.name)) {
+            ctx_ << "obj." + field.name + " = " + render_expr(*field.default_value) + ";" << endl;
+        }
+
+        bool is_conditional = (field.condition == ir::field::runtime && field.runtime_condition.has_value());
+        if (is_conditional) {
+            ctx_.start_if(render_expr(*field.runtime_condition));
+        }
+
+        if (field.type.kind == ir::type_kind::bitfield && field.type.bit_width.has_value()) {
+            // Consecutive bitfields are read as one group, as in the struct readers
+            i = emit_bitfield_group(fields, i);
+        } else if (field.condition == ir::field::always || is_conditional) {
+            emit_field(field);
+            i++;
+        } else {
+            i++;
+        }
+
+        if (is_conditional) {
+            ctx_.end_if();
+        }
+    }
+}
+
+size_t CppVisitorGenerator::emit_bitfield_group(const std::vector<const ir::field*>& fields, size_t start_index) {
+    size_t end_index = start_index;
+    size_t total_bits = 0;
+    while (end_index < fields.size() &&
+           fields[end_index]->type.kind == ir::type_kind::bitfield &&
+           fields[end_index]->type.bit_width.has_value()) {
+        total_bits += *fields[end_index]->type.bit_width;
+        end_index++;
+    }
+
+    // The group's bytes stay in the input; each field is extracted from there
+    std::string bytes = "bitfield_bytes" + std::to_string(temp_counter_++);
+    ctx_ << "const uint8_t* " + bytes + " = data;" << endl;
+    emit_checkpoint();
+    ctx_ << "skip_bytes(data, end, " + std::to_string((total_bits + 7) / 8) + ");" << endl;
+
+    size_t bit_offset = 0;
+    for (size_t i = start_index; i < end_index; i++) {
+        const auto& field = *fields[i];
+        size_t width = *field.type.bit_width;
+        std::string value = "static_cast<" + renderer_.get_type_name(field.type) + ">(visit::extract_bits(" +
+                            bytes + ", " + std::to_string(bit_offset) + ", " + std::to_string(width) + "))";
+        if (needed_.count(field.name)) {
+            ctx_ << "obj." + field.name + " = " + value + ";" << endl;
+            emit_constraints(field);
+            value = "obj." + field.name;
+        }
+        ctx_ << "visit::field<" + tag_name(field.name) + ">(visitor, " + value + ");" << endl;
+        bit_offset += width;
+    }
+    return end_index;
+}
+
+void CppVisitorGenerator::emit_field(const ir::field& field) {
+    if (field.label) {
+        std::string offset = "label_offset" + std::to_string(temp_counter_++);
+        emit_checkpoint();
+        ctx_ << "const uint64_t " + offset + " = static_cast<uint64_t>(" + render_expr(*field.label) + ");" << endl;
+        ctx_.start_if(offset + " > static_cast<uint64_t>(end - start)");
+        ctx_ << "throw std::runtime_error(\"Label position out of bounds\");" << endl;
+        ctx_.end_if();
+        ctx_ << "data = start + " + offset + ";" << endl;
+    }
+    if (field.alignment) {
+        std::string mask = std::to_string(*field.alignment - 1);
+        std::string aligned = "aligned_offset" + std::to_string(temp_counter_++);
+        ctx_ << "const size_t " + aligned + " = (static_cast<size_t>(data - start) + " + mask + ") & ~size_t(" +
+                mask + ");" << endl;
+        ctx_.start_if(aligned + " > static_cast<size_t>(end - start)");
+        ctx_ << "throw std::runtime_error(\"Buffer underflow aligning field\");" << endl;
+        ctx_.end_if();
+        ctx_ << "data = start + " + aligned + ";" << endl;
+    }
+
+    if (is_array(field.type)) {
+        emit_array(field);
+    } else {
+        emit_value(field);
+    }
+}
+
+void CppVisitorGenerator::emit_value(const ir::field& field) {
+    const ir::type_ref& type = field.type;
+    const std::string tag = tag_name(field.name);
+    const bool needed = needed_.count(field.name) > 0;
+    const std::string target = "obj." + field.name;
+
+    if (is_composite(type)) {
+        emit_composite(type, tag, needed ? target : "");
+        if (needed) {
+            emit_constraints(field);
+        }
+        return;
+    }
+
+    bool is_text = type.kind == ir::type_kind::string || type.kind == ir::type_kind::u16_string ||
+                   type.kind == ir::type_kind::u32_string;
+    if (is_text) {
+        emit_checkpoint();
+    }
+    if (needed) {
+        ctx_ << target + " = " + read_expr(type) + ";" << endl;
+        emit_constraints(field);
+        ctx_ << "visit::field<" + tag + ">(visitor, " + target + ");" << endl;
+        return;
+    }
+
+    // Values the visitor ignores are skipped without decoding
+    std::string skip;
+    if (type.kind == ir::type_kind::string) {
+        skip = "skip_string(data, end);";
+    } else if (type.kind == ir::type_kind::u16_string) {
+        skip = "skip_wide_string<2>(data, end);";
+    } else if (type.kind == ir::type_kind::u32_string) {
+        skip = "skip_wide_string<4>(data, end);";
+    } else if (auto size = scalar_size(type)) {
+        skip = "skip_bytes(data, end, " + std::to_string(*size) + ");";
+    }
+
+    if (skip.empty()) {
+        // Subtypes are validated whether or not the visitor handles them
+        ctx_ << "visit::field<" + tag + ">(visitor, " + read_expr(type) + ");" << endl;
+        return;
+    }
+    ctx_ << "if constexpr (visit::handles<" + tag + ", Visitor>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "visit::field<" + tag + ">(visitor, " + read_expr(type) + ");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    if (!is_text) {
+        emit_checkpoint();
+    }
+    ctx_ << skip << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+void CppVisitorGenerator::emit_composite(const ir::type_ref& type, const std::string& tag,
+                                         const std::string& target) {
+    const bool visitable = has_parse_function(type);
+
+    if (!target.empty()) {
+        // Later expressions read its members: decode it whole, and walk the
+        // same bytes again for a visitor that wants the fields one by one
+        std::string pos = "nested_pos" + std::to_string(temp_counter_++);
+        if (visitable) {
+            ctx_ << "const uint8_t* " + pos + " = data;" << endl;
+        }
+        ctx_ << target + " = " + read_call(type) + ";" << endl;
+        if (!visitable) {
+            ctx_ << "visit::field<" + tag + ">(visitor, " + target + ");" << endl;
+            return;
+        }
+        ctx_ << "if constexpr (visit::handles<" + tag + ", Visitor>) {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "visit::field<" + tag + ">(visitor, " + target + ");" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "} else {" << endl;
+        ctx_.writer().indent();
+        ctx_ << "visit::begin_struct<" + tag + ">(visitor);" << endl;
+        ctx_ << parse_call(type, pos) + ";" << endl;
+        ctx_ << "visit::end_struct<" + tag + ">(visitor);" << endl;
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+        return;
+    }
+
+    if (!visitable) {
+        ctx_ << "visit::field<" + tag + ">(visitor, " + read_call(type) + ");" << endl;
+        return;
+    }
+    ctx_ << "if constexpr (visit::handles<" + tag + ", Visitor>) {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "visit::field<" + tag + ">(visitor, " + read_call(type) + ");" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "} else {" << endl;
+    ctx_.writer().indent();
+    ctx_ << "visit::begin_struct<" + tag + ">(visitor);" << endl;
+    ctx_ << parse_call(type, "data") + ";" << endl;
+    ctx_ << "visit::end_struct<" + tag + ">(visitor);" << endl;
+    ctx_.writer().unindent();
+    ctx_ << "}" << endl;
+}
+
+void CppVisitorGenerator::emit_array(const ir::field& field) {
+    const ir::type_ref& type = field.type;
+    const ir::type_ref& element = *type.element_type;
+    const std::string tag = tag_name(field.name);
+    const bool needed = needed_.count(field.name) > 0;
+    const std::string target = "obj." + field.name;
+
+    // Element count: constant, counted or (T[]) up to the end of the input
+    std::optional<std::string> count;
+    if (type.array_size_expr) {
+        count = "static_cast<size_t>(" + render_expr(*type.array_size_expr) + ")";
+    } else if (type.array_size) {
+        count = std::to_string(*type.array_size);
+    }
+
+    ctx_.start_scope();
+    if (count) {
+        ctx_ << "const size_t count = " + *count + ";" << endl;
+        if (type.kind == ir::type_kind::array_ranged && type.min_size_expr && type.max_size_expr) {
+            ctx_.start_if("count < static_cast<size_t>(" + render_expr(*type.min_size_expr) +
+                          ") || count > static_cast<size_t>(" + render_expr(*type.max_size_expr) + ")");
+            ctx_ << "throw std::runtime_error(\"Array size out of range\");" << endl;
+            ctx_.end_if();
+        }
+    }
+    emit_checkpoint();
+    ctx_ << "visit::begin_array<" + tag + ">(visitor, " + (count ? "count" : "visit::unknown_count") + ");" << endl;
+
+    auto start_loop = [&]() {
+        if (count) {
+            ctx_.start_for("size_t i = 0", "i < count", "++i");
+        } else {
+            ctx_.start_while("data < end");
+        }
+    };
+    auto end_loop = [&]() {
+        if (count) {
+            ctx_.end_for();
+        } else {
+            ctx_.end_while();
+        }
+    };
+
+    auto size = scalar_size(element);
+    if (needed) {
+        // Kept for later expressions; every element is still reported
+        if (count) {
+            ctx_ << target + ".reserve(count);" << endl;
+        }
+        start_loop();
+        if (is_composite(element)) {
+            ctx_ << target + ".push_back(" + read_call(element) + ");" << endl;
+        } else {
+            ctx_ << target + ".push_back(" + read_expr(element) + ");" << endl;
+        }
+        ctx_ << "visit::field<" + tag + ">(visitor, " + target + ".back());" << endl;
+        end_loop();
+        emit_constraints(field);
+    } else if (size || element.kind == ir::type_kind::string || element.kind == ir::type_kind::u16_string ||
+               element.kind == ir::type_kind::u32_string) {
+        ctx_ << "if constexpr (visit::handles<" + tag + ", Visitor>) {" << endl;
+        ctx_.writer().indent();
+        start_loop();
+        ctx_ << "visit::field<" + tag + ">(visitor, " + read_expr(element) + ");" << endl;
+        end_loop();
+        ctx_.writer().unindent();
+        ctx_ << "} else {" << endl;
+        ctx_.writer().indent();
+        if (size) {
+            // A T[] whose tail is not a whole element underflows, as in the struct readers
+            std::string elements = count ? "count"
+                : "(static_cast<size_t>(end - data) + " + std::to_string(*size - 1) + ") / " + std::to_string(*size);
+            ctx_ << "skip_array(data, end, " + elements + ", " + std::to_string(*size) + ");" << endl;
+        } else {
+            std::string skip = element.kind == ir::type_kind::string ? "skip_string(data, end);"
+                : element.kind == ir::type_kind::u16_string ? "skip_wide_string<2>(data, end);"
+                : "skip_wide_string<4>(data, end);";
+            start_loop();
+            ctx_ << skip << endl;
+            end_loop();
+        }
+        ctx_.writer().unindent();
+        ctx_ << "}" << endl;
+    } else {
+        start_loop();
+        emit_element(element, tag, "");
+        end_loop();
+    }
+
+    ctx_ << "visit::end_array<" + tag + ">(visitor);" << endl;
+    ctx_.end_scope();
+}
+
+void CppVisitorGenerator::emit_element(const ir::type_ref& element, const std::string& tag,
+                                       const std::string& target) {
+    if (is_composite(element)) {
+        emit_composite(element, tag, target);
+    } else {
+        ctx_ << "visit::field<" + tag + ">(visitor, " + read_expr(element) + ");" << endl;
+    }
+}
+
+void CppVisitorGenerator::emit_constraints(const ir::field& field) {
+    std::vector<std::pair<std::string, std::string>> checks;
+    if (field.inline_constraint) {
+        checks.emplace_back(render_expr(*field.inline_constraint),
+                            "Constraint violation for field '" + field.name + "'");
+    }
+    for (const auto& application : field.constraints) {
+        if (application.constraint_index < bundle_->constraints.size()) {
+            const auto& constraint = bundle_->constraints[application.constraint_index];
+            checks.emplace_back(render_expr(constraint.condition),
+                                "Constraint '" + constraint.name + "' violated: " + constraint.error_message_template);
+        }
+    }
+
+    for (const auto& [condition, message] : checks) {
+        const std::string fail = "throw ConstraintViolation(\"" + message + "\");";
+        if (condition.find("parent->") != std::string::npos) {
+            // Union branch constraints on the enclosing struct apply only when one is passed
+            ctx_ << "if constexpr (!std::is_void_v<ParentT>) {" << endl;
+            ctx_.writer().indent();
+            ctx_.start_if("parent != nullptr && !(" + condition + ")");
+            ctx_ << fail << endl;
+            ctx_.end_if();
+            ctx_.writer().unindent();
+            ctx_ << "}" << endl;
+        } else {
+            ctx_.start_if("!(" + condition + ")");
+            ctx_ << fail << endl;
+            ctx_.end_if();
+        }
+    }
+}
+
+void CppVisitorGenerator::emit_checkpoint() {
+    // Padded readers may run past end; catch that before skips and seeks trust it
+    if (renderer_.is_padded_input_enabled()) {
+        ctx_ << "check_input_end(data, end);" << endl;
+    }
+}
+
+// ============================================================================
+// Types
+// ============================================================================
+
+std::string CppVisitorGenerator::tag_name(const std::string& field_name) const {
+    return "fields::" + owner_ + "::" + field_name;
+}
+
+std::string CppVisitorGenerator::value_type(const ir::type_ref& type) const {
+    if (is_array(type)) {
+        return value_type(*type.element_type);
+    }
+    switch (type.kind) {
+        case ir::type_kind::string:
+            return "std::string_view";
+        case ir::type_kind::struct_type:
+        case ir::type_kind::union_type:
+        case ir::type_kind::choice_type:
+        case ir::type_kind::enum_type:
+        case ir::type_kind::subtype_ref:
+            // Qualified: tag namespaces are named after the types
+            return qualifier_ + renderer_.get_type_name(type);
+        default:
+            return renderer_.get_type_name(type);
+    }
+}
+
+std::string CppVisitorGenerator::frame_type(const ir::type_ref& type) const {
+    if (is_array(type)) {
+        return "std::vector<" + frame_type(*type.element_type) + ">";
+    }
+    if (type.kind == ir::type_kind::string) {
+        return "std::string_view";
+    }
+    return renderer_.get_type_name(type);
+}
+
+std::string CppVisitorGenerator::read_expr(const ir::type_ref& type) const {
+    // Little endian unless stated, as in the struct readers
+    std::string suffix = "_le";
+    if (type.byte_order == ir::endianness::big) {
+        suffix = "_be";
+    } else if (type.byte_order == ir::endianness::native) {
+        suffix = "";
+    }
+
+    switch (type.kind) {
+        case ir::type_kind::uint8: return "read_uint8(data, end)";
+        case ir::type_kind::uint16: return "read_uint16" + suffix + "(data, end)";
+        case ir::type_kind::uint32: return "read_uint32" + suffix + "(data, end)";
+        case ir::type_kind::uint64: return "read_uint64" + suffix + "(data, end)";
+        case ir::type_kind::int8: return "read_int8(data, end)";
+        case ir::type_kind::int16: return "read_int16" + suffix + "(data, end)";
+        case ir::type_kind::int32: return "read_int32" + suffix + "(data, end)";
+        case ir::type_kind::int64: return "read_int64" + suffix + "(data, end)";
+        case ir::type_kind::float32: return "read_float32" + suffix + "(data, end)";
+        case ir::type_kind::float64: return "read_float64" + suffix + "(data, end)";
+        case ir::type_kind::boolean: return "(read_uint8(data, end) != 0)";
+        case ir::type_kind::string: return "visit::read_string_view(data, end)";
+        case ir::type_kind::u16_string:
+        case ir::type_kind::u32_string: {
+            std::string name = type.kind == ir::type_kind::u16_string ? "read_u16string" : "read_u32string";
+            name += type.byte_order == ir::endianness::big ? "_be" : "_le";
+            if (renderer_.is_utf8_strings_enabled()) {
+                name += "_utf8";
+            }
+            return name + "(data, end)";
+        }
+        case ir::type_kind::enum_type: {
+            const auto& enum_def = bundle_->enums.at(*type.type_index);
+            return "static_cast<" + enum_def.name + ">(" + read_expr(enum_def.base_type) + ")";
+        }
+        case ir::type_kind::subtype_ref:
+            return "read_" + renderer_.get_type_name(type) + "(data, end)";
+        default:
+            return read_call(type);
+    }
+}
+
+std::string CppVisitorGenerator::read_call(const ir::type_ref& type) const {
+    const std::string name = renderer_.get_type_name(type);
+    if (type.kind == ir::type_kind::union_type) {
+        bool uses_parent = !parent_refs(bundle_->unions.at(*type.type_index)).empty();
+        return name + "::read(data, end" + (uses_parent ? ", &obj" : "") + ")";
+    }
+    if (type.kind == ir::type_kind::choice_type) {
+        const auto& choice_def = bundle_->choices.at(*type.type_index);
+        if (choice_def.inferred_discriminator_type.has_value()) {
+            return name + "::read(data, end)";
+        }
+        return name + "::read(data, end, " + selector_args(type) + ")";
+    }
+    return name + "::read(data, end)";
+}
+
+std::string CppVisitorGenerator::parse_call(const ir::type_ref& type, const std::string& data_var) const {
+    const std::string call = "parse_" + renderer_.get_type_name(type) + "(" + data_var + ", end, visitor";
+    if (type.kind == ir::type_kind::union_type) {
+        bool uses_parent = !parent_refs(bundle_->unions.at(*type.type_index)).empty();
+        return call + (uses_parent ? ", &obj)" : ")");
+    }
+    if (type.kind == ir::type_kind::choice_type) {
+        const auto& choice_def = bundle_->choices.at(*type.type_index);
+        if (!choice_def.selector.has_value() && choice_def.inferred_discriminator_type.has_value()) {
+            return call + ")";
+        }
+        return call + ", " + selector_args(type) + ")";
+    }
+    return call + ")";
+}
+
+std::optional<size_t> CppVisitorGenerator::scalar_size(const ir::type_ref& type) const {
+    switch (type.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::int8:
+        case ir::type_kind::boolean:
+            return 1;
+        case ir::type_kind::uint16:
+        case ir::type_kind::int16:
+            return 2;
+        case ir::type_kind::uint32:
+        case ir::type_kind::int32:
+        case ir::type_kind::float32:
+            return 4;
+        case ir::type_kind::uint64:
+        case ir::type_kind::int64:
+        case ir::type_kind::float64:
+            return 8;
+        case ir::type_kind::enum_type:
+            return scalar_size(bundle_->enums.at(*type.type_index).base_type);
+        default:
+            return std::nullopt;  // Variable size, or validated on every read (subtypes)
+    }
+}
+
+// ============================================================================
+// Expressions
+// ============================================================================
+
+std::string CppVisitorGenerator::render_expr(const ir::expr& expr) const {
+    CppExpressionRenderer expr_renderer(expr_context_, bundle_);
+    return expr_renderer.render(expr);
+}
+
+std::string CppVisitorGenerator::selector_args(const ir::type_ref& type) const {
+    if (!type.choice_selector_args.empty()) {
+        std::string args;
+        for (const auto& arg : type.choice_selector_args) {
+            if (!args.empty()) {
+                args += ", ";
+            }
+            args += render_expr(*arg);
+        }
+        return args;
+    }
+
+    // The selector names a field of the enclosing struct
+    const auto& choice_def = bundle_->choices.at(*type.type_index);
+    ir::expr selector;
+    selector.type = ir::expr::field_ref;
+    selector.ref_name = choice_def.selector->ref_name;
+    return render_expr(selector);
+}
+
+}  // namespace datascript::codegen
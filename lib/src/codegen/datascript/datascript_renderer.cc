@@ -11,7 +11,7 @@ const std::set<std::string> DataScriptRenderer::keywords_ = {
     "true", "false", "this", "little", "big", "bit",
     "uint8", "uint16", "uint32", "uint64", "uint128",
     "int8", "int16", "int32", "int64", "int128",
-    "string", "bool"
+    "float32", "float64", "string", "bool"
 };
 
 DataScriptRenderer::DataScriptRenderer() = default;
@@ -147,6 +147,8 @@ std::string DataScriptRenderer::get_type_name(const ir::type_ref& type) const {
         case ir::type_kind::int32: oss << "int32"; break;
         case ir::type_kind::int64: oss << "int64"; break;
         case ir::type_kind::int128: oss << "int128"; break;
+        case ir::type_kind::float32: oss << "float32"; break;
+        case ir::type_kind::float64: oss << "float64"; break;
         case ir::type_kind::boolean: oss << "bool"; break;
         case ir::type_kind::string: oss << "string"; break;
         case ir::type_kind::u16_string: oss << "u16string"; break;
@@ -303,6 +305,28 @@ void DataScriptRenderer::render_subtype(const ir::subtype_def& s) {
 }
 
 void DataScriptRenderer::render_field(const ir::field& f) {
+    // Array transform / substream directive precedes the field (and its doc comment)
+    switch (f.transform) {
+        case ir::array_transform::none: break;
+        case ir::array_transform::delta: writer_->write_line("@delta"); break;
+        case ir::array_transform::delta_of_delta: writer_->write_line("@delta_of_delta"); break;
+        case ir::array_transform::zigzag_delta: writer_->write_line("@zigzag_delta"); break;
+    }
+    if (f.substream) {
+        const char* name = "xor";
+        switch (f.substream->transform) {
+            case ir::byte_transform::xor_key: name = "xor"; break;
+            case ir::byte_transform::rotate_left: name = "rol"; break;
+            case ir::byte_transform::rotate_right: name = "ror"; break;
+            case ir::byte_transform::zlib: name = "zlib"; break;
+        }
+        std::string directive = std::string("@") + name + "(" + render_expr(f.substream->size);
+        if (f.substream->parameter) {
+            directive += ", " + render_expr(*f.substream->parameter);
+        }
+        writer_->write_line(directive + ")");
+    }
+
     if (!f.documentation.empty()) {
         render_doc_comment(f.documentation);
     }
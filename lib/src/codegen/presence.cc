@@ -0,0 +1,343 @@
+//
+// Conditional Field Presence Planning
+//
+// Assigns presence bits to runtime-conditional fields and decides which of
+// them a generated struct stores out of line.
+//
+
+#include <datascript/codegen/presence.hh>
+#include <datascript/codegen/projection.hh>
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace datascript::codegen {
+
+namespace {
+
+    // Every name an expression may resolve against an object: the first
+    // segment of field paths ("header.len" -> "header") and bare identifiers
+    void add_expr_refs(const ir::expr& e, std::set<std::string>& names) {
+        if (e.type == ir::expr::field_ref || e.type == ir::expr::parameter_ref) {
+            names.insert(e.ref_name.substr(0, e.ref_name.find_first_of(".[")));
+        }
+        for (const ir::expr* child : {e.left.get(), e.right.get(), e.condition.get(),
+                                      e.true_expr.get(), e.false_expr.get()}) {
+            if (child) {
+                add_expr_refs(*child, names);
+            }
+        }
+        for (const auto& argument : e.arguments) {
+            add_expr_refs(*argument, names);
+        }
+    }
+
+    void add_type_refs(const ir::type_ref& type, std::set<std::string>& names) {
+        for (const ir::expr* e : {type.array_size_expr.get(), type.min_size_expr.get(),
+                                  type.max_size_expr.get()}) {
+            if (e) {
+                add_expr_refs(*e, names);
+            }
+        }
+        for (const auto& argument : type.choice_selector_args) {
+            add_expr_refs(*argument, names);
+        }
+        if (type.element_type) {
+            add_type_refs(*type.element_type, names);
+        }
+    }
+
+    void add_field_refs(const ir::field& field, std::set<std::string>& names) {
+        for (const auto* e : {field.runtime_condition ? &*field.runtime_condition : nullptr,
+                              field.label ? &*field.label : nullptr,
+                              field.default_value ? &*field.default_value : nullptr,
+                              field.inline_constraint ? &*field.inline_constraint : nullptr}) {
+            if (e) {
+                add_expr_refs(*e, names);
+            }
+        }
+        for (const auto& application : field.constraints) {
+            for (const auto& argument : application.arguments) {
+                add_expr_refs(argument, names);
+            }
+        }
+        if (field.substream) {
+            add_expr_refs(field.substream->size, names);
+            if (field.substream->parameter) {
+                add_expr_refs(*field.substream->parameter, names);
+            }
+        }
+        add_type_refs(field.type, names);
+    }
+
+    // Names referenced anywhere in the module. Union conditions reach into
+    // their parent struct and functions into their own, so a field is only
+    // safe to wrap if no expression at all can name it.
+    std::set<std::string> referenced_names(const ir::bundle& bundle) {
+        std::set<std::string> names;
+        for (const auto& struct_def : bundle.structs) {
+            for (const auto& field : struct_def.fields) {
+                add_field_refs(field, names);
+            }
+            for (const auto& function : struct_def.functions) {
+                for (const auto& statement : function.body) {
+                    std::visit([&](const auto& s) {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(s)>, ir::return_statement>) {
+                            add_expr_refs(s.value, names);
+                        } else {
+                            add_expr_refs(s.expression, names);
+                        }
+                    }, statement);
+                }
+            }
+        }
+        for (const auto& union_def : bundle.unions) {
+            for (const auto& union_case : union_def.cases) {
+                if (union_case.condition) {
+                    add_expr_refs(*union_case.condition, names);
+                }
+                for (const auto& field : union_case.fields) {
+                    add_field_refs(field, names);
+                }
+            }
+        }
+        for (const auto& choice_def : bundle.choices) {
+            if (choice_def.selector) {
+                add_expr_refs(*choice_def.selector, names);
+            }
+            for (const auto& choice_case : choice_def.cases) {
+                for (const auto& value : choice_case.case_values) {
+                    add_expr_refs(value, names);
+                }
+                if (choice_case.range_bound) {
+                    add_expr_refs(*choice_case.range_bound, names);
+                }
+                add_field_refs(choice_case.case_field, names);
+            }
+        }
+        for (const auto& constraint : bundle.constraints) {
+            add_expr_refs(constraint.condition, names);
+        }
+        return names;
+    }
+
+    bool is_large_kind(ir::type_kind kind) {
+        switch (kind) {
+            case ir::type_kind::string:
+            case ir::type_kind::u16_string:
+            case ir::type_kind::u32_string:
+            case ir::type_kind::struct_type:
+            case ir::type_kind::union_type:
+            case ir::type_kind::choice_type:
+            case ir::type_kind::array_fixed:
+            case ir::type_kind::array_variable:
+            case ir::type_kind::array_ranged:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool stores_out_of_line(const ir::bundle& bundle, const ir::field& field,
+                            const std::set<std::string>& referenced) {
+        if (!is_large_kind(field.type.kind) || referenced.count(field.name) ||
+            field.substream || field.default_value || field.inline_constraint || !field.constraints.empty()) {
+            return false;
+        }
+        auto size = fixed_wire_size(&bundle, field.type);
+        return !size || *size >= PresencePlan::out_of_line_min_bytes;
+    }
+
+    // Name of the struct, union or choice a type (or its array element) refers to
+    const std::string* nested_type_name(const ir::bundle& bundle, const ir::type_ref& type) {
+        if (type.element_type) {
+            return nested_type_name(bundle, *type.element_type);
+        }
+        if (!type.type_index) {
+            return nullptr;
+        }
+        size_t index = *type.type_index;
+        if (type.kind == ir::type_kind::struct_type && index < bundle.structs.size()) {
+            return &bundle.structs[index].name;
+        }
+        if (type.kind == ir::type_kind::union_type && index < bundle.unions.size()) {
+            return &bundle.unions[index].name;
+        }
+        if (type.kind == ir::type_kind::choice_type && index < bundle.choices.size()) {
+            return &bundle.choices[index].name;
+        }
+        return nullptr;
+    }
+
+    // has_<field>, moved aside with trailing underscores when the struct
+    // declares a member of that name ("uint8 has_name; string name if has_name;")
+    std::string presence_accessor(const ir::struct_def& struct_def, const std::string& field_name) {
+        std::set<std::string> taken = {"presence_"};
+        for (const auto& field : struct_def.fields) {
+            taken.insert(field.name);
+        }
+        for (const auto& function : struct_def.functions) {
+            taken.insert(function.name);
+        }
+        std::string accessor = "has_" + field_name;
+        while (taken.count(accessor)) {
+            accessor += "_";
+        }
+        return accessor;
+    }
+
+}
+
+conditional_storage parse_conditional_storage(const std::string& name) {
+    if (name == "inline") {
+        return conditional_storage::inline_value;
+    }
+    if (name == "optional") {
+        return conditional_storage::optional;
+    }
+    if (name == "boxed") {
+        return conditional_storage::boxed;
+    }
+    throw std::invalid_argument("conditional-storage must be inline, optional or boxed, not '" + name + "'");
+}
+
+const conditional_member* struct_presence::find(const std::string& field_name) const {
+    for (const auto& member : members) {
+        if (member.name == field_name) {
+            return &member;
+        }
+    }
+    return nullptr;
+}
+
+bool struct_presence::has_out_of_line() const {
+    for (const auto& member : members) {
+        if (member.out_of_line) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PresencePlan PresencePlan::build(const ir::bundle& bundle, conditional_storage storage) {
+    PresencePlan plan;
+    plan.storage_ = storage;
+
+    std::set<std::string> referenced;
+    if (storage != conditional_storage::inline_value) {
+        referenced = referenced_names(bundle);
+    }
+
+    for (const auto& struct_def : bundle.structs) {
+        struct_presence presence;
+        for (const auto& field : struct_def.fields) {
+            if (field.condition != ir::field::runtime || !field.runtime_condition) {
+                continue;
+            }
+            conditional_member member;
+            member.name = field.name;
+            member.accessor = presence_accessor(struct_def, field.name);
+            member.bit = presence.members.size();
+            member.out_of_line = storage != conditional_storage::inline_value &&
+                                 stores_out_of_line(bundle, field, referenced);
+            presence.members.push_back(std::move(member));
+        }
+        if (presence.members.empty()) {
+            continue;
+        }
+        if (storage == conditional_storage::boxed && presence.has_out_of_line()) {
+            plan.box_owners_.insert(struct_def.name);
+        }
+        plan.structs_[struct_def.name] = std::move(presence);
+    }
+
+    // Types holding a box owner (directly or in an array) own boxes too
+    if (!plan.box_owners_.empty()) {
+        auto holds_owner = [&](const std::vector<const ir::field*>& fields) {
+            for (const auto* field : fields) {
+                const std::string* name = nested_type_name(bundle, field->type);
+                if (name && plan.box_owners_.count(*name)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            auto visit = [&](const std::string& name, const std::vector<const ir::field*>& fields) {
+                if (!plan.box_owners_.count(name) && holds_owner(fields)) {
+                    plan.box_owners_.insert(name);
+                    changed = true;
+                }
+            };
+            for (const auto& struct_def : bundle.structs) {
+                std::vector<const ir::field*> fields;
+                for (const auto& field : struct_def.fields) {
+                    fields.push_back(&field);
+                }
+                visit(struct_def.name, fields);
+            }
+            for (const auto& union_def : bundle.unions) {
+                std::vector<const ir::field*> fields;
+                for (const auto& union_case : union_def.cases) {
+                    for (const auto& field : union_case.fields) {
+                        fields.push_back(&field);
+                    }
+                }
+                visit(union_def.name, fields);
+            }
+            for (const auto& choice_def : bundle.choices) {
+                std::vector<const ir::field*> fields;
+                for (const auto& choice_case : choice_def.cases) {
+                    fields.push_back(&choice_case.case_field);
+                }
+                visit(choice_def.name, fields);
+            }
+        }
+    }
+
+    return plan;
+}
+
+const struct_presence* PresencePlan::find(const std::string& struct_name) const {
+    auto it = structs_.find(struct_name);
+    return it == structs_.end() ? nullptr : &it->second;
+}
+
+bool PresencePlan::has_out_of_line() const {
+    for (const auto& [name, presence] : structs_) {
+        if (presence.has_out_of_line()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PresencePlan::widest_mask() const {
+    size_t widest = 0;
+    for (const auto& [name, presence] : structs_) {
+        widest = std::max(widest, presence.members.size());
+    }
+    return widest;
+}
+
+std::string presence_mask_type(size_t bit_count) {
+    if (bit_count <= 8) {
+        return "uint8_t";
+    }
+    if (bit_count <= 16) {
+        return "uint16_t";
+    }
+    if (bit_count <= 32) {
+        return "uint32_t";
+    }
+    if (bit_count <= 64) {
+        return "uint64_t";
+    }
+    return "std::bitset<" + std::to_string(bit_count) + ">";
+}
+
+}  // namespace datascript::codegen
@@ -0,0 +1,496 @@
+//
+// Projected Reader Planning
+//
+// Resolves a projection spec against the IR and decides, per field, whether
+// a projected reader decodes it or skips it.
+//
+
+#include <datascript/codegen/projection.hh>
+#include <datascript/codegen.hh>
+
+#include <set>
+
+namespace datascript::codegen {
+
+namespace {
+
+    std::vector<std::string> split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        size_t begin = 0;
+        while (true) {
+            size_t pos = text.find(separator, begin);
+            parts.push_back(text.substr(begin, pos == std::string::npos ? std::string::npos : pos - begin));
+            if (pos == std::string::npos) {
+                return parts;
+            }
+            begin = pos + 1;
+        }
+    }
+
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    std::optional<size_t> find_field(const ir::struct_def& struct_def, const std::string& name) {
+        for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+            if (struct_def.fields[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool is_string_kind(ir::type_kind kind) {
+        return kind == ir::type_kind::string ||
+               kind == ir::type_kind::u16_string ||
+               kind == ir::type_kind::u32_string;
+    }
+
+    bool is_array_kind(ir::type_kind kind) {
+        return kind == ir::type_kind::array_fixed ||
+               kind == ir::type_kind::array_variable ||
+               kind == ir::type_kind::array_ranged;
+    }
+
+    // Which fields of one struct the projected reader must decode
+    struct struct_projection {
+        std::set<size_t> decoded;  // Decoded in full
+        std::set<size_t> nested;   // Struct fields decoded with their own projection
+        bool decode_all = false;   // Something needs the whole object (e.g. a union's parent access)
+    };
+
+    class Planner {
+    public:
+        explicit Planner(const ir::bundle& bundle) : bundle_(bundle) {}
+
+        // User-requested path; malformed paths are errors
+        void request(size_t struct_index, const std::vector<std::string>& path, size_t pos) {
+            const auto& struct_def = bundle_.structs[struct_index];
+            auto field_index = find_field(struct_def, path[pos]);
+            if (!field_index) {
+                throw codegen_error("Projection: struct '" + struct_def.name +
+                                    "' has no field '" + path[pos] + "'");
+            }
+            auto& projection = projections_[struct_index];
+            if (pos + 1 == path.size()) {
+                projection.decoded.insert(*field_index);
+                return;
+            }
+            const auto& type = struct_def.fields[*field_index].type;
+            if (type.kind != ir::type_kind::struct_type || !type.type_index) {
+                throw codegen_error("Projection: field '" + struct_def.name + "." + path[pos] +
+                                    "' is not a struct, so '" + path[pos + 1] + "' cannot be selected");
+            }
+            projection.nested.insert(*field_index);
+            request(*type.type_index, path, pos + 1);
+        }
+
+        // Struct that needs a projected reader even if no field is requested
+        void require(size_t struct_index) {
+            projections_[struct_index];
+        }
+
+        // Grow every projection until all its dependencies are decoded
+        void close() {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                std::vector<size_t> indices;
+                for (const auto& [index, projection] : projections_) {
+                    indices.push_back(index);
+                }
+                for (size_t index : indices) {
+                    changed |= close_struct(index);
+                }
+            }
+        }
+
+        std::map<std::string, std::vector<field_projection>> actions() const {
+            std::map<std::string, std::vector<field_projection>> result;
+            for (const auto& [index, projection] : projections_) {
+                const auto& struct_def = bundle_.structs[index];
+                std::vector<field_projection> fields(struct_def.fields.size());
+                for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+                    fields[i] = field_action(projection, struct_def.fields[i], i);
+                }
+                result[struct_def.name] = std::move(fields);
+            }
+            return result;
+        }
+
+    private:
+        const ir::bundle& bundle_;
+        std::map<size_t, struct_projection> projections_;
+
+        // One fixpoint step for a struct; returns true if anything was added
+        bool close_struct(size_t index) {
+            const auto& struct_def = bundle_.structs[index];
+            size_t decoded_before = projections_[index].decoded.size();
+            size_t nested_before = projections_[index].nested.size();
+            size_t structs_before = projections_.size();
+
+            for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+                const auto& field = struct_def.fields[i];
+                if (field.condition == ir::field::never) {
+                    continue;
+                }
+
+                // Position and presence are needed whether the field is read or skipped
+                if (field.runtime_condition) {
+                    add_expr(index, *field.runtime_condition);
+                }
+                if (field.label) {
+                    add_expr(index, *field.label);
+                }
+                if (is_array_kind(field.type.kind) && field.type.array_size_expr) {
+                    add_expr(index, *field.type.array_size_expr);
+                }
+                if (field.substream) {
+                    add_expr(index, field.substream->size);
+                    if (field.substream->parameter) {
+                        add_expr(index, *field.substream->parameter);
+                    }
+                }
+
+                auto& projection = projections_[index];
+                if (!projection.decoded.count(i) && !projection.nested.count(i)) {
+                    classify_skipped(index, i);
+                }
+            }
+
+            if (projections_[index].decode_all) {
+                for (size_t i = 0; i < struct_def.fields.size(); ++i) {
+                    projections_[index].decoded.insert(i);
+                }
+                projections_[index].nested.clear();
+            }
+
+            // Decoded fields also need whatever their checks and selectors read
+            std::set<size_t> decoded = projections_[index].decoded;
+            for (size_t i : decoded) {
+                add_decoded_deps(index, struct_def.fields[i]);
+            }
+
+            const auto& projection = projections_[index];
+            return projection.decoded.size() != decoded_before ||
+                   projection.nested.size() != nested_before ||
+                   projections_.size() != structs_before;
+        }
+
+        // Fields nobody asked for: skip them if their size can be computed
+        // without decoding them, otherwise decode (or project) them anyway
+        void classify_skipped(size_t index, size_t field_index) {
+            const auto& field = bundle_.structs[index].fields[field_index];
+            const auto& type = field.type;
+            if (type.kind == ir::type_kind::bitfield) {
+                projections_[index].decoded.insert(field_index);  // Decoded as a group
+                return;
+            }
+            if (field.substream) {
+                projections_[index].decoded.insert(field_index);  // Captured, decoded lazily
+                return;
+            }
+            if (fixed_wire_size(&bundle_, type) || is_string_kind(type.kind)) {
+                return;
+            }
+            if (is_array_kind(type.kind) && type.array_size_expr && type.element_type &&
+                fixed_wire_size(&bundle_, *type.element_type)) {
+                return;
+            }
+            if (type.kind == ir::type_kind::struct_type && type.type_index &&
+                *type.type_index < bundle_.structs.size()) {
+                projections_[index].nested.insert(field_index);
+                projections_[*type.type_index];  // Empty projection: a pure skipper
+                return;
+            }
+            projections_[index].decoded.insert(field_index);
+        }
+
+        void add_decoded_deps(size_t index, const ir::field& field) {
+            const auto& type = field.type;
+            if (field.inline_constraint) {
+                add_expr(index, *field.inline_constraint);
+            }
+            if (field.default_value) {
+                add_expr(index, *field.default_value);
+            }
+            for (const auto& application : field.constraints) {
+                for (const auto& argument : application.arguments) {
+                    add_expr(index, argument);
+                }
+                if (application.constraint_index < bundle_.constraints.size()) {
+                    add_expr(index, bundle_.constraints[application.constraint_index].condition);
+                }
+            }
+            if (type.min_size_expr) {
+                add_expr(index, *type.min_size_expr);
+            }
+            if (type.max_size_expr) {
+                add_expr(index, *type.max_size_expr);
+            }
+            for (const auto& argument : type.choice_selector_args) {
+                add_expr(index, *argument);
+            }
+            if (type.kind == ir::type_kind::choice_type && type.type_index &&
+                *type.type_index < bundle_.choices.size() && type.choice_selector_args.empty()) {
+                const auto& selector = bundle_.choices[*type.type_index].selector;
+                if (selector && (selector->type == ir::expr::field_ref ||
+                                 selector->type == ir::expr::parameter_ref)) {
+                    add_reference(index, selector->ref_name);
+                }
+            }
+            if (type.kind == ir::type_kind::union_type) {
+                // Union readers evaluate their constraints against the parent object
+                projections_[index].decode_all = true;
+            }
+        }
+
+        void add_expr(size_t index, const ir::expr& e) {
+            std::set<std::string> visited_functions;
+            add_expr(index, e, visited_functions);
+        }
+
+        void add_expr(size_t index, const ir::expr& e, std::set<std::string>& visited_functions) {
+            switch (e.type) {
+                case ir::expr::field_ref:
+                case ir::expr::parameter_ref:  // Plain names ("size") arrive unresolved
+                    add_reference(index, e.ref_name);
+                    break;
+                case ir::expr::function_call:
+                    add_function(index, e.ref_name, visited_functions);
+                    break;
+                default:
+                    break;
+            }
+            for (const auto* child : {e.left.get(), e.right.get(), e.condition.get(),
+                                      e.true_expr.get(), e.false_expr.get()}) {
+                if (child) {
+                    add_expr(index, *child, visited_functions);
+                }
+            }
+            for (const auto& argument : e.arguments) {
+                add_expr(index, *argument, visited_functions);
+            }
+        }
+
+        // Member functions read fields through their bodies
+        void add_function(size_t index, const std::string& name, std::set<std::string>& visited_functions) {
+            auto dot = name.find('.');
+            if (dot != std::string::npos) {
+                // Function on a nested object needs that object in full
+                if (auto field_index = find_field(bundle_.structs[index], name.substr(0, dot))) {
+                    projections_[index].decoded.insert(*field_index);
+                }
+                return;
+            }
+            if (!visited_functions.insert(name).second) {
+                return;
+            }
+            for (const auto& function : bundle_.structs[index].functions) {
+                if (function.name != name) {
+                    continue;
+                }
+                for (const auto& statement : function.body) {
+                    if (auto* ret = std::get_if<ir::return_statement>(&statement)) {
+                        add_expr(index, ret->value, visited_functions);
+                    } else if (auto* expression = std::get_if<ir::expression_statement>(&statement)) {
+                        add_expr(index, expression->expression, visited_functions);
+                    }
+                }
+            }
+        }
+
+        // "count" or "header.count": decode the field, or just the nested member
+        void add_reference(size_t index, const std::string& ref_name) {
+            auto path = split(ref_name, '.');
+            size_t current = index;
+            for (size_t pos = 0; pos < path.size(); ++pos) {
+                const auto& struct_def = bundle_.structs[current];
+                auto field_index = find_field(struct_def, path[pos]);
+                if (!field_index) {
+                    return;  // Parameter, constant or enum item
+                }
+                auto& projection = projections_[current];
+                const auto& type = struct_def.fields[*field_index].type;
+                bool descend = pos + 1 < path.size() && !struct_def.fields[*field_index].substream &&
+                               type.kind == ir::type_kind::struct_type &&
+                               type.type_index && *type.type_index < bundle_.structs.size() &&
+                               find_field(bundle_.structs[*type.type_index], path[pos + 1]);
+                if (!descend) {
+                    projection.decoded.insert(*field_index);
+                    return;
+                }
+                projection.nested.insert(*field_index);
+                current = *type.type_index;
+            }
+        }
+
+        field_projection field_action(const struct_projection& projection,
+                                      const ir::field& field, size_t field_index) const {
+            field_projection result;
+            if (projection.decoded.count(field_index) || field.condition == ir::field::never) {
+                return result;
+            }
+            if (projection.nested.count(field_index)) {
+                result.action = projection_action::decode_nested;
+                return result;
+            }
+            const auto& type = field.type;
+            if (auto size = fixed_wire_size(&bundle_, type)) {
+                result.action = projection_action::skip_fixed;
+                result.byte_size = *size;
+            } else if (is_string_kind(type.kind)) {
+                result.action = projection_action::skip_string;
+            } else if (is_array_kind(type.kind) && type.array_size_expr && type.element_type) {
+                result.action = projection_action::skip_elements;
+                result.byte_size = fixed_wire_size(&bundle_, *type.element_type).value_or(0);
+            }
+            return result;
+        }
+    };
+
+}  // namespace
+
+// ============================================================================
+// ProjectionPlan
+// ============================================================================
+
+ProjectionPlan ProjectionPlan::build(const ir::bundle& bundle, const std::string& spec,
+                                     const std::vector<std::string>& boundary_structs) {
+    ProjectionPlan plan;
+    if (trim(spec).empty() && boundary_structs.empty()) {
+        return plan;
+    }
+
+    auto find_struct = [&](const std::string& name) -> std::optional<size_t> {
+        for (size_t i = 0; i < bundle.structs.size(); ++i) {
+            if (bundle.structs[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    };
+
+    Planner planner(bundle);
+    for (const auto& entry : split(spec, ';')) {
+        if (trim(entry).empty()) {
+            continue;
+        }
+        auto eq = entry.find('=');
+        if (eq == std::string::npos) {
+            throw codegen_error("Projection: expected 'Type=field,...' but got '" + trim(entry) + "'");
+        }
+        std::string struct_name = trim(entry.substr(0, eq));
+        auto struct_index = find_struct(struct_name);
+        if (!struct_index) {
+            throw codegen_error("Projection: unknown struct '" + struct_name + "'");
+        }
+        for (const auto& path_text : split(entry.substr(eq + 1), ',')) {
+            std::string path = trim(path_text);
+            if (path.empty()) {
+                throw codegen_error("Projection: empty field path for struct '" + struct_name + "'");
+            }
+            planner.request(*struct_index, split(path, '.'), 0);
+        }
+    }
+
+    for (const auto& struct_name : boundary_structs) {
+        auto struct_index = find_struct(struct_name);
+        if (!struct_index) {
+            throw codegen_error("Record index: unknown struct '" + struct_name + "'");
+        }
+        planner.require(*struct_index);
+    }
+
+    planner.close();
+    plan.readers_ = planner.actions();
+    return plan;
+}
+
+const std::vector<field_projection>* ProjectionPlan::find(const ir::struct_def& struct_def) const {
+    auto it = readers_.find(struct_def.name);
+    return it == readers_.end() ? nullptr : &it->second;
+}
+
+// ============================================================================
+// Fixed Wire Sizes
+// ============================================================================
+
+std::optional<size_t> fixed_wire_size(const ir::bundle* module, const ir::type_ref& type, size_t depth) {
+    // Guard against pathological nesting
+    if (depth > 64) {
+        return std::nullopt;
+    }
+
+    switch (type.kind) {
+        case ir::type_kind::uint8:
+        case ir::type_kind::int8:
+        case ir::type_kind::boolean:
+            return 1;
+        case ir::type_kind::uint16:
+        case ir::type_kind::int16:
+            return 2;
+        case ir::type_kind::uint32:
+        case ir::type_kind::int32:
+        case ir::type_kind::float32:
+            return 4;
+        case ir::type_kind::uint64:
+        case ir::type_kind::int64:
+        case ir::type_kind::float64:
+            return 8;
+        case ir::type_kind::uint128:
+        case ir::type_kind::int128:
+            return 16;
+        case ir::type_kind::enum_type:
+            if (module && type.type_index && *type.type_index < module->enums.size()) {
+                return fixed_wire_size(module, module->enums[*type.type_index].base_type, depth + 1);
+            }
+            return std::nullopt;
+        case ir::type_kind::subtype_ref:
+            if (module && type.type_index && *type.type_index < module->subtypes.size()) {
+                return fixed_wire_size(module, module->subtypes[*type.type_index].base_type, depth + 1);
+            }
+            return std::nullopt;
+        case ir::type_kind::struct_type:
+            if (module && type.type_index && *type.type_index < module->structs.size()) {
+                return fixed_wire_size(module, module->structs[*type.type_index], depth + 1);
+            }
+            return std::nullopt;
+        case ir::type_kind::array_fixed:
+            if (type.element_type && type.array_size) {
+                auto element_size = fixed_wire_size(module, *type.element_type, depth + 1);
+                if (element_size) {
+                    return *element_size * static_cast<size_t>(*type.array_size);
+                }
+            }
+            return std::nullopt;
+        default:
+            // Strings, bitfields, unions, choices and runtime-sized arrays
+            return std::nullopt;
+    }
+}
+
+std::optional<size_t> fixed_wire_size(const ir::bundle* module, const ir::struct_def& struct_def, size_t depth) {
+    size_t total = 0;
+    for (const auto& field : struct_def.fields) {
+        if (field.condition == ir::field::never) {
+            continue;
+        }
+        if (field.condition != ir::field::always || field.label || field.alignment || field.substream) {
+            return std::nullopt;
+        }
+        auto size = fixed_wire_size(module, field.type, depth);
+        if (!size) {
+            return std::nullopt;
+        }
+        total += *size;
+    }
+    return total;
+}
+
+}  // namespace datascript::codegen
@@ -69,6 +69,13 @@ endianness ast_endianness_to_ir(ast::endian e) {
     }
 }
 
+array_transform ast_transform_to_ir(const ast::transform_directive& t) {
+    if (t.name == "delta") return array_transform::delta;
+    if (t.name == "delta_of_delta") return array_transform::delta_of_delta;
+    if (t.name == "zigzag_delta") return array_transform::zigzag_delta;
+    return array_transform::none;  // Rejected in Phase 3
+}
+
 case_selector_mode ast_selector_kind_to_ir(ast::case_selector_kind kind) {
     switch (kind) {
         case ast::case_selector_kind::exact:    return case_selector_mode::exact;
@@ -140,6 +147,9 @@ struct monomorphization_context {
     std::vector<struct_def> wrapper_structs;
 
     // Cache: (base_type, args) -> index in concrete_structs/concrete_unions
+    // This is the only sharing the IR needs: every field owns a single type and
+    // expression tree, so hash-consing nodes would save no copies, and shared
+    // nodes would break the unique_ptr ownership IR consumers rely on.
     std::map<monomorphization_key, size_t> struct_cache;
     std::map<monomorphization_key, size_t> union_cache;
 
@@ -173,10 +183,12 @@ size_t calculate_struct_alignment(const std::vector<field>& fields) {
                 break;
             case type_kind::uint32:
             case type_kind::int32:
+            case type_kind::float32:
                 field_align = 4;
                 break;
             case type_kind::uint64:
             case type_kind::int64:
+            case type_kind::float64:
                 field_align = 8;
                 break;
             case type_kind::uint128:
@@ -219,11 +231,13 @@ size_t calculate_struct_size(const std::vector<field>& fields) {
                 break;
             case type_kind::uint32:
             case type_kind::int32:
+            case type_kind::float32:
                 field_size = 4;
                 field_align = 4;
                 break;
             case type_kind::uint64:
             case type_kind::int64:
+            case type_kind::float64:
                 field_size = 8;
                 field_align = 8;
                 break;
@@ -264,6 +278,63 @@ size_t calculate_struct_size(const std::vector<field>& fields) {
     return total_size;
 }
 
+/**
+ * Look up the wire size and heap bounds semantic analysis computed for a
+ * struct, union or choice definition.
+ */
+std::optional<size_bounds> find_size_bounds(const semantic::analyzed_module_set& analyzed,
+                                            const semantic::analyzed_module_set::resolved_type& def) {
+    auto it = analyzed.type_bounds.find(def);
+    if (it == analyzed.type_bounds.end()) {
+        return std::nullopt;
+    }
+    return size_bounds{it->second.min_size, it->second.max_size, it->second.max_heap_bytes};
+}
+
+/**
+ * Copy the element count bounds semantic analysis computed for the
+ * runtime-length array fields of a definition onto the IR fields.
+ */
+void apply_array_bounds(const semantic::analyzed_module_set& analyzed,
+                        const semantic::analyzed_module_set::resolved_type& def,
+                        const std::vector<field*>& fields) {
+    auto it = analyzed.type_bounds.find(def);
+    if (it == analyzed.type_bounds.end()) {
+        return;
+    }
+    for (const auto& array : it->second.arrays) {
+        for (field* f : fields) {
+            if (f->name == array.field) {
+                f->max_count = array.max_count;
+            }
+        }
+    }
+}
+
+/**
+ * Pointers to the fields of every union case.
+ */
+std::vector<field*> case_fields(std::vector<union_case>& cases) {
+    std::vector<field*> fields;
+    for (auto& union_case : cases) {
+        for (auto& f : union_case.fields) {
+            fields.push_back(&f);
+        }
+    }
+    return fields;
+}
+
+/**
+ * Pointers to the fields of every choice case.
+ */
+std::vector<field*> case_fields(std::vector<choice_def::case_def>& cases) {
+    std::vector<field*> fields;
+    for (auto& choice_case : cases) {
+        fields.push_back(&choice_case.case_field);
+    }
+    return fields;
+}
+
 /**
  * Calculate size of a union (max of all case sizes).
  */
@@ -308,10 +379,12 @@ size_t calculate_choice_size(const std::vector<choice_def::case_def>& cases) {
                 break;
             case type_kind::uint32:
             case type_kind::int32:
+            case type_kind::float32:
                 case_size = 4;
                 break;
             case type_kind::uint64:
             case type_kind::int64:
+            case type_kind::float64:
                 case_size = 8;
                 break;
             default:
@@ -338,10 +411,12 @@ size_t calculate_choice_alignment(const std::vector<choice_def::case_def>& cases
                 break;
             case type_kind::uint32:
             case type_kind::int32:
+            case type_kind::float32:
                 case_align = 4;
                 break;
             case type_kind::uint64:
             case type_kind::int64:
+            case type_kind::float64:
                 case_align = 8;
                 break;
             default:
@@ -373,9 +448,11 @@ size_t get_type_size(const type_ref& type, const bundle& b) {
             return 2;
         case type_kind::uint32:
         case type_kind::int32:
+        case type_kind::float32:
             return 4;
         case type_kind::uint64:
         case type_kind::int64:
+        case type_kind::float64:
             return 8;
         case type_kind::uint128:
         case type_kind::int128:
@@ -463,11 +540,13 @@ size_t get_type_alignment(const type_ref& type, const bundle& b) {
         // 4-byte alignment
         case type_kind::uint32:
         case type_kind::int32:
+        case type_kind::float32:
             return 4;
 
         // 8-byte alignment
         case type_kind::uint64:
         case type_kind::int64:
+        case type_kind::float64:
             return 8;
 
         // 16-byte alignment
@@ -712,6 +791,34 @@ bool is_enum_type(const std::string& name, const semantic::analyzed_module_set&
     return false;
 }
 
+/**
+ * Build the substream of a @xor(size, key) / @rol / @ror / @zlib(size)
+ * directive. Argument counts are validated in Phase 3.
+ */
+std::optional<substream_def> build_substream(const ast::transform_directive& t,
+                                             const semantic::analyzed_module_set& analyzed,
+                                             monomorphization_context* mono_ctx) {
+    if (t.args.empty()) {
+        return std::nullopt;  // Array transform (@delta etc.)
+    }
+
+    substream_def result;
+    if (t.name == "xor") {
+        result.transform = byte_transform::xor_key;
+    } else if (t.name == "rol") {
+        result.transform = byte_transform::rotate_left;
+    } else if (t.name == "ror") {
+        result.transform = byte_transform::rotate_right;
+    } else {
+        result.transform = byte_transform::zlib;
+    }
+    result.size = build_expr(t.args[0], analyzed, mono_ctx);
+    if (t.args.size() > 1) {
+        result.parameter = build_expr(t.args[1], analyzed, mono_ctx);
+    }
+    return result;
+}
+
 expr build_expr(const ast::expr& ast_expr,
                const semantic::analyzed_module_set& analyzed,
                monomorphization_context* mono_ctx) {
@@ -901,6 +1008,8 @@ size_t monomorphize_struct(const ast::struct_def* base_struct,
     // Build fields with parameter substitution and label/alignment directives
     std::optional<expr> pending_label = std::nullopt;
     std::optional<uint64_t> pending_alignment = std::nullopt;
+    array_transform pending_transform = array_transform::none;
+    std::optional<substream_def> pending_substream = std::nullopt;
 
     for (const auto& body_item : base_struct->body) {
         if (auto* ast_label = std::get_if<ast::label_directive>(&body_item)) {
@@ -925,6 +1034,11 @@ size_t monomorphize_struct(const ast::struct_def* base_struct,
                 // If neither works, alignment is not applied (error already reported in Phase 5)
             }
         }
+        else if (auto* ast_transform = std::get_if<ast::transform_directive>(&body_item)) {
+            // Array transform or substream directive: validated in Phase 3
+            pending_transform = ast_transform_to_ir(*ast_transform);
+            pending_substream = build_substream(*ast_transform, *mono_ctx->analyzed, mono_ctx);
+        }
         else if (auto* ast_field = std::get_if<ast::field_def>(&body_item)) {
             // Field: build it with parameter substitution and apply pending directives
             auto ir_field = build_field(*ast_field, *mono_ctx->analyzed, *mono_ctx->index_maps, mono_ctx);
@@ -950,6 +1064,12 @@ size_t monomorphize_struct(const ast::struct_def* base_struct,
                 pending_alignment.reset();
             }
 
+            // Apply pending array transform or substream if any
+            ir_field.transform = pending_transform;
+            pending_transform = array_transform::none;
+            ir_field.substream = std::move(pending_substream);
+            pending_substream.reset();
+
             concrete.fields.push_back(std::move(ir_field));
         }
         else if (auto* ast_func = std::get_if<ast::function_def>(&body_item)) {
@@ -983,6 +1103,12 @@ size_t monomorphize_struct(const ast::struct_def* base_struct,
                 }
             }
 
+            if (auto it = mono_ctx->analyzed->pure_functions.find(ast_func);
+                it != mono_ctx->analyzed->pure_functions.end()) {
+                ir_func.is_pure = true;
+                ir_func.input_fields.assign(it->second.begin(), it->second.end());
+            }
+
             if (ast_func->docstring) {
                 ir_func.documentation = ast_func->docstring.value();
             }
@@ -994,6 +1120,16 @@ size_t monomorphize_struct(const ast::struct_def* base_struct,
     // Restore previous substitution
     mono_ctx->current_substitution = prev_subst;
 
+    // Bounds of the generic definition also hold for every instantiation
+    if (mono_ctx->analyzed) {
+        concrete.bounds = find_size_bounds(*mono_ctx->analyzed, base_struct);
+        std::vector<field*> fields;
+        for (auto& f : concrete.fields) {
+            fields.push_back(&f);
+        }
+        apply_array_bounds(*mono_ctx->analyzed, base_struct, fields);
+    }
+
     if (base_struct->docstring) {
         concrete.documentation = base_struct->docstring.value();
     }
@@ -1064,6 +1200,12 @@ size_t monomorphize_union(const ast::union_def* base_union,
     // Restore previous substitution
     mono_ctx->current_substitution = prev_subst;
 
+    // Bounds of the generic definition also hold for every instantiation
+    if (mono_ctx->analyzed) {
+        concrete.bounds = find_size_bounds(*mono_ctx->analyzed, base_union);
+        apply_array_bounds(*mono_ctx->analyzed, base_union, case_fields(concrete.cases));
+    }
+
     if (base_union->docstring) {
         concrete.documentation = base_union->docstring.value();
     }
@@ -1176,6 +1318,12 @@ type_ref build_type_ref(const ast::type& ast_type,
             result.byte_order = ast_endianness_to_ir(prim->byte_order);
         }
     }
+    else if (auto* flt = std::get_if<ast::float_type>(&ast_type.node)) {
+        result.kind = (flt->bits == 64) ? type_kind::float64 : type_kind::float32;
+        if (flt->byte_order != ast::endian::unspec) {
+            result.byte_order = ast_endianness_to_ir(flt->byte_order);
+        }
+    }
     else if (std::get_if<ast::string_type>(&ast_type.node)) {
         result.kind = type_kind::string;
     }
@@ -1469,6 +1617,8 @@ struct_def build_struct(const ast::struct_def& ast_struct,
     // Build fields with labels and alignment directives
     std::optional<expr> pending_label = std::nullopt;
     std::optional<uint64_t> pending_alignment = std::nullopt;
+    array_transform pending_transform = array_transform::none;
+    std::optional<substream_def> pending_substream = std::nullopt;
 
     for (const auto& body_item : ast_struct.body) {
         if (auto* ast_label = std::get_if<ast::label_directive>(&body_item)) {
@@ -1485,6 +1635,11 @@ struct_def build_struct(const ast::struct_def& ast_struct,
             // Note: Non-constant alignments are validated in Phase 4 (constant evaluation)
             // and will produce a compile error, so we never reach here with invalid alignments.
         }
+        else if (auto* ast_transform = std::get_if<ast::transform_directive>(&body_item)) {
+            // Array transform or substream directive: validated in Phase 3
+            pending_transform = ast_transform_to_ir(*ast_transform);
+            pending_substream = build_substream(*ast_transform, analyzed, mono_ctx);
+        }
         else if (auto* ast_field = std::get_if<ast::field_def>(&body_item)) {
             // Field: build it and apply pending directives
             auto ir_field = build_field(*ast_field, analyzed, index_maps, mono_ctx);
@@ -1510,6 +1665,12 @@ struct_def build_struct(const ast::struct_def& ast_struct,
                 pending_alignment.reset();
             }
 
+            // Apply pending array transform or substream if any
+            ir_field.transform = pending_transform;
+            pending_transform = array_transform::none;
+            ir_field.substream = std::move(pending_substream);
+            pending_substream.reset();
+
             result.fields.push_back(std::move(ir_field));
         }
         else if (auto* ast_func = std::get_if<ast::function_def>(&body_item)) {
@@ -1543,6 +1704,11 @@ struct_def build_struct(const ast::struct_def& ast_struct,
                 }
             }
 
+            if (auto it = analyzed.pure_functions.find(ast_func); it != analyzed.pure_functions.end()) {
+                ir_func.is_pure = true;
+                ir_func.input_fields.assign(it->second.begin(), it->second.end());
+            }
+
             if (ast_func->docstring) {
                 ir_func.documentation = ast_func->docstring.value();
             }
@@ -1554,6 +1720,12 @@ struct_def build_struct(const ast::struct_def& ast_struct,
     // Calculate total size and alignment from fields
     result.total_size = calculate_struct_size(result.fields);
     result.alignment = calculate_struct_alignment(result.fields);
+    result.bounds = find_size_bounds(analyzed, &ast_struct);
+    std::vector<field*> fields;
+    for (auto& f : result.fields) {
+        fields.push_back(&f);
+    }
+    apply_array_bounds(analyzed, &ast_struct, fields);
 
     if (ast_struct.docstring) {
         result.documentation = ast_struct.docstring.value();
@@ -1690,6 +1862,8 @@ union_def build_union(const ast::union_def& ast_union,
     // Calculate size and alignment from cases
     result.size = calculate_union_size(result.cases);
     result.alignment = calculate_union_alignment(result.cases);
+    result.bounds = find_size_bounds(analyzed, &ast_union);
+    apply_array_bounds(analyzed, &ast_union, case_fields(result.cases));
 
     if (ast_union.docstring) {
         result.documentation = ast_union.docstring.value();
@@ -1765,6 +1939,8 @@ choice_def build_choice(const ast::choice_def& ast_choice,
     // Calculate size and alignment (max of all case fields plus tag)
     result.size = calculate_choice_size(result.cases);
     result.alignment = calculate_choice_alignment(result.cases);
+    result.bounds = find_size_bounds(analyzed, &ast_choice);
+    apply_array_bounds(analyzed, &ast_choice, case_fields(result.cases));
 
     if (ast_choice.docstring) {
         result.documentation = ast_choice.docstring.value();
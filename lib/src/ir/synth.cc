@@ -0,0 +1,2227 @@
+//
+// Synthetic Instance Generation: random valid encodings of IR types
+//
+// Types are compiled once into plans (slots for field values, expression
+// trees with resolved slots, value sources per field) and then interpreted
+// for every instance. Runs of fields whose values nothing reads are merged
+// into single random fills, so flat records cost little more than a memcpy.
+//
+
+#include <datascript/ir_synth.hh>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
+namespace datascript::ir {
+
+namespace {
+
+constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+// Deferred field states (kept in the field's state slot)
+constexpr int64_t deferred_unwritten = -1;
+constexpr int64_t deferred_resolved = -2;
+
+/// Thrown while generating one instance: the attempt is discarded and the
+/// instance is generated again
+struct retry_instance {
+    std::string reason;
+};
+
+// ============================================================================
+// Random Numbers
+// ============================================================================
+
+uint64_t mul_high(uint64_t a, uint64_t b) {
+    const uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    const uint64_t mid = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+    return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
+/// xoshiro256** seeded through splitmix64
+class random_source {
+public:
+    explicit random_source(uint64_t seed) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (auto& s : state_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = std::rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    /// Uniform in [0, bound); bound must not be 0
+    uint64_t below(uint64_t bound) { return mul_high(next(), bound); }
+
+    /// Uniform in [lo, hi]
+    int64_t between(int64_t lo, int64_t hi) {
+        const uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+        if (span == std::numeric_limits<uint64_t>::max()) {
+            return static_cast<int64_t>(next());
+        }
+        return static_cast<int64_t>(static_cast<uint64_t>(lo) + below(span + 1));
+    }
+
+    bool one_in(uint64_t n) { return below(n) == 0; }
+
+    /// Uniform in [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    void fill(uint8_t* out, size_t size) {
+        for (; size >= 8; out += 8, size -= 8) {
+            const uint64_t v = next();
+            std::memcpy(out, &v, 8);
+        }
+        if (size > 0) {
+            const uint64_t v = next();
+            std::memcpy(out, &v, size);
+        }
+    }
+
+private:
+    uint64_t state_[4] = {};
+};
+
+// ============================================================================
+// Output Buffer
+// ============================================================================
+
+/// Growable byte buffer without zero-initialization
+class byte_buffer {
+public:
+    size_t size() const { return size_; }
+    uint8_t* data() { return data_.get(); }
+    const uint8_t* data() const { return data_.get(); }
+
+    uint8_t* extend(size_t count) {
+        if (count == 0) {
+            return data_.get() + size_;
+        }
+        if (tail_end_ != no_index) {
+            throw synth_error("Data after unbounded array '" + tail_name_ +
+                              "' would be read as more of its elements");
+        }
+        if (size_ + count > capacity_) {
+            size_t capacity = std::max<size_t>(capacity_ * 2, 4096);
+            while (capacity < size_ + count) {
+                capacity *= 2;
+            }
+            auto grown = std::make_unique_for_overwrite<uint8_t[]>(capacity);
+            if (size_ > 0) {
+                std::memcpy(grown.get(), data_.get(), size_);
+            }
+            data_ = std::move(grown);
+            capacity_ = capacity;
+        }
+        uint8_t* p = data_.get() + size_;
+        size_ += count;
+        return p;
+    }
+
+    void truncate(size_t size) {
+        size_ = size;
+        if (tail_end_ != no_index && tail_end_ > size) {
+            tail_end_ = no_index;
+        }
+    }
+
+    void clear() { truncate(0); }
+
+    /// A T[] array was just written: it is read until the input ends
+    void close_tail(const std::string& field) {
+        tail_end_ = size_;
+        tail_name_ = field;
+    }
+
+    bool has_tail() const { return tail_end_ != no_index; }
+    const std::string& tail_name() const { return tail_name_; }
+
+private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    size_t tail_end_ = no_index;
+    std::string tail_name_;
+};
+
+// ============================================================================
+// Scalars
+// ============================================================================
+
+/// Wire form of an integer-like value
+struct scalar_info {
+    unsigned width = 0;      // Bytes on the wire
+    unsigned bits = 0;       // Value bits
+    bool is_signed = false;
+    bool big = false;
+    bool is_bool = false;
+    bool is_float = false;
+
+    int64_t min() const {
+        if (!is_signed) return 0;
+        return bits >= 64 ? std::numeric_limits<int64_t>::min() : -(int64_t{1} << (bits - 1));
+    }
+    int64_t max() const {
+        if (is_bool) return 1;
+        if (bits >= 64 || (!is_signed && bits == 63)) return std::numeric_limits<int64_t>::max();
+        return is_signed ? (int64_t{1} << (bits - 1)) - 1 : (int64_t{1} << bits) - 1;
+    }
+};
+
+bool is_big_endian(const type_ref& type) {
+    if (!type.byte_order) return false;  // Readers default to little endian
+    switch (*type.byte_order) {
+        case endianness::big: return true;
+        case endianness::native: return std::endian::native == std::endian::big;
+        default: return false;
+    }
+}
+
+std::optional<scalar_info> primitive_info(const type_ref& type) {
+    scalar_info info;
+    info.big = is_big_endian(type);
+    switch (type.kind) {
+        case type_kind::uint8:   info.width = 1; break;
+        case type_kind::uint16:  info.width = 2; break;
+        case type_kind::uint32:  info.width = 4; break;
+        case type_kind::uint64:  info.width = 8; break;
+        case type_kind::uint128: info.width = 16; break;
+        case type_kind::int8:    info.width = 1; info.is_signed = true; break;
+        case type_kind::int16:   info.width = 2; info.is_signed = true; break;
+        case type_kind::int32:   info.width = 4; info.is_signed = true; break;
+        case type_kind::int64:   info.width = 8; info.is_signed = true; break;
+        case type_kind::int128:  info.width = 16; info.is_signed = true; break;
+        case type_kind::float32: info.width = 4; info.is_float = true; break;
+        case type_kind::float64: info.width = 8; info.is_float = true; break;
+        case type_kind::boolean: info.width = 1; info.is_bool = true; break;
+        case type_kind::bitfield: {
+            // Outside bitfield runs, readers use the smallest little-endian
+            // integer that holds the bits
+            const size_t bits = type.bit_width.value_or(8);
+            info.width = bits <= 8 ? 1 : bits <= 16 ? 2 : bits <= 32 ? 4 : 8;
+            info.bits = static_cast<unsigned>(bits);
+            info.big = false;
+            return info;
+        }
+        default:
+            return std::nullopt;
+    }
+    info.bits = std::min(info.width * 8, 64u);
+    if (info.is_bool) info.bits = 1;
+    return info;
+}
+
+void put_uint(uint8_t* out, uint64_t value, const scalar_info& info) {
+    const unsigned width = std::min(info.width, 8u);
+    for (unsigned i = 0; i < width; ++i) {
+        const unsigned at = info.big ? info.width - 1 - i : i;
+        out[at] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    // 128-bit integers: the upper half extends the 64-bit value
+    const uint8_t fill = (info.is_signed && static_cast<int64_t>(value) < 0) ? 0xFF : 0x00;
+    for (unsigned i = 8; i < info.width; ++i) {
+        out[info.big ? info.width - 1 - i : i] = fill;
+    }
+}
+
+int64_t get_int(const uint8_t* in, const scalar_info& info) {
+    uint64_t value = 0;
+    const unsigned width = std::min(info.width, 8u);
+    for (unsigned i = 0; i < width; ++i) {
+        const unsigned at = info.big ? info.width - 1 - i : i;
+        value |= static_cast<uint64_t>(in[at]) << (8 * i);
+    }
+    if (info.bits < 64) {
+        value &= (uint64_t{1} << info.bits) - 1;
+        if (info.is_signed && (value >> (info.bits - 1)) != 0) {
+            value |= ~uint64_t{0} << info.bits;
+        }
+    }
+    return static_cast<int64_t>(value);
+}
+
+int64_t clamp_to(int64_t value, int64_t lo, int64_t hi) {
+    return std::min(std::max(value, lo), hi);
+}
+
+// Compressed size of a zlib stream made of stored blocks
+constexpr size_t stored_block_limit = 65535;
+
+size_t stored_zlib_size(size_t raw) {
+    const size_t blocks = std::max<size_t>(1, (raw + stored_block_limit - 1) / stored_block_limit);
+    return 2 + 5 * blocks + raw + 4;
+}
+
+/// Raw length whose stored-block zlib stream is exactly size bytes
+std::optional<size_t> stored_zlib_raw_size(size_t size) {
+    if (size < stored_zlib_size(0)) return std::nullopt;
+    size_t raw = size - stored_zlib_size(0);
+    while (raw > 0 && stored_zlib_size(raw) > size) {
+        --raw;
+    }
+    if (stored_zlib_size(raw) != size) return std::nullopt;
+    return raw;
+}
+
+// ============================================================================
+// Plans
+// ============================================================================
+
+struct struct_plan;
+struct union_plan;
+struct choice_plan;
+struct subtype_plan;
+
+/// Compiled expression node
+struct node {
+    enum kind_t : uint8_t {
+        constant,
+        slot,            // Value slot of the current frame
+        deferred_slot,   // Slot of a field written later (state slot in b)
+        lookup,          // Field of an enclosing frame, by name (text)
+        unary,
+        binary,
+        ternary,
+        failure          // Cannot be evaluated (text is the reason)
+    };
+
+    kind_t kind = constant;
+    expr::op_type op = expr::add;
+    int64_t value = 0;
+    uint32_t a = no_node, b = no_node, c = no_node;
+    std::string text;
+};
+
+/// Constraint-derived bound on a value: value OP node
+struct bound {
+    expr::op_type op;
+    uint32_t rhs;
+};
+
+/// Names and slots of one frame (struct, union or choice instance)
+struct layout {
+    std::string name;
+    std::vector<std::string> slot_names;
+    std::vector<size_t> slot_fields;  // Field plan index per slot (no_index: none)
+
+    size_t add_slot(const std::string& slot_name, size_t field_index) {
+        slot_names.push_back(slot_name);
+        slot_fields.push_back(field_index);
+        return slot_names.size() - 1;
+    }
+
+    std::optional<size_t> find(const std::string& slot_name) const {
+        for (size_t i = 0; i < slot_names.size(); ++i) {
+            if (slot_names[i] == slot_name) return i;
+        }
+        return std::nullopt;
+    }
+};
+
+struct field_plan {
+    const field* def = nullptr;
+    std::string path;          // "Struct.field"
+    size_t slot = no_index;
+    bool needs_value = false;  // Some expression reads the value
+
+    // Presence and position
+    uint32_t condition = no_node;
+    uint32_t label = no_node;
+    size_t label_field = no_index;     // Deferred offset field (in this layout)
+    size_t label_member = no_index;    // Field of that struct, for "struct.field" offsets
+    int64_t label_bias = 0;            // label = offset field + bias
+
+    // Value source for scalars
+    enum class source { random, length, selector, deferred };
+    source origin = source::random;
+    int64_t bias = 0;                  // length: count = value + bias
+    const length_distribution* length = nullptr;
+    const choice_plan* selects = nullptr;
+    size_t state_slot = no_index;      // deferred: write position or state
+
+    std::vector<uint32_t> checks;      // Constraints (non-zero = satisfied)
+    std::vector<bound> bounds;
+    std::vector<uint32_t> equals;      // Value is one of these
+
+    // Arrays (innermost counts come from the element type)
+    uint32_t count = no_node;
+    uint32_t min_count = no_node;
+    uint32_t max_count = no_node;
+    const length_distribution* elements = nullptr;
+
+    // Nested types
+    std::vector<uint32_t> selector_args;       // Choice arguments (this frame)
+    uint32_t selector = no_node;               // External selector without arguments
+    std::vector<std::pair<size_t, size_t>> captures;  // Child slot -> this frame's slot
+    std::vector<std::pair<size_t, size_t>> deferred_members;  // Child field -> this frame's state slot
+
+    // Substreams
+    uint32_t substream_size = no_node;
+    size_t substream_field = no_index;         // Deferred size field (in this layout)
+    size_t substream_member = no_index;        // Field of that struct, for "struct.field" sizes
+    int64_t substream_bias = 0;                // size = size field + bias
+    uint32_t substream_param = no_node;
+};
+
+/// One step of a struct: a random fill, one field or a bitfield run
+struct step {
+    enum kind_t : uint8_t { fill, single, bitfields };
+    kind_t kind = single;
+    size_t first = 0;   // Field plan index
+    size_t last = 0;    // bitfields: one past the run
+    size_t bytes = 0;   // fill: byte count
+};
+
+struct struct_plan {
+    const struct_def* def = nullptr;
+    layout frame;
+    std::vector<field_plan> fields;
+    std::vector<step> steps;
+    bool leads_discriminator = false;  // First field re-reads an inline discriminator
+    bool finalized = false;
+};
+
+struct union_plan {
+    const union_def* def = nullptr;
+    layout frame;
+    std::vector<field_plan> branches;  // Every case field, in trial order
+};
+
+struct choice_plan {
+    const choice_def* def = nullptr;
+    layout frame;
+
+    struct case_plan {
+        field_plan field;
+        std::vector<uint32_t> values;
+        uint32_t range_bound = no_node;
+        case_selector_mode mode = case_selector_mode::exact;
+        bool is_default = false;
+        bool rereads_discriminator = false;  // Inline choices: anonymous block or default
+        std::vector<int64_t> constant_values;
+        std::optional<int64_t> constant_bound;
+    };
+    std::vector<case_plan> cases;
+    std::vector<size_t> parameter_slots;
+    std::optional<scalar_info> discriminator;  // Inline discriminator choices
+};
+
+struct subtype_plan {
+    const subtype_def* def = nullptr;
+    layout frame;          // One slot: this
+    field_plan value;
+};
+
+/// Compile-time context for expressions
+struct scope {
+    layout* owner = nullptr;
+    std::vector<field_plan>* fields = nullptr;     // Field plans of owner
+    const struct_def* functions = nullptr;         // Member functions callable by name
+    const std::map<std::string, uint32_t>* substitutions = nullptr;
+    std::optional<size_t> self;                    // Slot of 'this'
+    int call_depth = 0;
+};
+
+/// Frame of one struct, union or choice instance during generation
+struct frame {
+    const layout* names = nullptr;
+    std::vector<field_plan>* fields = nullptr;
+    size_t base = 0;          // First slot in the slot stack
+    size_t start = 0;         // Buffer position where the instance starts
+    const frame* parent = nullptr;
+};
+
+bool is_comparison(expr::op_type op) {
+    return op == expr::eq || op == expr::ne || op == expr::lt ||
+           op == expr::gt || op == expr::le || op == expr::ge;
+}
+
+expr::op_type mirrored(expr::op_type op) {
+    switch (op) {
+        case expr::lt: return expr::gt;
+        case expr::gt: return expr::lt;
+        case expr::le: return expr::ge;
+        case expr::ge: return expr::le;
+        default: return op;
+    }
+}
+
+bool is_integer_kind(type_kind kind) {
+    switch (kind) {
+        case type_kind::uint8: case type_kind::uint16: case type_kind::uint32:
+        case type_kind::uint64: case type_kind::uint128:
+        case type_kind::int8: case type_kind::int16: case type_kind::int32:
+        case type_kind::int64: case type_kind::int128:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_array_kind(type_kind kind) {
+    return kind == type_kind::array_fixed || kind == type_kind::array_variable ||
+           kind == type_kind::array_ranged;
+}
+
+/// Innermost element type of a (possibly nested) array
+const type_ref& innermost(const type_ref& type) {
+    const type_ref* t = &type;
+    while (is_array_kind(t->kind) && t->element_type) {
+        t = t->element_type.get();
+    }
+    return *t;
+}
+
+/// Field reference plus constant: name (+|-) constant
+struct linear_ref {
+    std::string name;
+    int64_t bias = 0;
+};
+
+std::optional<linear_ref> as_linear_ref(const expr& e) {
+    if (e.type == expr::field_ref || e.type == expr::parameter_ref) {
+        return linear_ref{e.ref_name, 0};
+    }
+    if (e.type == expr::binary_op && e.left && e.right && (e.op == expr::add || e.op == expr::sub)) {
+        const expr& l = *e.left;
+        const expr& r = *e.right;
+        const bool l_ref = l.type == expr::field_ref || l.type == expr::parameter_ref;
+        const bool r_ref = r.type == expr::field_ref || r.type == expr::parameter_ref;
+        if (l_ref && r.type == expr::literal_int) {
+            const auto k = static_cast<int64_t>(r.int_value);
+            return linear_ref{l.ref_name, e.op == expr::add ? k : -k};
+        }
+        if (r_ref && l.type == expr::literal_int && e.op == expr::add) {
+            return linear_ref{r.ref_name, static_cast<int64_t>(l.int_value)};
+        }
+    }
+    return std::nullopt;
+}
+
+bool mentions_any(const expr& e, const std::vector<std::string>& names) {
+    if ((e.type == expr::field_ref || e.type == expr::parameter_ref) &&
+        std::find(names.begin(), names.end(), e.ref_name) != names.end()) {
+        return true;
+    }
+    for (const expr* child : {e.left.get(), e.right.get(), e.condition.get(),
+                              e.true_expr.get(), e.false_expr.get()}) {
+        if (child && mentions_any(*child, names)) return true;
+    }
+    for (const auto& arg : e.arguments) {
+        if (mentions_any(*arg, names)) return true;
+    }
+    return false;
+}
+
+bool names_one_of(const expr& e, const std::vector<std::string>& names) {
+    return (e.type == expr::field_ref || e.type == expr::parameter_ref) &&
+           std::find(names.begin(), names.end(), e.ref_name) != names.end();
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Generator State
+// ============================================================================
+
+struct instance_generator::impl {
+    const bundle& ir;
+    synth_options options;
+    random_source random;
+
+    // Plans (std::deque keeps addresses stable)
+    std::deque<struct_plan> struct_plans;
+    std::deque<union_plan> union_plans;
+    std::deque<choice_plan> choice_plans;
+    std::deque<subtype_plan> subtype_plans;
+    std::unordered_map<size_t, struct_plan*> structs_by_index;
+    std::unordered_map<size_t, union_plan*> unions_by_index;
+    std::unordered_map<size_t, choice_plan*> choices_by_index;
+    std::unordered_map<size_t, subtype_plan*> subtypes_by_index;
+    std::vector<node> nodes;
+
+    // Generation state
+    std::vector<int64_t> slots;
+    std::deque<byte_buffer> buffers;  // Output, then one per nested substream
+    size_t level = 0;
+    size_t depth = 0;
+
+    impl(const bundle& b, synth_options opts)
+        : ir(b), options(std::move(opts)), random(options.seed) {
+        buffers.emplace_back();
+    }
+
+    byte_buffer& out() { return buffers[level]; }
+
+    // ------------------------------------------------------------------------
+    // Expression compilation
+    // ------------------------------------------------------------------------
+
+    uint32_t add_node(node n) {
+        nodes.push_back(std::move(n));
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    uint32_t constant_node(int64_t value) {
+        node n;
+        n.kind = node::constant;
+        n.value = value;
+        return add_node(std::move(n));
+    }
+
+    uint32_t failure_node(const std::string& reason) {
+        node n;
+        n.kind = node::failure;
+        n.text = reason;
+        return add_node(std::move(n));
+    }
+
+    uint32_t slot_node(const scope& sc, size_t slot) {
+        node n;
+        n.kind = node::slot;
+        n.value = static_cast<int64_t>(slot);
+        if (sc.fields && slot < sc.owner->slot_fields.size()) {
+            const size_t field_index = sc.owner->slot_fields[slot];
+            if (field_index != no_index && field_index < sc.fields->size()) {
+                field_plan& fp = (*sc.fields)[field_index];
+                fp.needs_value = true;
+                if (fp.origin == field_plan::source::deferred) {
+                    n.kind = node::deferred_slot;
+                    n.a = static_cast<uint32_t>(fp.state_slot);
+                    n.text = fp.path;
+                }
+            }
+        }
+        return add_node(std::move(n));
+    }
+
+    std::optional<int64_t> constant_value(const std::string& name) const {
+        if (auto it = ir.constants.find(name); it != ir.constants.end()) {
+            return static_cast<int64_t>(it->second);
+        }
+        // Enum items: Enum.ITEM (possibly package-qualified)
+        const size_t dot = name.rfind('.');
+        if (dot == std::string::npos) return std::nullopt;
+        const std::string enum_name = name.substr(0, dot);
+        const std::string item_name = name.substr(dot + 1);
+        for (const auto& e : ir.enums) {
+            const bool matches = e.name == enum_name ||
+                (enum_name.size() > e.name.size() &&
+                 enum_name.compare(enum_name.size() - e.name.size(), e.name.size(), e.name) == 0 &&
+                 enum_name[enum_name.size() - e.name.size() - 1] == '.');
+            if (!matches) continue;
+            for (const auto& item : e.items) {
+                if (item.name == item_name) return static_cast<int64_t>(item.value);
+            }
+        }
+        return std::nullopt;
+    }
+
+    uint32_t compile_name(const std::string& name, scope& sc) {
+        if (sc.substitutions) {
+            if (auto it = sc.substitutions->find(name); it != sc.substitutions->end()) {
+                return it->second;
+            }
+        }
+        if (name == "this" && sc.self) {
+            return slot_node(sc, *sc.self);
+        }
+        if (auto slot = sc.owner->find(name)) {
+            return slot_node(sc, *slot);
+        }
+        if (auto slot = capture_path(name, sc)) {
+            return slot_node(sc, *slot);
+        }
+        if (auto value = constant_value(name)) {
+            return constant_node(*value);
+        }
+        node n;
+        n.kind = node::lookup;
+        n.text = name;
+        return add_node(std::move(n));
+    }
+
+    /// Slot for a dotted path into a nested struct field ("header.length"),
+    /// copied out of the child frame once the child is generated
+    std::optional<size_t> capture_path(const std::string& path, scope& sc) {
+        const size_t dot = path.find('.');
+        if (dot == std::string::npos || !sc.fields) return std::nullopt;
+        auto head = sc.owner->find(path.substr(0, dot));
+        if (!head) return std::nullopt;
+        const size_t field_index = sc.owner->slot_fields[*head];
+        if (field_index == no_index) return std::nullopt;
+        field_plan& fp = (*sc.fields)[field_index];
+        if (fp.def->type.kind != type_kind::struct_type || !fp.def->type.type_index || fp.def->substream) {
+            return std::nullopt;
+        }
+        struct_plan& child = struct_for(*fp.def->type.type_index);
+        scope child_scope{&child.frame, &child.fields, child.def, nullptr, std::nullopt, 0};
+        const std::string rest = path.substr(dot + 1);
+        std::optional<size_t> child_slot = child.frame.find(rest);
+        if (!child_slot) child_slot = capture_path(rest, child_scope);
+        if (!child_slot) return std::nullopt;
+        // Mark the child's field as read
+        slot_node(child_scope, *child_slot);
+        nodes.pop_back();
+        const size_t slot = sc.owner->add_slot(path, no_index);
+        fp.captures.emplace_back(*child_slot, slot);
+        return slot;
+    }
+
+    uint32_t compile(const expr& e, scope& sc) {
+        switch (e.type) {
+            case expr::literal_int:
+                return constant_node(static_cast<int64_t>(e.int_value));
+            case expr::literal_bool:
+                return constant_node(e.bool_value ? 1 : 0);
+            case expr::literal_string:
+                return failure_node("string literal \"" + e.string_value + "\"");
+            case expr::parameter_ref:
+            case expr::field_ref:
+                return compile_name(e.ref_name, sc);
+            case expr::constant_ref: {
+                if (auto value = constant_value(e.ref_name)) {
+                    return constant_node(*value);
+                }
+                return compile_name(e.ref_name, sc);
+            }
+            case expr::array_index:
+                return failure_node("array element reference");
+            case expr::unary_op: {
+                if (!e.left && !e.right) return failure_node("incomplete unary expression");
+                node n;
+                n.kind = node::unary;
+                n.op = e.op;
+                n.a = compile(e.left ? *e.left : *e.right, sc);
+                return add_node(std::move(n));
+            }
+            case expr::binary_op: {
+                if (!e.left || !e.right) return failure_node("incomplete binary expression");
+                node n;
+                n.kind = node::binary;
+                n.op = e.op;
+                n.a = compile(*e.left, sc);
+                n.b = compile(*e.right, sc);
+                return add_node(std::move(n));
+            }
+            case expr::ternary_op: {
+                if (!e.condition || !e.true_expr || !e.false_expr) {
+                    return failure_node("incomplete conditional expression");
+                }
+                node n;
+                n.kind = node::ternary;
+                n.a = compile(*e.condition, sc);
+                n.b = compile(*e.true_expr, sc);
+                n.c = compile(*e.false_expr, sc);
+                return add_node(std::move(n));
+            }
+            case expr::function_call:
+                return compile_call(e, sc);
+        }
+        return failure_node("unknown expression");
+    }
+
+    /// Member function calls are inlined: parameters become the argument trees
+    uint32_t compile_call(const expr& e, scope& sc) {
+        if (!sc.functions || sc.call_depth > 16) {
+            return failure_node("call to '" + e.ref_name + "'");
+        }
+        for (const auto& func : sc.functions->functions) {
+            if (func.name != e.ref_name || func.parameters.size() != e.arguments.size()) continue;
+            for (const auto& stmt : func.body) {
+                const auto* ret = std::get_if<return_statement>(&stmt);
+                if (!ret) continue;
+                std::map<std::string, uint32_t> params;
+                if (sc.substitutions) params = *sc.substitutions;
+                for (size_t i = 0; i < func.parameters.size(); ++i) {
+                    params[func.parameters[i].name] = compile(*e.arguments[i], sc);
+                }
+                scope body = sc;
+                body.substitutions = &params;
+                body.call_depth = sc.call_depth + 1;
+                return compile(ret->value, body);
+            }
+        }
+        return failure_node("call to '" + e.ref_name + "'");
+    }
+
+    // ------------------------------------------------------------------------
+    // Expression evaluation
+    // ------------------------------------------------------------------------
+
+    int64_t eval(uint32_t id, const frame& f) {
+        const node& n = nodes[id];
+        switch (n.kind) {
+            case node::constant:
+                return n.value;
+            case node::slot:
+                return slots[f.base + static_cast<size_t>(n.value)];
+            case node::deferred_slot:
+                if (slots[f.base + n.a] != deferred_resolved) {
+                    throw synth_error("Value of '" + n.text + "' is read before the generator can choose it");
+                }
+                return slots[f.base + static_cast<size_t>(n.value)];
+            case node::lookup:
+                for (const frame* p = f.parent; p; p = p->parent) {
+                    if (auto slot = p->names->find(n.text)) {
+                        return slots[p->base + *slot];
+                    }
+                }
+                throw synth_error("Cannot evaluate '" + n.text + "': no enclosing field has that name");
+            case node::unary: {
+                const int64_t v = eval(n.a, f);
+                switch (n.op) {
+                    case expr::negate: return static_cast<int64_t>(0 - static_cast<uint64_t>(v));
+                    case expr::logical_not: return v == 0 ? 1 : 0;
+                    case expr::bit_not: return ~v;
+                    default: return v;
+                }
+            }
+            case node::binary:
+                return eval_binary(n, f);
+            case node::ternary:
+                return eval(n.a, f) != 0 ? eval(n.b, f) : eval(n.c, f);
+            case node::failure:
+                throw synth_error("Cannot evaluate " + n.text);
+        }
+        return 0;
+    }
+
+    int64_t eval_binary(const node& n, const frame& f) {
+        if (n.op == expr::logical_and) {
+            return eval(n.a, f) != 0 && eval(n.b, f) != 0 ? 1 : 0;
+        }
+        if (n.op == expr::logical_or) {
+            return eval(n.a, f) != 0 || eval(n.b, f) != 0 ? 1 : 0;
+        }
+        const int64_t l = eval(n.a, f);
+        const int64_t r = eval(n.b, f);
+        const auto ul = static_cast<uint64_t>(l);
+        const auto ur = static_cast<uint64_t>(r);
+        switch (n.op) {
+            case expr::add: return static_cast<int64_t>(ul + ur);
+            case expr::sub: return static_cast<int64_t>(ul - ur);
+            case expr::mul: return static_cast<int64_t>(ul * ur);
+            case expr::div:
+            case expr::mod:
+                if (r == 0 || (l == std::numeric_limits<int64_t>::min() && r == -1)) {
+                    throw retry_instance{"division by zero"};
+                }
+                return n.op == expr::div ? l / r : l % r;
+            case expr::eq: return l == r;
+            case expr::ne: return l != r;
+            case expr::lt: return l < r;
+            case expr::gt: return l > r;
+            case expr::le: return l <= r;
+            case expr::ge: return l >= r;
+            case expr::bit_and: return l & r;
+            case expr::bit_or: return l | r;
+            case expr::bit_xor: return l ^ r;
+            case expr::bit_shift_left: return static_cast<int64_t>(ul << (ur & 63));
+            case expr::bit_shift_right: return static_cast<int64_t>(ul >> (ur & 63));
+            default: return 0;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Plan construction
+    // ------------------------------------------------------------------------
+
+    const length_distribution* distribution_for(const std::string& path) const {
+        if (auto it = options.field_lengths.find(path); it != options.field_lengths.end()) {
+            return &it->second;
+        }
+        return &options.array_length;
+    }
+
+    struct_plan& struct_for(size_t index) {
+        if (auto it = structs_by_index.find(index); it != structs_by_index.end()) {
+            return *it->second;
+        }
+        if (index >= ir.structs.size()) {
+            throw synth_error("Struct index " + std::to_string(index) + " is out of range");
+        }
+        struct_plan& plan = struct_plans.emplace_back();
+        structs_by_index[index] = &plan;
+        plan.def = &ir.structs[index];
+        plan.frame.name = plan.def->name;
+        compile_sequence(plan.def->fields, plan.frame, plan.fields, plan.def);
+        return plan;
+    }
+
+    union_plan& union_for(size_t index) {
+        if (auto it = unions_by_index.find(index); it != unions_by_index.end()) {
+            return *it->second;
+        }
+        if (index >= ir.unions.size()) {
+            throw synth_error("Union index " + std::to_string(index) + " is out of range");
+        }
+        union_plan& plan = union_plans.emplace_back();
+        unions_by_index[index] = &plan;
+        plan.def = &ir.unions[index];
+        plan.frame.name = plan.def->name;
+        for (const auto& c : plan.def->cases) {
+            for (const auto& f : c.fields) {
+                plan.frame.add_slot(f.name, plan.branches.size());
+                plan.branches.emplace_back().def = &f;
+            }
+        }
+        scope sc{&plan.frame, &plan.branches, nullptr, nullptr, std::nullopt, 0};
+        for (size_t i = 0; i < plan.branches.size(); ++i) {
+            plan.branches[i].slot = i;
+            compile_field(plan.branches[i], sc);
+        }
+        return plan;
+    }
+
+    choice_plan& choice_for(size_t index) {
+        if (auto it = choices_by_index.find(index); it != choices_by_index.end()) {
+            return *it->second;
+        }
+        if (index >= ir.choices.size()) {
+            throw synth_error("Choice index " + std::to_string(index) + " is out of range");
+        }
+        choice_plan& plan = choice_plans.emplace_back();
+        choices_by_index[index] = &plan;
+        plan.def = &ir.choices[index];
+        plan.frame.name = plan.def->name;
+
+        for (const auto& p : plan.def->parameters) {
+            plan.parameter_slots.push_back(plan.frame.add_slot(p.name, no_index));
+        }
+        const bool is_inline = plan.def->inferred_discriminator_type.has_value();
+        if (is_inline) {
+            plan.discriminator = primitive_info(*plan.def->inferred_discriminator_type);
+            if (!plan.discriminator || !is_integer_kind(plan.def->inferred_discriminator_type->kind)) {
+                plan.discriminator = scalar_info{1, 8, false, false, false, false};
+            }
+            plan.discriminator->big = false;  // Readers peek the discriminator little-endian
+        }
+
+        // Case fields need their slots before any of them compiles
+        plan.cases.resize(plan.def->cases.size());
+        std::vector<field_plan> case_fields(plan.def->cases.size());
+        for (size_t i = 0; i < plan.def->cases.size(); ++i) {
+            const auto& c = plan.def->cases[i];
+            case_fields[i].def = &c.case_field;
+            case_fields[i].slot = plan.frame.add_slot(c.case_field.name, i);
+        }
+        scope sc{&plan.frame, &case_fields, nullptr, nullptr, std::nullopt, 0};
+        for (size_t i = 0; i < plan.def->cases.size(); ++i) {
+            const auto& c = plan.def->cases[i];
+            auto& cp = plan.cases[i];
+            cp.mode = c.selector_mode;
+            cp.is_default = c.case_values.empty() && c.selector_mode == case_selector_mode::exact;
+            cp.rereads_discriminator = is_inline && (c.is_anonymous_block || cp.is_default);
+            for (const auto& v : c.case_values) {
+                cp.values.push_back(compile(v, sc));
+                if (nodes[cp.values.back()].kind == node::constant) {
+                    cp.constant_values.push_back(nodes[cp.values.back()].value);
+                }
+            }
+            if (c.range_bound) {
+                cp.range_bound = compile(*c.range_bound, sc);
+                if (nodes[cp.range_bound].kind == node::constant) {
+                    cp.constant_bound = nodes[cp.range_bound].value;
+                }
+            }
+            compile_field(case_fields[i], sc);
+        }
+        for (size_t i = 0; i < plan.cases.size(); ++i) {
+            plan.cases[i].field = std::move(case_fields[i]);
+        }
+        // Anonymous blocks re-read the discriminator as their first field
+        for (auto& cp : plan.cases) {
+            const auto& type = cp.field.def->type;
+            if (cp.rereads_discriminator && !cp.is_default &&
+                type.kind == type_kind::struct_type && type.type_index) {
+                struct_for(*type.type_index).leads_discriminator = true;
+            }
+        }
+        return plan;
+    }
+
+    subtype_plan& subtype_for(size_t index) {
+        if (auto it = subtypes_by_index.find(index); it != subtypes_by_index.end()) {
+            return *it->second;
+        }
+        if (index >= ir.subtypes.size()) {
+            throw synth_error("Subtype index " + std::to_string(index) + " is out of range");
+        }
+        subtype_plan& plan = subtype_plans.emplace_back();
+        subtypes_by_index[index] = &plan;
+        plan.def = &ir.subtypes[index];
+        plan.frame.name = plan.def->name;
+        plan.value.slot = plan.frame.add_slot("this", no_index);
+        plan.value.path = plan.def->name;
+        scope sc{&plan.frame, nullptr, nullptr, nullptr, plan.value.slot, 0};
+        add_constraint(plan.value, plan.def->constraint, sc, {"this"});
+        return plan;
+    }
+
+    /// Add a constraint as a check, and derive bounds and candidate values
+    /// from its top-level conjunction of comparisons with the value itself
+    void add_constraint(field_plan& fp, const expr& condition, scope& sc,
+                        const std::vector<std::string>& self_names) {
+        fp.checks.push_back(compile(condition, sc));
+        collect_bounds(fp, condition, sc, self_names);
+    }
+
+    void collect_bounds(field_plan& fp, const expr& e, scope& sc,
+                        const std::vector<std::string>& self_names) {
+        if (e.type != expr::binary_op || !e.left || !e.right) return;
+        if (e.op == expr::logical_and) {
+            collect_bounds(fp, *e.left, sc, self_names);
+            collect_bounds(fp, *e.right, sc, self_names);
+            return;
+        }
+        if (e.op == expr::logical_or) {
+            // x == a || x == b || ...: candidate values
+            std::vector<const expr*> pending{&e};
+            std::vector<uint32_t> values;
+            while (!pending.empty()) {
+                const expr* term = pending.back();
+                pending.pop_back();
+                if (term->type != expr::binary_op || !term->left || !term->right) return;
+                if (term->op == expr::logical_or) {
+                    pending.push_back(term->left.get());
+                    pending.push_back(term->right.get());
+                } else if (term->op == expr::eq && names_one_of(*term->left, self_names) &&
+                           !mentions_any(*term->right, self_names)) {
+                    values.push_back(compile(*term->right, sc));
+                } else if (term->op == expr::eq && names_one_of(*term->right, self_names) &&
+                           !mentions_any(*term->left, self_names)) {
+                    values.push_back(compile(*term->left, sc));
+                } else {
+                    return;
+                }
+            }
+            fp.equals.insert(fp.equals.end(), values.begin(), values.end());
+            return;
+        }
+        if (!is_comparison(e.op)) return;
+        if (names_one_of(*e.left, self_names) && !mentions_any(*e.right, self_names)) {
+            if (e.op == expr::eq) {
+                fp.equals.push_back(compile(*e.right, sc));
+            } else {
+                fp.bounds.push_back({e.op, compile(*e.right, sc)});
+            }
+        } else if (names_one_of(*e.right, self_names) && !mentions_any(*e.left, self_names)) {
+            if (e.op == expr::eq) {
+                fp.equals.push_back(compile(*e.left, sc));
+            } else {
+                fp.bounds.push_back({mirrored(e.op), compile(*e.left, sc)});
+            }
+        }
+    }
+
+    /// Struct fields: allocate slots, pick value sources, then compile
+    void compile_sequence(const std::vector<field>& defs, layout& frame,
+                          std::vector<field_plan>& plans, const struct_def* owner) {
+        plans.resize(defs.size());
+        for (size_t i = 0; i < defs.size(); ++i) {
+            plans[i].def = &defs[i];
+            plans[i].path = frame.name + "." + defs[i].name;
+            plans[i].slot = frame.add_slot(defs[i].name, i);
+        }
+
+        // Fields that hold a later label offset or substream size are
+        // written once that offset or size is known
+        // (a field of a nested struct, "header.data_offset", is patched in
+        // place once the struct is written)
+        struct deferral {
+            size_t field;
+            size_t member;
+            int64_t bias;
+        };
+        auto defer = [&](const expr& e, size_t consumer) -> std::optional<deferral> {
+            auto ref = as_linear_ref(e);
+            if (!ref) return std::nullopt;
+            const size_t dot = ref->name.find('.');
+            auto slot = frame.find(ref->name.substr(0, dot));
+            if (!slot || *slot >= consumer) return std::nullopt;
+            field_plan& target = plans[*slot];
+            if (dot != std::string::npos) {
+                auto member = defer_member(target, ref->name.substr(dot + 1));
+                if (!member) return std::nullopt;
+                target.deferred_members.emplace_back(*member, frame.add_slot("", no_index));
+                return deferral{*slot, *member, ref->bias};
+            }
+            if (target.origin != field_plan::source::random ||
+                !is_integer_kind(target.def->type.kind) ||
+                target.def->condition != field::always || target.def->substream) {
+                return std::nullopt;
+            }
+            target.origin = field_plan::source::deferred;
+            target.state_slot = frame.add_slot("", no_index);
+            return deferral{*slot, no_index, ref->bias};
+        };
+        for (size_t i = 0; i < defs.size(); ++i) {
+            const field& f = defs[i];
+            if (f.label) {
+                if (auto d = defer(*f.label, i)) {
+                    plans[i].label_field = d->field;
+                    plans[i].label_member = d->member;
+                    plans[i].label_bias = d->bias;
+                }
+            }
+            if (f.substream) {
+                if (auto d = defer(f.substream->size, i)) {
+                    plans[i].substream_field = d->field;
+                    plans[i].substream_member = d->member;
+                    plans[i].substream_bias = d->bias;
+                }
+            }
+        }
+
+        // Fields that set an array length or select a choice case
+        for (size_t i = 0; i < defs.size(); ++i) {
+            const field& f = defs[i];
+            const type_ref& type = f.type;
+            if ((type.kind == type_kind::array_variable || type.kind == type_kind::array_fixed) &&
+                type.array_size_expr && !type.array_size && !f.substream) {
+                if (auto ref = as_linear_ref(*type.array_size_expr)) {
+                    auto slot = frame.find(ref->name);
+                    if (slot && *slot < i && plans[*slot].origin == field_plan::source::random) {
+                        field_plan& target = plans[*slot];
+                        const type_kind kind = target.def->type.kind;
+                        if (is_integer_kind(kind) || kind == type_kind::bitfield) {
+                            target.origin = field_plan::source::length;
+                            target.bias = ref->bias;
+                            target.length = distribution_for(plans[i].path);
+                        }
+                    }
+                }
+            }
+            const type_ref& element = innermost(type);
+            if (element.kind == type_kind::choice_type && element.type_index) {
+                const choice_def& choice = ir.choices.at(*element.type_index);
+                std::optional<std::string> name;
+                if (!element.choice_selector_args.empty()) {
+                    if (element.choice_selector_args[0]->type == expr::field_ref ||
+                        element.choice_selector_args[0]->type == expr::parameter_ref) {
+                        name = element.choice_selector_args[0]->ref_name;
+                    }
+                } else if (choice.selector && !choice.inferred_discriminator_type) {
+                    name = choice.selector->ref_name;
+                }
+                if (name) {
+                    auto slot = frame.find(*name);
+                    if (slot && *slot < i && plans[*slot].origin == field_plan::source::random) {
+                        field_plan& target = plans[*slot];
+                        const type_kind kind = target.def->type.kind;
+                        if (is_integer_kind(kind) || kind == type_kind::enum_type ||
+                            kind == type_kind::bitfield) {
+                            target.origin = field_plan::source::selector;
+                            target.selects = &choice_for(*element.type_index);
+                        }
+                    }
+                }
+            }
+        }
+
+        scope sc{&frame, &plans, owner, nullptr, std::nullopt, 0};
+        for (auto& fp : plans) {
+            compile_field(fp, sc);
+        }
+    }
+
+    /// Field of a nested struct that can be left for a later label or
+    /// substream to write: a plain integer the struct itself never reads
+    std::optional<size_t> defer_member(const field_plan& holder, const std::string& member) {
+        const field& def = *holder.def;
+        if (def.type.kind != type_kind::struct_type || !def.type.type_index ||
+            def.condition != field::always || def.substream) {
+            return std::nullopt;
+        }
+        const struct_plan& child = struct_for(*def.type.type_index);
+        auto index = child.frame.find(member);
+        if (!index || *index >= child.def->fields.size()) return std::nullopt;
+        for (const auto& [deferred, state] : holder.deferred_members) {
+            if (deferred == *index) return std::nullopt;
+        }
+        const field_plan& fp = child.fields[*index];
+        const field& f = child.def->fields[*index];
+        if (fp.origin != field_plan::source::random || fp.needs_value || !fp.checks.empty() ||
+            !is_integer_kind(f.type.kind) || f.condition != field::always ||
+            f.label || f.alignment || f.substream || f.inline_constraint || !f.constraints.empty()) {
+            return std::nullopt;
+        }
+        return index;
+    }
+
+    void compile_field(field_plan& fp, scope& sc) {
+        const field& f = *fp.def;
+        if (fp.path.empty()) fp.path = sc.owner->name + "." + f.name;
+        fp.length = fp.length ? fp.length : distribution_for(fp.path);
+        fp.elements = distribution_for(fp.path);
+
+        if (f.condition == field::runtime && f.runtime_condition) {
+            fp.condition = compile(*f.runtime_condition, sc);
+        }
+        if (f.label && fp.label_field == no_index) {
+            fp.label = compile(*f.label, sc);
+        } else if (f.label) {
+            fp.label = constant_node(0);
+        }
+
+        // Constraints: inline, named and the subtype's own
+        const std::vector<std::string> self{f.name, "this"};
+        scope self_scope = sc;
+        self_scope.self = fp.slot;
+        if (f.inline_constraint) {
+            add_constraint(fp, *f.inline_constraint, self_scope, self);
+        }
+        for (const auto& app : f.constraints) {
+            if (app.constraint_index >= ir.constraints.size()) continue;
+            const constraint_def& c = ir.constraints[app.constraint_index];
+            std::map<std::string, uint32_t> params;
+            std::vector<std::string> self_names = self;
+            for (size_t i = 0; i < c.params.size() && i < app.arguments.size(); ++i) {
+                params[c.params[i].name] = compile(app.arguments[i], self_scope);
+                if (names_one_of(app.arguments[i], self)) {
+                    self_names.push_back(c.params[i].name);
+                }
+            }
+            scope constraint_scope = self_scope;
+            constraint_scope.substitutions = &params;
+            add_constraint(fp, c.condition, constraint_scope, self_names);
+        }
+        if (f.type.kind == type_kind::subtype_ref && f.type.type_index &&
+            *f.type.type_index < ir.subtypes.size()) {
+            add_constraint(fp, ir.subtypes[*f.type.type_index].constraint, self_scope, {"this"});
+        }
+
+        // Array counts (of the outermost array; inner counts are constant)
+        const type_ref& type = f.type;
+        if (is_array_kind(type.kind) && !f.substream) {
+            if (type.array_size_expr && !type.array_size) {
+                fp.count = compile(*type.array_size_expr, sc);
+            }
+            if (type.kind == type_kind::array_ranged) {
+                if (type.min_size_expr) fp.min_count = compile(*type.min_size_expr, sc);
+                if (type.max_size_expr) fp.max_count = compile(*type.max_size_expr, sc);
+                if (!type.array_size_expr && type.max_size_expr) fp.count = fp.max_count;
+            }
+        }
+
+        // Nested types
+        const type_ref& element = innermost(type);
+        if (element.kind == type_kind::choice_type && element.type_index) {
+            choice_plan& choice = choice_for(*element.type_index);
+            for (const auto& arg : element.choice_selector_args) {
+                fp.selector_args.push_back(compile(*arg, sc));
+            }
+            if (fp.selector_args.empty() && !choice.discriminator && choice.def->selector) {
+                fp.selector = compile_name(choice.def->selector->ref_name, sc);
+            }
+        } else if (element.kind == type_kind::struct_type && element.type_index) {
+            struct_for(*element.type_index);
+        } else if (element.kind == type_kind::union_type && element.type_index) {
+            union_for(*element.type_index);
+        } else if (element.kind == type_kind::subtype_ref && element.type_index) {
+            subtype_for(*element.type_index);
+        }
+
+        if (f.substream) {
+            if (fp.substream_field == no_index) {
+                fp.substream_size = compile(f.substream->size, sc);
+            }
+            if (f.substream->parameter) {
+                fp.substream_param = compile(*f.substream->parameter, sc);
+            }
+        }
+    }
+
+    /// Merge fields nothing reads into random fills; group bitfield runs
+    void finalize(struct_plan& plan) {
+        if (plan.finalized) return;
+        plan.finalized = true;
+        auto fill_bytes = [&](size_t index) -> size_t {
+            const field_plan& fp = plan.fields[index];
+            const field& f = *fp.def;
+            if (fp.needs_value || !fp.checks.empty() || fp.origin != field_plan::source::random ||
+                f.condition != field::always || f.label || f.alignment || f.substream ||
+                (index == 0 && plan.leads_discriminator)) {
+                return 0;
+            }
+            if (is_integer_kind(f.type.kind)) {
+                return primitive_info(f.type)->width;
+            }
+            if (f.type.kind == type_kind::array_fixed && f.type.array_size && f.type.element_type &&
+                is_integer_kind(f.type.element_type->kind) && !f.type.array_size_expr) {
+                return primitive_info(*f.type.element_type)->width * *f.type.array_size;
+            }
+            return 0;
+        };
+        for (size_t i = 0; i < plan.fields.size();) {
+            const field& f = *plan.fields[i].def;
+            if (f.type.kind == type_kind::bitfield && f.type.bit_width) {
+                size_t end = i;
+                while (end < plan.fields.size() && plan.fields[end].def->type.kind == type_kind::bitfield &&
+                       plan.fields[end].def->type.bit_width) {
+                    ++end;
+                }
+                plan.steps.push_back({step::bitfields, i, end, 0});
+                i = end;
+            } else if (f.condition == field::never) {
+                ++i;
+            } else if (size_t bytes = fill_bytes(i)) {
+                if (!plan.steps.empty() && plan.steps.back().kind == step::fill &&
+                    plan.steps.back().last == i) {
+                    plan.steps.back().bytes += bytes;
+                    plan.steps.back().last = i + 1;
+                } else {
+                    plan.steps.push_back({step::fill, i, i + 1, bytes});
+                }
+                ++i;
+            } else {
+                plan.steps.push_back({step::single, i, i + 1, 0});
+                ++i;
+            }
+        }
+    }
+
+    void finalize_all() {
+        for (auto& plan : struct_plans) {
+            finalize(plan);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Value selection
+    // ------------------------------------------------------------------------
+
+    uint64_t draw(const length_distribution& d) {
+        if (depth > options.max_depth || d.max <= d.min) return d.min;
+        switch (d.kind) {
+            case length_distribution::shape::fixed:
+                return d.min;
+            case length_distribution::shape::uniform:
+                return d.min + random.below(d.max - d.min + 1);
+            case length_distribution::shape::geometric: {
+                if (d.mean <= 0.0) return d.min;
+                const double p = 1.0 / (d.mean + 1.0);
+                const double k = std::floor(std::log1p(-random.unit()) / std::log1p(-p));
+                const double span = static_cast<double>(d.max - d.min);
+                return d.min + static_cast<uint64_t>(std::min(k, span));
+            }
+        }
+        return d.min;
+    }
+
+    /// First case a selector value picks, as the generated readers test them
+    std::optional<size_t> match_case(const choice_plan& plan, int64_t selector, const frame& f) {
+        for (size_t i = 0; i < plan.cases.size(); ++i) {
+            const auto& c = plan.cases[i];
+            if (c.mode != case_selector_mode::exact) {
+                if (c.range_bound == no_node) continue;
+                const int64_t b = eval(c.range_bound, f);
+                bool hit = false;
+                switch (c.mode) {
+                    case case_selector_mode::ge: hit = selector >= b; break;
+                    case case_selector_mode::gt: hit = selector > b; break;
+                    case case_selector_mode::le: hit = selector <= b; break;
+                    case case_selector_mode::lt: hit = selector < b; break;
+                    case case_selector_mode::ne: hit = selector != b; break;
+                    default: break;
+                }
+                if (hit) return i;
+            } else if (c.is_default) {
+                return i;
+            } else {
+                for (uint32_t v : c.values) {
+                    if (eval(v, f) == selector) return i;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// A selector value aimed at a random case (constant case values only)
+    int64_t selector_candidate(const choice_plan& plan, int64_t lo, int64_t hi) {
+        if (plan.cases.empty()) return random.between(lo, hi);
+        return case_candidate(plan.cases[random.below(plan.cases.size())], lo, hi, nullptr);
+    }
+
+    /// A selector value in [lo, hi] aimed at one case; case values that are
+    /// not constants are evaluated in the choice's frame when one is given
+    int64_t case_candidate(const choice_plan::case_plan& c, int64_t lo, int64_t hi, const frame* f) {
+        if (c.mode != case_selector_mode::exact) {
+            std::optional<int64_t> bound = c.constant_bound;
+            if (!bound && f && c.range_bound != no_node) bound = eval(c.range_bound, *f);
+            if (bound) {
+                const int64_t b = *bound;
+                switch (c.mode) {
+                    case case_selector_mode::ge: if (b <= hi) return random.between(std::max(b, lo), hi); break;
+                    case case_selector_mode::gt: if (b < hi) return random.between(std::max(b + 1, lo), hi); break;
+                    case case_selector_mode::le: if (b >= lo) return random.between(lo, std::min(b, hi)); break;
+                    case case_selector_mode::lt: if (b > lo) return random.between(lo, std::min(b - 1, hi)); break;
+                    default: break;
+                }
+            }
+        } else if (f && !c.values.empty()) {
+            return eval(c.values[random.below(c.values.size())], *f);
+        } else if (!c.constant_values.empty()) {
+            return c.constant_values[random.below(c.constant_values.size())];
+        }
+        return random.between(lo, hi);
+    }
+
+    /// Choose a scalar value for a field within [lo, hi] that satisfies the
+    /// field's constraints; the value is stored in the field's slot
+    int64_t choose(field_plan& fp, const frame& f, int64_t lo, int64_t hi,
+                   const enum_def* enumeration, std::optional<int64_t> forced = std::nullopt) {
+        int64_t& slot = slots[f.base + fp.slot];
+        for (size_t attempt = 0; attempt < options.max_attempts; ++attempt) {
+            int64_t low = lo, high = hi;
+            for (const auto& b : fp.bounds) {
+                const int64_t v = eval(b.rhs, f);
+                switch (b.op) {
+                    case expr::lt: if (v == std::numeric_limits<int64_t>::min()) low = 1, high = 0; else high = std::min(high, v - 1); break;
+                    case expr::le: high = std::min(high, v); break;
+                    case expr::gt: if (v == std::numeric_limits<int64_t>::max()) low = 1, high = 0; else low = std::max(low, v + 1); break;
+                    case expr::ge: low = std::max(low, v); break;
+                    default: break;
+                }
+            }
+            if (low > high) {
+                throw retry_instance{"no value of '" + fp.path + "' satisfies its constraints"};
+            }
+
+            int64_t value;
+            if (forced) {
+                value = *forced;
+            } else if (!fp.equals.empty()) {
+                value = eval(fp.equals[random.below(fp.equals.size())], f);
+            } else if (fp.origin == field_plan::source::length) {
+                const auto count = static_cast<int64_t>(draw(*fp.length));
+                value = clamp_to(count - fp.bias, low, high);
+            } else if (fp.origin == field_plan::source::selector) {
+                value = clamp_to(selector_candidate(*fp.selects, low, high), low, high);
+            } else if (enumeration && !enumeration->items.empty()) {
+                if (enumeration->is_bitmask) {
+                    uint64_t bits = 0;
+                    for (const auto& item : enumeration->items) {
+                        if (random.one_in(2)) bits |= item.value;
+                    }
+                    value = static_cast<int64_t>(bits);
+                } else {
+                    value = static_cast<int64_t>(enumeration->items[random.below(enumeration->items.size())].value);
+                }
+            } else if (fp.needs_value && fp.bounds.empty() && random.one_in(2)) {
+                // Values that steer decoding (lengths in expressions, flags)
+                // are kept small half of the time
+                value = clamp_to(static_cast<int64_t>(draw(options.array_length)), low, high);
+            } else {
+                value = random.between(low, high);
+            }
+
+            slot = value;
+            bool satisfied = true;
+            for (uint32_t check : fp.checks) {
+                if (eval(check, f) == 0) {
+                    satisfied = false;
+                    break;
+                }
+            }
+            if (satisfied) return value;
+            if (forced) break;
+        }
+        throw retry_instance{"no value of '" + fp.path + "' satisfies its constraints"};
+    }
+
+    /// Wire form of a field's scalar type (enums and subtypes use their base type)
+    std::optional<scalar_info> scalar_of(const type_ref& type, const enum_def** enumeration) {
+        *enumeration = nullptr;
+        if (type.kind == type_kind::enum_type && type.type_index && *type.type_index < ir.enums.size()) {
+            *enumeration = &ir.enums[*type.type_index];
+            return primitive_info((*enumeration)->base_type);
+        }
+        if (type.kind == type_kind::subtype_ref && type.type_index && *type.type_index < ir.subtypes.size()) {
+            return scalar_of(ir.subtypes[*type.type_index].base_type, enumeration);
+        }
+        return primitive_info(type);
+    }
+
+    // ------------------------------------------------------------------------
+    // Generation
+    // ------------------------------------------------------------------------
+
+    void enter(const std::string& name) {
+        if (++depth > 4 * options.max_depth + 64) {
+            throw synth_error("Type '" + name + "' nests without end; it cannot be synthesized");
+        }
+    }
+
+    size_t push_frame(frame& f, const layout& names, std::vector<field_plan>* fields, const frame* parent) {
+        f.names = &names;
+        f.fields = fields;
+        f.base = slots.size();
+        f.start = out().size();
+        f.parent = parent;
+        slots.resize(f.base + names.slot_names.size(), 0);
+        if (fields) {
+            for (const auto& fp : *fields) {
+                if (fp.state_slot != no_index) slots[f.base + fp.state_slot] = deferred_unwritten;
+                for (const auto& [member, state] : fp.deferred_members) {
+                    slots[f.base + state] = deferred_unwritten;
+                }
+            }
+        }
+        return f.base;
+    }
+
+    void gen_struct(struct_plan& plan, const frame* parent, std::optional<int64_t> forced_first,
+                    const field_plan* holder, size_t capture_base) {
+        enter(plan.def->name);
+        frame f;
+        push_frame(f, plan.frame, &plan.fields, parent);
+        for (const step& s : plan.steps) {
+            switch (s.kind) {
+                case step::fill:
+                    random.fill(out().extend(s.bytes), s.bytes);
+                    if (holder) mark_members(plan, s, *holder, capture_base, out().size() - s.bytes);
+                    break;
+                case step::bitfields:
+                    gen_bitfields(plan, s, f);
+                    break;
+                case step::single: {
+                    std::optional<int64_t> forced;
+                    if (s.first == 0) forced = forced_first;
+                    if (holder) mark_members(plan, s, *holder, capture_base, out().size());
+                    gen_field(plan.fields[s.first], f, forced);
+                    break;
+                }
+            }
+        }
+        if (holder) {
+            for (const auto& [child_slot, parent_slot] : holder->captures) {
+                slots[capture_base + parent_slot] = slots[f.base + child_slot];
+            }
+        }
+        slots.resize(f.base);
+        --depth;
+    }
+
+    /// Record where the holder's deferred members in this step are written,
+    /// for its label or substream to patch later
+    void mark_members(const struct_plan& plan, const step& s, const field_plan& holder,
+                      size_t holder_base, size_t at) {
+        for (size_t i = s.first; i < s.last; ++i) {
+            for (const auto& [member, state] : holder.deferred_members) {
+                if (member == i) slots[holder_base + state] = static_cast<int64_t>(at);
+            }
+            if (s.kind == step::fill) {
+                const type_ref& type = plan.fields[i].def->type;
+                at += is_integer_kind(type.kind) ? primitive_info(type)->width
+                                                 : primitive_info(*type.element_type)->width * *type.array_size;
+            }
+        }
+    }
+
+    void gen_bitfields(struct_plan& plan, const step& s, frame& f) {
+        // The first field's condition covers the whole run, as in the readers
+        const field_plan& head = plan.fields[s.first];
+        if (head.def->condition == field::never) return;
+        if (head.condition != no_node && eval(head.condition, f) == 0) return;
+
+        size_t total = 0;
+        for (size_t i = s.first; i < s.last; ++i) {
+            total += *plan.fields[i].def->type.bit_width;
+        }
+        const size_t bytes = (total + 7) / 8;
+        uint8_t* p = out().extend(bytes);
+        std::memset(p, 0, bytes);
+        const size_t at = out().size() - bytes;
+
+        size_t offset = 0;
+        for (size_t i = s.first; i < s.last; ++i) {
+            field_plan& fp = plan.fields[i];
+            const size_t width = *fp.def->type.bit_width;
+            const int64_t hi = width >= 63 ? std::numeric_limits<int64_t>::max()
+                                           : static_cast<int64_t>((uint64_t{1} << width) - 1);
+            uint64_t value;
+            if (fp.needs_value || !fp.checks.empty() || fp.origin != field_plan::source::random) {
+                value = static_cast<uint64_t>(choose(fp, f, 0, hi, nullptr));
+            } else {
+                value = random.next() & static_cast<uint64_t>(hi);
+            }
+            uint8_t* bits = out().data() + at;
+            for (size_t b = 0; b < width; ++b) {
+                if ((value >> b) & 1) bits[(offset + b) / 8] |= static_cast<uint8_t>(1u << ((offset + b) % 8));
+            }
+            offset += width;
+        }
+
+        // Slots hold what the readers extract (at most two bytes per field)
+        const uint8_t* bits = out().data() + at;
+        offset = 0;
+        for (size_t i = s.first; i < s.last; ++i) {
+            field_plan& fp = plan.fields[i];
+            const size_t width = *fp.def->type.bit_width;
+            const size_t byte_index = offset / 8, bit = offset % 8;
+            const uint64_t mask = width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+            uint64_t value;
+            if (bit + width > 8) {
+                const size_t first_bits = 8 - bit;
+                const uint64_t second_mask = (width - first_bits) >= 64 ? ~uint64_t{0}
+                                           : (uint64_t{1} << (width - first_bits)) - 1;
+                const uint64_t next = byte_index + 1 < bytes ? bits[byte_index + 1] : 0;
+                value = ((bits[byte_index] >> bit) & ((1u << first_bits) - 1)) | ((next & second_mask) << first_bits);
+            } else {
+                value = (bits[byte_index] >> bit) & mask;
+            }
+            slots[f.base + fp.slot] = static_cast<int64_t>(value);
+            offset += width;
+        }
+    }
+
+    void pad(size_t count, bool random_bytes) {
+        uint8_t* p = out().extend(count);
+        if (random_bytes) {
+            random.fill(p, count);
+        } else {
+            std::memset(p, 0, count);
+        }
+    }
+
+    /// Write a deferred field now that its value is known
+    void resolve(size_t field_index, size_t member, int64_t value, frame& f) {
+        if (member != no_index) {
+            resolve_member(field_index, member, value, f);
+            return;
+        }
+        field_plan& fp = (*f.fields)[field_index];
+        const int64_t state = slots[f.base + fp.state_slot];
+        if (state < 0) {
+            throw retry_instance{"'" + fp.path + "' was not written"};
+        }
+        const scalar_info info = *primitive_info(fp.def->type);
+        if (value < info.min() || value > info.max()) {
+            throw retry_instance{"'" + fp.path + "' cannot hold " + std::to_string(value)};
+        }
+        slots[f.base + fp.slot] = value;
+        slots[f.base + fp.state_slot] = deferred_resolved;
+        for (uint32_t check : fp.checks) {
+            if (eval(check, f) == 0) {
+                throw retry_instance{"'" + fp.path + "' = " + std::to_string(value) + " violates its constraints"};
+            }
+        }
+        put_uint(out().data() + static_cast<size_t>(state), static_cast<uint64_t>(value), info);
+    }
+
+    /// Patch a field of an already written nested struct
+    void resolve_member(size_t field_index, size_t member, int64_t value, frame& f) {
+        const field_plan& holder = (*f.fields)[field_index];
+        const field_plan& fp = struct_for(*holder.def->type.type_index).fields[member];
+        int64_t state = deferred_unwritten;
+        for (const auto& [deferred, slot] : holder.deferred_members) {
+            if (deferred == member) state = slots[f.base + slot];
+        }
+        if (state < 0) {
+            throw retry_instance{"'" + holder.def->name + "." + fp.def->name + "' was not written"};
+        }
+        const scalar_info info = *primitive_info(fp.def->type);
+        if (value < info.min() || value > info.max()) {
+            throw retry_instance{"'" + holder.def->name + "." + fp.def->name + "' cannot hold " +
+                                 std::to_string(value)};
+        }
+        for (const auto& [child_slot, parent_slot] : holder.captures) {
+            if (child_slot == fp.slot) slots[f.base + parent_slot] = value;
+        }
+        put_uint(out().data() + static_cast<size_t>(state), static_cast<uint64_t>(value), info);
+    }
+
+    void gen_field(field_plan& fp, frame& f, std::optional<int64_t> forced = std::nullopt) {
+        const field& def = *fp.def;
+        if (def.condition == field::never) return;
+        if (fp.condition != no_node && eval(fp.condition, f) == 0) return;
+
+        // Labels and alignment are relative to the enclosing struct
+        if (def.label) {
+            const size_t here = out().size() - f.start;
+            if (fp.label_field != no_index) {
+                const size_t gap = static_cast<size_t>(random.below(options.max_label_gap + 1));
+                pad(gap, true);
+                resolve(fp.label_field, fp.label_member, static_cast<int64_t>(here + gap) - fp.label_bias, f);
+            } else {
+                const int64_t target = eval(fp.label, f);
+                if (target < static_cast<int64_t>(here)) {
+                    throw retry_instance{"label of '" + fp.path + "' points back into data already written"};
+                }
+                const auto gap = static_cast<uint64_t>(target) - here;
+                if (gap > options.max_elements) {
+                    throw retry_instance{"label of '" + fp.path + "' skips " + std::to_string(gap) + " bytes"};
+                }
+                pad(static_cast<size_t>(gap), true);
+            }
+        }
+        if (def.alignment && *def.alignment > 1) {
+            const size_t here = out().size() - f.start;
+            const size_t align = static_cast<size_t>(*def.alignment);
+            pad((align - here % align) % align, false);
+        }
+
+        if (def.substream) {
+            gen_substream(fp, f);
+            return;
+        }
+
+        const type_ref& type = def.type;
+        if (forced && type.kind == type_kind::struct_type && type.type_index) {
+            // Anonymous choice block: its first field re-reads the discriminator
+            gen_struct(struct_for(*type.type_index), &f, forced, &fp, f.base);
+            return;
+        }
+        const enum_def* enumeration = nullptr;
+        if (auto info = scalar_of(type, &enumeration)) {
+            if (info->is_float) {
+                gen_float(*info);
+                return;
+            }
+            if (fp.origin == field_plan::source::deferred) {
+                slots[f.base + fp.state_slot] = static_cast<int64_t>(out().size());
+                std::memset(out().extend(info->width), 0, info->width);
+                return;
+            }
+            int64_t value;
+            if (fp.needs_value || !fp.checks.empty() || enumeration || info->is_bool ||
+                fp.origin != field_plan::source::random || forced) {
+                value = choose(fp, f, info->min(), info->max(), enumeration, forced);
+            } else {
+                value = static_cast<int64_t>(random.next());
+            }
+            put_uint(out().extend(info->width), static_cast<uint64_t>(value), *info);
+            return;
+        }
+        gen_value(type, fp, f, true);
+    }
+
+    void gen_float(const scalar_info& info) {
+        const double value = (random.unit() * 2.0 - 1.0) * 1.0e6;
+        uint64_t bits;
+        if (info.width == 4) {
+            bits = std::bit_cast<uint32_t>(static_cast<float>(value));
+        } else {
+            bits = std::bit_cast<uint64_t>(value);
+        }
+        put_uint(out().extend(info.width), bits, info);
+    }
+
+    /// Non-scalar values, and array elements (top = false)
+    void gen_value(const type_ref& type, field_plan& fp, frame& f, bool top) {
+        switch (type.kind) {
+            case type_kind::string:
+            case type_kind::u16_string:
+            case type_kind::u32_string:
+                gen_string(type);
+                return;
+            case type_kind::array_fixed:
+            case type_kind::array_variable:
+            case type_kind::array_ranged:
+                gen_array(type, fp, f, top);
+                return;
+            case type_kind::struct_type:
+                gen_struct(struct_for(*type.type_index), &f, std::nullopt,
+                           top ? &fp : nullptr, f.base);
+                return;
+            case type_kind::union_type:
+                gen_union(union_for(*type.type_index), &f);
+                return;
+            case type_kind::choice_type:
+                gen_choice_field(choice_for(*type.type_index), fp, f);
+                return;
+            case type_kind::subtype_ref: {
+                subtype_plan& plan = subtype_for(*type.type_index);
+                const enum_def* enumeration = nullptr;
+                auto info = scalar_of(plan.def->base_type, &enumeration);
+                if (!info) throw synth_error("Subtype '" + plan.def->name + "' has no scalar base type");
+                frame sf;
+                push_frame(sf, plan.frame, nullptr, &f);
+                const int64_t value = info->is_float ? 0 : choose(plan.value, sf, info->min(), info->max(), enumeration);
+                slots.resize(sf.base);
+                if (info->is_float) {
+                    gen_float(*info);
+                } else {
+                    put_uint(out().extend(info->width), static_cast<uint64_t>(value), *info);
+                }
+                return;
+            }
+            default: {
+                const enum_def* enumeration = nullptr;
+                auto info = scalar_of(type, &enumeration);
+                if (!info) throw synth_error("Cannot synthesize values of '" + fp.path + "'");
+                if (info->is_float) {
+                    gen_float(*info);
+                    return;
+                }
+                uint64_t value = random.next();
+                if (info->is_bool) {
+                    value &= 1;
+                } else if (enumeration && !enumeration->items.empty()) {
+                    value = enumeration->items[random.below(enumeration->items.size())].value;
+                }
+                put_uint(out().extend(info->width), value, *info);
+                return;
+            }
+        }
+    }
+
+    void gen_string(const type_ref& type) {
+        const uint64_t length = draw(options.string_length);
+        if (type.kind == type_kind::string) {
+            uint8_t* p = out().extend(length + 1);
+            for (uint64_t i = 0; i < length; i += 8) {
+                const uint64_t bits = random.next();
+                for (uint64_t j = i; j < std::min<uint64_t>(i + 8, length); ++j) {
+                    // Printable ASCII
+                    p[j] = static_cast<uint8_t>(0x20 + (((bits >> (8 * (j - i))) & 0xFF) * 95 >> 8));
+                }
+            }
+            p[length] = 0;
+            return;
+        }
+        scalar_info info;
+        info.width = type.kind == type_kind::u16_string ? 2 : 4;
+        info.bits = info.width * 8;
+        info.big = is_big_endian(type);
+        uint8_t* p = out().extend((length + 1) * info.width);
+        for (uint64_t i = 0; i < length; ++i) {
+            uint64_t unit = 0x20 + random.below(95);
+            if (random.one_in(8)) {
+                // Non-ASCII code point (never a surrogate)
+                unit = info.width == 2 ? 0xA0 + random.below(0xD800 - 0xA0)
+                                       : 0xA0 + random.below(0x10FFFF - 0xA0 - 0x800 + 1);
+                if (info.width == 4 && unit >= 0xD800) unit += 0x800;
+            }
+            put_uint(p + i * info.width, unit, info);
+        }
+        put_uint(p + length * info.width, 0, info);
+    }
+
+    void gen_array(const type_ref& type, field_plan& fp, frame& f, bool top) {
+        if (!type.element_type) throw synth_error("Array '" + fp.path + "' has no element type");
+        const type_ref& element = *type.element_type;
+
+        bool unbounded = false;
+        int64_t count;
+        if (type.array_size) {
+            count = static_cast<int64_t>(*type.array_size);
+        } else if (top && fp.count != no_node) {
+            count = eval(fp.count, f);
+        } else if (type.kind == type_kind::array_variable && !type.array_size_expr) {
+            count = static_cast<int64_t>(draw(*fp.elements));
+            unbounded = true;
+        } else {
+            throw synth_error("Cannot synthesize '" + fp.path + "': nested array with a runtime length");
+        }
+        if (top && type.kind == type_kind::array_ranged) {
+            if ((fp.min_count != no_node && count < eval(fp.min_count, f)) ||
+                (fp.max_count != no_node && count > eval(fp.max_count, f))) {
+                throw retry_instance{"length of '" + fp.path + "' is outside its range"};
+            }
+        }
+        if (count < 0 || static_cast<uint64_t>(count) > options.max_elements) {
+            throw retry_instance{"'" + fp.path + "' would have " + std::to_string(count) + " elements"};
+        }
+        const auto n = static_cast<size_t>(count);
+
+        // Scalars without per-element rules are one random fill
+        const enum_def* enumeration = nullptr;
+        auto info = scalar_of(element, &enumeration);
+        if (info && !info->is_float && !enumeration && element.kind != type_kind::subtype_ref) {
+            uint8_t* p = out().extend(n * info->width);
+            random.fill(p, n * info->width);
+            if (info->is_bool) {
+                for (size_t i = 0; i < n; ++i) p[i] &= 1;
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                gen_value(element, fp, f, false);
+            }
+        }
+        if (unbounded) {
+            out().close_tail(fp.path);
+        }
+    }
+
+    void gen_union(union_plan& plan, const frame* parent) {
+        enter(plan.def->name);
+        frame f;
+        push_frame(f, plan.frame, &plan.branches, parent);
+        if (plan.branches.empty()) throw synth_error("Union '" + plan.def->name + "' has no cases");
+
+        // Readers try branches in order: a later branch is valid only if
+        // every earlier one is rejected by a constraint
+        const size_t start = out().size();
+        bool done = false;
+        for (int attempt = 0; attempt < 4 && !done; ++attempt) {
+            const size_t k = random.below(plan.branches.size());
+            gen_field(plan.branches[k], f);
+            done = true;
+            for (size_t j = 0; j < k && done; ++j) {
+                done = rejects(plan.branches[j], start, f);
+            }
+            if (!done) out().truncate(start);
+        }
+        if (!done) {
+            gen_field(plan.branches[0], f);
+        }
+        slots.resize(f.base);
+        --depth;
+    }
+
+    /// Whether decoding a union branch from start fails a constraint in its
+    /// leading scalar fields
+    bool rejects(const field_plan& branch, size_t start, const frame& parent) {
+        const type_ref& type = branch.def->type;
+        if (type.kind != type_kind::struct_type || !type.type_index || branch.def->substream) return false;
+        struct_plan& plan = struct_for(*type.type_index);
+        frame f;
+        const size_t end = out().size();
+        push_frame(f, plan.frame, &plan.fields, &parent);
+        f.start = start;
+        size_t at = start;
+        bool rejected = false;
+        try {
+            for (auto& fp : plan.fields) {
+                const field& def = *fp.def;
+                const enum_def* enumeration = nullptr;
+                auto info = scalar_of(def.type, &enumeration);
+                if (!info || info->is_float || def.type.kind == type_kind::bitfield ||
+                    def.condition != field::always || def.label || def.alignment || def.substream ||
+                    at + info->width > end) {
+                    break;
+                }
+                slots[f.base + fp.slot] = get_int(out().data() + at, *info);
+                if (fp.state_slot != no_index) slots[f.base + fp.state_slot] = deferred_resolved;
+                at += info->width;
+                for (uint32_t check : fp.checks) {
+                    if (eval(check, f) == 0) {
+                        rejected = true;
+                        break;
+                    }
+                }
+                if (rejected) break;
+            }
+        } catch (const synth_error&) {
+            rejected = false;
+        } catch (const retry_instance&) {
+            rejected = false;
+        }
+        slots.resize(f.base);
+        return rejected;
+    }
+
+    void gen_choice_field(choice_plan& plan, field_plan& fp, frame& f) {
+        std::vector<int64_t> args;
+        args.reserve(fp.selector_args.size());
+        for (uint32_t arg : fp.selector_args) {
+            args.push_back(eval(arg, f));
+        }
+        std::optional<int64_t> selector;
+        if (!args.empty()) {
+            selector = args[0];
+        } else if (fp.selector != no_node) {
+            selector = eval(fp.selector, f);
+        }
+        gen_choice(plan, &f, args, selector);
+    }
+
+    void gen_choice(choice_plan& plan, const frame* parent, const std::vector<int64_t>& args,
+                    std::optional<int64_t> selector) {
+        enter(plan.def->name);
+        frame f;
+        push_frame(f, plan.frame, nullptr, parent);
+        for (size_t i = 0; i < plan.parameter_slots.size() && i < args.size(); ++i) {
+            slots[f.base + plan.parameter_slots[i]] = args[i];
+        }
+        if (plan.cases.empty()) throw synth_error("Choice '" + plan.def->name + "' has no cases");
+
+        if (plan.discriminator) {
+            gen_inline_choice(plan, f);
+        } else {
+            if (!selector) {
+                throw synth_error("Choice '" + plan.def->name + "' needs a selector");
+            }
+            auto index = match_case(plan, *selector, f);
+            if (!index) {
+                throw retry_instance{"no case of '" + plan.def->name + "' matches " + std::to_string(*selector)};
+            }
+            gen_field(plan.cases[*index].field, f);
+        }
+        slots.resize(f.base);
+        --depth;
+    }
+
+    void gen_inline_choice(choice_plan& plan, frame& f) {
+        const scalar_info& disc = *plan.discriminator;
+        const size_t start = out().size();
+        for (size_t attempt = 0; attempt < options.max_attempts; ++attempt) {
+            const size_t index = random.below(plan.cases.size());
+            auto& c = plan.cases[index];
+            std::optional<int64_t> value;
+            if (!c.is_default) {
+                // An earlier case may claim the value first
+                value = case_candidate(c, disc.min(), disc.max(), &f);
+                auto matched = match_case(plan, *value, f);
+                if (!matched || *matched != index) continue;
+                if (!c.rereads_discriminator) {
+                    put_uint(out().extend(disc.width), static_cast<uint64_t>(*value), disc);
+                    gen_field(c.field, f);
+                    return;
+                }
+            }
+
+            // Default and anonymous block cases: the reader peeks the
+            // discriminator from the case's own bytes
+            gen_field(c.field, f, value);
+            if (out().size() - start >= disc.width) {
+                auto matched = match_case(plan, get_int(out().data() + start, disc), f);
+                if (matched && *matched == index) return;
+            }
+            out().truncate(start);
+        }
+        throw retry_instance{"no case of '" + plan.def->name + "' could be encoded"};
+    }
+
+    void gen_substream(field_plan& fp, frame& f) {
+        const substream_def& s = *fp.def->substream;
+        std::optional<size_t> size;
+        if (fp.substream_field == no_index) {
+            const int64_t v = eval(fp.substream_size, f);
+            if (v < 0 || static_cast<uint64_t>(v) > options.max_elements) {
+                throw retry_instance{"substream '" + fp.path + "' would be " + std::to_string(v) + " bytes"};
+            }
+            size = static_cast<size_t>(v);
+        }
+        std::optional<size_t> raw_size = size;
+        if (size && s.transform == byte_transform::zlib) {
+            raw_size = stored_zlib_raw_size(*size);
+            if (!raw_size) {
+                throw retry_instance{"no zlib stream is " + std::to_string(*size) + " bytes"};
+            }
+        }
+        uint8_t param = 0;
+        if (fp.substream_param != no_node) {
+            param = static_cast<uint8_t>(eval(fp.substream_param, f));
+        }
+
+        // Decoded content, in a buffer of its own
+        if (++level == buffers.size()) buffers.emplace_back();
+        out().clear();
+        const type_ref& type = fp.def->type;
+        if (type.kind == type_kind::struct_type && type.type_index) {
+            gen_struct(struct_for(*type.type_index), &f, std::nullopt, nullptr, 0);
+            if (raw_size) {
+                if (out().size() > *raw_size) {
+                    throw retry_instance{"'" + fp.path + "' does not fit its substream"};
+                }
+                const size_t missing = *raw_size - out().size();
+                random.fill(out().extend(missing), missing);
+            }
+        } else {
+            const size_t n = raw_size ? *raw_size : static_cast<size_t>(draw(*fp.elements));
+            random.fill(out().extend(n), n);
+        }
+        byte_buffer& content = out();
+        --level;
+
+        const size_t before = out().size();
+        if (s.transform == byte_transform::zlib) {
+            write_stored_zlib(content.data(), content.size());
+        } else {
+            uint8_t* p = out().extend(content.size());
+            const unsigned bits = param & 7u;
+            for (size_t i = 0; i < content.size(); ++i) {
+                const uint8_t b = content.data()[i];
+                switch (s.transform) {
+                    case byte_transform::xor_key:
+                        p[i] = static_cast<uint8_t>(b ^ param);
+                        break;
+                    case byte_transform::rotate_left:   // Decoded = rotl(wire)
+                        p[i] = std::rotr(b, static_cast<int>(bits));
+                        break;
+                    case byte_transform::rotate_right:  // Decoded = rotr(wire)
+                        p[i] = std::rotl(b, static_cast<int>(bits));
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        if (fp.substream_field != no_index) {
+            resolve(fp.substream_field, fp.substream_member,
+                    static_cast<int64_t>(out().size() - before) - fp.substream_bias, f);
+        }
+    }
+
+    /// zlib stream of stored (uncompressed) deflate blocks
+    void write_stored_zlib(const uint8_t* data, size_t size) {
+        uint8_t* p = out().extend(stored_zlib_size(size));
+        *p++ = 0x78;
+        *p++ = 0x01;
+        size_t done = 0;
+        do {
+            const size_t chunk = std::min(size - done, stored_block_limit);
+            const bool last = done + chunk == size;
+            *p++ = last ? 0x01 : 0x00;
+            *p++ = static_cast<uint8_t>(chunk);
+            *p++ = static_cast<uint8_t>(chunk >> 8);
+            *p++ = static_cast<uint8_t>(~chunk);
+            *p++ = static_cast<uint8_t>(~chunk >> 8);
+            if (chunk > 0) std::memcpy(p, data + done, chunk);
+            p += chunk;
+            done += chunk;
+        } while (done < size);
+        // Adler-32, big-endian
+        uint32_t a = 1, b = 0;
+        for (size_t i = 0; i < size;) {
+            const size_t end = std::min(size, i + 5552);
+            for (; i < end; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        const uint32_t adler = (b << 16) | a;
+        *p++ = static_cast<uint8_t>(adler >> 24);
+        *p++ = static_cast<uint8_t>(adler >> 16);
+        *p++ = static_cast<uint8_t>(adler >> 8);
+        *p++ = static_cast<uint8_t>(adler);
+    }
+
+    // ------------------------------------------------------------------------
+    // ------------------------------------------------------------------------
+    // Entry points
+    // ------------------------------------------------------------------------
+
+    struct root {
+        struct_plan* structure = nullptr;
+        union_plan* alternatives = nullptr;
+        choice_plan* choice = nullptr;
+    };
+    std::map<std::string, root> roots;
+
+    root& root_for(const std::string& name) {
+        if (auto it = roots.find(name); it != roots.end()) {
+            return it->second;
+        }
+        root r;
+        for (size_t i = 0; i < ir.structs.size() && !r.structure; ++i) {
+            if (ir.structs[i].name == name) r.structure = &struct_for(i);
+        }
+        for (size_t i = 0; i < ir.unions.size() && !r.structure && !r.alternatives; ++i) {
+            if (ir.unions[i].name == name) r.alternatives = &union_for(i);
+        }
+        for (size_t i = 0; i < ir.choices.size() && !r.structure && !r.alternatives && !r.choice; ++i) {
+            if (ir.choices[i].name != name) continue;
+            r.choice = &choice_for(i);
+            if (!r.choice->discriminator) {
+                throw synth_error("Choice '" + name + "' takes its selector from an enclosing type; "
+                                  "synthesize the enclosing type instead");
+            }
+        }
+        if (!r.structure && !r.alternatives && !r.choice) {
+            throw synth_error("Unknown type '" + name + "'");
+        }
+        finalize_all();
+        return roots.emplace(name, r).first->second;
+    }
+
+    void reset() {
+        slots.clear();
+        level = 0;
+        depth = 0;
+    }
+
+    size_t append(const std::string& name, size_t count, std::vector<uint8_t>& result, bool records) {
+        reset();
+        const root& r = root_for(name);
+        byte_buffer& buffer = buffers.front();
+        buffer.clear();
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t attempt = 1;; ++attempt) {
+                const size_t start = buffer.size();
+                try {
+                    if (r.structure) {
+                        gen_struct(*r.structure, nullptr, std::nullopt, nullptr, 0);
+                    } else if (r.alternatives) {
+                        gen_union(*r.alternatives, nullptr);
+                    } else {
+                        gen_choice(*r.choice, nullptr, {}, std::nullopt);
+                    }
+                    break;
+                } catch (const retry_instance& e) {
+                    reset();
+                    buffer.truncate(start);
+                    if (attempt >= options.max_attempts) {
+                        throw synth_error("Could not synthesize '" + name + "' in " +
+                                          std::to_string(attempt) + " attempts: " + e.reason);
+                    }
+                } catch (...) {
+                    reset();
+                    throw;
+                }
+            }
+            if (records && count > 1 && buffer.has_tail()) {
+                throw synth_error("'" + name + "' ends in unbounded array '" + buffer.tail_name() +
+                                  "'; back-to-back records would run together");
+            }
+        }
+        result.insert(result.end(), buffer.data(), buffer.data() + buffer.size());
+        return buffer.size();
+    }
+};
+
+// ============================================================================
+// Public Interface
+// ============================================================================
+
+instance_generator::instance_generator(const bundle& b, synth_options options)
+    : impl_(std::make_unique<impl>(b, std::move(options))) {}
+
+instance_generator::~instance_generator() = default;
+
+instance_generator::instance_generator(instance_generator&&) noexcept = default;
+instance_generator& instance_generator::operator=(instance_generator&&) noexcept = default;
+
+size_t instance_generator::generate(const std::string& type_name, std::vector<uint8_t>& out) {
+    return impl_->append(type_name, 1, out, false);
+}
+
+size_t instance_generator::generate_records(const std::string& type_name, size_t count,
+                                            std::vector<uint8_t>& out) {
+    return impl_->append(type_name, count, out, true);
+}
+
+void instance_generator::reseed(uint64_t seed) {
+    impl_->random.reseed(seed);
+}
+
+} // namespace datascript::ir
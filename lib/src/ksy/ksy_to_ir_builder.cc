@@ -353,6 +353,22 @@ ir::field KsyToIrBuilder::build_field(const fkyaml::node& item) {
         }
     }
 
+    // Handle byte transforms ('process'): the region is parsed lazily
+    if (item.contains("process") && item["process"].is_string()) {
+        field.substream = map_process(item["process"].get_value<std::string>(), item);
+        if (!item.contains("type")) {
+            // Raw bytes: uint8 name[] receives the decoded region
+            ir::type_ref array_type;
+            array_type.kind = ir::type_kind::array_variable;
+            array_type.source = {"", 0, 0};
+            array_type.size_bytes = 0;
+            array_type.alignment = 1;
+            array_type.is_variable_size = true;
+            array_type.element_type = std::make_unique<ir::type_ref>(std::move(field.type));
+            field.type = std::move(array_type);
+        }
+    }
+
     return field;
 }
 
@@ -468,11 +484,33 @@ ir::type_ref KsyToIrBuilder::map_type(const std::string& ksy_type) {
         return type;
     }
 
-    // Unsupported types (Phase 1)
-    if (ksy_type == "f4" || ksy_type == "f8") {
-        unsupported("floating-point types",
-                   "DataScript does not support floating-point types (f4, f8).\n"
-                   "  Consider using fixed-point integers or external conversion.");
+    if (ksy_type == "f4" || ksy_type == "f4le") {
+        type.kind = ir::type_kind::float32;
+        type.byte_order = ir::endianness::little;
+        type.size_bytes = 4;
+        type.alignment = 4;
+        return type;
+    }
+    if (ksy_type == "f4be") {
+        type.kind = ir::type_kind::float32;
+        type.byte_order = ir::endianness::big;
+        type.size_bytes = 4;
+        type.alignment = 4;
+        return type;
+    }
+    if (ksy_type == "f8" || ksy_type == "f8le") {
+        type.kind = ir::type_kind::float64;
+        type.byte_order = ir::endianness::little;
+        type.size_bytes = 8;
+        type.alignment = 8;
+        return type;
+    }
+    if (ksy_type == "f8be") {
+        type.kind = ir::type_kind::float64;
+        type.byte_order = ir::endianness::big;
+        type.size_bytes = 8;
+        type.alignment = 8;
+        return type;
     }
 
     // Unknown type - assume user-defined struct
@@ -515,6 +553,70 @@ ir::expr KsyToIrBuilder::map_expression(const std::string& expr_str) {
                "Complex expressions not yet supported: " + expr_str);
 }
 
+ir::substream_def KsyToIrBuilder::map_process(const std::string& process, const fkyaml::node& item) {
+    ir::substream_def result;
+
+    // Region length
+    if (item.contains("size") && item["size"].is_integer()) {
+        result.size = ir::expr::make_literal_int(static_cast<uint64_t>(item["size"].get_value<int64_t>()),
+                                                 {"", 0, 0});
+    } else if (item.contains("size") && item["size"].is_string()) {
+        result.size = map_expression(item["size"].get_value<std::string>());
+    } else {
+        unsupported("process", "'process' requires a 'size' (size-eos is not supported)");
+    }
+
+    // Name and optional argument: xor(0x5a), rol(3), zlib
+    std::string name = process;
+    std::string argument;
+    auto open = process.find('(');
+    if (open != std::string::npos) {
+        auto close = process.rfind(')');
+        if (close == std::string::npos || close < open) {
+            unsupported("process", "Malformed process: " + process);
+        }
+        name = process.substr(0, open);
+        argument = process.substr(open + 1, close - open - 1);
+        argument.erase(0, argument.find_first_not_of(' '));
+        argument.erase(argument.find_last_not_of(' ') + 1);
+    }
+
+    if (name == "zlib" && argument.empty()) {
+        result.transform = ir::byte_transform::zlib;
+        return result;
+    }
+    if (name == "xor") {
+        result.transform = ir::byte_transform::xor_key;
+    } else if (name == "rol") {
+        result.transform = ir::byte_transform::rotate_left;
+    } else if (name == "ror") {
+        result.transform = ir::byte_transform::rotate_right;
+    } else {
+        unsupported("process: " + name, "Only xor, rol, ror and zlib are supported");
+    }
+    if (argument.empty() || argument[0] == '[') {
+        unsupported("process: " + process, "Expected a single-byte key or bit count");
+    }
+
+    // Integer literal (decimal or 0x hex) or field reference
+    if (std::isdigit(static_cast<unsigned char>(argument[0]))) {
+        size_t parsed = 0;
+        uint64_t value = 0;
+        try {
+            value = std::stoull(argument, &parsed, 0);
+        } catch (const std::exception&) {
+            parsed = 0;
+        }
+        if (parsed != argument.size() || value > 0xFF) {
+            unsupported("process: " + process, "Expected a single-byte key or bit count");
+        }
+        result.parameter = ir::expr::make_literal_int(value, {"", 0, 0});
+    } else {
+        result.parameter = map_expression(argument);
+    }
+    return result;
+}
+
 void KsyToIrBuilder::unsupported(const std::string& feature,
                                const std::string& message) {
     throw KsyError(feature, message);
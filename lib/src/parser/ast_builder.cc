@@ -85,7 +85,10 @@ namespace {
     };
 }
 
-/* Helper to extract string from token (creates a std::string) */
+/* Helper to extract string from token (creates a std::string)
+ * Tokens point into the scanned source buffer, so this is the only copy of
+ * the text; identifiers are not interned because the public AST owns its
+ * names as std::string, and short names fit the small-string buffer anyway. */
 static std::string extract_string(const token_value_t* tok) {
     if (!tok || !tok->start || !tok->end) {
         return {};
@@ -369,6 +372,10 @@ ast_type_t* parser_bool_to_type(ast_bool_type_t* b) {
     return reinterpret_cast <ast_type_t*>(b);
 }
 
+ast_type_t* parser_float_to_type(ast_float_type_t* f) {
+    return reinterpret_cast <ast_type_t*>(f);
+}
+
 ast_type_t* parser_bitfield_to_type(ast_bitfield_type_t* bf) {
     return reinterpret_cast <ast_type_t*>(bf);
 }
@@ -613,6 +620,24 @@ ast_u32_string_type_t* parser_build_u32_string_type(parser_context_t* ctx, int e
     }
 }
 
+ast_float_type_t* parser_build_float_type(parser_context_t* ctx, int bits, int endian_param) {
+    if (!ctx || !ctx->ast_builder) {
+        return nullptr;
+    }
+
+    try {
+        using namespace datascript::ast;
+        endian e = endian::unspec;
+        if (endian_param == datascript::parser::ENDIAN_LITTLE) e = endian::little;
+        else if (endian_param == datascript::parser::ENDIAN_BIG) e = endian::big;
+
+        return simple_types <ast_float_type_t, float_type>::make(ctx, static_cast <std::uint32_t>(bits), e);
+    } catch (const std::exception& ex) {
+        parser_set_error(ctx, PARSER_ERROR_SEMANTIC, "Failed to build float type: %s", ex.what());
+        return nullptr;
+    }
+}
+
 ast_bool_type_t* parser_build_bool_type(parser_context_t* ctx) {
     if (!ctx || !ctx->ast_builder) {
         return nullptr;
@@ -1523,6 +1548,62 @@ ast_alignment_directive_t* parser_build_alignment_directive(parser_context_t* ct
     }
 }
 
+/* Array transform directive builder */
+ast_transform_directive_t* parser_build_transform_directive(parser_context_t* ctx, token_value_t* name_tok) {
+    if (!ctx || !ctx->ast_builder || !name_tok) {
+        return nullptr;
+    }
+
+    try {
+        ctx->ast_builder->temp_transforms.emplace_back(
+            transform_directive{
+                make_pos(ctx),
+                extract_string(name_tok),
+                {}
+            }
+        );
+
+        return reinterpret_cast <ast_transform_directive_t*>(&ctx->ast_builder->temp_transforms.back());
+    } catch (const std::exception& e) {
+        parser_set_error(ctx, PARSER_ERROR_SEMANTIC, "Failed to build transform directive: %s", e.what());
+        return nullptr;
+    }
+}
+
+/* Substream transform directive builder: @zlib(size) */
+ast_transform_directive_t* parser_build_transform_directive_args(parser_context_t* ctx, token_value_t* name_tok,
+                                                                 ast_arg_list_t* args) {
+    // RAII guard ensures automatic cleanup on all paths
+    datascript::parser::arg_list_guard arg_guard(reinterpret_cast <arg_list_holder*>(args));
+
+    if (!ctx || !ctx->ast_builder || !name_tok) {
+        return nullptr;
+    }
+
+    try {
+        std::vector <expr> arguments;
+        if (arg_guard) {
+            for (auto* arg_ptr : arg_guard->args) {
+                auto* expr_ptr = reinterpret_cast <expr*>(arg_ptr);
+                arguments.push_back(std::move(*expr_ptr));
+            }
+        }
+
+        ctx->ast_builder->temp_transforms.emplace_back(
+            transform_directive{
+                make_pos(ctx),
+                extract_string(name_tok),
+                std::move(arguments)
+            }
+        );
+
+        return reinterpret_cast <ast_transform_directive_t*>(&ctx->ast_builder->temp_transforms.back());
+    } catch (const std::exception& e) {
+        parser_set_error(ctx, PARSER_ERROR_SEMANTIC, "Failed to build transform directive: %s", e.what());
+        return nullptr;
+    }
+}
+
 /* Convert label directive to body item */
 ast_struct_body_item_t* parser_label_to_body_item(parser_context_t* ctx, ast_label_directive_t* label) {
     if (!ctx || !ctx->ast_builder || !label) {
@@ -1563,6 +1644,26 @@ ast_struct_body_item_t* parser_alignment_to_body_item(parser_context_t* ctx, ast
     }
 }
 
+/* Convert transform directive to body item */
+ast_struct_body_item_t* parser_transform_to_body_item(parser_context_t* ctx, ast_transform_directive_t* transform) {
+    if (!ctx || !ctx->ast_builder || !transform) {
+        return nullptr;
+    }
+
+    try {
+        auto* transform_ptr = reinterpret_cast <transform_directive*>(transform);
+
+        ctx->ast_builder->temp_body_items.emplace_back(
+            std::move(*transform_ptr)
+        );
+
+        return reinterpret_cast <ast_struct_body_item_t*>(&ctx->ast_builder->temp_body_items.back());
+    } catch (const std::exception& e) {
+        parser_set_error(ctx, PARSER_ERROR_SEMANTIC, "Failed to convert transform to body item: %s", e.what());
+        return nullptr;
+    }
+}
+
 /* Convert field to body item */
 ast_struct_body_item_t* parser_field_to_body_item(parser_context_t* ctx, ast_field_def_t* field) {
     if (!ctx || !ctx->ast_builder || !field) {
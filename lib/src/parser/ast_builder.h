@@ -69,6 +69,7 @@ typedef struct ast_string_type ast_string_type_t;
 typedef struct ast_u16_string_type ast_u16_string_type_t;
 typedef struct ast_u32_string_type ast_u32_string_type_t;
 typedef struct ast_bool_type ast_bool_type_t;
+typedef struct ast_float_type ast_float_type_t;
 typedef struct ast_bitfield_type ast_bitfield_type_t;
 typedef struct ast_qualified_name ast_qualified_name_t;
 typedef struct ast_array_type_fixed ast_array_type_fixed_t;
@@ -104,6 +105,7 @@ typedef struct ast_field_def ast_field_def_t;
 typedef struct ast_field_list ast_field_list_t;
 typedef struct ast_label_directive ast_label_directive_t;
 typedef struct ast_alignment_directive ast_alignment_directive_t;
+typedef struct ast_transform_directive ast_transform_directive_t;
 typedef struct ast_struct_body_item ast_struct_body_item_t;
 typedef struct ast_struct_body_list ast_struct_body_list_t;
 typedef struct ast_struct_def ast_struct_def_t;
@@ -153,6 +155,7 @@ ast_string_type_t* parser_build_string_type(parser_context_t* ctx);
 ast_u16_string_type_t* parser_build_u16_string_type(parser_context_t* ctx, int endian);
 ast_u32_string_type_t* parser_build_u32_string_type(parser_context_t* ctx, int endian);
 ast_bool_type_t* parser_build_bool_type(parser_context_t* ctx);
+ast_float_type_t* parser_build_float_type(parser_context_t* ctx, int bits, int endian);
 ast_bitfield_type_t* parser_build_bit_field(parser_context_t* ctx, token_value_t* width_tok);
 ast_bitfield_type_t* parser_build_bit_field_expr(parser_context_t* ctx, ast_expr_t* width_expr);
 
@@ -213,6 +216,10 @@ ast_label_directive_t* parser_build_label_directive(parser_context_t* ctx, ast_e
 ast_alignment_directive_t* parser_build_alignment_directive(parser_context_t* ctx, ast_expr_t* alignment_expr);
 ast_struct_body_item_t* parser_label_to_body_item(parser_context_t* ctx, ast_label_directive_t* label);
 ast_struct_body_item_t* parser_alignment_to_body_item(parser_context_t* ctx, ast_alignment_directive_t* alignment);
+ast_transform_directive_t* parser_build_transform_directive(parser_context_t* ctx, token_value_t* name_tok);
+ast_transform_directive_t* parser_build_transform_directive_args(parser_context_t* ctx, token_value_t* name_tok,
+                                                                 ast_arg_list_t* args);
+ast_struct_body_item_t* parser_transform_to_body_item(parser_context_t* ctx, ast_transform_directive_t* transform);
 ast_struct_body_item_t* parser_field_to_body_item(parser_context_t* ctx, ast_field_def_t* field);
 ast_struct_body_item_t* parser_field_to_body_item_with_docstring(parser_context_t* ctx, ast_field_def_t* field, token_value_t* docstring);
 ast_struct_body_list_t* parser_build_struct_body_list_single(parser_context_t* ctx, ast_struct_body_item_t* item);
@@ -269,6 +276,7 @@ ast_type_t* parser_string_to_type(ast_string_type_t* str);
 ast_type_t* parser_u16_string_to_type(ast_u16_string_type_t* str);
 ast_type_t* parser_u32_string_to_type(ast_u32_string_type_t* str);
 ast_type_t* parser_bool_to_type(ast_bool_type_t* b);
+ast_type_t* parser_float_to_type(ast_float_type_t* f);
 ast_type_t* parser_bitfield_to_type(ast_bitfield_type_t* bf);
 ast_type_t* parser_qualified_name_to_type(ast_qualified_name_t* qname);
 ast_type_t* parser_array_fixed_to_type(ast_array_type_fixed_t* arr);
@@ -22,6 +22,7 @@ struct ast_module_holder {
     std::deque<datascript::ast::field_def> temp_fields;
     std::deque<datascript::ast::label_directive> temp_labels;
     std::deque<datascript::ast::alignment_directive> temp_alignments;
+    std::deque<datascript::ast::transform_directive> temp_transforms;
     std::deque<datascript::ast::struct_body_item> temp_body_items;
     std::deque<datascript::ast::choice_case> temp_choice_cases;
     std::deque<datascript::ast::union_case> temp_union_cases;
@@ -80,6 +80,7 @@ void ParseTrace(FILE *TraceFILE, char *zTracePrompt);
 %type string_type {ast_string_type_t*}
 %type u16_string_type {ast_u16_string_type_t*}
 %type u32_string_type {ast_u32_string_type_t*}
+%type float_type {ast_float_type_t*}
 %type bool_type {ast_bool_type_t*}
 %type bit_field_type {ast_bitfield_type_t*}
 %type qualified_name {ast_qualified_name_t*}
@@ -124,6 +125,7 @@ void ParseTrace(FILE *TraceFILE, char *zTracePrompt);
 %token BOOL STRING U16STRING U32STRING BIT.
 %token UINT8 UINT16 UINT32 UINT64 UINT128.
 %token INT8 INT16 INT32 INT64 INT128.
+%token FLOAT32 FLOAT64.
 %token SEMICOLON COMMA DOT DOTDOT COLON EQUALS.
 %token LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET.
 %token LT GT PLUS MINUS STAR SLASH PERCENT QUESTION AT.
@@ -260,6 +262,7 @@ base_type_specifier(R) ::= string_type(T). { R = parser_string_to_type(T); }
 base_type_specifier(R) ::= u16_string_type(T). { R = parser_u16_string_to_type(T); }
 base_type_specifier(R) ::= u32_string_type(T). { R = parser_u32_string_to_type(T); }
 base_type_specifier(R) ::= bool_type(T). { R = parser_bool_to_type(T); }
+base_type_specifier(R) ::= float_type(T). { R = parser_float_to_type(T); }
 base_type_specifier(R) ::= bit_field_type(T). { R = parser_bitfield_to_type(T); }
 base_type_specifier(R) ::= qualified_name(Q). { R = parser_qualified_name_to_type(Q); }
 base_type_specifier(R) ::= type_instantiation(I). { R = parser_type_instantiation_to_type(I); }
@@ -304,6 +307,26 @@ integer_type(R) ::= INT128. {
     R = parser_build_integer_type(ctx, 1, 128, 0);
 }
 
+/* IEEE-754 Floating-Point Types with optional endianness */
+float_type(R) ::= FLOAT32. {
+    R = parser_build_float_type(ctx, 32, 0);  /* 0 = unspec */
+}
+float_type(R) ::= LITTLE FLOAT32. {
+    R = parser_build_float_type(ctx, 32, 1);  /* 1 = little */
+}
+float_type(R) ::= BIG FLOAT32. {
+    R = parser_build_float_type(ctx, 32, 2);  /* 2 = big */
+}
+float_type(R) ::= FLOAT64. {
+    R = parser_build_float_type(ctx, 64, 0);  /* 0 = unspec */
+}
+float_type(R) ::= LITTLE FLOAT64. {
+    R = parser_build_float_type(ctx, 64, 1);  /* 1 = little */
+}
+float_type(R) ::= BIG FLOAT64. {
+    R = parser_build_float_type(ctx, 64, 2);  /* 2 = big */
+}
+
 /* String and Boolean Types */
 string_type(R) ::= STRING. {
     R = parser_build_string_type(ctx);
@@ -559,13 +582,25 @@ struct_body_list(R) ::= struct_body_list(L) struct_body_item(I). {
     R = parser_build_struct_body_list_append(ctx, L, I);
 }
 
-/* Struct body item - can be field, label, or alignment */
-/* Note: Labels and alignment don't have docstrings, only fields do */
+/* Struct body item - can be field, label, alignment, or array transform */
+/* Note: Labels, alignment and transforms don't have docstrings, only fields do */
 struct_body_item(R) ::= ALIGN LPAREN expression(E) RPAREN COLON. {
     ast_alignment_directive_t* align = parser_build_alignment_directive(ctx, E);
     R = parser_alignment_to_body_item(ctx, align);
 }
 
+/* Array transform for the next field: @delta, @delta_of_delta, @zigzag_delta */
+struct_body_item(R) ::= AT IDENTIFIER(N). {
+    ast_transform_directive_t* transform = parser_build_transform_directive(ctx, N);
+    R = parser_transform_to_body_item(ctx, transform);
+}
+
+/* Substream transform for the next field: @xor(size, key), @rol(size, bits), @zlib(size) */
+struct_body_item(R) ::= AT IDENTIFIER(N) LPAREN argument_list_content(A) RPAREN. {
+    ast_transform_directive_t* transform = parser_build_transform_directive_args(ctx, N, A);
+    R = parser_transform_to_body_item(ctx, transform);
+}
+
 /* Label expression - identifier or field access, but not array indexing or function calls */
 /* This avoids ambiguity with array type syntax like Type[10] field; */
 label_expression(R) ::= primary_expression(E). {
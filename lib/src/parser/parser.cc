@@ -2,8 +2,6 @@
  * DataScript Parser - C++ Interface
  */
 
-#include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <array>
 #include <cstring>
@@ -17,6 +15,8 @@
 #include "parser/ast_holder.hh"
 #include "parser/scanner_context.h"
 #include "parser/parser_context.h"
+#include "parser/parser_constants.h"
+#include "parser/source_buffer.hh"
 
 /* Forward declarations for Lemon */
 extern "C" {
@@ -30,29 +30,28 @@ int parser_scan_token(scanner_context_t* ctx, parser_context_t* pctx, token_valu
 namespace {
     class scanner {
         public:
-            scanner(const char* input, size_t length, const char* filename) {
+            /* Scans the buffer in place; it already carries the zero padding re2c needs */
+            scanner(const datascript::parser::source_buffer& input, const char* filename) {
                 m_ctx = new scanner_context_t;
-                constexpr size_t PADDING = 32;
-                char* padded_input = new char[length + PADDING];
+                const char* data = input.data();
 
-                memcpy(padded_input, input, length);
-                memset(padded_input + length, 0, PADDING); /* Fill padding with nulls */
-
-                m_ctx->input = padded_input;
-                m_ctx->cursor = padded_input;
-                m_ctx->eof = padded_input + length; /* End of actual data */
-                m_ctx->limit = padded_input + length + PADDING; /* End of buffer with padding */
-                m_ctx->marker = padded_input;
+                m_ctx->input = data;
+                m_ctx->cursor = data;
+                m_ctx->eof = data + input.size(); /* End of actual data */
+                m_ctx->limit = data + input.size() + datascript::parser::INPUT_BUFFER_PADDING; /* End of buffer with padding */
+                m_ctx->marker = data;
                 m_ctx->line = 1;
                 m_ctx->column = 1;
                 m_ctx->filename = filename ? filename : "<input>";
             }
 
             ~scanner() {
-                delete [] m_ctx->input;
                 delete m_ctx;
             }
 
+            scanner(const scanner&) = delete;
+            scanner& operator =(const scanner&) = delete;
+
             int operator ()(token_value_t* token, parser_context_t* pctx) {
                 return parser_scan_token(m_ctx, pctx, token);
             }
@@ -196,11 +195,11 @@ int parser_parse(parser& the_parser, parser_context_t& ctx, scanner& lexer) {
 namespace datascript {
     /* Implementation details */
     namespace {
-        ast::module parse_datascript_impl(const std::string& input, const std::string& filename) {
+        ast::module parse_datascript_impl(const parser::source_buffer& input, const std::string& filename) {
             /* Create parser context */
-            parser the_parser;
+            ::parser the_parser;  /* Lemon wrapper (not the datascript::parser namespace) */
 
-            scanner lexer(input.c_str(), input.length(), filename.c_str());
+            scanner lexer(input, filename.c_str());
             parser_context ctx{};
             ctx.m_scanner = lexer.get();
             ast_module_holder holder;
@@ -229,15 +228,8 @@ namespace datascript {
 
     /* Public API */
     ast::module parse_datascript(const std::filesystem::path& path) {
-        /* Read file contents */
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file: " + path.string());
-        }
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
+        /* Map the file; the scanner reads it in place without copying */
+        auto content = parser::source_buffer::from_file(path);
 
         /* Parse with filename for error reporting */
         return parse_datascript_impl(content, path.string());
@@ -245,6 +237,6 @@ namespace datascript {
 
     ast::module parse_datascript(const std::string& text) {
         /* Parse with generic filename */
-        return parse_datascript_impl(text, "<string>");
+        return parse_datascript_impl(parser::source_buffer::from_text(text), "<string>");
     }
 } // namespace datascript
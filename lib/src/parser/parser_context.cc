@@ -72,6 +72,8 @@ const char* parser_get_token_name(int token_code) {
         case TOKEN_INT32: return "'int32'";
         case TOKEN_INT64: return "'int64'";
         case TOKEN_INT128: return "'int128'";
+        case TOKEN_FLOAT32: return "'float32'";
+        case TOKEN_FLOAT64: return "'float64'";
         case TOKEN_SEMICOLON: return "';'";
         case TOKEN_COMMA: return "','";
         case TOKEN_DOT: return "'.'";
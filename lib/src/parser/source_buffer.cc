@@ -0,0 +1,131 @@
+//
+// Source buffer for the re2c scanner - file mapping and padded copies
+//
+
+#include "parser/source_buffer.hh"
+#include "parser/parser_constants.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DATASCRIPT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace datascript::parser {
+
+source_buffer source_buffer::from_text(std::string_view text) {
+    source_buffer buf;
+    buf.m_owned = new char[text.size() + INPUT_BUFFER_PADDING];
+    if (!text.empty()) {
+        memcpy(buf.m_owned, text.data(), text.size());
+    }
+    memset(buf.m_owned + text.size(), 0, INPUT_BUFFER_PADDING); /* Fill padding with nulls */
+    buf.m_data = buf.m_owned;
+    buf.m_size = text.size();
+    return buf;
+}
+
+namespace {
+    source_buffer read_file(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file: " + path.string());
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return source_buffer::from_text(buffer.str());
+    }
+}
+
+source_buffer source_buffer::from_file(const std::filesystem::path& path) {
+#if defined(DATASCRIPT_HAVE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path.string());
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        /* Pipes, devices and empty files are read the ordinary way */
+        ::close(fd);
+        return read_file(path);
+    }
+
+    /*
+     * Reserve an anonymous zero-filled region large enough for the file plus
+     * the scanner padding, then map the file over its start. The kernel
+     * zero-fills the tail of the file's last page, and any whole pages after
+     * it stay anonymous, so the padding never requires copying the input.
+     */
+    const auto size = static_cast<size_t>(st.st_size);
+    const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t total = (size + INPUT_BUFFER_PADDING + page - 1) / page * page;
+
+    void* base = ::mmap(nullptr, total, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return read_file(path);
+    }
+
+    void* file = ::mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    ::close(fd);
+    if (file == MAP_FAILED) {
+        ::munmap(base, total);
+        return read_file(path);
+    }
+
+    source_buffer buf;
+    buf.m_data = static_cast<const char*>(base);
+    buf.m_size = size;
+    buf.m_mapping_size = total;
+    return buf;
+#else
+    return read_file(path);
+#endif
+}
+
+source_buffer::source_buffer(source_buffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_mapping_size(std::exchange(other.m_mapping_size, 0)),
+      m_owned(std::exchange(other.m_owned, nullptr)) {
+}
+
+source_buffer& source_buffer::operator =(source_buffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_mapping_size = std::exchange(other.m_mapping_size, 0);
+        m_owned = std::exchange(other.m_owned, nullptr);
+    }
+    return *this;
+}
+
+source_buffer::~source_buffer() {
+    release();
+}
+
+void source_buffer::release() noexcept {
+#if defined(DATASCRIPT_HAVE_MMAP)
+    if (m_mapping_size != 0) {
+        ::munmap(const_cast<char*>(m_data), m_mapping_size);
+    }
+#endif
+    delete [] m_owned;
+    m_data = nullptr;
+    m_owned = nullptr;
+    m_size = 0;
+    m_mapping_size = 0;
+}
+
+} // namespace datascript::parser
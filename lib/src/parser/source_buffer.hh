@@ -0,0 +1,49 @@
+//
+// Source buffer for the re2c scanner
+//
+// The scanner needs INPUT_BUFFER_PADDING zero bytes after the last input
+// byte (sentinel + lookahead). Files are memory-mapped so that this padding
+// comes from the mapping itself instead of a copy of the whole file.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace datascript::parser {
+
+/* Read-only scanner input with guaranteed zero padding after the data */
+class source_buffer {
+    public:
+        /* Map a file; falls back to reading it when mapping is unavailable */
+        static source_buffer from_file(const std::filesystem::path& path);
+
+        /* Copy in-memory text into a padded buffer */
+        static source_buffer from_text(std::string_view text);
+
+        source_buffer(source_buffer&& other) noexcept;
+        source_buffer& operator =(source_buffer&& other) noexcept;
+        source_buffer(const source_buffer&) = delete;
+        source_buffer& operator =(const source_buffer&) = delete;
+        ~source_buffer();
+
+        /* First input byte; data()[size() .. size() + padding) are zero */
+        [[nodiscard]] const char* data() const { return m_data; }
+        [[nodiscard]] size_t size() const { return m_size; }
+
+        /* True if the input is backed by a file mapping (no copy was made) */
+        [[nodiscard]] bool is_mapped() const { return m_mapping_size != 0; }
+
+    private:
+        source_buffer() = default;
+        void release() noexcept;
+
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_mapping_size = 0;  /* Non-zero: m_data is an mmap region of this size */
+        char* m_owned = nullptr;    /* Heap buffer when not mapped */
+};
+
+} // namespace datascript::parser
@@ -31,7 +31,7 @@ namespace datascript::semantic {
         analyzed.symbols = std::move(symbols);
 
         // Phase 2: Name resolution
-        phases::resolve_names(modules, analyzed, diagnostics);
+        phases::resolve_names(modules, analyzed, diagnostics, opts.jobs);
 
         // Check for errors after name resolution
         has_errors = std::any_of(diagnostics.begin(), diagnostics.end(),
@@ -43,19 +43,25 @@ namespace datascript::semantic {
         }
 
         // Phase 3: Type checking
-        phases::check_types(modules, analyzed, diagnostics);
+        phases::check_types(modules, analyzed, diagnostics, opts.jobs);
 
         // Phase 4: Constant evaluation
-        phases::evaluate_constants(modules, analyzed, diagnostics);
+        phases::evaluate_constants(modules, analyzed, diagnostics, opts.jobs);
 
         // Phase 5: Size calculation
-        phases::calculate_sizes(modules, analyzed, diagnostics);
+        phases::calculate_sizes(modules, analyzed, diagnostics, opts.jobs);
+        phases::calculate_wire_bounds(modules, analyzed, opts.jobs);
 
         // Phase 6: Constraint validation
-        phases::validate_constraints(modules, analyzed, diagnostics);
+        phases::validate_constraints(modules, analyzed, diagnostics, opts.jobs);
 
         // Phase 7: Reachability analysis
-        phases::analyze_reachability(modules, analyzed, diagnostics);
+        phases::analyze_reachability(modules, analyzed, diagnostics, opts.jobs);
+
+        // Phase 8: Decode cost analysis (optional)
+        if (opts.check_decode_cost) {
+            phases::analyze_decode_cost(modules, analyzed, diagnostics, opts.jobs);
+        }
 
         // Filter diagnostics by minimum level and disabled warnings
         std::vector <diagnostic> filtered_diags;
@@ -0,0 +1,103 @@
+//
+// Parallel work distribution for semantic analysis phases
+//
+// Phases split their work into independent tasks (one per module, type or
+// constant). Each task writes only to its own slot, so results and
+// diagnostics can be merged afterwards in task order, which keeps the output
+// identical to a serial run regardless of the number of worker threads.
+//
+
+#pragma once
+
+#include <datascript/semantic.hh>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace datascript::semantic::detail {
+
+/// Resolve the requested job count: 0 means "one per hardware thread".
+inline size_t effective_jobs(size_t jobs) {
+    if (jobs == 0) {
+        jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return jobs;
+}
+
+/// Run fn(i) for every i in [0, count) on up to `jobs` threads.
+///
+/// Tasks are handed out dynamically from a shared counter so uneven task
+/// sizes balance out. With jobs <= 1 (or a single task) everything runs
+/// inline on the calling thread. The first exception thrown by any task is
+/// rethrown after all workers have joined.
+template<typename Fn>
+void parallel_for(size_t count, size_t jobs, Fn&& fn) {
+    size_t workers = std::min(effective_jobs(jobs), count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(workers);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            try {
+                for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                    fn(i);
+                }
+            } catch (...) {
+                errors[w] = std::current_exception();
+                next.store(count);  // Stop handing out work
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+/// Append per-task diagnostic buffers [begin, end) to `out` in task order.
+inline void merge_diagnostics(std::vector<std::vector<diagnostic>>& buffers,
+                              size_t begin, size_t end,
+                              std::vector<diagnostic>& out) {
+    for (size_t i = begin; i < end; ++i) {
+        out.insert(out.end(),
+                   std::make_move_iterator(buffers[i].begin()),
+                   std::make_move_iterator(buffers[i].end()));
+    }
+}
+
+/// Append all per-task diagnostic buffers to `out` in task order.
+inline void merge_diagnostics(std::vector<std::vector<diagnostic>>& buffers,
+                              std::vector<diagnostic>& out) {
+    merge_diagnostics(buffers, 0, buffers.size(), out);
+}
+
+/// All modules of a module set in analysis order (main first, then imports).
+inline std::vector<const ast::module*> modules_in_order(const module_set& modules) {
+    std::vector<const ast::module*> result;
+    result.reserve(1 + modules.imported.size());
+    result.push_back(&modules.main.module);
+    for (const auto& imported : modules.imported) {
+        result.push_back(&imported.module);
+    }
+    return result;
+}
+
+} // namespace datascript::semantic::detail
@@ -6,6 +6,7 @@
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
 
 namespace datascript::semantic::phases {
@@ -94,46 +95,53 @@ namespace {
         return std::nullopt;
     }
 
+    // Per-module resolution state: shared read-only symbols plus a private
+    // output map, so modules can be resolved concurrently
+    struct resolution_context {
+        const symbol_table& symbols;
+        std::map<const ast::qualified_name*, analyzed_module_set::resolved_type> resolved_types;
+    };
+
     // Forward declaration
     void resolve_type(
         const ast::type& type_node,
-        analyzed_module_set& analyzed,
+        resolution_context& ctx,
         std::vector<diagnostic>& diags);
 
     // Resolve array element type (recursive)
     void resolve_array_type(
         const ast::type& element_type,
-        analyzed_module_set& analyzed,
+        resolution_context& ctx,
         std::vector<diagnostic>& diags)
     {
-        resolve_type(element_type, analyzed, diags);
+        resolve_type(element_type, ctx, diags);
     }
 
     // Main type resolution function
     void resolve_type(
         const ast::type& type_node,
-        analyzed_module_set& analyzed,
+        resolution_context& ctx,
         std::vector<diagnostic>& diags)
     {
         // qualified_name is the only type that needs resolution
         if (auto* qname = std::get_if<ast::qualified_name>(&type_node.node)) {
             // Resolve to actual definition
-            auto resolved = resolve_qualified_name(*qname, analyzed.symbols, diags);
+            auto resolved = resolve_qualified_name(*qname, ctx.symbols, diags);
 
             // Store resolution only if successful
             if (resolved.has_value()) {
-                analyzed.resolved_types[qname] = resolved.value();
+                ctx.resolved_types[qname] = resolved.value();
             }
         }
         // Array types: recursively resolve element type
         else if (auto* arr_fixed = std::get_if<ast::array_type_fixed>(&type_node.node)) {
-            resolve_array_type(*arr_fixed->element_type, analyzed, diags);
+            resolve_array_type(*arr_fixed->element_type, ctx, diags);
         }
         else if (auto* arr_range = std::get_if<ast::array_type_range>(&type_node.node)) {
-            resolve_array_type(*arr_range->element_type, analyzed, diags);
+            resolve_array_type(*arr_range->element_type, ctx, diags);
         }
         else if (auto* arr_unsized = std::get_if<ast::array_type_unsized>(&type_node.node)) {
-            resolve_array_type(*arr_unsized->element_type, analyzed, diags);
+            resolve_array_type(*arr_unsized->element_type, ctx, diags);
         }
         // Primitive types, string, bool, bitfield - no resolution needed
     }
@@ -198,18 +206,18 @@ namespace {
 
     void resolve_module_names(
         const ast::module& mod,
-        analyzed_module_set& analyzed,
+        resolution_context& ctx,
         std::vector<diagnostic>& diags)
     {
         // Resolve type references in constants
         for (const auto& const_def : mod.constants) {
-            resolve_type(const_def.ctype, analyzed, diags);
-            resolve_expr(const_def.value, analyzed.symbols, diags);
+            resolve_type(const_def.ctype, ctx, diags);
+            resolve_expr(const_def.value, ctx.symbols, diags);
         }
 
         // Resolve target types in type aliases
         for (const auto& type_alias : mod.type_aliases) {
-            resolve_type(type_alias.target_type, analyzed, diags);
+            resolve_type(type_alias.target_type, ctx, diags);
         }
 
         // Resolve field types and functions in structs
@@ -217,29 +225,29 @@ namespace {
             for (const auto& body_item : struct_def.body) {
                 // Process fields
                 if (auto* field = std::get_if<ast::field_def>(&body_item)) {
-                    resolve_type(field->field_type, analyzed, diags);
+                    resolve_type(field->field_type, ctx, diags);
 
                     // Resolve condition expression if present
                     if (field->condition) {
-                        resolve_expr(field->condition.value(), analyzed.symbols, diags);
+                        resolve_expr(field->condition.value(), ctx.symbols, diags);
                     }
                 }
                 // Process functions
                 else if (auto* func = std::get_if<ast::function_def>(&body_item)) {
                     // Resolve return type
-                    resolve_type(func->return_type, analyzed, diags);
+                    resolve_type(func->return_type, ctx, diags);
 
                     // Resolve parameter types
                     for (const auto& param : func->parameters) {
-                        resolve_type(param.param_type, analyzed, diags);
+                        resolve_type(param.param_type, ctx, diags);
                     }
 
                     // Resolve expressions in function body
                     for (const auto& stmt : func->body) {
                         if (auto* ret_stmt = std::get_if<ast::return_statement>(&stmt)) {
-                            resolve_expr(ret_stmt->value, analyzed.symbols, diags);
+                            resolve_expr(ret_stmt->value, ctx.symbols, diags);
                         } else if (auto* expr_stmt = std::get_if<ast::expression_statement>(&stmt)) {
-                            resolve_expr(expr_stmt->expression, analyzed.symbols, diags);
+                            resolve_expr(expr_stmt->expression, ctx.symbols, diags);
                         }
                     }
                 }
@@ -255,10 +263,10 @@ namespace {
                     // (inline types are converted to named types in phase 0)
                     if (std::holds_alternative<ast::field_def>(item)) {
                         const auto& field = std::get<ast::field_def>(item);
-                        resolve_type(field.field_type, analyzed, diags);
+                        resolve_type(field.field_type, ctx, diags);
 
                         if (field.condition) {
-                            resolve_expr(field.condition.value(), analyzed.symbols, diags);
+                            resolve_expr(field.condition.value(), ctx.symbols, diags);
                         }
                     }
                     // Note: labels, alignments, functions, inline types shouldn't appear here
@@ -267,19 +275,19 @@ namespace {
 
                 // Resolve case condition if present
                 if (union_case.condition) {
-                    resolve_expr(union_case.condition.value(), analyzed.symbols, diags);
+                    resolve_expr(union_case.condition.value(), ctx.symbols, diags);
                 }
             }
         }
 
         // Resolve base types in enums
         for (const auto& enum_def : mod.enums) {
-            resolve_type(enum_def.base_type, analyzed, diags);
+            resolve_type(enum_def.base_type, ctx, diags);
 
             // Resolve enum item value expressions
             for (const auto& item : enum_def.items) {
                 if (item.value) {
-                    resolve_expr(item.value.value(), analyzed.symbols, diags);
+                    resolve_expr(item.value.value(), ctx.symbols, diags);
                 }
             }
         }
@@ -288,22 +296,22 @@ namespace {
         for (const auto& choice_def : mod.choices) {
             // Only resolve selector for external discriminator choices
             if (choice_def.selector.has_value()) {
-                resolve_expr(choice_def.selector.value(), analyzed.symbols, diags);
+                resolve_expr(choice_def.selector.value(), ctx.symbols, diags);
             }
 
             for (const auto& case_def : choice_def.cases) {
                 // Resolve case expressions
                 for (const auto& case_expr : case_def.case_exprs) {
-                    resolve_expr(case_expr, analyzed.symbols, diags);
+                    resolve_expr(case_expr, ctx.symbols, diags);
                 }
 
                 // Resolve field type (after desugaring, items[0] contains the field_def)
                 if (!case_def.items.empty() && std::holds_alternative<ast::field_def>(case_def.items[0])) {
                     const auto& field = std::get<ast::field_def>(case_def.items[0]);
-                    resolve_type(field.field_type, analyzed, diags);
+                    resolve_type(field.field_type, ctx, diags);
 
                     if (field.condition) {
-                        resolve_expr(field.condition.value(), analyzed.symbols, diags);
+                        resolve_expr(field.condition.value(), ctx.symbols, diags);
                     }
                 }
             }
@@ -313,11 +321,11 @@ namespace {
         for (const auto& constraint_def : mod.constraints) {
             // Resolve parameter types
             for (const auto& param : constraint_def.params) {
-                resolve_type(param.param_type, analyzed, diags);
+                resolve_type(param.param_type, ctx, diags);
             }
 
             // Resolve condition expression
-            resolve_expr(constraint_def.condition, analyzed.symbols, diags);
+            resolve_expr(constraint_def.condition, ctx.symbols, diags);
         }
     }
 
@@ -330,15 +338,27 @@ namespace {
 void resolve_names(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    // Resolve names in main module
-    resolve_module_names(modules.main.module, analyzed, diagnostics);
+    // Modules resolve independently against the (read-only) symbol table
+    auto mods = detail::modules_in_order(modules);
+    std::vector<resolution_context> contexts;
+    contexts.reserve(mods.size());
+    for (size_t i = 0; i < mods.size(); ++i) {
+        contexts.push_back(resolution_context{analyzed.symbols, {}});
+    }
+    std::vector<std::vector<diagnostic>> diags(mods.size());
+
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        resolve_module_names(*mods[i], contexts[i], diags[i]);
+    });
 
-    // Resolve names in all imported modules
-    for (const auto& imported : modules.imported) {
-        resolve_module_names(imported.module, analyzed, diagnostics);
+    // Merge in module order (main first, then imports)
+    for (auto& ctx : contexts) {
+        analyzed.resolved_types.merge(ctx.resolved_types);
     }
+    detail::merge_diagnostics(diags, diagnostics);
 }
 
 } // namespace datascript::semantic::phases
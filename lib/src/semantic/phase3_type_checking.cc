@@ -5,10 +5,14 @@
 // are performed on compatible types.
 //
 // This phase focuses on validation only - it doesn't build a type map.
+// It also classifies struct member functions as pure (see
+// analyzed_module_set::pure_functions) for code generation.
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
+#include <set>
 
 namespace datascript::semantic::phases {
 
@@ -35,6 +39,7 @@ namespace {
 
     enum class type_cat {
         integer,
+        floating,
         boolean,
         string,
         array,
@@ -47,6 +52,9 @@ namespace {
         if (std::holds_alternative<ast::primitive_type>(t.node)) {
             return type_cat::integer;
         }
+        if (std::holds_alternative<ast::float_type>(t.node)) {
+            return type_cat::floating;
+        }
         if (std::holds_alternative<ast::bool_type>(t.node)) {
             return type_cat::boolean;
         }
@@ -72,6 +80,7 @@ namespace {
     std::string type_cat_to_string(type_cat cat) {
         switch (cat) {
             case type_cat::integer: return "integer";
+            case type_cat::floating: return "floating-point";
             case type_cat::boolean: return "boolean";
             case type_cat::string: return "string";
             case type_cat::array: return "array";
@@ -82,6 +91,17 @@ namespace {
         return "unknown";
     }
 
+    // Integers and floating-point values mix in arithmetic and comparisons
+    bool is_numeric(type_cat cat) {
+        return cat == type_cat::integer || cat == type_cat::floating;
+    }
+
+    // Result category of numeric arithmetic: floating-point if either side is
+    type_cat numeric_result(type_cat left, type_cat right) {
+        return (left == type_cat::floating || right == type_cat::floating)
+            ? type_cat::floating : type_cat::integer;
+    }
+
     // Convert binary operator to readable string for error messages
     std::string op_to_string(ast::binary_op op) {
         switch (op) {
@@ -155,6 +175,21 @@ namespace {
             case ast::binary_op::sub:
             case ast::binary_op::mul:
             case ast::binary_op::div:
+                // Arithmetic operators accept integer or floating-point operands
+                if (!is_numeric(left_cat)) {
+                    add_error(diags, diag_codes::E_INVALID_OPERAND_TYPE,
+                        "Operator '" + op_to_string(binary.op) + "' requires numeric operands, " +
+                        "but left operand has type '" + type_cat_to_string(left_cat) + "'",
+                        binary.pos);
+                }
+                if (!is_numeric(right_cat)) {
+                    add_error(diags, diag_codes::E_INVALID_OPERAND_TYPE,
+                        "Operator '" + op_to_string(binary.op) + "' requires numeric operands, " +
+                        "but right operand has type '" + type_cat_to_string(right_cat) + "'",
+                        binary.pos);
+                }
+                return numeric_result(left_cat, right_cat);
+
             case ast::binary_op::mod:
             case ast::binary_op::bit_and:
             case ast::binary_op::bit_or:
@@ -184,6 +219,7 @@ namespace {
             case ast::binary_op::ge:
                 // Comparison operators require compatible operands
                 if (left_cat != right_cat &&
+                    !(is_numeric(left_cat) && is_numeric(right_cat)) &&
                     left_cat != type_cat::unknown &&
                     right_cat != type_cat::unknown) {
                     add_error(diags, diag_codes::E_INCOMPATIBLE_TYPES,
@@ -226,6 +262,14 @@ namespace {
         switch (unary.op) {
             case ast::unary_op::neg:
             case ast::unary_op::pos:
+                if (!is_numeric(operand_cat)) {
+                    add_error(diags, diag_codes::E_INVALID_OPERAND_TYPE,
+                        "Operator '" + op_to_string(unary.op) + "' requires numeric operand, " +
+                        "but got type '" + type_cat_to_string(operand_cat) + "'",
+                        unary.pos);
+                }
+                return operand_cat == type_cat::floating ? type_cat::floating : type_cat::integer;
+
             case ast::unary_op::bit_not:
                 if (operand_cat != type_cat::integer) {
                     add_error(diags, diag_codes::E_INVALID_OPERAND_TYPE,
@@ -264,12 +308,16 @@ namespace {
         }
 
         if (true_cat != false_cat &&
+            !(is_numeric(true_cat) && is_numeric(false_cat)) &&
             true_cat != type_cat::unknown &&
             false_cat != type_cat::unknown) {
             add_error(diags, diag_codes::E_INCOMPATIBLE_TYPES,
                 "Ternary branches have incompatible types", ternary.pos);
         }
 
+        if (is_numeric(true_cat) && is_numeric(false_cat)) {
+            return numeric_result(true_cat, false_cat);
+        }
         return true_cat;
     }
 
@@ -504,13 +552,190 @@ namespace {
         return type_cat::unknown;
     }
 
+    // ========================================================================
+    // Transform Directives
+    // ========================================================================
+
+    bool is_known_transform(const std::string& name) {
+        return name == "delta" || name == "delta_of_delta" || name == "zigzag_delta";
+    }
+
+    bool is_substream_transform(const std::string& name) {
+        return name == "xor" || name == "rol" || name == "ror" || name == "zlib";
+    }
+
+    // @zlib(size); @xor(size, key), @rol(size, bits), @ror(size, bits)
+    size_t substream_arg_count(const std::string& name) {
+        return name == "zlib" ? 1 : 2;
+    }
+
+    // A substream parses a struct without parameters, or keeps the bytes (uint8[])
+    bool is_substream_target(const ast::type& type, const analyzed_module_set& analyzed) {
+        if (auto* qname = std::get_if<ast::qualified_name>(&type.node)) {
+            auto* struct_def = analyzed.symbols.find_struct_qualified(qname->parts);
+            return struct_def && struct_def->parameters.empty();
+        }
+        if (auto* unsized = std::get_if<ast::array_type_unsized>(&type.node)) {
+            auto* prim = std::get_if<ast::primitive_type>(&unsized->element_type->node);
+            return prim && !prim->is_signed && prim->bits == 8;
+        }
+        return false;
+    }
+
+    // @delta and friends apply to the next field, which must be a sized
+    // array of integers no wider than 64 bits; substream transforms apply to
+    // a struct (or uint8[]) field parsed from a region of the given size
+    void check_array_transforms(
+        const std::vector<ast::struct_body_item>& body,
+        const analyzed_module_set& analyzed,
+        std::vector<diagnostic>& diags)
+    {
+        const ast::transform_directive* pending = nullptr;
+
+        for (const auto& item : body) {
+            if (auto* transform = std::get_if<ast::transform_directive>(&item)) {
+                if (is_known_transform(transform->name)) {
+                    if (!transform->args.empty()) {
+                        add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                            "Array transform '@" + transform->name + "' takes no arguments",
+                            transform->pos);
+                    }
+                } else if (is_substream_transform(transform->name)) {
+                    size_t expected = substream_arg_count(transform->name);
+                    if (transform->args.size() != expected) {
+                        add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                            "Substream transform '@" + transform->name + "' expects " +
+                            (expected == 1 ? "(size)" : transform->name == "xor" ? "(size, key)" : "(size, bits)") +
+                            " but got " + std::to_string(transform->args.size()) + " argument(s)",
+                            transform->pos);
+                    }
+                } else {
+                    add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                        "Unknown transform '@" + transform->name +
+                        "' (expected @delta, @delta_of_delta, @zigzag_delta, @xor, @rol, @ror or @zlib)",
+                        transform->pos);
+                }
+                if (pending) {
+                    add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                        "Only one transform may be applied to a field",
+                        transform->pos);
+                }
+                pending = transform;
+                continue;
+            }
+
+            auto* field = std::get_if<ast::field_def>(&item);
+            if (!field) {
+                continue;  // Labels and alignment may sit between the transform and its field
+            }
+            if (!pending) {
+                continue;
+            }
+
+            if (is_substream_transform(pending->name)) {
+                if (!is_substream_target(field->field_type, analyzed)) {
+                    add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                        "Substream transform '@" + pending->name + "' requires a struct without "
+                        "parameters or a uint8[] field, but field '" + field->name + "' is neither",
+                        pending->pos);
+                }
+                pending = nullptr;
+                continue;
+            }
+
+            const ast::type* element = nullptr;
+            if (auto* fixed = std::get_if<ast::array_type_fixed>(&field->field_type.node)) {
+                element = fixed->element_type.get();
+            } else if (auto* ranged = std::get_if<ast::array_type_range>(&field->field_type.node)) {
+                element = ranged->element_type.get();
+            }
+
+            auto* prim = element ? std::get_if<ast::primitive_type>(&element->node) : nullptr;
+            if (!prim || prim->bits > 64) {
+                add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                    "Array transform '@" + pending->name + "' requires a sized array of "
+                    "integers up to 64 bits, but field '" + field->name + "' is not one",
+                    pending->pos);
+            }
+            pending = nullptr;
+        }
+
+        if (pending) {
+            add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                "Transform '@" + pending->name + "' is not followed by a field",
+                pending->pos);
+        }
+    }
+
+    // Array sizes, labels, alignment and substream arguments become size_t
+    // counts and offsets in generated code, so a floating-point expression
+    // there is rejected. Only the category is checked: these expressions may
+    // name parameters, which the context cannot resolve, so diagnostics from
+    // inside the expression are not reported here.
+    void check_integer_operand(
+        const ast::expr& expr,
+        const std::string& what,
+        const ast::source_pos& pos,
+        const analyzed_module_set& analyzed,
+        const type_check_context& ctx,
+        std::vector<diagnostic>& diags)
+    {
+        std::vector<diagnostic> scratch;
+        if (check_expr_with_context(expr, analyzed, ctx, scratch) == type_cat::floating) {
+            add_error(diags, diag_codes::E_INVALID_OPERAND_TYPE,
+                what + " must be integer type", pos);
+        }
+    }
+
+    void check_array_size_operands(
+        const ast::type& type,
+        const ast::source_pos& pos,
+        const analyzed_module_set& analyzed,
+        const type_check_context& ctx,
+        std::vector<diagnostic>& diags)
+    {
+        if (auto* fixed = std::get_if<ast::array_type_fixed>(&type.node)) {
+            check_integer_operand(fixed->size, "Array size", pos, analyzed, ctx, diags);
+            check_array_size_operands(*fixed->element_type, pos, analyzed, ctx, diags);
+        } else if (auto* ranged = std::get_if<ast::array_type_range>(&type.node)) {
+            if (ranged->min_size) {
+                check_integer_operand(ranged->min_size.value(), "Array size", pos, analyzed, ctx, diags);
+            }
+            check_integer_operand(ranged->max_size, "Array size", pos, analyzed, ctx, diags);
+            check_array_size_operands(*ranged->element_type, pos, analyzed, ctx, diags);
+        } else if (auto* unsized = std::get_if<ast::array_type_unsized>(&type.node)) {
+            check_array_size_operands(*unsized->element_type, pos, analyzed, ctx, diags);
+        }
+    }
+
+    void check_integer_operands(
+        const std::vector<ast::struct_body_item>& items,
+        const analyzed_module_set& analyzed,
+        const type_check_context& ctx,
+        std::vector<diagnostic>& diags)
+    {
+        for (const auto& item : items) {
+            if (auto* field = std::get_if<ast::field_def>(&item)) {
+                check_array_size_operands(field->field_type, field->pos, analyzed, ctx, diags);
+            } else if (auto* label = std::get_if<ast::label_directive>(&item)) {
+                check_integer_operand(label->label_expr, "Label", label->pos, analyzed, ctx, diags);
+            } else if (auto* alignment = std::get_if<ast::alignment_directive>(&item)) {
+                check_integer_operand(alignment->alignment_expr, "Alignment", alignment->pos, analyzed, ctx, diags);
+            } else if (auto* transform = std::get_if<ast::transform_directive>(&item)) {
+                for (const auto& arg : transform->args) {
+                    check_integer_operand(arg, "Substream argument", transform->pos, analyzed, ctx, diags);
+                }
+            }
+        }
+    }
+
     // ========================================================================
     // Module-Level Type Checking
     // ========================================================================
 
     void check_module_types(
         const ast::module& mod,
-        analyzed_module_set& analyzed,
+        const analyzed_module_set& analyzed,
         std::vector<diagnostic>& diags)
     {
         // Check constant definitions
@@ -564,6 +789,14 @@ namespace {
                                 field->pos);
                         }
                     }
+                    if (field->constraint) {
+                        auto constraint_cat = check_expr_with_context(field->constraint.value(), analyzed, ctx, diags);
+                        if (constraint_cat != type_cat::boolean && constraint_cat != type_cat::unknown) {
+                            add_error(diags, diag_codes::E_TYPE_MISMATCH,
+                                "Field constraint must be boolean type",
+                                field->pos);
+                        }
+                    }
                 }
             }
         }
@@ -586,6 +819,14 @@ namespace {
                                     field.pos);
                             }
                         }
+                        if (field.constraint) {
+                            auto constraint_cat = check_expr_with_context(field.constraint.value(), analyzed, ctx, diags);
+                            if (constraint_cat != type_cat::boolean && constraint_cat != type_cat::unknown) {
+                                add_error(diags, diag_codes::E_TYPE_MISMATCH,
+                                    "Field constraint must be boolean type",
+                                    field.pos);
+                            }
+                        }
                     }
                 }
 
@@ -634,6 +875,16 @@ namespace {
                                 field.pos);
                         }
                     }
+                    if (field.constraint) {
+                        type_check_context ctx;
+                        ctx.current_choice = &choice_def;
+                        auto constraint_cat = check_expr_with_context(field.constraint.value(), analyzed, ctx, diags);
+                        if (constraint_cat != type_cat::boolean && constraint_cat != type_cat::unknown) {
+                            add_error(diags, diag_codes::E_TYPE_MISMATCH,
+                                "Case field constraint must be boolean type",
+                                field.pos);
+                        }
+                    }
                 }
             }
         }
@@ -728,6 +979,43 @@ namespace {
             }
         };
 
+        // Validate array and substream transform directives (struct fields only)
+        for (const auto& struct_def : mod.structs) {
+            check_array_transforms(struct_def.body, analyzed, diags);
+        }
+        for (const auto& union_def : mod.unions) {
+            for (const auto& union_case : union_def.cases) {
+                for (const auto& item : union_case.items) {
+                    if (auto* transform = std::get_if<ast::transform_directive>(&item)) {
+                        add_error(diags, diag_codes::E_INVALID_DIRECTIVE,
+                            "Transforms are only supported on struct fields",
+                            transform->pos);
+                    }
+                }
+            }
+        }
+
+        // Counts, offsets and lengths must not be floating-point
+        for (const auto& struct_def : mod.structs) {
+            type_check_context ctx;
+            ctx.current_struct = &struct_def;
+            check_integer_operands(struct_def.body, analyzed, ctx, diags);
+        }
+        for (const auto& union_def : mod.unions) {
+            type_check_context ctx;
+            ctx.current_union = &union_def;
+            for (const auto& union_case : union_def.cases) {
+                check_integer_operands(union_case.items, analyzed, ctx, diags);
+            }
+        }
+        for (const auto& choice_def : mod.choices) {
+            type_check_context ctx;
+            ctx.current_choice = &choice_def;
+            for (const auto& case_def : choice_def.cases) {
+                check_integer_operands(case_def.items, analyzed, ctx, diags);
+            }
+        }
+
         // Validate struct field types
         for (const auto& struct_def : mod.structs) {
             for (const auto& body_item : struct_def.body) {
@@ -760,6 +1048,138 @@ namespace {
         }
     }
 
+    // ========================================================================
+    // Function Purity
+    // ========================================================================
+
+    // Classifies the member functions of one struct. Function bodies cannot
+    // assign, so a function is pure unless it recurses or calls something
+    // other than a member function of the struct or a method of a field.
+    class function_purity_analyzer {
+    public:
+        explicit function_purity_analyzer(const ast::struct_def& struct_def) {
+            for (const auto& item : struct_def.body) {
+                if (auto* field = std::get_if<ast::field_def>(&item)) {
+                    fields_.insert(field->name);
+                } else if (auto* func = std::get_if<ast::function_def>(&item)) {
+                    functions_[func->name] = func;
+                }
+            }
+        }
+
+        // Add every pure function with the fields it reads to result
+        void run(std::map<const ast::function_def*, std::set<std::string>>& result) {
+            for (const auto& [name, func] : functions_) {
+                if (visit(*func)) {
+                    result[func] = states_[func].inputs;
+                }
+            }
+        }
+
+    private:
+        struct state {
+            bool visiting = false;
+            bool done = false;
+            bool pure = false;
+            std::set<std::string> inputs;  // Fields read directly or through calls
+        };
+
+        bool visit(const ast::function_def& func) {
+            auto& st = states_[&func];
+            if (st.done) {
+                return st.pure;
+            }
+            if (st.visiting) {
+                return false;  // Recursion: the call graph has no bottom to memoize
+            }
+            st.visiting = true;
+
+            std::set<std::string> locals;
+            for (const auto& param : func.parameters) {
+                locals.insert(param.name);
+            }
+
+            bool pure = true;
+            for (const auto& stmt : func.body) {
+                if (auto* ret = std::get_if<ast::return_statement>(&stmt)) {
+                    pure = collect(ret->value, locals, st.inputs) && pure;
+                } else if (auto* expr_stmt = std::get_if<ast::expression_statement>(&stmt)) {
+                    pure = collect(expr_stmt->expression, locals, st.inputs) && pure;
+                }
+            }
+
+            st.visiting = false;
+            st.done = true;
+            st.pure = pure;
+            return pure;
+        }
+
+        // Record the fields expr reads; false if it makes the function impure
+        bool collect(const ast::expr& expr, const std::set<std::string>& locals,
+                     std::set<std::string>& inputs) {
+            if (auto* id = std::get_if<ast::identifier>(&expr.node)) {
+                // Anything else is a constant, enum item or type parameter
+                if (!locals.contains(id->name) && fields_.contains(id->name)) {
+                    inputs.insert(id->name);
+                }
+                return true;
+            }
+            if (auto* unary = std::get_if<ast::unary_expr>(&expr.node)) {
+                return collect(*unary->operand, locals, inputs);
+            }
+            if (auto* binary = std::get_if<ast::binary_expr>(&expr.node)) {
+                bool left = collect(*binary->left, locals, inputs);
+                return collect(*binary->right, locals, inputs) && left;
+            }
+            if (auto* ternary = std::get_if<ast::ternary_expr>(&expr.node)) {
+                bool cond = collect(*ternary->condition, locals, inputs);
+                bool t = collect(*ternary->true_expr, locals, inputs);
+                return collect(*ternary->false_expr, locals, inputs) && cond && t;
+            }
+            if (auto* access = std::get_if<ast::field_access_expr>(&expr.node)) {
+                return collect(*access->object, locals, inputs);
+            }
+            if (auto* index = std::get_if<ast::array_index_expr>(&expr.node)) {
+                bool array = collect(*index->array, locals, inputs);
+                return collect(*index->index, locals, inputs) && array;
+            }
+            if (auto* call = std::get_if<ast::function_call_expr>(&expr.node)) {
+                bool pure = true;
+                for (const auto& arg : call->arguments) {
+                    pure = collect(arg, locals, inputs) && pure;
+                }
+                if (auto* callee = std::get_if<ast::identifier>(&call->function->node)) {
+                    auto it = functions_.find(callee->name);
+                    if (it == functions_.end() || !visit(*it->second)) {
+                        return false;
+                    }
+                    const auto& callee_inputs = states_[it->second].inputs;
+                    inputs.insert(callee_inputs.begin(), callee_inputs.end());
+                    return pure;
+                }
+                if (auto* method = std::get_if<ast::field_access_expr>(&call->function->node)) {
+                    // A method of a field reads only that field
+                    return collect(*method->object, locals, inputs) && pure;
+                }
+                return false;
+            }
+            return true;  // Literals
+        }
+
+        std::set<std::string> fields_;
+        std::map<std::string, const ast::function_def*> functions_;
+        std::map<const ast::function_def*, state> states_;
+    };
+
+    void classify_module_functions(
+        const ast::module& mod,
+        std::map<const ast::function_def*, std::set<std::string>>& result)
+    {
+        for (const auto& struct_def : mod.structs) {
+            function_purity_analyzer(struct_def).run(result);
+        }
+    }
+
 } // anonymous namespace
 
 // ============================================================================
@@ -769,14 +1189,23 @@ namespace {
 void check_types(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    // Check types in main module
-    check_module_types(modules.main.module, analyzed, diagnostics);
+    // Type checking only reads the analysis state, so modules are independent
+    auto mods = detail::modules_in_order(modules);
+    std::vector<std::vector<diagnostic>> diags(mods.size());
+
+    std::vector<std::map<const ast::function_def*, std::set<std::string>>> pure(mods.size());
+
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        check_module_types(*mods[i], analyzed, diags[i]);
+        classify_module_functions(*mods[i], pure[i]);
+    });
 
-    // Check types in all imported modules
-    for (const auto& imported : modules.imported) {
-        check_module_types(imported.module, analyzed, diagnostics);
+    detail::merge_diagnostics(diags, diagnostics);
+    for (auto& functions : pure) {
+        analyzed.pure_functions.merge(functions);
     }
 }
 
@@ -6,8 +6,10 @@
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
 #include <limits>
+#include <map>
 #include <set>
 
 namespace datascript::semantic::phases {
@@ -398,63 +400,158 @@ namespace {
     }
 
     // ========================================================================
-    // Module-Level Constant Evaluation
+    // Constant Dependency Levels
     // ========================================================================
 
-    void evaluate_module_constants(
-        const ast::module& mod,
-        analyzed_module_set& analyzed,
-        std::vector<diagnostic>& diags)
+    // Collect constants referenced by an expression (only through the
+    // operators evaluate_expr() descends into)
+    void collect_constant_refs(
+        const ast::expr& expr,
+        const symbol_table& symbols,
+        std::vector<const ast::constant_def*>& refs)
     {
-        // Evaluate all constants in the module
-        for (const auto& const_def : mod.constants) {
-            // Skip if already evaluated (from circular dependency check)
-            if (analyzed.constant_values.contains(&const_def)) {
-                continue;
+        if (auto* id = std::get_if<ast::identifier>(&expr.node)) {
+            if (auto* const_def = symbols.find_constant(id->name)) {
+                refs.push_back(const_def);
             }
+        }
+        else if (auto* binary = std::get_if<ast::binary_expr>(&expr.node)) {
+            collect_constant_refs(*binary->left, symbols, refs);
+            collect_constant_refs(*binary->right, symbols, refs);
+        }
+        else if (auto* unary = std::get_if<ast::unary_expr>(&expr.node)) {
+            collect_constant_refs(*unary->operand, symbols, refs);
+        }
+        else if (auto* ternary = std::get_if<ast::ternary_expr>(&expr.node)) {
+            collect_constant_refs(*ternary->condition, symbols, refs);
+            collect_constant_refs(*ternary->true_expr, symbols, refs);
+            collect_constant_refs(*ternary->false_expr, symbols, refs);
+        }
+    }
+
+    // Group constants into topological levels of their dependency graph:
+    // level 0 references no other constant, level N only references
+    // constants of lower levels. Constants on (or behind) a cycle are
+    // returned in `cyclic`, in declaration order.
+    std::vector<std::vector<size_t>> constant_levels(
+        const std::vector<const ast::constant_def*>& constants,
+        const symbol_table& symbols,
+        std::vector<size_t>& cyclic)
+    {
+        std::map<const ast::constant_def*, size_t> index_of;
+        for (size_t i = 0; i < constants.size(); ++i) {
+            index_of.emplace(constants[i], i);
+        }
 
-            std::set<const ast::constant_def*> evaluation_stack;
-            evaluation_stack.insert(&const_def);
+        std::vector<std::vector<size_t>> dependents(constants.size());
+        std::vector<size_t> pending(constants.size(), 0);
 
-            auto value = evaluate_expr(const_def.value, analyzed, diags, evaluation_stack);
+        for (size_t i = 0; i < constants.size(); ++i) {
+            std::vector<const ast::constant_def*> refs;
+            collect_constant_refs(constants[i]->value, symbols, refs);
+            std::sort(refs.begin(), refs.end());
+            refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
 
-            if (value && value->type == const_value::kind::integer) {
-                // Store as uint64_t (sign-extension handled by cast)
-                analyzed.constant_values[&const_def] = static_cast<uint64_t>(value->int_val);
+            for (const auto* ref : refs) {
+                auto it = index_of.find(ref);
+                if (it != index_of.end()) {
+                    dependents[it->second].push_back(i);
+                    ++pending[i];
+                }
             }
-            // Boolean and string constants not stored (only integers needed for sizes)
         }
 
-        // Evaluate enum item values
-        for (const auto& enum_def : mod.enums) {
-            int64_t next_value = 0;
-
-            for (const auto& item : enum_def.items) {
-                int64_t current_value = next_value;
-
-                if (item.value) {
-                    // Explicit value
-                    std::set<const ast::constant_def*> evaluation_stack;
-                    auto value = evaluate_expr(item.value.value(), analyzed, diags, evaluation_stack);
+        std::vector<std::vector<size_t>> levels;
+        std::vector<size_t> current;
+        for (size_t i = 0; i < constants.size(); ++i) {
+            if (pending[i] == 0) {
+                current.push_back(i);
+            }
+        }
 
-                    if (value && value->type == const_value::kind::integer) {
-                        current_value = value->int_val;
+        std::vector<bool> placed(constants.size(), false);
+        while (!current.empty()) {
+            std::vector<size_t> next;
+            for (size_t i : current) {
+                placed[i] = true;
+                for (size_t d : dependents[i]) {
+                    if (--pending[d] == 0) {
+                        next.push_back(d);
                     }
                 }
+            }
+            std::sort(next.begin(), next.end());
+            levels.push_back(std::move(current));
+            current = std::move(next);
+        }
+
+        for (size_t i = 0; i < constants.size(); ++i) {
+            if (!placed[i]) {
+                cyclic.push_back(i);
+            }
+        }
+        return levels;
+    }
+
+    // ========================================================================
+    // Constant and Enum Evaluation
+    // ========================================================================
+
+    // Evaluate a single constant definition. Only integer values are
+    // returned (booleans and strings are not needed for sizes).
+    std::optional<uint64_t> evaluate_constant_def(
+        const ast::constant_def& const_def,
+        const analyzed_module_set& analyzed,
+        std::vector<diagnostic>& diags)
+    {
+        std::set<const ast::constant_def*> evaluation_stack;
+        evaluation_stack.insert(&const_def);
+
+        auto value = evaluate_expr(const_def.value, analyzed, diags, evaluation_stack);
+
+        if (value && value->type == const_value::kind::integer) {
+            // Store as uint64_t (sign-extension handled by cast)
+            return static_cast<uint64_t>(value->int_val);
+        }
+        return std::nullopt;
+    }
+
+    // Evaluate the item values of one enum, in item order
+    std::vector<uint64_t> evaluate_enum_items(
+        const ast::enum_def& enum_def,
+        const analyzed_module_set& analyzed,
+        std::vector<diagnostic>& diags)
+    {
+        std::vector<uint64_t> values;
+        values.reserve(enum_def.items.size());
+        int64_t next_value = 0;
+
+        for (const auto& item : enum_def.items) {
+            int64_t current_value = next_value;
 
-                // Store the value for this enum item
-                analyzed.enum_item_values[&item] = static_cast<uint64_t>(current_value);
+            if (item.value) {
+                // Explicit value
+                std::set<const ast::constant_def*> evaluation_stack;
+                auto value = evaluate_expr(item.value.value(), analyzed, diags, evaluation_stack);
 
-                // Next item gets current + 1 (unless it has explicit value)
-                next_value = current_value + 1;
+                if (value && value->type == const_value::kind::integer) {
+                    current_value = value->int_val;
+                }
             }
+
+            values.push_back(static_cast<uint64_t>(current_value));
+
+            // Next item gets current + 1 (unless it has explicit value)
+            next_value = current_value + 1;
         }
+        return values;
     }
 
 // Validate inline choice discriminator types (explicit type required)
 static void validate_choice_discriminator_types(
     const ast::module& mod,
-    analyzed_module_set& analyzed,
+    const analyzed_module_set& analyzed,
+    std::map<const ast::choice_def*, ast::primitive_type>& discriminator_types,
     std::vector<diagnostic>& diagnostics)
 {
     for (const auto& choice : mod.choices) {
@@ -547,7 +644,7 @@ static void validate_choice_discriminator_types(
         }
 
         // Store the explicit discriminator type
-        analyzed.choice_discriminator_types.emplace(&choice, prim_type);
+        discriminator_types.emplace(&choice, prim_type);
     }
 }
 
@@ -560,27 +657,92 @@ static void validate_choice_discriminator_types(
 void evaluate_constants(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    // Evaluate constants in main module
-    evaluate_module_constants(modules.main.module, analyzed, diagnostics);
+    auto mods = detail::modules_in_order(modules);
+
+    // Flatten constants and enums in declaration order (main module first)
+    std::vector<const ast::constant_def*> constants;
+    std::vector<const ast::enum_def*> enums;
+    std::vector<size_t> module_const_end;
+    std::vector<size_t> module_enum_end;
+    for (const auto* mod : mods) {
+        for (const auto& const_def : mod->constants) {
+            constants.push_back(&const_def);
+        }
+        for (const auto& enum_def : mod->enums) {
+            enums.push_back(&enum_def);
+        }
+        module_const_end.push_back(constants.size());
+        module_enum_end.push_back(enums.size());
+    }
 
-    // Evaluate constants in all imported modules
-    for (const auto& imported : modules.imported) {
-        evaluate_module_constants(imported.module, analyzed, diagnostics);
+    std::vector<std::vector<diagnostic>> const_diags(constants.size());
+    std::vector<std::optional<uint64_t>> const_values(constants.size());
+
+    // Evaluate constants level by level along the dependency graph. Within a
+    // level no constant references another, so they evaluate concurrently
+    // against the values stored by earlier levels.
+    std::vector<size_t> cyclic;
+    auto levels = constant_levels(constants, analyzed.symbols, cyclic);
+    for (const auto& level : levels) {
+        detail::parallel_for(level.size(), jobs, [&](size_t k) {
+            size_t i = level[k];
+            const_values[i] = evaluate_constant_def(*constants[i], analyzed, const_diags[i]);
+        });
+        for (size_t i : level) {
+            if (const_values[i]) {
+                analyzed.constant_values[constants[i]] = *const_values[i];
+            }
+        }
+    }
+
+    // Constants on a cycle report their own errors; evaluate them serially
+    for (size_t i : cyclic) {
+        const_values[i] = evaluate_constant_def(*constants[i], analyzed, const_diags[i]);
+        if (const_values[i]) {
+            analyzed.constant_values[constants[i]] = *const_values[i];
+        }
+    }
+
+    // Enum items only depend on constants, so all enums are independent
+    std::vector<std::vector<diagnostic>> enum_diags(enums.size());
+    std::vector<std::vector<uint64_t>> enum_values(enums.size());
+    detail::parallel_for(enums.size(), jobs, [&](size_t i) {
+        enum_values[i] = evaluate_enum_items(*enums[i], analyzed, enum_diags[i]);
+    });
+    for (size_t i = 0; i < enums.size(); ++i) {
+        for (size_t j = 0; j < enums[i]->items.size(); ++j) {
+            analyzed.enum_item_values[&enums[i]->items[j]] = enum_values[i][j];
+        }
     }
 
-    // Validate alignment directives (must be constant expressions)
-    validate_alignment_directives(modules.main.module, analyzed, diagnostics);
-    for (const auto& imported : modules.imported) {
-        validate_alignment_directives(imported.module, analyzed, diagnostics);
+    // Validate alignment directives (must be constant expressions) and
+    // discriminator types for inline choices (explicit type required)
+    std::vector<std::vector<diagnostic>> align_diags(mods.size());
+    std::vector<std::vector<diagnostic>> choice_diags(mods.size());
+    std::vector<std::map<const ast::choice_def*, ast::primitive_type>> discriminators(mods.size());
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        validate_alignment_directives(*mods[i], analyzed, align_diags[i]);
+        validate_choice_discriminator_types(*mods[i], analyzed, discriminators[i], choice_diags[i]);
+    });
+    for (auto& types : discriminators) {
+        analyzed.choice_discriminator_types.merge(types);
     }
 
-    // Validate discriminator types for inline choices (explicit type required)
-    validate_choice_discriminator_types(modules.main.module, analyzed, diagnostics);
-    for (const auto& imported : modules.imported) {
-        validate_choice_discriminator_types(imported.module, analyzed, diagnostics);
+    // Merge diagnostics in declaration order: per module its constants then
+    // its enums, followed by alignment and discriminator checks
+    size_t const_begin = 0;
+    size_t enum_begin = 0;
+    for (size_t m = 0; m < mods.size(); ++m) {
+        detail::merge_diagnostics(const_diags, const_begin, module_const_end[m], diagnostics);
+        detail::merge_diagnostics(enum_diags, enum_begin, module_enum_end[m], diagnostics);
+        const_begin = module_const_end[m];
+        enum_begin = module_enum_end[m];
     }
+    detail::merge_diagnostics(align_diags, diagnostics);
+    detail::merge_diagnostics(choice_diags, diagnostics);
 }
 
 std::optional<uint64_t> evaluate_constant_uint(
@@ -5,6 +5,7 @@
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
 #include <limits>
 
@@ -53,6 +54,16 @@ namespace {
         return info;
     }
 
+    // Calculate IEEE-754 floating-point type size
+    type_info calculate_float_type_info(const ast::float_type& flt) {
+        type_info info;
+        info.size = flt.bits / 8;
+        info.alignment = info.size;
+        info.is_variable_size = false;
+        info.is_signed = true;
+        return info;
+    }
+
     // Calculate bitfield type size
     type_info calculate_bitfield_type_info(uint64_t bits) {
         type_info info;
@@ -195,6 +206,9 @@ namespace {
         if (auto* prim = std::get_if<ast::primitive_type>(&type_node.node)) {
             return calculate_primitive_type_info(*prim);
         }
+        else if (auto* flt = std::get_if<ast::float_type>(&type_node.node)) {
+            return calculate_float_type_info(*flt);
+        }
         else if (auto* bf = std::get_if<ast::bit_field_type_fixed>(&type_node.node)) {
             return calculate_bitfield_type_info(bf->width);
         }
@@ -260,13 +274,17 @@ namespace {
         return info;
     }
 
+    // Field offsets produced by one layout task
+    using field_offset_map = std::map<const ast::field_def*, size_t>;
+
     // ========================================================================
     // Struct Layout Calculation
     // ========================================================================
 
     void calculate_struct_layout(
         const ast::struct_def& struct_def,
-        analyzed_module_set& analyzed,
+        const analyzed_module_set& analyzed,
+        field_offset_map& field_offsets,
         std::vector<diagnostic>& diags)
     {
         size_t current_offset = 0;
@@ -281,7 +299,7 @@ namespace {
                 current_offset = align_offset(current_offset, field_info.alignment);
 
                 // Store field offset
-                analyzed.field_offsets[field] = current_offset;
+                field_offsets[field] = current_offset;
 
                 // Track maximum alignment for struct
                 max_alignment = std::max(max_alignment, field_info.alignment);
@@ -313,7 +331,8 @@ namespace {
 
     void calculate_union_layout(
         const ast::union_def& union_def,
-        analyzed_module_set& analyzed,
+        const analyzed_module_set& analyzed,
+        field_offset_map& field_offsets,
         std::vector<diagnostic>& diags)
     {
         size_t max_size = 0;
@@ -326,7 +345,7 @@ namespace {
                     auto field_info = calculate_type_info(field.field_type, analyzed, diags);
 
                     // All union fields start at offset 0
-                    analyzed.field_offsets[&field] = 0;
+                    field_offsets[&field] = 0;
 
                     // Track maximum size and alignment
                     if (!field_info.is_variable_size) {
@@ -341,30 +360,6 @@ namespace {
         max_size = align_offset(max_size, max_alignment);
     }
 
-    // ========================================================================
-    // Module-Level Size Calculation
-    // ========================================================================
-
-    void calculate_module_sizes(
-        const ast::module& mod,
-        analyzed_module_set& analyzed,
-        std::vector<diagnostic>& diags)
-    {
-        // Calculate sizes for all structs
-        for (const auto& struct_def : mod.structs) {
-            calculate_struct_layout(struct_def, analyzed, diags);
-        }
-
-        // Calculate sizes for all unions
-        for (const auto& union_def : mod.unions) {
-            calculate_union_layout(union_def, analyzed, diags);
-        }
-
-        // Enums inherit size from base type (already handled in calculate_type_info)
-
-        // Choices are variable-size (already handled in calculate_type_info)
-    }
-
 } // anonymous namespace
 
 // ============================================================================
@@ -374,15 +369,46 @@ namespace {
 void calculate_sizes(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    // Calculate sizes in main module
-    calculate_module_sizes(modules.main.module, analyzed, diagnostics);
+    // One layout task per struct and union, in module order (structs before
+    // unions within a module). A layout only reads resolved types and
+    // constant values - nested aggregates contribute placeholder sizes - so
+    // the type dependency graph has a single level and all tasks run at once.
+    struct layout_task {
+        const ast::struct_def* struct_def = nullptr;
+        const ast::union_def* union_def = nullptr;
+    };
+
+    std::vector<layout_task> tasks;
+    for (const auto* mod : detail::modules_in_order(modules)) {
+        for (const auto& struct_def : mod->structs) {
+            tasks.push_back({&struct_def, nullptr});
+        }
+        for (const auto& union_def : mod->unions) {
+            tasks.push_back({nullptr, &union_def});
+        }
+    }
+
+    // Enums inherit size from base type and choices are variable-size
+    // (both handled in calculate_type_info)
+
+    std::vector<field_offset_map> offsets(tasks.size());
+    std::vector<std::vector<diagnostic>> diags(tasks.size());
+
+    detail::parallel_for(tasks.size(), jobs, [&](size_t i) {
+        if (tasks[i].struct_def) {
+            calculate_struct_layout(*tasks[i].struct_def, analyzed, offsets[i], diags[i]);
+        } else {
+            calculate_union_layout(*tasks[i].union_def, analyzed, offsets[i], diags[i]);
+        }
+    });
 
-    // Calculate sizes in all imported modules
-    for (const auto& imported : modules.imported) {
-        calculate_module_sizes(imported.module, analyzed, diagnostics);
+    for (auto& task_offsets : offsets) {
+        analyzed.field_offsets.merge(task_offsets);
     }
+    detail::merge_diagnostics(diags, diagnostics);
 }
 
 } // namespace datascript::semantic::phases
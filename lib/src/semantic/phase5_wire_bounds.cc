@@ -0,0 +1,915 @@
+//
+// Phase 5 (continued): Wire Size and Heap Bounds
+//
+// Computes how few and how many bytes a decode of each struct, union and
+// choice reads, and how many heap bytes it can allocate. Runtime array
+// counts are bounded by interval arithmetic over the value ranges of the
+// fields and parameters they are computed from.
+//
+
+#include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace datascript::semantic {
+
+namespace phases {
+
+namespace {
+    using named_type = analyzed_module_set::resolved_type;
+    using bound = std::optional<size_t>;
+
+    constexpr size_t size_max = std::numeric_limits<size_t>::max();
+
+    // ========================================================================
+    // Bound Arithmetic (std::nullopt = unbounded; overflow saturates to it)
+    // ========================================================================
+
+    bound add_bounds(bound a, bound b) {
+        if (!a || !b || *a > size_max - *b) {
+            return std::nullopt;
+        }
+        return *a + *b;
+    }
+
+    bound mul_bounds(bound a, std::optional<uint64_t> n) {
+        if (!a || !n) {
+            return std::nullopt;
+        }
+        if (*a == 0 || *n == 0) {
+            return 0;
+        }
+        if (*n > size_max / *a) {
+            return std::nullopt;
+        }
+        return *a * static_cast<size_t>(*n);
+    }
+
+    bound max_bounds(bound a, bound b) {
+        if (!a || !b) {
+            return std::nullopt;
+        }
+        return std::max(*a, *b);
+    }
+
+    size_t saturating_mul(size_t a, uint64_t n) {
+        return mul_bounds(a, n).value_or(size_max);
+    }
+
+    size_t align_up(size_t value, size_t alignment) {
+        if (alignment <= 1) return value;
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    uint64_t max_for_bits(uint64_t bits) {
+        return bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << bits) - 1;
+    }
+
+    // Smallest all-ones value covering v (upper bound of v | w and v ^ w)
+    uint64_t fill_low_bits(uint64_t v) {
+        for (unsigned shift = 1; shift < 64; shift <<= 1) {
+            v |= v >> shift;
+        }
+        return v;
+    }
+
+    // ========================================================================
+    // Name Lookup
+    // ========================================================================
+
+    std::optional<named_type> resolve_named(const ast::type& type, const analyzed_module_set& analyzed) {
+        const ast::qualified_name* qname = nullptr;
+        if (auto* name = std::get_if<ast::qualified_name>(&type.node)) {
+            qname = name;
+        } else if (auto* inst = std::get_if<ast::type_instantiation>(&type.node)) {
+            qname = &inst->base_type;
+        } else {
+            return std::nullopt;
+        }
+
+        auto it = analyzed.resolved_types.find(qname);
+        if (it != analyzed.resolved_types.end()) {
+            return it->second;
+        }
+
+        // Parameterized references are not recorded by name resolution
+        const auto& symbols = analyzed.symbols;
+        if (auto* def = symbols.find_struct_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_union_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_choice_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_enum_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_subtype_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_type_alias_qualified(qname->parts)) return named_type{def};
+        return std::nullopt;
+    }
+
+    // Fields decoded so far and type parameters, visible to size expressions
+    struct value_scope {
+        std::map<std::string, const ast::field_def*> fields;
+        std::map<std::string, const ast::param*> params;
+    };
+
+    value_scope scope_for(const std::vector<ast::param>& params) {
+        value_scope scope;
+        for (const auto& param : params) {
+            scope.params[param.name] = &param;
+        }
+        return scope;
+    }
+
+    // In-memory size of a decoded value (LP64 standard library model)
+    struct native_layout {
+        size_t size = 0;
+        size_t align = 1;
+    };
+
+    constexpr native_layout vector_layout{24, 8};
+    constexpr native_layout string_layout{32, 8};
+
+    // std::optional<T> and std::variant<...>: payload plus a trailing flag byte
+    native_layout with_flag(native_layout payload) {
+        return native_layout{align_up(payload.size + 1, payload.align), payload.align};
+    }
+
+    // ========================================================================
+    // Bounds Calculator
+    // ========================================================================
+
+    // Bounds are memoized per definition. Recursive types (only possible
+    // through arrays) get an unbounded maximum on the recursive edge.
+    class bounds_calculator {
+    public:
+        explicit bounds_calculator(const analyzed_module_set& analyzed)
+            : analyzed_(analyzed) {}
+
+        wire_bounds of_definition(const named_type& def) {
+            auto key = def;
+            if (auto it = bounds_.find(key); it != bounds_.end()) {
+                return it->second;
+            }
+            if (!in_progress_.insert(key).second) {
+                wire_bounds recursive;
+                return recursive;  // min 0, max and heap unbounded
+            }
+
+            wire_bounds result;
+            if (auto* s = std::get_if<const ast::struct_def*>(&def)) {
+                std::vector<array_count_bound> arrays;
+                result = of_items((*s)->body, scope_for((*s)->parameters), &arrays);
+                result.arrays = std::move(arrays);
+            } else if (auto* u = std::get_if<const ast::union_def*>(&def)) {
+                result = of_union(**u);
+            } else if (auto* c = std::get_if<const ast::choice_def*>(&def)) {
+                result = of_choice(**c);
+            } else if (auto* e = std::get_if<const ast::enum_def*>(&def)) {
+                result = of_type((*e)->base_type, {}, {}, nullptr);
+            } else if (auto* st = std::get_if<const ast::subtype_def*>(&def)) {
+                result = of_type((*st)->base_type, {}, {}, nullptr);
+            } else if (auto* a = std::get_if<const ast::type_alias_def*>(&def)) {
+                result = of_type((*a)->target_type, {}, {}, nullptr);
+            }
+
+            in_progress_.erase(key);
+            bounds_[key] = result;
+            return result;
+        }
+
+    private:
+        // Bounds of one value of type; arrays collects runtime-length arrays
+        wire_bounds of_type(const ast::type& type, const value_scope& scope,
+                            const std::string& field_name, std::vector<array_count_bound>* arrays) {
+            const auto& node = type.node;
+
+            if (auto* prim = std::get_if<ast::primitive_type>(&node)) {
+                return fixed(prim->bits / 8);
+            }
+            if (auto* flt = std::get_if<ast::float_type>(&node)) {
+                return fixed(flt->bits / 8);
+            }
+            if (std::holds_alternative<ast::bool_type>(node)) {
+                return fixed(1);
+            }
+            if (auto* bits = std::get_if<ast::bit_field_type_fixed>(&node)) {
+                return bitfield(bits->width);
+            }
+            if (auto* bits = std::get_if<ast::bit_field_type_expr>(&node)) {
+                return bitfield(max_value(bits->width_expr, scope).value_or(64));
+            }
+            if (std::holds_alternative<ast::string_type>(node)) {
+                return unbounded(1);
+            }
+            if (std::holds_alternative<ast::u16_string_type>(node)) {
+                return unbounded(2);
+            }
+            if (std::holds_alternative<ast::u32_string_type>(node)) {
+                return unbounded(4);
+            }
+            if (auto* arr = std::get_if<ast::array_type_fixed>(&node)) {
+                auto element = of_type(*arr->element_type, scope, {}, nullptr);
+                if (auto count = constant(arr->size)) {
+                    // std::array: elements live inline
+                    wire_bounds result;
+                    result.min_size = saturating_mul(element.min_size, *count);
+                    result.max_size = mul_bounds(element.max_size, *count);
+                    result.max_heap_bytes = mul_bounds(element.max_heap_bytes, *count);
+                    return result;
+                }
+                return runtime_array(*arr->element_type, element, 0,
+                                     max_value(arr->size, scope), arr->size, scope,
+                                     field_name, arrays);
+            }
+            if (auto* arr = std::get_if<ast::array_type_range>(&node)) {
+                // Element count is max - min (see ir_builder)
+                auto element = of_type(*arr->element_type, scope, {}, nullptr);
+                auto max_count = max_value(arr->max_size, scope);
+                uint64_t min_count = 0;
+                auto min_const = arr->min_size ? constant(*arr->min_size) : std::optional<uint64_t>{0};
+                auto max_const = constant(arr->max_size);
+                if (min_const && max_const && *max_const >= *min_const) {
+                    min_count = *max_const - *min_const;
+                    max_count = min_count;
+                }
+                return runtime_array(*arr->element_type, element, min_count, max_count,
+                                     arr->max_size, scope, field_name, arrays);
+            }
+            if (std::holds_alternative<ast::array_type_unsized>(node)) {
+                if (arrays) {
+                    arrays->push_back(array_count_bound{field_name, std::nullopt, {}});
+                }
+                return unbounded(0);
+            }
+            if (auto def = resolve_named(type, analyzed_)) {
+                auto result = of_definition(*def);
+                result.arrays.clear();
+                return result;
+            }
+            return unbounded(0);
+        }
+
+        // A substream consumes exactly its region. The reader keeps the raw
+        // bytes and decodes the nested value on first access: the transformed
+        // copy is as large as the region, except that inflated data has no bound
+        wire_bounds of_substream(const ast::transform_directive& transform, const ast::type& type,
+                                 const value_scope& scope) {
+            const auto& size_expr = transform.args.front();
+            auto size_min = constant(size_expr);
+            auto size_max_value = max_value(size_expr, scope);
+
+            wire_bounds result;
+            result.min_size = size_min && *size_min <= size_max ? static_cast<size_t>(*size_min) : 0;
+            result.max_size = size_max_value && *size_max_value <= size_max
+                                  ? bound{static_cast<size_t>(*size_max_value)}
+                                  : std::nullopt;
+            if (transform.name == "zlib") {
+                result.max_heap_bytes = std::nullopt;
+                return result;
+            }
+            bound nested = std::holds_alternative<ast::array_type_unsized>(type.node)
+                               ? result.max_size
+                               : of_type(type, scope, {}, nullptr).max_heap_bytes;
+            result.max_heap_bytes = add_bounds(mul_bounds(result.max_size, 2), nested);
+            return result;
+        }
+
+        wire_bounds runtime_array(const ast::type& element_type, const wire_bounds& element,
+                                  uint64_t min_count, std::optional<uint64_t> max_count,
+                                  const ast::expr& count_expr, const value_scope& scope,
+                                  const std::string& field_name, std::vector<array_count_bound>* arrays) {
+            if (arrays) {
+                array_count_bound entry{field_name, max_count, {}};
+                collect_inputs(count_expr, scope, entry.inputs);
+                arrays->push_back(std::move(entry));
+            }
+
+            // std::vector: elements on the heap, plus whatever they allocate
+            wire_bounds result;
+            result.min_size = saturating_mul(element.min_size, min_count);
+            result.max_size = mul_bounds(element.max_size, max_count);
+            result.max_heap_bytes = add_bounds(mul_bounds(native(element_type).size, max_count),
+                                               mul_bounds(element.max_heap_bytes, max_count));
+            return result;
+        }
+
+        wire_bounds of_items(const std::vector<ast::struct_body_item>& items, value_scope scope,
+                             std::vector<array_count_bound>* arrays) {
+            size_t position_min = 0;  // Where the next field starts, at least
+            bound position_max = 0;   // ... and at most
+            size_t extent_min = 0;    // Furthest byte certainly read so far
+            bound extent = 0;         // Furthest byte possibly read so far
+            bound heap = 0;
+            const ast::transform_directive* substream = nullptr;
+
+            for (const auto& item : items) {
+                if (auto* field = std::get_if<ast::field_def>(&item)) {
+                    auto b = substream ? of_substream(*substream, field->field_type, scope)
+                                       : of_type(field->field_type, scope, field->name, arrays);
+                    substream = nullptr;
+                    if (!field->condition) {
+                        position_min = std::min(size_max - b.min_size, position_min) + b.min_size;
+                    }
+                    position_max = add_bounds(position_max, b.max_size);
+                    extent_min = std::max(extent_min, position_min);
+                    extent = max_bounds(extent, position_max);
+                    heap = add_bounds(heap, b.max_heap_bytes);
+                    scope.fields[field->name] = field;
+                }
+                else if (auto* label = std::get_if<ast::label_directive>(&item)) {
+                    auto offset = constant(label->label_expr);
+                    position_min = offset ? static_cast<size_t>(*offset) : 0;
+                    auto offset_max = max_value(label->label_expr, scope);
+                    position_max = offset_max && *offset_max <= size_max
+                                       ? bound{static_cast<size_t>(*offset_max)}
+                                       : std::nullopt;
+                    extent = max_bounds(extent, position_max);
+                }
+                else if (auto* align = std::get_if<ast::alignment_directive>(&item)) {
+                    auto alignment = constant(align->alignment_expr);
+                    if (alignment && *alignment > 1) {
+                        position_max = add_bounds(position_max, static_cast<size_t>(*alignment - 1));
+                    }
+                    extent = max_bounds(extent, position_max);
+                }
+                else if (auto* transform = std::get_if<ast::transform_directive>(&item)) {
+                    if (!transform->args.empty()) {
+                        substream = transform;  // @zlib(size) etc.: the next field reads a byte region
+                    }
+                }
+            }
+
+            wire_bounds result;
+            result.min_size = extent_min;
+            result.max_size = extent;
+            result.max_heap_bytes = heap;
+            return result;
+        }
+
+        wire_bounds of_union(const ast::union_def& union_def) {
+            // One case is decoded in the end; failed attempts free what they allocated
+            wire_bounds result;
+            result.min_size = union_def.cases.empty() ? 0 : size_max;
+            result.max_size = 0;
+            result.max_heap_bytes = 0;
+            for (const auto& union_case : union_def.cases) {
+                auto b = of_items(union_case.items, scope_for(union_def.parameters), &result.arrays);
+                result.min_size = std::min(result.min_size, b.min_size);
+                result.max_size = max_bounds(result.max_size, b.max_size);
+                result.max_heap_bytes = max_bounds(result.max_heap_bytes, b.max_heap_bytes);
+            }
+            return result;
+        }
+
+        wire_bounds of_choice(const ast::choice_def& choice) {
+            // An inline discriminator is consumed by exact and range cases;
+            // default and block cases re-read it as their own data
+            wire_bounds discriminator = fixed(0);
+            if (!choice.selector) {
+                if (auto it = analyzed_.choice_discriminator_types.find(&choice);
+                    it != analyzed_.choice_discriminator_types.end()) {
+                    discriminator = fixed(it->second.bits / 8);
+                } else if (choice.inline_discriminator_type) {
+                    discriminator = of_type(*choice.inline_discriminator_type, {}, {}, nullptr);
+                }
+            }
+
+            wire_bounds result;
+            result.min_size = choice.cases.empty() ? 0 : size_max;
+            result.max_size = 0;
+            result.max_heap_bytes = 0;
+            for (const auto& choice_case : choice.cases) {
+                auto b = of_items(choice_case.items, scope_for(choice.parameters), &result.arrays);
+                if (!choice_case.is_default && !choice_case.is_anonymous_block) {
+                    b.min_size = std::min(size_max - discriminator.min_size, b.min_size) + discriminator.min_size;
+                    b.max_size = add_bounds(b.max_size, discriminator.max_size);
+                } else {
+                    b.max_size = max_bounds(b.max_size, discriminator.max_size);
+                }
+                result.min_size = std::min(result.min_size, b.min_size);
+                result.max_size = max_bounds(result.max_size, b.max_size);
+                result.max_heap_bytes = max_bounds(result.max_heap_bytes, b.max_heap_bytes);
+            }
+            return result;
+        }
+
+        static wire_bounds fixed(size_t size) {
+            wire_bounds result;
+            result.min_size = size;
+            result.max_size = size;
+            result.max_heap_bytes = 0;
+            return result;
+        }
+
+        static wire_bounds unbounded(size_t min_size) {
+            wire_bounds result;
+            result.min_size = min_size;
+            return result;
+        }
+
+        // Bit fields may share bytes with their neighbours
+        static wire_bounds bitfield(uint64_t width) {
+            wire_bounds result;
+            result.min_size = 0;
+            result.max_size = static_cast<size_t>(std::min<uint64_t>(width, 64) + 7) / 8 + 1;
+            result.max_heap_bytes = 0;
+            return result;
+        }
+
+        // ====================================================================
+        // In-Memory Layout
+        // ====================================================================
+
+        native_layout native(const ast::type& type) {
+            const auto& node = type.node;
+
+            if (auto* prim = std::get_if<ast::primitive_type>(&node)) {
+                size_t size = prim->bits / 8;
+                return native_layout{size, size};
+            }
+            if (auto* flt = std::get_if<ast::float_type>(&node)) {
+                size_t size = flt->bits / 8;
+                return native_layout{size, size};
+            }
+            if (std::holds_alternative<ast::bool_type>(node)) {
+                return native_layout{1, 1};
+            }
+            if (auto* bits = std::get_if<ast::bit_field_type_fixed>(&node)) {
+                size_t size = bits->width <= 8 ? 1 : bits->width <= 16 ? 2 : bits->width <= 32 ? 4 : 8;
+                return native_layout{size, size};
+            }
+            if (std::holds_alternative<ast::bit_field_type_expr>(node)) {
+                return native_layout{8, 8};
+            }
+            if (std::holds_alternative<ast::string_type>(node) ||
+                std::holds_alternative<ast::u16_string_type>(node) ||
+                std::holds_alternative<ast::u32_string_type>(node)) {
+                return string_layout;
+            }
+            if (auto* arr = std::get_if<ast::array_type_fixed>(&node)) {
+                if (auto count = constant(arr->size)) {
+                    auto element = native(*arr->element_type);
+                    return native_layout{saturating_mul(element.size, *count), element.align};
+                }
+                return vector_layout;
+            }
+            if (std::holds_alternative<ast::array_type_range>(node) ||
+                std::holds_alternative<ast::array_type_unsized>(node)) {
+                return vector_layout;
+            }
+            if (auto def = resolve_named(type, analyzed_)) {
+                return native_of(*def);
+            }
+            return native_layout{};
+        }
+
+        native_layout native_of(const named_type& def) {
+            if (auto it = layouts_.find(def); it != layouts_.end()) {
+                return it->second;
+            }
+            if (!laying_out_.insert(def).second) {
+                return native_layout{};  // Recursion only happens through vectors
+            }
+
+            native_layout layout;
+            if (auto* s = std::get_if<const ast::struct_def*>(&def)) {
+                layout = native_of_items((*s)->body);
+            } else if (auto* u = std::get_if<const ast::union_def*>(&def)) {
+                native_layout largest;
+                for (const auto& union_case : (*u)->cases) {
+                    auto c = native_of_case(union_case.items, union_case.is_anonymous_block);
+                    largest = native_layout{std::max(largest.size, c.size), std::max(largest.align, c.align)};
+                }
+                layout = with_flag(largest);
+            } else if (auto* c = std::get_if<const ast::choice_def*>(&def)) {
+                native_layout largest;
+                for (const auto& choice_case : (*c)->cases) {
+                    auto cl = native_of_case(choice_case.items, choice_case.is_anonymous_block);
+                    largest = native_layout{std::max(largest.size, cl.size), std::max(largest.align, cl.align)};
+                }
+                layout = with_flag(largest);
+            } else if (auto* e = std::get_if<const ast::enum_def*>(&def)) {
+                layout = native((*e)->base_type);
+            } else if (auto* st = std::get_if<const ast::subtype_def*>(&def)) {
+                layout = native((*st)->base_type);
+            } else if (auto* a = std::get_if<const ast::type_alias_def*>(&def)) {
+                layout = native((*a)->target_type);
+            }
+
+            laying_out_.erase(def);
+            layouts_[def] = layout;
+            return layout;
+        }
+
+        // Members in declaration order; conditional fields are std::optional
+        native_layout native_of_items(const std::vector<ast::struct_body_item>& items) {
+            native_layout layout;
+            for (const auto& item : items) {
+                auto* field = std::get_if<ast::field_def>(&item);
+                if (!field) {
+                    continue;
+                }
+                auto member = native(field->field_type);
+                if (field->condition) {
+                    member = with_flag(member);
+                }
+                layout.size = align_up(layout.size, member.align);
+                layout.size = std::min(size_max - member.size, layout.size) + member.size;
+                layout.align = std::max(layout.align, member.align);
+            }
+            layout.size = align_up(layout.size, layout.align);
+            return layout;
+        }
+
+        native_layout native_of_case(const std::vector<ast::struct_body_item>& items, bool is_block) {
+            if (!is_block) {
+                for (const auto& item : items) {
+                    if (auto* field = std::get_if<ast::field_def>(&item)) {
+                        return native(field->field_type);
+                    }
+                }
+            }
+            return native_of_items(items);
+        }
+
+        // ====================================================================
+        // Value Ranges
+        // ====================================================================
+
+        std::optional<uint64_t> constant(const ast::expr& expr) const {
+            std::vector<diagnostic> scratch;  // Runtime values are not errors here
+            return evaluate_constant_uint(expr, analyzed_, scratch);
+        }
+
+        // Largest value an expression can take, by interval arithmetic over
+        // the ranges of the fields and parameters it reads
+        std::optional<uint64_t> max_value(const ast::expr& expr, const value_scope& scope) {
+            if (auto value = constant(expr)) {
+                return value;
+            }
+
+            const auto& node = expr.node;
+            if (auto* id = std::get_if<ast::identifier>(&node)) {
+                if (auto it = scope.fields.find(id->name); it != scope.fields.end()) {
+                    return field_max(*it->second);
+                }
+                if (auto it = scope.params.find(id->name); it != scope.params.end()) {
+                    return type_max(it->second->param_type);
+                }
+                return std::nullopt;
+            }
+            if (std::holds_alternative<ast::field_access_expr>(node)) {
+                auto* field = member_field(expr, scope);
+                return field ? field_max(*field) : std::nullopt;
+            }
+            if (auto* unary = std::get_if<ast::unary_expr>(&node)) {
+                if (unary->op == ast::unary_op::pos) {
+                    return max_value(*unary->operand, scope);
+                }
+                if (unary->op == ast::unary_op::log_not) {
+                    return 1;
+                }
+                return std::nullopt;
+            }
+            if (auto* ternary = std::get_if<ast::ternary_expr>(&node)) {
+                auto t = max_value(*ternary->true_expr, scope);
+                auto f = max_value(*ternary->false_expr, scope);
+                if (!t || !f) {
+                    return std::nullopt;
+                }
+                return std::max(*t, *f);
+            }
+            if (auto* binary = std::get_if<ast::binary_expr>(&node)) {
+                return binary_max(*binary, scope);
+            }
+            return std::nullopt;  // Function calls, indexing, strings
+        }
+
+        std::optional<uint64_t> binary_max(const ast::binary_expr& binary, const value_scope& scope) {
+            using op = ast::binary_op;
+            constexpr uint64_t u64_max = std::numeric_limits<uint64_t>::max();
+
+            switch (binary.op) {
+                case op::eq: case op::ne: case op::lt: case op::gt: case op::le: case op::ge:
+                case op::log_and: case op::log_or:
+                    return 1;
+                default:
+                    break;
+            }
+
+            auto left = max_value(*binary.left, scope);
+            auto right = max_value(*binary.right, scope);
+
+            switch (binary.op) {
+                case op::add:
+                    if (!left || !right || *left > u64_max - *right) return std::nullopt;
+                    return *left + *right;
+                case op::mul:
+                    if (!left || !right) return std::nullopt;
+                    if (*left != 0 && *right > u64_max / *left) return std::nullopt;
+                    return *left * *right;
+                case op::sub:
+                case op::div:
+                case op::rshift:
+                    return left;  // Unsigned results never exceed the left operand
+                case op::mod:
+                    if (right && *right > 0) {
+                        return left ? std::min(*left, *right - 1) : *right - 1;
+                    }
+                    return left;
+                case op::bit_and:
+                    if (left && right) return std::min(*left, *right);
+                    return left ? left : right;
+                case op::bit_or:
+                case op::bit_xor:
+                    if (!left || !right) return std::nullopt;
+                    return fill_low_bits(std::max(*left, *right));
+                case op::lshift:
+                    if (!left || !right || *right >= 64) return std::nullopt;
+                    if (*left > (u64_max >> *right)) return std::nullopt;
+                    return *left << *right;
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        std::optional<uint64_t> field_max(const ast::field_def& field) {
+            auto result = type_max(field.field_type);
+            if (field.constraint) {
+                if (auto limit = upper_bound(*field.constraint, field.name)) {
+                    result = result ? std::min(*result, *limit) : *limit;
+                }
+            }
+            return result;
+        }
+
+        std::optional<uint64_t> type_max(const ast::type& type) {
+            const auto& node = type.node;
+            if (auto* prim = std::get_if<ast::primitive_type>(&node)) {
+                if (prim->bits > 64) return std::nullopt;
+                return max_for_bits(prim->is_signed ? prim->bits - 1 : prim->bits);
+            }
+            if (auto* bits = std::get_if<ast::bit_field_type_fixed>(&node)) {
+                return max_for_bits(bits->width);
+            }
+            if (std::holds_alternative<ast::bool_type>(node)) {
+                return 1;
+            }
+
+            auto def = resolve_named(type, analyzed_);
+            if (!def) {
+                return std::nullopt;
+            }
+            if (auto* e = std::get_if<const ast::enum_def*>(&*def)) {
+                return type_max((*e)->base_type);
+            }
+            if (auto* st = std::get_if<const ast::subtype_def*>(&*def)) {
+                auto result = type_max((*st)->base_type);
+                if (auto limit = upper_bound((*st)->constraint, "this")) {
+                    result = result ? std::min(*result, *limit) : *limit;
+                }
+                return result;
+            }
+            if (auto* a = std::get_if<const ast::type_alias_def*>(&*def)) {
+                return type_max((*a)->target_type);
+            }
+            return std::nullopt;
+        }
+
+        // Upper bound a constraint places on `name` ("n <= 64", "n < 8 && n > 0", "100 >= n")
+        std::optional<uint64_t> upper_bound(const ast::expr& constraint, const std::string& name) {
+            auto* binary = std::get_if<ast::binary_expr>(&constraint.node);
+            if (!binary) {
+                return std::nullopt;
+            }
+
+            using op = ast::binary_op;
+            if (binary->op == op::log_and) {
+                auto l = upper_bound(*binary->left, name);
+                auto r = upper_bound(*binary->right, name);
+                if (l && r) return std::min(*l, *r);
+                return l ? l : r;
+            }
+            if (binary->op == op::log_or) {
+                auto l = upper_bound(*binary->left, name);
+                auto r = upper_bound(*binary->right, name);
+                if (l && r) return std::max(*l, *r);
+                return std::nullopt;
+            }
+
+            auto is_name = [&](const ast::expr& e) {
+                auto* id = std::get_if<ast::identifier>(&e.node);
+                return id && id->name == name;
+            };
+
+            // Normalize to "name <op> value"
+            op relation = binary->op;
+            std::optional<uint64_t> value;
+            if (is_name(*binary->left)) {
+                value = constant(*binary->right);
+            } else if (is_name(*binary->right)) {
+                value = constant(*binary->left);
+                switch (relation) {
+                    case op::lt: relation = op::gt; break;
+                    case op::gt: relation = op::lt; break;
+                    case op::le: relation = op::ge; break;
+                    case op::ge: relation = op::le; break;
+                    default: break;
+                }
+            }
+            if (!value) {
+                return std::nullopt;
+            }
+
+            switch (relation) {
+                case op::le:
+                case op::eq:
+                    return value;
+                case op::lt:
+                    return *value == 0 ? 0 : *value - 1;
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        // Field definition an identifier or field access chain names, if any
+        const ast::field_def* member_field(const ast::expr& expr, const value_scope& scope) {
+            if (auto* id = std::get_if<ast::identifier>(&expr.node)) {
+                auto it = scope.fields.find(id->name);
+                return it != scope.fields.end() ? it->second : nullptr;
+            }
+            auto* access = std::get_if<ast::field_access_expr>(&expr.node);
+            if (!access) {
+                return nullptr;
+            }
+            const auto* parent = member_field(*access->object, scope);
+            if (!parent) {
+                return nullptr;
+            }
+            auto def = resolve_named(parent->field_type, analyzed_);
+            auto* struct_def = def ? std::get_if<const ast::struct_def*>(&*def) : nullptr;
+            if (!struct_def) {
+                return nullptr;
+            }
+            for (const auto& item : (*struct_def)->body) {
+                if (auto* field = std::get_if<ast::field_def>(&item); field && field->name == access->field_name) {
+                    return field;
+                }
+            }
+            return nullptr;
+        }
+
+        // Names of the fields and parameters an expression reads ("n", "hdr.count")
+        void collect_inputs(const ast::expr& expr, const value_scope& scope, std::vector<std::string>& out) {
+            const auto& node = expr.node;
+            auto add = [&](std::string name) {
+                if (std::find(out.begin(), out.end(), name) == out.end()) {
+                    out.push_back(std::move(name));
+                }
+            };
+
+            if (auto* id = std::get_if<ast::identifier>(&node)) {
+                if (scope.fields.contains(id->name) || scope.params.contains(id->name)) {
+                    add(id->name);
+                }
+            } else if (auto* access = std::get_if<ast::field_access_expr>(&node)) {
+                std::string path = access->field_name;
+                const ast::expr* object = access->object.get();
+                while (auto* inner = std::get_if<ast::field_access_expr>(&object->node)) {
+                    path = inner->field_name + "." + path;
+                    object = inner->object.get();
+                }
+                if (auto* root = std::get_if<ast::identifier>(&object->node)) {
+                    add(root->name + "." + path);
+                }
+            } else if (auto* unary = std::get_if<ast::unary_expr>(&node)) {
+                collect_inputs(*unary->operand, scope, out);
+            } else if (auto* binary = std::get_if<ast::binary_expr>(&node)) {
+                collect_inputs(*binary->left, scope, out);
+                collect_inputs(*binary->right, scope, out);
+            } else if (auto* ternary = std::get_if<ast::ternary_expr>(&node)) {
+                collect_inputs(*ternary->condition, scope, out);
+                collect_inputs(*ternary->true_expr, scope, out);
+                collect_inputs(*ternary->false_expr, scope, out);
+            } else if (auto* call = std::get_if<ast::function_call_expr>(&node)) {
+                for (const auto& arg : call->arguments) {
+                    collect_inputs(arg, scope, out);
+                }
+            } else if (auto* index = std::get_if<ast::array_index_expr>(&node)) {
+                collect_inputs(*index->array, scope, out);
+                collect_inputs(*index->index, scope, out);
+            }
+        }
+
+        const analyzed_module_set& analyzed_;
+        std::map<named_type, wire_bounds> bounds_;
+        std::set<named_type> in_progress_;
+        std::map<named_type, native_layout> layouts_;
+        std::set<named_type> laying_out_;
+    };
+
+    // Structs, unions and choices of a module, in report order
+    std::vector<std::pair<named_type, std::string>> aggregate_types(const ast::module& mod) {
+        std::vector<std::pair<named_type, std::string>> result;
+        for (const auto& s : mod.structs) result.emplace_back(named_type{&s}, "struct");
+        for (const auto& u : mod.unions) result.emplace_back(named_type{&u}, "union");
+        for (const auto& c : mod.choices) result.emplace_back(named_type{&c}, "choice");
+        return result;
+    }
+
+} // anonymous namespace
+
+// ============================================================================
+// Public API: Wire Size and Heap Bounds
+// ============================================================================
+
+void calculate_wire_bounds(
+    const module_set& modules,
+    analyzed_module_set& analyzed,
+    size_t jobs)
+{
+    auto mods = detail::modules_in_order(modules);
+    std::vector<std::vector<std::pair<named_type, wire_bounds>>> results(mods.size());
+
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        bounds_calculator calculator(analyzed);
+        for (const auto& [def, kind] : aggregate_types(*mods[i])) {
+            results[i].emplace_back(def, calculator.of_definition(def));
+        }
+    });
+
+    for (auto& module_results : results) {
+        for (auto& [def, bounds] : module_results) {
+            analyzed.type_bounds[def] = std::move(bounds);
+        }
+    }
+}
+
+} // namespace phases
+
+// ============================================================================
+// Size Report
+// ============================================================================
+
+namespace {
+    std::string json_escape(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    template<typename T>
+    std::string json_number(const std::optional<T>& value) {
+        return value ? std::to_string(*value) : "null";
+    }
+}
+
+std::string format_size_report(const analyzed_module_set& analyzed) {
+    std::ostringstream out;
+    out << "{\n  \"types\": [";
+
+    bool first = true;
+    for (const auto* mod : detail::modules_in_order(*analyzed.original)) {
+        for (const auto& [def, kind] : phases::aggregate_types(*mod)) {
+            auto it = analyzed.type_bounds.find(def);
+            if (it == analyzed.type_bounds.end()) {
+                continue;
+            }
+            const auto& bounds = it->second;
+            std::string name = std::visit([](auto* d) { return d->name; }, def);
+
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "    {\n";
+            out << "      \"name\": \"" << json_escape(name) << "\",\n";
+            out << "      \"kind\": \"" << kind << "\",\n";
+            out << "      \"min_wire_size\": " << bounds.min_size << ",\n";
+            out << "      \"max_wire_size\": " << json_number(bounds.max_size) << ",\n";
+            out << "      \"max_heap_bytes\": " << json_number(bounds.max_heap_bytes) << ",\n";
+            out << "      \"arrays\": [";
+            for (size_t i = 0; i < bounds.arrays.size(); ++i) {
+                const auto& array = bounds.arrays[i];
+                out << (i == 0 ? "\n" : ",\n");
+                out << "        {\"field\": \"" << json_escape(array.field) << "\", \"max_count\": "
+                    << json_number(array.max_count) << ", \"inputs\": [";
+                for (size_t j = 0; j < array.inputs.size(); ++j) {
+                    out << (j == 0 ? "" : ", ") << "\"" << json_escape(array.inputs[j]) << "\"";
+                }
+                out << "]}";
+            }
+            out << (bounds.arrays.empty() ? "]\n" : "\n      ]\n");
+            out << "    }";
+        }
+    }
+
+    out << (first ? "]\n}\n" : "\n  ]\n}\n");
+    return out.str();
+}
+
+} // namespace datascript::semantic
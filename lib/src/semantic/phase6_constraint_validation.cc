@@ -8,6 +8,7 @@
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
 
 namespace datascript::semantic::phases {
@@ -284,7 +285,7 @@ namespace {
 
     void validate_module_constraints(
         const ast::module& mod,
-        analyzed_module_set& analyzed,
+        const analyzed_module_set& analyzed,
         std::vector<diagnostic>& diags)
     {
         // Validate explicit constraint definitions
@@ -317,15 +318,18 @@ namespace {
 void validate_constraints(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    // Validate constraints in main module
-    validate_module_constraints(modules.main.module, analyzed, diagnostics);
+    // Validation only reads the analysis state, so modules are independent
+    auto mods = detail::modules_in_order(modules);
+    std::vector<std::vector<diagnostic>> diags(mods.size());
 
-    // Validate constraints in all imported modules
-    for (const auto& imported : modules.imported) {
-        validate_module_constraints(imported.module, analyzed, diagnostics);
-    }
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        validate_module_constraints(*mods[i], analyzed, diags[i]);
+    });
+
+    detail::merge_diagnostics(diags, diagnostics);
 }
 
 } // namespace datascript::semantic::phases
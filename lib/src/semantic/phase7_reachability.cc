@@ -9,6 +9,7 @@
 //
 
 #include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
 #include <algorithm>
 #include <set>
 
@@ -43,6 +44,17 @@ namespace {
         std::set<const ast::choice_def*> used_choices;
         std::set<const ast::constraint_def*> used_constraints;
         std::set<std::string> used_imports;  // Package names
+
+        // Fold another tracker's usage into this one
+        void merge(usage_tracker& other) {
+            used_constants.merge(other.used_constants);
+            used_structs.merge(other.used_structs);
+            used_unions.merge(other.used_unions);
+            used_enums.merge(other.used_enums);
+            used_choices.merge(other.used_choices);
+            used_constraints.merge(other.used_constraints);
+            used_imports.merge(other.used_imports);
+        }
     };
 
     // Forward declarations
@@ -313,16 +325,20 @@ namespace {
 void analyze_reachability(
     const module_set& modules,
     analyzed_module_set& analyzed,
-    std::vector<diagnostic>& diagnostics)
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
 {
-    usage_tracker tracker;
+    // Track usage per module (main first, then imports), then union the sets
+    auto mods = detail::modules_in_order(modules);
+    std::vector<usage_tracker> trackers(mods.size());
 
-    // Track usage in main module
-    track_module_usage(modules.main.module, analyzed, tracker);
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        track_module_usage(*mods[i], analyzed, trackers[i]);
+    });
 
-    // Track usage in all imported modules
-    for (const auto& imported : modules.imported) {
-        track_module_usage(imported.module, analyzed, tracker);
+    usage_tracker tracker;
+    for (auto& module_tracker : trackers) {
+        tracker.merge(module_tracker);
     }
 
     // Detect unused symbols in main module
@@ -0,0 +1,758 @@
+//
+// Phase 8: Decode Cost Analysis
+//
+// Estimates the per-decode work of every struct, union and choice and
+// warns about schema patterns that make generated readers slow or let the
+// input decide how much work they do:
+// - Unbounded arrays of structs
+// - Unions that reject cases by trial decoding
+// - Array lengths with no upper bound
+// - Backward label seeks
+// - Choices too large for linear dispatch
+//
+
+#include <datascript/semantic.hh>
+#include "semantic/parallel.hh"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace datascript::semantic {
+
+namespace phases {
+
+namespace {
+    // Helper: add warning diagnostic
+    void add_warning(std::vector<diagnostic>& diags,
+                    const char* code,
+                    const std::string& message,
+                    const ast::source_pos& pos) {
+        diags.push_back(diagnostic{
+            diagnostic_level::warning,
+            code,
+            message,
+            pos,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt
+        });
+    }
+
+    // Choices with more case comparisons than this get W_LARGE_CHOICE
+    constexpr size_t max_linear_cases = 16;
+
+    // Array counts read from wider fields need a constraint to be bounded
+    constexpr uint32_t max_unconstrained_count_bits = 16;
+
+    using named_type = analyzed_module_set::resolved_type;
+
+    // ========================================================================
+    // Helpers
+    // ========================================================================
+
+    size_t saturating_add(size_t a, size_t b) {
+        return a > std::numeric_limits<size_t>::max() - b ? std::numeric_limits<size_t>::max() : a + b;
+    }
+
+    size_t saturating_mul(size_t a, uint64_t b) {
+        if (a == 0 || b == 0) {
+            return 0;
+        }
+        return b > std::numeric_limits<size_t>::max() / a ? std::numeric_limits<size_t>::max()
+                                                          : a * static_cast<size_t>(b);
+    }
+
+    void accumulate(decode_cost& total, const decode_cost& part, uint64_t times = 1) {
+        total.checked_reads = saturating_add(total.checked_reads, saturating_mul(part.checked_reads, times));
+        total.branches = saturating_add(total.branches, saturating_mul(part.branches, times));
+        total.allocations = saturating_add(total.allocations, saturating_mul(part.allocations, times));
+        total.throw_sites = saturating_add(total.throw_sites, saturating_mul(part.throw_sites, times));
+        total.runtime_loops = saturating_add(total.runtime_loops, saturating_mul(part.runtime_loops, times));
+    }
+
+    decode_cost component_max(const decode_cost& a, const decode_cost& b) {
+        return decode_cost{
+            std::max(a.checked_reads, b.checked_reads),
+            std::max(a.branches, b.branches),
+            std::max(a.allocations, b.allocations),
+            std::max(a.throw_sites, b.throw_sites),
+            std::max(a.runtime_loops, b.runtime_loops)
+        };
+    }
+
+    const void* definition_key(const named_type& def) {
+        return std::visit([](auto* d) -> const void* { return d; }, def);
+    }
+
+    std::string definition_name(const named_type& def) {
+        return std::visit([](auto* d) { return d->name; }, def);
+    }
+
+    // Definition a type reference names (struct, enum, alias, ...), if any
+    std::optional<named_type> resolve_named(const ast::type& type, const analyzed_module_set& analyzed) {
+        const ast::qualified_name* qname = nullptr;
+        if (auto* name = std::get_if<ast::qualified_name>(&type.node)) {
+            qname = name;
+        } else if (auto* inst = std::get_if<ast::type_instantiation>(&type.node)) {
+            qname = &inst->base_type;
+        } else {
+            return std::nullopt;
+        }
+
+        auto it = analyzed.resolved_types.find(qname);
+        if (it != analyzed.resolved_types.end()) {
+            return it->second;
+        }
+
+        // Parameterized references are not recorded by name resolution
+        const auto& symbols = analyzed.symbols;
+        if (auto* def = symbols.find_struct_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_union_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_choice_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_enum_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_subtype_qualified(qname->parts)) return named_type{def};
+        if (auto* def = symbols.find_type_alias_qualified(qname->parts)) return named_type{def};
+        return std::nullopt;
+    }
+
+    // Like resolve_named, but looks through type aliases
+    std::optional<named_type> resolve_definition(const ast::type& type, const analyzed_module_set& analyzed) {
+        auto def = resolve_named(type, analyzed);
+        for (size_t depth = 0; def && depth < 64; ++depth) {
+            auto* alias = std::get_if<const ast::type_alias_def*>(&*def);
+            if (!alias) {
+                return def;
+            }
+            def = resolve_named((*alias)->target_type, analyzed);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<uint64_t> constant_value(const ast::expr& expr, const analyzed_module_set& analyzed) {
+        std::vector<diagnostic> scratch;  // Runtime sizes are not errors here
+        return evaluate_constant_uint(expr, analyzed, scratch);
+    }
+
+    // Number of selector comparisons an if-chain dispatch performs in the worst case
+    size_t count_case_comparisons(const ast::choice_def& choice) {
+        size_t comparisons = 0;
+        for (const auto& choice_case : choice.cases) {
+            if (choice_case.is_default) {
+                continue;
+            }
+            comparisons += choice_case.selector_kind == ast::case_selector_kind::exact
+                               ? choice_case.case_exprs.size()
+                               : 1;
+        }
+        return comparisons;
+    }
+
+    // ========================================================================
+    // Cost Model
+    // ========================================================================
+
+    // Decode cost and minimum encoded size of types, memoized per definition.
+    // Recursive references (only possible through arrays) count as free.
+    class cost_model {
+    public:
+        explicit cost_model(const analyzed_module_set& analyzed)
+            : analyzed_(analyzed) {}
+
+        decode_cost of_definition(const named_type& def) {
+            const void* key = definition_key(def);
+            if (auto it = costs_.find(key); it != costs_.end()) {
+                return it->second;
+            }
+            if (!costing_.insert(key).second) {
+                return {};
+            }
+
+            decode_cost cost;
+            if (auto* s = std::get_if<const ast::struct_def*>(&def)) {
+                cost = of_items((*s)->body);
+            } else if (auto* u = std::get_if<const ast::union_def*>(&def)) {
+                cost = of_union(**u);
+            } else if (auto* c = std::get_if<const ast::choice_def*>(&def)) {
+                cost = of_choice(**c);
+            } else if (auto* e = std::get_if<const ast::enum_def*>(&def)) {
+                cost = of_type((*e)->base_type);
+            } else if (auto* st = std::get_if<const ast::subtype_def*>(&def)) {
+                cost = of_type((*st)->base_type);
+                cost.branches++;  // Subtype constraint
+                cost.throw_sites++;
+            } else if (auto* a = std::get_if<const ast::type_alias_def*>(&def)) {
+                cost = of_type((*a)->target_type);
+            }
+
+            costing_.erase(key);
+            costs_[key] = cost;
+            return cost;
+        }
+
+        decode_cost of_type(const ast::type& type) {
+            decode_cost cost;
+            const auto& node = type.node;
+
+            if (std::holds_alternative<ast::primitive_type>(node) ||
+                std::holds_alternative<ast::float_type>(node) ||
+                std::holds_alternative<ast::bool_type>(node) ||
+                std::holds_alternative<ast::bit_field_type_fixed>(node) ||
+                std::holds_alternative<ast::bit_field_type_expr>(node)) {
+                cost.checked_reads = 1;
+                cost.throw_sites = 1;
+            }
+            else if (std::holds_alternative<ast::string_type>(node) ||
+                     std::holds_alternative<ast::u16_string_type>(node) ||
+                     std::holds_alternative<ast::u32_string_type>(node)) {
+                // Terminator scan plus the copy into std::string
+                cost.checked_reads = 1;
+                cost.branches = 1;
+                cost.allocations = 1;
+                cost.throw_sites = 1;
+                cost.runtime_loops = 1;
+            }
+            else if (auto* fixed = std::get_if<ast::array_type_fixed>(&node)) {
+                auto element = of_type(*fixed->element_type);
+                if (auto count = constant_value(fixed->size, analyzed_)) {
+                    accumulate(cost, element, *count);
+                } else {
+                    add_runtime_loop(cost, element);
+                }
+            }
+            else if (auto* ranged = std::get_if<ast::array_type_range>(&node)) {
+                add_runtime_loop(cost, of_type(*ranged->element_type));
+                cost.branches++;  // Length check against the range
+                cost.throw_sites++;
+            }
+            else if (auto* unsized = std::get_if<ast::array_type_unsized>(&node)) {
+                add_runtime_loop(cost, of_type(*unsized->element_type));
+            }
+            else if (auto def = resolve_named(type, analyzed_)) {
+                cost = of_definition(*def);
+            }
+
+            return cost;
+        }
+
+        decode_cost of_items(const std::vector<ast::struct_body_item>& items) {
+            decode_cost cost;
+            for (const auto& item : items) {
+                if (auto* field = std::get_if<ast::field_def>(&item)) {
+                    accumulate(cost, of_type(field->field_type));
+                    if (field->condition) {
+                        cost.branches++;
+                    }
+                    if (field->constraint) {
+                        cost.branches++;
+                        cost.throw_sites++;
+                    }
+                }
+                else if (std::holds_alternative<ast::label_directive>(item) ||
+                         std::holds_alternative<ast::alignment_directive>(item)) {
+                    // Seek with a bounds check
+                    cost.branches++;
+                    cost.throw_sites++;
+                }
+            }
+            return cost;
+        }
+
+        // Lower bound on the bytes a type occupies on the wire
+        size_t min_size(const ast::type& type) {
+            const auto& node = type.node;
+
+            if (auto* prim = std::get_if<ast::primitive_type>(&node)) {
+                return prim->bits / 8;
+            }
+            if (auto* flt = std::get_if<ast::float_type>(&node)) {
+                return flt->bits / 8;
+            }
+            if (std::holds_alternative<ast::bool_type>(node) ||
+                std::holds_alternative<ast::string_type>(node)) {
+                return 1;
+            }
+            if (std::holds_alternative<ast::u16_string_type>(node)) {
+                return 2;
+            }
+            if (std::holds_alternative<ast::u32_string_type>(node)) {
+                return 4;
+            }
+            if (auto* arr = std::get_if<ast::array_type_fixed>(&node)) {
+                auto count = constant_value(arr->size, analyzed_);
+                return count ? saturating_mul(min_size(*arr->element_type), *count) : 0;
+            }
+            if (auto* arr = std::get_if<ast::array_type_range>(&node)) {
+                if (!arr->min_size) {
+                    return 0;
+                }
+                auto count = constant_value(*arr->min_size, analyzed_);
+                return count ? saturating_mul(min_size(*arr->element_type), *count) : 0;
+            }
+            if (auto def = resolve_named(type, analyzed_)) {
+                return min_size_of(*def);
+            }
+            // Bit fields may share bytes with their neighbours; unsized arrays may be empty
+            return 0;
+        }
+
+    private:
+        static void add_runtime_loop(decode_cost& cost, const decode_cost& element) {
+            accumulate(cost, element);
+            cost.branches++;     // Loop test
+            cost.allocations++;  // std::vector storage
+            cost.runtime_loops++;
+        }
+
+        // Aggregates come from the wire bounds computed in phase 5
+        size_t min_size_of(const named_type& def) {
+            if (auto it = analyzed_.type_bounds.find(def); it != analyzed_.type_bounds.end()) {
+                return it->second.min_size;
+            }
+            if (auto* e = std::get_if<const ast::enum_def*>(&def)) {
+                return min_size((*e)->base_type);
+            }
+            if (auto* st = std::get_if<const ast::subtype_def*>(&def)) {
+                return min_size((*st)->base_type);
+            }
+            if (auto* a = std::get_if<const ast::type_alias_def*>(&def)) {
+                return min_size((*a)->target_type);
+            }
+            return 0;
+        }
+
+        decode_cost of_union(const ast::union_def& union_def) {
+            // Worst case: every case is decoded before the last one succeeds
+            decode_cost cost;
+            for (const auto& union_case : union_def.cases) {
+                accumulate(cost, of_items(union_case.items));
+                cost.branches++;  // try/catch and position restore
+                if (union_case.condition) {
+                    cost.branches++;
+                    cost.throw_sites++;
+                }
+            }
+            return cost;
+        }
+
+        decode_cost of_choice(const ast::choice_def& choice) {
+            decode_cost cost;
+            if (!choice.selector) {
+                if (choice.inline_discriminator_type) {
+                    cost = of_type(*choice.inline_discriminator_type);
+                } else {
+                    cost.checked_reads = 1;
+                    cost.throw_sites = 1;
+                }
+            }
+
+            cost.branches += count_case_comparisons(choice);
+            bool has_default = std::any_of(choice.cases.begin(), choice.cases.end(),
+                                           [](const auto& c) { return c.is_default; });
+            if (!has_default) {
+                cost.throw_sites++;  // No matching case
+            }
+
+            decode_cost worst;
+            for (const auto& choice_case : choice.cases) {
+                worst = component_max(worst, of_items(choice_case.items));
+            }
+            accumulate(cost, worst);
+            return cost;
+        }
+
+        const analyzed_module_set& analyzed_;
+        std::map<const void*, decode_cost> costs_;
+        std::set<const void*> costing_;  // Definitions on the current cost path
+    };
+
+    // ========================================================================
+    // Performance Lints
+    // ========================================================================
+
+    // Fields and member functions visible to expressions in a body
+    struct body_scope {
+        std::map<std::string, const ast::field_def*> fields;  // Fields read so far
+        std::map<std::string, const ast::function_def*> functions;
+    };
+
+    class decode_linter {
+    public:
+        decode_linter(const analyzed_module_set& analyzed, cost_model& model,
+                      std::vector<diagnostic>& diags)
+            : analyzed_(analyzed), model_(model), diags_(diags) {}
+
+        void check_struct(const ast::struct_def& struct_def) {
+            body_scope scope;
+            for (const auto& item : struct_def.body) {
+                if (auto* func = std::get_if<ast::function_def>(&item)) {
+                    scope.functions[func->name] = func;
+                }
+            }
+            check_items(struct_def.name, struct_def.body, scope);
+        }
+
+        void check_union(const ast::union_def& union_def) {
+            for (const auto& union_case : union_def.cases) {
+                body_scope scope;
+                check_items(union_def.name, union_case.items, scope);
+            }
+
+            if (union_def.cases.size() < 2) {
+                return;
+            }
+            std::string slow_cases;
+            const ast::union_case* first_slow = nullptr;
+            for (size_t i = 0; i + 1 < union_def.cases.size(); ++i) {
+                const auto& union_case = union_def.cases[i];
+                if (rejects_cheaply(union_case)) {
+                    continue;
+                }
+                if (!first_slow) {
+                    first_slow = &union_case;
+                } else {
+                    slow_cases += ", ";
+                }
+                slow_cases += "'" + union_case.case_name + "'";
+            }
+            if (first_slow) {
+                add_warning(diags_, diag_codes::W_TRIAL_DECODING,
+                    "Union '" + union_def.name + "' can only reject " +
+                    (slow_cases.find(',') == std::string::npos ? "case " : "cases ") + slow_cases +
+                    " by decoding them and catching the failure, so input for later cases pays "
+                    "for every earlier case; start each case but the last with a constrained tag "
+                    "field (e.g. 'uint8 tag : tag == 1;') or use a choice with a selector",
+                    first_slow->pos);
+            }
+        }
+
+        void check_choice(const ast::choice_def& choice) {
+            for (const auto& choice_case : choice.cases) {
+                body_scope scope;
+                check_items(choice.name, choice_case.items, scope);
+            }
+
+            size_t comparisons = count_case_comparisons(choice);
+            if (comparisons > max_linear_cases) {
+                add_warning(diags_, diag_codes::W_LARGE_CHOICE,
+                    "Choice '" + choice.name + "' dispatches on " + std::to_string(comparisons) +
+                    " case values with a chain of comparisons, so a late case costs up to " +
+                    std::to_string(comparisons) + " branches per decode; group values with "
+                    "range cases or split the choice on a coarser selector",
+                    choice.pos);
+            }
+        }
+
+    private:
+        void check_items(const std::string& owner,
+                         const std::vector<ast::struct_body_item>& items,
+                         body_scope& scope) {
+            size_t position = 0;  // Bytes certainly read since the start of the body
+            for (const auto& item : items) {
+                if (auto* field = std::get_if<ast::field_def>(&item)) {
+                    check_array(*field, scope);
+                    if (!field->condition) {
+                        position = saturating_add(position, model_.min_size(field->field_type));
+                    }
+                    scope.fields[field->name] = field;
+                }
+                else if (auto* label = std::get_if<ast::label_directive>(&item)) {
+                    auto offset = constant_value(label->label_expr, analyzed_);
+                    if (offset && *offset < position) {
+                        add_warning(diags_, diag_codes::W_BACKWARD_SEEK,
+                            "Label in '" + owner + "' seeks back to offset " +
+                            std::to_string(*offset) + " after at least " + std::to_string(position) +
+                            " bytes were read; backward seeks defeat streaming and prefetching, "
+                            "so place the labelled fields after the data before them",
+                            label->pos);
+                    }
+                    position = offset ? static_cast<size_t>(*offset) : 0;
+                }
+            }
+        }
+
+        void check_array(const ast::field_def& field, const body_scope& scope) {
+            const auto& node = field.field_type.node;
+
+            if (auto* arr = std::get_if<ast::array_type_unsized>(&node)) {
+                auto element = resolve_definition(*arr->element_type, analyzed_);
+                if (element && (std::holds_alternative<const ast::struct_def*>(*element) ||
+                                std::holds_alternative<const ast::union_def*>(*element) ||
+                                std::holds_alternative<const ast::choice_def*>(*element))) {
+                    add_warning(diags_, diag_codes::W_UNBOUNDED_STRUCT_ARRAY,
+                        "Field '" + field.name + "' is an unbounded array of '" +
+                        definition_name(*element) + "': elements are decoded until the input "
+                        "runs out, so the input decides the decode time and allocation size; "
+                        "give it an explicit count or a ranged size such as '" +
+                        definition_name(*element) + "[..1024]'",
+                        field.pos);
+                }
+            }
+            else if (auto* fixed = std::get_if<ast::array_type_fixed>(&node)) {
+                check_count(field, fixed->size, scope);
+            }
+        }
+
+        void check_count(const ast::field_def& field, const ast::expr& size, const body_scope& scope) {
+            if (constant_value(size, analyzed_)) {
+                return;
+            }
+
+            std::vector<const ast::field_def*> inputs;
+            if (!collect_count_inputs(size, scope, inputs)) {
+                return;  // Depends on something we cannot see through
+            }
+
+            for (const auto* input : inputs) {
+                if (input->constraint) {
+                    continue;
+                }
+                auto bits = integer_bits(input->field_type);
+                if (!bits || *bits <= max_unconstrained_count_bits) {
+                    continue;
+                }
+
+                uint64_t max_count = *bits >= 64 ? std::numeric_limits<uint64_t>::max()
+                                                 : (uint64_t{1} << *bits) - 1;
+                add_warning(diags_, diag_codes::W_UNBOUNDED_COUNT,
+                    "Array '" + field.name + "' takes its length from '" + input->name + "' (" +
+                    std::to_string(*bits) + "-bit, unconstrained), so malformed input can "
+                    "request up to " + std::to_string(max_count) + " elements; constrain it "
+                    "(e.g. '" + input->name + " : " + input->name + " <= 4096') or use a "
+                    "narrower count field",
+                    field.pos);
+                return;
+            }
+        }
+
+        // Collect the fields an array length reads. Returns false if the
+        // length calls something that is not a known pure member function.
+        bool collect_count_inputs(const ast::expr& expr, const body_scope& scope,
+                                  std::vector<const ast::field_def*>& inputs) {
+            if (auto* id = std::get_if<ast::identifier>(&expr.node)) {
+                if (auto it = scope.fields.find(id->name); it != scope.fields.end()) {
+                    inputs.push_back(it->second);
+                }
+                return true;
+            }
+            if (std::holds_alternative<ast::field_access_expr>(expr.node)) {
+                if (auto* member = member_field(expr, scope)) {
+                    inputs.push_back(member);
+                }
+                return true;
+            }
+            if (auto* unary = std::get_if<ast::unary_expr>(&expr.node)) {
+                return collect_count_inputs(*unary->operand, scope, inputs);
+            }
+            if (auto* binary = std::get_if<ast::binary_expr>(&expr.node)) {
+                return collect_count_inputs(*binary->left, scope, inputs) &&
+                       collect_count_inputs(*binary->right, scope, inputs);
+            }
+            if (auto* ternary = std::get_if<ast::ternary_expr>(&expr.node)) {
+                return collect_count_inputs(*ternary->condition, scope, inputs) &&
+                       collect_count_inputs(*ternary->true_expr, scope, inputs) &&
+                       collect_count_inputs(*ternary->false_expr, scope, inputs);
+            }
+            if (auto* index = std::get_if<ast::array_index_expr>(&expr.node)) {
+                return collect_count_inputs(*index->array, scope, inputs) &&
+                       collect_count_inputs(*index->index, scope, inputs);
+            }
+            if (auto* call = std::get_if<ast::function_call_expr>(&expr.node)) {
+                auto* name = std::get_if<ast::identifier>(&call->function->node);
+                if (!name) {
+                    return false;
+                }
+                auto func = scope.functions.find(name->name);
+                if (func == scope.functions.end()) {
+                    return false;
+                }
+                auto pure = analyzed_.pure_functions.find(func->second);
+                if (pure == analyzed_.pure_functions.end()) {
+                    return false;
+                }
+                for (const auto& field_name : pure->second) {
+                    if (auto it = scope.fields.find(field_name); it != scope.fields.end()) {
+                        inputs.push_back(it->second);
+                    }
+                }
+                for (const auto& arg : call->arguments) {
+                    if (!collect_count_inputs(arg, scope, inputs)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return true;  // Literals
+        }
+
+        // Field definition an identifier or field access chain names, if any
+        const ast::field_def* member_field(const ast::expr& expr, const body_scope& scope) {
+            if (auto* id = std::get_if<ast::identifier>(&expr.node)) {
+                auto it = scope.fields.find(id->name);
+                return it != scope.fields.end() ? it->second : nullptr;
+            }
+            auto* access = std::get_if<ast::field_access_expr>(&expr.node);
+            if (!access) {
+                return nullptr;
+            }
+            const auto* parent = member_field(*access->object, scope);
+            if (!parent) {
+                return nullptr;
+            }
+            auto def = resolve_definition(parent->field_type, analyzed_);
+            auto* struct_def = def ? std::get_if<const ast::struct_def*>(&*def) : nullptr;
+            if (!struct_def) {
+                return nullptr;
+            }
+            for (const auto& item : (*struct_def)->body) {
+                if (auto* field = std::get_if<ast::field_def>(&item); field && field->name == access->field_name) {
+                    return field;
+                }
+            }
+            return nullptr;
+        }
+
+        // Width of an integer field type, or nullopt if it is not a plain
+        // integer (subtypes carry their own constraint)
+        std::optional<uint32_t> integer_bits(const ast::type& type) {
+            if (auto* prim = std::get_if<ast::primitive_type>(&type.node)) {
+                return prim->bits;
+            }
+            if (auto* bits = std::get_if<ast::bit_field_type_fixed>(&type.node)) {
+                return static_cast<uint32_t>(bits->width);
+            }
+            auto def = resolve_definition(type, analyzed_);
+            if (def) {
+                if (auto* e = std::get_if<const ast::enum_def*>(&*def)) {
+                    return integer_bits((*e)->base_type);
+                }
+            }
+            return std::nullopt;
+        }
+
+        // True if a failing case throws after one small read
+        bool rejects_cheaply(const ast::union_case& union_case) {
+            for (const auto& item : union_case.items) {
+                auto* field = std::get_if<ast::field_def>(&item);
+                if (!field) {
+                    if (std::holds_alternative<ast::function_def>(item)) {
+                        continue;
+                    }
+                    return false;
+                }
+
+                const auto& node = field->field_type.node;
+                bool scalar = std::holds_alternative<ast::primitive_type>(node) ||
+                              std::holds_alternative<ast::bit_field_type_fixed>(node) ||
+                              std::holds_alternative<ast::bool_type>(node) ||
+                              std::holds_alternative<ast::float_type>(node);
+                auto def = resolve_definition(field->field_type, analyzed_);
+                if (def && std::holds_alternative<const ast::enum_def*>(*def)) {
+                    scalar = true;
+                }
+                if (def && std::holds_alternative<const ast::subtype_def*>(*def)) {
+                    return true;  // Subtype constraint checks right after the read
+                }
+                // A simple case's "T x : cond;" is stored as the case condition
+                bool constrained = field->constraint.has_value() ||
+                                   (!union_case.is_anonymous_block && union_case.condition.has_value());
+                return scalar && constrained;
+            }
+            return false;
+        }
+
+        const analyzed_module_set& analyzed_;
+        cost_model& model_;
+        std::vector<diagnostic>& diags_;
+    };
+
+} // anonymous namespace
+
+// ============================================================================
+// Public API: Decode Cost Analysis
+// ============================================================================
+
+void analyze_decode_cost(
+    const module_set& modules,
+    analyzed_module_set& analyzed,
+    std::vector<diagnostic>& diagnostics,
+    size_t jobs)
+{
+    auto mods = detail::modules_in_order(modules);
+    std::vector<std::vector<type_decode_cost>> costs(mods.size());
+
+    detail::parallel_for(mods.size(), jobs, [&](size_t i) {
+        cost_model model(analyzed);
+        const auto& mod = *mods[i];
+        for (const auto& s : mod.structs) {
+            costs[i].push_back({s.name, "struct", s.pos, model.of_definition(&s)});
+        }
+        for (const auto& u : mod.unions) {
+            costs[i].push_back({u.name, "union", u.pos, model.of_definition(&u)});
+        }
+        for (const auto& c : mod.choices) {
+            costs[i].push_back({c.name, "choice", c.pos, model.of_definition(&c)});
+        }
+    });
+
+    for (auto& module_costs : costs) {
+        analyzed.decode_costs.insert(analyzed.decode_costs.end(),
+                                     std::make_move_iterator(module_costs.begin()),
+                                     std::make_move_iterator(module_costs.end()));
+    }
+
+    // Lint the main module only (imports are linted when compiled themselves)
+    cost_model model(analyzed);
+    decode_linter linter(analyzed, model, diagnostics);
+    const auto& main = modules.main.module;
+    for (const auto& s : main.structs) {
+        linter.check_struct(s);
+    }
+    for (const auto& u : main.unions) {
+        linter.check_union(u);
+    }
+    for (const auto& c : main.choices) {
+        linter.check_choice(c);
+    }
+}
+
+} // namespace phases
+
+// ============================================================================
+// Cost Report
+// ============================================================================
+
+std::string format_cost_report(const analyzed_module_set& analyzed) {
+    if (analyzed.decode_costs.empty()) {
+        return {};
+    }
+
+    size_t name_width = 4;
+    for (const auto& entry : analyzed.decode_costs) {
+        name_width = std::max(name_width, entry.name.size());
+    }
+
+    std::ostringstream out;
+    out << std::left << std::setw(static_cast<int>(name_width)) << "Type" << "  "
+        << std::setw(6) << "Kind" << std::right
+        << std::setw(8) << "Reads" << std::setw(10) << "Branches"
+        << std::setw(8) << "Allocs" << std::setw(8) << "Throws"
+        << std::setw(7) << "Loops" << '\n';
+
+    for (const auto& entry : analyzed.decode_costs) {
+        const auto& cost = entry.cost;
+        out << std::left << std::setw(static_cast<int>(name_width)) << entry.name << "  "
+            << std::setw(6) << entry.kind << std::right
+            << std::setw(8) << cost.checked_reads << std::setw(10) << cost.branches
+            << std::setw(8) << cost.allocations << std::setw(8) << cost.throw_sites
+            << std::setw(7) << cost.runtime_loops << '\n';
+    }
+
+    out << "\nCounts are per decode; loops whose trip count comes from the input "
+           "are counted once.\n";
+    return out.str();
+}
+
+} // namespace datascript::semantic
@@ -0,0 +1,46 @@
+//
+// Shared fixtures for code generation tests: schema source to IR, and IR to
+// C++ with renderer options set as `ds --cpp-<name>=<value>` would set them
+//
+
+#pragma once
+
+#include <doctest/doctest.h>
+#include <datascript/parser.hh>
+#include <datascript/semantic.hh>
+#include <datascript/ir_builder.hh>
+#include <datascript/codegen/cpp/cpp_renderer.hh>
+#include <map>
+#include <string>
+
+namespace datascript::codegen_test {
+
+// Parse, analyze and convert to IR; the schema must analyze cleanly
+inline ir::bundle build_bundle(const std::string& source) {
+    auto parsed = parse_datascript(std::string(source));
+
+    module_set modules;
+    modules.main.module = std::move(parsed);
+    modules.main.file_path = "test.ds";
+    modules.main.package_name = "test";
+
+    auto analysis = semantic::analyze(modules);
+    REQUIRE_FALSE( analysis.has_errors() );
+
+    return ir::build_ir(analysis.analyzed.value());
+}
+
+// Render a schema with the given generator options
+inline std::string generate_with_options(const std::string& source,
+                                         const std::map<std::string, codegen::OptionValue>& options,
+                                         const codegen::RenderOptions& render_options = {}) {
+    auto ir_module = build_bundle(source);
+
+    codegen::CppRenderer renderer;
+    for (const auto& [name, value] : options) {
+        renderer.set_option(name, value);
+    }
+    return renderer.render_module(ir_module, render_options);
+}
+
+} // namespace datascript::codegen_test
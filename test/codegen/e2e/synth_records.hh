@@ -0,0 +1,57 @@
+//
+// Record buffers written by `ds --synth` at build time (datascript_synthesize()
+// in test/CMakeLists.txt), for e2e tests that decode them with the generated
+// readers
+//
+
+#pragma once
+
+#include <doctest/doctest.h>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace synth_records {
+
+// Instances per buffer, as passed to --synth-count
+constexpr size_t count = SYNTH_RECORD_COUNT;
+
+// Contents of <schema>.<Type>.bin, followed by `padding` zero bytes that are
+// not part of the records
+inline std::vector<uint8_t> load(const std::string& schema, const std::string& type, size_t padding = 0) {
+    const std::string path = std::string(SYNTH_DATA_DIR) + "/" + schema + "." + type + ".bin";
+    std::ifstream in(path, std::ios::binary);
+    REQUIRE_MESSAGE( in, "missing synthesized data " << path );
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    REQUIRE_FALSE( bytes.empty() );
+    bytes.resize(bytes.size() + padding, 0x00);
+    return bytes;
+}
+
+// Decode back-to-back T records from the first `size` bytes until they are
+// used up; returns the number decoded
+template<typename T>
+size_t read_all(const std::vector<uint8_t>& bytes, size_t size) {
+    const uint8_t* ptr = bytes.data();
+    const uint8_t* end = bytes.data() + size;
+    size_t decoded = 0;
+    while (ptr < end) {
+        const uint8_t* start = ptr;
+        T::read(ptr, end);
+        REQUIRE( ptr > start );
+        ++decoded;
+    }
+    CHECK( ptr == end );
+    return decoded;
+}
+
+template<typename T>
+size_t read_all(const std::vector<uint8_t>& bytes) {
+    return read_all<T>(bytes, bytes.size());
+}
+
+} // namespace synth_records
@@ -0,0 +1,168 @@
+//
+// End-to-End Test: Delta-Encoded Array Transforms
+// Encodes values with a reference encoder, decodes them with the generated
+// readers, and checks every count from 0 up to several SIMD blocks, so each
+// tail length after the SSE2 lanes is covered
+//
+#include <doctest/doctest.h>
+#include <e2e_array_transforms.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <array>
+#include <type_traits>
+#include <vector>
+
+using namespace e2e_array_transforms;
+
+namespace {
+
+    constexpr uint8_t TRAILER = 0xA5;
+
+    enum class Encoding { delta, delta_of_delta, zigzag_delta };
+
+    // Values that wrap around the element width, so sums must wrap too
+    template<typename T>
+    std::vector<T> sample_values(size_t count) {
+        using U = std::make_unsigned_t<T>;
+        std::vector<T> values;
+        for (size_t i = 0; i < count; ++i) {
+            U v = static_cast<U>(static_cast<U>(i * i * 2654435761u) ^ static_cast<U>(i % 3 == 0 ? ~U{0} : U{0}));
+            values.push_back(static_cast<T>(v));
+        }
+        return values;
+    }
+
+    // Reference encoder: wire values for `values` under `encoding`
+    template<typename T>
+    std::vector<std::make_unsigned_t<T>> encode(const std::vector<T>& values, Encoding encoding) {
+        using U = std::make_unsigned_t<T>;
+        std::vector<U> wire;
+        U previous = 0;
+        U previous_delta = 0;
+        for (T value : values) {
+            const U v = static_cast<U>(value);
+            const U delta = static_cast<U>(v - previous);
+            switch (encoding) {
+                case Encoding::delta:
+                    wire.push_back(delta);
+                    break;
+                case Encoding::delta_of_delta:
+                    wire.push_back(static_cast<U>(delta - previous_delta));
+                    break;
+                case Encoding::zigzag_delta: {
+                    constexpr unsigned bits = sizeof(U) * 8;
+                    const U sign = (delta >> (bits - 1)) ? ~U{0} : U{0};
+                    wire.push_back(static_cast<U>(static_cast<U>(delta << 1) ^ sign));
+                    break;
+                }
+            }
+            previous = v;
+            previous_delta = delta;
+        }
+        return wire;
+    }
+
+    template<typename U>
+    void put(std::vector<uint8_t>& bytes, U value, bool big) {
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            const size_t shift = 8 * (big ? sizeof(U) - 1 - i : i);
+            bytes.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    // count, wire values, trailer
+    template<typename T>
+    std::vector<uint8_t> message(const std::vector<T>& values, Encoding encoding, bool big = false, bool with_count = true) {
+        std::vector<uint8_t> bytes;
+        if (with_count) {
+            bytes.push_back(static_cast<uint8_t>(values.size()));
+        }
+        for (auto w : encode(values, encoding)) {
+            put(bytes, w, big);
+        }
+        bytes.push_back(TRAILER);
+        return bytes;
+    }
+
+    // Decode every count in [0, 19] and compare with the original values
+    template<typename S, typename T>
+    void check_all_counts(Encoding encoding, bool big = false) {
+        for (size_t count = 0; count < 20; ++count) {
+            CAPTURE( count );
+            const auto values = sample_values<T>(count);
+            const auto bytes = message(values, encoding, big);
+
+            const uint8_t* ptr = bytes.data();
+            S obj = S::read(ptr, bytes.data() + bytes.size());
+            CHECK( ptr == bytes.data() + bytes.size() );
+            CHECK( obj.trailer == TRAILER );
+            REQUIRE( obj.values.size() == count );
+            for (size_t i = 0; i < count; ++i) {
+                CAPTURE( i );
+                CHECK( obj.values[i] == values[i] );
+            }
+        }
+    }
+}
+
+TEST_SUITE("E2E - Array Transforms") {
+
+    TEST_CASE("Delta32 - every tail after the 4-lane blocks") {
+        check_all_counts<Delta32, uint32_t>(Encoding::delta);
+    }
+
+    TEST_CASE("BigDelta32 - byte swap before the prefix sum") {
+        check_all_counts<BigDelta32, uint32_t>(Encoding::delta, true);
+    }
+
+    TEST_CASE("ZigzagDelta32 - signed differences") {
+        check_all_counts<ZigzagDelta32, int32_t>(Encoding::zigzag_delta);
+    }
+
+    TEST_CASE("Delta64 - every tail after the 2-lane blocks") {
+        check_all_counts<Delta64, uint64_t>(Encoding::delta);
+    }
+
+    TEST_CASE("DeltaOfDelta64 - second differences") {
+        check_all_counts<DeltaOfDelta64, int64_t>(Encoding::delta_of_delta);
+    }
+
+    TEST_CASE("ZigzagDelta16 - scalar width") {
+        check_all_counts<ZigzagDelta16, int16_t>(Encoding::zigzag_delta);
+    }
+
+    TEST_CASE("FixedDelta32 - fixed array with a 3-element tail") {
+        const auto values = sample_values<uint32_t>(7);
+        const auto bytes = message(values, Encoding::delta, false, false);
+
+        const uint8_t* ptr = bytes.data();
+        FixedDelta32 obj = FixedDelta32::read(ptr, bytes.data() + bytes.size());
+        CHECK( ptr == bytes.data() + bytes.size() );
+        CHECK( obj.trailer == TRAILER );
+        for (size_t i = 0; i < 7; ++i) {
+            CAPTURE( i );
+            CHECK( obj.values[i] == values[i] );
+        }
+    }
+
+    TEST_CASE("Delta32 - a truncated tail throws") {
+        auto bytes = message(sample_values<uint32_t>(6), Encoding::delta);
+        bytes.resize(bytes.size() - 3);  // Drop the trailer and part of the last value
+
+        const uint8_t* ptr = bytes.data();
+        CHECK_THROWS_AS( Delta32::read(ptr, bytes.data() + bytes.size()), std::runtime_error );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Synthesized records of every transform") {
+        CHECK( synth_records::read_all<Delta32>(synth_records::load("e2e_array_transforms", "Delta32")) == synth_records::count );
+        CHECK( synth_records::read_all<BigDelta32>(synth_records::load("e2e_array_transforms", "BigDelta32")) == synth_records::count );
+        CHECK( synth_records::read_all<ZigzagDelta32>(synth_records::load("e2e_array_transforms", "ZigzagDelta32")) == synth_records::count );
+        CHECK( synth_records::read_all<Delta64>(synth_records::load("e2e_array_transforms", "Delta64")) == synth_records::count );
+        CHECK( synth_records::read_all<DeltaOfDelta64>(synth_records::load("e2e_array_transforms", "DeltaOfDelta64")) == synth_records::count );
+        CHECK( synth_records::read_all<ZigzagDelta16>(synth_records::load("e2e_array_transforms", "ZigzagDelta16")) == synth_records::count );
+        CHECK( synth_records::read_all<FixedDelta32>(synth_records::load("e2e_array_transforms", "FixedDelta32")) == synth_records::count );
+    }
+#endif
+}
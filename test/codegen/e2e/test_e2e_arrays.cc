@@ -4,6 +4,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_arrays.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -129,4 +132,11 @@ TEST_SUITE("E2E - Arrays") {
         CHECK(obj.get(1, 1) == 5);
         CHECK(obj.get(2, 2) == 9);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("PointArray - synthesized records") {
+        auto bytes = synth_records::load("e2e_arrays", "PointArray");
+        CHECK(synth_records::read_all<PointArray>(bytes) == synth_records::count);
+    }
+#endif
 }
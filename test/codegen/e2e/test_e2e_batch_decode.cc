@@ -0,0 +1,111 @@
+//
+// End-to-End Test: Batched Decoding of Independent Messages
+// Decodes scattered message buffers with read_batch() (--cpp-batch-decode=true)
+// into reused objects, across several prefetch groups
+//
+#include <doctest/doctest.h>
+#include <e2e_batch_decode.h>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace e2e_batch_decode;
+
+namespace {
+
+    // Order `id` with id % 4 lines, a discount when `discounted`, and `tail` trailer bytes
+    std::vector<uint8_t> order_bytes(uint32_t id, bool discounted, uint8_t tail = 2) {
+        std::vector<uint8_t> bytes = {
+            0x52, 0x44, 0x52, 0x4F,                            // magic "RDRO" (0x4F524452)
+            static_cast<uint8_t>(id), 0x00, 0x00, 0x00,        // id
+            'n', static_cast<uint8_t>('0' + id % 10), 0x00,    // note
+        };
+        const uint8_t count = static_cast<uint8_t>(id % 4);
+        bytes.push_back(count);
+        for (uint8_t i = 0; i < count; ++i) {
+            bytes.insert(bytes.end(), {'s', 'k', 'u', static_cast<uint8_t>('a' + i), 0x00});  // sku
+            bytes.insert(bytes.end(), {static_cast<uint8_t>(i + 1), 0x00});                   // quantity
+        }
+        bytes.push_back(discounted ? 0x01 : 0x00);  // flags
+        if (discounted) {
+            bytes.insert(bytes.end(), {0x0A, 0x00, 0x00, 0x00});  // discount = 10
+        }
+        for (uint8_t i = 0; i < tail; ++i) {
+            bytes.push_back(static_cast<uint8_t>(0xF0 + i));
+        }
+        return bytes;
+    }
+
+    std::vector<std::span<const uint8_t>> spans_of(const std::vector<std::vector<uint8_t>>& messages) {
+        return {messages.begin(), messages.end()};
+    }
+}
+
+TEST_SUITE("E2E - Batch Decoding") {
+
+    TEST_CASE("Order - every message of a multi-group batch decodes") {
+        // Each message in its own allocation, as a gateway would receive them
+        std::vector<std::vector<uint8_t>> messages;
+        for (uint32_t id = 0; id < 21; ++id) {
+            messages.push_back(order_bytes(id, id % 2 == 0));
+        }
+        auto inputs = spans_of(messages);
+        std::vector<Order> orders(inputs.size());
+        std::vector<BatchStatus> status(inputs.size(), BatchStatus::not_decoded);
+
+        CHECK( Order::read_batch(inputs, orders, status) == 21 );
+        for (uint32_t id = 0; id < 21; ++id) {
+            const Order& order = orders[id];
+            CHECK( status[id] == BatchStatus::ok );
+            CHECK( order.id == id );
+            CHECK( order.note == "n" + std::to_string(id % 10) );
+            REQUIRE( order.lines.size() == id % 4 );
+            for (size_t i = 0; i < order.lines.size(); ++i) {
+                CHECK( order.lines[i].sku == std::string("sku") + static_cast<char>('a' + i) );
+                CHECK( order.lines[i].quantity == i + 1 );
+            }
+            CHECK( order.has_discount() == (id % 2 == 0) );
+            CHECK( order.discount == (id % 2 == 0 ? 10u : 0u) );
+            CHECK( (order.trailer == std::vector<uint8_t>{0xF0, 0xF1}) );
+        }
+    }
+
+    TEST_CASE("Order - reused objects drop what the previous message set") {
+        std::vector<std::vector<uint8_t>> first = {order_bytes(3, true, 5)};
+        std::vector<std::vector<uint8_t>> second = {order_bytes(1, false, 1)};
+        std::vector<Order> orders(1);
+
+        REQUIRE( Order::read_batch(spans_of(first), orders) == 1 );
+        CHECK( orders[0].lines.size() == 3 );
+        CHECK( orders[0].discount == 10 );
+
+        REQUIRE( Order::read_batch(spans_of(second), orders) == 1 );
+        CHECK( orders[0].id == 1 );
+        CHECK( orders[0].lines.size() == 1 );
+        CHECK_FALSE( orders[0].has_discount() );
+        CHECK( orders[0].discount == 0 );
+        CHECK( (orders[0].trailer == std::vector<uint8_t>{0xF0}) );
+    }
+
+    TEST_CASE("Order - failures are reported per message without throwing") {
+        auto bad_magic = order_bytes(2, false);
+        bad_magic[0] = 0x00;
+        auto truncated = order_bytes(5, true, 0);
+        truncated.resize(truncated.size() - 2);   // Inside the discount
+
+        std::vector<std::vector<uint8_t>> messages = {
+            order_bytes(0, false), bad_magic, truncated, order_bytes(7, true), order_bytes(8, false)
+        };
+        auto inputs = spans_of(messages);
+        std::vector<Order> orders(4);               // No slot for the last message
+        std::vector<BatchStatus> status(inputs.size(), BatchStatus::ok);
+
+        CHECK( Order::read_batch(inputs, orders, status) == 2 );
+        CHECK( status[0] == BatchStatus::ok );
+        CHECK( status[1] == BatchStatus::constraint_violation );
+        CHECK( status[2] == BatchStatus::decode_error );
+        CHECK( status[3] == BatchStatus::ok );
+        CHECK( status[4] == BatchStatus::not_decoded );
+        CHECK( orders[3].id == 7 );
+    }
+}
@@ -4,6 +4,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_bitfields.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -61,4 +64,11 @@ TEST_SUITE("E2E - Bit Fields") {
         CHECK(obj.get_type() == 3);
         CHECK(obj.is_compressed() == true);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("PackedData - synthesized records") {
+        auto bytes = synth_records::load("e2e_bitfields", "PackedData");
+        CHECK(synth_records::read_all<PackedData>(bytes) == synth_records::count);
+    }
+#endif
 }
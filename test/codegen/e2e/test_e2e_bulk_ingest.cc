@@ -0,0 +1,123 @@
+//
+// End-to-End Test: Bulk File Ingestion
+// Reads real files with bulk_ingest<T>() (--cpp-bulk-ingest=true) through
+// both backends: io_uring where the kernel allows it, and the pread() pool
+//
+#include <doctest/doctest.h>
+#include <e2e_bulk_ingest.h>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace e2e_bulk_ingest;
+
+namespace {
+
+    // Capture with the given id and a payload of `count` bytes (id + i)
+    std::vector<uint8_t> capture_bytes(uint32_t id, uint16_t count) {
+        std::vector<uint8_t> bytes = {
+            static_cast<uint8_t>(id), static_cast<uint8_t>(id >> 8), 0x00, 0x00,  // id
+            static_cast<uint8_t>(count), static_cast<uint8_t>(count >> 8)         // count
+        };
+        for (uint16_t i = 0; i < count; ++i) {
+            bytes.push_back(static_cast<uint8_t>(id + i));
+        }
+        return bytes;
+    }
+
+    // Files removed again when the test ends
+    struct CaptureDir {
+        std::filesystem::path dir;
+
+        CaptureDir() {
+            dir = std::filesystem::temp_directory_path() /
+                  ("datascript_bulk_ingest_" + std::to_string(::getpid()));
+            std::filesystem::create_directories(dir);
+        }
+        ~CaptureDir() {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+
+        std::string write(const std::string& name, const std::vector<uint8_t>& bytes) {
+            auto path = dir / name;
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            return path.string();
+        }
+    };
+}
+
+TEST_SUITE("E2E - Bulk Ingest") {
+
+    TEST_CASE("Capture - every file is decoded once by either backend") {
+        CaptureDir captures;
+        std::vector<std::string> paths;
+        for (uint32_t id = 0; id < 40; ++id) {
+            // Every tenth file is larger than a buffer and is read on its own
+            const uint16_t count = id % 10 == 9 ? 300 : static_cast<uint16_t>(id % 7);
+            paths.push_back(captures.write("capture_" + std::to_string(id) + ".bin", capture_bytes(id, count)));
+        }
+
+        for (bool uring : {true, false}) {
+            BulkIngestOptions options;
+            options.queue_depth = 4;
+            options.buffer_size = 256;
+            options.workers = 3;
+            options.use_io_uring = uring;
+
+            std::mutex mutex;
+            std::vector<int> seen(paths.size(), 0);
+            bool payloads_match = true;
+            BulkIngestStats stats = bulk_ingest<Capture>(paths, [&](size_t index, Capture&& capture) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[index] += capture.id == index ? 1 : 100;
+                for (size_t i = 0; i < capture.payload.size(); ++i) {
+                    payloads_match &= capture.payload[i] == static_cast<uint8_t>(capture.id + i);
+                }
+            }, options);
+
+            CHECK( stats.files == paths.size() );
+            CHECK( stats.io_errors == 0 );
+            CHECK( stats.parse_errors == 0 );
+            CHECK( payloads_match );
+            for (size_t i = 0; i < seen.size(); ++i) {
+                CHECK( seen[i] == 1 );
+            }
+            if (!uring) {
+                CHECK_FALSE( stats.used_io_uring );
+            }
+        }
+    }
+
+    TEST_CASE("Capture - missing and truncated files are counted, not thrown") {
+        CaptureDir captures;
+        auto truncated = capture_bytes(1, 8);
+        truncated.resize(truncated.size() - 3);
+        std::vector<std::string> paths = {
+            captures.write("good.bin", capture_bytes(0, 2)),
+            (captures.dir / "missing.bin").string(),
+            captures.write("truncated.bin", truncated)
+        };
+
+        for (bool uring : {true, false}) {
+            BulkIngestOptions options;
+            options.use_io_uring = uring;
+
+            std::mutex mutex;
+            std::vector<size_t> decoded;
+            BulkIngestStats stats = bulk_ingest<Capture>(paths, [&](size_t index, Capture&&) {
+                std::lock_guard<std::mutex> lock(mutex);
+                decoded.push_back(index);
+            }, options);
+
+            CHECK( stats.io_errors == 1 );
+            CHECK( stats.parse_errors == 1 );
+            REQUIRE( decoded.size() == 1 );
+            CHECK( decoded[0] == 0 );
+        }
+    }
+}
@@ -3,6 +3,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_choices.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -46,4 +49,11 @@ TEST_SUITE("E2E - Choices") {
 
         CHECK(obj.packet_type == PACKET_REQUEST);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Message - synthesized records") {
+        auto bytes = synth_records::load("e2e_choices", "Message");
+        CHECK(synth_records::read_all<Message>(bytes) == synth_records::count);
+    }
+#endif
 }
@@ -0,0 +1,250 @@
+//
+// End-to-End Test: Runtime CPU Feature Dispatch
+// Selects kernels with DATASCRIPT_FORCE_ISA, decodes a real buffer through
+// them (--cpp-cpu-dispatch=true), and checks every level the host supports
+// against the scalar kernels
+//
+#include <doctest/doctest.h>
+#include <e2e_cpu_dispatch.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace e2e_cpu_dispatch;
+
+namespace {
+
+    void force_isa(const char* name) {
+    #ifdef _WIN32
+        _putenv_s("DATASCRIPT_FORCE_ISA", name);
+    #else
+        setenv("DATASCRIPT_FORCE_ISA", name, 1);
+    #endif
+    }
+
+    template<typename T>
+    void put_be(std::vector<uint8_t>& out, T value, size_t width = sizeof(T)) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        for (size_t i = 0; i < width; ++i) {
+            out.push_back(static_cast<uint8_t>(bits >> (8 * (width - 1 - i))));
+        }
+    }
+
+    std::vector<uint8_t> sample_bytes(const std::vector<float>& levels, const std::string& name,
+                                      const std::string& title, const std::string& tag,
+                                      uint32_t code, const std::string& label, uint8_t key,
+                                      const std::vector<uint64_t>& stamps) {
+        std::vector<uint8_t> bytes;
+        bytes.push_back(static_cast<uint8_t>(levels.size()));
+        for (float level : levels) {
+            put_be(bytes, level);
+        }
+        bytes.insert(bytes.end(), name.begin(), name.end());
+        bytes.push_back(0);
+        for (char c : title + '\0') {
+            bytes.push_back(static_cast<uint8_t>(c));
+            bytes.push_back(0);
+        }
+        for (char c : tag + '\0') {
+            put_be(bytes, static_cast<uint32_t>(static_cast<uint8_t>(c)));
+        }
+
+        std::vector<uint8_t> sealed;
+        for (size_t i = 0; i < 4; ++i) {
+            sealed.push_back(static_cast<uint8_t>(code >> (8 * i)));
+        }
+        sealed.insert(sealed.end(), label.begin(), label.end());
+        sealed.push_back(0);
+        bytes.push_back(static_cast<uint8_t>(sealed.size()));
+        bytes.push_back(static_cast<uint8_t>(sealed.size() >> 8));
+        bytes.push_back(key);
+        for (uint8_t b : sealed) {
+            bytes.push_back(b ^ key);
+        }
+
+        for (uint64_t stamp : stamps) {
+            put_be(bytes, stamp);
+        }
+        return bytes;
+    }
+
+    // Every level up to what the host supports
+    std::vector<cpu::Isa> supported_levels() {
+        std::vector<cpu::Isa> levels;
+        for (cpu::Isa isa : {cpu::Isa::Scalar, cpu::Isa::Sse2, cpu::Isa::Sse42, cpu::Isa::Avx2, cpu::Isa::Avx512}) {
+            if (isa <= cpu::detect_isa()) {
+                levels.push_back(isa);
+            }
+        }
+        return levels;
+    }
+}
+
+TEST_SUITE("E2E - CPU Dispatch") {
+
+    // The only test that reaches cpu::active_isa(): the level is fixed on
+    // first use, so the override has to be in place before the first read
+    TEST_CASE("Sample - DATASCRIPT_FORCE_ISA selects the kernels readers use") {
+        force_isa("sse2");
+        const cpu::Isa expected = std::min(cpu::Isa::Sse2, cpu::detect_isa());
+        CHECK( cpu::active_isa() == expected );
+        CHECK( cpu::kernels().isa == expected );
+
+        // Long enough for the vector loops to run before their scalar tails
+        const std::vector<float> levels = {1.5f, -2.0f, 0.25f, 1024.0f, -0.125f};
+        const std::string name = "a name long enough to cover several 16-byte blocks";
+        const std::string title = "a title that also spans more than one vector block";
+        const std::string tag = "tag of thirty-two bytes, or more";
+        const std::string label = "sealed label behind the xor transform";
+        std::vector<uint64_t> stamps;
+        for (uint64_t i = 0; i < 11; ++i) {
+            stamps.push_back(0x0102030405060708ull * (i + 1));
+        }
+
+        auto bytes = sample_bytes(levels, name, title, tag, 0xC0DE1234u, label, 0x5A, stamps);
+        const uint8_t* ptr = bytes.data();
+        Sample obj = Sample::read(ptr, ptr + bytes.size());
+
+        CHECK( obj.levels == levels );
+        CHECK( obj.name == name );
+        CHECK( obj.title == title );
+        CHECK( obj.tag == tag );
+        CHECK( obj.sealed->code == 0xC0DE1234u );
+        CHECK( obj.sealed->label == label );
+        CHECK( obj.stamps == stamps );
+        CHECK( ptr == bytes.data() + bytes.size() );
+
+        // Still fixed after a later change to the environment
+        force_isa("scalar");
+        CHECK( cpu::active_isa() == expected );
+    }
+
+    TEST_CASE("Isa names round-trip and unknown names fall back") {
+        for (cpu::Isa isa : {cpu::Isa::Scalar, cpu::Isa::Sse2, cpu::Isa::Sse42, cpu::Isa::Avx2, cpu::Isa::Avx512}) {
+            CHECK( cpu::parse_isa(cpu::isa_name(isa), cpu::Isa::Scalar) == isa );
+        }
+        CHECK( cpu::parse_isa("neon", cpu::Isa::Avx2) == cpu::Isa::Avx2 );
+        CHECK( cpu::parse_isa("", cpu::Isa::Sse2) == cpu::Isa::Sse2 );
+
+        // Requests above the host are lowered to what it supports
+        CHECK( cpu::kernels_for(cpu::Isa::Avx512).isa == cpu::detect_isa() );
+    }
+
+    TEST_CASE("Kernels - every supported level matches the scalar kernels") {
+        const cpu::Kernels scalar = cpu::kernels_for(cpu::Isa::Scalar);
+        REQUIRE( scalar.isa == cpu::Isa::Scalar );
+
+        // Odd sizes and offsets put the vector bodies and tails at every alignment
+        std::vector<uint8_t> src(515);
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+
+        for (cpu::Isa isa : supported_levels()) {
+            CAPTURE( cpu::isa_name(isa) );
+            const cpu::Kernels k = cpu::kernels_for(isa);
+            CHECK( k.isa == isa );
+
+            for (size_t offset : {size_t(0), size_t(1), size_t(3)}) {
+                for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(31), size_t(63)}) {
+                    const uint8_t* in = src.data() + offset;
+                    std::vector<uint8_t> want(8 * count), got(8 * count);
+                    scalar.byteswap16(want.data(), in, count);
+                    k.byteswap16(got.data(), in, count);
+                    CHECK( got == want );
+                    scalar.byteswap32(want.data(), in, count);
+                    k.byteswap32(got.data(), in, count);
+                    CHECK( got == want );
+                    scalar.byteswap64(want.data(), in, count);
+                    k.byteswap64(got.data(), in, count);
+                    CHECK( got == want );
+
+                    std::vector<uint8_t> xored(in, in + 8 * count), rotated(xored);
+                    std::vector<uint8_t> xored_want(xored), rotated_want(xored);
+                    scalar.xor_bytes(xored_want.data(), xored_want.size(), 0xA5);
+                    k.xor_bytes(xored.data(), xored.size(), 0xA5);
+                    CHECK( xored == xored_want );
+                    scalar.rotl_bytes(rotated_want.data(), rotated_want.size(), 3);
+                    k.rotl_bytes(rotated.data(), rotated.size(), 3);
+                    CHECK( rotated == rotated_want );
+
+                    // Every delta mode, split in two calls so the sums carry across
+                    for (unsigned mode = 0; mode < 8; ++mode) {
+                        CAPTURE( mode );
+                        const size_t head = count / 3;
+                        uint32_t value32 = 7, delta32 = 3, want_value32 = 7, want_delta32 = 3;
+                        scalar.delta32(in, want.data(), head, mode, want_value32, want_delta32);
+                        scalar.delta32(in + 4 * head, want.data() + 4 * head, count - head, mode, want_value32, want_delta32);
+                        k.delta32(in, got.data(), head, mode, value32, delta32);
+                        k.delta32(in + 4 * head, got.data() + 4 * head, count - head, mode, value32, delta32);
+                        CHECK( std::equal(got.begin(), got.begin() + 4 * count, want.begin()) );
+                        CHECK( value32 == want_value32 );
+                        CHECK( delta32 == want_delta32 );
+
+                        uint64_t value64 = 7, delta64 = 3, want_value64 = 7, want_delta64 = 3;
+                        scalar.delta64(in, want.data(), head, mode, want_value64, want_delta64);
+                        scalar.delta64(in + 8 * head, want.data() + 8 * head, count - head, mode, want_value64, want_delta64);
+                        k.delta64(in, got.data(), head, mode, value64, delta64);
+                        k.delta64(in + 8 * head, got.data() + 8 * head, count - head, mode, value64, delta64);
+                        CHECK( got == want );
+                        CHECK( value64 == want_value64 );
+                        CHECK( delta64 == want_delta64 );
+                    }
+                }
+            }
+
+            // Zero units at every position of a buffer, and none at all
+            for (size_t zero_at = 0; zero_at <= 200; zero_at += 4) {
+                std::vector<uint8_t> text(200, 0x41);
+                if (zero_at < text.size()) {
+                    std::fill(text.begin() + zero_at, text.begin() + std::min<size_t>(zero_at + 4, text.size()), 0);
+                }
+                const uint8_t* begin = text.data() + 1;
+                const uint8_t* end = text.data() + text.size();
+                CHECK( k.find_zero8(begin, end) == scalar.find_zero8(begin, end) );
+                CHECK( k.find_zero16(begin, end) == scalar.find_zero16(begin, end) );
+                CHECK( k.find_zero32(begin, end) == scalar.find_zero32(begin, end) );
+            }
+
+            // The vector kernels may stop early, but never past the scalar
+            // result, and what they write is the same
+            for (bool big : {false, true}) {
+                std::vector<uint8_t> units16, units32;
+                for (size_t i = 0; i < 90; ++i) {
+                    const uint32_t unit = i == 70 ? 0xE9u : 0x20u + i % 0x5F;
+                    for (size_t b = 0; b < 2; ++b) {
+                        units16.push_back(static_cast<uint8_t>(unit >> (8 * (big ? 1 - b : b))));
+                    }
+                    for (size_t b = 0; b < 4; ++b) {
+                        units32.push_back(static_cast<uint8_t>(unit >> (8 * (big ? 3 - b : b))));
+                    }
+                }
+                std::string want(90, '\0'), got(90, '\0');
+                const size_t want16 = scalar.ascii16(units16.data(), 90, want.data(), big);
+                const size_t got16 = k.ascii16(units16.data(), 90, got.data(), big);
+                CHECK( want16 == 70 );
+                CHECK( got16 <= want16 );
+                CHECK( got.compare(0, got16, want, 0, got16) == 0 );
+
+                const size_t want32 = scalar.ascii32(units32.data(), 90, want.data(), big);
+                const size_t got32 = k.ascii32(units32.data(), 90, got.data(), big);
+                CHECK( want32 == 70 );
+                CHECK( got32 <= want32 );
+                CHECK( got.compare(0, got32, want, 0, got32) == 0 );
+            }
+        }
+    }
+
+    TEST_CASE("Kernels - the benchmark covers every supported level") {
+        auto results = cpu::benchmark_kernels(4096, 1);
+        REQUIRE( !results.empty() );
+        for (cpu::Isa isa : supported_levels()) {
+            CHECK( std::any_of(results.begin(), results.end(),
+                               [&](const cpu::KernelThroughput& r) { return r.isa == isa; }) );
+        }
+        CHECK( cpu::format_benchmark(results).find(cpu::isa_name(cpu::detect_isa())) != std::string::npos );
+    }
+}
@@ -0,0 +1,155 @@
+//
+// End-to-End Test: Content-Addressed Decode Cache
+// Decodes the same bytes twice with read_cached() (--cpp-decode-cache=true)
+// and checks that the second decode is a cache hit sharing the first object
+//
+#include <doctest/doctest.h>
+#include <e2e_decode_cache.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <string>
+#include <vector>
+
+using namespace e2e_decode_cache;
+
+namespace {
+
+    // Frame with `length` payload bytes starting at `seed`, and a tag
+    std::vector<uint8_t> frame_bytes(uint8_t kind, uint16_t length, uint8_t seed, const std::string& tag) {
+        std::vector<uint8_t> bytes = {
+            kind,
+            static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),  // length
+        };
+        for (uint16_t i = 0; i < length; ++i) {
+            bytes.push_back(static_cast<uint8_t>(seed + i));  // payload
+        }
+        bytes.insert(bytes.end(), tag.begin(), tag.end());
+        bytes.push_back(0x00);  // tag terminator
+        return bytes;
+    }
+
+    template<typename T>
+    void reset_cache() {
+        T::decode_cache().clear();
+        T::decode_cache().reset_stats();
+    }
+}
+
+TEST_SUITE("E2E - Decode Cache") {
+
+    TEST_CASE("Point - decoding the same bytes twice hits the cache") {
+        reset_cache<Point>();
+        const std::vector<uint8_t> data = {
+            0x34, 0x12,              // x = 0x1234
+            0x78, 0x56, 0x34, 0x12,  // y = 0x12345678
+        };
+
+        const uint8_t* ptr = data.data();
+        auto first = Point::read_cached(ptr, data.data() + data.size());
+        CHECK( ptr == data.data() + data.size() );
+        CHECK( Point::decode_cache().misses() == 1 );
+        CHECK( Point::decode_cache().hits() == 0 );
+
+        ptr = data.data();
+        auto second = Point::read_cached(ptr, data.data() + data.size());
+        CHECK( ptr == data.data() + data.size() );
+        CHECK( Point::decode_cache().misses() == 1 );
+        CHECK( Point::decode_cache().hits() == 1 );
+
+        // The hit shares the object decoded on the miss
+        CHECK( second == first );
+        CHECK( second->x == 0x1234 );
+        CHECK( second->y == 0x12345678 );
+    }
+
+    TEST_CASE("Point - equal bytes in a different buffer hit, different bytes miss") {
+        reset_cache<Point>();
+        const std::vector<uint8_t> a = {0x01, 0x00, 0x02, 0x00, 0x00, 0x00};
+        const std::vector<uint8_t> b = a;
+        const std::vector<uint8_t> c = {0x01, 0x00, 0x03, 0x00, 0x00, 0x00};
+
+        const uint8_t* ptr = a.data();
+        auto from_a = Point::read_cached(ptr, a.data() + a.size());
+        ptr = b.data();
+        auto from_b = Point::read_cached(ptr, b.data() + b.size());
+        ptr = c.data();
+        auto from_c = Point::read_cached(ptr, c.data() + c.size());
+
+        CHECK( from_b == from_a );
+        CHECK( from_c != from_a );
+        CHECK( from_c->y == 3 );
+        CHECK( Point::decode_cache().hits() == 1 );
+        CHECK( Point::decode_cache().misses() == 2 );
+        CHECK( Point::decode_cache().size() == 2 );
+    }
+
+    TEST_CASE("Point - truncated input still throws") {
+        reset_cache<Point>();
+        const std::vector<uint8_t> data = {0x01, 0x00, 0x02};
+        const uint8_t* ptr = data.data();
+        CHECK_THROWS_AS( Point::read_cached(ptr, data.data() + data.size()), std::runtime_error );
+        CHECK( Point::decode_cache().size() == 0 );
+    }
+
+    TEST_CASE("Frame - records inside a larger buffer hit on their own extent") {
+        reset_cache<Frame>();
+
+        // A, B, A back to back: the second A is followed by different bytes
+        // than the first, so only an extent-sized key can match it
+        std::vector<uint8_t> buffer;
+        const auto a = frame_bytes(1, 40, 0x10, "alpha");
+        const auto b = frame_bytes(2, 3, 0x80, "beta");
+        buffer.insert(buffer.end(), a.begin(), a.end());
+        buffer.insert(buffer.end(), b.begin(), b.end());
+        buffer.insert(buffer.end(), a.begin(), a.end());
+
+        const uint8_t* ptr = buffer.data();
+        const uint8_t* end = buffer.data() + buffer.size();
+        auto first = Frame::read_cached(ptr, end);
+        CHECK( ptr == buffer.data() + a.size() );
+        auto middle = Frame::read_cached(ptr, end);
+        CHECK( ptr == buffer.data() + a.size() + b.size() );
+        auto last = Frame::read_cached(ptr, end);
+        CHECK( ptr == end );
+
+        CHECK( Frame::decode_cache().misses() == 2 );
+        CHECK( Frame::decode_cache().hits() == 1 );
+        CHECK( last == first );
+        CHECK( middle != first );
+
+        CHECK( first->kind == 1 );
+        CHECK( first->length == 40 );
+        REQUIRE( first->payload.size() == 40 );
+        CHECK( first->payload[39] == 0x10 + 39 );
+        CHECK( first->tag == "alpha" );
+        CHECK( middle->kind == 2 );
+        CHECK( middle->tag == "beta" );
+    }
+
+    TEST_CASE("Frame - a cached result matches a plain read()") {
+        reset_cache<Frame>();
+        const auto data = frame_bytes(7, 5, 0x41, "tag");
+
+        const uint8_t* ptr = data.data();
+        Frame plain = Frame::read(ptr, data.data() + data.size());
+        for (int round = 0; round < 2; ++round) {
+            ptr = data.data();
+            auto cached = Frame::read_cached(ptr, data.data() + data.size());
+            CHECK( ptr == data.data() + data.size() );
+            CHECK( cached->kind == plain.kind );
+            CHECK( cached->length == plain.length );
+            CHECK( cached->payload == plain.payload );
+            CHECK( cached->tag == plain.tag );
+        }
+        CHECK( Frame::decode_cache().hits() == 1 );
+        CHECK( Frame::decode_cache().misses() == 1 );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Frame - synthesized records") {
+        auto bytes = synth_records::load("e2e_decode_cache", "Frame");
+        CHECK( synth_records::read_all<Frame>(bytes) == synth_records::count );
+    }
+#endif
+}
@@ -3,6 +3,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_endianness.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -55,4 +58,11 @@ TEST_SUITE("E2E - Endianness") {
         CHECK(obj.le_dword == 0x12345678);
         CHECK(obj.be_dword == 0x12345678);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("MixedEndianData - synthesized records") {
+        auto bytes = synth_records::load("e2e_endianness", "MixedEndianData");
+        CHECK(synth_records::read_all<MixedEndianData>(bytes) == synth_records::count);
+    }
+#endif
 }
@@ -81,4 +81,29 @@ TEST_SUITE("E2E - Function Calls") {
         CHECK(obj.double_payload() == 0);
         CHECK(obj.add_value(100) == 100);
     }
+
+    TEST_CASE("GuardedRatio - guarded function is not evaluated without its guard") {
+        // parts = 0: share() would divide by zero, but every use is guarded
+        std::vector<uint8_t> empty = {0x00};
+        const uint8_t* ptr = empty.data();
+        GuardedRatio none = GuardedRatio::read(ptr, ptr + empty.size());
+
+        CHECK(none.parts == 0);
+        CHECK(none.spread.empty());
+        CHECK(ptr == empty.data() + empty.size());
+
+        // parts = 4: share() = 3 sizes spread and admits bonus
+        std::vector<uint8_t> data = {
+            0x04,              // parts = 4
+            0x0A, 0x0B, 0x0C,  // spread[3]
+            0x07               // bonus
+        };
+        ptr = data.data();
+        GuardedRatio obj = GuardedRatio::read(ptr, ptr + data.size());
+
+        CHECK(obj.share() == 3);
+        REQUIRE(obj.spread.size() == 3);
+        CHECK(obj.spread[2] == 0x0C);
+        CHECK(obj.bonus == 7);
+    }
 }
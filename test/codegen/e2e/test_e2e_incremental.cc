@@ -0,0 +1,151 @@
+//
+// End-to-End Test: Incremental Re-Decoding
+// Edits a buffer in place and re-decodes it with IncrementalDecoder<T>
+// (--cpp-incremental=true); every update must equal a full decode of the
+// edited bytes
+//
+#include <doctest/doctest.h>
+#include <e2e_incremental.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <string>
+#include <vector>
+
+using namespace e2e_incremental;
+
+namespace {
+
+    constexpr uint16_t ENTRY_COUNT = 10;
+
+    // Offset of entry i's key; every value is "v<digit>", so entries are 11 bytes
+    size_t key_offset(size_t i) {
+        return 2 + i * 11;
+    }
+
+    std::vector<uint8_t> catalog_bytes() {
+        std::vector<uint8_t> bytes = {static_cast<uint8_t>(ENTRY_COUNT), 0x00};  // count
+        for (uint16_t i = 0; i < ENTRY_COUNT; ++i) {
+            bytes.insert(bytes.end(), {static_cast<uint8_t>(i), 0x00, 0x00, 0x00});  // key
+            bytes.insert(bytes.end(), {static_cast<uint8_t>(i * 2), 0x00});           // pos.x
+            bytes.insert(bytes.end(), {static_cast<uint8_t>(i * 3), 0x00});           // pos.y
+            bytes.insert(bytes.end(), {'v', static_cast<uint8_t>('0' + i), 0x00});    // value
+        }
+        bytes.insert(bytes.end(), {'c', 'a', 't', 0x00});  // title
+        return bytes;
+    }
+
+    Catalog full_decode(const std::vector<uint8_t>& bytes) {
+        const uint8_t* ptr = bytes.data();
+        return Catalog::read(ptr, bytes.data() + bytes.size());
+    }
+
+    void check_equal(const Catalog& actual, const Catalog& expected) {
+        CHECK( actual.count == expected.count );
+        REQUIRE( actual.entries.size() == expected.entries.size() );
+        for (size_t i = 0; i < expected.entries.size(); ++i) {
+            CAPTURE( i );
+            CHECK( actual.entries[i].key == expected.entries[i].key );
+            CHECK( actual.entries[i].pos.x == expected.entries[i].pos.x );
+            CHECK( actual.entries[i].pos.y == expected.entries[i].pos.y );
+            CHECK( actual.entries[i].value == expected.entries[i].value );
+        }
+        CHECK( actual.title == expected.title );
+    }
+}
+
+TEST_SUITE("E2E - Incremental Decoding") {
+
+    TEST_CASE("Catalog - first decode matches read()") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+
+        check_equal(decoder.decode(bytes.data(), bytes.size()), full_decode(bytes));
+        CHECK( decoder.stats().nodes_reused == 0 );
+    }
+
+    TEST_CASE("Catalog - editing one key re-decodes only that entry and the root") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+        decoder.decode(bytes.data(), bytes.size());
+
+        const size_t edit = key_offset(5);
+        bytes[edit] = 0x7F;
+        const Catalog& updated = decoder.update(bytes.data(), bytes.size(), edit, edit + 1);
+
+        CHECK( updated.entries[5].key == 0x7F );
+        check_equal(updated, full_decode(bytes));
+
+        // Entry 5 and its ancestor Catalog are decoded again; the nine other
+        // entries and entry 5's Point are reused
+        CHECK( decoder.stats().nodes_decoded == 2 );
+        CHECK( decoder.stats().nodes_reused == ENTRY_COUNT );
+        CHECK( decoder.stats().bytes_reused > 0 );
+    }
+
+    TEST_CASE("Catalog - successive edits each match a full decode") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+        decoder.decode(bytes.data(), bytes.size());
+
+        for (size_t i = 0; i < ENTRY_COUNT; ++i) {
+            const size_t edit = key_offset(i) + 4;  // pos.x
+            bytes[edit] = static_cast<uint8_t>(0xF0 + i);
+            CAPTURE( i );
+            check_equal(decoder.update(bytes.data(), bytes.size(), edit, edit + 1), full_decode(bytes));
+        }
+        CHECK( decoder.value().entries[9].pos.x == 0xF9 );
+    }
+
+    TEST_CASE("Catalog - an edit that moves later entries re-decodes them") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+        decoder.decode(bytes.data(), bytes.size());
+
+        // Shorten entry 3's value to "v": the terminator moves one byte
+        // earlier, so every later entry starts one byte sooner
+        const size_t value = key_offset(3) + 8;
+        bytes[value + 1] = 0x00;
+        bytes[value + 2] = 'x';
+
+        const Catalog expected = full_decode(bytes);
+        check_equal(decoder.update(bytes.data(), bytes.size(), value + 1, value + 3), expected);
+        CHECK( decoder.value().entries[3].value == "v" );
+    }
+
+    TEST_CASE("Catalog - a failed update keeps the previous tree") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+        decoder.decode(bytes.data(), bytes.size());
+
+        // A count larger than the buffer cannot decode
+        bytes[0] = 0xFF;
+        CHECK_THROWS_AS( decoder.update(bytes.data(), bytes.size(), 0, 1), std::runtime_error );
+        CHECK( decoder.value().count == ENTRY_COUNT );
+
+        // The failed range is merged into the next update, which only
+        // names a different byte
+        bytes[0] = static_cast<uint8_t>(ENTRY_COUNT);
+        const size_t edit = key_offset(7);
+        bytes[edit] = 0x42;
+        check_equal(decoder.update(bytes.data(), bytes.size(), edit, edit + 1), full_decode(bytes));
+    }
+
+    TEST_CASE("Catalog - a buffer of a different size is decoded in full") {
+        std::vector<uint8_t> bytes = catalog_bytes();
+        IncrementalDecoder<Catalog> decoder;
+        decoder.decode(bytes.data(), bytes.size());
+
+        bytes.insert(bytes.end() - 1, 's');  // title "cats"
+        check_equal(decoder.update(bytes.data(), bytes.size(), 0, 0), full_decode(bytes));
+        CHECK( decoder.value().title == "cats" );
+        CHECK( decoder.stats().nodes_reused == 0 );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Catalog - synthesized records") {
+        auto bytes = synth_records::load("e2e_incremental", "Catalog");
+        CHECK( synth_records::read_all<Catalog>(bytes) == synth_records::count );
+    }
+#endif
+}
@@ -0,0 +1,144 @@
+//
+// End-to-End Test: Padded-Input Readers
+// Decodes complete messages from a PaddedBuffer (--cpp-padded-input=true),
+// then every truncation of them, with zero and with garbage padding; each
+// truncated read must throw
+//
+#include <doctest/doctest.h>
+#include <e2e_padded_input.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace e2e_padded_input;
+
+namespace {
+
+    void put_u16(std::vector<uint8_t>& bytes, uint16_t value) {
+        bytes.push_back(static_cast<uint8_t>(value));
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void put_u32(std::vector<uint8_t>& bytes, uint32_t value) {
+        put_u16(bytes, static_cast<uint16_t>(value));
+        put_u16(bytes, static_cast<uint16_t>(value >> 16));
+    }
+
+    void put_string(std::vector<uint8_t>& bytes, const std::string& text) {
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        bytes.push_back(0x00);
+    }
+
+    // Text body and a narrow number, or a value body and a wide number
+    std::vector<uint8_t> message_bytes(bool text) {
+        std::vector<uint8_t> bytes;
+        put_u32(bytes, 0x44415050);  // magic "PPAD"
+        bytes.push_back(text ? 1 : 2);
+        if (text) {
+            put_string(bytes, "hello");
+        } else {
+            put_u32(bytes, 0x89ABCDEF);
+            put_u32(bytes, 0x01234567);
+        }
+        put_u16(bytes, 0xFFF6);  // origin.x = -10
+        put_u16(bytes, 20);      // origin.y
+        put_u16(bytes, 5);       // count
+        for (uint32_t i = 0; i < 5; ++i) {
+            put_u32(bytes, 1000 * i);
+        }
+        put_string(bytes, "label");
+        if (text) {
+            bytes.push_back(7);       // narrow
+        } else {
+            put_u32(bytes, 70000);    // wide: first byte 0x70 fails the narrow constraint
+        }
+        put_u16(bytes, 0xBEEF);  // checksum
+        return bytes;
+    }
+
+    // The first `size` bytes of `bytes`, followed by `fill` padding
+    PaddedBuffer truncated(const std::vector<uint8_t>& bytes, size_t size, uint8_t fill) {
+        PaddedBuffer buffer(size);
+        if (size > 0) {
+            std::memcpy(buffer.data(), bytes.data(), size);
+        }
+        std::memset(buffer.data() + size, fill, input_padding);
+        return buffer;
+    }
+}
+
+TEST_SUITE("E2E - Padded Input") {
+
+    TEST_CASE("Message - complete inputs decode") {
+        const auto text = message_bytes(true);
+        Message a = Message::read(PaddedBuffer::copy_of(text.data(), text.size()));
+        CHECK( a.kind == 1 );
+        REQUIRE( a.body.as_text() != nullptr );
+        CHECK( a.body.as_text()->value == "hello" );
+        CHECK( a.origin.x == -10 );
+        CHECK( a.origin.y == 20 );
+        REQUIRE( a.samples.size() == 5 );
+        CHECK( a.samples[4] == 4000 );
+        CHECK( a.label == "label" );
+        REQUIRE( a.number.as_narrow() != nullptr );
+        CHECK( *a.number.as_narrow() == 7 );
+        CHECK( a.checksum == 0xBEEF );
+
+        const auto value = message_bytes(false);
+        Message b = Message::read(PaddedBuffer::copy_of(value.data(), value.size()));
+        REQUIRE( b.body.as_value() != nullptr );
+        CHECK( b.body.as_value()->value == 0x0123456789ABCDEFull );
+        REQUIRE( b.number.as_wide() != nullptr );
+        CHECK( *b.number.as_wide() == 70000 );
+        CHECK( b.checksum == 0xBEEF );
+    }
+
+    TEST_CASE("Message - garbage padding after a complete input is never read") {
+        for (bool text : {true, false}) {
+            CAPTURE( text );
+            const auto bytes = message_bytes(text);
+            Message m = Message::read(truncated(bytes, bytes.size(), 0xFF));
+            CHECK( m.checksum == 0xBEEF );
+            CHECK( m.label == "label" );
+        }
+    }
+
+    TEST_CASE("Message - every truncation throws") {
+        for (bool text : {true, false}) {
+            const auto bytes = message_bytes(text);
+            for (uint8_t fill : {uint8_t{0x00}, uint8_t{0xFF}}) {
+                for (size_t size = 0; size < bytes.size(); ++size) {
+                    CAPTURE( text );
+                    CAPTURE( static_cast<int>(fill) );
+                    CAPTURE( size );
+                    CHECK_THROWS_AS( Message::read(truncated(bytes, size, fill)), std::runtime_error );
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Message - raw pointers with caller-provided padding") {
+        auto bytes = message_bytes(false);
+        const size_t size = bytes.size();
+        bytes.resize(size + input_padding, 0x00);
+
+        const uint8_t* ptr = bytes.data();
+        Message m = Message::read(ptr, bytes.data() + size);
+        CHECK( ptr == bytes.data() + size );
+        REQUIRE( m.number.as_wide() != nullptr );
+        CHECK( *m.number.as_wide() == 70000 );
+
+        ptr = bytes.data();
+        CHECK_THROWS_AS( Message::read(ptr, bytes.data() + size - 1), std::runtime_error );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Message - synthesized records with caller-provided padding") {
+        auto bytes = synth_records::load("e2e_padded_input", "Message", input_padding);
+        CHECK( synth_records::read_all<Message>(bytes, bytes.size() - input_padding) == synth_records::count );
+    }
+#endif
+}
@@ -4,6 +4,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_primitives.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 #include <cstring>
 
@@ -224,4 +227,11 @@ TEST_SUITE("E2E - Primitive Types") {
         CHECK(obj.utf32_be_text == U"IJ");
         CHECK(obj.utf32_default == U"KL");
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("AllPrimitives - synthesized records") {
+        auto bytes = synth_records::load("e2e_primitives", "AllPrimitives");
+        CHECK(synth_records::read_all<AllPrimitives>(bytes) == synth_records::count);
+    }
+#endif
 }
@@ -0,0 +1,122 @@
+//
+// End-to-End Test: Projected Readers and Record Boundaries
+// Decodes real buffers with read_projected() (--cpp-project=Reading=data,checksum)
+// and with the boundary scanner behind build_index() / read_at() (--cpp-record-index=Reading)
+// and read_all_parallel() (--cpp-parallel-decode=Reading)
+//
+#include <doctest/doctest.h>
+#include <e2e_projection.h>
+#include <vector>
+
+using namespace e2e_projection;
+
+namespace {
+
+    // Reading with data={0xAA, 0xBB, 0xCC}, the given flags and checksum=0xDEADBEEF
+    std::vector<uint8_t> reading_bytes(uint8_t flags, uint8_t id = 7) {
+        std::vector<uint8_t> bytes = {
+            id, 0x00, 0x00, 0x00,    // id
+            0x03, 0x00,              // size = 3
+            0xAA, 0xBB, 0xCC,        // data
+            flags                    // flags
+        };
+        if (flags != 0) {
+            bytes.insert(bytes.end(), {0x01, 0x02, 0x03, 0x04});  // extra
+        }
+        bytes.insert(bytes.end(), {'o', 'k', 0x00});  // note = "ok"
+        bytes.insert(bytes.end(), {0xEF, 0xBE, 0xAD, 0xDE});  // checksum
+        return bytes;
+    }
+
+    // Back-to-back readings with ids 0..count-1; every third has no extra field
+    std::vector<uint8_t> reading_stream(uint8_t count) {
+        std::vector<uint8_t> stream;
+        for (uint8_t id = 0; id < count; ++id) {
+            auto bytes = reading_bytes(id % 3 == 0 ? 0x00 : 0x01, id);
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+        }
+        return stream;
+    }
+
+}
+
+TEST_SUITE("E2E - Projected Readers") {
+
+    TEST_CASE("Reading - projected fields decode like read()") {
+        auto bytes = reading_bytes(0x01);
+        const uint8_t* ptr = bytes.data();
+        Reading obj = Reading::read_projected(ptr, ptr + bytes.size());
+
+        // size is not selected but sizes data, so it is decoded too
+        CHECK(obj.size == 3);
+        REQUIRE(obj.data.size() == 3);
+        CHECK(obj.data[0] == 0xAA);
+        CHECK(obj.data[2] == 0xCC);
+        CHECK(obj.checksum == 0xDEADBEEF);
+
+        // Unselected fields are skipped, but the reader still ends after the record
+        CHECK(obj.id == 0);
+        CHECK(obj.note.empty());
+        CHECK(ptr == bytes.data() + bytes.size());
+    }
+
+    TEST_CASE("Reading - skipped conditional field follows its condition") {
+        auto bytes = reading_bytes(0x00);
+        const uint8_t* ptr = bytes.data();
+        Reading obj = Reading::read_projected(ptr, ptr + bytes.size());
+
+        CHECK(obj.flags == 0);
+        CHECK(obj.checksum == 0xDEADBEEF);
+        CHECK(ptr == bytes.data() + bytes.size());
+    }
+
+    TEST_CASE("Reading - truncated input still underflows") {
+        auto bytes = reading_bytes(0x01);
+        bytes.resize(bytes.size() - 1);
+        const uint8_t* ptr = bytes.data();
+        CHECK_THROWS(Reading::read_projected(ptr, ptr + bytes.size()));
+    }
+
+    TEST_CASE("Reading - record index finds every record boundary") {
+        auto stream = reading_stream(10);
+        RecordIndex index = Reading::build_index(stream.data(), stream.size(), 4);
+
+        CHECK(index.count() == 10);
+        for (uint64_t n = 0; n < 10; ++n) {
+            Reading obj = Reading::read_at(index, stream.data(), stream.size(), n);
+            CHECK(obj.id == n);
+            CHECK(obj.size == 3);
+            CHECK(obj.has_extra() == (n % 3 != 0));
+            CHECK(obj.note == "ok");
+            CHECK(obj.checksum == 0xDEADBEEF);
+        }
+    }
+
+    TEST_CASE("Reading - parallel decoding returns every record in order") {
+        auto stream = reading_stream(200);
+
+        for (size_t workers : {size_t(1), size_t(4)}) {
+            std::vector<Reading> records = Reading::read_all_parallel(stream.data(), stream.size(), workers);
+
+            REQUIRE(records.size() == 200);
+            for (size_t n = 0; n < records.size(); ++n) {
+                CHECK(records[n].id == n);
+                CHECK(records[n].data.size() == 3);
+                CHECK(records[n].has_extra() == (n % 3 != 0));
+                CHECK(records[n].checksum == 0xDEADBEEF);
+            }
+        }
+    }
+
+    TEST_CASE("Reading - parallel decoding reports a truncated record") {
+        auto stream = reading_stream(50);
+        stream.pop_back();
+        CHECK_THROWS(Reading::read_all_parallel(stream.data(), stream.size(), 4));
+    }
+
+    TEST_CASE("Reading - truncated last record fails the index scan") {
+        auto stream = reading_stream(3);
+        stream.pop_back();
+        CHECK_THROWS(Reading::build_index(stream.data(), stream.size()));
+    }
+}
@@ -3,6 +3,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_real_world.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -179,4 +182,11 @@ TEST_SUITE("E2E - Real-World Formats") {
         CHECK(obj.info_header.get_height() == 100);
         CHECK(obj.info_header.is_uncompressed() == true);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("TLVMessage - synthesized records") {
+        auto bytes = synth_records::load("e2e_real_world", "TLVMessage");
+        CHECK(synth_records::read_all<TLVMessage>(bytes) == synth_records::count);
+    }
+#endif
 }
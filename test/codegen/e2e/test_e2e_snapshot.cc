@@ -0,0 +1,173 @@
+//
+// End-to-End Test: Relocatable Decoded-Object Snapshots
+// Decodes a Catalog, snapshots it with to_snapshot() (--cpp-snapshot=true),
+// moves the image to other addresses and a file, and compares every view
+// accessor against the decoded object
+//
+#include <doctest/doctest.h>
+#include <e2e_snapshot.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace e2e_snapshot;
+
+namespace {
+
+    void put_u16(std::vector<uint8_t>& bytes, uint16_t value) {
+        bytes.push_back(static_cast<uint8_t>(value));
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void put_u32(std::vector<uint8_t>& bytes, uint32_t value) {
+        put_u16(bytes, static_cast<uint16_t>(value));
+        put_u16(bytes, static_cast<uint16_t>(value >> 16));
+    }
+
+    void put_string(std::vector<uint8_t>& bytes, const std::string& text) {
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        bytes.push_back(0x00);
+    }
+
+    // Catalog with `count` symbols and three tags
+    std::vector<uint8_t> catalog_bytes(uint16_t count) {
+        std::vector<uint8_t> bytes;
+        put_u32(bytes, 0x50414E53);  // magic "SNAP"
+        put_u16(bytes, 10);          // origin.x
+        put_u16(bytes, 20);          // origin.y
+        bytes.push_back(1);          // version[0]
+        bytes.push_back(7);          // version[1]
+        put_u16(bytes, count);
+        for (uint16_t i = 0; i < count; ++i) {
+            put_u32(bytes, 0x1000u + i * 16u);   // address
+            bytes.push_back(i % 2 ? 2 : 1);      // kind
+            put_string(bytes, "sym_" + std::to_string(i));
+        }
+        for (uint16_t i = 0; i < count; ++i) {
+            put_u32(bytes, 0xA5A50000u | i);     // hashes
+        }
+        bytes.push_back(3);                      // tag_count
+        put_string(bytes, "core");
+        put_string(bytes, "");
+        put_string(bytes, "generated");
+        put_string(bytes, "reference catalog");  // note
+        return bytes;
+    }
+
+    Catalog decode(const std::vector<uint8_t>& bytes) {
+        const uint8_t* ptr = bytes.data();
+        Catalog catalog = Catalog::read(ptr, bytes.data() + bytes.size());
+        REQUIRE( ptr == bytes.data() + bytes.size() );
+        return catalog;
+    }
+
+    // Every accessor of the view agrees with the decoded object
+    void check_matches(const Catalog::SnapshotView& view, const Catalog& catalog) {
+        CHECK( view.magic() == catalog.magic );
+        CHECK( view.origin().x() == catalog.origin.x );
+        CHECK( view.origin().y() == catalog.origin.y );
+        REQUIRE( view.version().size() == 2 );
+        CHECK( view.version()[0] == catalog.version[0] );
+        CHECK( view.version()[1] == catalog.version[1] );
+        CHECK( view.count() == catalog.count );
+
+        REQUIRE( view.symbols().size() == catalog.symbols.size() );
+        for (size_t i = 0; i < catalog.symbols.size(); ++i) {
+            CHECK( view.symbols()[i].address() == catalog.symbols[i].address );
+            CHECK( view.symbols()[i].kind() == catalog.symbols[i].kind );
+            CHECK( view.symbols()[i].name() == catalog.symbols[i].name );
+        }
+        CHECK( view.hashes().to_vector() == catalog.hashes );
+
+        REQUIRE( view.tags().size() == catalog.tags.size() );
+        for (size_t i = 0; i < catalog.tags.size(); ++i) {
+            CHECK( view.tags()[i] == catalog.tags[i] );
+        }
+        CHECK( view.note() == catalog.note );
+    }
+}
+
+TEST_SUITE("E2E - Snapshots") {
+
+    TEST_CASE("Catalog - snapshot views match the decoded object") {
+        Catalog catalog = decode(catalog_bytes(5));
+        std::vector<uint8_t> image = catalog.to_snapshot();
+
+        check_matches(Catalog::open_snapshot(image.data(), image.size()), catalog);
+    }
+
+    TEST_CASE("Catalog - a relocated image reads the same at any address") {
+        Catalog catalog = decode(catalog_bytes(9));
+        const std::vector<uint8_t> image = catalog.to_snapshot();
+
+        // Copy to every offset within a word, including unaligned bases
+        for (size_t shift = 0; shift < 8; ++shift) {
+            std::vector<uint8_t> moved(image.size() + shift, 0xCC);
+            std::memcpy(moved.data() + shift, image.data(), image.size());
+
+            CAPTURE( shift );
+            check_matches(Catalog::open_snapshot(moved.data() + shift, image.size()), catalog);
+        }
+    }
+
+    TEST_CASE("Catalog - an image written to disk and mapped back compares equal") {
+        Catalog catalog = decode(catalog_bytes(64));
+        const std::vector<uint8_t> image = catalog.to_snapshot();
+
+        auto path = std::filesystem::temp_directory_path() /
+                    ("datascript_snapshot_" + std::to_string(::getpid()) + ".snap");
+        save_snapshot(path.string(), image);
+        {
+            SnapshotFile file(path.string());
+            REQUIRE( file.size() == image.size() );
+            CHECK( std::memcmp(file.data(), image.data(), image.size()) == 0 );
+            check_matches(Catalog::open_snapshot(file), catalog);
+        }
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    TEST_CASE("Catalog - the same object snapshots to the same bytes") {
+        Catalog catalog = decode(catalog_bytes(3));
+        Catalog again = decode(catalog_bytes(3));
+        CHECK( catalog.to_snapshot() == again.to_snapshot() );
+    }
+
+    TEST_CASE("Catalog - empty arrays and strings survive") {
+        Catalog catalog = decode(catalog_bytes(0));
+        std::vector<uint8_t> image = catalog.to_snapshot();
+        auto view = Catalog::open_snapshot(image.data(), image.size());
+
+        CHECK( view.symbols().empty() );
+        CHECK( view.hashes().empty() );
+        CHECK( view.tags()[1].empty() );
+        check_matches(view, catalog);
+    }
+
+    TEST_CASE("Catalog - damaged images are rejected") {
+        Catalog catalog = decode(catalog_bytes(2));
+        const std::vector<uint8_t> image = catalog.to_snapshot();
+
+        std::vector<uint8_t> bad_magic = image;
+        bad_magic[0] ^= 0xFF;
+        CHECK_THROWS_AS( Catalog::open_snapshot(bad_magic.data(), bad_magic.size()), SnapshotError );
+
+        std::vector<uint8_t> bad_layout = image;
+        bad_layout[16] ^= 0x01;  // layout hash
+        CHECK_THROWS_AS( Catalog::open_snapshot(bad_layout.data(), bad_layout.size()), SnapshotError );
+
+        CHECK_THROWS_AS( Catalog::open_snapshot(image.data(), image.size() - 1), SnapshotError );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Catalog - synthesized records") {
+        auto bytes = synth_records::load("e2e_snapshot", "Catalog");
+        CHECK( synth_records::read_all<Catalog>(bytes) == synth_records::count );
+    }
+#endif
+}
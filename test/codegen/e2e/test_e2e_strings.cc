@@ -4,6 +4,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_strings.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 #include <cstring>
 
@@ -138,4 +141,11 @@ TEST_SUITE("E2E - String Types") {
         CHECK(obj.second == "123.45");
         CHECK(obj.third == "@#$%");
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("MixedData - synthesized records") {
+        auto bytes = synth_records::load("e2e_strings", "MixedData");
+        CHECK(synth_records::read_all<MixedData>(bytes) == synth_records::count);
+    }
+#endif
 }
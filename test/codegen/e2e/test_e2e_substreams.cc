@@ -0,0 +1,140 @@
+//
+// End-to-End Test: Byte-Transform Substreams (xor, rotate)
+// Builds messages with the transforms applied, decodes them, and checks
+// that get() undoes each transform and parses the plain bytes
+//
+#include <doctest/doctest.h>
+#include <e2e_substreams.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
+#include <vector>
+
+using namespace e2e_substreams;
+
+namespace {
+
+    uint8_t rotl(uint8_t b, unsigned bits) {
+        return static_cast<uint8_t>((b << bits) | (b >> (8 - bits)));
+    }
+
+    uint8_t rotr(uint8_t b, unsigned bits) {
+        return static_cast<uint8_t>((b >> bits) | (b << (8 - bits)));
+    }
+
+    // Header with `count` ids, before the xor is applied
+    std::vector<uint8_t> header_bytes(uint8_t count) {
+        std::vector<uint8_t> bytes = {0x02, 0x01, count};  // version = 0x0102, count
+        for (uint8_t i = 0; i < count; ++i) {
+            bytes.insert(bytes.end(), {static_cast<uint8_t>(0x10 + i), static_cast<uint8_t>(i)});
+        }
+        return bytes;
+    }
+
+    std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < size; ++i) {
+            bytes.push_back(static_cast<uint8_t>(seed + i * 37));
+        }
+        return bytes;
+    }
+
+    // Container whose regions decode to `header`, `left` and `right`
+    std::vector<uint8_t> container_bytes(const std::vector<uint8_t>& header, uint8_t key,
+                                         const std::vector<uint8_t>& left, const std::vector<uint8_t>& right) {
+        std::vector<uint8_t> bytes = {
+            static_cast<uint8_t>(header.size()), static_cast<uint8_t>(header.size() >> 8),  // length
+            key,
+        };
+        for (uint8_t b : header) bytes.push_back(b ^ key);     // @xor(length, key)
+        for (uint8_t b : left) bytes.push_back(rotr(b, 3));    // @rol(16, 3) undoes a right rotation
+        for (uint8_t b : right) bytes.push_back(rotl(b, 5));   // @ror(19, 5) undoes a left rotation
+        bytes.push_back(0x5A);                                 // trailer
+        return bytes;
+    }
+}
+
+TEST_SUITE("E2E - Substreams") {
+
+    TEST_CASE("Container - every transform is undone on access") {
+        // 3 + 2 * 10 = 23 header bytes: one 16-byte block and a 7-byte tail
+        const auto header = header_bytes(10);
+        const auto left = pattern(16, 1);
+        const auto right = pattern(19, 200);
+        const auto data = container_bytes(header, 0xC3, left, right);
+
+        const uint8_t* ptr = data.data();
+        Container obj = Container::read(ptr, data.data() + data.size());
+        CHECK( ptr == data.data() + data.size() );
+        CHECK( obj.trailer == 0x5A );
+
+        // Regions are captured as stored and decoded lazily
+        CHECK_FALSE( obj.header.decoded() );
+        CHECK( obj.header.raw().size() == header.size() );
+        CHECK( obj.header.raw()[0] == (header[0] ^ 0xC3) );
+
+        CHECK( obj.header->version == 0x0102 );
+        REQUIRE( obj.header->ids.size() == 10 );
+        for (uint16_t i = 0; i < 10; ++i) {
+            CHECK( obj.header->ids[i] == ((i << 8) | (0x10 + i)) );
+        }
+        CHECK( obj.header.decoded() );
+
+        CHECK( obj.rotated_left.get() == left );
+        CHECK( obj.rotated_right.get() == right );
+    }
+
+    TEST_CASE("Container - every key and rotation round-trips") {
+        const auto header = header_bytes(20);
+        const auto left = pattern(16, 7);
+        const auto right = pattern(19, 9);
+        for (unsigned key = 0; key < 256; key += 17) {
+            CAPTURE( key );
+            const auto data = container_bytes(header, static_cast<uint8_t>(key), left, right);
+            const uint8_t* ptr = data.data();
+            Container obj = Container::read(ptr, data.data() + data.size());
+
+            REQUIRE( obj.header->ids.size() == 20 );
+            CHECK( obj.header->ids[19] == ((19 << 8) | (0x10 + 19)) );
+            CHECK( *obj.rotated_left == left );
+            CHECK( *obj.rotated_right == right );
+        }
+    }
+
+    TEST_CASE("Container - a region past the end of input throws") {
+        auto data = container_bytes(header_bytes(2), 0x11, pattern(16, 0), pattern(19, 0));
+        data.resize(data.size() - 10);  // Cut into the @ror region
+
+        const uint8_t* ptr = data.data();
+        CHECK_THROWS_AS( Container::read(ptr, data.data() + data.size()), std::runtime_error );
+    }
+
+    TEST_CASE("Container - a region too short for its struct throws on access") {
+        auto header = header_bytes(4);
+        header.pop_back();  // The last id no longer fits in the region
+        const auto data = container_bytes(header, 0x42, pattern(16, 0), pattern(19, 0));
+
+        const uint8_t* ptr = data.data();
+        Container obj = Container::read(ptr, data.data() + data.size());
+        CHECK( ptr == data.data() + data.size() );
+        CHECK_THROWS_AS( obj.header.get(), std::runtime_error );
+    }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Container - synthesized records, substreams included") {
+        auto bytes = synth_records::load("e2e_substreams", "Container");
+        CHECK( synth_records::read_all<Container>(bytes) == synth_records::count );
+
+        // read() only copies the regions; decode every header as well
+        const uint8_t* ptr = bytes.data();
+        const uint8_t* end = bytes.data() + bytes.size();
+        while (ptr < end) {
+            Container obj = Container::read(ptr, end);
+            const Header& header = obj.header.get();
+            CHECK( header.ids.size() == header.count );
+            CHECK( obj.rotated_left.get().size() == 16 );
+            CHECK( obj.rotated_right.get().size() == 19 );
+        }
+    }
+#endif
+}
@@ -0,0 +1,136 @@
+//
+// End-to-End Test: zlib Substreams
+// Compresses payloads with the system zlib, decodes the container, and
+// checks that get() inflates back to the original bytes, up to the 256 KiB
+// limit the schema is generated with (--cpp-substream-max-inflate=262144)
+//
+#include <doctest/doctest.h>
+#include <e2e_substreams_zlib.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+using namespace e2e_substreams_zlib;
+
+namespace {
+
+    std::vector<uint8_t> deflate_bytes(const std::vector<uint8_t>& plain) {
+        uLongf size = compressBound(static_cast<uLong>(plain.size()));
+        std::vector<uint8_t> packed(size);
+        REQUIRE( compress(packed.data(), &size, plain.data(), static_cast<uLong>(plain.size())) == Z_OK );
+        packed.resize(size);
+        return packed;
+    }
+
+    void put_u32(std::vector<uint8_t>& bytes, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    std::vector<uint8_t> record_bytes(uint32_t id, const std::string& name) {
+        std::vector<uint8_t> bytes;
+        put_u32(bytes, id);
+        bytes.insert(bytes.end(), name.begin(), name.end());
+        bytes.push_back(0x00);
+        return bytes;
+    }
+
+    // Archive with the given (already compressed) regions
+    std::vector<uint8_t> archive_bytes(const std::vector<uint8_t>& body, const std::vector<uint8_t>& record) {
+        std::vector<uint8_t> bytes;
+        put_u32(bytes, static_cast<uint32_t>(body.size()));
+        bytes.insert(bytes.end(), body.begin(), body.end());
+        put_u32(bytes, static_cast<uint32_t>(record.size()));
+        bytes.insert(bytes.end(), record.begin(), record.end());
+        bytes.push_back(0x7E);  // trailer
+        return bytes;
+    }
+
+    // Compressible but not trivially so
+    std::vector<uint8_t> body_plain(size_t size) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < size; ++i) {
+            bytes.push_back(static_cast<uint8_t>((i / 7) ^ (i % 13)));
+        }
+        return bytes;
+    }
+}
+
+TEST_SUITE("E2E - zlib Substreams") {
+
+    TEST_CASE("Archive - compressed regions inflate to the original bytes") {
+        // 100 KB inflates in several 16 KiB steps
+        const auto body = body_plain(100 * 1024);
+        const auto packed_body = deflate_bytes(body);
+        const auto packed_record = deflate_bytes(record_bytes(0xCAFE, "inflated"));
+        const auto data = archive_bytes(packed_body, packed_record);
+
+        const uint8_t* ptr = data.data();
+        Archive obj = Archive::read(ptr, data.data() + data.size());
+        CHECK( ptr == data.data() + data.size() );
+        CHECK( obj.trailer == 0x7E );
+
+        CHECK( obj.body.raw() == packed_body );
+        CHECK_FALSE( obj.body.decoded() );
+        CHECK( obj.body.get() == body );
+
+        CHECK( obj.record->id == 0xCAFE );
+        CHECK( obj.record->name == "inflated" );
+    }
+
+    TEST_CASE("Archive - empty and single-byte payloads round-trip") {
+        for (size_t size : {size_t{0}, size_t{1}, size_t{16384}, size_t{16385}}) {
+            CAPTURE( size );
+            const auto body = body_plain(size);
+            const auto data = archive_bytes(deflate_bytes(body), deflate_bytes(record_bytes(1, "")));
+
+            const uint8_t* ptr = data.data();
+            Archive obj = Archive::read(ptr, data.data() + data.size());
+            CHECK( obj.body.get() == body );
+            CHECK( obj.record->name.empty() );
+        }
+    }
+
+    TEST_CASE("Archive - streams inflating past the limit throw on access") {
+        const auto record = deflate_bytes(record_bytes(3, "bomb"));
+
+        // Exactly at the limit still inflates
+        const std::vector<uint8_t> at_limit(262144, 0x00);
+        auto data = archive_bytes(deflate_bytes(at_limit), record);
+        const uint8_t* ptr = data.data();
+        Archive full = Archive::read(ptr, data.data() + data.size());
+        CHECK( full.body.get() == at_limit );
+
+        // 16 MiB of zeros compress about a thousandfold
+        const auto bomb = deflate_bytes(std::vector<uint8_t>(16 << 20, 0x00));
+        CHECK( bomb.size() < 32 * 1024 );
+        for (const auto& packed : {deflate_bytes(std::vector<uint8_t>(262145, 0x00)), bomb}) {
+            data = archive_bytes(packed, record);
+            ptr = data.data();
+            Archive obj = Archive::read(ptr, data.data() + data.size());
+            CHECK_THROWS_WITH_AS( obj.body.get(), "zlib substream too large", std::runtime_error );
+            CHECK( obj.record->name == "bomb" );
+        }
+    }
+
+    TEST_CASE("Archive - corrupt and truncated streams throw on access") {
+        const auto body = body_plain(4096);
+        const auto record = deflate_bytes(record_bytes(2, "ok"));
+
+        auto corrupt = deflate_bytes(body);
+        corrupt[0] ^= 0xFF;  // zlib header
+        auto data = archive_bytes(corrupt, record);
+        const uint8_t* ptr = data.data();
+        Archive bad = Archive::read(ptr, data.data() + data.size());
+        CHECK_THROWS_AS( bad.body.get(), std::runtime_error );
+        CHECK( bad.record->name == "ok" );  // Other regions are unaffected
+
+        auto truncated = deflate_bytes(body);
+        truncated.resize(truncated.size() / 2);
+        data = archive_bytes(truncated, record);
+        ptr = data.data();
+        Archive cut = Archive::read(ptr, data.data() + data.size());
+        CHECK_THROWS_AS( cut.body.get(), std::runtime_error );
+    }
+}
@@ -3,6 +3,9 @@
 //
 #include <doctest/doctest.h>
 #include <e2e_subtypes.h>
+#ifdef SYNTH_DATA_DIR
+#include "synth_records.hh"
+#endif
 #include <vector>
 
 using namespace generated;
@@ -128,4 +131,11 @@ TEST_SUITE("E2E - Subtypes") {
         CHECK(validate_Percentage(101) == false);
         CHECK(validate_Percentage(255) == false);
     }
+
+#ifdef SYNTH_DATA_DIR
+    TEST_CASE("Server - synthesized records") {
+        auto bytes = synth_records::load("e2e_subtypes", "Server");
+        CHECK(synth_records::read_all<Server>(bytes) == synth_records::count);
+    }
+#endif
 }
@@ -0,0 +1,99 @@
+//
+// End-to-End Test: Wide Strings Decoded to UTF-8
+// Transcodes real UTF-16/UTF-32 buffers with the generated readers
+// (--cpp-utf8-strings=true), through the vector and the scalar paths
+//
+#include <doctest/doctest.h>
+#include <e2e_utf8_strings.h>
+#include <string>
+#include <vector>
+
+using namespace e2e_utf8_strings;
+
+namespace {
+
+    // Null-terminated code units in the given byte order
+    template<typename Units>
+    void append_units(std::vector<uint8_t>& out, const Units& text, bool big) {
+        constexpr size_t width = sizeof(typename Units::value_type);
+        auto put = [&](uint32_t unit) {
+            for (size_t i = 0; i < width; ++i) {
+                const size_t shift = 8 * (big ? width - 1 - i : i);
+                out.push_back(static_cast<uint8_t>(unit >> shift));
+            }
+        };
+        for (auto unit : text) {
+            put(static_cast<uint32_t>(unit));
+        }
+        put(0);
+    }
+
+    std::vector<uint8_t> names_bytes(const std::u16string& short_name, const std::u16string& title,
+                                     const std::u32string& long_name, const std::u32string& tag) {
+        std::vector<uint8_t> bytes;
+        append_units(bytes, short_name, false);
+        append_units(bytes, title, true);
+        append_units(bytes, long_name, false);
+        append_units(bytes, tag, true);
+        append_units(bytes, std::u16string(u"a"), false);
+        append_units(bytes, std::u16string(u"été"), false);
+        return bytes;
+    }
+}
+
+TEST_SUITE("E2E - UTF-8 Strings") {
+
+    TEST_CASE("Names - wide strings arrive as UTF-8 in both byte orders") {
+        // Long ASCII runs take the vector path; the rest falls back per unit
+        auto bytes = names_bytes(u"plain ascii name that spans several blocks",
+                                 u"héllo 日本 \U0001F600!",
+                                 U"café \U0001F680 and more ascii after the rocket",
+                                 U"€\U0010FFFF");
+        const uint8_t* ptr = bytes.data();
+        Names obj = Names::read(ptr, ptr + bytes.size());
+
+        CHECK( obj.short_name == "plain ascii name that spans several blocks" );
+        CHECK( obj.title == "h\xC3\xA9llo \xE6\x97\xA5\xE6\x9C\xAC \xF0\x9F\x98\x80!" );
+        CHECK( obj.long_name == "caf\xC3\xA9 \xF0\x9F\x9A\x80 and more ascii after the rocket" );
+        CHECK( obj.tag == "\xE2\x82\xAC\xF4\x8F\xBF\xBF" );
+        CHECK( obj.aliases[0] == "a" );
+        CHECK( obj.aliases[1] == "\xC3\xA9t\xC3\xA9" );
+        CHECK( ptr == bytes.data() + bytes.size() );
+    }
+
+    TEST_CASE("Names - empty strings") {
+        auto bytes = names_bytes(u"", u"", U"", U"");
+        const uint8_t* ptr = bytes.data();
+        Names obj = Names::read(ptr, ptr + bytes.size());
+
+        CHECK( obj.short_name.empty() );
+        CHECK( obj.tag.empty() );
+        CHECK( ptr == bytes.data() + bytes.size() );
+    }
+
+    TEST_CASE("Names - invalid and unterminated input is rejected") {
+        // Unpaired high surrogate, then one followed by a non-surrogate
+        for (const std::u16string& bad : {std::u16string(1, char16_t(0xD800)),
+                                          std::u16string({char16_t(0xD83D), u'x'}),
+                                          std::u16string(1, char16_t(0xDC00))}) {
+            auto bytes = names_bytes(bad, u"", U"", U"");
+            const uint8_t* ptr = bytes.data();
+            CHECK_THROWS( Names::read(ptr, ptr + bytes.size()) );
+        }
+
+        // Beyond U+10FFFF, and a UTF-32 surrogate code point
+        for (const std::u32string& bad : {std::u32string(1, char32_t(0x110000)),
+                                          std::u32string(1, char32_t(0xD800))}) {
+            auto bytes = names_bytes(u"", u"", bad, U"");
+            const uint8_t* ptr = bytes.data();
+            CHECK_THROWS( Names::read(ptr, ptr + bytes.size()) );
+        }
+
+        // No terminator before the end of the buffer
+        std::vector<uint8_t> bytes;
+        append_units(bytes, std::u16string(u"unterminated"), false);
+        bytes.resize(bytes.size() - 2);
+        const uint8_t* ptr = bytes.data();
+        CHECK_THROWS( Names::read(ptr, ptr + bytes.size()) );
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Tests for @delta / @delta_of_delta / @zigzag_delta array transforms
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source) {
+    return generate_with_options(source, {});
+}
+
+TEST_SUITE("Codegen - Array Transforms") {
+
+    TEST_CASE("Transformed arrays decode with a fused reconstruction read") {
+        std::string code = generate_cpp(R"(
+            struct Series {
+                uint32 count;
+                @delta_of_delta
+                int64 timestamps[count];
+                @delta
+                big uint32 ids[count];
+                @zigzag_delta
+                int16 levels[8];
+            };
+        )");
+
+        CHECK( code.find("std::vector<int64_t> timestamps;") != std::string::npos );
+        CHECK( code.find("std::array<int16_t, 8> levels;") != std::string::npos );
+        CHECK( code.find("read_array_delta_of_delta_le(data, end, obj.timestamps.data(), static_cast<size_t>(obj.count));") != std::string::npos );
+        CHECK( code.find("read_array_delta_be(data, end, obj.ids.data(), static_cast<size_t>(obj.count));") != std::string::npos );
+        CHECK( code.find("read_array_zigzag_delta_le(data, end, obj.levels.data(), static_cast<size_t>(8));") != std::string::npos );
+    }
+
+    TEST_CASE("Transform helpers are emitted only when a transform is used") {
+        std::string with = generate_cpp(R"(
+            struct Series {
+                @delta
+                uint32 ids[4];
+            };
+        )");
+        std::string without = generate_cpp(R"(
+            struct Series {
+                uint32 ids[4];
+            };
+        )");
+
+        CHECK( with.find("#define DATASCRIPT_TRANSFORM_SSE2 1") != std::string::npos );
+        CHECK( with.find("enum class ArrayTransform { Delta, DeltaOfDelta, ZigzagDelta };") != std::string::npos );
+        CHECK( with.find("inline void read_transformed_array(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {") != std::string::npos );
+        CHECK( with.find("inline void read_array_zigzag_delta_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {") != std::string::npos );
+
+        CHECK( without.find("DATASCRIPT_TRANSFORM_SSE2") == std::string::npos );
+        CHECK( without.find("read_transformed_array") == std::string::npos );
+    }
+
+    TEST_CASE("Untransformed integer arrays keep per-element decoding") {
+        std::string code = generate_cpp(R"(
+            struct Series {
+                @delta
+                uint32 ids[4];
+                uint32 raw[4];
+            };
+        )");
+
+        CHECK( code.find("read_array_delta_le(data, end, obj.ids.data(), static_cast<size_t>(4));") != std::string::npos );
+        CHECK( code.find("obj.raw.data()") == std::string::npos );
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Tests for batched decoding (--cpp-batch-decode)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static const char* const order_schema = R"(
+    struct Customer {
+        string name;
+        uint32 age;
+    };
+
+    struct Order {
+        uint32 id;
+        string note;
+        uint16 count;
+        Customer lines[count];
+        Customer customer;
+        uint32 extra if count != 0;
+    };
+)";
+
+TEST_SUITE("Codegen - Batch Decoding") {
+
+    TEST_CASE("Batch decoding is not generated by default") {
+        std::string code = generate_with_options(order_schema, {});
+
+        CHECK( code.find("read_batch") == std::string::npos );
+        CHECK( code.find("read_into") == std::string::npos );
+        CHECK( code.find("decode_batch") == std::string::npos );
+    }
+
+    TEST_CASE("read_into() decodes in place and resets only optional fields") {
+        std::string code = generate_with_options(order_schema, {{"batch-decode", true}});
+
+        auto into = code.find("static void read_into(Order& obj, const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( into != std::string::npos );
+        CHECK( code.find("obj.extra = {};", into) != std::string::npos );
+        CHECK( code.find("obj.id = {};", into) == std::string::npos );
+        CHECK( code.find("read_string_into(obj.note, data, end);", into) != std::string::npos );
+        CHECK( code.find("Customer::read_into(obj.lines[i], data, end);", into) != std::string::npos );
+        CHECK( code.find("Customer::read_into(obj.customer, data, end);", into) != std::string::npos );
+
+        // read() is unchanged
+        CHECK( code.find("obj.customer = Customer::read(data, end);") != std::string::npos );
+    }
+
+    TEST_CASE("read_batch() is generated per struct with the runtime helpers") {
+        std::string code = generate_with_options(order_schema, {{"batch-decode", true}});
+
+        CHECK( code.find("static size_t read_batch(std::span<const std::span<const uint8_t>> inputs, std::span<Order> outputs,") != std::string::npos );
+        CHECK( code.find("static size_t read_batch(std::span<const std::span<const uint8_t>> inputs, std::span<Customer> outputs,") != std::string::npos );
+        CHECK( code.find("return decode_batch<Order>(inputs, outputs, status,") != std::string::npos );
+
+        CHECK( code.find("#include <span>") != std::string::npos );
+        CHECK( code.find("enum class BatchStatus : uint8_t {") != std::string::npos );
+        CHECK( code.find("inline void read_string_into(std::string& out, const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+        CHECK( code.find("__builtin_prefetch(address, 0, 3);") != std::string::npos );
+        CHECK( code.find("} catch (const ConstraintViolation&) {") != std::string::npos );
+    }
+
+    TEST_CASE("Requires exception error handling") {
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( generate_with_options(order_schema, {{"batch-decode", true}}, options), codegen::codegen_error );
+    }
+}
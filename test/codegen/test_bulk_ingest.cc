@@ -0,0 +1,117 @@
+//
+// Tests for bulk file ingestion driver generation (--cpp-bulk-ingest)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+TEST_SUITE("Codegen - Bulk Ingest") {
+
+    TEST_CASE("Bulk ingestion driver is not generated by default") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {});
+
+        CHECK( code.find("BulkReader") == std::string::npos );
+        CHECK( code.find("bulk_ingest") == std::string::npos );
+        CHECK( code.find("#include <thread>") == std::string::npos );
+        CHECK( code.find("io_uring") == std::string::npos );
+    }
+
+    TEST_CASE("Bulk ingestion driver and platform includes are generated") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {{"bulk-ingest", true}});
+
+        // Includes (io_uring only where the kernel header exists)
+        CHECK( code.find("#include <thread>") != std::string::npos );
+        CHECK( code.find("#include <condition_variable>") != std::string::npos );
+        CHECK( code.find("#if __has_include(<linux/io_uring.h>)") != std::string::npos );
+        CHECK( code.find("#define DATASCRIPT_BULK_IO_URING 1") != std::string::npos );
+
+        // Public runtime
+        CHECK( code.find("struct BulkIngestOptions {") != std::string::npos );
+        CHECK( code.find("struct BulkIngestStats {") != std::string::npos );
+        CHECK( code.find("class BulkReader {") != std::string::npos );
+        CHECK( code.find("BulkIngestStats bulk_ingest(const std::vector<std::string>& paths, Fn&& on_record,") != std::string::npos );
+        CHECK( code.find("on_record(index, T::read(p, data + len));") != std::string::npos );
+    }
+
+    TEST_CASE("io_uring backend uses registered buffers and a pread fallback") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+            };
+        )", {{"bulk-ingest", true}});
+
+        CHECK( code.find("IORING_REGISTER_BUFFERS") != std::string::npos );
+        CHECK( code.find("IORING_OP_READ_FIXED") != std::string::npos );
+        CHECK( code.find("IORING_OP_READV") != std::string::npos );
+        CHECK( code.find("void run_pread(State& state, Deliver& deliver) {") != std::string::npos );
+
+        // The io_uring backend is compiled out where the feature macro is missing
+        auto guard = code.find("#if defined(DATASCRIPT_BULK_IO_URING)");
+        auto ring = code.find("class Ring {");
+        REQUIRE( guard != std::string::npos );
+        REQUIRE( ring != std::string::npos );
+        CHECK( guard < ring );
+    }
+
+    TEST_CASE("Worker threads are joined on every exit path") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+            };
+        )", {{"bulk-ingest", true}});
+
+        CHECK( code.find("class Workers {") != std::string::npos );
+        CHECK( code.find("~Workers() { join(); }") != std::string::npos );
+        CHECK( code.find("} catch (const std::system_error&) {") != std::string::npos );
+
+        // Neither backend owns a bare vector of threads any more
+        CHECK( code.find("std::vector<std::thread> threads;") == std::string::npos );
+        CHECK( code.find("threads.emplace_back(worker)") == std::string::npos );
+        CHECK( code.find("if (threads.spawn(state.worker_count, worker) == 0) return false;") != std::string::npos );
+    }
+
+    TEST_CASE("A failed ring reaps its reads before the buffers go away") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+            };
+        )", {{"bulk-ingest", true}});
+
+        // Transient io_uring_enter errors are retried, not fatal
+        CHECK( code.find("if (errno != EAGAIN && errno != EBUSY) return false;") != std::string::npos );
+
+        // Reads in flight are cancelled and reaped before the pread fallback;
+        // if that fails too, the arena they write into is leaked
+        auto fallback = code.find("if (!cancel_in_flight()) {");
+        REQUIRE( fallback != std::string::npos );
+        CHECK( code.find("sqe->opcode = IORING_OP_ASYNC_CANCEL;") != std::string::npos );
+        CHECK( code.find("arena_storage.release();", fallback) != std::string::npos );
+        CHECK( code.find("slot_storage.release();", fallback) != std::string::npos );
+        CHECK( code.find("std::vector<uint8_t> arena(") == std::string::npos );
+    }
+
+    TEST_CASE("Bulk ingestion composes with the decode cache") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+            };
+        )", {{"bulk-ingest", true}, {"decode-cache", true}});
+
+        CHECK( code.find("class DecodeCache {") != std::string::npos );
+        CHECK( code.find("class BulkReader {") != std::string::npos );
+    }
+}
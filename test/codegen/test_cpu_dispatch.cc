@@ -0,0 +1,93 @@
+//
+// Tests for --cpp-cpu-dispatch (vector kernels selected by CPU feature at run time)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source, bool dispatch) {
+    return generate_with_options(source, {{"cpu-dispatch", dispatch}, {"utf8-strings", true}});
+}
+
+static const char* const sample_schema = R"(
+    struct Sample {
+        uint8 count;
+        big float32 levels[count];
+        string name;
+        little u16string title;
+        uint16 length;
+        uint8 key;
+        @xor(length, key)
+        uint8 payload[];
+    };
+)";
+
+TEST_SUITE("Codegen - CPU Dispatch") {
+
+    TEST_CASE("Kernels for every level with one-time detection") {
+        std::string code = generate_cpp(sample_schema, true);
+
+        CHECK( code.find("#define DATASCRIPT_TARGET(isa) __attribute__((target(isa)))") != std::string::npos );
+        CHECK( code.find("enum class Isa : uint8_t { Scalar, Sse2, Sse42, Avx2, Avx512 };") != std::string::npos );
+        CHECK( code.find("__builtin_cpu_supports(\"avx2\")") != std::string::npos );
+        CHECK( code.find("namespace sse42 {") != std::string::npos );
+        CHECK( code.find("DATASCRIPT_TARGET(\"avx512f,avx512bw\")") != std::string::npos );
+        CHECK( code.find("std::getenv(\"DATASCRIPT_FORCE_ISA\")") != std::string::npos );
+        CHECK( code.find("static const Kernels table = kernels_for(active_isa());") != std::string::npos );
+        CHECK( code.find("inline std::vector<KernelThroughput> benchmark_kernels(") != std::string::npos );
+    }
+
+    TEST_CASE("Runtime helpers call the dispatched kernels") {
+        std::string code = generate_cpp(sample_schema, true);
+
+        CHECK( code.find("cpu::kernels().byteswap32(dst, p, count);") != std::string::npos );
+        CHECK( code.find("cpu::kernels().find_zero8(data, end)") != std::string::npos );
+        CHECK( code.find("cpu::kernels().find_zero16(p, end)") != std::string::npos );
+        CHECK( code.find("cpu::kernels().ascii16(src + 2 * i, units - i, out, BigEndian);") != std::string::npos );
+        CHECK( code.find("cpu::kernels().xor_bytes(bytes, size, param);") != std::string::npos );
+
+        // NEON keeps its fixed fast path; SSE2 is replaced by the kernels
+        CHECK( code.find("#elif defined(DATASCRIPT_UTF8_NEON)") != std::string::npos );
+        CHECK( code.find("_mm_xor_si128(x, key)") == std::string::npos );
+    }
+
+    TEST_CASE("Delta arrays use the dispatched prefix sums") {
+        const char* schema = R"(
+            struct Series {
+                uint16 count;
+                @delta
+                uint32 stamps[count];
+                @zigzag_delta
+                big int64 offsets[count];
+            };
+        )";
+
+        std::string code = generate_cpp(schema, true);
+
+        CHECK( code.find("void (*delta32)(const uint8_t* src, uint8_t* dst, size_t count, unsigned mode, uint32_t& value, uint32_t& delta);") != std::string::npos );
+        CHECK( code.find("scalar::delta32, scalar::delta64};") != std::string::npos );
+        CHECK( code.find("sse2::delta32, sse2::delta64};") != std::string::npos );
+        CHECK( code.find("avx2::delta32, avx2::delta64};") != std::string::npos );
+        CHECK( code.find("measure(\"delta64\", [&] {") != std::string::npos );
+        CHECK( code.find("cpu::kernels().delta32(p, reinterpret_cast<uint8_t*>(out), count, mode, value, delta);") != std::string::npos );
+        CHECK( code.find("transform_array_sse2") == std::string::npos );
+
+        std::string fixed = generate_cpp(schema, false);
+        CHECK( fixed.find("i = transform_array_sse2<W, swap, X>(") != std::string::npos );
+        CHECK( fixed.find("cpu::kernels().delta32") == std::string::npos );
+    }
+
+    TEST_CASE("Disabled by default") {
+        std::string code = generate_cpp(sample_schema, false);
+
+        CHECK( code.find("namespace cpu") == std::string::npos );
+        CHECK( code.find("cpu::kernels()") == std::string::npos );
+        CHECK( code.find("DATASCRIPT_FORCE_ISA") == std::string::npos );
+        CHECK( code.find("w = byteswap_word(w);") != std::string::npos );
+    }
+}
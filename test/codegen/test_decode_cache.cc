@@ -0,0 +1,104 @@
+//
+// Tests for content-addressed decode cache generation (--cpp-decode-cache)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+TEST_SUITE("Codegen - Decode Cache") {
+
+    TEST_CASE("Decode cache is not generated by default") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {});
+
+        CHECK( code.find("DecodeCache") == std::string::npos );
+        CHECK( code.find("read_cached") == std::string::npos );
+        CHECK( code.find("#include <mutex>") == std::string::npos );
+    }
+
+    TEST_CASE("Fixed-size struct is keyed by its wire size") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {{"decode-cache", true}});
+
+        // Runtime support
+        CHECK( code.find("#include <mutex>") != std::string::npos );
+        CHECK( code.find("inline uint64_t decode_cache_hash(const uint8_t* p, size_t len, uint64_t seed = 0) {") != std::string::npos );
+        CHECK( code.find("class DecodeCache {") != std::string::npos );
+        CHECK( code.find("uint64_t hits() const") != std::string::npos );
+        CHECK( code.find("uint64_t misses() const") != std::string::npos );
+
+        // Per-struct members (default capacity)
+        CHECK( code.find("static DecodeCache<Point>& decode_cache() {") != std::string::npos );
+        CHECK( code.find("static DecodeCache<Point> cache(1024);") != std::string::npos );
+        CHECK( code.find("static std::shared_ptr<const Point> read_cached(const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+        CHECK( code.find("const size_t key_len = 6;  // Fixed wire size") != std::string::npos );
+    }
+
+    TEST_CASE("Variable-size struct is keyed by its decoded extent") {
+        std::string code = generate_with_options(R"(
+            struct Message {
+                uint8 kind;
+                string text;
+            };
+        )", {{"decode-cache", true}, {"decode-cache-capacity", int64_t{16}}});
+
+        CHECK( code.find("static DecodeCache<Message> cache(16);") != std::string::npos );
+        CHECK( code.find("static Message read_boundary(const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+
+        auto cached = code.find("read_cached(const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( cached != std::string::npos );
+        CHECK( code.find("(void)read_boundary(extent_end, end);  // Decodes only the fields that determine the size",
+                         cached) != std::string::npos );
+        CHECK( code.find("const size_t key_len = static_cast<size_t>(extent_end - data);", cached) != std::string::npos );
+        CHECK( code.find("available") == std::string::npos );
+    }
+
+    TEST_CASE("Conditional fields disable the fixed-size key") {
+        std::string code = generate_with_options(R"(
+            struct Record {
+                uint8 flags;
+                uint32 extra if flags != 0;
+            };
+        )", {{"decode-cache", true}});
+
+        CHECK( code.find("const size_t key_len = static_cast<size_t>(extent_end - data);") != std::string::npos );
+    }
+
+    TEST_CASE("Fixed-size structs need no boundary scan") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {{"decode-cache", true}});
+
+        CHECK( code.find("read_boundary") == std::string::npos );
+    }
+
+    TEST_CASE("Decode cache requires exception error handling") {
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( generate_with_options(R"(
+            struct Point {
+                uint16 x;
+            };
+        )", {{"decode-cache", true}}, options), codegen::codegen_error );
+    }
+
+    TEST_CASE("Negative decode cache capacity is rejected") {
+        codegen::CppRenderer renderer;
+        CHECK_THROWS_AS( renderer.set_option("decode-cache-capacity", int64_t{-1}), std::invalid_argument );
+    }
+}
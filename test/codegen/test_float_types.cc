@@ -0,0 +1,91 @@
+//
+// Tests for float32/float64 fields and bulk decoding of float arrays
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source) {
+    return generate_with_options(source, {});
+}
+
+TEST_SUITE("Codegen - Floating-Point Types") {
+
+    TEST_CASE("Float fields map to float/double with endian-specific readers") {
+        std::string code = generate_cpp(R"(
+            struct Reading {
+                float32 gain;
+                big float32 offset;
+                little float64 scale;
+                big float64 bias;
+            };
+        )");
+
+        CHECK( code.find("float gain;") != std::string::npos );
+        CHECK( code.find("double scale;") != std::string::npos );
+        CHECK( code.find("obj.gain = read_float32_le(data, end);") != std::string::npos );
+        CHECK( code.find("obj.offset = read_float32_be(data, end);") != std::string::npos );
+        CHECK( code.find("obj.scale = read_float64_le(data, end);") != std::string::npos );
+        CHECK( code.find("obj.bias = read_float64_be(data, end);") != std::string::npos );
+    }
+
+    TEST_CASE("Float readers and bulk array helpers are emitted") {
+        std::string code = generate_cpp(R"(
+            struct Reading {
+                float32 gain;
+            };
+        )");
+
+        CHECK( code.find("#include <cstring>") != std::string::npos );
+        CHECK( code.find("inline float read_float32_le(const uint8_t*& p, const uint8_t* end) {") != std::string::npos );
+        CHECK( code.find("inline double read_float64_be(const uint8_t*& p, const uint8_t* end) {") != std::string::npos );
+        CHECK( code.find("inline void read_array_le(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {") != std::string::npos );
+        CHECK( code.find("inline void read_array_be(const uint8_t*& p, const uint8_t* end, T* out, size_t count) {") != std::string::npos );
+        CHECK( code.find("throw std::runtime_error(\"Buffer underflow reading array\");") != std::string::npos );
+    }
+
+    TEST_CASE("Float arrays decode with a single bulk read") {
+        std::string code = generate_cpp(R"(
+            struct Waveform {
+                float32 coeffs[4];
+                uint32 count;
+                big float64 samples[count];
+            };
+        )");
+
+        CHECK( code.find("std::array<float, 4> coeffs;") != std::string::npos );
+        CHECK( code.find("std::vector<double> samples;") != std::string::npos );
+        CHECK( code.find("read_array_le(data, end, obj.coeffs.data(), static_cast<size_t>(4));") != std::string::npos );
+        CHECK( code.find("obj.samples.resize(obj.count);") != std::string::npos );
+        CHECK( code.find("read_array_be(data, end, obj.samples.data(), static_cast<size_t>(obj.count));") != std::string::npos );
+        CHECK( code.find("obj.samples[i] = ") == std::string::npos );
+    }
+
+    TEST_CASE("Unbounded float arrays are sized by the remaining bytes") {
+        std::string code = generate_cpp(R"(
+            struct Trace {
+                uint8 channel;
+                big float32 samples[];
+            };
+        )");
+
+        CHECK( code.find("obj.samples.resize((static_cast<size_t>(end - data) + 4 - 1) / 4);") != std::string::npos );
+        CHECK( code.find("read_array_be(data, end, obj.samples.data(), obj.samples.size());") != std::string::npos );
+        CHECK( code.find("obj.samples.push_back(") == std::string::npos );
+    }
+
+    TEST_CASE("Counted integer arrays keep per-element decoding") {
+        std::string code = generate_cpp(R"(
+            struct Table {
+                uint32 ids[2];
+            };
+        )");
+
+        CHECK( code.find("obj.ids[i] = read_uint32_le(data, end);") != std::string::npos );
+        CHECK( code.find("read_array_le(data, end, obj.ids") == std::string::npos );
+    }
+}
@@ -0,0 +1,131 @@
+//
+// Tests for the heap-free, exception-free output profile (--cpp-profile=freestanding)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <stdexcept>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_freestanding(const std::string& source, int64_t capacity = 4096) {
+    return generate_with_options(source, {{"profile", std::string("freestanding")},
+                                          {"freestanding-capacity", capacity}});
+}
+
+static const char* const device_schema = R"(
+    struct Point {
+        uint8 x;
+        uint8 y;
+    };
+
+    union Reading {
+        uint8 narrow : narrow < 100;
+        uint32 wide;
+    };
+
+    choice Command : uint8 {
+        case 1:
+            uint16 speed;
+        case 2:
+            uint8 mode;
+    };
+
+    struct Frame {
+        uint32 id;
+        string label;
+        uint8 count;
+        uint32 samples[count];
+        uint8 magic[4];
+        Reading reading;
+        Command command;
+        Point trail[];
+    };
+)";
+
+TEST_SUITE("Codegen - Freestanding Profile") {
+
+    TEST_CASE("Default profile is unchanged") {
+        std::string code = generate_with_options(device_schema, {});
+
+        CHECK( code.find("enum class Status") == std::string::npos );
+        CHECK( code.find("BoundedArray") == std::string::npos );
+        CHECK( code.find("std::vector<uint32_t> samples") != std::string::npos );
+    }
+
+    TEST_CASE("Header uses no heap, no exceptions and no container headers") {
+        std::string code = generate_freestanding(device_schema);
+
+        CHECK( code.find("#include <cstdint>") != std::string::npos );
+        CHECK( code.find("enum class Status : uint8_t") != std::string::npos );
+        CHECK( code.find("throw") == std::string::npos );
+        CHECK( code.find("std::vector") == std::string::npos );
+        CHECK( code.find("std::string") == std::string::npos );
+        CHECK( code.find("std::variant") == std::string::npos );
+        CHECK( code.find("#include <vector>") == std::string::npos );
+        CHECK( code.find("#include <stdexcept>") == std::string::npos );
+        CHECK( code.find("static Status read(Frame& obj, const uint8_t*& data, const uint8_t* end)") != std::string::npos );
+    }
+
+    TEST_CASE("Bounded arrays are stored inline") {
+        std::string code = generate_freestanding(device_schema);
+
+        // uint8 count: at most 255 samples
+        CHECK( code.find("BoundedArray<uint32_t, 255> samples;") != std::string::npos );
+        CHECK( code.find("if (count > 255) return Status::capacity_exceeded;") != std::string::npos );
+        CHECK( code.find("FixedArray<uint8_t, 4> magic;") != std::string::npos );
+        CHECK( code.find("WireString<char> label;") != std::string::npos );
+        CHECK( code.find("WireSequence<Point> trail;") != std::string::npos );
+        CHECK( code.find("WireSequence<Point>::read_rest(obj.trail, data, end)") != std::string::npos );
+    }
+
+    TEST_CASE("Arrays above the capacity limit become views") {
+        std::string code = generate_freestanding(device_schema, 16);
+
+        CHECK( code.find("BoundedArray<uint32_t") == std::string::npos );
+        CHECK( code.find("WireArray<uint32_t> samples;") != std::string::npos );
+        CHECK( code.find("FixedArray<uint8_t, 4> magic;") != std::string::npos );
+    }
+
+    TEST_CASE("Unions are tagged and fall through on constraint violations") {
+        std::string code = generate_freestanding(device_schema);
+
+        auto reading = code.find("struct Reading {");
+        REQUIRE( reading != std::string::npos );
+        CHECK( code.find("enum class Tag : uint8_t { unset, narrow, wide };", reading) != std::string::npos );
+        CHECK( code.find("static Status read_as_narrow(Reading& obj", reading) != std::string::npos );
+        CHECK( code.find("if (Status s = read_as_narrow(obj, data, end, parent); s != Status::constraint_violation) return s;",
+                         reading) != std::string::npos );
+        CHECK( code.find("Reading::read(obj.reading, data, end, &obj)") != std::string::npos );
+    }
+
+    TEST_CASE("Block case conditions read members through the block") {
+        std::string code = generate_freestanding(R"(
+            union Body {
+                {
+                    uint8 tag;
+                    uint8 rest;
+                } block : tag == 2;
+                uint16 plain;
+            };
+        )");
+
+        CHECK( code.find("if (!((obj.block.tag == 2))) return Status::constraint_violation;") != std::string::npos );
+    }
+
+    TEST_CASE("Choices without a default case report invalid selectors") {
+        std::string code = generate_freestanding(device_schema);
+
+        auto command = code.find("struct Command {");
+        REQUIRE( command != std::string::npos );
+        CHECK( code.find("enum class Tag : uint8_t { unset, speed, mode };", command) != std::string::npos );
+        CHECK( code.find("return Status::invalid_selector;", command) != std::string::npos );
+    }
+
+    TEST_CASE("Negative capacity is rejected") {
+        codegen::CppRenderer renderer;
+        CHECK_THROWS_AS( renderer.set_option("freestanding-capacity", int64_t(-1)), std::invalid_argument );
+    }
+}
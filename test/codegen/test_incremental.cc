@@ -0,0 +1,118 @@
+//
+// Tests for incremental re-decoding support (--cpp-incremental)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+TEST_SUITE("Codegen - Incremental Decoding") {
+
+    TEST_CASE("Incremental support is not generated by default") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint16 y;
+            };
+        )", {});
+
+        CHECK( code.find("IncrementalDecoder") == std::string::npos );
+        CHECK( code.find("incremental_frame") == std::string::npos );
+    }
+
+    TEST_CASE("Struct readers reuse and record nodes") {
+        std::string code = generate_with_options(R"(
+            struct Entry {
+                uint16 key;
+                string value;
+            };
+
+            struct Table {
+                uint8 count;
+                Entry entries[count];
+            };
+        )", {{"incremental", true}});
+
+        // Runtime support
+        CHECK( code.find("class IncrementalSession {") != std::string::npos );
+        CHECK( code.find("class IncrementalFrame {") != std::string::npos );
+        CHECK( code.find("class IncrementalDecoder {") != std::string::npos );
+        CHECK( code.find("inline void incremental_touch(const uint8_t* p) {") != std::string::npos );
+
+        // Every struct reader looks up its previous node before decoding...
+        CHECK( code.find("if (const Entry* reused = incremental_frame.reuse<Entry>(data, end)) {") != std::string::npos );
+        CHECK( code.find("if (const Table* reused = incremental_frame.reuse<Table>(data, end)) {") != std::string::npos );
+
+        // ...and records the decoded node right before returning it
+        size_t record = code.find("incremental_frame.record(obj, data);");
+        REQUIRE( record != std::string::npos );
+        CHECK( code.find("return", record) == code.find("return obj;", record) );
+    }
+
+    TEST_CASE("Only nodes made mostly of their own fields keep a copy") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint16 y;
+            };
+
+            struct Segment {
+                Point from;
+                Point to;
+            };
+        )", {{"incremental", true}});
+
+        // Parents count the bytes of decoded and reused children...
+        CHECK( code.find("parent.children_consumed += next_[index].consumed;") != std::string::npos );
+        CHECK( code.find("next_[frames_.back()].children_consumed += node.consumed;") != std::string::npos );
+
+        // ...and store a value only when those children cover at most half of their input
+        size_t keep = code.find("if (frames_.size() > 1 && 2 * node.children_consumed <= node.consumed) {");
+        REQUIRE( keep != std::string::npos );
+        CHECK( code.find("node.value = std::make_shared<const T>(value);", keep) != std::string::npos );
+    }
+
+    TEST_CASE("Label seeks widen the node's input range") {
+        std::string code = generate_with_options(R"(
+            struct Header {
+                uint32 offset;
+                offset:
+                uint8 payload;
+            };
+        )", {{"incremental", true}});
+
+        size_t touch = code.find("incremental_touch(data);  // Bytes read so far stay in this node's input range");
+        REQUIRE( touch != std::string::npos );
+        CHECK( touch < code.find("data = label_pos", touch) );
+    }
+
+    TEST_CASE("Union trial decoding records the bytes of failed branches") {
+        std::string code = generate_with_options(R"(
+            union Number {
+                uint32 wide : wide > 1000;
+                uint8 narrow;
+            };
+
+            struct Holder {
+                Number number;
+            };
+        )", {{"incremental", true}});
+
+        CHECK( code.find("incremental_touch(data);  // The failed attempt's bytes stay in this node's input range") != std::string::npos );
+    }
+
+    TEST_CASE("Requires exception error handling") {
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint16 y;
+            };
+        )", {{"incremental", true}}, options), codegen::codegen_error );
+    }
+}
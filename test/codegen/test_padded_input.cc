@@ -0,0 +1,94 @@
+//
+// Tests for --cpp-padded-input (branch-light readers over padded buffers)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source, bool padded) {
+    return generate_with_options(source, {{"padded-input", padded}});
+}
+
+static const char* const record_schema = R"(
+    struct Record {
+        uint32 magic;
+        big uint16 count;
+        uint16 values[count];
+        string name;
+        uint32 offset;
+        offset:
+        uint8 tail;
+    };
+
+    union Frame {
+        {
+            uint8 tag : tag == 1;
+            uint32 value;
+        } tagged;
+        uint16 plain;
+    };
+)";
+
+TEST_SUITE("Codegen - Padded Input") {
+
+    TEST_CASE("Fixed-width readers load without bounds checks") {
+        std::string code = generate_cpp(record_schema, true);
+
+        CHECK( code.find("inline constexpr size_t input_padding = 8;") != std::string::npos );
+        CHECK( code.find("class PaddedBuffer {") != std::string::npos );
+        CHECK( code.find("std::memcpy(&w, p < end ? p : end, sizeof(W));") != std::string::npos );
+        CHECK( code.find("inline uint16_t read_uint16_be(const uint8_t*& p, const uint8_t* end) "
+                         "{ return read_padded_be<uint16_t>(p, end); }") != std::string::npos );
+        CHECK( code.find("Buffer underflow reading uint32") == std::string::npos );
+
+        // Bulk array and string readers keep their own checks
+        CHECK( code.find("Buffer underflow reading array") != std::string::npos );
+        CHECK( code.find("static Record read(const PaddedBuffer& buffer) {") != std::string::npos );
+    }
+
+    TEST_CASE("Checkpoints guard counts, seeks, backtracking and returns") {
+        std::string code = generate_cpp(record_schema, true);
+
+        CHECK( code.find("check_input_end(data, end);\n"
+                         "            obj.values.resize(obj.count);") != std::string::npos );
+        CHECK( code.find("check_input_end(data, end);\n"
+                         "            obj.name = read_string(data, end);") != std::string::npos );
+        CHECK( code.find("check_input_end(data, end);\n"
+                         "            const uint8_t* label_pos0") != std::string::npos );
+        CHECK( code.find("check_input_end(data, end);\n"
+                         "            data = union_pos;") != std::string::npos );
+        CHECK( code.find("check_input_end(data, end);\n"
+                         "            return obj;") != std::string::npos );
+    }
+
+    TEST_CASE("Substreams are decoded from a padded copy") {
+        std::string code = generate_cpp(R"(
+            struct Inner {
+                uint16 version;
+            };
+
+            struct Sealed {
+                uint8 key;
+                @xor(2, key)
+                Inner inner;
+            };
+        )", true);
+
+        CHECK( code.find("plain.resize(size + input_padding);") != std::string::npos );
+        CHECK( code.find("return T::read(p, p + size);") != std::string::npos );
+    }
+
+    TEST_CASE("Default readers are unchanged") {
+        std::string code = generate_cpp(record_schema, false);
+
+        CHECK( code.find("Buffer underflow reading uint32") != std::string::npos );
+        CHECK( code.find("check_input_end") == std::string::npos );
+        CHECK( code.find("PaddedBuffer") == std::string::npos );
+        CHECK( code.find("input_padding") == std::string::npos );
+    }
+}
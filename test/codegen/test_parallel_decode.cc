@@ -0,0 +1,86 @@
+//
+// Tests for two-phase parallel decoding (--cpp-parallel-decode)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static const char* const event_schema = R"(
+    struct Event {
+        uint32 id;
+        string message;
+        uint16 count;
+        uint32 values[count];
+    };
+)";
+
+TEST_SUITE("Codegen - Parallel Decoding") {
+
+    TEST_CASE("No parallel decoder is generated by default") {
+        std::string code = generate_with_options(event_schema, {});
+
+        CHECK( code.find("parallel_decode") == std::string::npos );
+        CHECK( code.find("read_all_parallel") == std::string::npos );
+    }
+
+    TEST_CASE("Listed structs get read_all_parallel() backed by a boundary scanner") {
+        std::string code = generate_with_options(event_schema, {{"parallel-decode", std::string("Event")}});
+
+        auto scanner = code.find("static Event read_boundary(const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( scanner != std::string::npos );
+        CHECK( code.find("skip_string(data, end);", scanner) != std::string::npos );
+        CHECK( code.find("obj.count = read_uint16_le(data, end);", scanner) != std::string::npos );
+
+        CHECK( code.find("static std::vector<Event> read_all_parallel(const uint8_t* data, size_t size, size_t workers = 0) {") != std::string::npos );
+        CHECK( code.find("return parallel_decode<Event>(data, size, workers,") != std::string::npos );
+
+        CHECK( code.find("#include <thread>") != std::string::npos );
+        CHECK( code.find("inline std::vector<T> parallel_decode(const uint8_t* data, size_t size, size_t workers, Skip skip, Read read) {") != std::string::npos );
+        CHECK( code.find("std::rethrow_exception(error);") != std::string::npos );
+    }
+
+    TEST_CASE("A record that consumes no input throws with any worker count") {
+        std::string code = generate_with_options(event_schema, {{"parallel-decode", std::string("Event")}});
+
+        auto decoder = code.find("inline std::vector<T> parallel_decode(");
+        REQUIRE( decoder != std::string::npos );
+
+        // Serial path, phase 1 and phase 2 each check progress
+        size_t guards = 0;
+        for (auto at = code.find("throw std::runtime_error(\"Record consumed no input\");", decoder);
+             at != std::string::npos;
+             at = code.find("throw std::runtime_error(\"Record consumed no input\");", at + 1)) {
+            ++guards;
+        }
+        CHECK( guards == 3 );
+        CHECK( code.find("if (q <= before) {", decoder) != std::string::npos );
+    }
+
+    TEST_CASE("Record indexes and parallel decoding share one boundary scanner") {
+        std::string code = generate_with_options(event_schema, {
+            {"parallel-decode", std::string("Event")},
+            {"record-index", std::string("Event")}});
+
+        auto first = code.find("static Event read_boundary(");
+        REQUIRE( first != std::string::npos );
+        CHECK( code.find("static Event read_boundary(", first + 1) == std::string::npos );
+        CHECK( code.find("static RecordIndex build_index(") != std::string::npos );
+        CHECK( code.find("static std::vector<Event> read_all_parallel(") != std::string::npos );
+    }
+
+    TEST_CASE("Unknown structs are rejected") {
+        CHECK_THROWS_AS( generate_with_options(event_schema, {{"parallel-decode", std::string("Missing")}}),
+                         codegen::codegen_error );
+    }
+
+    TEST_CASE("Requires exception error handling") {
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( generate_with_options(event_schema, {{"parallel-decode", std::string("Event")}}, options), codegen::codegen_error );
+    }
+}
@@ -0,0 +1,122 @@
+//
+// Tests for conditional field presence bits and --cpp-conditional-storage
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <datascript/codegen/presence.hh>
+#include <stdexcept>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source, const std::string& storage, bool batch = false) {
+    return generate_with_options(source, {{"conditional-storage", storage}, {"batch-decode", batch}});
+}
+
+static const char* const record_schema = R"(
+    struct Inner {
+        uint8 n;
+        uint8 data[n];
+    };
+
+    struct Record {
+        uint8 flags;
+        uint32 small if flags > 0;
+        string label if flags > 1;
+        Inner inner if flags > 2;
+        uint8 len if flags > 3;
+        uint8 blob[len] if flags > 3;
+        uint8 tiny[4] if flags > 4;
+    };
+)";
+
+TEST_SUITE("Codegen - Conditional Field Presence") {
+
+    TEST_CASE("Presence bits and accessors with inline storage") {
+        std::string code = generate_cpp(record_schema, "inline");
+
+        CHECK( code.find("std::string label;") != std::string::npos );
+        CHECK( code.find("Inner inner;") != std::string::npos );
+        CHECK( code.find("uint8_t presence_{};") != std::string::npos );
+        CHECK( code.find("bool has_small() const { return (presence_ >> 0) & 1u; }") != std::string::npos );
+        CHECK( code.find("bool has_tiny() const { return (presence_ >> 5) & 1u; }") != std::string::npos );
+        CHECK( code.find("obj.presence_ |= uint8_t(1) << 1;") != std::string::npos );
+        CHECK( code.find("Boxed") == std::string::npos );
+
+        // Structs without conditional fields are unchanged
+        auto inner = code.find("struct Inner {");
+        REQUIRE( inner != std::string::npos );
+        CHECK( code.find("presence_", inner) > code.find("struct Record {") );
+    }
+
+    TEST_CASE("Large fields are boxed unless expressions read them") {
+        std::string code = generate_cpp(record_schema, "boxed");
+
+        CHECK( code.find("class Boxed {") != std::string::npos );
+        CHECK( code.find("Boxed<std::string> label;") != std::string::npos );
+        CHECK( code.find("Boxed<Inner> inner;") != std::string::npos );
+        CHECK( code.find("Boxed<std::vector<uint8_t>> blob;") != std::string::npos );
+
+        // len sizes blob and tiny is below the size threshold
+        CHECK( code.find("uint8_t len;") != std::string::npos );
+        CHECK( code.find("std::array<uint8_t, 4> tiny;") != std::string::npos );
+        CHECK( code.find("uint32_t small;") != std::string::npos );
+
+        CHECK( code.find("obj.inner.emplace();\n") != std::string::npos );
+        CHECK( code.find("(*obj.inner) = Inner::read(data, end);") != std::string::npos );
+        CHECK( code.find("(*obj.blob).resize(obj.len);") != std::string::npos );
+    }
+
+    TEST_CASE("Optional storage and read_into() reset") {
+        std::string code = generate_cpp(record_schema, "optional", true);
+
+        CHECK( code.find("#include <optional>") != std::string::npos );
+        CHECK( code.find("std::optional<std::string> label;") != std::string::npos );
+        CHECK( code.find("class Boxed {") == std::string::npos );
+
+        auto into = code.find("static void read_into(Record& obj, const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( into != std::string::npos );
+        CHECK( code.find("obj.label.reset();", into) != std::string::npos );
+        CHECK( code.find("obj.presence_ = {};", into) != std::string::npos );
+        CHECK( code.find("read_string_into((*obj.label), data, end);", into) != std::string::npos );
+    }
+
+    TEST_CASE("Wide masks use std::bitset") {
+        std::string source = "struct Wide {\n    uint8 f;\n";
+        for (int i = 0; i < 70; i++) {
+            source += "    uint8 x" + std::to_string(i) + " if f > " + std::to_string(i) + ";\n";
+        }
+        source += "};\n";
+        std::string code = generate_cpp(source, "inline");
+
+        CHECK( code.find("#include <bitset>") != std::string::npos );
+        CHECK( code.find("std::bitset<70> presence_{};") != std::string::npos );
+        CHECK( code.find("obj.presence_.set(69);") != std::string::npos );
+        CHECK( code.find("bool has_x69() const { return presence_.test(69); }") != std::string::npos );
+    }
+
+    TEST_CASE("Accessors step around existing members") {
+        std::string code = generate_cpp(R"(
+            struct Flagged {
+                uint8 has_name;
+                string name if has_name != 0;
+                uint8 has_size;
+                uint8 has_size_;
+                uint8 size if has_name > 1;
+            };
+        )", "inline");
+
+        CHECK( code.find("uint8_t has_name;") != std::string::npos );
+        CHECK( code.find("bool has_name_() const { return (presence_ >> 0) & 1u; }") != std::string::npos );
+        CHECK( code.find("bool has_size__() const { return (presence_ >> 1) & 1u; }") != std::string::npos );
+        CHECK( code.find("bool has_name()") == std::string::npos );
+    }
+
+    TEST_CASE("Unknown storage is rejected") {
+        CHECK_THROWS_AS( codegen::parse_conditional_storage("heap"), std::invalid_argument );
+        CHECK( codegen::parse_conditional_storage("boxed") == codegen::conditional_storage::boxed );
+    }
+}
@@ -0,0 +1,90 @@
+//
+// Tests for projected readers (--cpp-project)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_projected(const std::string& source, const std::string& projection) {
+    return generate_with_options(source, {{"project", projection}});
+}
+
+static const char* const order_schema = R"(
+    struct Customer {
+        string name;
+        uint32 age;
+        string city;
+    };
+
+    struct Order {
+        uint32 id;
+        string note;
+        uint16 count;
+        uint32 items[count];
+        Customer customer;
+        uint64 total;
+    };
+)";
+
+TEST_SUITE("Codegen - Projected Readers") {
+
+    TEST_CASE("No projected readers are generated by default") {
+        std::string code = generate_projected(order_schema, "");
+
+        CHECK( code.find("read_projected") == std::string::npos );
+        CHECK( code.find("inline void skip_bytes(") == std::string::npos );
+    }
+
+    TEST_CASE("Unselected fields are skipped; size fields are still decoded") {
+        std::string code = generate_projected(order_schema, "Order=total");
+
+        CHECK( code.find("static Order read_projected(const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+        CHECK( code.find("skip_bytes(data, end, 4);") != std::string::npos );
+        CHECK( code.find("skip_string(data, end);") != std::string::npos );
+        CHECK( code.find("skip_array(data, end, static_cast<size_t>(obj.count), 4);") != std::string::npos );
+
+        // Customer is variable-size and unselected: its projected reader only skips
+        CHECK( code.find("obj.customer = Customer::read_projected(data, end);") != std::string::npos );
+        CHECK( code.find("static Customer read_projected(const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+
+        CHECK( code.find("inline void skip_bytes(const uint8_t*& data, const uint8_t* end, size_t count) {") != std::string::npos );
+        CHECK( code.find("inline void skip_wide_string(const uint8_t*& data, const uint8_t* end) {") != std::string::npos );
+    }
+
+    TEST_CASE("Nested paths project the nested struct") {
+        std::string code = generate_projected(order_schema, "Order=customer.age");
+
+        auto customer = code.find("static Customer read_projected(");
+        REQUIRE( customer != std::string::npos );
+        auto age = code.find("obj.age = read_uint32_le(data, end);", customer);
+        CHECK( age != std::string::npos );
+        CHECK( code.find("obj.name = read_string(data, end);", customer) == std::string::npos );
+    }
+
+    TEST_CASE("Conditions keep the fields they read") {
+        std::string code = generate_projected(R"(
+            struct Packet {
+                uint8 flags;
+                uint32 extra if (flags & 0x01) != 0;
+                uint16 length;
+            };
+        )", "Packet=length");
+
+        auto projected = code.find("static Packet read_projected(");
+        REQUIRE( projected != std::string::npos );
+        CHECK( code.find("obj.flags = read_uint8(data, end);", projected) != std::string::npos );
+        CHECK( code.find("obj.extra = ", projected) == std::string::npos );
+        CHECK( code.find("obj.length = read_uint16_le(data, end);", projected) != std::string::npos );
+    }
+
+    TEST_CASE("Unknown structs and fields are rejected") {
+        CHECK_THROWS_AS( generate_projected(order_schema, "Order=missing"), codegen::codegen_error );
+        CHECK_THROWS_AS( generate_projected(order_schema, "Invoice=id"), codegen::codegen_error );
+        CHECK_THROWS_AS( generate_projected(order_schema, "Order=id.value"), codegen::codegen_error );
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Tests for record-offset indexes (--cpp-record-index)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static const char* const event_schema = R"(
+    struct Event {
+        uint32 id;
+        string message;
+        uint16 count;
+        uint32 values[count];
+    };
+
+    struct Other {
+        uint8 tag;
+    };
+)";
+
+TEST_SUITE("Codegen - Record Index") {
+
+    TEST_CASE("No record index is generated by default") {
+        std::string code = generate_with_options(event_schema, {});
+
+        CHECK( code.find("class RecordIndex") == std::string::npos );
+        CHECK( code.find("build_index") == std::string::npos );
+    }
+
+    TEST_CASE("Listed structs get a boundary scanner, build_index() and read_at()") {
+        std::string code = generate_with_options(event_schema, {{"record-index", std::string("Event")}});
+
+        auto scanner = code.find("static Event read_boundary(const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( scanner != std::string::npos );
+        CHECK( code.find("skip_bytes(data, end, 4);", scanner) != std::string::npos );
+        CHECK( code.find("obj.count = read_uint16_le(data, end);", scanner) != std::string::npos );
+        CHECK( code.find("skip_array(data, end, static_cast<size_t>(obj.count), 4);", scanner) != std::string::npos );
+
+        CHECK( code.find("static RecordIndex build_index(const uint8_t* data, size_t size, uint32_t stride = RecordIndex::default_stride) {") != std::string::npos );
+        CHECK( code.find("static Event read_at(const RecordIndex& index, const uint8_t* data, size_t size, uint64_t n) {") != std::string::npos );
+
+        // Unlisted structs are left alone
+        CHECK( code.find("static Other read_boundary(") == std::string::npos );
+        CHECK( code.find("static Other read_at(") == std::string::npos );
+    }
+
+    TEST_CASE("A user projection of the same struct leaves the scanner alone") {
+        std::string code = generate_with_options(event_schema, {
+            {"record-index", std::string("Event")},
+            {"project", std::string("Event=message")}});
+
+        // read_projected() decodes the selected string ...
+        auto projected = code.find("static Event read_projected(const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( projected != std::string::npos );
+        CHECK( code.find("obj.message = read_string(data, end);", projected) != std::string::npos );
+
+        // ... while the scanner still only skips it, and the index uses the scanner
+        auto scanner = code.find("static Event read_boundary(const uint8_t*& data, const uint8_t* end) {");
+        REQUIRE( scanner != std::string::npos );
+        auto scanner_end = code.find("return obj;", scanner);
+        CHECK( code.find("skip_string(data, end);", scanner) < scanner_end );
+        CHECK( code.find("obj.message = ", scanner) > scanner_end );
+        CHECK( code.find("(void)read_boundary(cursor, limit);") != std::string::npos );
+        CHECK( code.find("(void)read_projected(cursor, limit);") == std::string::npos );
+    }
+
+    TEST_CASE("Runtime index support is emitted once") {
+        std::string code = generate_with_options(event_schema, {{"record-index", std::string("Event, Other")}});
+
+        CHECK( code.find("class RecordIndexError : public std::runtime_error {") != std::string::npos );
+        CHECK( code.find("struct RecordRange {") != std::string::npos );
+        CHECK( code.find("std::vector<RecordRange> split(size_t parts) const {") != std::string::npos );
+        CHECK( code.find("static std::optional<RecordIndex> load(const std::string& index_path, const std::string& source_path) {") != std::string::npos );
+        CHECK( code.find("#include <filesystem>") != std::string::npos );
+        CHECK( code.find("static Other read_at(") != std::string::npos );
+        CHECK( code.find("class RecordIndex {") == code.rfind("class RecordIndex {") );
+    }
+
+    TEST_CASE("Unknown structs are rejected") {
+        CHECK_THROWS_AS( generate_with_options(event_schema, {{"record-index", std::string("Missing")}}),
+                         codegen::codegen_error );
+    }
+
+    TEST_CASE("Requires exception error handling") {
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( generate_with_options(event_schema, {{"record-index", std::string("Event")}}, options), codegen::codegen_error );
+    }
+}
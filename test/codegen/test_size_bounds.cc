@@ -0,0 +1,75 @@
+//
+// Tests for wire size and heap bound constants (--cpp-size-bounds)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static const char* const packet_schema = R"(
+    struct Sample {
+        uint16 id;
+        uint8 count;
+        uint32 values[count];
+    };
+
+    struct Note {
+        string text;
+    };
+
+    union Either {
+        uint8 tag : tag == 1;
+        uint32 wide;
+    };
+
+    choice Kind : uint8 {
+        case 1:
+            uint16 a;
+        default:
+            uint8 b;
+    };
+)";
+
+TEST_SUITE("Codegen - Size Bounds") {
+
+    TEST_CASE("Size bound constants are not generated by default") {
+        std::string code = generate_with_options(packet_schema, {});
+
+        CHECK( code.find("min_wire_size") == std::string::npos );
+        CHECK( code.find("max_heap_bytes") == std::string::npos );
+    }
+
+    TEST_CASE("Bounded struct gets exact constants") {
+        std::string code = generate_with_options(packet_schema, {{"size-bounds", true}});
+
+        auto sample = code.find("struct Sample {");
+        REQUIRE( sample != std::string::npos );
+        auto end = code.find("};", code.find("max_heap_bytes", sample));
+        CHECK( code.find("static constexpr size_t min_wire_size = 3;", sample) < end );
+        CHECK( code.find("static constexpr size_t max_wire_size = 1023;", sample) < end );
+        CHECK( code.find("static constexpr size_t max_heap_bytes = 1020;", sample) < end );
+    }
+
+    TEST_CASE("Unbounded values use SIZE_MAX") {
+        std::string code = generate_with_options(packet_schema, {{"size-bounds", true}});
+
+        auto note = code.find("struct Note {");
+        REQUIRE( note != std::string::npos );
+        CHECK( code.find("static constexpr size_t max_wire_size = SIZE_MAX;  // unbounded", note) != std::string::npos );
+    }
+
+    TEST_CASE("Unions and choices get constants") {
+        std::string code = generate_with_options(packet_schema, {{"size-bounds", true}});
+
+        auto either = code.find("struct Either {");
+        REQUIRE( either != std::string::npos );
+        CHECK( code.find("static constexpr size_t max_wire_size = 4;", either) != std::string::npos );
+
+        auto kind = code.find("struct Kind {");
+        REQUIRE( kind != std::string::npos );
+        CHECK( code.find("static constexpr size_t max_wire_size = 3;", kind) != std::string::npos );
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Tests for relocatable decoded-object snapshot generation (--cpp-snapshot)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+TEST_SUITE("Codegen - Snapshots") {
+
+    TEST_CASE("Snapshots are not generated by default") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint16 x;
+                uint32 y;
+            };
+        )", {});
+
+        CHECK( code.find("SnapshotWriter") == std::string::npos );
+        CHECK( code.find("to_snapshot") == std::string::npos );
+        CHECK( code.find("#include <sys/mman.h>") == std::string::npos );
+    }
+
+    TEST_CASE("Scalar fields are stored at natural alignment") {
+        std::string code = generate_with_options(R"(
+            struct Point {
+                uint8 tag;
+                uint32 x;
+                uint16 y;
+            };
+        )", {{"snapshot", true}});
+
+        // Runtime support
+        CHECK( code.find("#include <sys/mman.h>") != std::string::npos );
+        CHECK( code.find("class SnapshotWriter {") != std::string::npos );
+        CHECK( code.find("class SnapshotFile {") != std::string::npos );
+
+        // tag @0, x @4, y @8; 12-byte records aligned to 4
+        CHECK( code.find("static constexpr size_t snapshot_record_size = 12;") != std::string::npos );
+        CHECK( code.find("static constexpr size_t snapshot_record_align = 4;") != std::string::npos );
+        CHECK( code.find("w.put(at + 4, this->x);") != std::string::npos );
+        CHECK( code.find("uint16_t y() const { return snapshot_load<uint16_t>(base_ + at_ + 8); }") != std::string::npos );
+        CHECK( code.find("static SnapshotView open_snapshot(const uint8_t* data, size_t size) {") != std::string::npos );
+        CHECK( code.find("std::vector<uint8_t> to_snapshot() const {") != std::string::npos );
+    }
+
+    TEST_CASE("Strings, arrays and nested structs become references and views") {
+        std::string code = generate_with_options(R"(
+            struct Symbol {
+                uint32 address;
+                string name;
+            };
+
+            struct Table {
+                uint16 count;
+                Symbol symbols[count];
+                uint32 hashes[count];
+                uint8 magic[4];
+                string note;
+            };
+        )", {{"snapshot", true}});
+
+        // Table: count @0, symbols @8 (ref), hashes @24 (ref), magic @40, note @48 (ref)
+        CHECK( code.find("SnapshotRecords<Symbol> symbols() const { return snapshot_records<Symbol>(base_, size_, at_ + 8); }") != std::string::npos );
+        CHECK( code.find("SnapshotArray<uint32_t> hashes() const { return snapshot_array<uint32_t>(base_, size_, at_ + 24); }") != std::string::npos );
+        CHECK( code.find("SnapshotArray<uint8_t> magic() const { return SnapshotArray<uint8_t>(base_ + at_ + 40, 4); }") != std::string::npos );
+        CHECK( code.find("std::string_view note() const { return snapshot_string(base_, size_, at_ + 48); }") != std::string::npos );
+        CHECK( code.find("w.put_array(at + 24, this->hashes.data(), this->hashes.size());") != std::string::npos );
+        CHECK( code.find("this->symbols[i].write_snapshot(w, elements_at + i * Symbol::snapshot_record_size);") != std::string::npos );
+    }
+
+    TEST_CASE("Layout hash changes with the schema") {
+        auto hash_of = [](const std::string& code) {
+            auto pos = code.find("snapshot_layout_hash = ");
+            REQUIRE( pos != std::string::npos );
+            return code.substr(pos, code.find(';', pos) - pos);
+        };
+
+        std::string a = generate_with_options("struct P { uint16 x; uint16 y; };", {{"snapshot", true}});
+        std::string b = generate_with_options("struct P { uint16 x; uint32 y; };", {{"snapshot", true}});
+        std::string c = generate_with_options("struct P { uint16 x; uint16 y; };", {{"snapshot", true}});
+
+        CHECK( hash_of(a) != hash_of(b) );
+        CHECK( hash_of(a) == hash_of(c) );
+    }
+
+    TEST_CASE("Types without a snapshot layout are skipped") {
+        std::string code = generate_with_options(R"(
+            struct Wide {
+                little u16string text;
+            };
+        )", {{"snapshot", true}});
+
+        CHECK( code.find("// No snapshot support") != std::string::npos );
+        CHECK( code.find("Wide::SnapshotView") == std::string::npos );
+    }
+}
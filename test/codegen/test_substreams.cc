@@ -0,0 +1,121 @@
+//
+// Tests for @xor / @rol / @ror / @zlib substream fields
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <datascript/codegen/projection.hh>
+#include <datascript/codegen/datascript/datascript_renderer.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source) {
+    return generate_with_options(source, {});
+}
+
+static const char* const container_schema = R"(
+    struct Header {
+        uint16 version;
+        uint8 flags;
+    };
+
+    struct Container {
+        uint16 length;
+        uint8 key;
+        @xor(length, key)
+        Header header;
+        @ror(16, 3)
+        uint8 scrambled[];
+        uint32 packed_size;
+        @zlib(packed_size)
+        uint8 body[];
+    };
+)";
+
+TEST_SUITE("Codegen - Substreams") {
+
+    TEST_CASE("Substream fields capture their region and decode on access") {
+        std::string code = generate_cpp(container_schema);
+
+        CHECK( code.find("Substream<Header> header;") != std::string::npos );
+        CHECK( code.find("Substream<std::vector<uint8_t>> scrambled;") != std::string::npos );
+        CHECK( code.find("Substream<std::vector<uint8_t>> body;") != std::string::npos );
+        CHECK( code.find("read_substream(obj.header, data, end, static_cast<size_t>(obj.length), "
+                         "ByteTransform::Xor, static_cast<uint8_t>(obj.key));") != std::string::npos );
+        CHECK( code.find("read_substream(obj.scrambled, data, end, static_cast<size_t>(16), "
+                         "ByteTransform::RotateRight, static_cast<uint8_t>(3));") != std::string::npos );
+        CHECK( code.find("read_substream(obj.body, data, end, static_cast<size_t>(obj.packed_size), "
+                         "ByteTransform::Zlib, 0);") != std::string::npos );
+
+        // Lazy decoding with SIMD kernels and streaming inflate
+        CHECK( code.find("class Substream {") != std::string::npos );
+        CHECK( code.find("const T& get() const {") != std::string::npos );
+        CHECK( code.find("inline void undo_byte_transform(") != std::string::npos );
+        CHECK( code.find("_mm_xor_si128") != std::string::npos );
+        CHECK( code.find("inline std::vector<uint8_t> inflate_substream(") != std::string::npos );
+    }
+
+    TEST_CASE("Inflated zlib substreams are capped") {
+        std::string code = generate_cpp(container_schema);
+        CHECK( code.find("constexpr size_t substream_max_inflate = 67108864;") != std::string::npos );
+        CHECK( code.find("throw std::runtime_error(\"zlib substream too large\");") != std::string::npos );
+
+        std::string small = generate_with_options(container_schema, {{"substream-max-inflate", int64_t{4096}}});
+        CHECK( small.find("constexpr size_t substream_max_inflate = 4096;") != std::string::npos );
+
+        codegen::CppRenderer renderer;
+        CHECK_THROWS_AS( renderer.set_option("substream-max-inflate", int64_t{-1}), std::invalid_argument );
+    }
+
+    TEST_CASE("zlib is included only when a substream uses it") {
+        std::string with_zlib = generate_cpp(container_schema);
+        CHECK( with_zlib.find("#include <zlib.h>") != std::string::npos );
+
+        std::string xor_only = generate_cpp(R"(
+            struct Blob {
+                @xor(8, 0xFF)
+                uint8 bytes[];
+            };
+        )");
+        CHECK( xor_only.find("class Substream {") != std::string::npos );
+        CHECK( xor_only.find("#include <zlib.h>") == std::string::npos );
+        CHECK( xor_only.find("inflate_substream") == std::string::npos );
+
+        std::string plain = generate_cpp(R"(
+            struct Blob {
+                uint8 bytes[8];
+            };
+        )");
+        CHECK( plain.find("Substream") == std::string::npos );
+    }
+
+    TEST_CASE("Substream structs have no fixed wire size") {
+        auto ir_module = build_bundle(container_schema);
+
+        REQUIRE( ir_module.structs.size() == 2 );
+        CHECK( codegen::fixed_wire_size(&ir_module, ir_module.structs[0]).has_value() );
+        CHECK_FALSE( codegen::fixed_wire_size(&ir_module, ir_module.structs[1]).has_value() );
+    }
+
+    TEST_CASE("Freestanding profile rejects substreams") {
+        auto ir_module = build_bundle(container_schema);
+
+        codegen::CppRenderer renderer;
+        renderer.set_option("profile", std::string("freestanding"));
+        CHECK_THROWS_AS( renderer.render_module(ir_module, codegen::RenderOptions{}), codegen::codegen_error );
+    }
+
+    TEST_CASE("DataScript renderer writes substream directives back") {
+        auto ir_module = build_bundle(container_schema);
+
+        codegen::DataScriptRenderer renderer;
+        std::string source = renderer.render_module(ir_module, codegen::RenderOptions{});
+
+        CHECK( source.find("@xor(length, key)") != std::string::npos );
+        CHECK( source.find("@ror(16, 3)") != std::string::npos );
+        CHECK( source.find("@zlib(packed_size)") != std::string::npos );
+    }
+}
@@ -263,3 +263,81 @@ TEST_CASE("Function with 64-bit return type") {
     CHECK( code.find("uint64_t get_timestamp() const {") != std::string::npos );
     CHECK( code.find("return timestamp;") != std::string::npos );
 }
+
+TEST_CASE("Pure function used repeatedly is evaluated once after its inputs") {
+    std::string source = R"(
+        struct Packet {
+            uint16 count;
+            uint16 width;
+            uint8 payload[payload_size()];
+            uint8 trailer if payload_size() > 4;
+
+            function uint32 payload_size() {
+                return count * width;
+            }
+        };
+    )";
+
+    std::string code = generate_code(source);
+
+    auto width = code.find("obj.width = read_uint16_le(data, end);");
+    auto memo = code.find("const uint32_t _memo_payload_size = obj.payload_size();");
+    REQUIRE( width != std::string::npos );
+    REQUIRE( memo != std::string::npos );
+    CHECK( width < memo );
+
+    // Later uses in the same reader read the memo
+    auto reader_end = code.find("\n        }\n", memo);
+    REQUIRE( reader_end != std::string::npos );
+    CHECK( code.find("if ((_memo_payload_size > 4)) {", memo) < reader_end );
+    CHECK( code.find("obj.payload_size()", code.find('\n', memo)) > reader_end );
+
+    // The function itself is unchanged
+    CHECK( code.find("uint32_t payload_size() const {") != std::string::npos );
+}
+
+TEST_CASE("Pure function behind a guard is not evaluated early") {
+    std::string source = R"(
+        struct Ratio {
+            uint8 parts;
+            uint8 spread[share()] if parts != 0;
+            uint8 bonus if parts != 0 && share() > 2;
+            uint8 tail;
+            uint8 extra[share()] if tail > share();
+
+            function uint8 share() {
+                return 12 / parts;
+            }
+        };
+    )";
+
+    std::string code = generate_code(source);
+
+    // Guarded and short-circuited uses leave the calls in place ...
+    auto guard = code.find("if ((obj.parts != 0)) {");
+    REQUIRE( guard != std::string::npos );
+    CHECK( code.find("_memo_share") > code.find("obj.tail = read_uint8(data, end);") );
+
+    // ... until a condition calls it on every input
+    auto memo = code.find("const uint8_t _memo_share = obj.share();");
+    REQUIRE( memo != std::string::npos );
+    CHECK( code.find("if ((obj.tail > _memo_share)) {", memo) != std::string::npos );
+}
+
+TEST_CASE("Function used once is called directly") {
+    std::string source = R"(
+        struct Header {
+            uint8 flags;
+            uint8 extra if is_extended();
+
+            function bool is_extended() {
+                return (flags & 1) != 0;
+            }
+        };
+    )";
+
+    std::string code = generate_code(source);
+
+    CHECK( code.find("_memo_") == std::string::npos );
+    CHECK( code.find("if (obj.is_extended()) {") != std::string::npos );
+}
@@ -0,0 +1,72 @@
+//
+// Tests for UTF-8 decoding of u16string/u32string fields (--cpp-utf8-strings)
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+TEST_SUITE("Codegen - UTF-8 Strings") {
+
+    TEST_CASE("Wide strings keep their types by default") {
+        std::string code = generate_with_options(R"(
+            struct Names {
+                u16string short_name;
+                u32string long_name;
+            };
+        )", {});
+
+        CHECK( code.find("std::u16string short_name;") != std::string::npos );
+        CHECK( code.find("std::u32string long_name;") != std::string::npos );
+        CHECK( code.find("read_u16string_le(data, end)") != std::string::npos );
+        CHECK( code.find("_utf8") == std::string::npos );
+        CHECK( code.find("#include <emmintrin.h>") == std::string::npos );
+    }
+
+    TEST_CASE("Wide strings decode to UTF-8 std::string") {
+        std::string code = generate_with_options(R"(
+            struct Names {
+                little u16string short_name;
+                big u16string title;
+                u32string long_name;
+                big u32string tag;
+                u16string aliases[2];
+            };
+        )", {{"utf8-strings", true}});
+
+        // Field types
+        CHECK( code.find("std::string short_name;") != std::string::npos );
+        CHECK( code.find("std::string long_name;") != std::string::npos );
+        CHECK( code.find("std::array<std::string, 2> aliases;") != std::string::npos );
+        CHECK( code.find("std::u16string short_name;") == std::string::npos );
+
+        // Readers follow the declared byte order
+        CHECK( code.find("obj.short_name = read_u16string_le_utf8(data, end);") != std::string::npos );
+        CHECK( code.find("obj.title = read_u16string_be_utf8(data, end);") != std::string::npos );
+        CHECK( code.find("obj.long_name = read_u32string_le_utf8(data, end);") != std::string::npos );
+        CHECK( code.find("obj.tag = read_u32string_be_utf8(data, end);") != std::string::npos );
+        CHECK( code.find("obj.aliases[i] = read_u16string_le_utf8(data, end);") != std::string::npos );
+    }
+
+    TEST_CASE("Transcoding runtime has SIMD paths and validation") {
+        std::string code = generate_with_options(R"(
+            struct Label {
+                u16string text;
+            };
+        )", {{"utf8-strings", true}});
+
+        CHECK( code.find("#include <emmintrin.h>") != std::string::npos );
+        CHECK( code.find("#include <arm_neon.h>") != std::string::npos );
+        CHECK( code.find("inline std::string utf16_to_utf8(const uint8_t* src, size_t units) {") != std::string::npos );
+        CHECK( code.find("inline std::string utf32_to_utf8(const uint8_t* src, size_t units) {") != std::string::npos );
+        CHECK( code.find("_mm_packus_epi16") != std::string::npos );
+        CHECK( code.find("vmovn_u16") != std::string::npos );
+        CHECK( code.find("Invalid UTF-16: unpaired high surrogate") != std::string::npos );
+        CHECK( code.find("Invalid UTF-16: unpaired low surrogate") != std::string::npos );
+        CHECK( code.find("Invalid UTF-32 code point") != std::string::npos );
+        CHECK( code.find("UTF-16 string not null-terminated before end of buffer") != std::string::npos );
+    }
+}
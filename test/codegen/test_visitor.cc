@@ -0,0 +1,119 @@
+//
+// Tests for --cpp-visitor (event-driven parse_<Type>(data, end, visitor))
+//
+
+#include <doctest/doctest.h>
+#include "codegen_test_helpers.hh"
+#include <datascript/codegen.hh>
+#include <string>
+
+using namespace datascript;
+using namespace datascript::codegen_test;
+
+static std::string generate_cpp(const std::string& source, bool visitor) {
+    return generate_with_options(source, {{"visitor", visitor}});
+}
+
+static const char* const record_schema = R"(
+    struct Header {
+        uint8 len;
+    };
+
+    struct Record {
+        uint32 magic : magic == 0xCAFEBABE;
+        Header header;
+        uint16 values[header.len];
+        string name;
+        uint32 stamp;
+    };
+
+    union Frame {
+        {
+            uint8 tag : tag == 1;
+            uint32 value;
+        } tagged;
+        uint16 plain;
+    };
+)";
+
+TEST_SUITE("Codegen - Visitor Decoding") {
+
+    TEST_CASE("Tags and parse functions for every type") {
+        std::string code = generate_cpp(record_schema, true);
+
+        CHECK( code.find("concept handles = requires (V& v, const typename Tag::value_type& value) {")
+               != std::string::npos );
+        CHECK( code.find("namespace fields::Record {") != std::string::npos );
+        CHECK( code.find("struct name {\n"
+                         "        using value_type = std::string_view;\n"
+                         "        static constexpr std::string_view field_name = \"name\";\n"
+                         "        static constexpr size_t field_index = 3;") != std::string::npos );
+        CHECK( code.find("using value_type = ::test::Header;") != std::string::npos );
+        CHECK( code.find("void parse_Record(const uint8_t*& data, const uint8_t* end, Visitor& visitor);")
+               != std::string::npos );
+        CHECK( code.find("void parse_Frame(const uint8_t*& data, const uint8_t* end, Visitor& visitor, "
+                         "const ParentT* parent = nullptr);") != std::string::npos );
+    }
+
+    TEST_CASE("Unhandled fields are skipped; fields later expressions read are kept") {
+        std::string code = generate_cpp(record_schema, true);
+
+        // Only the constrained field and the length source are stored
+        CHECK( code.find("struct {\n"
+                         "            uint32_t magic{};\n"
+                         "            Header header{};\n"
+                         "        } obj;") != std::string::npos );
+        CHECK( code.find("if constexpr (visit::handles<fields::Record::stamp, Visitor>) {\n"
+                         "            visit::field<fields::Record::stamp>(visitor, read_uint32_le(data, end));\n"
+                         "        } else {\n"
+                         "            skip_bytes(data, end, 4);\n"
+                         "        }") != std::string::npos );
+        CHECK( code.find("skip_array(data, end, count, 2);") != std::string::npos );
+        CHECK( code.find("visit::field<fields::Record::name>(visitor, visit::read_string_view(data, end));")
+               != std::string::npos );
+        CHECK( code.find("parse_Header(nested_pos0, end, visitor);") != std::string::npos );
+
+        // The visitor sees only the union branch that matched
+        CHECK( code.find("if (visit::try_branch([&] { parse_Frame_as_tagged(trial_data, end, trial, parent); })) {\n"
+                         "                visit::begin_choice<fields::Frame::tagged>(visitor);")
+               != std::string::npos );
+    }
+
+    TEST_CASE("Union case conditions read the branch just decoded") {
+        std::string code = generate_cpp(R"(
+            struct Inner {
+                uint8 kind;
+            };
+
+            union Body {
+                Inner inner : inner.kind == 1;
+                {
+                    uint8 tag;
+                    uint8 rest;
+                } block : tag == 2;
+            };
+        )", true);
+
+        auto inner = code.find("void parse_Body_as_inner(");
+        REQUIRE( inner != std::string::npos );
+        CHECK( code.find("obj.inner = Inner::read(data, end);", inner) != std::string::npos );
+        CHECK( code.find("if (!((obj.inner.kind == 1))) {", inner) != std::string::npos );
+
+        auto block = code.find("void parse_Body_as_block(");
+        REQUIRE( block != std::string::npos );
+        CHECK( code.find("if (!((obj.block.tag == 2))) {", block) != std::string::npos );
+    }
+
+    TEST_CASE("Disabled by default; requires exceptions") {
+        std::string code = generate_cpp(record_schema, false);
+        CHECK( code.find("namespace visit") == std::string::npos );
+        CHECK( code.find("parse_Record") == std::string::npos );
+
+        auto ir_module = build_bundle(record_schema);
+        codegen::CppRenderer renderer;
+        renderer.set_option("visitor", true);
+        codegen::RenderOptions options;
+        options.use_exceptions = false;
+        CHECK_THROWS_AS( renderer.render_module(ir_module, options), codegen::codegen_error );
+    }
+}
@@ -585,14 +585,12 @@ struct DataBlock {
             // Verify vector declaration
             CHECK(cpp_code.find("std::vector<uint8_t> remaining_bytes;") != std::string::npos);
 
-            // Verify EOF-based reading
+            // Verify EOF-based reading: the remaining bytes size the array,
+            // then one bulk read fills it
             CHECK(cpp_code.find("// Read until end of data") != std::string::npos);
-            CHECK(cpp_code.find("while (data < end) {") != std::string::npos);
-            CHECK(cpp_code.find("obj.remaining_bytes.push_back(read_uint8(data, end));") != std::string::npos);
-
-            // Verify no resize call (unbounded arrays don't resize)
-            size_t remaining_resize = cpp_code.find("obj.remaining_bytes.resize");
-            CHECK(remaining_resize == std::string::npos);
+            CHECK(cpp_code.find("obj.remaining_bytes.resize(static_cast<size_t>(end - data));") != std::string::npos);
+            CHECK(cpp_code.find("read_array_le(data, end, obj.remaining_bytes.data(), obj.remaining_bytes.size());") != std::string::npos);
+            CHECK(cpp_code.find("while (data < end) {") == std::string::npos);
         }
     }
 
@@ -621,7 +619,8 @@ struct IntStream {
 
         // Verify uint32 unbounded array
         CHECK(cpp_code.find("std::vector<uint32_t> values;") != std::string::npos);
-        CHECK(cpp_code.find("obj.values.push_back(read_uint32_le(data, end));") != std::string::npos);
+        CHECK(cpp_code.find("obj.values.resize((static_cast<size_t>(end - data) + 4 - 1) / 4);") != std::string::npos);
+        CHECK(cpp_code.find("read_array_le(data, end, obj.values.data(), obj.values.size());") != std::string::npos);
     }
 
     TEST_CASE("Unbounded array with big-endian elements") {
@@ -647,7 +646,7 @@ struct BigEndianStream {
         std::string cpp_code = codegen::generate_cpp_header(ir, opts);
 
         // Verify big-endian reading
-        CHECK(cpp_code.find("obj.values.push_back(read_uint16_be(data, end));") != std::string::npos);
+        CHECK(cpp_code.find("read_array_be(data, end, obj.values.data(), obj.values.size());") != std::string::npos);
     }
 
     TEST_CASE("Unbounded string array") {
@@ -742,10 +741,59 @@ struct Stream {
         CHECK(cpp_code.find("static Stream read(const uint8_t*& data, const uint8_t* end)") != std::string::npos);
 
         // Verify unbounded array in exception mode
-        CHECK(cpp_code.find("while (data < end) {") != std::string::npos);
-        CHECK(cpp_code.find("obj.bytes.push_back(read_uint8(data, end));") != std::string::npos);
+        CHECK(cpp_code.find("obj.bytes.resize(static_cast<size_t>(end - data));") != std::string::npos);
+        CHECK(cpp_code.find("read_array_le(data, end, obj.bytes.data(), obj.bytes.size());") != std::string::npos);
 
         // Should not have read_safe with exceptions_only
         CHECK(cpp_code.find("read_safe(") == std::string::npos);
     }
+
+    TEST_CASE("Unbounded arrays reserve capacity from the remaining bytes") {
+        const char* schema = R"(
+struct Point { uint16 x; uint16 y; };
+struct Entry { uint32 id; string name; };
+
+struct Track {
+    uint8 kind;
+    Point points[];
+};
+
+struct Directory {
+    Entry entries[];
+};
+
+struct Blob {
+    uint8 bytes[];
+};
+)";
+
+        auto parsed = parse_datascript(std::string(schema));
+        module_set modules;
+        modules.main.file_path = "test.ds";
+        modules.main.module = std::move(parsed);
+        modules.main.package_name = "test";
+
+        auto analysis = semantic::analyze(modules);
+        REQUIRE_FALSE(analysis.has_errors());
+
+        auto ir = ir::build_ir(analysis.analyzed.value());
+
+        codegen::cpp_options opts;
+        opts.namespace_name = "test";
+        opts.error_handling = codegen::cpp_options::exceptions_only;
+        std::string cpp_code = codegen::generate_cpp_header(ir, opts);
+
+        // Fixed-size elements: exact count
+        size_t points = cpp_code.find("reserve_remaining(obj.points, data, end, 4);");
+        REQUIRE(points != std::string::npos);
+        CHECK(cpp_code.find("while (data < end) {", points) != std::string::npos);
+
+        // Integer elements skip the loop: one bulk read
+        CHECK(cpp_code.find("reserve_remaining(obj.bytes") == std::string::npos);
+        CHECK(cpp_code.find("read_array_le(data, end, obj.bytes.data(), obj.bytes.size());") != std::string::npos);
+
+        // Variable-size elements: bounded by the minimum wire size, capped
+        CHECK(cpp_code.find("reserve_remaining(obj.entries, data, end, 5, 4096);") != std::string::npos);
+        CHECK(cpp_code.find("inline void reserve_remaining(Vec& out, const uint8_t* p, const uint8_t* end, size_t wire_size,") != std::string::npos);
+    }
 }
@@ -0,0 +1,325 @@
+//
+// Tests for the synthetic instance generator (ir::instance_generator)
+//
+
+#include <doctest/doctest.h>
+#include <datascript/parser.hh>
+#include <datascript/semantic.hh>
+#include <datascript/ir_builder.hh>
+#include <datascript/ir_synth.hh>
+#include <string>
+#include <vector>
+
+using namespace datascript;
+
+namespace {
+
+ir::bundle build_bundle(const std::string& source) {
+    auto parsed = parse_datascript(std::string(source));
+
+    module_set modules;
+    modules.main.module = std::move(parsed);
+    modules.main.file_path = "test.ds";
+    modules.main.package_name = "test";
+
+    auto analysis = semantic::analyze(modules);
+    REQUIRE_FALSE( analysis.has_errors() );
+
+    return ir::build_ir(analysis.analyzed.value());
+}
+
+std::vector<uint8_t> generate(const ir::bundle& bundle, const std::string& type, uint64_t seed) {
+    ir::instance_generator generator(bundle, {.seed = seed});
+    std::vector<uint8_t> out;
+    generator.generate(type, out);
+    return out;
+}
+
+uint32_t le32(const std::vector<uint8_t>& b, size_t at) {
+    return b[at] | (b[at + 1] << 8) | (b[at + 2] << 16) | (static_cast<uint32_t>(b[at + 3]) << 24);
+}
+
+} // anonymous namespace
+
+TEST_SUITE("IR - Synthetic Instances") {
+
+    TEST_CASE("Equal seeds give equal output") {
+        auto bundle = build_bundle(R"(
+            struct Record {
+                uint16 count;
+                uint32 values[count];
+                string name;
+            };
+        )");
+
+        ir::instance_generator a(bundle, {.seed = 42});
+        ir::instance_generator b(bundle, {.seed = 42});
+        ir::instance_generator c(bundle, {.seed = 43});
+        std::vector<uint8_t> out_a, out_b, out_c;
+        a.generate_records("Record", 50, out_a);
+        b.generate_records("Record", 50, out_b);
+        c.generate_records("Record", 50, out_c);
+
+        CHECK( out_a == out_b );
+        CHECK( out_a != out_c );
+
+        std::vector<uint8_t> again;
+        a.reseed(42);
+        a.generate_records("Record", 50, again);
+        CHECK( again == out_a );
+    }
+
+    TEST_CASE("Constraints and array lengths hold") {
+        auto bundle = build_bundle(R"(
+            struct Packet {
+                uint32 magic : magic == 0xCAFEBABE;
+                uint8 kind : kind >= 3 && kind <= 5;
+                big uint16 count;
+                uint8 data[count];
+            };
+        )");
+
+        ir::synth_options options;
+        options.field_lengths["Packet.data"] = ir::length_distribution::fixed(5);
+        ir::instance_generator generator(bundle, options);
+
+        for (int i = 0; i < 20; ++i) {
+            std::vector<uint8_t> out;
+            CHECK( generator.generate("Packet", out) == 12 );
+            REQUIRE( out.size() == 12 );
+            CHECK( le32(out, 0) == 0xCAFEBABE );
+            CHECK( out[4] >= 3 );
+            CHECK( out[4] <= 5 );
+            CHECK( out[5] == 0 );
+            CHECK( out[6] == 5 );
+        }
+    }
+
+    TEST_CASE("Enum fields take declared values") {
+        auto bundle = build_bundle(R"(
+            enum uint8 Color { RED = 1, GREEN = 2, BLUE = 9 };
+            struct Pixel {
+                Color color;
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 30; ++seed) {
+            auto out = generate(bundle, "Pixel", seed);
+            REQUIRE( out.size() == 1 );
+            CHECK( (out[0] == 1 || out[0] == 2 || out[0] == 9) );
+        }
+    }
+
+    TEST_CASE("Bitfield counts size later arrays") {
+        auto bundle = build_bundle(R"(
+            struct Packed {
+                bit:4 count;
+                bit:4 kind;
+                uint8 data[count];
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 30; ++seed) {
+            auto out = generate(bundle, "Packed", seed);
+            REQUIRE( !out.empty() );
+            CHECK( out.size() == 1u + (out[0] & 0x0F) );
+        }
+    }
+
+    TEST_CASE("External selectors pick a case") {
+        auto bundle = build_bundle(R"(
+            choice Payload(uint8 tag) on tag {
+                case 1: uint32 number;
+                case 2: uint16 word;
+            };
+            struct Message {
+                uint8 tag;
+                Payload(tag) body;
+            };
+        )");
+
+        bool seen[3] = {false, false, false};
+        for (uint64_t seed = 0; seed < 40; ++seed) {
+            auto out = generate(bundle, "Message", seed);
+            REQUIRE( !out.empty() );
+            REQUIRE( (out[0] == 1 || out[0] == 2) );
+            CHECK( out.size() == (out[0] == 1 ? 5u : 3u) );
+            seen[out[0]] = true;
+        }
+        CHECK( seen[1] );
+        CHECK( seen[2] );
+    }
+
+    TEST_CASE("Inline discriminators are encoded as the reader peeks them") {
+        auto bundle = build_bundle(R"(
+            choice Value : uint8 {
+                case 0x01: uint16 small;
+                case 0xFF: {
+                    uint8 marker;
+                    uint32 wide;
+                } block;
+                default: uint8 raw;
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 60; ++seed) {
+            auto out = generate(bundle, "Value", seed);
+            REQUIRE( !out.empty() );
+            if (out[0] == 0x01) {
+                CHECK( out.size() == 3 );      // Discriminator, then the case
+            } else if (out[0] == 0xFF) {
+                CHECK( out.size() == 5 );      // The block re-reads the discriminator
+            } else {
+                CHECK( out.size() == 1 );      // Default: the discriminator is the data
+            }
+        }
+
+        ir::instance_generator generator(bundle);
+        std::vector<uint8_t> out;
+        CHECK_THROWS_AS( generator.generate("Missing", out), ir::synth_error );
+    }
+
+    TEST_CASE("Unions are encoded so that trial decoding picks the generated branch") {
+        auto bundle = build_bundle(R"(
+            union Frame {
+                {
+                    uint8 magic : magic == 0xAA;
+                    uint32 value;
+                } tagged;
+                uint16 plain;
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 40; ++seed) {
+            auto out = generate(bundle, "Frame", seed);
+            REQUIRE( (out.size() == 5 || out.size() == 2) );
+            if (out.size() == 5) {
+                CHECK( out[0] == 0xAA );
+            } else {
+                CHECK( out[0] != 0xAA );
+            }
+        }
+    }
+
+    TEST_CASE("Labels and alignment are relative to the struct") {
+        auto bundle = build_bundle(R"(
+            struct Indexed {
+                uint32 offset;
+                uint8 tag;
+                offset:
+                uint16 payload;
+                align(8):
+                uint64 aligned;
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 20; ++seed) {
+            auto out = generate(bundle, "Indexed", seed);
+            REQUIRE( out.size() >= 4 );
+            const uint32_t offset = le32(out, 0);
+            CHECK( offset >= 5 );
+            CHECK( offset <= 5 + 8 );
+            const size_t aligned_at = (offset + 2 + 7) / 8 * 8;
+            CHECK( out.size() == aligned_at + 8 );
+        }
+    }
+
+    TEST_CASE("Labels can name offsets inside nested structs") {
+        auto bundle = build_bundle(R"(
+            struct Stamp {
+                uint32 seconds;
+                uint32 micros;
+            };
+            struct Header {
+                uint32 magic;
+                uint32 data_offset;
+                uint16 meta_offset;
+                Stamp created;
+            };
+            struct File {
+                Header header;
+                uint8 kind;
+                header.data_offset:
+                uint32 data;
+                align(8):
+                header.meta_offset:
+                uint64 meta;
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 20; ++seed) {
+            auto out = generate(bundle, "File", seed);
+            REQUIRE( out.size() >= 19 );
+            const uint32_t data_offset = le32(out, 4);
+            const uint32_t meta_offset = out[8] | (out[9] << 8);
+            CHECK( data_offset >= 19 );
+            CHECK( data_offset <= 19 + 8 );
+            CHECK( meta_offset >= data_offset + 4 );
+            CHECK( out.size() == (meta_offset + 7) / 8 * 8 + 8 );
+        }
+    }
+
+    TEST_CASE("Substream sizes and transforms match the content") {
+        auto bundle = build_bundle(R"(
+            struct Inner {
+                uint16 id : id == 0x1234;
+                uint8 flags;
+            };
+            struct Sealed {
+                uint16 length;
+                uint8 key;
+                @xor(length, key)
+                Inner inner;
+                uint32 packed_size;
+                @zlib(packed_size)
+                uint8 body[];
+            };
+        )");
+
+        for (uint64_t seed = 0; seed < 20; ++seed) {
+            auto out = generate(bundle, "Sealed", seed);
+            REQUIRE( out.size() >= 10 );
+            CHECK( (out[0] | (out[1] << 8)) == 3 );
+            const uint8_t key = out[2];
+            CHECK( (out[3] ^ key) == 0x34 );
+            CHECK( (out[4] ^ key) == 0x12 );
+
+            // Stored-block zlib stream: header, then the blocks
+            const uint32_t packed = le32(out, 6);
+            CHECK( out.size() == 10 + packed );
+            CHECK( out[10] == 0x78 );
+        }
+    }
+
+    TEST_CASE("Record buffers and their limits") {
+        auto bundle = build_bundle(R"(
+            struct Fixed {
+                uint32 id;
+                uint16 value;
+            };
+            struct Tail {
+                uint8 kind;
+                uint8 rest[];
+            };
+            struct Impossible {
+                uint8 low;
+                uint8 high : high > low && high < low;
+            };
+        )");
+
+        ir::instance_generator generator(bundle);
+        std::vector<uint8_t> out;
+        CHECK( generator.generate_records("Fixed", 100, out) == 600 );
+        CHECK( out.size() == 600 );
+
+        // T[] reads to the end of the input: one instance is fine, a
+        // record buffer is not
+        std::vector<uint8_t> tail;
+        CHECK_NOTHROW( generator.generate_records("Tail", 1, tail) );
+        CHECK_THROWS_AS( generator.generate_records("Tail", 2, tail), ir::synth_error );
+
+        std::vector<uint8_t> impossible;
+        CHECK_THROWS_AS( generator.generate("Impossible", impossible), ir::synth_error );
+        CHECK( impossible.empty() );
+    }
+}
@@ -116,6 +116,41 @@ TEST_SUITE("Module Loading") {
         fs::remove(temp_path);
     }
 
+    TEST_CASE("parse_datascript(path) - files ending at page boundaries") {
+        // Mapped input relies on zero padding after the last byte; check
+        // sizes around common page sizes, including an exact multiple
+        std::string temp_path = get_test_data_path() + "/temp_page_boundary.ds";
+        const std::string decl = "const uint32 VALUE = 7;";
+
+        for (size_t size : {decl.size(), size_t{4095}, size_t{4096}, size_t{16384}}) {
+            {
+                std::ofstream out(temp_path, std::ios::binary);
+                out << decl << std::string(size - decl.size(), ' ');
+            }
+            REQUIRE(fs::file_size(temp_path) == size);
+
+            auto mod = parse_datascript(fs::path(temp_path));
+            REQUIRE(mod.constants.size() == 1);
+            CHECK(mod.constants[0].name == "VALUE");
+        }
+
+        // Unterminated comment running into the padding is still an error
+        {
+            std::ofstream out(temp_path, std::ios::binary);
+            out << decl << std::string(4096 - decl.size() - 2, ' ') << "/*";
+        }
+        CHECK_THROWS(parse_datascript(fs::path(temp_path)));
+
+        fs::remove(temp_path);
+    }
+
+    TEST_CASE("parse_datascript(path) - missing file") {
+        CHECK_THROWS_AS(
+            parse_datascript(fs::path(get_test_data_path() + "/does_not_exist.ds")),
+            std::runtime_error
+        );
+    }
+
     TEST_CASE("import_not_found_error - message formatting") {
         std::vector<std::string> searched_paths = {
             "/path/one/foo/bar.ds",
@@ -0,0 +1,274 @@
+//
+// Tests for Phase 8: Decode Cost Analysis
+//
+
+#include <doctest/doctest.h>
+#include <datascript/parser.hh>
+#include <datascript/semantic.hh>
+
+using namespace datascript;
+using namespace datascript::semantic;
+
+namespace {
+    // Helper: create a module_set from a single source string
+    module_set make_module_set(const std::string& source) {
+        auto main_mod = parse_datascript(source);
+
+        module_set modules;
+        modules.main.module = std::move(main_mod);
+        modules.main.file_path = "<test>";
+        modules.main.package_name = "";
+
+        return modules;
+    }
+
+    analysis_result analyze_with_costs(module_set& modules) {
+        analysis_options opts;
+        opts.check_decode_cost = true;
+        return analyze(modules, opts);
+    }
+
+    size_t count_code(const analysis_result& result, const char* code) {
+        size_t count = 0;
+        for (const auto& warning : result.get_warnings()) {
+            if (warning.code == std::string(code)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    const type_decode_cost* find_cost(const analysis_result& result, const std::string& name) {
+        for (const auto& entry : result.analyzed->decode_costs) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+}
+
+TEST_SUITE("Semantic Analysis - Decode Cost") {
+    TEST_CASE("Disabled by default") {
+        auto modules = make_module_set(R"(
+            struct Item { uint16 id; };
+            struct List { Item[] items; };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        CHECK(result.analyzed->decode_costs.empty());
+        CHECK(count_code(result, diag_codes::W_UNBOUNDED_STRUCT_ARRAY) == 0);
+    }
+
+    TEST_CASE("Struct costs count reads, allocations and runtime loops") {
+        auto modules = make_module_set(R"(
+            struct Point { uint16 x; uint16 y; };
+
+            struct Shape {
+                uint8 count;
+                Point[count] points;
+                string name;
+                uint32 flags : flags < 16;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        REQUIRE(result.analyzed->decode_costs.size() == 2);
+
+        auto* point = find_cost(result, "Point");
+        REQUIRE(point != nullptr);
+        CHECK(point->kind == "struct");
+        CHECK(point->cost.checked_reads == 2);
+        CHECK(point->cost.allocations == 0);
+        CHECK(point->cost.runtime_loops == 0);
+
+        auto* shape = find_cost(result, "Shape");
+        REQUIRE(shape != nullptr);
+        CHECK(shape->cost.checked_reads == 5);  // count, one point (x, y), name, flags
+        CHECK(shape->cost.allocations == 2);    // points vector, name
+        CHECK(shape->cost.runtime_loops == 2);  // points, name scan
+        CHECK(shape->cost.throw_sites == 6);    // 5 reads + flags constraint
+    }
+
+    TEST_CASE("Constant arrays scale with their length") {
+        auto modules = make_module_set(R"(
+            const uint32 N = 4;
+            struct Block { uint32[N] words; };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* block = find_cost(result, "Block");
+        REQUIRE(block != nullptr);
+        CHECK(block->cost.checked_reads == 4);
+        CHECK(block->cost.runtime_loops == 0);
+    }
+
+    TEST_CASE("Choices count comparisons plus their most expensive case") {
+        auto modules = make_module_set(R"(
+            choice Value : uint8 {
+                case 1:
+                    uint8 small;
+                case 2:
+                case 3:
+                    { uint32 a; uint32 b; } pair;
+                default:
+                    uint16 other;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* value = find_cost(result, "Value");
+        REQUIRE(value != nullptr);
+        CHECK(value->kind == "choice");
+        CHECK(value->cost.checked_reads == 3);  // Discriminator + widest case
+        CHECK(value->cost.branches == 3);       // 1, 2, 3
+    }
+
+    TEST_CASE("WARNING: Unbounded array of structs") {
+        auto modules = make_module_set(R"(
+            struct Record { uint32 id; };
+            struct Log {
+                Record[] records;
+                uint8[] tail;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        CHECK_FALSE(result.has_errors());
+        CHECK(count_code(result, diag_codes::W_UNBOUNDED_STRUCT_ARRAY) == 1);
+    }
+
+    TEST_CASE("WARNING: Union rejects cases by trial decoding") {
+        auto modules = make_module_set(R"(
+            struct A { uint32 x; };
+            struct B { uint16 y; };
+
+            union Slow {
+                A a;
+                B b;
+            };
+
+            union Tagged {
+                uint8 tag_a : tag_a == 1;
+                B b;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        CHECK_FALSE(result.has_errors());
+        REQUIRE(count_code(result, diag_codes::W_TRIAL_DECODING) == 1);
+        for (const auto& warning : result.get_warnings()) {
+            if (warning.code == std::string(diag_codes::W_TRIAL_DECODING)) {
+                CHECK(warning.message.find("Slow") != std::string::npos);
+            }
+        }
+    }
+
+    TEST_CASE("WARNING: Union trial decoding names every slow case once") {
+        auto modules = make_module_set(R"(
+            struct A { uint32 x; };
+            struct B { uint16 y; };
+            struct C { uint8 z; };
+
+            union Slow {
+                A a;
+                B b;
+                C c;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        REQUIRE(count_code(result, diag_codes::W_TRIAL_DECODING) == 1);
+        for (const auto& warning : result.get_warnings()) {
+            if (warning.code == std::string(diag_codes::W_TRIAL_DECODING)) {
+                CHECK(warning.message.find("cases 'a', 'b'") != std::string::npos);
+                CHECK(warning.message.find("'c'") == std::string::npos);
+            }
+        }
+    }
+
+    TEST_CASE("WARNING: Array count without an upper bound") {
+        auto modules = make_module_set(R"(
+            struct Packet {
+                uint32 length;
+                uint8[length] body;
+                uint16 short_length;
+                uint8[short_length] small;
+                uint32 checked : checked <= 4096;
+                uint8[checked] bounded;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        CHECK_FALSE(result.has_errors());
+        REQUIRE(count_code(result, diag_codes::W_UNBOUNDED_COUNT) == 1);
+        for (const auto& warning : result.get_warnings()) {
+            if (warning.code == std::string(diag_codes::W_UNBOUNDED_COUNT)) {
+                CHECK(warning.message.find("'length'") != std::string::npos);
+            }
+        }
+    }
+
+    TEST_CASE("WARNING: Label seeks backwards") {
+        auto modules = make_module_set(R"(
+            struct Header {
+                uint32 magic;
+                uint32 version;
+                4:
+                uint32 again;
+            };
+
+            struct Forward {
+                uint32 magic;
+                16:
+                uint32 body;
+            };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        CHECK_FALSE(result.has_errors());
+        CHECK(count_code(result, diag_codes::W_BACKWARD_SEEK) == 1);
+    }
+
+    TEST_CASE("WARNING: Choice too large for linear dispatch") {
+        std::string source = "choice Opcode : uint8 {\n";
+        for (int i = 0; i < 20; ++i) {
+            source += "case " + std::to_string(i) + ": uint8 op" + std::to_string(i) + ";\n";
+        }
+        source += "};\n";
+        auto modules = make_module_set(source);
+
+        auto result = analyze_with_costs(modules);
+
+        CHECK_FALSE(result.has_errors());
+        CHECK(count_code(result, diag_codes::W_LARGE_CHOICE) == 1);
+    }
+
+    TEST_CASE("Cost report lists every type") {
+        auto modules = make_module_set(R"(
+            struct Point { uint16 x; uint16 y; };
+            union Either { uint8 a : a == 0; uint16 b; };
+        )");
+
+        auto result = analyze_with_costs(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto report = format_cost_report(*result.analyzed);
+        CHECK(report.find("Branches") != std::string::npos);
+        CHECK(report.find("Point") != std::string::npos);
+        CHECK(report.find("Either") != std::string::npos);
+    }
+}
@@ -0,0 +1,155 @@
+//
+// Tests for parallel semantic analysis (analysis_options::jobs)
+//
+
+#include <doctest/doctest.h>
+#include <datascript/parser.hh>
+#include <datascript/semantic.hh>
+
+using namespace datascript;
+using namespace datascript::semantic;
+
+namespace {
+    // Helper: main module plus two imported packages
+    module_set make_multi_module_set() {
+        module_set modules;
+
+        modules.main.module = parse_datascript(std::string(R"(
+            package app;
+            import geo.*;
+            import util.*;
+
+            const uint32 A = B + 1;
+            const uint32 B = N * 2;
+            const uint32 C = A + B;
+            const uint32 BROKEN = 1 / 0;
+
+            enum uint8 Color {
+                RED = A,
+                GREEN,
+                BLUE = C
+            };
+
+            struct Scene {
+                Point origin;
+                uint8[B] data;
+                Color color;
+            };
+        )"));
+        modules.main.file_path = "app.ds";
+        modules.main.package_name = "app";
+
+        loaded_module geo;
+        geo.module = parse_datascript(std::string(R"(
+            package geo;
+
+            const uint32 N = 4;
+
+            struct Point {
+                uint32 x;
+                uint32 y;
+            };
+        )"));
+        geo.file_path = "geo.ds";
+        geo.package_name = "geo";
+
+        loaded_module util;
+        util.module = parse_datascript(std::string(R"(
+            package util;
+
+            const uint32 ALL_ONES = 0xFFFFFFFF;
+
+            struct Pair {
+                uint16 first;
+                uint16 second;
+            };
+        )"));
+        util.file_path = "util.ds";
+        util.package_name = "util";
+
+        modules.imported.push_back(std::move(geo));
+        modules.package_index["geo"] = 0;
+        modules.imported.push_back(std::move(util));
+        modules.package_index["util"] = 1;
+
+        return modules;
+    }
+
+    std::vector<std::string> diagnostic_lines(const analysis_result& result) {
+        std::vector<std::string> lines;
+        for (const auto& diag : result.diagnostics) {
+            lines.push_back(diag.format());
+        }
+        return lines;
+    }
+}
+
+TEST_SUITE("Semantic Analysis - Parallel Phases") {
+    TEST_CASE("Parallel analysis reports the same diagnostics as serial") {
+        auto serial_modules = make_multi_module_set();
+        auto parallel_modules = make_multi_module_set();
+
+        analysis_options serial_opts;
+        serial_opts.jobs = 1;
+        analysis_options parallel_opts;
+        parallel_opts.jobs = 4;
+
+        auto serial = analyze(serial_modules, serial_opts);
+        auto parallel = analyze(parallel_modules, parallel_opts);
+
+        REQUIRE(serial.has_errors());
+        CHECK(diagnostic_lines(parallel) == diagnostic_lines(serial));
+    }
+
+    TEST_CASE("Parallel analysis computes the same constants, enums and offsets") {
+        auto modules = make_multi_module_set();
+        // Drop the failing constant so analysis succeeds
+        modules.main.module.constants.pop_back();
+
+        analysis_options opts;
+        opts.jobs = 0;  // One worker per hardware thread
+        opts.disabled_warnings = {diag_codes::W_UNUSED_CONSTANT, diag_codes::W_UNUSED_IMPORT};
+
+        auto result = analyze(modules, opts);
+        REQUIRE_FALSE(result.has_errors());
+        const auto& analyzed = result.analyzed.value();
+
+        const auto& consts = modules.main.module.constants;
+        CHECK(analyzed.constant_values.at(&consts[0]) == 9);   // A = B + 1
+        CHECK(analyzed.constant_values.at(&consts[1]) == 8);   // B = N * 2
+        CHECK(analyzed.constant_values.at(&consts[2]) == 17);  // C = A + B
+
+        const auto& items = modules.main.module.enums[0].items;
+        CHECK(analyzed.enum_item_values.at(&items[0]) == 9);
+        CHECK(analyzed.enum_item_values.at(&items[1]) == 10);
+        CHECK(analyzed.enum_item_values.at(&items[2]) == 17);
+
+        const auto& pair = modules.imported[1].module.structs[0];
+        const auto& second = std::get<ast::field_def>(pair.body[1]);
+        CHECK(analyzed.field_offsets.at(&second) == 2);
+
+        CHECK(analyzed.resolved_types.size() >= 2);
+    }
+
+    TEST_CASE("Circular constants are still reported with workers") {
+        auto modules = module_set{};
+        modules.main.module = parse_datascript(std::string(R"(
+            const uint32 X = Y + 1;
+            const uint32 Y = X + 1;
+            const uint32 Z = 3;
+        )"));
+        modules.main.file_path = "<test>";
+
+        analysis_options opts;
+        opts.jobs = 4;
+        auto result = analyze(modules, opts);
+
+        bool found_circular = false;
+        for (const auto& diag : result.diagnostics) {
+            if (diag.code == diag_codes::E_CIRCULAR_CONSTANT) {
+                found_circular = true;
+            }
+        }
+        CHECK(found_circular);
+    }
+}
@@ -489,4 +489,350 @@ TEST_SUITE("Semantic Analysis - Type Checking") {
         CHECK_FALSE(result.has_errors());
         REQUIRE(result.analyzed.has_value());
     }
+
+    TEST_CASE("Floating-point fields mix with integers in arithmetic and comparisons") {
+        auto modules = make_module_set(R"(
+            struct Reading {
+                uint8 offset;
+                float32 gain: gain > 0 && gain * 2 < 100;
+                big float64 scale: -scale != offset + gain;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK_FALSE(result.has_errors());
+        REQUIRE(result.analyzed.has_value());
+    }
+
+    TEST_CASE("Bitwise operations reject floating-point operands") {
+        auto modules = make_module_set(R"(
+            struct Reading {
+                float32 gain;
+                uint32 mask: mask == (gain & 0xFF);
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK(result.has_errors());
+    }
+
+    TEST_CASE("ERROR: Floating-point array sizes, labels, alignment and substream lengths") {
+        const char* sources[] = {
+            R"(
+                struct Samples {
+                    float32 n;
+                    uint8 data[n];
+                };
+            )",
+            R"(
+                struct Samples {
+                    float32 n;
+                    uint8 data[1..n];
+                };
+            )",
+            R"(
+                struct Indexed {
+                    float64 offset;
+                    offset:
+                    uint8 value;
+                };
+            )",
+            R"(
+                struct Aligned {
+                    float32 width;
+                    align(width):
+                    uint32 value;
+                };
+            )",
+            R"(
+                struct Container {
+                    float32 length;
+                    @zlib(length)
+                    uint8 body[];
+                };
+            )",
+        };
+
+        for (const char* source : sources) {
+            auto modules = make_module_set(source);
+            auto result = analyze(modules);
+
+            REQUIRE(result.has_errors());
+
+            bool found_invalid_operand = false;
+            for (const auto& error : result.get_errors()) {
+                if (error.code == std::string(diag_codes::E_INVALID_OPERAND_TYPE)) {
+                    found_invalid_operand = true;
+                    break;
+                }
+            }
+            CHECK(found_invalid_operand);
+        }
+    }
+
+    TEST_CASE("ERROR: Array size mixing integer and floating-point fields") {
+        auto modules = make_module_set(R"(
+            struct Samples {
+                uint8 count;
+                float32 scale;
+                uint8 data[count * scale];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK(result.has_errors());
+    }
+
+    TEST_CASE("Inline constraints in union blocks must be boolean") {
+        auto modules = make_module_set(R"(
+            union Frame {
+                {
+                    uint8 tag : tag + 1;
+                    uint8 value;
+                } tagged;
+                uint16 plain;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK(result.has_errors());
+    }
+
+    TEST_CASE("ERROR: Non-boolean inline constraint on a struct field") {
+        // Accepted before inline constraints were type-checked
+        auto modules = make_module_set(R"(
+            struct Header {
+                uint8 tag : tag + 1;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.has_errors());
+
+        auto errors = result.get_errors();
+        bool found_type_mismatch = false;
+        for (const auto& error : errors) {
+            if (error.code == std::string(diag_codes::E_TYPE_MISMATCH)) {
+                found_type_mismatch = true;
+                break;
+            }
+        }
+        CHECK(found_type_mismatch);
+    }
+
+    TEST_CASE("ERROR: Non-boolean inline constraint on a choice case field") {
+        // Accepted before inline constraints were type-checked
+        auto modules = make_module_set(R"(
+            choice Data on selector {
+                case 1: uint32 int_field : int_field & 0xFF;
+                case 2: string str_field;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK(result.has_errors());
+    }
+
+    TEST_CASE("Boolean inline constraints pass in structs, unions and choices") {
+        auto modules = make_module_set(R"(
+            struct Header {
+                uint8 tag : tag < 4;
+            };
+            union Frame {
+                uint16 word : word != 0;
+                uint8 byte;
+            };
+            choice Data on selector {
+                case 1: uint32 int_field : int_field > 0 && int_field < 100;
+                case 2: string str_field;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK_FALSE(result.has_errors());
+    }
+
+    TEST_CASE("Array transforms apply to sized integer arrays") {
+        auto modules = make_module_set(R"(
+            struct Series {
+                uint32 count;
+                @delta_of_delta
+                int64 timestamps[count];
+                @zigzag_delta
+                big int16 levels[4];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK_FALSE(result.has_errors());
+        REQUIRE(result.analyzed.has_value());
+    }
+
+    TEST_CASE("ERROR: Unknown array transform") {
+        auto modules = make_module_set(R"(
+            struct Series {
+                @xor
+                uint32 ids[4];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.has_errors());
+
+        bool found_invalid_directive = false;
+        for (const auto& error : result.get_errors()) {
+            if (error.code == std::string(diag_codes::E_INVALID_DIRECTIVE)) {
+                found_invalid_directive = true;
+                break;
+            }
+        }
+        CHECK(found_invalid_directive);
+    }
+
+    TEST_CASE("ERROR: Array transform on a non-array field") {
+        auto modules = make_module_set(R"(
+            struct Series {
+                @delta
+                uint32 id;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.has_errors());
+
+        bool found_invalid_directive = false;
+        for (const auto& error : result.get_errors()) {
+            if (error.code == std::string(diag_codes::E_INVALID_DIRECTIVE)) {
+                found_invalid_directive = true;
+                break;
+            }
+        }
+        CHECK(found_invalid_directive);
+    }
+
+    TEST_CASE("Substream transforms apply to structs and byte arrays") {
+        auto modules = make_module_set(R"(
+            struct Header {
+                uint16 version;
+            };
+
+            struct Container {
+                uint16 length;
+                uint8 key;
+                @xor(length, key)
+                Header header;
+                @rol(16, 3)
+                uint8 scrambled[];
+                @zlib(length)
+                uint8 body[];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        CHECK_FALSE(result.has_errors());
+        REQUIRE(result.analyzed.has_value());
+    }
+
+    TEST_CASE("ERROR: Substream transform with a wrong argument count") {
+        auto modules = make_module_set(R"(
+            struct Container {
+                @zlib(4, 1)
+                uint8 body[];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.has_errors());
+
+        bool found_invalid_directive = false;
+        for (const auto& error : result.get_errors()) {
+            if (error.code == std::string(diag_codes::E_INVALID_DIRECTIVE)) {
+                found_invalid_directive = true;
+                break;
+            }
+        }
+        CHECK(found_invalid_directive);
+    }
+
+    TEST_CASE("ERROR: Substream transform on a sized array") {
+        auto modules = make_module_set(R"(
+            struct Container {
+                @xor(4, 0x5A)
+                uint8 body[4];
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.has_errors());
+
+        bool found_invalid_directive = false;
+        for (const auto& error : result.get_errors()) {
+            if (error.code == std::string(diag_codes::E_INVALID_DIRECTIVE)) {
+                found_invalid_directive = true;
+                break;
+            }
+        }
+        CHECK(found_invalid_directive);
+    }
+
+    TEST_CASE("Pure member functions record the fields they read") {
+        auto modules = make_module_set(R"(
+            const uint32 HEADER = 4;
+
+            struct Packet {
+                uint16 count;
+                uint16 width;
+                uint8 kind;
+
+                function uint32 payload_size() {
+                    return count * width;
+                }
+
+                function uint32 total_size() {
+                    return payload_size() + HEADER;
+                }
+
+                function uint32 scaled(uint32 count) {
+                    return count * 2;
+                }
+
+                function uint32 forever() {
+                    return forever();
+                }
+
+                function uint32 via_forever() {
+                    return forever() + kind;
+                }
+            };
+        )");
+
+        auto result = analyze(modules);
+        REQUIRE_FALSE(result.has_errors());
+
+        std::map<std::string, std::set<std::string>> pure;
+        for (const auto& [func, inputs] : result.analyzed->pure_functions) {
+            pure[func->name] = inputs;
+        }
+
+        CHECK((pure["payload_size"] == std::set<std::string>{"count", "width"}));
+        CHECK((pure["total_size"] == std::set<std::string>{"count", "width"}));
+        CHECK(pure["scaled"].empty());  // The parameter shadows the field
+
+        // Recursion has no fixed point to memoize
+        CHECK_FALSE(pure.contains("forever"));
+        CHECK_FALSE(pure.contains("via_forever"));
+    }
 }
@@ -0,0 +1,157 @@
+//
+// Tests for Phase 5 (continued): Wire Size and Heap Bounds
+//
+
+#include <doctest/doctest.h>
+#include <datascript/parser.hh>
+#include <datascript/semantic.hh>
+
+using namespace datascript;
+using namespace datascript::semantic;
+
+namespace {
+    // Helper: create a module_set from a single source string
+    module_set make_module_set(const std::string& source) {
+        auto main_mod = parse_datascript(source);
+
+        module_set modules;
+        modules.main.module = std::move(main_mod);
+        modules.main.file_path = "<test>";
+        modules.main.package_name = "";
+
+        return modules;
+    }
+
+    const wire_bounds* find_bounds(const analysis_result& result, const std::string& name) {
+        for (const auto& [def, bounds] : result.analyzed->type_bounds) {
+            auto def_name = std::visit([](auto* d) { return d->name; }, def);
+            if (def_name == name) {
+                return &bounds;
+            }
+        }
+        return nullptr;
+    }
+}
+
+TEST_SUITE("Semantic Analysis - Wire Bounds") {
+    TEST_CASE("Fixed-size struct") {
+        auto modules = make_module_set(R"(
+            struct Point { uint16 x; uint16 y; float64 z; };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* point = find_bounds(result, "Point");
+        REQUIRE(point != nullptr);
+        CHECK(point->min_size == 12);
+        CHECK(point->max_size == 12);
+        CHECK(point->max_heap_bytes == 0);
+        CHECK(point->arrays.empty());
+    }
+
+    TEST_CASE("Array counts are bounded by count field types and constraints") {
+        auto modules = make_module_set(R"(
+            struct Item { uint32 id; };
+
+            struct Packet {
+                uint8 count : count <= 10;
+                Item[count * 2] items;
+                uint8 tag;
+                uint8[tag] raw;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* packet = find_bounds(result, "Packet");
+        REQUIRE(packet != nullptr);
+        CHECK(packet->min_size == 2);
+        CHECK(packet->max_size == 2 + 20 * 4 + 255);
+        CHECK(packet->max_heap_bytes == 20 * 4 + 255);
+
+        REQUIRE(packet->arrays.size() == 2);
+        CHECK(packet->arrays[0].field == "items");
+        CHECK(packet->arrays[0].max_count == 20);
+        REQUIRE(packet->arrays[0].inputs.size() == 1);
+        CHECK(packet->arrays[0].inputs[0] == "count");
+        CHECK(packet->arrays[1].max_count == 255);
+    }
+
+    TEST_CASE("Strings and unsized arrays are unbounded") {
+        auto modules = make_module_set(R"(
+            struct Named { uint16 id; string name; };
+            struct Log { uint8[] tail; };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* named = find_bounds(result, "Named");
+        REQUIRE(named != nullptr);
+        CHECK(named->min_size == 3);  // id + terminator
+        CHECK_FALSE(named->max_size.has_value());
+        CHECK_FALSE(named->max_heap_bytes.has_value());
+
+        auto* log = find_bounds(result, "Log");
+        REQUIRE(log != nullptr);
+        CHECK(log->min_size == 0);
+        REQUIRE(log->arrays.size() == 1);
+        CHECK_FALSE(log->arrays[0].max_count.has_value());
+    }
+
+    TEST_CASE("Conditional fields only add to the maximum") {
+        auto modules = make_module_set(R"(
+            struct Header {
+                uint8 flags;
+                uint32 extra if flags != 0;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* header = find_bounds(result, "Header");
+        REQUIRE(header != nullptr);
+        CHECK(header->min_size == 1);
+        CHECK(header->max_size == 5);
+    }
+
+    TEST_CASE("Choices take the smallest and largest case") {
+        auto modules = make_module_set(R"(
+            choice Value : uint8 {
+                case 1:
+                    uint8 small;
+                case 2:
+                    { uint32 a; uint32 b; } pair;
+                default:
+                    uint16 other;
+            };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto* value = find_bounds(result, "Value");
+        REQUIRE(value != nullptr);
+        CHECK(value->min_size == 2);  // Discriminator + small
+        CHECK(value->max_size == 8);  // Block cases re-read from the discriminator
+    }
+
+    TEST_CASE("Size report is JSON with null for unbounded values") {
+        auto modules = make_module_set(R"(
+            struct Point { uint16 x; uint16 y; };
+            struct Named { string name; };
+        )");
+
+        auto result = analyze(modules);
+
+        REQUIRE(result.analyzed.has_value());
+        auto report = format_size_report(*result.analyzed);
+        CHECK(report.find("\"name\": \"Point\"") != std::string::npos);
+        CHECK(report.find("\"max_wire_size\": 4") != std::string::npos);
+        CHECK(report.find("\"max_wire_size\": null") != std::string::npos);
+        CHECK(report.find("Point") < report.find("Named"));
+    }
+}